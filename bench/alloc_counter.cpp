@@ -0,0 +1,55 @@
+// Replaces the global allocation functions of the bench binary with
+// counting versions, so the harness can report heap allocations per call.
+// The array and nothrow forms default to calling these; the sized deletes
+// are spelled out because GCC asks for them.
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "harness.hpp"
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+
+void* allocate(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (size == 0) size = 1;
+  for (;;) {
+    if (void* p = std::malloc(size)) return p;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void* allocate_aligned(std::size_t size, std::size_t align) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  // aligned_alloc wants a size that is a multiple of the alignment.
+  size = (size + align - 1) & ~(align - 1);
+  if (size == 0) size = align;
+  for (;;) {
+    if (void* p = std::aligned_alloc(align, size)) return p;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+}  // namespace
+
+namespace algoritmi::bench {
+
+std::uint64_t allocation_count() noexcept { return allocations.load(std::memory_order_relaxed); }
+
+}  // namespace algoritmi::bench
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) {
+  return allocate_aligned(size, static_cast<std::size_t>(align));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,61 @@
+// Standard-library reference points. Every Algoritmi module is compared
+// against these rows in bench_output.txt.
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+template <class T>
+void std_sort(State& st) {
+  auto const input = random_vector<T>(st.n());
+  std::vector<T> v;
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { v = input; }, [&] { std::sort(v.begin(), v.end()); });
+}
+
+template <class T>
+void std_stable_sort(State& st) {
+  auto const input = random_vector<T>(st.n());
+  std::vector<T> v;
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { v = input; }, [&] { std::stable_sort(v.begin(), v.end()); });
+}
+
+template <class T>
+void std_lower_bound(State& st) {
+  auto keys = random_vector<T>(st.n());
+  std::sort(keys.begin(), keys.end());
+  auto const queries = random_vector<T>(1 << 16, 7);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (T q : queries)
+      acc += static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), q) - keys.begin());
+    do_not_optimize(acc);
+  });
+}
+
+template <class T>
+void std_accumulate(State& st) {
+  auto const v = random_vector<T>(st.n());
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { do_not_optimize(std::accumulate(v.begin(), v.end(), T{})); });
+}
+
+ALGORITMI_BENCH("baseline/std::sort/u32", std_sort<std::uint32_t>);
+ALGORITMI_BENCH("baseline/std::sort/u64", std_sort<std::uint64_t>);
+ALGORITMI_BENCH("baseline/std::sort/f64", std_sort<double>);
+ALGORITMI_BENCH("baseline/std::stable_sort/u64", std_stable_sort<std::uint64_t>);
+ALGORITMI_BENCH("baseline/std::lower_bound/u32", std_lower_bound<std::uint32_t>);
+ALGORITMI_BENCH("baseline/std::lower_bound/u64", std_lower_bound<std::uint64_t>);
+ALGORITMI_BENCH("baseline/std::accumulate/u64", std_accumulate<std::uint64_t>);
+
+}  // namespace
+}  // namespace algoritmi::bench
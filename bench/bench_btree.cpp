@@ -0,0 +1,147 @@
+// Ordered map benchmarks: btree_map against std::map, n random 64-bit keys.
+//
+//   find      query_count lookups, half of them hits (ns per lookup)
+//   range     query_count scans of the 64 entries from a random lower_bound
+//             (ns per entry visited)
+//   mixed     query_count operations on the full map: 50% insert, 25% erase,
+//             25% find, keys from twice the key range (ns per operation)
+//   insert    building the map by n inserts in random order, and the
+//             btree_map bulk load from sorted input (ns per element)
+#include <algoritmi/btree.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t query_count = 1 << 16;
+constexpr std::size_t scan_length = 64;
+constexpr std::size_t max_n = 10000000;
+
+// Even keys; odd queries miss.
+std::vector<std::uint64_t> keys(std::size_t n) {
+  auto v = random_vector<std::uint64_t>(n);
+  for (auto& k : v) k &= ~std::uint64_t{1};
+  return v;
+}
+
+std::vector<std::uint64_t> queries(std::vector<std::uint64_t> const& k) {
+  Rng rng(9);
+  std::vector<std::uint64_t> q(query_count);
+  for (auto& x : q) x = k[rng.below(k.size())] | rng.below(2);
+  return q;
+}
+
+template <class Map>
+Map filled(std::vector<std::uint64_t> const& k) {
+  Map m;
+  for (auto x : k) m.try_emplace(x, x);
+  return m;
+}
+
+template <class Map>
+void find(State& st) {
+  auto const k = keys(st.n());
+  Map const m = filled<Map>(k);
+  auto const q = queries(k);
+  st.set_items_per_run(q.size());
+  st.run([&] {
+    std::uint64_t acc = 0;
+    for (auto x : q) acc += m.find(x) != m.end();
+    do_not_optimize(acc);
+  });
+}
+
+void btree_find_scalar(State& st) {
+  auto const k = keys(st.n());
+  auto const m = filled<btree_map<std::uint64_t, std::uint64_t>>(k);
+  auto const q = queries(k);
+  st.set_items_per_run(q.size());
+  st.run([&] {
+    std::uint64_t acc = 0;
+    for (auto x : q) acc += m.lower_bound(isa::scalar, x) != m.end();
+    do_not_optimize(acc);
+  });
+}
+
+template <class Map>
+void range(State& st) {
+  auto const k = keys(st.n());
+  Map const m = filled<Map>(k);
+  auto const q = queries(k);
+  st.set_items_per_run(q.size() * scan_length);
+  st.run([&] {
+    std::uint64_t acc = 0;
+    for (auto x : q) {
+      auto it = m.lower_bound(x);
+      for (std::size_t j = 0; j < scan_length && it != m.end(); ++j, ++it) acc += it->second;
+    }
+    do_not_optimize(acc);
+  });
+}
+
+template <class Map>
+void mixed(State& st) {
+  auto const k = keys(st.n());
+  Rng rng(13);
+  std::vector<std::pair<unsigned, std::uint64_t>> ops(query_count);
+  for (auto& op : ops) op = {static_cast<unsigned>(rng.below(4)), k[rng.below(k.size())] ^ 2};
+  st.set_items_per_run(ops.size());
+  Map const base = filled<Map>(k);
+  Map m;
+  st.run([&] { m = base; },
+         [&] {
+           std::uint64_t acc = 0;
+           for (auto [kind, key] : ops) {
+             if (kind < 2)
+               acc += m.try_emplace(key, key).second;
+             else if (kind == 2)
+               acc += m.erase(key);
+             else
+               acc += m.find(key) != m.end();
+           }
+           do_not_optimize(acc);
+         });
+}
+
+template <class Map>
+void insert(State& st) {
+  auto const k = keys(st.n());
+  st.run([&] { do_not_optimize(filled<Map>(k).size()); });
+}
+
+void btree_bulk_load(State& st) {
+  auto k = keys(st.n());
+  std::sort(k.begin(), k.end());
+  k.erase(std::unique(k.begin(), k.end()), k.end());
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> sorted(k.size());
+  for (std::size_t i = 0; i < k.size(); ++i) sorted[i] = {k[i], k[i]};
+  st.run([&] {
+    btree_map<std::uint64_t, std::uint64_t> m(sorted_unique, sorted.begin(), sorted.end());
+    do_not_optimize(m.size());
+  });
+}
+
+using btree = btree_map<std::uint64_t, std::uint64_t>;
+using rbtree = std::map<std::uint64_t, std::uint64_t>;
+
+ALGORITMI_BENCH("btree/btree_map/find", find<btree>, max_n);
+ALGORITMI_BENCH("btree/btree_map_scalar/find", btree_find_scalar, max_n);
+ALGORITMI_BENCH("btree/std_map/find", find<rbtree>, max_n);
+ALGORITMI_BENCH("btree/btree_map/range", range<btree>, max_n);
+ALGORITMI_BENCH("btree/std_map/range", range<rbtree>, max_n);
+ALGORITMI_BENCH("btree/btree_map/mixed", mixed<btree>, max_n);
+ALGORITMI_BENCH("btree/std_map/mixed", mixed<rbtree>, max_n);
+ALGORITMI_BENCH("btree/btree_map/insert", insert<btree>, max_n);
+ALGORITMI_BENCH("btree/std_map/insert", insert<rbtree>, max_n);
+ALGORITMI_BENCH("btree/btree_map/bulk_load", btree_bulk_load, max_n);
+
+}  // namespace
+}  // namespace algoritmi::bench
@@ -0,0 +1,161 @@
+// Queue throughput: n 64-bit items handed from producer to consumer threads
+// (ns per item). Threads yield when the queue is full or empty, so results
+// on machines with fewer cores than threads measure mostly scheduling.
+//
+//   spsc/1p1c        spsc_queue, one push and one pop per item
+//   spsc_bulk/1p1c   spsc_queue, push_bulk/pop_bulk in batches of 64
+//   mpmc/<p>p<c>c    mpmc_queue with p producers and c consumers
+//   segmented/...    segmented_queue (unbounded)
+//   mutex/...        std::deque behind a std::mutex, the baseline
+// Bounded queues hold ring_capacity items.
+#include <algoritmi/concurrent.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t ring_capacity = 4096;
+constexpr std::size_t batch = 64;
+constexpr std::size_t max_items = 10000000;
+
+class locked_deque {
+ public:
+  bool try_push(std::uint64_t v) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    items_.push_back(v);
+    return true;
+  }
+  bool try_pop(std::uint64_t& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.empty()) return false;
+    out = items_.front();
+    items_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::deque<std::uint64_t> items_;
+};
+
+struct unbounded_push {
+  template <class Q>
+  bool operator()(Q& q, std::uint64_t v) const {
+    q.push(v);
+    return true;
+  }
+};
+struct try_push {
+  template <class Q>
+  bool operator()(Q& q, std::uint64_t v) const {
+    return q.try_push(v);
+  }
+};
+
+// Producers split [0, n) between them; consumers pop until n items are out.
+template <class Q, class Push>
+std::uint64_t transfer(Q& q, std::size_t n, unsigned producers, unsigned consumers, Push push) {
+  std::atomic<std::size_t> popped{0};
+  std::atomic<std::uint64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < producers; ++p)
+    threads.emplace_back([&, p] {
+      for (std::size_t i = n * p / producers, end = n * (p + 1) / producers; i < end; ++i)
+        while (!push(q, i)) std::this_thread::yield();
+    });
+  for (unsigned c = 0; c < consumers; ++c)
+    threads.emplace_back([&] {
+      std::uint64_t local = 0, v;
+      while (popped.load(std::memory_order_relaxed) < n) {
+        if (q.try_pop(v)) {
+          local += v;
+          popped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      sum.fetch_add(local, std::memory_order_relaxed);
+    });
+  for (auto& t : threads) t.join();
+  return sum.load();
+}
+
+void spsc(State& st) {
+  st.run([&] {
+    spsc_queue<std::uint64_t> q(ring_capacity);
+    do_not_optimize(transfer(q, st.n(), 1, 1, try_push{}));
+  });
+}
+
+void spsc_bulk(State& st) {
+  st.run([&] {
+    spsc_queue<std::uint64_t> q(ring_capacity);
+    std::size_t const n = st.n();
+    std::uint64_t sum = 0;
+    std::thread producer([&] {
+      std::uint64_t buf[batch];
+      for (std::size_t i = 0; i < n;) {
+        std::size_t const k = std::min(batch, n - i);
+        for (std::size_t j = 0; j < k; ++j) buf[j] = i + j;
+        std::size_t done = 0;
+        while ((done += q.push_bulk(buf + done, k - done)) < k) std::this_thread::yield();
+        i += k;
+      }
+    });
+    std::uint64_t buf[batch];
+    for (std::size_t got = 0; got < n;) {
+      std::size_t const k = q.pop_bulk(buf, batch);
+      if (k == 0) std::this_thread::yield();
+      for (std::size_t j = 0; j < k; ++j) sum += buf[j];
+      got += k;
+    }
+    producer.join();
+    do_not_optimize(sum);
+  });
+}
+
+template <unsigned P, unsigned C>
+void mpmc(State& st) {
+  st.run([&] {
+    mpmc_queue<std::uint64_t> q(ring_capacity);
+    do_not_optimize(transfer(q, st.n(), P, C, try_push{}));
+  });
+}
+
+template <unsigned P, unsigned C>
+void segmented(State& st) {
+  st.run([&] {
+    segmented_queue<std::uint64_t> q;
+    do_not_optimize(transfer(q, st.n(), P, C, unbounded_push{}));
+  });
+}
+
+template <unsigned P, unsigned C>
+void mutex(State& st) {
+  st.run([&] {
+    locked_deque q;
+    do_not_optimize(transfer(q, st.n(), P, C, try_push{}));
+  });
+}
+
+ALGORITMI_BENCH("concurrent/spsc/1p1c", spsc, max_items);
+ALGORITMI_BENCH("concurrent/spsc_bulk/1p1c", spsc_bulk, max_items);
+ALGORITMI_BENCH("concurrent/mpmc/1p1c", mpmc<1, 1>, max_items);
+ALGORITMI_BENCH("concurrent/mpmc/2p2c", mpmc<2, 2>, max_items);
+ALGORITMI_BENCH("concurrent/segmented/1p1c", segmented<1, 1>, max_items);
+ALGORITMI_BENCH("concurrent/segmented/2p2c", segmented<2, 2>, max_items);
+ALGORITMI_BENCH("concurrent/mutex/1p1c", mutex<1, 1>, max_items);
+ALGORITMI_BENCH("concurrent/mutex/2p2c", mutex<2, 2>, max_items);
+
+}  // namespace
+}  // namespace algoritmi::bench
@@ -0,0 +1,154 @@
+// Dynamic programming benchmarks.
+//
+//   edit_distance   fuzzy matching: one 6-12 byte query against n dictionary
+//                   words (ns per comparison), bit-parallel against the
+//                   textbook full table; and two random n-byte strings over
+//                   a 4-letter alphabet, reported per table cell
+//   lcs_length      the same long strings, per cell
+//   alignment       Smith-Waterman score (SIMD and scalar) and Hirschberg
+//                   global alignment of two n-byte strings, per cell
+//   knapsack        n items, capacity 1000, per item x capacity cell
+#include <algoritmi/dp.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+// Bit-parallel kernels do n^2 / 64 word steps; cell-at-a-time ones n^2.
+constexpr std::size_t max_bits_n = 100000;
+constexpr std::size_t max_cells_n = 10000;
+constexpr std::size_t capacity = 1000;
+
+std::vector<std::string> dictionary(std::size_t n) {
+  Rng rng(11);
+  std::vector<std::string> words(n);
+  for (auto& w : words) {
+    w.resize(6 + rng.below(7));
+    for (char& c : w) c = static_cast<char>('a' + rng.below(26));
+  }
+  return words;
+}
+
+std::string dna(std::size_t n, std::uint64_t seed) {
+  static char const bases[] = "ACGT";
+  Rng rng(seed);
+  std::string s(n, 'A');
+  for (char& c : s) c = bases[rng.below(4)];
+  return s;
+}
+
+constexpr std::string_view query = "algoritmi";
+
+std::size_t table_edit_distance(std::string_view a, std::string_view b) {
+  std::vector<std::size_t> t((a.size() + 1) * (b.size() + 1));
+  std::size_t const w = b.size() + 1;
+  for (std::size_t i = 0; i <= a.size(); ++i)
+    for (std::size_t j = 0; j <= b.size(); ++j)
+      t[i * w + j] = i == 0 || j == 0 ? i + j
+                                      : std::min({t[(i - 1) * w + j] + 1, t[i * w + j - 1] + 1,
+                                                  t[(i - 1) * w + j - 1] + (a[i - 1] != b[j - 1])});
+  return t.back();
+}
+
+template <class Distance>
+void words_bench(State& st, Distance distance) {
+  auto const words = dictionary(st.n());
+  st.run([&] {
+    std::size_t acc = 0;
+    for (auto const& w : words) acc += distance(w);
+    do_not_optimize(acc);
+  });
+}
+
+void edit_distance_matcher_words(State& st) {
+  edit_distance_matcher m(query);
+  words_bench(st, [&](std::string_view w) { return m.distance(w); });
+}
+
+void edit_distance_bounded_words(State& st) {
+  edit_distance_matcher m(query);
+  words_bench(st, [&](std::string_view w) { return m.distance(w, 2); });
+}
+
+void edit_distance_words(State& st) {
+  words_bench(st, [&](std::string_view w) { return edit_distance(query, w); });
+}
+
+void table_edit_distance_words(State& st) {
+  words_bench(st, [&](std::string_view w) { return table_edit_distance(query, w); });
+}
+
+template <class F>
+void pair_bench(State& st, F f) {
+  std::string const a = dna(st.n(), 1), b = dna(st.n(), 2);
+  st.set_items_per_run(st.n() * st.n());
+  st.run([&] { do_not_optimize(f(a, b)); });
+}
+
+void edit_distance_long(State& st) {
+  pair_bench(st, [](std::string_view a, std::string_view b) { return edit_distance(a, b); });
+}
+
+void lcs_length_long(State& st) {
+  pair_bench(st, [](std::string_view a, std::string_view b) { return lcs_length(a, b); });
+}
+
+template <isa Which>
+void local_alignment(State& st) {
+  pair_bench(st, [](std::string_view a, std::string_view b) {
+    return local_alignment_score(a, b, {2, -1, -1}, Which);
+  });
+}
+
+void global_alignment_score_long(State& st) {
+  pair_bench(st, [](std::string_view a, std::string_view b) {
+    return global_alignment_score(a, b);
+  });
+}
+
+void global_alignment_long(State& st) {
+  pair_bench(st, [](std::string_view a, std::string_view b) {
+    return global_alignment(a, b).score;
+  });
+}
+
+template <bool Items>
+void knapsack_items(State& st) {
+  Rng rng(5);
+  std::vector<std::size_t> weights(st.n());
+  std::vector<std::int64_t> values(st.n());
+  for (auto& w : weights) w = 1 + rng.below(100);
+  for (auto& v : values) v = static_cast<std::int64_t>(1 + rng.below(1000));
+  st.set_items_per_run(st.n() * (capacity + 1));
+  st.run([&] {
+    if constexpr (Items)
+      do_not_optimize(knapsack(weights, values, capacity).value);
+    else
+      do_not_optimize(knapsack_value(weights, values, capacity));
+  });
+}
+
+ALGORITMI_BENCH("dp/edit_distance/matcher_words", edit_distance_matcher_words);
+ALGORITMI_BENCH("dp/edit_distance/bounded_words", edit_distance_bounded_words);
+ALGORITMI_BENCH("dp/edit_distance/words", edit_distance_words);
+ALGORITMI_BENCH("dp/table_edit_distance/words", table_edit_distance_words);
+ALGORITMI_BENCH("dp/edit_distance/long", edit_distance_long, max_bits_n);
+ALGORITMI_BENCH("dp/lcs_length/long", lcs_length_long, max_bits_n);
+ALGORITMI_BENCH("dp/local_alignment_score/long", local_alignment<isa::avx2>, max_cells_n);
+ALGORITMI_BENCH("dp/local_alignment_score_scalar/long", local_alignment<isa::scalar>,
+                max_cells_n);
+ALGORITMI_BENCH("dp/global_alignment_score/long", global_alignment_score_long, max_cells_n);
+ALGORITMI_BENCH("dp/global_alignment/long", global_alignment_long, max_cells_n);
+ALGORITMI_BENCH("dp/knapsack_value/items", knapsack_items<false>, max_bits_n);
+ALGORITMI_BENCH("dp/knapsack/items", knapsack_items<true>, max_cells_n);
+
+}  // namespace
+}  // namespace algoritmi::bench
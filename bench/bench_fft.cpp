@@ -0,0 +1,159 @@
+// Transform and convolution benchmarks. n is the transform length rounded
+// down to a power of two for the plans, the output length for the
+// convolutions and the product's limbs for bigint; all report ns per
+// point (per limb for bigint).
+//
+//   fft        complex forward transform: AVX2/FMA, portable butterflies,
+//              par
+//   ntt        forward NTT modulo 998244353, serial and par
+//   convolve   equal lengths (one whole transform), a 1000-point template
+//              against a long signal (overlap-save), par, and the direct
+//              loop on the template case for reference
+//   bigint     bigint_multiply of two equal halves, serial and par
+#include <algoritmi/fft.hpp>
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+// 10^7 points: up to 2^24 complex doubles (256 MiB) per transform, and
+// close to the longest product bigint_multiply takes.
+constexpr std::size_t max_transform_n = 10000000;
+// The direct loop does n * template_points multiply-adds.
+constexpr std::size_t template_points = 1000;
+constexpr std::size_t max_direct_n = 1000000;
+
+std::size_t power_of_two_below(std::size_t n) {
+  std::size_t p = 1;
+  while (2 * p <= n) p *= 2;
+  return p;
+}
+
+std::vector<double> random_signal(std::size_t n, std::uint64_t seed) {
+  auto const values = random_vector<std::uint32_t>(n, seed);
+  std::vector<double> x(n);
+  for (std::size_t i = 0; i < n; ++i) x[i] = static_cast<double>(values[i]) * 0x1.0p-31 - 1;
+  return x;
+}
+
+template <class Forward>
+void fft_bench(State& st, Forward forward) {
+  std::size_t const n = power_of_two_below(st.n());
+  fft_plan const plan(n);
+  auto const re = random_signal(n, 1), im = random_signal(n, 2);
+  std::vector<std::complex<double>> x(n);
+  for (std::size_t i = 0; i < n; ++i) x[i] = {re[i], im[i]};
+  st.set_items_per_run(n);
+  st.set_bytes_per_item(sizeof(std::complex<double>));
+  // Transforms are linear: repeating forward() on the same array only
+  // scales it, by at most n per run, so rescale now and then.
+  std::size_t runs = 0;
+  st.run([&] {
+    forward(plan, x);
+    if (++runs % 16 == 0)
+      for (auto& v : x) v /= static_cast<double>(n);
+    do_not_optimize(x.data());
+  });
+}
+
+template <isa Which>
+void fft_isa(State& st) {
+  fft_bench(st, [](fft_plan const& plan, std::vector<std::complex<double>>& x) {
+    plan.forward(Which, x);
+  });
+}
+
+void fft_par(State& st) {
+  fft_bench(st, [](fft_plan const& plan, std::vector<std::complex<double>>& x) {
+    plan.forward(par, x);
+  });
+}
+
+template <bool Parallel>
+void ntt_bench(State& st) {
+  std::size_t const n = power_of_two_below(st.n());
+  ntt_plan<998244353> const plan(n);
+  auto x = random_vector<std::uint32_t>(n, 3);
+  for (auto& v : x) v %= 998244353;
+  st.set_items_per_run(n);
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] {
+    if (Parallel)
+      plan.forward(par, x);
+    else
+      plan.forward(x);
+    do_not_optimize(x.data());
+  });
+}
+
+template <class Convolve>
+void convolve_bench(State& st, std::size_t nb, Convolve convolve_fn) {
+  std::size_t const n = st.n(), na = n + 1 > nb ? n + 1 - nb : 1;
+  auto const a = random_signal(na, 4), b = random_signal(nb, 5);
+  st.set_items_per_run(n);
+  st.set_bytes_per_item(sizeof(double));
+  st.run([&] {
+    auto const c = convolve_fn(span<double const>(a), span<double const>(b));
+    do_not_optimize(c.data());
+  });
+}
+
+void convolve_equal(State& st) {
+  convolve_bench(st, st.n() / 2 + 1, [](auto a, auto b) { return convolve(a, b); });
+}
+
+void convolve_equal_par(State& st) {
+  convolve_bench(st, st.n() / 2 + 1, [](auto a, auto b) { return convolve(par, a, b); });
+}
+
+void convolve_template(State& st) {
+  convolve_bench(st, template_points, [](auto a, auto b) { return convolve(a, b); });
+}
+
+void convolve_template_par(State& st) {
+  convolve_bench(st, template_points, [](auto a, auto b) { return convolve(par, a, b); });
+}
+
+void convolve_direct(State& st) {
+  convolve_bench(st, template_points, [](auto a, auto b) {
+    std::vector<double> c(a.size() + b.size() - 1);
+    for (std::size_t j = 0; j < b.size(); ++j)
+      for (std::size_t i = 0; i < a.size(); ++i) c[i + j] += a[i] * b[j];
+    return c;
+  });
+}
+
+template <bool Parallel>
+void bigint_bench(State& st) {
+  std::size_t const half = st.n() / 2 + 1;
+  auto const a = random_vector<std::uint32_t>(half, 6), b = random_vector<std::uint32_t>(half, 7);
+  st.set_items_per_run(2 * half);
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] {
+    auto const c = Parallel ? bigint_multiply(par, a, b) : bigint_multiply(a, b);
+    do_not_optimize(c.data());
+  });
+}
+
+ALGORITMI_BENCH("fft/fft/c64", fft_isa<isa::avx2>, max_transform_n);
+ALGORITMI_BENCH("fft/fft_scalar/c64", fft_isa<isa::scalar>, max_transform_n);
+ALGORITMI_BENCH("fft/fft_par/c64", fft_par, max_transform_n);
+ALGORITMI_BENCH("fft/ntt/u32", ntt_bench<false>, max_transform_n);
+ALGORITMI_BENCH("fft/ntt_par/u32", ntt_bench<true>, max_transform_n);
+ALGORITMI_BENCH("fft/convolve/f64", convolve_equal, max_transform_n);
+ALGORITMI_BENCH("fft/convolve_par/f64", convolve_equal_par, max_transform_n);
+ALGORITMI_BENCH("fft/convolve_template/f64", convolve_template, max_transform_n);
+ALGORITMI_BENCH("fft/convolve_template_par/f64", convolve_template_par, max_transform_n);
+ALGORITMI_BENCH("fft/convolve_direct/f64", convolve_direct, max_direct_n);
+ALGORITMI_BENCH("fft/bigint/u32", bigint_bench<false>, max_transform_n);
+ALGORITMI_BENCH("fft/bigint_par/u32", bigint_bench<true>, max_transform_n);
+
+}  // namespace
+}  // namespace algoritmi::bench
@@ -0,0 +1,145 @@
+#include <algoritmi/filter.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t query_count = 1 << 16;
+
+// Lookups of keys that are mostly absent, the pre-filter's common case.
+template <class Filter, class Lookup>
+void filter_lookup(State& st, Filter const& f, Lookup lookup) {
+  auto const queries = random_vector<std::uint64_t>(query_count, 7);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (std::uint64_t q : queries) acc += lookup(f, q);
+    do_not_optimize(acc);
+  });
+}
+
+template <class Filter>
+void filter_batch(State& st, Filter const& f) {
+  auto const queries = random_vector<std::uint64_t>(query_count, 7);
+  std::unique_ptr<bool[]> out(new bool[queries.size()]);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    f.contains(queries.data(), queries.size(), out.get());
+    do_not_optimize(out.get());
+  });
+}
+
+blocked_bloom_filter<std::uint64_t> make_bloom(std::size_t n) {
+  auto const keys = random_vector<std::uint64_t>(n);
+  blocked_bloom_filter<std::uint64_t> bloom(n);
+  bloom.insert(keys.begin(), keys.end());
+  return bloom;
+}
+
+void bloom_insert(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    blocked_bloom_filter<std::uint64_t> bloom(keys.size());
+    bloom.insert(keys.begin(), keys.end());
+    do_not_optimize(bloom.contains(keys[0]));
+  });
+}
+
+void bloom_contains(State& st) {
+  filter_lookup(st, make_bloom(st.n()),
+                [](auto const& f, std::uint64_t q) { return f.contains(q); });
+}
+
+void bloom_contains_scalar(State& st) {
+  filter_lookup(st, make_bloom(st.n()),
+                [](auto const& f, std::uint64_t q) { return f.contains(isa::scalar, q); });
+}
+
+void bloom_batch(State& st) { filter_batch(st, make_bloom(st.n())); }
+
+template <class Filter>
+void static_build(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    Filter const f(keys.begin(), keys.end());
+    do_not_optimize(f.contains(keys[0]));
+  });
+}
+
+template <class Filter>
+void static_build_par(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    Filter const f(par, keys.begin(), keys.end());
+    do_not_optimize(f.contains(keys[0]));
+  });
+}
+
+template <class Filter>
+void static_contains(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  filter_lookup(st, Filter(keys.begin(), keys.end()),
+                [](auto const& f, std::uint64_t q) { return f.contains(q); });
+}
+
+template <class Filter>
+void static_batch(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  filter_batch(st, Filter(keys.begin(), keys.end()));
+}
+
+void hll_add(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    hyperloglog<std::uint64_t> counter;
+    counter.add(keys.begin(), keys.end());
+    do_not_optimize(counter.estimate());
+  });
+}
+
+// Merging dense counters of precision 18 (256 KB of registers).
+template <isa Which>
+void hll_merge(State& st) {
+  auto const keys = random_vector<std::uint64_t>(1 << 20);
+  hyperloglog<std::uint64_t> a(18), b(18);
+  for (std::size_t i = 0; i < keys.size(); ++i) (i % 2 ? a : b).add(keys[i]);
+  st.set_items_per_run(a.register_count());
+  st.set_bytes_per_item(1);
+  st.run([&] {
+    a.merge(Which, b);
+    do_not_optimize(&a);
+  });
+}
+
+using fuse8 = binary_fuse_filter<std::uint64_t>;
+using xor8 = xor_filter<std::uint64_t>;
+
+ALGORITMI_BENCH("filter/bloom_insert/u64", bloom_insert);
+ALGORITMI_BENCH("filter/bloom_contains/u64", bloom_contains);
+ALGORITMI_BENCH("filter/bloom_contains_scalar/u64", bloom_contains_scalar);
+ALGORITMI_BENCH("filter/bloom_batch/u64", bloom_batch);
+ALGORITMI_BENCH("filter/xor_build/u64", static_build<xor8>);
+ALGORITMI_BENCH("filter/binary_fuse_build/u64", static_build<fuse8>);
+ALGORITMI_BENCH("filter/binary_fuse_build_par/u64", static_build_par<fuse8>);
+ALGORITMI_BENCH("filter/xor_contains/u64", static_contains<xor8>);
+ALGORITMI_BENCH("filter/binary_fuse_contains/u64", static_contains<fuse8>);
+ALGORITMI_BENCH("filter/binary_fuse_batch/u64", static_batch<fuse8>);
+ALGORITMI_BENCH("filter/hyperloglog_add/u64", hll_add);
+ALGORITMI_BENCH("filter/hyperloglog_merge/avx2", hll_merge<isa::avx2>);
+ALGORITMI_BENCH("filter/hyperloglog_merge/scalar", hll_merge<isa::scalar>);
+
+}  // namespace
+}  // namespace algoritmi::bench
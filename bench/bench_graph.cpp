@@ -0,0 +1,161 @@
+// Graph benchmarks: n is the number of edges, over n / 16 vertices with
+// uniformly random endpoints and weights in [1, 1000]. ns/op is per edge.
+#include <algoritmi/graph.hpp>
+#include <algoritmi/memory.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t average_degree = 16;
+constexpr std::size_t max_edges = 10000000;
+
+std::vector<weighted_edge<std::uint32_t>> random_edges(std::size_t m) {
+  std::size_t const n = m / average_degree + 1;
+  Rng rng(m);
+  std::vector<weighted_edge<std::uint32_t>> edges(m);
+  for (auto& e : edges) {
+    e.from = static_cast<vertex_id>(rng.below(n));
+    e.to = static_cast<vertex_id>(rng.below(n));
+    e.weight = static_cast<std::uint32_t>(rng.below(1000) + 1);
+  }
+  return edges;
+}
+
+csr_graph<std::uint32_t> random_graph(std::size_t m, bool symmetric) {
+  auto const edges = random_edges(symmetric ? m / 2 : m);
+  return csr_graph<std::uint32_t>(m / average_degree + 1, edges, symmetric);
+}
+
+void build(State& st) {
+  auto const edges = random_edges(st.n());
+  st.set_bytes_per_item(sizeof(edges[0]));
+  st.run([&] {
+    csr_graph<std::uint32_t> g(st.n() / average_degree + 1, edges);
+    do_not_optimize(g.num_edges());
+  });
+}
+
+template <bool Parallel>
+void bfs_bench(State& st) {
+  auto const g = random_graph(st.n(), true);
+  st.set_items_per_run(g.num_edges());
+  st.set_bytes_per_item(sizeof(vertex_id));
+  st.run([&] {
+    if constexpr (Parallel)
+      do_not_optimize(bfs(par, g, 0).depth.data());
+    else
+      do_not_optimize(bfs(g, 0).depth.data());
+  });
+}
+
+// Repeated searches with all storage in an arena reset between runs.
+void bfs_arena(State& st) {
+  auto const g = random_graph(st.n(), true);
+  arena scratch;
+  st.set_items_per_run(g.num_edges());
+  st.set_bytes_per_item(sizeof(vertex_id));
+  st.run([&] { scratch.reset(); }, [&] { do_not_optimize(bfs(g, 0, &scratch).depth.data()); });
+}
+
+void bfs_top_down(State& st) {
+  auto const g = random_graph(st.n(), false);
+  st.set_items_per_run(g.num_edges());
+  st.set_bytes_per_item(sizeof(vertex_id));
+  st.run([&] { do_not_optimize(bfs(g, 0).depth.data()); });
+}
+
+void dijkstra_bench(State& st) {
+  auto const g = random_graph(st.n(), false);
+  st.set_items_per_run(g.num_edges());
+  st.set_bytes_per_item(sizeof(vertex_id) + sizeof(std::uint32_t));
+  st.run([&] { do_not_optimize(dijkstra(g, 0).data()); });
+}
+
+void dijkstra_arena(State& st) {
+  auto const g = random_graph(st.n(), false);
+  arena scratch;
+  st.set_items_per_run(g.num_edges());
+  st.set_bytes_per_item(sizeof(vertex_id) + sizeof(std::uint32_t));
+  st.run([&] { scratch.reset(); }, [&] { do_not_optimize(dijkstra(g, 0, &scratch).data()); });
+}
+
+template <bool Parallel>
+void delta_stepping_bench(State& st) {
+  auto const g = random_graph(st.n(), false);
+  st.set_items_per_run(g.num_edges());
+  st.set_bytes_per_item(sizeof(vertex_id) + sizeof(std::uint32_t));
+  st.run([&] {
+    if constexpr (Parallel)
+      do_not_optimize(delta_stepping(par, g, 0).data());
+    else
+      do_not_optimize(delta_stepping(g, 0).data());
+  });
+}
+
+// Union-find over the endpoints of every edge.
+template <bool Parallel>
+void components_bench(State& st) {
+  auto const weighted = random_edges(st.n());
+  std::vector<edge> edges(weighted.size());
+  for (std::size_t i = 0; i < edges.size(); ++i) edges[i] = {weighted[i].from, weighted[i].to};
+  std::size_t const n = st.n() / average_degree + 1;
+  st.set_bytes_per_item(sizeof(edge));
+  st.run([&] {
+    if constexpr (Parallel)
+      do_not_optimize(connected_components(par, n, edges).data());
+    else
+      do_not_optimize(connected_components(n, edges).data());
+  });
+}
+
+// MST algorithms on the same edge lists: Kruskal sorts every edge,
+// filter-Kruskal only those it cannot discard.
+template <class Mst>
+void mst_bench(State& st, Mst mst) {
+  auto const edges = random_edges(st.n());
+  std::size_t const n = st.n() / average_degree + 1;
+  st.set_bytes_per_item(sizeof(edges[0]));
+  st.run([&] { do_not_optimize(mst(n, edges.data(), edges.size()).data()); });
+}
+
+void kruskal_bench(State& st) {
+  mst_bench(st, [](std::size_t n, auto const* e, std::size_t m) { return kruskal(n, e, m); });
+}
+template <bool Parallel>
+void filter_kruskal_bench(State& st) {
+  mst_bench(st, [](std::size_t n, auto const* e, std::size_t m) {
+    return Parallel ? filter_kruskal(par, n, e, m) : filter_kruskal(n, e, m);
+  });
+}
+template <bool Parallel>
+void boruvka_bench(State& st) {
+  mst_bench(st, [](std::size_t n, auto const* e, std::size_t m) {
+    return Parallel ? boruvka(par, n, e, m) : boruvka(n, e, m);
+  });
+}
+
+ALGORITMI_BENCH("graph/csr_build", build, max_edges);
+ALGORITMI_BENCH("graph/bfs/top_down", bfs_top_down, max_edges);
+ALGORITMI_BENCH("graph/bfs/direction_optimizing", bfs_bench<false>, max_edges);
+ALGORITMI_BENCH("graph/bfs/direction_optimizing/arena", bfs_arena, max_edges);
+ALGORITMI_BENCH("graph/bfs_par/direction_optimizing", bfs_bench<true>, max_edges);
+ALGORITMI_BENCH("graph/dijkstra/radix_heap", dijkstra_bench, max_edges);
+ALGORITMI_BENCH("graph/dijkstra/radix_heap/arena", dijkstra_arena, max_edges);
+ALGORITMI_BENCH("graph/delta_stepping", delta_stepping_bench<false>, max_edges);
+ALGORITMI_BENCH("graph/delta_stepping_par", delta_stepping_bench<true>, max_edges);
+ALGORITMI_BENCH("graph/connected_components", components_bench<false>, max_edges);
+ALGORITMI_BENCH("graph/connected_components_par", components_bench<true>, max_edges);
+ALGORITMI_BENCH("graph/mst/kruskal", kruskal_bench, max_edges);
+ALGORITMI_BENCH("graph/mst/filter_kruskal", filter_kruskal_bench<false>, max_edges);
+ALGORITMI_BENCH("graph/mst/filter_kruskal_par", filter_kruskal_bench<true>, max_edges);
+ALGORITMI_BENCH("graph/mst/boruvka", boruvka_bench<false>, max_edges);
+ALGORITMI_BENCH("graph/mst/boruvka_par", boruvka_bench<true>, max_edges);
+
+}  // namespace
+}  // namespace algoritmi::bench
@@ -0,0 +1,152 @@
+// Hash map benchmarks against std::unordered_map.
+//
+//   insert          build a map of n random u64 keys from empty
+//   insert_reserve  same after reserve(n)
+//   find_hit        query_count lookups of present keys
+//   find_miss       query_count lookups of absent keys
+//   erase           erase all n keys in random order
+//   find_hit/string query_count lookups of present string keys, probing
+//                   by std::string_view (a std::string temporary for std)
+#include <algoritmi/hash.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t query_count = 1 << 16;
+constexpr std::size_t max_map = 10000000;
+
+using key = std::uint64_t;
+
+template <class Map>
+void insert(State& st) {
+  auto const keys = random_vector<key>(st.n());
+  st.set_bytes_per_item(sizeof(key) * 2);
+  st.run([&] {
+    Map m;
+    for (key k : keys) m.emplace(k, k);
+    do_not_optimize(m.size());
+  });
+}
+
+template <class Map>
+void insert_reserve(State& st) {
+  auto const keys = random_vector<key>(st.n());
+  st.set_bytes_per_item(sizeof(key) * 2);
+  st.run([&] {
+    Map m;
+    m.reserve(keys.size());
+    for (key k : keys) m.emplace(k, k);
+    do_not_optimize(m.size());
+  });
+}
+
+// Odd keys are present and even ones absent, so hits and misses come from
+// the same distribution.
+template <class Map, bool Hit>
+void find(State& st) {
+  auto keys = random_vector<key>(st.n());
+  Map m;
+  m.reserve(keys.size());
+  for (key& k : keys) m.emplace(k | 1, k);
+  Rng rng(7);
+  std::vector<key> queries(query_count);
+  for (auto& q : queries) q = Hit ? keys[rng.below(keys.size())] | 1 : rng.next() & ~key{1};
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(key));
+  st.run([&] {
+    std::size_t found = 0;
+    for (key q : queries) found += m.find(q) != m.end();
+    do_not_optimize(found);
+  });
+}
+
+template <class Map>
+void erase(State& st) {
+  auto const keys = random_vector<key>(st.n());
+  auto order = keys;
+  Rng rng(3);
+  for (std::size_t i = order.size(); i > 1; --i) std::swap(order[i - 1], order[rng.below(i)]);
+  Map m;
+  st.set_bytes_per_item(sizeof(key) * 2);
+  st.run(
+      [&] {
+        m.clear();
+        for (key k : keys) m.emplace(k, k);
+      },
+      [&] {
+        for (key k : order) m.erase(k);
+        do_not_optimize(m.size());
+      });
+}
+
+std::vector<std::string> string_keys(std::size_t n) {
+  Rng rng(5);
+  std::vector<std::string> keys(n);
+  for (auto& s : keys) s = "key/" + std::to_string(rng.next());
+  return keys;
+}
+
+template <class Map>
+void string_find(State& st) {
+  auto const keys = string_keys(st.n());
+  Map m;
+  m.reserve(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) m.emplace(keys[i], i);
+  Rng rng(7);
+  std::vector<std::string_view> queries(query_count);
+  for (auto& q : queries) q = keys[rng.below(keys.size())];
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(20);
+  st.run([&] {
+    std::size_t acc = 0;
+    for (std::string_view q : queries) {
+      if constexpr (std::is_same_v<Map, std::unordered_map<std::string, std::size_t>>)
+        acc += m.find(std::string(q))->second;
+      else
+        acc += m.find(q)->second;
+    }
+    do_not_optimize(acc);
+  });
+}
+
+using std_map = std::unordered_map<key, key>;
+using flat_map = flat_hash_map<key, key>;
+using node_map = node_hash_map<key, key>;
+
+ALGORITMI_BENCH("hash/std_unordered_map/insert/u64", insert<std_map>, max_map);
+ALGORITMI_BENCH("hash/flat_hash_map/insert/u64", insert<flat_map>, max_map);
+ALGORITMI_BENCH("hash/node_hash_map/insert/u64", insert<node_map>, max_map);
+
+ALGORITMI_BENCH("hash/std_unordered_map/insert_reserve/u64", insert_reserve<std_map>, max_map);
+ALGORITMI_BENCH("hash/flat_hash_map/insert_reserve/u64", insert_reserve<flat_map>, max_map);
+ALGORITMI_BENCH("hash/node_hash_map/insert_reserve/u64", insert_reserve<node_map>, max_map);
+
+ALGORITMI_BENCH("hash/std_unordered_map/find_hit/u64", (find<std_map, true>), max_map);
+ALGORITMI_BENCH("hash/flat_hash_map/find_hit/u64", (find<flat_map, true>), max_map);
+ALGORITMI_BENCH("hash/node_hash_map/find_hit/u64", (find<node_map, true>), max_map);
+
+ALGORITMI_BENCH("hash/std_unordered_map/find_miss/u64", (find<std_map, false>), max_map);
+ALGORITMI_BENCH("hash/flat_hash_map/find_miss/u64", (find<flat_map, false>), max_map);
+ALGORITMI_BENCH("hash/node_hash_map/find_miss/u64", (find<node_map, false>), max_map);
+
+ALGORITMI_BENCH("hash/std_unordered_map/erase/u64", erase<std_map>, max_map);
+ALGORITMI_BENCH("hash/flat_hash_map/erase/u64", erase<flat_map>, max_map);
+
+ALGORITMI_BENCH("hash/std_unordered_map/find_hit/string",
+                string_find<std::unordered_map<std::string, std::size_t>>, 1000000);
+ALGORITMI_BENCH("hash/flat_hash_map/find_hit/string",
+                string_find<flat_hash_map<std::string, std::size_t>>, 1000000);
+
+}  // namespace
+}  // namespace algoritmi::bench
@@ -0,0 +1,183 @@
+// Priority-queue benchmarks against std::priority_queue (as a min-heap).
+//
+//   fill_drain    push n random keys, then pop them all; ns/op per key
+//   hold          heap of n keys; each op pops the minimum and pushes it
+//                 back with a random increment (the classic event-queue
+//                 "hold" model, and monotone, so radix_heap qualifies)
+//   decrease_key  n keys, n decrease-key operations on random elements,
+//                 then drain; std::priority_queue emulates decrease-key by
+//                 pushing a duplicate and skipping stale entries on pop
+#include <algoritmi/heap.hpp>
+#include <algoritmi/memory.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t max_heap = 10000000;
+
+using key = std::uint64_t;
+
+struct std_queue {
+  std::priority_queue<key, std::vector<key>, std::greater<key>> q;
+  void push(key k) { q.push(k); }
+  key pop() {
+    key const k = q.top();
+    q.pop();
+    return k;
+  }
+  bool empty() const { return q.empty(); }
+};
+
+template <std::size_t D>
+struct dary {
+  dary_heap<key, D> q;
+  void push(key k) { q.push(k); }
+  key pop() { return q.pop(); }
+  bool empty() const { return q.empty(); }
+};
+
+struct radix {
+  struct none {};
+  radix_heap<key, none> q;
+  void push(key k) { q.push(k, none{}); }
+  key pop() { return q.pop().first; }
+  bool empty() const { return q.empty(); }
+};
+
+struct pairing {
+  pairing_heap<key> q;
+  void push(key k) { q.push(k); }
+  key pop() { return q.pop(); }
+  bool empty() const { return q.empty(); }
+};
+
+struct pairing_pooled {
+  fixed_pool pool{pairing_heap<key>::node_size, pairing_heap<key>::node_align, 1024};
+  pairing_heap<key> q{&pool};
+  void push(key k) { q.push(k); }
+  key pop() { return q.pop(); }
+  bool empty() const { return q.empty(); }
+};
+
+// Keys are kept below 2^48 so hold increments never overflow.
+constexpr key key_mask = (key{1} << 48) - 1;
+
+template <class Q>
+void fill_drain(State& st) {
+  auto keys = random_vector<key>(st.n());
+  for (auto& k : keys) k &= key_mask;
+  st.set_bytes_per_item(sizeof(key));
+  st.run([&] {
+    Q q;
+    for (key k : keys) q.push(k);
+    key sum = 0;
+    while (!q.empty()) sum += q.pop();
+    do_not_optimize(sum);
+  });
+}
+
+template <class Q>
+void hold(State& st) {
+  auto keys = random_vector<key>(st.n());
+  Q q;
+  for (key k : keys) q.push(k & key_mask);
+  Rng rng(7);
+  std::vector<key> increments(st.n());
+  for (auto& d : increments) d = rng.below(1u << 20);
+  st.set_bytes_per_item(sizeof(key));
+  st.run([&] {
+    for (key d : increments) q.push(q.pop() + d);
+    clobber_memory();
+  });
+}
+
+struct decrease_plan {
+  std::vector<key> initial;
+  std::vector<std::uint32_t> target;  // element to decrease
+  std::vector<key> amount;            // by how much (never below zero)
+};
+
+decrease_plan make_plan(std::size_t n) {
+  decrease_plan p{random_vector<key>(n), std::vector<std::uint32_t>(n), std::vector<key>(n)};
+  Rng rng(11);
+  for (auto& k : p.initial) k = (k & key_mask) | (key{1} << 47);
+  for (std::size_t i = 0; i < n; ++i) {
+    p.target[i] = static_cast<std::uint32_t>(rng.below(n));
+    p.amount[i] = rng.below(1u << 20);
+  }
+  return p;
+}
+
+void decrease_key_std(State& st) {
+  auto const plan = make_plan(st.n());
+  using entry = std::pair<key, std::uint32_t>;
+  st.set_bytes_per_item(sizeof(entry));
+  st.run([&] {
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> q;
+    std::vector<key> current(plan.initial);
+    for (std::uint32_t i = 0; i < current.size(); ++i) q.push({current[i], i});
+    for (std::size_t i = 0; i < plan.target.size(); ++i) {
+      std::uint32_t const t = plan.target[i];
+      current[t] -= plan.amount[i];
+      q.push({current[t], t});
+    }
+    key sum = 0;
+    while (!q.empty()) {
+      auto const [k, id] = q.top();
+      q.pop();
+      if (k == current[id]) sum += k;
+    }
+    do_not_optimize(sum);
+  });
+}
+
+template <bool Pooled>
+void decrease_key_pairing(State& st) {
+  auto const plan = make_plan(st.n());
+  using heap = pairing_heap<key>;
+  st.set_bytes_per_item(heap::node_size);
+  fixed_pool pool(heap::node_size, heap::node_align, 1024);
+  std::pmr::memory_resource* mr = Pooled ? &pool : std::pmr::get_default_resource();
+  std::vector<heap::handle> handles(st.n());
+  st.run([&] {
+    heap q(mr);
+    for (std::size_t i = 0; i < handles.size(); ++i) handles[i] = q.push(plan.initial[i]);
+    for (std::size_t i = 0; i < plan.target.size(); ++i) {
+      heap::handle const h = handles[plan.target[i]];
+      q.decrease_key(h, h.value() - plan.amount[i]);
+    }
+    key sum = 0;
+    while (!q.empty()) sum += q.pop();
+    do_not_optimize(sum);
+  });
+}
+
+ALGORITMI_BENCH("heap/std_priority_queue/fill_drain/u64", fill_drain<std_queue>, max_heap);
+ALGORITMI_BENCH("heap/dary_heap2/fill_drain/u64", fill_drain<dary<2>>, max_heap);
+ALGORITMI_BENCH("heap/dary_heap4/fill_drain/u64", fill_drain<dary<4>>, max_heap);
+ALGORITMI_BENCH("heap/dary_heap8/fill_drain/u64", fill_drain<dary<8>>, max_heap);
+ALGORITMI_BENCH("heap/radix_heap/fill_drain/u64", fill_drain<radix>, max_heap);
+ALGORITMI_BENCH("heap/pairing_heap/fill_drain/u64", fill_drain<pairing>, max_heap);
+ALGORITMI_BENCH("heap/pairing_heap_pool/fill_drain/u64", fill_drain<pairing_pooled>, max_heap);
+
+ALGORITMI_BENCH("heap/std_priority_queue/hold/u64", hold<std_queue>, max_heap);
+ALGORITMI_BENCH("heap/dary_heap2/hold/u64", hold<dary<2>>, max_heap);
+ALGORITMI_BENCH("heap/dary_heap4/hold/u64", hold<dary<4>>, max_heap);
+ALGORITMI_BENCH("heap/dary_heap8/hold/u64", hold<dary<8>>, max_heap);
+ALGORITMI_BENCH("heap/radix_heap/hold/u64", hold<radix>, max_heap);
+ALGORITMI_BENCH("heap/pairing_heap/hold/u64", hold<pairing>, max_heap);
+
+ALGORITMI_BENCH("heap/std_priority_queue/decrease_key/u64", decrease_key_std, max_heap);
+ALGORITMI_BENCH("heap/pairing_heap/decrease_key/u64", decrease_key_pairing<false>, max_heap);
+ALGORITMI_BENCH("heap/pairing_heap_pool/decrease_key/u64", decrease_key_pairing<true>, max_heap);
+
+}  // namespace
+}  // namespace algoritmi::bench
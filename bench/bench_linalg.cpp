@@ -0,0 +1,133 @@
+// Dense matrix benchmarks. n is the number of elements of the square
+// output, so the side is sqrt(n); multiplies report ns per multiply-add
+// (side^3 of them), transposes ns per element.
+//
+//   gemm        packed AVX2/FMA gemm, portable micro-kernel, par, and the
+//               naive i-k-j triple loop for reference
+//   multiply    Strassen above strassen_cutoff, and one level forced
+//   transpose   cache-oblivious, par, and the naive double loop
+#include <algoritmi/linalg.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+// side^3 multiply-adds: about a second per run at the largest sizes.
+constexpr std::size_t max_gemm_n = 10000000;
+constexpr std::size_t max_naive_n = 1000000;
+
+std::size_t side_of(std::size_t n) {
+  return static_cast<std::size_t>(std::sqrt(static_cast<double>(n)));
+}
+
+template <class T>
+matrix<T> random_matrix(std::size_t side, std::uint64_t seed) {
+  auto const values = random_vector<std::uint32_t>(side * side, seed);
+  matrix<T> m(side, side);
+  for (std::size_t i = 0; i < values.size(); ++i) m.data()[i] = static_cast<T>(values[i] >> 8);
+  return m;
+}
+
+template <class T, class Multiply>
+void multiply_bench(State& st, Multiply multiply) {
+  std::size_t const side = side_of(st.n());
+  auto const a = random_matrix<T>(side, 1), b = random_matrix<T>(side, 2);
+  matrix<T> c(side, side);
+  st.set_items_per_run(side * side * side);
+  st.set_bytes_per_item(0);
+  st.run([&] {
+    multiply(a, b, c);
+    do_not_optimize(c.data());
+  });
+}
+
+template <class T, isa Which>
+void gemm_isa(State& st) {
+  multiply_bench<T>(st, [](auto const& a, auto const& b, auto& c) {
+    gemm(Which, T{1}, a, b, T{0}, c);
+  });
+}
+
+template <class T>
+void gemm_par(State& st) {
+  multiply_bench<T>(st, [](auto const& a, auto const& b, auto& c) {
+    gemm(par, T{1}, a, b, T{0}, c);
+  });
+}
+
+template <class T>
+void gemm_naive(State& st) {
+  multiply_bench<T>(st, [](auto const& a, auto const& b, auto& c) {
+    std::size_t const n = a.rows();
+    std::fill(c.data(), c.data() + n * n, T{});
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t p = 0; p < n; ++p)
+        for (std::size_t j = 0; j < n; ++j) c(i, j) += a(i, p) * b(p, j);
+  });
+}
+
+template <class T>
+void multiply_auto(State& st) {
+  multiply_bench<T>(st, [](auto const& a, auto const& b, auto& c) { c = multiply(a, b); });
+}
+
+template <class T>
+void strassen_one_level(State& st) {
+  multiply_bench<T>(st, [](auto const& a, auto const& b, auto& c) {
+    c = strassen_multiply(a, b, a.rows() / 2);
+  });
+}
+
+template <class Transpose>
+void transpose_bench(State& st, Transpose transpose) {
+  std::size_t const side = side_of(st.n());
+  auto const a = random_matrix<double>(side, 3);
+  matrix<double> b(side, side);
+  st.set_items_per_run(side * side);
+  st.set_bytes_per_item(2 * sizeof(double));
+  st.run([&] {
+    transpose(a, b);
+    do_not_optimize(b.data());
+  });
+}
+
+void transpose_oblivious(State& st) {
+  transpose_bench(st, [](matrix<double> const& a, matrix<double>& b) {
+    transpose<double>(a, b.view());
+  });
+}
+
+void transpose_par(State& st) {
+  transpose_bench(st, [](matrix<double> const& a, matrix<double>& b) {
+    transpose<double>(par, a, b.view());
+  });
+}
+
+void transpose_naive(State& st) {
+  transpose_bench(st, [](matrix<double> const& a, matrix<double>& b) {
+    for (std::size_t i = 0; i < a.rows(); ++i)
+      for (std::size_t j = 0; j < a.cols(); ++j) b(j, i) = a(i, j);
+  });
+}
+
+ALGORITMI_BENCH("linalg/gemm/f64", gemm_isa<double, isa::avx2>, max_gemm_n);
+ALGORITMI_BENCH("linalg/gemm/f32", gemm_isa<float, isa::avx2>, max_gemm_n);
+ALGORITMI_BENCH("linalg/gemm_scalar/f64", gemm_isa<double, isa::scalar>, max_gemm_n);
+ALGORITMI_BENCH("linalg/gemm_par/f64", gemm_par<double>, max_gemm_n);
+ALGORITMI_BENCH("linalg/gemm_naive/f64", gemm_naive<double>, max_naive_n);
+ALGORITMI_BENCH("linalg/multiply/f64", multiply_auto<double>, max_gemm_n);
+ALGORITMI_BENCH("linalg/strassen_one_level/f64", strassen_one_level<double>, max_gemm_n);
+ALGORITMI_BENCH("linalg/transpose/f64", transpose_oblivious);
+ALGORITMI_BENCH("linalg/transpose_par/f64", transpose_par);
+ALGORITMI_BENCH("linalg/transpose_naive/f64", transpose_naive);
+
+}  // namespace
+}  // namespace algoritmi::bench
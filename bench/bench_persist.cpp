@@ -0,0 +1,163 @@
+// Index file benchmarks: getting a queryable structure at startup by
+// rebuilding it versus opening a saved one.
+//
+//   build_*   build from the sorted keys or key/value pairs already in memory
+//   open_*    open the index file, load the structure and answer one query;
+//             the file is in the page cache, so this is the warm-restart cost
+//   save_*    write the structure and commit the file
+//   *_mapped  lookups on the loaded structure, against search/ and hash/
+#include <algoritmi/persist.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t max_n = 100000000;
+constexpr std::size_t query_count = 1 << 16;
+
+std::filesystem::path temp_index(char const* what) {
+  return std::filesystem::temp_directory_path() / (std::string("algoritmi_bench_") + what + ".idx");
+}
+
+// Removes the file when the benchmark is done.
+struct temp_file {
+  std::filesystem::path path;
+  ~temp_file() {
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+  }
+};
+
+std::vector<std::uint64_t> sorted_keys(std::size_t n) {
+  auto keys = random_vector<std::uint64_t>(n);
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+flat_hash_map<std::uint64_t, std::uint64_t> make_map(std::vector<std::uint64_t> const& keys) {
+  flat_hash_map<std::uint64_t, std::uint64_t> m;
+  m.reserve(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) m.try_emplace(keys[i], i);
+  return m;
+}
+
+void build_tree(State& st) {
+  auto const keys = sorted_keys(st.n());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    static_search_tree<std::uint64_t> const t(keys.begin(), keys.end());
+    do_not_optimize(t.lower_bound(keys[keys.size() / 2]));
+  });
+}
+
+void save_tree(State& st) {
+  auto const keys = sorted_keys(st.n());
+  static_search_tree<std::uint64_t> const t(keys.begin(), keys.end());
+  temp_file const file{temp_index("save_tree")};
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    index_writer w(file.path);
+    save(w, "keys", t);
+    w.commit();
+  });
+}
+
+void open_tree(State& st) {
+  auto const keys = sorted_keys(st.n());
+  temp_file const file{temp_index("open_tree")};
+  {
+    index_writer w(file.path);
+    save(w, "keys", static_search_tree<std::uint64_t>(keys.begin(), keys.end()));
+    w.commit();
+  }
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    index_file const f(file.path);
+    auto const t = load<static_search_tree<std::uint64_t>>(f, "keys");
+    do_not_optimize(t.lower_bound(keys[keys.size() / 2]));
+  });
+}
+
+void tree_mapped(State& st) {
+  auto const keys = sorted_keys(st.n());
+  temp_file const file{temp_index("tree_mapped")};
+  {
+    index_writer w(file.path);
+    save(w, "keys", static_search_tree<std::uint64_t>(keys.begin(), keys.end()));
+    w.commit();
+  }
+  index_file const f(file.path);
+  auto const t = load<static_search_tree<std::uint64_t>>(f, "keys");
+  auto const queries = random_vector<std::uint64_t>(query_count, 7);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (std::uint64_t q : queries) acc += t.lower_bound(q);
+    do_not_optimize(acc);
+  });
+}
+
+void build_map(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  st.set_bytes_per_item(2 * sizeof(std::uint64_t));
+  st.run([&] { do_not_optimize(make_map(keys).size()); });
+}
+
+void open_map(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  temp_file const file{temp_index("open_map")};
+  {
+    index_writer w(file.path);
+    save(w, "map", make_map(keys));
+    w.commit();
+  }
+  st.set_bytes_per_item(2 * sizeof(std::uint64_t));
+  st.run([&] {
+    index_file const f(file.path);
+    auto const m = load<flat_hash_map_view<std::uint64_t, std::uint64_t>>(f, "map");
+    do_not_optimize(m.find(keys[keys.size() / 2]));
+  });
+}
+
+void map_mapped(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  temp_file const file{temp_index("map_mapped")};
+  {
+    index_writer w(file.path);
+    save(w, "map", make_map(keys));
+    w.commit();
+  }
+  index_file const f(file.path);
+  auto const m = load<flat_hash_map_view<std::uint64_t, std::uint64_t>>(f, "map");
+  // Half hits, half misses.
+  auto queries = random_vector<std::uint64_t>(query_count, 7);
+  for (std::size_t i = 0; i < queries.size(); i += 2) queries[i] = keys[queries[i] % keys.size()];
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(2 * sizeof(std::uint64_t));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (std::uint64_t q : queries) acc += m.find(q) != nullptr;
+    do_not_optimize(acc);
+  });
+}
+
+ALGORITMI_BENCH("persist/build_static_tree/u64", build_tree, max_n);
+ALGORITMI_BENCH("persist/save_static_tree/u64", save_tree, max_n);
+ALGORITMI_BENCH("persist/open_static_tree/u64", open_tree, max_n);
+ALGORITMI_BENCH("persist/static_tree_mapped/u64", tree_mapped, max_n);
+
+ALGORITMI_BENCH("persist/build_flat_hash_map/u64", build_map, max_n);
+ALGORITMI_BENCH("persist/open_flat_hash_map/u64", open_map, max_n);
+ALGORITMI_BENCH("persist/flat_hash_map_mapped/u64", map_mapped, max_n);
+
+}  // namespace
+}  // namespace algoritmi::bench
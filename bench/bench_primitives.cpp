@@ -0,0 +1,156 @@
+// Parallel primitive benchmarks against the standard library.
+//
+//   inclusive_scan    prefix sums of n u32/u64 (std::inclusive_scan, the
+//                     SIMD kernel, and the look-back scan under par)
+//   reduce            sum of n u32
+//   copy_if           keep the elements below the median, about half
+//   stable_partition  same predicate, in place
+//   histogram         n bytes into 256 bins
+#include <algoritmi/primitives.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t max_n = 100000000;
+
+template <class T>
+void std_scan(State& st) {
+  auto const in = random_vector<T>(st.n());
+  std::vector<T> out(in.size());
+  st.set_bytes_per_item(2 * sizeof(T));
+  st.run([&] {
+    std::inclusive_scan(in.begin(), in.end(), out.begin());
+    do_not_optimize(out.back());
+  });
+}
+
+template <class T, bool Par>
+void simd_scan(State& st) {
+  auto const in = random_vector<T>(st.n());
+  std::vector<T> out(in.size());
+  st.set_bytes_per_item(2 * sizeof(T));
+  st.run([&] {
+    if constexpr (Par)
+      inclusive_scan(par, in.data(), in.size(), out.data());
+    else
+      inclusive_scan(in.data(), in.size(), out.data());
+    do_not_optimize(out.back());
+  });
+}
+
+void std_reduce(State& st) {
+  auto const in = random_vector<std::uint32_t>(st.n());
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] { do_not_optimize(std::reduce(in.begin(), in.end(), std::uint32_t{0})); });
+}
+
+template <bool Par>
+void simd_reduce(State& st) {
+  auto const in = random_vector<std::uint32_t>(st.n());
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] {
+    if constexpr (Par)
+      do_not_optimize(reduce(par, in.data(), in.size()));
+    else
+      do_not_optimize(reduce(in.data(), in.size()));
+  });
+}
+
+constexpr auto below_half = [](std::uint32_t x) { return x < 0x80000000u; };
+
+void std_copy_if(State& st) {
+  auto const in = random_vector<std::uint32_t>(st.n());
+  std::vector<std::uint32_t> out(in.size());
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] {
+    auto const end = std::copy_if(in.begin(), in.end(), out.begin(), below_half);
+    do_not_optimize(end);
+  });
+}
+
+template <bool Par>
+void flag_copy_if(State& st) {
+  auto const in = random_vector<std::uint32_t>(st.n());
+  std::vector<std::uint32_t> out(in.size());
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] {
+    if constexpr (Par)
+      do_not_optimize(copy_if(par, in.data(), in.size(), out.data(), below_half));
+    else
+      do_not_optimize(copy_if(in.data(), in.size(), out.data(), below_half));
+  });
+}
+
+template <int Impl>  // 0 std, 1 algoritmi, 2 algoritmi par
+void partition(State& st) {
+  auto const in = random_vector<std::uint32_t>(st.n());
+  std::vector<std::uint32_t> data(in.size());
+  st.set_bytes_per_item(sizeof(std::uint32_t));
+  st.run([&] { std::copy(in.begin(), in.end(), data.begin()); },
+         [&] {
+           if constexpr (Impl == 0)
+             do_not_optimize(std::stable_partition(data.begin(), data.end(), below_half));
+           else if constexpr (Impl == 1)
+             do_not_optimize(stable_partition(data.data(), data.size(), below_half));
+           else
+             do_not_optimize(stable_partition(par, data.data(), data.size(), below_half));
+         });
+}
+
+void naive_histogram(State& st) {
+  auto const in = random_vector<std::uint8_t>(st.n());
+  std::vector<std::size_t> counts(256);
+  st.set_bytes_per_item(1);
+  st.run([&] {
+    std::fill(counts.begin(), counts.end(), 0);
+    for (std::uint8_t b : in) ++counts[b];
+    do_not_optimize(counts.data());
+  });
+}
+
+template <bool Par>
+void split_histogram(State& st) {
+  auto const in = random_vector<std::uint8_t>(st.n());
+  st.set_bytes_per_item(1);
+  st.run([&] {
+    if constexpr (Par)
+      do_not_optimize(histogram(par, in.data(), in.size(), 256).data());
+    else
+      do_not_optimize(histogram(in.data(), in.size(), 256).data());
+  });
+}
+
+ALGORITMI_BENCH("primitives/std_inclusive_scan/u32", std_scan<std::uint32_t>, max_n);
+ALGORITMI_BENCH("primitives/inclusive_scan/u32", (simd_scan<std::uint32_t, false>), max_n);
+ALGORITMI_BENCH("primitives/inclusive_scan_par/u32", (simd_scan<std::uint32_t, true>), max_n);
+ALGORITMI_BENCH("primitives/std_inclusive_scan/u64", std_scan<std::uint64_t>, max_n);
+ALGORITMI_BENCH("primitives/inclusive_scan/u64", (simd_scan<std::uint64_t, false>), max_n);
+ALGORITMI_BENCH("primitives/inclusive_scan_par/u64", (simd_scan<std::uint64_t, true>), max_n);
+
+ALGORITMI_BENCH("primitives/std_reduce/u32", std_reduce, max_n);
+ALGORITMI_BENCH("primitives/reduce/u32", simd_reduce<false>, max_n);
+ALGORITMI_BENCH("primitives/reduce_par/u32", simd_reduce<true>, max_n);
+
+ALGORITMI_BENCH("primitives/std_copy_if/u32", std_copy_if, max_n);
+ALGORITMI_BENCH("primitives/copy_if/u32", flag_copy_if<false>, max_n);
+ALGORITMI_BENCH("primitives/copy_if_par/u32", flag_copy_if<true>, max_n);
+
+ALGORITMI_BENCH("primitives/std_stable_partition/u32", partition<0>, max_n);
+ALGORITMI_BENCH("primitives/stable_partition/u32", partition<1>, max_n);
+ALGORITMI_BENCH("primitives/stable_partition_par/u32", partition<2>, max_n);
+
+ALGORITMI_BENCH("primitives/naive_histogram/u8", naive_histogram, max_n);
+ALGORITMI_BENCH("primitives/histogram/u8", split_histogram<false>, max_n);
+ALGORITMI_BENCH("primitives/histogram_par/u8", split_histogram<true>, max_n);
+
+}  // namespace
+}  // namespace algoritmi::bench
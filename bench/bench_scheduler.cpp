@@ -0,0 +1,64 @@
+// Scheduler overhead.
+//
+//   parallel_for/spawn   n empty tasks on threads started for the call, the
+//                        way parallel algorithms ran before the scheduler
+//   parallel_for/pool    n empty tasks on default_scheduler()
+//   fork_join/fib        parallel_invoke recursion down to n leaves
+#include <algoritmi/scheduler.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t max_tasks = 10000000;
+
+void spawn(State& st) {
+  unsigned const threads = default_scheduler().concurrency();
+  st.run([&] {
+    std::atomic<std::size_t> next{0}, sum{0};
+    auto worker = [&] {
+      std::size_t local = 0;
+      for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < st.n();) local += i;
+      sum.fetch_add(local, std::memory_order_relaxed);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    do_not_optimize(sum.load());
+  });
+}
+
+void pool(State& st) {
+  std::atomic<std::size_t> sum{0};
+  st.run([&] {
+    parallel_for(par, 0, st.n(), [&](std::size_t i) {
+      sum.fetch_add(i, std::memory_order_relaxed);
+    }, 1024);
+    do_not_optimize(sum.load());
+  });
+}
+
+std::size_t leaves(std::size_t n) {
+  if (n <= 1) return n;
+  std::size_t a = 0, b = 0;
+  parallel_invoke([&] { a = leaves(n / 2); }, [&] { b = leaves(n - n / 2); });
+  return a + b;
+}
+
+void fib(State& st) {
+  st.run([&] { do_not_optimize(leaves(st.n())); });
+}
+
+ALGORITMI_BENCH("scheduler/parallel_for/spawn", spawn, max_tasks);
+ALGORITMI_BENCH("scheduler/parallel_for/pool", pool, max_tasks);
+ALGORITMI_BENCH("scheduler/fork_join/fib", fib, 1000000);
+
+}  // namespace
+}  // namespace algoritmi::bench
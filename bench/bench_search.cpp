@@ -0,0 +1,115 @@
+#include <algoritmi/search.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t query_count = 1 << 16;
+
+template <class T, class Lookup>
+void lookup_bench(State& st, Lookup lookup) {
+  auto keys = random_vector<T>(st.n());
+  std::sort(keys.begin(), keys.end());
+  auto const queries = random_vector<T>(query_count, 7);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (T q : queries) acc += lookup(keys, q);
+    do_not_optimize(acc);
+  });
+}
+
+template <class T>
+void simd_lower_bound(State& st) {
+  lookup_bench<T>(st, [](std::vector<T> const& k, T q) { return lower_bound(k.data(), k.size(), q); });
+}
+
+template <class T>
+void branchless(State& st) {
+  lookup_bench<T>(st, [](std::vector<T> const& k, T q) {
+    return static_cast<std::size_t>(branchless_lower_bound(k.begin(), k.end(), q) - k.begin());
+  });
+}
+
+template <class T>
+void eytzinger(State& st) {
+  auto keys = random_vector<T>(st.n());
+  std::sort(keys.begin(), keys.end());
+  eytzinger_index<T> const index(keys.begin(), keys.end());
+  auto const queries = random_vector<T>(query_count, 7);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (T q : queries) acc += index.lower_bound(q);
+    do_not_optimize(acc);
+  });
+}
+
+template <class T>
+void stree(State& st) {
+  auto keys = random_vector<T>(st.n());
+  std::sort(keys.begin(), keys.end());
+  static_search_tree<T> const index(keys.begin(), keys.end());
+  auto const queries = random_vector<T>(query_count, 7);
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] {
+    std::size_t acc = 0;
+    for (T q : queries) acc += index.lower_bound(q);
+    do_not_optimize(acc);
+  });
+}
+
+template <class T>
+void stree_batch(State& st) {
+  auto keys = random_vector<T>(st.n());
+  std::sort(keys.begin(), keys.end());
+  static_search_tree<T> const index(keys.begin(), keys.end());
+  auto const queries = random_vector<T>(query_count, 7);
+  std::vector<std::size_t> out(queries.size());
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] {
+    index.lower_bound_batch(queries.data(), queries.size(), out.data());
+    do_not_optimize(out.data());
+  });
+}
+
+// Scans the whole array: the key is absent.
+template <class T>
+void find_first_miss(State& st) {
+  std::vector<T> v(st.n(), T{1});
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { do_not_optimize(find_first(v.data(), v.size(), T{0})); });
+}
+
+template <class T>
+void std_find_miss(State& st) {
+  std::vector<T> v(st.n(), T{1});
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { do_not_optimize(std::find(v.begin(), v.end(), T{0})); });
+}
+
+ALGORITMI_BENCH("search/lower_bound/u32", simd_lower_bound<std::uint32_t>);
+ALGORITMI_BENCH("search/lower_bound/u64", simd_lower_bound<std::uint64_t>);
+ALGORITMI_BENCH("search/branchless_lower_bound/u32", branchless<std::uint32_t>);
+ALGORITMI_BENCH("search/eytzinger/u32", eytzinger<std::uint32_t>);
+ALGORITMI_BENCH("search/eytzinger/u64", eytzinger<std::uint64_t>);
+ALGORITMI_BENCH("search/static_tree/u32", stree<std::uint32_t>);
+ALGORITMI_BENCH("search/static_tree/u64", stree<std::uint64_t>);
+ALGORITMI_BENCH("search/static_tree_batch/u32", stree_batch<std::uint32_t>);
+ALGORITMI_BENCH("search/static_tree_batch/u64", stree_batch<std::uint64_t>);
+ALGORITMI_BENCH("search/find_first/u32", find_first_miss<std::uint32_t>);
+ALGORITMI_BENCH("search/find_first/u64", find_first_miss<std::uint64_t>);
+ALGORITMI_BENCH("baseline/std::find/u32", std_find_miss<std::uint32_t>);
+
+}  // namespace
+}  // namespace algoritmi::bench
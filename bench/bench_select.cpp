@@ -0,0 +1,99 @@
+#include <algoritmi/select.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+template <class T, class Select>
+void select_bench(State& st, Select select) {
+  auto const input = random_vector<T>(st.n());
+  std::vector<T> v;
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { v = input; }, [&] {
+    select(v);
+    do_not_optimize(v.data());
+  });
+}
+
+// The median, the hardest rank for selection.
+template <class T>
+void median(State& st) {
+  select_bench<T>(st, [](std::vector<T>& v) {
+    algoritmi::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+  });
+}
+
+template <class T>
+void p99(State& st) {
+  select_bench<T>(st, [](std::vector<T>& v) {
+    algoritmi::nth_element(v.begin(), v.begin() + v.size() / 100 * 99, v.end());
+  });
+}
+
+// Without the SIMD kernels: a comparator they do not recognise.
+template <class T>
+void median_generic(State& st) {
+  select_bench<T>(st, [](std::vector<T>& v) {
+    algoritmi::nth_element(v.begin(), v.begin() + v.size() / 2, v.end(),
+                           [](T a, T b) { return a < b; });
+  });
+}
+
+template <class T>
+void median_std(State& st) {
+  select_bench<T>(st, [](std::vector<T>& v) {
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+  });
+}
+
+// p50, p90, p99 and p999 of one array.
+template <class T>
+void percentiles(State& st) {
+  static constexpr double qs[] = {0.5, 0.9, 0.99, 0.999};
+  select_bench<T>(st, [](std::vector<T>& v) {
+    auto const q = algoritmi::quantiles(v.begin(), v.end(), span<double const>(qs, 4));
+    do_not_optimize(q.data());
+  });
+}
+
+void kll_update(State& st) {
+  auto const input = random_vector<double>(st.n());
+  st.set_bytes_per_item(sizeof(double));
+  st.run([&] {
+    kll_sketch<double> sketch;
+    for (double x : input) sketch.update(x);
+    do_not_optimize(sketch.quantile(0.99));
+  });
+}
+
+void tdigest_add(State& st) {
+  auto const input = random_vector<double>(st.n());
+  st.set_bytes_per_item(sizeof(double));
+  st.run([&] {
+    tdigest digest;
+    for (double x : input) digest.add(x);
+    do_not_optimize(digest.quantile(0.99));
+  });
+}
+
+ALGORITMI_BENCH("select/nth_element/u32", median<std::uint32_t>);
+ALGORITMI_BENCH("select/nth_element/u64", median<std::uint64_t>);
+ALGORITMI_BENCH("select/nth_element/f64", median<double>);
+ALGORITMI_BENCH("select/nth_element_p99/u32", p99<std::uint32_t>);
+ALGORITMI_BENCH("select/nth_element_generic/u32", median_generic<std::uint32_t>);
+ALGORITMI_BENCH("select/nth_element_generic/f64", median_generic<double>);
+ALGORITMI_BENCH("select/std_nth_element/u32", median_std<std::uint32_t>);
+ALGORITMI_BENCH("select/std_nth_element/f64", median_std<double>);
+ALGORITMI_BENCH("select/quantiles/f64", percentiles<double>);
+ALGORITMI_BENCH("select/kll_sketch/f64", kll_update);
+ALGORITMI_BENCH("select/tdigest/f64", tdigest_add);
+
+}  // namespace
+}  // namespace algoritmi::bench
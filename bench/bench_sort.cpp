@@ -0,0 +1,152 @@
+#include <algoritmi/memory.hpp>
+#include <algoritmi/sort.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+struct Record {
+  std::uint64_t key;
+  std::uint64_t payload;
+};
+
+struct by_key {
+  std::uint64_t operator()(Record const& r) const noexcept { return r.key; }
+};
+
+template <class T, class Sort>
+void sort_bench(State& st, Sort sort) {
+  auto const input = random_vector<T>(st.n());
+  std::vector<T> v;
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { v = input; }, [&] { sort(v); });
+}
+
+template <class T>
+void radix(State& st) {
+  sort_bench<T>(st, [](std::vector<T>& v) { radix_sort(v.begin(), v.end()); });
+}
+
+// Scratch from an arena that is reset between runs: no heap allocations.
+template <class T>
+void radix_arena(State& st) {
+  auto const input = random_vector<T>(st.n());
+  std::vector<T> v;
+  arena scratch;
+  st.set_bytes_per_item(sizeof(T));
+  st.run(
+      [&] {
+        v = input;
+        scratch.reset();
+      },
+      [&] { radix_sort(v.begin(), v.end(), identity_key{}, &scratch); });
+}
+
+template <class T>
+void radix_par(State& st) {
+  sort_bench<T>(st, [](std::vector<T>& v) { radix_sort(par, v.begin(), v.end()); });
+}
+
+template <class T>
+void pdq(State& st) {
+  sort_bench<T>(st, [](std::vector<T>& v) { pdqsort(v.begin(), v.end()); });
+}
+
+template <class T>
+void pdq_par(State& st) {
+  sort_bench<T>(st, [](std::vector<T>& v) { pdqsort(par, v.begin(), v.end()); });
+}
+
+// Consecutive groups of 1 to small_sort_max random keys, each sorted on its
+// own, as when finishing buckets or ordering the values of each group in an
+// aggregation. ns/op is per key.
+template <class T, class Sort>
+void groups_bench(State& st, Sort sort) {
+  auto const input = random_vector<T>(st.n());
+  std::vector<std::size_t> bounds{0};
+  Rng rng(st.n());
+  while (bounds.back() < st.n())
+    bounds.push_back(std::min(st.n(), bounds.back() + 1 + rng.below(small_sort_max)));
+  std::vector<T> v;
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { v = input; },
+         [&] {
+           for (std::size_t g = 1; g < bounds.size(); ++g)
+             sort(v.data() + bounds[g - 1], v.data() + bounds[g]);
+         });
+}
+
+template <class T>
+void small(State& st) {
+  groups_bench<T>(st, [](T* first, T* last) { small_sort(first, last); });
+}
+
+template <class T>
+void std_small(State& st) {
+  groups_bench<T>(st, [](T* first, T* last) { std::sort(first, last); });
+}
+
+// File to file through the page cache. The budget is an eighth of the
+// input, so large inputs form 24 radix-sorted runs and merge them in one
+// pass; small ones fit in a single run.
+template <class T, class Compare>
+void external(State& st) {
+  namespace fs = std::filesystem;
+  fs::path const dir = fs::temp_directory_path();
+  fs::path const in = dir / "algoritmi-bench-external.in";
+  fs::path const out = dir / "algoritmi-bench-external.out";
+  {
+    auto const input = random_vector<T>(st.n());
+    std::ofstream f(in, std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<char const*>(input.data()),
+            static_cast<std::streamsize>(input.size() * sizeof(T)));
+  }
+  external_sort_options options;
+  options.memory_budget = std::max<std::size_t>(st.n() * sizeof(T) / 8, std::size_t{1} << 16);
+  st.set_bytes_per_item(sizeof(T));
+  st.run([&] { external_sort<T>(in, out, Compare(), options); });
+  fs::remove(in);
+  fs::remove(out);
+}
+
+void radix_records(State& st) {
+  auto const keys = random_vector<std::uint64_t>(st.n());
+  std::vector<Record> input(st.n());
+  for (std::size_t i = 0; i < input.size(); ++i) input[i] = {keys[i], i};
+  std::vector<Record> v;
+  st.set_bytes_per_item(sizeof(Record));
+  st.run([&] { v = input; }, [&] { radix_sort(v.begin(), v.end(), by_key{}); });
+}
+
+ALGORITMI_BENCH("sort/radix_sort/u32", radix<std::uint32_t>);
+ALGORITMI_BENCH("sort/radix_sort/u64", radix<std::uint64_t>);
+ALGORITMI_BENCH("sort/radix_sort/u64/arena", radix_arena<std::uint64_t>);
+ALGORITMI_BENCH("sort/radix_sort/f64", radix<double>);
+ALGORITMI_BENCH("sort/radix_sort/record16", radix_records);
+ALGORITMI_BENCH("sort/radix_sort_par/u32", radix_par<std::uint32_t>);
+ALGORITMI_BENCH("sort/radix_sort_par/u64", radix_par<std::uint64_t>);
+ALGORITMI_BENCH("sort/pdqsort/u32", pdq<std::uint32_t>);
+ALGORITMI_BENCH("sort/pdqsort/u64", pdq<std::uint64_t>);
+ALGORITMI_BENCH("sort/pdqsort/f64", pdq<double>);
+ALGORITMI_BENCH("sort/small_sort/u32", small<std::uint32_t>);
+ALGORITMI_BENCH("sort/small_sort/u64", small<std::uint64_t>);
+ALGORITMI_BENCH("sort/small_sort/f64", small<double>);
+ALGORITMI_BENCH("sort/std_sort_small/u32", std_small<std::uint32_t>);
+ALGORITMI_BENCH("sort/std_sort_small/u64", std_small<std::uint64_t>);
+ALGORITMI_BENCH("sort/pdqsort_par/u64", pdq_par<std::uint64_t>);
+ALGORITMI_BENCH("sort/external_sort/u64", (external<std::uint64_t, std::less<std::uint64_t>>),
+                100000000);
+ALGORITMI_BENCH("sort/external_sort_pdq/u64", (external<std::uint64_t, std::greater<std::uint64_t>>),
+                100000000);
+
+}  // namespace
+}  // namespace algoritmi::bench
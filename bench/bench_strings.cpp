@@ -0,0 +1,130 @@
+// String algorithm benchmarks against the standard library.
+//
+//   find_substring  a 16-byte pattern that only occurs at the end of n bytes
+//                   of log-like text (lowercase words, digits, separators)
+//   aho_corasick    n bytes of the same text against 64 keywords that start
+//                   with uppercase letters (the root prefilter on), and
+//                   1024 lowercase words (prefilter off)
+//   suffix_array    SA-IS against sorting suffixes with std::sort
+//   lcp_array       Kasai over the suffix array of the same text
+#include <algoritmi/strings.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t max_n = 100000000;
+// A suffix array and its scratch take about 16 bytes per text byte.
+constexpr std::size_t max_index_n = 10000000;
+// Sorting suffixes with std::sort compares long prefixes; keep it short.
+constexpr std::size_t max_sort_n = 1000000;
+
+std::string random_word(Rng& rng, char first, char last) {
+  std::string w(3 + rng.below(6), first);
+  for (char& c : w)
+    c = static_cast<char>(first + rng.below(static_cast<unsigned>(last - first) + 1));
+  return w;
+}
+
+std::string log_text(std::size_t n) {
+  static char const separators[] = " :=/.\n";
+  Rng rng(7);
+  std::string text;
+  text.reserve(n + 16);
+  while (text.size() < n) {
+    text += rng.below(4) == 0 ? random_word(rng, '0', '9') : random_word(rng, 'a', 'z');
+    text += separators[rng.below(sizeof(separators) - 1)];
+  }
+  text.resize(n);
+  return text;
+}
+
+constexpr std::string_view needle = "session_expired!";
+
+std::string text_with_needle(std::size_t n) {
+  std::string text = log_text(n);
+  if (n >= needle.size()) text.replace(n - needle.size(), needle.size(), needle);
+  return text;
+}
+
+void std_find(State& st) {
+  std::string const text = text_with_needle(st.n());
+  st.set_bytes_per_item(1);
+  st.run([&] { do_not_optimize(std::string_view(text).find(needle)); });
+}
+
+void std_bmh_find(State& st) {
+  std::string const text = text_with_needle(st.n());
+  std::boyer_moore_horspool_searcher searcher(needle.begin(), needle.end());
+  st.set_bytes_per_item(1);
+  st.run([&] { do_not_optimize(std::search(text.begin(), text.end(), searcher)); });
+}
+
+template <isa Which>
+void simd_find(State& st) {
+  std::string const text = text_with_needle(st.n());
+  st.set_bytes_per_item(1);
+  st.run([&] { do_not_optimize(find_substring(Which, text, needle)); });
+}
+
+template <bool Uppercase>
+void ac_scan(State& st) {
+  std::string const text = log_text(st.n());
+  Rng rng(11);
+  std::vector<std::string> keywords(Uppercase ? 64 : 1024);
+  for (auto& k : keywords) k = Uppercase ? random_word(rng, 'A', 'Z') : random_word(rng, 'a', 'z');
+  aho_corasick const ac(keywords.begin(), keywords.end());
+  st.set_bytes_per_item(1);
+  st.run([&] {
+    std::size_t count = 0;
+    ac.for_each_match(text, [&](aho_corasick::match const&) { ++count; });
+    do_not_optimize(count);
+  });
+}
+
+void std_sort_suffixes(State& st) {
+  std::string const text = log_text(st.n());
+  std::vector<std::uint32_t> sa(text.size());
+  st.run([&] {
+    for (std::uint32_t i = 0; i < sa.size(); ++i) sa[i] = i;
+    std::string_view const t = text;
+    std::sort(sa.begin(), sa.end(),
+              [&](std::uint32_t a, std::uint32_t b) { return t.substr(a) < t.substr(b); });
+    do_not_optimize(sa.front());
+  });
+}
+
+void sais(State& st) {
+  std::string const text = log_text(st.n());
+  st.run([&] { do_not_optimize(suffix_array(text).front()); });
+}
+
+void kasai(State& st) {
+  std::string const text = log_text(st.n());
+  auto const sa = suffix_array(text);
+  st.run([&] { do_not_optimize(lcp_array(text, sa.data()).back()); });
+}
+
+ALGORITMI_BENCH("strings/std_find/text", std_find, max_n);
+ALGORITMI_BENCH("strings/std_bmh_find/text", std_bmh_find, max_n);
+ALGORITMI_BENCH("strings/find_substring_scalar/text", simd_find<isa::scalar>, max_n);
+ALGORITMI_BENCH("strings/find_substring/text", simd_find<isa::avx2>, max_n);
+
+ALGORITMI_BENCH("strings/aho_corasick/64_upper", ac_scan<true>, max_n);
+ALGORITMI_BENCH("strings/aho_corasick/1024_lower", ac_scan<false>, max_n);
+
+ALGORITMI_BENCH("strings/std_sort_suffixes/text", std_sort_suffixes, max_sort_n);
+ALGORITMI_BENCH("strings/suffix_array/text", sais, max_index_n);
+ALGORITMI_BENCH("strings/lcp_array/text", kasai, max_index_n);
+
+}  // namespace
+}  // namespace algoritmi::bench
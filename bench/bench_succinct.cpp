@@ -0,0 +1,146 @@
+// Succinct structure benchmarks. n is the number of bits (bitvector) or
+// values; query benches run query_count random queries and report ns per
+// query. bytes/item is the structure's size per bit or value, so it reads
+// as the compression achieved.
+#include <algoritmi/succinct.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "data.hpp"
+#include "harness.hpp"
+
+namespace algoritmi::bench {
+namespace {
+
+constexpr std::size_t query_count = 1 << 16;
+constexpr std::size_t max_bits = 1000000000;
+
+rank_select_bitvector half_set(std::size_t n) {
+  auto const words = random_vector<std::uint64_t>((n + 63) / 64);
+  return rank_select_bitvector(words, n);
+}
+
+// A posting list: n increasing document ids with gaps uniform in [1, 64].
+std::vector<std::uint64_t> postings(std::size_t n) {
+  Rng rng(n);
+  std::vector<std::uint64_t> v(n);
+  std::uint64_t id = 0;
+  for (auto& x : v) x = id += 1 + rng.below(64);
+  return v;
+}
+
+std::vector<std::uint64_t> random_queries(std::uint64_t bound) {
+  Rng rng(7);
+  std::vector<std::uint64_t> q(query_count);
+  for (auto& x : q) x = rng.below(bound);
+  return q;
+}
+
+template <class Query>
+void query_bench(State& st, double bytes_per_item, std::vector<std::uint64_t> const& queries,
+                 Query query) {
+  st.set_items_per_run(queries.size());
+  st.set_bytes_per_item(bytes_per_item);
+  st.run([&] {
+    std::uint64_t acc = 0;
+    for (std::uint64_t q : queries) acc += query(q);
+    do_not_optimize(acc);
+  });
+}
+
+void bitvector_build(State& st) {
+  auto const words = random_vector<std::uint64_t>((st.n() + 63) / 64);
+  st.set_bytes_per_item(1.0 / 8);
+  st.run([&] { do_not_optimize(rank_select_bitvector(words, st.n()).count_ones()); });
+}
+
+void rank1(State& st) {
+  auto const b = half_set(st.n());
+  query_bench(st, double(b.memory_bytes()) / st.n(), random_queries(st.n() + 1),
+              [&](std::uint64_t i) { return b.rank1(i); });
+}
+
+void select1(State& st) {
+  auto const b = half_set(st.n());
+  query_bench(st, double(b.memory_bytes()) / st.n(), random_queries(b.count_ones()),
+              [&](std::uint64_t k) { return b.select1(k); });
+}
+
+void select0(State& st) {
+  auto const b = half_set(st.n());
+  query_bench(st, double(b.memory_bytes()) / st.n(), random_queries(b.count_zeros()),
+              [&](std::uint64_t k) { return b.select0(k); });
+}
+
+void elias_fano_build(State& st) {
+  auto const v = postings(st.n());
+  st.set_bytes_per_item(sizeof(std::uint64_t));
+  st.run([&] { do_not_optimize(elias_fano(v.begin(), v.end()).size()); });
+}
+
+void elias_fano_access(State& st) {
+  auto const v = postings(st.n());
+  elias_fano const e(v.begin(), v.end());
+  query_bench(st, double(e.memory_bytes()) / st.n(), random_queries(st.n()),
+              [&](std::uint64_t i) { return e[i]; });
+}
+
+void elias_fano_lower_bound(State& st) {
+  auto const v = postings(st.n());
+  elias_fano const e(v.begin(), v.end());
+  query_bench(st, double(e.memory_bytes()) / st.n(), random_queries(v.back() + 1),
+              [&](std::uint64_t key) { return e.lower_bound(key); });
+}
+
+// Decoding a whole posting list; ns/op is per value.
+void elias_fano_decode(State& st) {
+  auto const v = postings(st.n());
+  elias_fano const e(v.begin(), v.end());
+  std::vector<std::uint64_t> out(st.n());
+  st.set_bytes_per_item(double(e.memory_bytes()) / st.n());
+  st.run([&] {
+    e.decode(0, st.n(), out.data());
+    do_not_optimize(out.data());
+  });
+}
+
+// Column of 16-bit values.
+wavelet_matrix column(std::size_t n) {
+  auto const v = random_vector<std::uint16_t>(n);
+  return wavelet_matrix(v.begin(), v.end());
+}
+
+void wavelet_access(State& st) {
+  auto const m = column(st.n());
+  query_bench(st, double(m.memory_bytes()) / st.n(), random_queries(st.n()),
+              [&](std::uint64_t i) { return m[i]; });
+}
+
+void wavelet_rank(State& st) {
+  auto const m = column(st.n());
+  query_bench(st, double(m.memory_bytes()) / st.n(), random_queries(st.n() + 1),
+              [&](std::uint64_t i) { return m.rank(i & 0xffff, i); });
+}
+
+// Median of a random range.
+void wavelet_quantile(State& st) {
+  auto const m = column(st.n());
+  query_bench(st, double(m.memory_bytes()) / st.n(), random_queries(st.n()),
+              [&](std::uint64_t i) { return m.quantile(i / 2, i + 1, (i + 1 - i / 2) / 2); });
+}
+
+ALGORITMI_BENCH("succinct/bitvector/build", bitvector_build, max_bits);
+ALGORITMI_BENCH("succinct/bitvector/rank1", rank1, max_bits);
+ALGORITMI_BENCH("succinct/bitvector/select1", select1, max_bits);
+ALGORITMI_BENCH("succinct/bitvector/select0", select0, max_bits);
+ALGORITMI_BENCH("succinct/elias_fano/build", elias_fano_build);
+ALGORITMI_BENCH("succinct/elias_fano/access", elias_fano_access);
+ALGORITMI_BENCH("succinct/elias_fano/lower_bound", elias_fano_lower_bound);
+ALGORITMI_BENCH("succinct/elias_fano/decode", elias_fano_decode);
+ALGORITMI_BENCH("succinct/wavelet_matrix/access", wavelet_access);
+ALGORITMI_BENCH("succinct/wavelet_matrix/rank", wavelet_rank);
+ALGORITMI_BENCH("succinct/wavelet_matrix/quantile", wavelet_quantile);
+
+}  // namespace
+}  // namespace algoritmi::bench
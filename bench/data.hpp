@@ -0,0 +1,51 @@
+// Deterministic input generators shared by the benchmark translation units.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace algoritmi::bench {
+
+// splitmix64: tiny, fast and good enough for benchmark inputs.
+class Rng {
+ public:
+  explicit Rng(std::uint64_t seed = 0x9e3779b97f4a7c15ULL) : state_(seed) {}
+
+  std::uint64_t next() noexcept {
+    std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, bound) via Lemire's multiply-shift (bias is negligible here).
+  std::uint64_t below(std::uint64_t bound) noexcept {
+    return static_cast<std::uint64_t>(
+        (static_cast<unsigned __int128>(next()) * bound) >> 64);
+  }
+
+  double uniform() noexcept { return (next() >> 11) * 0x1.0p-53; }
+
+ private:
+  std::uint64_t state_;
+};
+
+template <class T>
+std::vector<T> random_vector(std::size_t n, std::uint64_t seed = 42) {
+  Rng rng(seed);
+  std::vector<T> v(n);
+  for (auto& x : v) {
+    if constexpr (std::is_floating_point_v<T>) {
+      x = static_cast<T>(rng.uniform() * 2.0 - 1.0) * static_cast<T>(1e6);
+    } else {
+      std::uint64_t const bits = rng.next();
+      std::memcpy(&x, &bits, sizeof(T) < sizeof(bits) ? sizeof(T) : sizeof(bits));
+    }
+  }
+  return v;
+}
+
+}  // namespace algoritmi::bench
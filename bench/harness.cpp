@@ -0,0 +1,135 @@
+#include "harness.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace algoritmi::bench {
+
+std::vector<Benchmark>& registry() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+namespace {
+
+struct Row {
+  std::string name;
+  std::size_t n;
+  double ns_per_op;
+  double bytes_per_op;
+  double allocs_per_call;
+  std::size_t reps;
+  // Instrumented builds only; a negative value is a missing event.
+  std::array<double, hw_event_count> hw_per_op;
+  std::array<double, counter_count> events_per_op;
+};
+
+// Extra columns of instrumented builds, in hw_event then counter order.
+constexpr char const* instrument_columns =
+    "\tcycles/op\tinstr/op\tcache-miss/op\tbranch-miss/op\tcmp/op\tswaps/op\tprobes/op\t"
+    "relax/op";
+
+double median(std::vector<double> v) {
+  if (v.empty()) return 0.0;
+  auto mid = v.begin() + static_cast<std::ptrdiff_t>(v.size() / 2);
+  std::nth_element(v.begin(), mid, v.end());
+  if (v.size() % 2 == 1) return *mid;
+  double const hi = *mid;
+  double const lo = *std::max_element(v.begin(), mid);
+  return 0.5 * (lo + hi);
+}
+
+bool selected(std::string const& name, std::vector<std::string> const& filters) {
+  if (filters.empty()) return true;
+  return std::any_of(filters.begin(), filters.end(), [&](std::string const& f) {
+    return name.find(f) != std::string::npos;
+  });
+}
+
+std::string format_row(Row const& r) {
+  double const mops = r.ns_per_op > 0.0 ? 1e3 / r.ns_per_op : 0.0;
+  double const mbps = r.ns_per_op > 0.0 ? r.bytes_per_op * 1e3 / r.ns_per_op : 0.0;
+  char buf[256];
+  std::snprintf(buf, sizeof buf, "\t%zu\t%.3f\t%.1f\t%.2f\t%.1f\t%.1f\t%zu", r.n, r.ns_per_op,
+                r.bytes_per_op, mops, mbps, r.allocs_per_call, r.reps);
+  std::string row = r.name + buf;
+  if constexpr (instrumentation_enabled) {
+    for (double v : r.hw_per_op) {
+      if (v < 0.0)
+        std::snprintf(buf, sizeof buf, "\t-");
+      else
+        std::snprintf(buf, sizeof buf, "\t%.2f", v);
+      row += buf;
+    }
+    for (double v : r.events_per_op) {
+      std::snprintf(buf, sizeof buf, "\t%.2f", v);
+      row += buf;
+    }
+  }
+  return row;
+}
+
+Row make_row(std::string const& name, State const& st) {
+  double const items = static_cast<double>(st.items_per_run());
+  double const runs = static_cast<double>(st.samples().size());
+  Row r{name, st.n(), median(st.samples()) / items, st.bytes_per_item(),
+        st.allocations_per_run(), st.samples().size(), {}, {}};
+  for (std::size_t i = 0; i < hw_event_count; ++i) {
+    auto const e = static_cast<hw_event>(i);
+    r.hw_per_op[i] = st.has(e) ? static_cast<double>(st.total(e)) / runs / items : -1.0;
+  }
+  for (std::size_t i = 0; i < counter_count; ++i)
+    r.events_per_op[i] = static_cast<double>(st.total(static_cast<counter>(i))) / runs / items;
+  return r;
+}
+
+}  // namespace
+
+int run_all(Options const& opt) {
+  auto benchmarks = registry();
+  std::sort(benchmarks.begin(), benchmarks.end(),
+            [](Benchmark const& a, Benchmark const& b) { return a.name < b.name; });
+
+  if (opt.list_only) {
+    for (auto const& b : benchmarks) std::cout << b.name << '\n';
+    return 0;
+  }
+
+  std::vector<Row> rows;
+  for (auto const& b : benchmarks) {
+    if (!selected(b.name, opt.filters)) continue;
+    for (std::size_t n = opt.min_n; n <= opt.max_n && n <= b.max_n; n *= 10) {
+      State st(n, opt.limits);
+      b.fn(st);
+      if (st.samples().empty() || st.items_per_run() == 0) continue;
+      Row r = make_row(b.name, st);
+      std::cerr << format_row(r) << '\n';
+      rows.push_back(std::move(r));
+      if (n > opt.max_n / 10) break;
+    }
+  }
+
+  std::ofstream out(opt.out);
+  if (!out) {
+    std::cerr << "algoritmi_bench: cannot open " << opt.out << " for writing\n";
+    return 1;
+  }
+  // The header is fixed and rows are sorted by (benchmark, n), so two reports
+  // diff line by line. Timing columns are the only ones expected to move.
+  out << "# algoritmi bench v2\n";
+  out << "# threads=" << std::thread::hardware_concurrency() << '\n';
+  if constexpr (instrumentation_enabled)
+    out << "# instrument=1 perf=" << (perf_counters().available() ? "yes" : "no") << '\n';
+  out << "benchmark\tn\tns/op\tbytes/op\tMop/s\tMB/s\tallocs/call\treps";
+  if constexpr (instrumentation_enabled) out << instrument_columns;
+  out << '\n';
+  for (auto const& r : rows) out << format_row(r) << '\n';
+  return out ? 0 : 1;
+}
+
+}  // namespace algoritmi::bench
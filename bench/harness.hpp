@@ -0,0 +1,174 @@
+// Minimal benchmark harness for Algoritmi.
+//
+// Benchmarks register themselves with ALGORITMI_BENCH and are run once per
+// input size (powers of ten between --min-n and --max-n). Every timed run is
+// measured on its own; the reported figure is the median run divided by the
+// number of items the run processed, so "ns/op" always means nanoseconds per
+// element (or per query, for lookup benchmarks). Heap allocations made by
+// timed runs are counted too and reported per run.
+//
+// In ALGORITMI_INSTRUMENT builds each timed run also reads the hardware
+// counters of the running thread and the library's event counters, and
+// the report gains their means per item.
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <algoritmi/instrument.hpp>
+
+namespace algoritmi::bench {
+
+// Calls to the global operator new since startup (all threads).
+std::uint64_t allocation_count() noexcept;
+
+// Prevents the compiler from discarding a computed value.
+template <class T>
+inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile char sink;
+  sink = *reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+struct Limits {
+  double min_time_s = 0.25;  // keep repeating until this much time was timed
+  std::size_t min_reps = 3;
+  std::size_t max_reps = 1000;
+  double max_wall_s = 10.0;  // hard cap per (benchmark, n), setup included
+};
+
+class State {
+ public:
+  State(std::size_t n, Limits const& limits) : n_(n), items_(n), limits_(limits) {}
+
+  std::size_t n() const noexcept { return n_; }
+
+  // Number of operations one timed run performs; defaults to n.
+  void set_items_per_run(std::size_t items) noexcept { items_ = items; }
+  // Bytes of input touched per operation, used for bytes/op and MB/s.
+  void set_bytes_per_item(double bytes) noexcept { bytes_per_item_ = bytes; }
+
+  // Repeatedly calls setup() (untimed) followed by body() (timed).
+  template <class Setup, class Body>
+  void run(Setup&& setup, Body&& body) {
+    using clock = std::chrono::steady_clock;
+    auto const wall_start = clock::now();
+    double timed = 0.0;
+    while (samples_.size() < limits_.max_reps) {
+      setup();
+      clobber_memory();
+      std::uint64_t const a0 = allocation_count();
+      counter_snapshot const e0 = read_counters();
+      perf_.start();
+      auto const t0 = clock::now();
+      body();
+      clobber_memory();
+      auto const t1 = clock::now();
+      record(perf_.stop(), read_counters() - e0);
+      allocations_ += allocation_count() - a0;
+      double const ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+      samples_.push_back(ns);
+      timed += ns * 1e-9;
+      double const wall = std::chrono::duration<double>(t1 - wall_start).count();
+      if (samples_.size() >= limits_.min_reps && timed >= limits_.min_time_s) break;
+      if (wall >= limits_.max_wall_s) break;
+    }
+  }
+
+  template <class Body>
+  void run(Body&& body) {
+    run([] {}, std::forward<Body>(body));
+  }
+
+  std::size_t items_per_run() const noexcept { return items_; }
+  double bytes_per_item() const noexcept { return bytes_per_item_; }
+  std::vector<double> const& samples() const noexcept { return samples_; }
+  // Mean heap allocations per timed run.
+  double allocations_per_run() const noexcept {
+    return samples_.empty() ? 0.0
+                            : static_cast<double>(allocations_) / static_cast<double>(samples_.size());
+  }
+  // Hardware events summed over the timed runs; missing unless every run
+  // counted them.
+  bool has(hw_event e) const noexcept {
+    return !samples_.empty() && hw_runs_[static_cast<std::size_t>(e)] == samples_.size();
+  }
+  std::uint64_t total(hw_event e) const noexcept { return hw_[static_cast<std::size_t>(e)]; }
+  // Library events summed over the timed runs.
+  std::uint64_t total(counter c) const noexcept { return events_[c]; }
+
+ private:
+  void record(perf_sample const& hw, counter_snapshot const& events) noexcept {
+    for (std::size_t i = 0; i < hw_event_count; ++i) {
+      hw_[i] += hw.values[i];
+      hw_runs_[i] += hw.valid[i];
+    }
+    for (std::size_t i = 0; i < counter_count; ++i) events_.values[i] += events.values[i];
+  }
+
+  std::size_t n_;
+  std::size_t items_;
+  double bytes_per_item_ = 0.0;
+  Limits limits_;
+  std::vector<double> samples_;
+  std::uint64_t allocations_ = 0;
+  perf_counters perf_;
+  std::array<std::uint64_t, hw_event_count> hw_{};
+  std::array<std::size_t, hw_event_count> hw_runs_{};
+  counter_snapshot events_;
+};
+
+using BenchFn = void (*)(State&);
+
+struct Benchmark {
+  std::string name;
+  BenchFn fn;
+  std::size_t max_n;  // sizes above this are skipped (e.g. quadratic kernels)
+};
+
+std::vector<Benchmark>& registry();
+
+struct Registration {
+  Registration(char const* name, BenchFn fn,
+               std::size_t max_n = std::numeric_limits<std::size_t>::max()) {
+    registry().push_back(Benchmark{name, fn, max_n});
+  }
+};
+
+struct Options {
+  std::size_t min_n = 1000;
+  std::size_t max_n = 100000000;
+  std::vector<std::string> filters;  // substring match; empty runs everything
+  std::string out = "bench_output.txt";
+  Limits limits;
+  bool list_only = false;
+};
+
+// Runs every registered benchmark selected by `opt` and writes the report.
+// Returns a process exit code.
+int run_all(Options const& opt);
+
+}  // namespace algoritmi::bench
+
+#define ALGORITMI_BENCH_CONCAT_(a, b) a##b
+#define ALGORITMI_BENCH_CONCAT(a, b) ALGORITMI_BENCH_CONCAT_(a, b)
+
+// ALGORITMI_BENCH("module/algorithm/type", fn [, max_n])
+#define ALGORITMI_BENCH(name, ...)                                          \
+  static ::algoritmi::bench::Registration ALGORITMI_BENCH_CONCAT(           \
+      algoritmi_bench_reg_, __LINE__)(name, __VA_ARGS__)
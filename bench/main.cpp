@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "harness.hpp"
+
+namespace {
+
+void usage() {
+  std::cerr <<
+      "usage: algoritmi_bench [options] [filter...]\n"
+      "  --min-n=N       smallest input size (default 1e3)\n"
+      "  --max-n=N       largest input size (default 1e8)\n"
+      "  --min-time=S    timed seconds per size before stopping (default 0.25)\n"
+      "  --max-reps=R    repetition cap per size (default 1000)\n"
+      "  --out=PATH      report file (default bench_output.txt)\n"
+      "  --list          print benchmark names and exit\n"
+      "Filters are substrings; a benchmark runs if it matches any of them.\n";
+}
+
+// Accepts "1000", "1e6" and similar; sizes are always positive integers.
+bool parse_size(char const* text, std::size_t& out) {
+  char* end = nullptr;
+  double const v = std::strtod(text, &end);
+  if (end == text || *end != '\0' || !(v >= 1.0)) return false;
+  out = static_cast<std::size_t>(v);
+  return true;
+}
+
+char const* value_of(char const* arg, char const* flag) {
+  std::size_t const len = std::strlen(flag);
+  if (std::strncmp(arg, flag, len) == 0 && arg[len] == '=') return arg + len + 1;
+  return nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  algoritmi::bench::Options opt;
+  for (int i = 1; i < argc; ++i) {
+    char const* a = argv[i];
+    char const* v = nullptr;
+    bool ok = true;
+    if ((v = value_of(a, "--min-n"))) {
+      ok = parse_size(v, opt.min_n);
+    } else if ((v = value_of(a, "--max-n"))) {
+      ok = parse_size(v, opt.max_n);
+    } else if ((v = value_of(a, "--min-time"))) {
+      opt.limits.min_time_s = std::strtod(v, nullptr);
+    } else if ((v = value_of(a, "--max-reps"))) {
+      ok = parse_size(v, opt.limits.max_reps);
+    } else if ((v = value_of(a, "--out"))) {
+      opt.out = v;
+    } else if (std::strcmp(a, "--out") == 0 && i + 1 < argc) {
+      opt.out = argv[++i];
+    } else if (std::strcmp(a, "--list") == 0) {
+      opt.list_only = true;
+    } else if (std::strcmp(a, "--help") == 0 || std::strcmp(a, "-h") == 0) {
+      usage();
+      return 0;
+    } else if (a[0] == '-') {
+      ok = false;
+    } else {
+      opt.filters.emplace_back(a);
+    }
+    if (!ok) {
+      std::cerr << "algoritmi_bench: bad argument '" << a << "'\n";
+      usage();
+      return 2;
+    }
+  }
+  return algoritmi::bench::run_all(opt);
+}
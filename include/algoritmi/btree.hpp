@@ -0,0 +1,20 @@
+// Ordered containers.
+//
+//   btree_map<K, V[, Compare, NodeBytes]>
+//                     B+-tree map: cache-line-aligned nodes of NodeBytes
+//                     of keys (256 by default), linked leaves for range
+//                     scans; the std::map interface for lookup (find,
+//                     contains, lower_bound, upper_bound, at), insertion
+//                     (insert, try_emplace, insert_or_assign, operator[])
+//                     and erase, with iterators over std::pair<K const&,
+//                     V&> proxies
+//   btree_map(sorted_unique, first, last)
+//                     bulk load from sorted pairs in O(n)
+//
+// For integer and floating-point keys the search within a node compares
+// the whole key array with AVX2 or SSE4.2 kernels picked at runtime (see
+// cpu.hpp); lower_bound has an overload taking an `isa`.
+#pragma once
+
+#include "btree/btree_map.hpp"
+#include "btree/kernels.hpp"
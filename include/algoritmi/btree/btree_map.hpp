@@ -0,0 +1,768 @@
+// Ordered map as an in-memory B+-tree.
+//
+// Nodes are cache-line aligned and their key arrays take NodeBytes (a
+// multiple of the cache line), so a lookup reads about log_B(n) short runs
+// of consecutive lines instead of the log_2(n) scattered nodes of a
+// red-black tree. Keys live in every level; values only in the leaves,
+// which are linked in key order, so a range scan walks arrays.
+//
+// For integer and floating-point keys under std::less the rank within a
+// node is a count of vector compares over the whole key array, unused slots
+// holding the largest key (kernels.hpp); other keys and comparators binary
+// search the used slots. Floating-point keys must not be NaN.
+//
+// Every node but the root stays at least half full: inserts split a full
+// node in two, erases borrow from a sibling or merge with it. Iterators and
+// references are invalidated by any insert or erase, as for a vector.
+// Key and T must be default-constructible; the tree stores them in arrays.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../search/kernels.hpp"
+#include "../search/static_tree.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+
+// Tag for constructors whose input is sorted with no equal keys.
+struct sorted_unique_t {
+  explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+template <class Key, class T, class Compare = std::less<Key>,
+          std::size_t NodeBytes = 4 * cache_line_size>
+class btree_map {
+  static_assert(NodeBytes % cache_line_size == 0, "btree_map: NodeBytes must be whole lines");
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key const, T>;
+  using key_compare = Compare;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  // Whether in-node search runs the SIMD kernels.
+  static constexpr bool simd_search =
+      detail::search::simd_key_v<Key> && std::is_same_v<Compare, std::less<Key>>;
+  // Keys per node.
+  static constexpr std::size_t node_keys = std::max<std::size_t>(8, NodeBytes / sizeof(Key));
+
+ private:
+  static constexpr std::size_t B = node_keys;
+  static constexpr std::size_t min_keys = B / 2;
+  // Enough for any size_t count of elements at the minimum fan-out.
+  static constexpr unsigned max_height = 48;
+
+  using inner = detail::btree::inner<Key, B>;
+  struct alignas(cache_line_size) leaf {
+    Key keys[B];  // first, like inner::keys, for the kernels
+    leaf* prev = nullptr;
+    leaf* next = nullptr;
+    std::uint32_t count = 0;
+    T values[B];
+  };
+
+ public:
+  // Dereferences to std::pair<Key const&, T&>, the entry's key and value
+  // stored apart; key() and value() name them directly.
+  template <bool Const>
+  class basic_iterator {
+    using leaf_ptr = std::conditional_t<Const, leaf const*, leaf*>;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = btree_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<Key const&, std::conditional_t<Const, T const&, T&>>;
+    struct pointer {
+      reference ref;
+      reference const* operator->() const noexcept { return &ref; }
+    };
+
+    basic_iterator() = default;
+    template <bool C = Const, class = std::enable_if_t<C>>
+    basic_iterator(basic_iterator<false> const& it) noexcept : leaf_(it.leaf_), i_(it.i_) {}
+
+    Key const& key() const noexcept { return leaf_->keys[i_]; }
+    auto& value() const noexcept { return leaf_->values[i_]; }
+    reference operator*() const noexcept { return {key(), value()}; }
+    pointer operator->() const noexcept { return {**this}; }
+
+    basic_iterator& operator++() noexcept {
+      if (++i_ == leaf_->count && leaf_->next) {
+        leaf_ = leaf_->next;
+        i_ = 0;
+      }
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept {
+      basic_iterator old = *this;
+      ++*this;
+      return old;
+    }
+    basic_iterator& operator--() noexcept {
+      if (i_ == 0) {
+        leaf_ = leaf_->prev;
+        i_ = leaf_->count;
+      }
+      --i_;
+      return *this;
+    }
+    basic_iterator operator--(int) noexcept {
+      basic_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept {
+      return a.leaf_ == b.leaf_ && a.i_ == b.i_;
+    }
+    friend bool operator!=(basic_iterator const& a, basic_iterator const& b) noexcept {
+      return !(a == b);
+    }
+
+   private:
+    friend class btree_map;
+    template <bool>
+    friend class basic_iterator;
+
+    // The position after a leaf's last entry is the next leaf's first; only
+    // the last leaf has an end position of its own.
+    basic_iterator(leaf_ptr l, std::size_t i) noexcept
+        : leaf_(l), i_(static_cast<std::uint32_t>(i)) {
+      if (l && i_ == l->count && l->next) {
+        leaf_ = l->next;
+        i_ = 0;
+      }
+    }
+
+    leaf_ptr leaf_ = nullptr;
+    std::uint32_t i_ = 0;
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  btree_map() noexcept : btree_map(std::pmr::get_default_resource()) {}
+  explicit btree_map(std::pmr::memory_resource* mr, Compare const& comp = Compare()) noexcept
+      : comp_(comp), mr_(mr) {}
+
+  // Bulk load from pairs sorted by key with no two equal, which the input
+  // is checked for (std::invalid_argument). Leaves are filled completely,
+  // so the tree is as shallow and compact as it can be. O(n).
+  template <class InputIt>
+  btree_map(sorted_unique_t, InputIt first, InputIt last,
+            std::pmr::memory_resource* mr = std::pmr::get_default_resource(),
+            Compare const& comp = Compare())
+      : comp_(comp), mr_(mr) {
+    bulk_load(first, last);
+  }
+
+  btree_map(btree_map const& other) : comp_(other.comp_), mr_(other.mr_) {
+    bulk_load(other.begin(), other.end());
+  }
+  btree_map(btree_map&& other) noexcept : comp_(other.comp_), mr_(other.mr_) { steal(other); }
+  btree_map& operator=(btree_map const& other) {
+    if (this != &other) {
+      btree_map copy(sorted_unique, other.begin(), other.end(), mr_, other.comp_);
+      clear();
+      comp_ = other.comp_;
+      steal(copy);
+    }
+    return *this;
+  }
+  btree_map& operator=(btree_map&& other) noexcept {
+    if (this != &other) {
+      clear();
+      comp_ = other.comp_;
+      mr_ = other.mr_;
+      steal(other);
+    }
+    return *this;
+  }
+  ~btree_map() { clear(); }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  // Inner levels above the leaves.
+  unsigned height() const noexcept { return height_; }
+  std::size_t memory_bytes() const noexcept { return nodes_bytes_; }
+  std::pmr::memory_resource* resource() const noexcept { return mr_; }
+
+  iterator begin() noexcept { return iterator(first_, 0); }
+  iterator end() noexcept { return iterator(last_, last_ ? last_->count : 0); }
+  const_iterator begin() const noexcept { return const_iterator(first_, 0); }
+  const_iterator end() const noexcept { return const_iterator(last_, last_ ? last_->count : 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // ------------------------------------------------------------ lookup --
+
+  iterator lower_bound(Key const& key) noexcept { return mutable_at(locate<false>(key)); }
+  const_iterator lower_bound(Key const& key) const noexcept { return locate<false>(key); }
+  iterator upper_bound(Key const& key) noexcept { return mutable_at(locate<true>(key)); }
+  const_iterator upper_bound(Key const& key) const noexcept { return locate<true>(key); }
+
+  // lower_bound with an explicit instruction set for the in-node search
+  // (clamped to the host's); the same as lower_bound for other keys.
+  const_iterator lower_bound(isa which, Key const& key) const noexcept {
+    if constexpr (simd_search) {
+      if (!root_) return end();
+      auto const& k = detail::btree::make_kernel_table<Key, B>(which);
+      unsigned path[max_height];
+      auto const* l = static_cast<leaf const*>(k.descend(root_, height_, key, path));
+      return const_iterator(l, k.lower_rank(l->keys, key));
+    } else {
+      (void)which;
+      return lower_bound(key);
+    }
+  }
+
+  iterator find(Key const& key) noexcept { return mutable_at(find_const(key)); }
+  const_iterator find(Key const& key) const noexcept { return find_const(key); }
+  bool contains(Key const& key) const noexcept { return find_const(key) != end(); }
+  size_type count(Key const& key) const noexcept { return contains(key) ? 1 : 0; }
+
+  T& at(Key const& key) {
+    iterator it = find(key);
+    if (it == end()) throw std::out_of_range("btree_map: key not found");
+    return it.value();
+  }
+  T const& at(Key const& key) const {
+    const_iterator it = find(key);
+    if (it == end()) throw std::out_of_range("btree_map: key not found");
+    return it.value();
+  }
+
+  // ------------------------------------------------------------ insert --
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args) {
+    return emplace_unique(key, std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return emplace_unique(std::move(key), std::forward<Args>(args)...);
+  }
+  std::pair<iterator, bool> insert(value_type const& v) { return try_emplace(v.first, v.second); }
+  template <class P, class = std::enable_if_t<std::is_constructible_v<value_type, P&&>>>
+  std::pair<iterator, bool> insert(P&& v) {
+    value_type p(std::forward<P>(v));
+    return try_emplace(p.first, std::move(p.second));
+  }
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(Key const& key, M&& obj) {
+    auto r = try_emplace(key, std::forward<M>(obj));
+    if (!r.second) r.first.value() = std::forward<M>(obj);
+    return r;
+  }
+  T& operator[](Key const& key) { return try_emplace(key).first.value(); }
+  T& operator[](Key&& key) { return try_emplace(std::move(key)).first.value(); }
+
+  // ------------------------------------------------------------- erase --
+
+  size_type erase(Key const& key) {
+    if (!root_) return 0;
+    unsigned path[max_height];
+    leaf* l = descend(key, path);
+    std::size_t const i = lower_rank(l, key);
+    if (i == l->count || comp_(key, l->keys[i])) return 0;
+    std::move(l->keys + i + 1, l->keys + l->count, l->keys + i);
+    std::move(l->values + i + 1, l->values + l->count, l->values + i);
+    --l->count;
+    release(l->keys, l->values, l->count, l->count + 1);
+    --size_;
+    if (height_ == 0) {
+      if (l->count == 0) {
+        free_node(l);
+        root_ = first_ = last_ = nullptr;
+      }
+    } else if (l->count < min_keys) {
+      rebalance(path, l);
+    }
+    return 1;
+  }
+
+  // Returns the iterator to the entry after pos. O(log n): the tree may
+  // have been rebalanced, so the successor is looked up again.
+  iterator erase(const_iterator pos) {
+    Key const key = pos.key();
+    erase(key);
+    return upper_bound(key);
+  }
+  iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+  void clear() noexcept {
+    if (root_) destroy(root_, height_);
+    root_ = first_ = last_ = nullptr;
+    height_ = 0;
+    size_ = 0;
+    nodes_bytes_ = 0;
+  }
+
+  void swap(btree_map& other) noexcept {
+    std::swap(comp_, other.comp_);
+    std::swap(mr_, other.mr_);
+    std::swap(root_, other.root_);
+    std::swap(first_, other.first_);
+    std::swap(last_, other.last_);
+    std::swap(height_, other.height_);
+    std::swap(size_, other.size_);
+    std::swap(nodes_bytes_, other.nodes_bytes_);
+  }
+
+ private:
+  // ---------------------------------------------------------- searching --
+
+  leaf* descend(Key const& key, unsigned* path) const noexcept {
+    if constexpr (simd_search) {
+      void const* l = detail::btree::kernels<Key, B>().descend(root_, height_, key, path);
+      return static_cast<leaf*>(const_cast<void*>(l));
+    } else {
+      void* node = root_;
+      for (unsigned h = 0; h < height_; ++h) {
+        auto* n = static_cast<inner*>(node);
+        auto const c = std::upper_bound(n->keys, n->keys + n->count, key, comp_) - n->keys;
+        path[h] = static_cast<unsigned>(c);
+        node = n->children[c];
+      }
+      return static_cast<leaf*>(node);
+    }
+  }
+
+  std::size_t lower_rank(leaf const* l, Key const& key) const noexcept {
+    if constexpr (simd_search)
+      return detail::btree::kernels<Key, B>().lower_rank(l->keys, key);
+    else
+      return static_cast<std::size_t>(
+          std::lower_bound(l->keys, l->keys + l->count, key, comp_) - l->keys);
+  }
+
+  std::size_t upper_rank(leaf const* l, Key const& key) const noexcept {
+    if constexpr (simd_search)
+      return detail::btree::kernels<Key, B>().upper_rank(l->keys, l->count, key);
+    else
+      return static_cast<std::size_t>(
+          std::upper_bound(l->keys, l->keys + l->count, key, comp_) - l->keys);
+  }
+
+  template <bool Upper>
+  const_iterator locate(Key const& key) const noexcept {
+    if (!root_) return end();
+    unsigned path[max_height];
+    leaf const* l = descend(key, path);
+    return const_iterator(l, Upper ? upper_rank(l, key) : lower_rank(l, key));
+  }
+
+  const_iterator find_const(Key const& key) const noexcept {
+    if (!root_) return end();
+    unsigned path[max_height];
+    leaf const* l = descend(key, path);
+    std::size_t const i = lower_rank(l, key);
+    if (i == l->count || comp_(key, l->keys[i])) return end();
+    return const_iterator(l, i);
+  }
+
+  iterator mutable_at(const_iterator it) noexcept {
+    return iterator(const_cast<leaf*>(it.leaf_), it.i_);
+  }
+
+  // ------------------------------------------------------------- nodes --
+
+  static Key unused_key() noexcept {
+    if constexpr (simd_search)
+      return detail::stree::padding_key<Key>();
+    else
+      return Key();
+  }
+
+  // Resets slots [from, to) so they neither hold resources nor disturb the
+  // whole-array counts of the kernels.
+  static void release(Key* keys, T* values, std::size_t from, std::size_t to) {
+    std::fill(keys + from, keys + to, unused_key());
+    if (values)
+      for (std::size_t i = from; i < to; ++i) values[i] = T();
+  }
+
+  template <class Node>
+  Node* new_node() {
+    void* p = mr_->allocate(sizeof(Node), alignof(Node));
+    Node* n;
+    try {
+      n = ::new (p) Node();
+    } catch (...) {
+      mr_->deallocate(p, sizeof(Node), alignof(Node));
+      throw;
+    }
+    std::fill(n->keys, n->keys + B, unused_key());
+    nodes_bytes_ += sizeof(Node);
+    return n;
+  }
+
+  template <class Node>
+  void free_node(Node* n) noexcept {
+    n->~Node();
+    mr_->deallocate(n, sizeof(Node), alignof(Node));
+    nodes_bytes_ -= sizeof(Node);
+  }
+
+  void destroy(void* node, unsigned h) noexcept {
+    if (h == 0) return free_node(static_cast<leaf*>(node));
+    auto* n = static_cast<inner*>(node);
+    for (std::size_t c = 0; c <= n->count; ++c) destroy(n->children[c], h - 1);
+    free_node(n);
+  }
+
+  void steal(btree_map& other) noexcept {
+    root_ = std::exchange(other.root_, nullptr);
+    first_ = std::exchange(other.first_, nullptr);
+    last_ = std::exchange(other.last_, nullptr);
+    height_ = std::exchange(other.height_, 0);
+    size_ = std::exchange(other.size_, 0);
+    nodes_bytes_ = std::exchange(other.nodes_bytes_, 0);
+  }
+
+  // nodes[h] is the inner node at depth h on the path recorded by descend.
+  void path_nodes(unsigned const* path, inner** nodes) const noexcept {
+    void* node = root_;
+    for (unsigned h = 0; h < height_; ++h) {
+      nodes[h] = static_cast<inner*>(node);
+      node = nodes[h]->children[path[h]];
+    }
+  }
+
+  // ------------------------------------------------------------ insert --
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace_unique(K&& key, Args&&... args) {
+    if (!root_) root_ = first_ = last_ = new_node<leaf>();
+    unsigned path[max_height];
+    leaf* l = descend(key, path);
+    std::size_t i = lower_rank(l, key);
+    if (i < l->count && !comp_(key, l->keys[i])) return {iterator(l, i), false};
+    T value(std::forward<Args>(args)...);
+    if (l->count == B) {
+      // The new leaf joins the tree and the leaf chain only once the inner
+      // levels have taken its separator, so a bad_alloc changes nothing.
+      leaf* r = new_node<leaf>();
+      try {
+        insert_separator(path, l->keys[B / 2], r);
+      } catch (...) {
+        free_node(r);
+        throw;
+      }
+      split_leaf(l, r);
+      if (i > l->count) {
+        i -= l->count;
+        l = r;
+      }
+    }
+    std::move_backward(l->keys + i, l->keys + l->count, l->keys + l->count + 1);
+    std::move_backward(l->values + i, l->values + l->count, l->values + l->count + 1);
+    l->keys[i] = std::forward<K>(key);
+    l->values[i] = std::move(value);
+    ++l->count;
+    ++size_;
+    return {iterator(l, i), true};
+  }
+
+  // Moves the upper half of the full leaf l into the empty leaf r and links
+  // r after it.
+  void split_leaf(leaf* l, leaf* r) noexcept {
+    std::size_t const h = B / 2;
+    std::move(l->keys + h, l->keys + B, r->keys);
+    std::move(l->values + h, l->values + B, r->values);
+    release(l->keys, l->values, h, B);
+    r->count = static_cast<std::uint32_t>(B - h);
+    l->count = static_cast<std::uint32_t>(h);
+    r->next = l->next;
+    r->prev = l;
+    (l->next ? l->next->prev : last_) = r;
+    l->next = r;
+  }
+
+  static void inner_insert(inner* p, std::size_t r, Key const& sep, void* right) {
+    std::move_backward(p->keys + r, p->keys + p->count, p->keys + p->count + 1);
+    std::move_backward(p->children + r + 1, p->children + p->count + 1,
+                       p->children + p->count + 2);
+    p->keys[r] = sep;
+    p->children[r + 1] = right;
+    ++p->count;
+  }
+
+  // Adds `right`, a new node whose smallest key is sep, after the child
+  // the path went through at the deepest inner level, splitting full
+  // nodes upwards. The new nodes are allocated before anything moves, so a
+  // bad_alloc leaves the tree as it was.
+  void insert_separator(unsigned const* path, Key sep, void* right) {
+    inner* nodes[max_height];
+    path_nodes(path, nodes);
+    unsigned splits = 0;
+    while (splits < height_ && nodes[height_ - 1 - splits]->count == B) ++splits;
+    inner* spare[max_height + 1];
+    unsigned const needed = splits + (splits == height_);
+    unsigned made = 0;
+    try {
+      for (; made < needed; ++made) spare[made] = new_node<inner>();
+    } catch (...) {
+      while (made > 0) free_node(spare[--made]);
+      throw;
+    }
+    for (unsigned h = height_; h-- > 0;) {
+      inner* p = nodes[h];
+      std::size_t const r = path[h];
+      if (p->count < B) return inner_insert(p, r, sep, right);
+      inner* q = spare[--made];
+      std::size_t const mid = B / 2;
+      Key up = std::move(p->keys[mid]);
+      std::move(p->keys + mid + 1, p->keys + B, q->keys);
+      std::copy(p->children + mid + 1, p->children + B + 1, q->children);
+      q->count = static_cast<std::uint32_t>(B - 1 - mid);
+      p->count = static_cast<std::uint32_t>(mid);
+      release(p->keys, nullptr, mid, B);
+      if (r <= mid)
+        inner_insert(p, r, sep, right);
+      else
+        inner_insert(q, r - mid - 1, sep, right);
+      sep = std::move(up);
+      right = q;
+    }
+    inner* root = spare[--made];
+    root->keys[0] = std::move(sep);
+    root->children[0] = root_;
+    root->children[1] = right;
+    root->count = 1;
+    root_ = root;
+    ++height_;
+  }
+
+  // ------------------------------------------------------------- erase --
+
+  // Removes keys[k] and children[k + 1].
+  static void inner_erase(inner* p, std::size_t k) {
+    std::move(p->keys + k + 1, p->keys + p->count, p->keys + k);
+    std::copy(p->children + k + 2, p->children + p->count + 1, p->children + k + 1);
+    --p->count;
+    release(p->keys, nullptr, p->count, p->count + 1);
+  }
+
+  void unlink(leaf* l) noexcept {
+    (l->prev ? l->prev->next : first_) = l->next;
+    (l->next ? l->next->prev : last_) = l->prev;
+  }
+
+  // Appends all of `from` to `to` and frees it.
+  void merge_leaves(leaf* to, leaf* from) {
+    std::move(from->keys, from->keys + from->count, to->keys + to->count);
+    std::move(from->values, from->values + from->count, to->values + to->count);
+    to->count += from->count;
+    unlink(from);
+    free_node(from);
+  }
+
+  // l, a non-root leaf, fell below half full.
+  void rebalance(unsigned const* path, leaf* l) {
+    inner* nodes[max_height];
+    path_nodes(path, nodes);
+    inner* p = nodes[height_ - 1];
+    std::size_t const r = path[height_ - 1];
+    leaf* left = r > 0 ? static_cast<leaf*>(p->children[r - 1]) : nullptr;
+    leaf* right = r < p->count ? static_cast<leaf*>(p->children[r + 1]) : nullptr;
+    if (left && left->count > min_keys) {
+      std::move_backward(l->keys, l->keys + l->count, l->keys + l->count + 1);
+      std::move_backward(l->values, l->values + l->count, l->values + l->count + 1);
+      --left->count;
+      l->keys[0] = std::move(left->keys[left->count]);
+      l->values[0] = std::move(left->values[left->count]);
+      release(left->keys, left->values, left->count, left->count + 1);
+      ++l->count;
+      p->keys[r - 1] = l->keys[0];
+      return;
+    }
+    if (right && right->count > min_keys) {
+      l->keys[l->count] = std::move(right->keys[0]);
+      l->values[l->count] = std::move(right->values[0]);
+      ++l->count;
+      std::move(right->keys + 1, right->keys + right->count, right->keys);
+      std::move(right->values + 1, right->values + right->count, right->values);
+      --right->count;
+      release(right->keys, right->values, right->count, right->count + 1);
+      p->keys[r] = right->keys[0];
+      return;
+    }
+    if (left) {
+      merge_leaves(left, l);
+      inner_erase(p, r - 1);
+    } else {
+      merge_leaves(l, right);
+      inner_erase(p, r);
+    }
+    rebalance_inner(path, nodes);
+  }
+
+  // An inner node on the path may have fallen below half full after a
+  // merge below it; fix it and continue upwards while merges cascade.
+  void rebalance_inner(unsigned const* path, inner** nodes) {
+    for (unsigned h = height_ - 1; h > 0; --h) {
+      inner* n = nodes[h];
+      if (n->count >= min_keys) return;
+      inner* g = nodes[h - 1];
+      std::size_t const r = path[h - 1];
+      inner* left = r > 0 ? static_cast<inner*>(g->children[r - 1]) : nullptr;
+      inner* right = r < g->count ? static_cast<inner*>(g->children[r + 1]) : nullptr;
+      if (left && left->count > min_keys) {
+        std::move_backward(n->keys, n->keys + n->count, n->keys + n->count + 1);
+        std::move_backward(n->children, n->children + n->count + 1, n->children + n->count + 2);
+        n->keys[0] = std::move(g->keys[r - 1]);
+        n->children[0] = left->children[left->count];
+        ++n->count;
+        g->keys[r - 1] = std::move(left->keys[left->count - 1]);
+        --left->count;
+        release(left->keys, nullptr, left->count, left->count + 1);
+        return;
+      }
+      if (right && right->count > min_keys) {
+        n->keys[n->count] = std::move(g->keys[r]);
+        n->children[n->count + 1] = right->children[0];
+        ++n->count;
+        g->keys[r] = std::move(right->keys[0]);
+        std::move(right->keys + 1, right->keys + right->count, right->keys);
+        std::copy(right->children + 1, right->children + right->count + 1, right->children);
+        --right->count;
+        release(right->keys, nullptr, right->count, right->count + 1);
+        return;
+      }
+      if (left) {
+        merge_inner(left, g->keys[r - 1], n);
+        inner_erase(g, r - 1);
+      } else {
+        merge_inner(n, g->keys[r], right);
+        inner_erase(g, r);
+      }
+    }
+    inner* root = nodes[0];
+    if (root->count == 0) {
+      root_ = root->children[0];
+      free_node(root);
+      --height_;
+    }
+  }
+
+  void merge_inner(inner* to, Key const& sep, inner* from) {
+    to->keys[to->count] = sep;
+    std::move(from->keys, from->keys + from->count, to->keys + to->count + 1);
+    std::copy(from->children, from->children + from->count + 1, to->children + to->count + 1);
+    to->count += 1 + from->count;
+    free_node(from);
+  }
+
+  // --------------------------------------------------------- bulk load --
+
+  template <class InputIt>
+  void bulk_load(InputIt first, InputIt last) {
+    try {
+      for (; first != last; ++first) {
+        auto&& v = *first;
+        if (last_ && !comp_(last_->keys[last_->count - 1], v.first))
+          throw std::invalid_argument("btree_map: input is not sorted and unique");
+        if (!last_ || last_->count == B) {
+          leaf* l = new_node<leaf>();
+          l->prev = last_;
+          (last_ ? last_->next : first_) = l;
+          last_ = l;
+        }
+        last_->keys[last_->count] = v.first;
+        last_->values[last_->count] = v.second;
+        ++last_->count;
+        ++size_;
+      }
+      if (!first_) return;
+      // The last leaf takes half of its predecessor's entries if short.
+      if (leaf* p = last_->prev; p && last_->count < min_keys) {
+        std::size_t const move = (p->count + last_->count) / 2 - last_->count;
+        std::move_backward(last_->keys, last_->keys + last_->count,
+                           last_->keys + last_->count + move);
+        std::move_backward(last_->values, last_->values + last_->count,
+                           last_->values + last_->count + move);
+        std::move(p->keys + p->count - move, p->keys + p->count, last_->keys);
+        std::move(p->values + p->count - move, p->values + p->count, last_->values);
+        p->count -= static_cast<std::uint32_t>(move);
+        last_->count += static_cast<std::uint32_t>(move);
+        release(p->keys, p->values, p->count, p->count + move);
+      }
+      build_levels();
+    } catch (...) {
+      while (first_) {
+        leaf* next = first_->next;
+        free_node(first_);
+        first_ = next;
+      }
+      last_ = nullptr;
+      size_ = 0;
+      throw;
+    }
+  }
+
+  // Stacks inner levels over the linked leaves, spreading the children of
+  // each level evenly over as few nodes as hold them.
+  void build_levels() {
+    struct entry {
+      void* node;
+      Key min;
+    };
+    std::pmr::vector<entry> level(mr_), up(mr_);
+    for (leaf* l = first_; l; l = l->next) level.push_back({l, l->keys[0]});
+    std::pmr::vector<inner*> made(mr_);
+    try {
+      while (level.size() > 1) {
+        std::size_t const parents = (level.size() + B) / (B + 1);
+        up.clear();
+        std::size_t c = 0;
+        for (std::size_t k = 0; k < parents; ++k) {
+          std::size_t const end = level.size() * (k + 1) / parents;
+          made.push_back(nullptr);
+          inner* p = made.back() = new_node<inner>();
+          up.push_back({p, level[c].min});
+          p->children[0] = level[c++].node;
+          for (; c < end; ++c) {
+            p->keys[p->count] = level[c].min;
+            p->children[++p->count] = level[c].node;
+          }
+        }
+        level.swap(up);
+        ++height_;
+      }
+    } catch (...) {
+      for (inner* p : made)
+        if (p) free_node(p);
+      height_ = 0;
+      throw;
+    }
+    root_ = level[0].node;
+  }
+
+  Compare comp_;
+  std::pmr::memory_resource* mr_;
+  void* root_ = nullptr;  // a leaf when height_ == 0
+  leaf* first_ = nullptr;
+  leaf* last_ = nullptr;
+  unsigned height_ = 0;
+  std::size_t size_ = 0;
+  std::size_t nodes_bytes_ = 0;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,114 @@
+// In-node search kernels for btree_map, one version per instruction set.
+//
+// Node key arrays have a fixed capacity and unused slots hold the largest
+// key value, so a rank is a count over the whole array: a fixed number of
+// vector compares and popcounts, no branch on the node's fill. Descending
+// the inner levels is one kernel call, so the dispatch costs one indirect
+// call per lookup rather than one per node.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+#include "../search/kernels.hpp"
+
+namespace algoritmi::detail::btree {
+
+// keys[i] is the smallest key under children[i + 1]; count keys are in use
+// and count + 1 children.
+template <class K, std::size_t B>
+struct alignas(cache_line_size) inner {
+  K keys[B];
+  void* children[B + 1];
+  std::uint32_t count = 0;
+};
+
+#define ALGORITMI_BTREE_KERNELS(TARGET, SUFFIX, OPS)                                     \
+  /* Keys below k (Less) or above k (!Less) among the B in the array. */                 \
+  template <bool Less, class K, std::size_t B>                                           \
+  TARGET ALGORITMI_ALWAYS_INLINE std::size_t count_##SUFFIX(                             \
+      K const* keys, typename OPS<K>::vec k) noexcept {                                  \
+    using ops = OPS<K>;                                                                  \
+    std::size_t c = 0;                                                                   \
+    for (std::size_t j = 0; j < B; j += ops::lanes) {                                    \
+      auto const v = ops::load(keys + j);                                                \
+      unsigned const m = Less ? ops::lt(v, k) : ops::lt(k, v);                           \
+      if constexpr (ops::lanes == 1)                                                     \
+        c += m;                                                                          \
+      else                                                                               \
+        c += static_cast<std::size_t>(popcount(m));                                      \
+    }                                                                                    \
+    return c;                                                                            \
+  }                                                                                      \
+                                                                                         \
+  /* Follows key from root down `height` inner levels to a leaf, recording */            \
+  /* the child taken at each level in path. */                                           \
+  template <class K, std::size_t B>                                                      \
+  TARGET void const* descend_##SUFFIX(void const* node, unsigned height, K key,          \
+                                      unsigned* path) noexcept {                         \
+    auto const k = OPS<K>::set1(key);                                                    \
+    for (unsigned h = 0; h < height; ++h) {                                              \
+      auto const* n = static_cast<inner<K, B> const*>(node);                             \
+      std::size_t const c = std::min<std::size_t>(B - count_##SUFFIX<false, K, B>(n->keys, k), \
+                                                  n->count);                             \
+      path[h] = static_cast<unsigned>(c);                                                \
+      node = n->children[c];                                                             \
+      for (std::size_t line = 0; line < B * sizeof(K); line += cache_line_size)          \
+        ALGORITMI_PREFETCH(static_cast<char const*>(node) + line);                       \
+    }                                                                                    \
+    return node;                                                                         \
+  }                                                                                      \
+                                                                                         \
+  template <class K, std::size_t B>                                                      \
+  TARGET std::size_t lower_rank_##SUFFIX(K const* keys, K key) noexcept {                \
+    return count_##SUFFIX<true, K, B>(keys, OPS<K>::set1(key));                          \
+  }                                                                                      \
+                                                                                         \
+  template <class K, std::size_t B>                                                      \
+  TARGET std::size_t upper_rank_##SUFFIX(K const* keys, std::size_t count, K key) noexcept { \
+    return std::min(B - count_##SUFFIX<false, K, B>(keys, OPS<K>::set1(key)), count);   \
+  }
+
+ALGORITMI_BTREE_KERNELS(, scalar, search::scalar_ops)
+#if ALGORITMI_HAS_SIMD
+ALGORITMI_BTREE_KERNELS(ALGORITMI_TARGET_SSE42, sse42, search::sse_ops)
+ALGORITMI_BTREE_KERNELS(ALGORITMI_TARGET_AVX2, avx2, search::avx2_ops)
+#endif
+
+#undef ALGORITMI_BTREE_KERNELS
+
+template <class K, std::size_t B>
+struct kernel_table {
+  void const* (*descend)(void const*, unsigned, K, unsigned*) noexcept;
+  std::size_t (*lower_rank)(K const*, K) noexcept;
+  std::size_t (*upper_rank)(K const*, std::size_t, K) noexcept;
+};
+
+template <class K, std::size_t B>
+kernel_table<K, B> make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  switch (usable_isa(which)) {
+    case isa::avx2:
+      return {&descend_avx2<K, B>, &lower_rank_avx2<K, B>, &upper_rank_avx2<K, B>};
+    case isa::sse42:
+      return {&descend_sse42<K, B>, &lower_rank_sse42<K, B>, &upper_rank_sse42<K, B>};
+    default:
+      break;
+  }
+#else
+  (void)which;
+#endif
+  return {&descend_scalar<K, B>, &lower_rank_scalar<K, B>, &upper_rank_scalar<K, B>};
+}
+
+template <class K, std::size_t B>
+kernel_table<K, B> const& kernels() noexcept {
+  static kernel_table<K, B> const table = make_kernel_table<K, B>(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::btree
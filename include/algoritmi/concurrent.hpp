@@ -0,0 +1,21 @@
+// Queues for handing work between threads.
+//
+//   spsc_queue<T>(capacity)        bounded ring, one producer and one
+//                                  consumer; cache-line-separated indices
+//                                  with cached copies, push_bulk/pop_bulk
+//   mpmc_queue<T>(capacity)        bounded, any number of producers and
+//                                  consumers; Vyukov's per-cell sequence
+//                                  numbers, one CAS per operation
+//   segmented_queue<T>             unbounded MPMC; fetch-and-add over linked
+//                                  array segments, freed through hazard
+//                                  pointers
+//
+// All are non-blocking: try_push/try_emplace report a full bounded queue
+// and try_pop an empty one by returning false, and callers choose how to
+// wait. Storage comes from a std::pmr::memory_resource given last.
+#pragma once
+
+#include "concurrent/hazard_pointers.hpp"
+#include "concurrent/mpmc_queue.hpp"
+#include "concurrent/segmented_queue.hpp"
+#include "concurrent/spsc_queue.hpp"
@@ -0,0 +1,140 @@
+// Hazard pointers (Michael, "Hazard Pointers: Safe Memory Reclamation for
+// Lock-Free Objects", IEEE TPDS 2004) for the unbounded queue's segments.
+//
+// A thread about to dereference a shared node publishes its address in its
+// record and checks that the node is still reachable; a node unlinked from
+// the structure is retired to the unlinking thread's list and freed only
+// once a scan finds no record publishing it. Scans run when a list reaches
+// twice the number of records, so each retired node costs O(1) amortized.
+//
+// Each domain keeps one record per thread that has used it, found by
+// thread id through a small thread-local cache. Records are not released
+// when a thread exits; a later thread with the same id takes the record
+// over, retired list included. Everything still retired is freed when the
+// domain is destroyed.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../config.hpp"
+
+namespace algoritmi::detail::conc {
+
+class hazard_domain {
+ public:
+  using deleter = void (*)(void* node, void* context) noexcept;
+
+  struct alignas(cache_line_size) record {
+    std::atomic<void*> hazard{nullptr};
+    std::thread::id owner;
+    record* next = nullptr;
+    struct retired_node {
+      void* node;
+      deleter free;
+      void* context;
+    };
+    std::vector<retired_node> retired;  // owner only
+  };
+
+  hazard_domain() noexcept : id_(next_id().fetch_add(1, std::memory_order_relaxed)) {}
+  hazard_domain(hazard_domain const&) = delete;
+  hazard_domain& operator=(hazard_domain const&) = delete;
+  ~hazard_domain() {
+    record* r = records_.load(std::memory_order_acquire);
+    while (r) {
+      for (auto const& n : r->retired) n.free(n.node, n.context);
+      record* next = r->next;
+      delete r;
+      r = next;
+    }
+  }
+
+  // The calling thread's record.
+  record& local() {
+    cache_entry* cache = thread_cache();
+    for (unsigned i = 0; i < cache_size; ++i)
+      if (cache[i].domain == id_) return *cache[i].rec;
+    record* r = find_or_add(std::this_thread::get_id());
+    unsigned& victim = thread_cache_victim();
+    cache[victim++ % cache_size] = {id_, r};
+    return *r;
+  }
+
+  // Publishes src's current value in r and returns it once it is known to
+  // have still been in src after publication.
+  template <class T>
+  static T* protect(record& r, std::atomic<T*> const& src) noexcept {
+    T* p = src.load(std::memory_order_acquire);
+    for (;;) {
+      r.hazard.store(p, std::memory_order_seq_cst);
+      T* const again = src.load(std::memory_order_seq_cst);
+      if (again == p) return p;
+      p = again;
+    }
+  }
+
+  static void clear(record& r) noexcept { r.hazard.store(nullptr, std::memory_order_release); }
+
+  // node is unreachable for threads that have not published it yet;
+  // free(node, context) runs once no record publishes it.
+  void retire(record& r, void* node, deleter free, void* context) {
+    r.retired.push_back({node, free, context});
+    if (r.retired.size() >= 2 * records_count_.load(std::memory_order_relaxed) + 8) scan(r);
+  }
+
+ private:
+  static constexpr unsigned cache_size = 4;
+  struct cache_entry {
+    std::uint64_t domain = 0;
+    record* rec = nullptr;
+  };
+
+  static std::atomic<std::uint64_t>& next_id() noexcept {
+    static std::atomic<std::uint64_t> id{1};
+    return id;
+  }
+  static cache_entry* thread_cache() noexcept {
+    static thread_local cache_entry cache[cache_size];
+    return cache;
+  }
+  static unsigned& thread_cache_victim() noexcept {
+    static thread_local unsigned victim = 0;
+    return victim;
+  }
+
+  record* find_or_add(std::thread::id self) {
+    for (record* r = records_.load(std::memory_order_acquire); r; r = r->next)
+      if (r->owner == self) return r;
+    auto* r = new record;
+    r->owner = self;
+    r->next = records_.load(std::memory_order_relaxed);
+    while (!records_.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+    records_count_.fetch_add(1, std::memory_order_relaxed);
+    return r;
+  }
+
+  void scan(record& self) {
+    std::vector<void*> hazards;
+    for (record* r = records_.load(std::memory_order_acquire); r; r = r->next)
+      if (void* h = r->hazard.load(std::memory_order_seq_cst)) hazards.push_back(h);
+    std::sort(hazards.begin(), hazards.end());
+    auto keep = std::partition(self.retired.begin(), self.retired.end(), [&](auto const& n) {
+      return std::binary_search(hazards.begin(), hazards.end(), n.node);
+    });
+    for (auto it = keep; it != self.retired.end(); ++it) it->free(it->node, it->context);
+    self.retired.erase(keep, self.retired.end());
+  }
+
+  std::atomic<record*> records_{nullptr};
+  std::atomic<std::size_t> records_count_{0};
+  std::uint64_t const id_;
+};
+
+}  // namespace algoritmi::detail::conc
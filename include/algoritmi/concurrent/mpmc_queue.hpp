@@ -0,0 +1,128 @@
+// Bounded multi-producer multi-consumer queue (Vyukov's bounded MPMC
+// queue, 1024cores.net, 2010).
+//
+// Each cell carries a sequence number saying whose turn it is: a producer
+// may fill cell i & mask when its sequence equals ticket i, and a consumer
+// may empty it when the sequence is i + 1; emptying sets it to i + capacity
+// for the producer one lap later. Producers claim tickets with a CAS on the
+// enqueue counter, consumers on the dequeue counter, so a push or pop costs
+// one CAS on a shared line plus the cell, and the two sides do not touch
+// each other's counter.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../config.hpp"
+#include "../detail/bits.hpp"
+
+namespace algoritmi {
+
+template <class T>
+class mpmc_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+                "mpmc_queue: T must be nothrow movable");
+
+ public:
+  // Room for at least `capacity` elements (rounded up to a power of two,
+  // at least 2).
+  explicit mpmc_queue(std::size_t capacity,
+                      std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : mr_(mr) {
+    if (capacity == 0 || capacity > (std::size_t{1} << 40))
+      throw std::length_error("mpmc_queue: capacity out of range");
+    std::size_t const size = std::size_t{1} << std::max(1, detail::bit_width(capacity - 1));
+    mask_ = size - 1;
+    cells_ = static_cast<cell*>(mr_->allocate(size * sizeof(cell), alignof(cell)));
+    for (std::size_t i = 0; i < size; ++i) ::new (cells_ + i) cell(i);
+  }
+  mpmc_queue(mpmc_queue const&) = delete;
+  mpmc_queue& operator=(mpmc_queue const&) = delete;
+  ~mpmc_queue() {
+    std::size_t const tail = enqueue_.load(std::memory_order_relaxed);
+    for (std::size_t i = dequeue_.load(std::memory_order_relaxed); i != tail; ++i)
+      cells_[i & mask_].value()->~T();
+    for (std::size_t i = 0; i <= mask_; ++i) cells_[i].~cell();
+    mr_->deallocate(cells_, (mask_ + 1) * sizeof(cell), alignof(cell));
+  }
+
+  std::size_t capacity() const noexcept { return mask_ + 1; }
+  // A snapshot; may be off by the operations in flight.
+  std::size_t size_approx() const noexcept {
+    std::size_t const d = dequeue_.load(std::memory_order_relaxed);
+    std::size_t const e = enqueue_.load(std::memory_order_relaxed);
+    return e > d ? e - d : 0;
+  }
+
+  // false if the queue is full. The element is built before a cell is
+  // claimed, so a throwing constructor leaves the queue untouched.
+  template <class... Args>
+  bool try_emplace(Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    std::size_t pos = enqueue_.load(std::memory_order_relaxed);
+    cell* c;
+    for (;;) {
+      c = cells_ + (pos & mask_);
+      std::size_t const seq = c->seq.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+    ::new (c->storage) T(std::move(value));
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+  bool try_push(T const& v) { return try_emplace(v); }
+  bool try_push(T&& v) { return try_emplace(std::move(v)); }
+
+  // false if the queue is empty.
+  bool try_pop(T& out) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    std::size_t pos = dequeue_.load(std::memory_order_relaxed);
+    cell* c;
+    for (;;) {
+      c = cells_ + (pos & mask_);
+      std::size_t const seq = c->seq.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_.load(std::memory_order_relaxed);
+      }
+    }
+    T* v = c->value();
+    out = std::move(*v);
+    v->~T();
+    c->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  struct cell {
+    explicit cell(std::size_t s) noexcept : seq(s) {}
+    T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    std::atomic<std::size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  alignas(cache_line_size) std::atomic<std::size_t> enqueue_{0};
+  alignas(cache_line_size) std::atomic<std::size_t> dequeue_{0};
+  alignas(cache_line_size) cell* cells_ = nullptr;
+  std::size_t mask_ = 0;
+  std::pmr::memory_resource* mr_;
+};
+
+}  // namespace algoritmi
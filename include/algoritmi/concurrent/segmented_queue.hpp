@@ -0,0 +1,183 @@
+// Unbounded multi-producer multi-consumer queue: a linked list of
+// fixed-size array segments indexed by fetch-and-add (the FAAArrayQueue of
+// Correia & Ramalhete, after Morrison & Afek's LCRQ, PPoPP 2013).
+//
+// A producer takes a slot with a fetch_add on the tail segment's enqueue
+// index and publishes its element by flipping the slot from empty to full;
+// a consumer takes a slot with a fetch_add on the head segment's dequeue
+// index and flips it to taken. A consumer that reaches a slot whose
+// producer has not finished marks it taken anyway, and that producer moves
+// on to a new slot. An index past the end of its segment sends producers
+// to the next segment, appended by whichever gets there first, and
+// consumers to unlink the drained segment. Unlinked segments are freed
+// through hazard pointers (hazard_pointers.hpp), since other threads may
+// still be reading them.
+//
+// Unlike a CAS loop on a shared index, fetch_add always succeeds, so
+// contended pushes and pops do not retry one another.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../config.hpp"
+#include "hazard_pointers.hpp"
+
+namespace algoritmi {
+
+template <class T, std::size_t SegmentSlots = 1024>
+class segmented_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+                "segmented_queue: T must be nothrow movable");
+  static_assert(SegmentSlots >= 2);
+
+ public:
+  explicit segmented_queue(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : mr_(mr) {
+    segment* s = new_segment();
+    head_.store(s, std::memory_order_relaxed);
+    tail_.store(s, std::memory_order_relaxed);
+  }
+  segmented_queue(segmented_queue const&) = delete;
+  segmented_queue& operator=(segmented_queue const&) = delete;
+  ~segmented_queue() {
+    for (segment* s = head_.load(std::memory_order_relaxed); s;) {
+      std::size_t const end = std::min(s->enqueue.load(std::memory_order_relaxed), SegmentSlots);
+      for (std::size_t i = s->dequeue.load(std::memory_order_relaxed); i < end; ++i)
+        if (s->slots[i].state.load(std::memory_order_relaxed) == full) s->slots[i].value()->~T();
+      segment* next = s->next.load(std::memory_order_relaxed);
+      free_segment(s, mr_);
+      s = next;
+    }
+  }
+
+  template <class... Args>
+  void emplace(Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    auto& rec = hazards_.local();
+    for (;;) {
+      segment* tail = detail::conc::hazard_domain::protect(rec, tail_);
+      std::size_t const i = tail->enqueue.fetch_add(1, std::memory_order_acq_rel);
+      if (i < SegmentSlots) {
+        slot& s = tail->slots[i];
+        ::new (s.storage) T(std::move(value));
+        std::uint8_t expected = unset;
+        if (s.state.compare_exchange_strong(expected, full, std::memory_order_release,
+                                            std::memory_order_relaxed))
+          break;
+        // A consumer gave up on the slot; take the element back.
+        value = std::move(*s.value());
+        s.value()->~T();
+        continue;
+      }
+      if (tail != tail_.load(std::memory_order_acquire)) continue;
+      segment* next = tail->next.load(std::memory_order_acquire);
+      if (next) {
+        tail_.compare_exchange_strong(tail, next, std::memory_order_release,
+                                      std::memory_order_relaxed);
+        continue;
+      }
+      segment* fresh = new_segment();
+      ::new (fresh->slots[0].storage) T(std::move(value));
+      fresh->slots[0].state.store(full, std::memory_order_relaxed);
+      fresh->enqueue.store(1, std::memory_order_relaxed);
+      if (tail->next.compare_exchange_strong(next, fresh, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        tail_.compare_exchange_strong(tail, fresh, std::memory_order_release,
+                                      std::memory_order_relaxed);
+        break;
+      }
+      value = std::move(*fresh->slots[0].value());
+      fresh->slots[0].value()->~T();
+      free_segment(fresh, mr_);
+    }
+    detail::conc::hazard_domain::clear(rec);
+  }
+  void push(T const& v) { emplace(v); }
+  void push(T&& v) { emplace(std::move(v)); }
+
+  // false if the queue was found empty.
+  bool try_pop(T& out) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    auto& rec = hazards_.local();
+    bool got = false;
+    for (;;) {
+      segment* head = detail::conc::hazard_domain::protect(rec, head_);
+      if (head->dequeue.load(std::memory_order_acquire) >=
+              head->enqueue.load(std::memory_order_acquire) &&
+          !head->next.load(std::memory_order_acquire))
+        break;
+      std::size_t const i = head->dequeue.fetch_add(1, std::memory_order_acq_rel);
+      if (i < SegmentSlots) {
+        slot& s = head->slots[i];
+        if (s.state.exchange(taken, std::memory_order_acq_rel) != full) continue;
+        out = std::move(*s.value());
+        s.value()->~T();
+        got = true;
+        break;
+      }
+      segment* next = head->next.load(std::memory_order_acquire);
+      if (!next) break;
+      // The tail must not be left on a segment about to be retired.
+      segment* t = head;
+      tail_.compare_exchange_strong(t, next, std::memory_order_release,
+                                    std::memory_order_relaxed);
+      if (head_.compare_exchange_strong(head, next, std::memory_order_acq_rel,
+                                        std::memory_order_relaxed))
+        hazards_.retire(rec, head, &free_segment_erased, mr_);
+    }
+    detail::conc::hazard_domain::clear(rec);
+    return got;
+  }
+
+  // Whether the queue looked empty at some point during the call.
+  bool empty() const noexcept {
+    auto& rec = hazards_.local();
+    segment* head = detail::conc::hazard_domain::protect(rec, head_);
+    bool const e = head->dequeue.load(std::memory_order_acquire) >=
+                       head->enqueue.load(std::memory_order_acquire) &&
+                   !head->next.load(std::memory_order_acquire);
+    detail::conc::hazard_domain::clear(rec);
+    return e;
+  }
+
+ private:
+  // Slot states.
+  static constexpr std::uint8_t unset = 0, full = 1, taken = 2;
+
+  struct slot {
+    T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    std::atomic<std::uint8_t> state{unset};
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+  struct segment {
+    alignas(cache_line_size) std::atomic<std::size_t> enqueue{0};
+    alignas(cache_line_size) std::atomic<std::size_t> dequeue{0};
+    alignas(cache_line_size) std::atomic<segment*> next{nullptr};
+    slot slots[SegmentSlots];
+  };
+
+  segment* new_segment() {
+    void* p = mr_->allocate(sizeof(segment), alignof(segment));
+    return ::new (p) segment();
+  }
+  static void free_segment(segment* s, std::pmr::memory_resource* mr) noexcept {
+    s->~segment();
+    mr->deallocate(s, sizeof(segment), alignof(segment));
+  }
+  static void free_segment_erased(void* s, void* mr) noexcept {
+    free_segment(static_cast<segment*>(s), static_cast<std::pmr::memory_resource*>(mr));
+  }
+
+  alignas(cache_line_size) std::atomic<segment*> head_{nullptr};
+  alignas(cache_line_size) std::atomic<segment*> tail_{nullptr};
+  std::pmr::memory_resource* mr_;
+  mutable detail::conc::hazard_domain hazards_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,138 @@
+// Bounded single-producer single-consumer ring buffer.
+//
+// The producer owns the tail index and the consumer the head, each on its
+// own cache line, and each side keeps a private copy of the other's index
+// that it refreshes only when the ring looks full (or empty). In steady
+// state an operation touches its own line and the slot, and the two cores
+// exchange a line only once per lap of the shorter side. push_bulk and
+// pop_bulk move up to a whole ring with one index update.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../config.hpp"
+#include "../detail/bits.hpp"
+
+namespace algoritmi {
+
+template <class T>
+class spsc_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+                "spsc_queue: T must be nothrow movable");
+
+ public:
+  // Room for at least `capacity` elements (rounded up to a power of two).
+  explicit spsc_queue(std::size_t capacity,
+                      std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : mr_(mr) {
+    if (capacity == 0 || capacity > (std::size_t{1} << 40))
+      throw std::length_error("spsc_queue: capacity out of range");
+    std::size_t const size = std::size_t{1} << detail::bit_width(capacity - 1);
+    mask_ = size - 1;
+    slots_ = static_cast<T*>(mr_->allocate(size * sizeof(T), alignment));
+  }
+  spsc_queue(spsc_queue const&) = delete;
+  spsc_queue& operator=(spsc_queue const&) = delete;
+  ~spsc_queue() {
+    std::size_t const tail = tail_.load(std::memory_order_relaxed);
+    for (std::size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+      slots_[i & mask_].~T();
+    mr_->deallocate(slots_, (mask_ + 1) * sizeof(T), alignment);
+  }
+
+  std::size_t capacity() const noexcept { return mask_ + 1; }
+  // Exact from either side when the other is idle, a snapshot otherwise.
+  std::size_t size() const noexcept {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+  bool empty() const noexcept { return size() == 0; }
+
+  // ---------------------------------------------------------- producer --
+
+  template <class... Args>
+  bool try_emplace(Args&&... args) {
+    std::size_t const tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) return false;
+    }
+    ::new (slots_ + (tail & mask_)) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  bool try_push(T const& v) { return try_emplace(v); }
+  bool try_push(T&& v) { return try_emplace(std::move(v)); }
+
+  // Pushes the first min(count, free slots) elements of [first, ...) and
+  // returns how many. If constructing one throws, none of them is pushed.
+  template <class InputIt>
+  std::size_t push_bulk(InputIt first, std::size_t count) {
+    std::size_t const tail = tail_.load(std::memory_order_relaxed);
+    std::size_t room = capacity() - (tail - head_cache_);
+    if (room < count) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      room = capacity() - (tail - head_cache_);
+    }
+    std::size_t const n = std::min(room, count);
+    std::size_t i = 0;
+    try {
+      for (; i < n; ++i, ++first) ::new (slots_ + ((tail + i) & mask_)) T(*first);
+    } catch (...) {
+      while (i-- > 0) slots_[(tail + i) & mask_].~T();
+      throw;
+    }
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  // ---------------------------------------------------------- consumer --
+
+  bool try_pop(T& out) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    std::size_t const head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) return false;
+    }
+    T& slot = slots_[head & mask_];
+    out = std::move(slot);
+    slot.~T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops up to max elements into out and returns how many.
+  template <class OutputIt>
+  std::size_t pop_bulk(OutputIt out, std::size_t max) {
+    std::size_t const head = head_.load(std::memory_order_relaxed);
+    if (tail_cache_ - head < max) tail_cache_ = tail_.load(std::memory_order_acquire);
+    std::size_t const n = std::min(tail_cache_ - head, max);
+    for (std::size_t i = 0; i < n; ++i, ++out) {
+      T& slot = slots_[(head + i) & mask_];
+      *out = std::move(slot);
+      slot.~T();
+    }
+    head_.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+ private:
+  static constexpr std::size_t alignment = std::max<std::size_t>(alignof(T), cache_line_size);
+
+  // Producer line, consumer line, then the fields both only read.
+  alignas(cache_line_size) std::atomic<std::size_t> tail_{0};
+  std::size_t head_cache_ = 0;
+  alignas(cache_line_size) std::atomic<std::size_t> head_{0};
+  std::size_t tail_cache_ = 0;
+  alignas(cache_line_size) T* slots_ = nullptr;
+  std::size_t mask_ = 0;
+  std::pmr::memory_resource* mr_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,76 @@
+// Compiler portability macros shared by every Algoritmi header.
+#pragma once
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ALGORITMI_ALWAYS_INLINE inline __attribute__((always_inline))
+#define ALGORITMI_NOINLINE __attribute__((noinline))
+#define ALGORITMI_LIKELY(x) __builtin_expect(!!(x), 1)
+#define ALGORITMI_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define ALGORITMI_PREFETCH(addr) __builtin_prefetch(addr)
+#define ALGORITMI_PREFETCH_W(addr) __builtin_prefetch(addr, 1)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define ALGORITMI_ALWAYS_INLINE __forceinline
+#define ALGORITMI_NOINLINE __declspec(noinline)
+#define ALGORITMI_LIKELY(x) (x)
+#define ALGORITMI_UNLIKELY(x) (x)
+#define ALGORITMI_PREFETCH(addr) _mm_prefetch(reinterpret_cast<char const*>(addr), _MM_HINT_T0)
+#define ALGORITMI_PREFETCH_W(addr) ALGORITMI_PREFETCH(addr)
+#else
+#define ALGORITMI_ALWAYS_INLINE inline
+#define ALGORITMI_NOINLINE
+#define ALGORITMI_LIKELY(x) (x)
+#define ALGORITMI_UNLIKELY(x) (x)
+#define ALGORITMI_PREFETCH(addr) ((void)(addr))
+#define ALGORITMI_PREFETCH_W(addr) ((void)(addr))
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ALGORITMI_X86 1
+#else
+#define ALGORITMI_X86 0
+#endif
+
+// Per-function instruction-set targets. Kernels compiled with these run only
+// after a CPUID check (see cpu.hpp), so one binary serves every host. MSVC
+// exposes all intrinsics unconditionally and needs no attribute. The
+// AVX2_FMA target is for kernels that also check cpu().fma.
+#if ALGORITMI_X86 && (defined(__GNUC__) || defined(__clang__))
+#define ALGORITMI_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define ALGORITMI_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#define ALGORITMI_TARGET_AVX2_FMA __attribute__((target("avx2,fma,bmi,bmi2,popcnt")))
+#define ALGORITMI_HAS_SIMD 1
+#elif ALGORITMI_X86 && defined(_MSC_VER)
+#define ALGORITMI_TARGET_SSE42
+#define ALGORITMI_TARGET_AVX2
+#define ALGORITMI_TARGET_AVX2_FMA
+#define ALGORITMI_HAS_SIMD 1
+#else
+#define ALGORITMI_TARGET_SSE42
+#define ALGORITMI_TARGET_AVX2
+#define ALGORITMI_TARGET_AVX2_FMA
+#define ALGORITMI_HAS_SIMD 0
+#endif
+
+// SSE2 is part of the x86-64 baseline, so code that needs nothing newer uses
+// it unconditionally instead of going through the runtime dispatch.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ALGORITMI_SSE2 1
+#else
+#define ALGORITMI_SSE2 0
+#endif
+
+// Instrumentation hooks (see instrument.hpp) are compiled in only when this
+// is 1. It is a per-build switch, e.g. the ALGORITMI_INSTRUMENT CMake
+// option; every translation unit of a program must agree on it.
+#ifndef ALGORITMI_INSTRUMENT
+#define ALGORITMI_INSTRUMENT 0
+#endif
+
+namespace algoritmi {
+
+// Size of the unit the hardware moves between cache levels. Node and block
+// layouts throughout the library are sized in multiples of this.
+inline constexpr unsigned cache_line_size = 64;
+
+}  // namespace algoritmi
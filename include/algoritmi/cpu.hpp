@@ -0,0 +1,118 @@
+// Runtime CPU feature detection.
+//
+// SIMD kernels are compiled for several instruction sets in the same binary
+// and selected on first use from what the host reports through CPUID.
+// Setting the environment variable ALGORITMI_ISA to "scalar", "sse42" or
+// "avx2" caps the selection, which is how the slower paths are exercised on
+// modern hardware.
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+
+#include "config.hpp"
+
+#if ALGORITMI_X86 && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace algoritmi {
+
+enum class isa : unsigned char { scalar = 0, sse42 = 1, avx2 = 2 };
+
+struct cpu_features {
+  bool sse42 = false;
+  bool popcnt = false;
+  bool avx2 = false;
+  bool bmi2 = false;
+  bool fma = false;
+};
+
+namespace detail {
+
+inline cpu_features detect_cpu_features() noexcept {
+  cpu_features f;
+#if ALGORITMI_X86 && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  f.sse42 = __builtin_cpu_supports("sse4.2");
+  f.popcnt = __builtin_cpu_supports("popcnt");
+  f.avx2 = __builtin_cpu_supports("avx2");
+  f.bmi2 = __builtin_cpu_supports("bmi2");
+  f.fma = __builtin_cpu_supports("fma");
+#elif ALGORITMI_X86 && defined(_MSC_VER)
+  int r[4];
+  __cpuid(r, 0);
+  int const max_leaf = r[0];
+  __cpuid(r, 1);
+  f.sse42 = (r[2] >> 20) & 1;
+  f.popcnt = (r[2] >> 23) & 1;
+  f.fma = (r[2] >> 12) & 1;
+  bool const os_avx = ((r[2] >> 27) & 1) && (_xgetbv(0) & 6) == 6;
+  f.fma = f.fma && os_avx;
+  if (max_leaf >= 7) {
+    __cpuidex(r, 7, 0);
+    f.avx2 = os_avx && ((r[1] >> 5) & 1);
+    f.bmi2 = (r[1] >> 8) & 1;
+  }
+#endif
+  return f;
+}
+
+inline isa isa_from_env(isa fallback) noexcept {
+  char const* v = std::getenv("ALGORITMI_ISA");
+  if (!v) return fallback;
+  if (std::strcmp(v, "scalar") == 0) return isa::scalar;
+  if (std::strcmp(v, "sse42") == 0) return isa::sse42;
+  if (std::strcmp(v, "avx2") == 0) return isa::avx2;
+  return fallback;
+}
+
+}  // namespace detail
+
+inline cpu_features const& cpu() noexcept {
+  static cpu_features const features = detail::detect_cpu_features();
+  return features;
+}
+
+// Best instruction set the host can execute.
+inline isa max_supported_isa() noexcept {
+  static isa const best = [] {
+#if ALGORITMI_HAS_SIMD
+    cpu_features const& f = cpu();
+    if (f.avx2 && f.bmi2 && f.popcnt) return isa::avx2;
+    if (f.sse42 && f.popcnt) return isa::sse42;
+#endif
+    return isa::scalar;
+  }();
+  return best;
+}
+
+// Instruction set the dispatching entry points use: the best supported one,
+// lowered by ALGORITMI_ISA if set. Fixed at first call.
+inline isa active_isa() noexcept {
+  static isa const active = [] {
+    isa const best = max_supported_isa();
+    isa const wanted = detail::isa_from_env(best);
+    return wanted < best ? wanted : best;
+  }();
+  return active;
+}
+
+// Clamps an explicitly requested instruction set to one the host supports.
+inline isa usable_isa(isa wanted) noexcept {
+  isa const best = max_supported_isa();
+  return wanted < best ? wanted : best;
+}
+
+inline char const* to_string(isa i) noexcept {
+  switch (i) {
+    case isa::avx2:
+      return "avx2";
+    case isa::sse42:
+      return "sse42";
+    default:
+      return "scalar";
+  }
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,48 @@
+// Over-aligned allocation for arrays whose layout assumes cache-line
+// boundaries. Memory comes from a std::pmr::memory_resource, so aligned
+// containers can live in an arena or pool like everything else.
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+
+#include "../config.hpp"
+
+namespace algoritmi::detail {
+
+template <class T, std::size_t Align = cache_line_size>
+struct aligned_allocator {
+  using value_type = T;
+  static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0);
+
+  template <class U>
+  struct rebind {
+    using other = aligned_allocator<U, Align>;
+  };
+
+  aligned_allocator() noexcept : resource(std::pmr::get_default_resource()) {}
+  aligned_allocator(std::pmr::memory_resource* mr) noexcept : resource(mr) {}
+  template <class U>
+  aligned_allocator(aligned_allocator<U, Align> const& other) noexcept : resource(other.resource) {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+    return static_cast<T*>(resource->allocate(n * sizeof(T), Align));
+  }
+  void deallocate(T* p, std::size_t n) noexcept { resource->deallocate(p, n * sizeof(T), Align); }
+
+  template <class U>
+  bool operator==(aligned_allocator<U, Align> const& other) const noexcept {
+    return *resource == *other.resource;
+  }
+  template <class U>
+  bool operator!=(aligned_allocator<U, Align> const& other) const noexcept {
+    return !(*this == other);
+  }
+
+  std::pmr::memory_resource* resource;
+};
+
+}  // namespace algoritmi::detail
@@ -0,0 +1,72 @@
+// Bit-manipulation helpers (C++17 has no <bit>).
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace algoritmi::detail {
+
+// Undefined for x == 0.
+inline int countr_zero(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#elif defined(_MSC_VER)
+  unsigned long i;
+  _BitScanForward64(&i, x);
+  return static_cast<int>(i);
+#else
+  int n = 0;
+  while (!(x & 1)) x >>= 1, ++n;
+  return n;
+#endif
+}
+
+// Undefined for x == 0.
+inline int countl_zero(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(x);
+#elif defined(_MSC_VER)
+  unsigned long i;
+  _BitScanReverse64(&i, x);
+  return 63 - static_cast<int>(i);
+#else
+  int n = 0;
+  while (!(x & (std::uint64_t{1} << 63))) x <<= 1, ++n;
+  return n;
+#endif
+}
+
+inline int popcount(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(x);
+#elif defined(_MSC_VER)
+  return static_cast<int>(__popcnt64(x));
+#else
+  int n = 0;
+  for (; x; x &= x - 1) ++n;
+  return n;
+#endif
+}
+
+// Number of bits needed to represent x; 0 for x == 0.
+inline int bit_width(std::uint64_t x) noexcept { return x ? 64 - countl_zero(x) : 0; }
+
+// High half of the 128-bit product a * b; mulhi(x, n) maps a uniform x to
+// a uniform index below n without a division.
+inline std::uint64_t mulhi(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+  return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#elif defined(_MSC_VER)
+  return __umulh(a, b);
+#else
+  std::uint64_t const a_lo = a & 0xffffffff, a_hi = a >> 32;
+  std::uint64_t const b_lo = b & 0xffffffff, b_hi = b >> 32;
+  std::uint64_t const mid = (a_lo * b_lo >> 32) + (a_hi * b_lo & 0xffffffff) + a_lo * b_hi;
+  return a_hi * b_hi + (a_hi * b_lo >> 32) + (mid >> 32);
+#endif
+}
+
+}  // namespace algoritmi::detail
@@ -0,0 +1,70 @@
+// Array that either owns a vector or refers to memory owned elsewhere.
+//
+// Immutable structures keep their arrays in one of these so that the same
+// class serves an index built in memory and one opened from a mapped file
+// (persist.hpp) without copying. Readers see a const array either way;
+// builders call own() to get the vector, which drops any borrowed view
+// (own_copy() keeps its contents). Copies of a borrowing array borrow the
+// same memory.
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "../span.hpp"
+
+namespace algoritmi::detail {
+
+template <class T, class Alloc = std::pmr::polymorphic_allocator<T>>
+class borrowable_array {
+ public:
+  using vector_type = std::vector<T, Alloc>;
+
+  borrowable_array() = default;
+  explicit borrowable_array(Alloc alloc) : owned_(alloc) {}
+
+  vector_type& own() noexcept {
+    borrowed_ = nullptr;
+    size_ = 0;
+    is_borrowed_ = false;
+    return owned_;
+  }
+
+  // own() keeping the contents: a borrowed array is copied first, so a
+  // structure loaded from a file can still be updated.
+  vector_type& own_copy() {
+    if (is_borrowed_) {
+      vector_type copy(borrowed_, borrowed_ + size_, owned_.get_allocator());
+      own().swap(copy);
+    }
+    return owned_;
+  }
+
+  // Refers to `s` from now on; the memory must outlive every copy.
+  void borrow(span<T const> s) {
+    vector_type(owned_.get_allocator()).swap(owned_);
+    borrowed_ = s.data();
+    size_ = s.size();
+    is_borrowed_ = true;
+  }
+
+  bool borrowed() const noexcept { return is_borrowed_; }
+  T const* data() const noexcept { return is_borrowed_ ? borrowed_ : owned_.data(); }
+  std::size_t size() const noexcept { return is_borrowed_ ? size_ : owned_.size(); }
+  bool empty() const noexcept { return size() == 0; }
+  T const& operator[](std::size_t i) const noexcept { return data()[i]; }
+  T const* begin() const noexcept { return data(); }
+  T const* end() const noexcept { return data() + size(); }
+  operator span<T const>() const noexcept { return {data(), size()}; }
+
+  Alloc get_allocator() const noexcept { return owned_.get_allocator(); }
+
+ private:
+  vector_type owned_;
+  T const* borrowed_ = nullptr;
+  std::size_t size_ = 0;
+  bool is_borrowed_ = false;
+};
+
+}  // namespace algoritmi::detail
@@ -0,0 +1,253 @@
+// POSIX file access for the out-of-core algorithms and index files:
+// positioned reads and writes that retry short transfers, a read-only
+// mapping, and a background thread that performs I/O requests in
+// submission order.
+//
+// Errors throw std::system_error carrying errno and the file name.
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace algoritmi::detail {
+
+[[noreturn]] inline void throw_io_error(char const* what, std::filesystem::path const& path) {
+  throw std::system_error(errno, std::generic_category(), std::string(what) + " " + path.string());
+}
+
+class file {
+ public:
+  file() = default;
+
+  static file open_read(std::filesystem::path const& path) {
+    return file(path, O_RDONLY);
+  }
+  static file create(std::filesystem::path const& path) {
+    return file(path, O_RDWR | O_CREAT | O_TRUNC);
+  }
+  // A new file in dir that is unlinked at once: it lives as long as the
+  // descriptor and cannot be left behind by a crash.
+  static file anonymous(std::filesystem::path const& dir) {
+    static std::atomic<unsigned> counter{0};
+    for (;;) {
+      std::filesystem::path const path =
+          dir / ("algoritmi-" + std::to_string(::getpid()) + "-" +
+                 std::to_string(counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp");
+      int const fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+      if (fd < 0) {
+        if (errno == EEXIST) continue;
+        throw_io_error("cannot create temporary file", path);
+      }
+      ::unlink(path.c_str());
+      file f;
+      f.fd_ = fd;
+      f.path_ = path;
+      return f;
+    }
+  }
+
+  file(file&& other) noexcept
+      : fd_(std::exchange(other.fd_, -1)), path_(std::move(other.path_)) {}
+  file& operator=(file&& other) noexcept {
+    if (this != &other) {
+      close();
+      fd_ = std::exchange(other.fd_, -1);
+      path_ = std::move(other.path_);
+    }
+    return *this;
+  }
+  file(file const&) = delete;
+  file& operator=(file const&) = delete;
+  ~file() { close(); }
+
+  int fd() const noexcept { return fd_; }
+  std::filesystem::path const& path() const noexcept { return path_; }
+
+  std::uint64_t size() const {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) throw_io_error("cannot stat", path_);
+    return static_cast<std::uint64_t>(st.st_size);
+  }
+
+  // Reads exactly `bytes`; hitting end of file is an error.
+  void read_at(void* dst, std::size_t bytes, std::uint64_t offset) const {
+    auto* p = static_cast<char*>(dst);
+    while (bytes > 0) {
+      ssize_t const r = ::pread(fd_, p, bytes, static_cast<off_t>(offset));
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        throw_io_error("read failed on", path_);
+      }
+      if (r == 0) {
+        errno = EIO;
+        throw_io_error("unexpected end of file in", path_);
+      }
+      p += r;
+      bytes -= static_cast<std::size_t>(r);
+      offset += static_cast<std::uint64_t>(r);
+    }
+  }
+
+  void write_at(void const* src, std::size_t bytes, std::uint64_t offset) const {
+    auto const* p = static_cast<char const*>(src);
+    while (bytes > 0) {
+      ssize_t const r = ::pwrite(fd_, p, bytes, static_cast<off_t>(offset));
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        throw_io_error("write failed on", path_);
+      }
+      p += r;
+      bytes -= static_cast<std::size_t>(r);
+      offset += static_cast<std::uint64_t>(r);
+    }
+  }
+
+  // Flushes written data to the device.
+  void sync() const {
+    if (::fsync(fd_) != 0) throw_io_error("cannot sync", path_);
+  }
+
+  // Tells the kernel to read ahead aggressively; purely a hint.
+  void advise_sequential() const noexcept {
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  }
+
+ private:
+  file(std::filesystem::path const& path, int flags) : path_(path) {
+    fd_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd_ < 0) throw_io_error("cannot open", path);
+  }
+
+  void close() noexcept {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+  }
+
+  int fd_ = -1;
+  std::filesystem::path path_;
+};
+
+enum class map_access {
+  sequential,  // one pass front to back: aggressive read-ahead
+  random,      // default kernel read-ahead
+  populate,    // fault every page in before returning (Linux)
+};
+
+// Read-only shared mapping of a whole file.
+class mapped_file {
+ public:
+  explicit mapped_file(file const& f, map_access access = map_access::sequential)
+      : size_(static_cast<std::size_t>(f.size())) {
+    if (size_ == 0) return;
+    int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+    if (access == map_access::populate) flags |= MAP_POPULATE;
+#endif
+    void* p = ::mmap(nullptr, size_, PROT_READ, flags, f.fd(), 0);
+    if (p == MAP_FAILED) throw_io_error("cannot map", f.path());
+    data_ = static_cast<char const*>(p);
+#if defined(MADV_SEQUENTIAL)
+    if (access == map_access::sequential) ::madvise(p, size_, MADV_SEQUENTIAL);
+#endif
+  }
+  mapped_file(mapped_file&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+  mapped_file& operator=(mapped_file&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+  mapped_file(mapped_file const&) = delete;
+  mapped_file& operator=(mapped_file const&) = delete;
+  ~mapped_file() { unmap(); }
+
+  char const* data() const noexcept { return data_; }
+  std::size_t size() const noexcept { return size_; }
+
+ private:
+  void unmap() noexcept {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+  }
+
+  char const* data_ = nullptr;
+  std::size_t size_;
+};
+
+// One background thread running submitted jobs in FIFO order. The order is
+// what makes double buffering safe without further locking: a read into a
+// buffer submitted after a write from it cannot start before that write has
+// finished. The destructor finishes every queued job before returning, so
+// declare the worker after the buffers it touches.
+class io_worker {
+ public:
+  io_worker() : thread_([this] { loop(); }) {}
+  io_worker(io_worker const&) = delete;
+  io_worker& operator=(io_worker const&) = delete;
+  ~io_worker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  // Exceptions thrown by fn surface from the returned future's get().
+  template <class Fn>
+  std::future<void> submit(Fn fn) {
+    std::packaged_task<void()> task(std::move(fn));
+    std::future<void> result = task.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return result;
+  }
+
+ private:
+  void loop() {
+    for (;;) {
+      std::packaged_task<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        task = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::packaged_task<void()>> queue_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace algoritmi::detail
@@ -0,0 +1,44 @@
+// Fork-join helper used by the parallel algorithm variants; runs on the
+// current executor (scheduler/task_scheduler.hpp).
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "../scheduler/executor.hpp"
+#include "../scheduler/task_scheduler.hpp"
+
+namespace algoritmi::detail {
+
+inline unsigned resolve_threads(unsigned requested) {
+  return requested ? requested : current_executor().concurrency();
+}
+
+// Calls fn(i) for every i in [0, tasks) with up to `threads` of them running
+// at once, the caller taking part. Tasks are claimed from a shared counter,
+// so a thread that finishes early keeps taking work from the others. The
+// first exception thrown by any task is rethrown on the calling thread.
+template <class Fn>
+void parallel_for(std::size_t tasks, unsigned threads, Fn&& fn) {
+  if (tasks == 0) return;
+  if (threads <= 1 || tasks == 1) {
+    for (std::size_t i = 0; i < tasks; ++i) fn(i);
+    return;
+  }
+  current_executor().bulk(tasks, threads, task_fn(fn));
+}
+
+// Tasks per thread for irregular work; extra tasks let fast threads pick up
+// slack.
+inline constexpr std::size_t tasks_per_thread = 8;
+
+// a = min(a, value); true if this call lowered it.
+template <class T>
+inline bool atomic_fetch_min(std::atomic<T>& a, T value) noexcept {
+  T cur = a.load(std::memory_order_relaxed);
+  while (value < cur)
+    if (a.compare_exchange_weak(cur, value, std::memory_order_relaxed)) return true;
+  return false;
+}
+
+}  // namespace algoritmi::detail
@@ -0,0 +1,24 @@
+// Dynamic programming over strings and item sets, without the full table.
+//
+//   edit_distance(a, b[, max])    Levenshtein distance, bit-parallel
+//                                 (Myers), O(mn / 64); with a bound it
+//                                 stops once the bound is exceeded
+//   edit_distance_matcher         one pattern against many strings
+//   lcs_length(a, b)              bit-parallel LCS length
+//   longest_common_subsequence    the subsequence itself, linear space
+//   global_alignment_score        Needleman-Wunsch score, linear space
+//   global_alignment              score and edit script, Hirschberg
+//   local_alignment_score         Smith-Waterman score, anti-diagonal SIMD
+//   knapsack_value, knapsack      0/1 knapsack in O(W) memory; knapsack
+//                                 recovers the items Hirschberg-style
+//
+// Alignments score a match, a mismatch and a gap (linear gap cost). The
+// Smith-Waterman kernels compute 8 (SSE4.2) or 16 (AVX2) cells of an
+// anti-diagonal per instruction in saturating 16-bit lanes, picked at
+// runtime (see cpu.hpp); an overload taking an `isa` runs a specific one.
+#pragma once
+
+#include "dp/alignment.hpp"
+#include "dp/edit_distance.hpp"
+#include "dp/kernels.hpp"
+#include "dp/knapsack.hpp"
@@ -0,0 +1,211 @@
+// Sequence alignment with linear gap scores.
+//
+//   global_alignment        Needleman-Wunsch, in linear space by Hirschberg,
+//                           "A linear space algorithm for computing maximal
+//                           common subsequences" (1975): the score rows of
+//                           the top half of a computed forwards and of the
+//                           bottom half backwards meet in the middle row,
+//                           where the best sum names a cell the optimal path
+//                           crosses; the two sub-problems are solved
+//                           recursively. O(mn) time, twice the score-only
+//                           cost, in O(m + n) memory. Sub-problems of at
+//                           most full_table_cells cells are traced back from
+//                           a full table.
+//   local_alignment_score   Smith-Waterman score, anti-diagonal SIMD kernels
+//                           (kernels.hpp).
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpu.hpp"
+#include "../detail/scratch.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+
+// Score of a column pairing equal bytes, different bytes, or a byte with a
+// gap.
+struct alignment_scoring {
+  std::int64_t match = 1;
+  std::int64_t mismatch = -1;
+  std::int64_t gap = -1;
+};
+
+// One column of an alignment of a against b: insert consumes a byte of b
+// only, remove a byte of a only, the others one of each.
+enum class edit_op : char { match = '=', substitute = 'X', insert = 'I', remove = 'D' };
+
+struct alignment {
+  std::int64_t score = 0;
+  std::pmr::vector<edit_op> ops;
+};
+
+namespace detail::dp {
+
+inline constexpr std::size_t full_table_cells = 4096;
+
+// row[j] = best score of a against b[0, j), or, with Reverse, of a against
+// the last j bytes of b. row has b.size() + 1 entries.
+template <bool Reverse>
+void global_row(std::string_view a, std::string_view b, alignment_scoring const& s,
+                std::int64_t* row) noexcept {
+  std::size_t const m = a.size(), n = b.size();
+  auto at = [](std::string_view x, std::size_t i) { return Reverse ? x[x.size() - 1 - i] : x[i]; };
+  for (std::size_t j = 0; j <= n; ++j) row[j] = static_cast<std::int64_t>(j) * s.gap;
+  for (std::size_t i = 0; i < m; ++i) {
+    char const c = at(a, i);
+    std::int64_t diag = row[0];
+    row[0] += s.gap;
+    for (std::size_t j = 1; j <= n; ++j) {
+      std::int64_t const up = row[j];
+      std::int64_t const h = diag + (c == at(b, j - 1) ? s.match : s.mismatch);
+      row[j] = std::max(h, std::max(up, row[j - 1]) + s.gap);
+      diag = up;
+    }
+  }
+}
+
+inline void trace_full_table(std::string_view a, std::string_view b, alignment_scoring const& s,
+                             std::pmr::vector<edit_op>& ops, std::pmr::memory_resource* mr) {
+  std::size_t const m = a.size(), n = b.size(), w = n + 1;
+  scratch_buffer<std::int64_t> t((m + 1) * w, mr);
+  for (std::size_t i = 0; i <= m; ++i) {
+    for (std::size_t j = 0; j <= n; ++j) {
+      std::int64_t& h = t[i * w + j];
+      if (i == 0 || j == 0) {
+        h = static_cast<std::int64_t>(i + j) * s.gap;
+        continue;
+      }
+      h = t[(i - 1) * w + j - 1] + (a[i - 1] == b[j - 1] ? s.match : s.mismatch);
+      h = std::max(h, std::max(t[(i - 1) * w + j], t[i * w + j - 1]) + s.gap);
+    }
+  }
+  std::size_t const start = ops.size();
+  std::size_t i = m, j = n;
+  while (i > 0 || j > 0) {
+    std::int64_t const h = t[i * w + j];
+    if (i > 0 && j > 0) {
+      bool const same = a[i - 1] == b[j - 1];
+      if (h == t[(i - 1) * w + j - 1] + (same ? s.match : s.mismatch)) {
+        ops.push_back(same ? edit_op::match : edit_op::substitute);
+        --i, --j;
+        continue;
+      }
+    }
+    if (i > 0 && h == t[(i - 1) * w + j] + s.gap) {
+      ops.push_back(edit_op::remove);
+      --i;
+    } else {
+      ops.push_back(edit_op::insert);
+      --j;
+    }
+  }
+  std::reverse(ops.begin() + static_cast<std::ptrdiff_t>(start), ops.end());
+}
+
+inline void hirschberg(std::string_view a, std::string_view b, alignment_scoring const& s,
+                       std::pmr::vector<edit_op>& ops, std::pmr::memory_resource* mr) {
+  std::size_t const m = a.size(), n = b.size();
+  if (m == 0 || n == 0) {
+    ops.insert(ops.end(), m + n, m ? edit_op::remove : edit_op::insert);
+    return;
+  }
+  if (m == 1 || (m + 1) * (n + 1) <= full_table_cells) return trace_full_table(a, b, s, ops, mr);
+  std::size_t const mid = m / 2;
+  std::size_t split = 0;
+  {
+    scratch_buffer<std::int64_t> top(n + 1, mr), bottom(n + 1, mr);
+    global_row<false>(a.substr(0, mid), b, s, top.get());
+    global_row<true>(a.substr(mid), b, s, bottom.get());
+    std::int64_t best = top[0] + bottom[n];
+    for (std::size_t j = 1; j <= n; ++j)
+      if (top[j] + bottom[n - j] > best) best = top[j] + bottom[n - j], split = j;
+  }
+  hirschberg(a.substr(0, mid), b.substr(0, split), s, ops, mr);
+  hirschberg(a.substr(mid), b.substr(split), s, ops, mr);
+}
+
+}  // namespace detail::dp
+
+// Best score over all global alignments of a and b, in O(min(m, n)) memory.
+inline std::int64_t global_alignment_score(
+    std::string_view a, std::string_view b, alignment_scoring const& scoring = {},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  if (a.size() < b.size()) std::swap(a, b);
+  detail::scratch_buffer<std::int64_t> row(b.size() + 1, mr);
+  detail::dp::global_row<false>(a, b, scoring, row.get());
+  return row[b.size()];
+}
+
+// An optimal global alignment of a and b, in O(m + n) working memory.
+inline alignment global_alignment(
+    std::string_view a, std::string_view b, alignment_scoring const& scoring = {},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  alignment result{0, std::pmr::vector<edit_op>(mr)};
+  result.ops.reserve(a.size() + b.size());
+  detail::dp::hirschberg(a, b, scoring, result.ops, mr);
+  std::size_t i = 0, j = 0;
+  for (edit_op op : result.ops) {
+    switch (op) {
+      case edit_op::match:
+        result.score += scoring.match, ++i, ++j;
+        break;
+      case edit_op::substitute:
+        result.score += scoring.mismatch, ++i, ++j;
+        break;
+      case edit_op::insert:
+        result.score += scoring.gap, ++j;
+        break;
+      case edit_op::remove:
+        result.score += scoring.gap, ++i;
+        break;
+    }
+  }
+  return result;
+}
+
+// A longest common subsequence of a and b (lcs_length() gives its length
+// faster). A substitution scores below the two gaps it could be replaced
+// by, so the optimal alignment's matches are an LCS.
+inline std::pmr::string longest_common_subsequence(
+    std::string_view a, std::string_view b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  alignment const al = global_alignment(a, b, {1, -1, 0}, mr);
+  std::pmr::string lcs(mr);
+  lcs.reserve(static_cast<std::size_t>(al.score));
+  std::size_t i = 0;
+  for (edit_op op : al.ops) {
+    if (op == edit_op::match) lcs.push_back(a[i]);
+    if (op != edit_op::insert) ++i;
+  }
+  return lcs;
+}
+
+// Best score of an alignment of a substring of a with a substring of b
+// (0 for none), in O(min(m, n)) memory.
+inline std::int64_t local_alignment_score(
+    std::string_view a, std::string_view b, alignment_scoring const& scoring, isa which,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  if (a.size() > b.size()) std::swap(a, b);
+  if (a.empty()) return 0;
+  detail::dp::local_params const p{scoring.match, scoring.mismatch, scoring.gap};
+  return detail::dp::make_kernel_table(which).local_score(a.data(), a.size(), b.data(), b.size(),
+                                                          p, mr);
+}
+
+inline std::int64_t local_alignment_score(
+    std::string_view a, std::string_view b, alignment_scoring const& scoring = {},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  if (a.size() > b.size()) std::swap(a, b);
+  if (a.empty()) return 0;
+  detail::dp::local_params const p{scoring.match, scoring.mismatch, scoring.gap};
+  return detail::dp::kernels().local_score(a.data(), a.size(), b.data(), b.size(), p, mr);
+}
+
+}  // namespace algoritmi
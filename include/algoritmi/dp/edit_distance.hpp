@@ -0,0 +1,214 @@
+// Bit-parallel edit distance and longest common subsequence length.
+//
+// Both fill the usual (m + 1) x (n + 1) table a column at a time, but keep a
+// column as bit vectors of m bits, one bit per pattern position, so a
+// column costs O(m / 64) word operations instead of m cell updates and no
+// table is stored.
+//
+//   edit_distance  Myers, "A fast bit-vector algorithm for approximate
+//                  string matching based on dynamic programming" (1999),
+//                  in the multi-word form of Hyyro (2003): the vertical
+//                  and horizontal differences between neighbouring cells
+//                  (each -1, 0 or +1) are kept as positive and negative
+//                  bit vectors, and the horizontal difference at the last
+//                  row of each 64-row block carries into the next block.
+//                  With a bound k the column loop stops once the last row,
+//                  less the columns left, exceeds k.
+//   lcs_length     Allison & Dix (1986) / Hyyro (2004): a bit per row
+//                  marks where the LCS of the prefixes does not grow; one
+//                  addition with carry per word updates a column.
+//
+// The shorter string is the pattern. edit_distance_matcher keeps the
+// pattern's match masks for comparing one string with many.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "../detail/bits.hpp"
+#include "../detail/scratch.hpp"
+
+namespace algoritmi {
+namespace detail::dp {
+
+inline constexpr std::size_t no_bound = std::numeric_limits<std::size_t>::max();
+
+inline std::size_t blocks_for(std::size_t m) noexcept { return (m + 63) / 64; }
+
+// peq[c * blocks + b]: bit i set where pattern[64 * b + i] == c.
+inline void fill_match_masks(std::string_view pattern, std::size_t blocks,
+                             std::uint64_t* peq) noexcept {
+  std::fill(peq, peq + 256 * blocks, std::uint64_t{0});
+  for (std::size_t i = 0; i < pattern.size(); ++i)
+    peq[static_cast<unsigned char>(pattern[i]) * blocks + i / 64] |= std::uint64_t{1}
+                                                                     << (i % 64);
+}
+
+// One column of one block; hin and the result are the horizontal
+// differences entering at the top row and leaving at row `last`.
+inline int advance_block(std::uint64_t& pv, std::uint64_t& mv, std::uint64_t eq, int hin,
+                         std::uint64_t last) noexcept {
+  std::uint64_t const xv = eq | mv;
+  if (hin < 0) eq |= 1;
+  std::uint64_t const xh = (((eq & pv) + pv) ^ pv) | eq;
+  std::uint64_t ph = mv | ~(xh | pv);
+  std::uint64_t mh = pv & xh;
+  int const hout = (ph & last) ? 1 : (mh & last) ? -1 : 0;
+  ph <<= 1;
+  mh <<= 1;
+  if (hin < 0)
+    mh |= 1;
+  else if (hin > 0)
+    ph |= 1;
+  pv = mh | ~(xv | ph);
+  mv = ph & xv;
+  return hout;
+}
+
+// Distance between the pattern described by peq (m >= 1 characters) and
+// text, or max + 1 if it exceeds max. pv and mv hold `blocks` words.
+inline std::size_t myers(std::uint64_t const* peq, std::size_t m, std::string_view text,
+                         std::size_t max, std::uint64_t* pv, std::uint64_t* mv) noexcept {
+  std::size_t const blocks = blocks_for(m);
+  std::uint64_t const last = std::uint64_t{1} << ((m - 1) % 64);
+  std::size_t score = m;
+  std::size_t left = text.size();
+  if (blocks == 1) {
+    std::uint64_t p = ~std::uint64_t{0}, q = 0;
+    for (char c : text) {
+      score += advance_block(p, q, peq[static_cast<unsigned char>(c)], 1, last);
+      if (--left < score && score - left > max) return max + 1;
+    }
+    return score;
+  }
+  std::fill(pv, pv + blocks, ~std::uint64_t{0});
+  std::fill(mv, mv + blocks, 0);
+  std::uint64_t const top = std::uint64_t{1} << 63;
+  for (char c : text) {
+    std::uint64_t const* eq = peq + static_cast<unsigned char>(c) * blocks;
+    int h = 1;
+    for (std::size_t b = 0; b + 1 < blocks; ++b) h = advance_block(pv[b], mv[b], eq[b], h, top);
+    score += advance_block(pv[blocks - 1], mv[blocks - 1], eq[blocks - 1], h, last);
+    if (--left < score && score - left > max) return max + 1;
+  }
+  return score;
+}
+
+inline std::size_t lcs_bits(std::uint64_t const* peq, std::size_t m, std::string_view text,
+                            std::uint64_t* v) noexcept {
+  std::size_t const blocks = blocks_for(m);
+  std::fill(v, v + blocks, ~std::uint64_t{0});
+  for (char c : text) {
+    std::uint64_t const* eq = peq + static_cast<unsigned char>(c) * blocks;
+    std::uint64_t carry = 0;
+    for (std::size_t b = 0; b < blocks; ++b) {
+      std::uint64_t const u = v[b] & eq[b];
+      std::uint64_t const sum = v[b] + u;
+      std::uint64_t const x = sum + carry;
+      carry = (sum < v[b]) | (x < sum);
+      v[b] = x | (v[b] - u);
+    }
+  }
+  // Zeros among the m real rows.
+  std::size_t ones = 0;
+  for (std::size_t b = 0; b + 1 < blocks; ++b) ones += static_cast<std::size_t>(popcount(v[b]));
+  std::uint64_t const tail = m % 64 ? (std::uint64_t{1} << (m % 64)) - 1 : ~std::uint64_t{0};
+  ones += static_cast<std::size_t>(popcount(v[blocks - 1] & tail));
+  return m - ones;
+}
+
+inline void order_by_length(std::string_view& pattern, std::string_view& text) noexcept {
+  if (pattern.size() > text.size()) std::swap(pattern, text);
+}
+
+// Masks on the stack for patterns of one word, else from mr.
+template <class F>
+auto with_match_masks(std::string_view pattern, std::pmr::memory_resource* mr, F&& f) {
+  std::size_t const blocks = blocks_for(pattern.size());
+  if (blocks == 1) {
+    std::uint64_t peq[256];
+    std::uint64_t state[2];
+    fill_match_masks(pattern, 1, peq);
+    return f(peq, state, state + 1);
+  }
+  scratch_buffer<std::uint64_t> buf(258 * blocks, mr);
+  fill_match_masks(pattern, blocks, buf.get());
+  return f(buf.get(), buf.get() + 256 * blocks, buf.get() + 257 * blocks);
+}
+
+}  // namespace detail::dp
+
+// Levenshtein distance: the fewest single-byte insertions, deletions and
+// substitutions that turn a into b.
+inline std::size_t edit_distance(std::string_view a, std::string_view b,
+                                 std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::dp::order_by_length(a, b);
+  if (a.empty()) return b.size();
+  return detail::dp::with_match_masks(a, mr, [&](auto peq, auto pv, auto mv) {
+    return detail::dp::myers(peq, a.size(), b, detail::dp::no_bound, pv, mv);
+  });
+}
+
+// Same, but any distance above max is reported as max + 1, which lets the
+// computation stop early.
+inline std::size_t edit_distance(std::string_view a, std::string_view b, std::size_t max,
+                                 std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::dp::order_by_length(a, b);
+  if (b.size() - a.size() > max) return max + 1;
+  if (a.empty()) return b.size();
+  return detail::dp::with_match_masks(a, mr, [&](auto peq, auto pv, auto mv) {
+    return detail::dp::myers(peq, a.size(), b, max, pv, mv);
+  });
+}
+
+// Length of the longest common subsequence of a and b.
+inline std::size_t lcs_length(std::string_view a, std::string_view b,
+                              std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::dp::order_by_length(a, b);
+  if (a.empty()) return 0;
+  return detail::dp::with_match_masks(a, mr, [&](auto peq, auto v, auto) {
+    return detail::dp::lcs_bits(peq, a.size(), b, v);
+  });
+}
+
+// One string compared with many: the pattern's match masks are built once,
+// and the pattern itself is not kept.
+class edit_distance_matcher {
+ public:
+  explicit edit_distance_matcher(std::string_view pattern,
+                                 std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : m_(pattern.size()),
+        peq_(256 * detail::dp::blocks_for(m_), mr),
+        state_(2 * detail::dp::blocks_for(m_), mr) {
+    detail::dp::fill_match_masks(pattern, detail::dp::blocks_for(m_), peq_.data());
+  }
+
+  std::size_t pattern_size() const noexcept { return m_; }
+
+  // edit_distance(pattern, text[, max]). Not safe to call concurrently on
+  // one matcher: the column state is kept in the object.
+  std::size_t distance(std::string_view text) noexcept {
+    return distance(text, detail::dp::no_bound);
+  }
+  std::size_t distance(std::string_view text, std::size_t max) noexcept {
+    std::size_t const gap = text.size() > m_ ? text.size() - m_ : m_ - text.size();
+    if (gap > max) return max + 1;
+    if (m_ == 0) return text.size();
+    if (text.empty()) return m_;
+    std::size_t const blocks = detail::dp::blocks_for(m_);
+    return detail::dp::myers(peq_.data(), m_, text, max, state_.data(),
+                             state_.data() + blocks);
+  }
+
+ private:
+  std::size_t m_;
+  std::pmr::vector<std::uint64_t> peq_;
+  std::pmr::vector<std::uint64_t> state_;
+};
+
+}  // namespace algoritmi
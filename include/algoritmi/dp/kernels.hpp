@@ -0,0 +1,218 @@
+// Local alignment (Smith-Waterman) score kernels, one version per
+// instruction set, selected like the search kernels (see cpu.hpp).
+//
+// The recurrence H[i][j] = max(0, H[i-1][j-1] + s(a_i, b_j),
+// H[i-1][j] + gap, H[i][j-1] + gap) makes every cell depend on its left,
+// upper and upper-left neighbours, so the cells of one anti-diagonal
+// (i + j constant) are independent. The SIMD kernels sweep anti-diagonals
+// and compute 8 (SSE4.2) or 16 (AVX2) cells per instruction in saturating
+// 16-bit lanes, keeping only the last two diagonals. With b stored
+// reversed, the characters paired along a diagonal are contiguous in both
+// strings and one byte compare yields the substitution scores. If a score
+// reaches the 16-bit limit the kernel starts over with the scalar one,
+// which sweeps rows in 64-bit arithmetic.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/scratch.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::dp {
+
+struct local_params {
+  std::int64_t match;
+  std::int64_t mismatch;
+  std::int64_t gap;
+};
+
+// ---------------------------------------------------------------- scalar --
+
+inline std::int64_t local_score_scalar(char const* a, std::size_t m, char const* b, std::size_t n,
+                                       local_params const& s, std::pmr::memory_resource* mr) {
+  scratch_buffer<std::int64_t> row(n + 1, mr);
+  std::fill(row.get(), row.get() + n + 1, 0);
+  std::int64_t best = 0;
+  for (std::size_t i = 0; i < m; ++i) {
+    std::int64_t diag = 0, left = 0;
+    for (std::size_t j = 1; j <= n; ++j) {
+      std::int64_t const up = row[j];
+      std::int64_t h = diag + (a[i] == b[j - 1] ? s.match : s.mismatch);
+      h = std::max(h, std::max(up, left) + s.gap);
+      h = std::max<std::int64_t>(h, 0);
+      diag = up;
+      row[j] = left = h;
+      best = std::max(best, h);
+    }
+  }
+  return best;
+}
+
+#if ALGORITMI_HAS_SIMD
+
+// 16-bit lane operations. equal() compares the bytes at a and b lane by lane.
+struct sse_dp_ops {
+  using vec = __m128i;
+  static constexpr std::size_t lanes = 8;
+
+  ALGORITMI_TARGET_SSE42 static vec load(std::int16_t const* p) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static void store(std::int16_t* p, vec v) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::int16_t x) noexcept { return _mm_set1_epi16(x); }
+  ALGORITMI_TARGET_SSE42 static vec zero() noexcept { return _mm_setzero_si128(); }
+  ALGORITMI_TARGET_SSE42 static vec equal(char const* a, char const* b) noexcept {
+    __m128i const x = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(a));
+    __m128i const y = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(b));
+    return _mm_cvtepi8_epi16(_mm_cmpeq_epi8(x, y));
+  }
+  ALGORITMI_TARGET_SSE42 static vec adds(vec x, vec y) noexcept { return _mm_adds_epi16(x, y); }
+  ALGORITMI_TARGET_SSE42 static vec max(vec x, vec y) noexcept { return _mm_max_epi16(x, y); }
+  ALGORITMI_TARGET_SSE42 static vec select(vec mask, vec yes, vec no) noexcept {
+    return _mm_blendv_epi8(no, yes, mask);
+  }
+  ALGORITMI_TARGET_SSE42 static std::int16_t hmax(vec v) noexcept {
+    v = _mm_max_epi16(v, _mm_shuffle_epi32(v, 0x4e));
+    v = _mm_max_epi16(v, _mm_shuffle_epi32(v, 0xb1));
+    v = _mm_max_epi16(v, _mm_shufflelo_epi16(v, 0xb1));
+    return static_cast<std::int16_t>(_mm_extract_epi16(v, 0));
+  }
+};
+
+struct avx2_dp_ops {
+  using vec = __m256i;
+  static constexpr std::size_t lanes = 16;
+
+  ALGORITMI_TARGET_AVX2 static vec load(std::int16_t const* p) noexcept {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static void store(std::int16_t* p, vec v) noexcept {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::int16_t x) noexcept { return _mm256_set1_epi16(x); }
+  ALGORITMI_TARGET_AVX2 static vec zero() noexcept { return _mm256_setzero_si256(); }
+  ALGORITMI_TARGET_AVX2 static vec equal(char const* a, char const* b) noexcept {
+    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a));
+    __m128i const y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b));
+    return _mm256_cvtepi8_epi16(_mm_cmpeq_epi8(x, y));
+  }
+  ALGORITMI_TARGET_AVX2 static vec adds(vec x, vec y) noexcept { return _mm256_adds_epi16(x, y); }
+  ALGORITMI_TARGET_AVX2 static vec max(vec x, vec y) noexcept { return _mm256_max_epi16(x, y); }
+  ALGORITMI_TARGET_AVX2 static vec select(vec mask, vec yes, vec no) noexcept {
+    return _mm256_blendv_epi8(no, yes, mask);
+  }
+  ALGORITMI_TARGET_AVX2 static std::int16_t hmax(vec v) noexcept {
+    __m128i x = _mm_max_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_max_epi16(x, _mm_shuffle_epi32(x, 0x4e));
+    x = _mm_max_epi16(x, _mm_shuffle_epi32(x, 0xb1));
+    x = _mm_max_epi16(x, _mm_shufflelo_epi16(x, 0xb1));
+    return static_cast<std::int16_t>(_mm_extract_epi16(x, 0));
+  }
+};
+
+inline constexpr std::int16_t score_limit = 32767;
+
+// Whether every intermediate value fits a saturating 16-bit lane without
+// wrapping: parameters small enough that one step cannot jump past the
+// saturation point from a valid score.
+inline bool fits_16bit(local_params const& s) noexcept {
+  auto ok = [](std::int64_t x) { return x >= -16384 && x <= 16384; };
+  return ok(s.match) && ok(s.mismatch) && ok(s.gap);
+}
+
+// Diagonal d holds cells (i, d - i); diag[d % 3][i] is H[i][d - i], with
+// index 0 (row 0) and any index not yet on a diagonal left at zero, which
+// are exactly the boundary cells the recurrence reads.
+#define ALGORITMI_DP_KERNELS(TARGET, SUFFIX, OPS)                                          \
+  TARGET inline std::int64_t local_score_##SUFFIX(char const* a, std::size_t m,             \
+                                                  char const* b, std::size_t n,             \
+                                                  local_params const& s,                    \
+                                                  std::pmr::memory_resource* mr) {          \
+    using ops = OPS;                                                                       \
+    constexpr std::size_t L = ops::lanes;                                                  \
+    if (!fits_16bit(s) || m < L) return local_score_scalar(a, m, b, n, s, mr);              \
+    std::size_t const stride = m + 1 + L;                                                  \
+    scratch_buffer<std::int16_t> buf(3 * stride, mr);                                      \
+    std::fill(buf.get(), buf.get() + 3 * stride, std::int16_t{0});                         \
+    scratch_buffer<char> rb(n, mr);                                                        \
+    std::reverse_copy(b, b + n, rb.get());                                                 \
+    auto const match = ops::set1(static_cast<std::int16_t>(s.match));                      \
+    auto const mismatch = ops::set1(static_cast<std::int16_t>(s.mismatch));                \
+    auto const gap = ops::set1(static_cast<std::int16_t>(s.gap));                          \
+    auto const zero = ops::zero();                                                         \
+    auto best = zero;                                                                      \
+    std::int64_t tail_best = 0;                                                            \
+    for (std::size_t d = 2; d <= m + n; ++d) {                                             \
+      std::int16_t* const cur = buf.get() + d % 3 * stride;                                \
+      std::int16_t const* const up = buf.get() + (d - 1) % 3 * stride;                     \
+      std::int16_t const* const diag = buf.get() + (d - 2) % 3 * stride;                   \
+      std::size_t const lo = d > n + 1 ? d - n : 1;                                        \
+      std::size_t const hi = std::min(m, d - 1);                                           \
+      /* b[d - i - 1] is rb[n + i - d], in range for i >= lo. */                           \
+      std::size_t i = lo;                                                                  \
+      for (; i + L <= hi + 1; i += L) {                                                    \
+        auto const sub = ops::select(ops::equal(a + i - 1, rb.get() + (n + i - d)), match, \
+                                     mismatch);                                            \
+        auto h = ops::adds(ops::load(diag + i - 1), sub);                                  \
+        h = ops::max(h, ops::adds(ops::max(ops::load(up + i - 1), ops::load(up + i)), gap)); \
+        h = ops::max(h, zero);                                                             \
+        ops::store(cur + i, h);                                                            \
+        best = ops::max(best, h);                                                          \
+      }                                                                                    \
+      for (; i <= hi; ++i) {                                                               \
+        std::int64_t h = diag[i - 1] + (a[i - 1] == rb[n + i - d] ? s.match : s.mismatch); \
+        h = std::max(h, std::max<std::int64_t>(up[i - 1], up[i]) + s.gap);                 \
+        h = std::min<std::int64_t>(std::max<std::int64_t>(h, 0), score_limit);             \
+        cur[i] = static_cast<std::int16_t>(h);                                             \
+        tail_best = std::max(tail_best, h);                                                \
+      }                                                                                    \
+    }                                                                                      \
+    std::int64_t const result = std::max<std::int64_t>(ops::hmax(best), tail_best);        \
+    if (result >= score_limit) return local_score_scalar(a, m, b, n, s, mr);               \
+    return result;                                                                         \
+  }
+
+ALGORITMI_DP_KERNELS(ALGORITMI_TARGET_SSE42, sse42, sse_dp_ops)
+ALGORITMI_DP_KERNELS(ALGORITMI_TARGET_AVX2, avx2, avx2_dp_ops)
+
+#undef ALGORITMI_DP_KERNELS
+
+#endif  // ALGORITMI_HAS_SIMD
+
+struct kernel_table {
+  std::int64_t (*local_score)(char const*, std::size_t, char const*, std::size_t,
+                              local_params const&, std::pmr::memory_resource*);
+};
+
+inline kernel_table make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  switch (usable_isa(which)) {
+    case isa::avx2:
+      return {&local_score_avx2};
+    case isa::sse42:
+      return {&local_score_sse42};
+    default:
+      break;
+  }
+#else
+  (void)which;
+#endif
+  return {&local_score_scalar};
+}
+
+inline kernel_table const& kernels() noexcept {
+  static kernel_table const table = make_kernel_table(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::dp
@@ -0,0 +1,97 @@
+// 0/1 knapsack by dynamic programming over capacities.
+//
+// knapsack_value keeps one row of best[c], the best value of the items so
+// far with total weight at most c: O(nW) time, O(W) memory. knapsack also
+// recovers the items without the n x W table, the way Hirschberg recovers
+// an alignment: the rows of the two halves of the items are combined to
+// find how much capacity the optimum gives each half, and each half is
+// solved the same way. O(nW log n) time, O(W) memory.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../detail/scratch.hpp"
+#include "../span.hpp"
+
+namespace algoritmi {
+
+struct knapsack_result {
+  std::int64_t value = 0;
+  std::pmr::vector<std::size_t> items;  // increasing indices
+};
+
+namespace detail::dp {
+
+inline void check_items(span<std::size_t const> weights, span<std::int64_t const> values) {
+  if (weights.size() != values.size())
+    throw std::invalid_argument("knapsack: weights and values differ in length");
+}
+
+// best[c] over items [first, last), c <= capacity.
+inline void knapsack_row(span<std::size_t const> weights, span<std::int64_t const> values,
+                         std::size_t first, std::size_t last, std::size_t capacity,
+                         std::int64_t* best) noexcept {
+  std::fill(best, best + capacity + 1, 0);
+  for (std::size_t k = first; k < last; ++k) {
+    std::size_t const w = weights[k];
+    std::int64_t const v = values[k];
+    if (w > capacity || v <= 0) continue;
+    for (std::size_t c = capacity; c >= w; --c) {
+      best[c] = std::max(best[c], best[c - w] + v);
+      if (c == 0) break;
+    }
+  }
+}
+
+inline void knapsack_items(span<std::size_t const> weights, span<std::int64_t const> values,
+                           std::size_t first, std::size_t last, std::size_t capacity,
+                           std::pmr::vector<std::size_t>& items, std::pmr::memory_resource* mr) {
+  if (last - first == 1) {
+    if (weights[first] <= capacity && values[first] > 0) items.push_back(first);
+    return;
+  }
+  std::size_t const mid = first + (last - first) / 2;
+  std::size_t split = 0;
+  {
+    scratch_buffer<std::int64_t> low(capacity + 1, mr), high(capacity + 1, mr);
+    knapsack_row(weights, values, first, mid, capacity, low.get());
+    knapsack_row(weights, values, mid, last, capacity, high.get());
+    std::int64_t best = low[0] + high[capacity];
+    for (std::size_t c = 1; c <= capacity; ++c)
+      if (low[c] + high[capacity - c] > best) best = low[c] + high[capacity - c], split = c;
+  }
+  knapsack_items(weights, values, first, mid, split, items, mr);
+  knapsack_items(weights, values, mid, last, capacity - split, items, mr);
+}
+
+}  // namespace detail::dp
+
+// Largest total value of a subset of the items with total weight at most
+// capacity. Item k weighs weights[k] and is worth values[k].
+inline std::int64_t knapsack_value(
+    span<std::size_t const> weights, span<std::int64_t const> values, std::size_t capacity,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::dp::check_items(weights, values);
+  detail::scratch_buffer<std::int64_t> best(capacity + 1, mr);
+  detail::dp::knapsack_row(weights, values, 0, weights.size(), capacity, best.get());
+  return best[capacity];
+}
+
+// The value and one subset achieving it.
+inline knapsack_result knapsack(span<std::size_t const> weights, span<std::int64_t const> values,
+                                std::size_t capacity,
+                                std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::dp::check_items(weights, values);
+  knapsack_result result{0, std::pmr::vector<std::size_t>(mr)};
+  if (weights.empty()) return result;
+  detail::dp::knapsack_items(weights, values, 0, weights.size(), capacity, result.items, mr);
+  for (std::size_t k : result.items) result.value += values[k];
+  return result;
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,22 @@
+// Execution policies accepted by algorithms that have a parallel mode.
+#pragma once
+
+#include <cstddef>
+
+namespace algoritmi {
+
+struct sequenced_policy {};
+
+struct parallel_policy {
+  // 0 uses current_executor().concurrency() (scheduler/executor.hpp).
+  unsigned threads = 0;
+
+  constexpr parallel_policy with_threads(unsigned n) const noexcept {
+    return parallel_policy{n};
+  }
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+
+}  // namespace algoritmi
@@ -0,0 +1,25 @@
+// Fast Fourier and number-theoretic transforms, and the convolutions built
+// on them.
+//
+//   fft_plan(n)                    complex FFT of a power-of-two size n,
+//                                  radix-4, twiddles precomputed
+//   ntt_plan<P>(n)                 NTT modulo a prime P with 2^k | P - 1,
+//                                  Montgomery arithmetic
+//   convolve(a, b)                 real convolution, overlap-save when one
+//                                  sequence is much shorter
+//   convolve_mod<P>(a, b)          exact convolution modulo P
+//   bigint_multiply(a, b)          product of integers in 32-bit limbs
+//
+// The FFT butterflies use AVX2 with FMA when the host has both, picked at
+// runtime like the search kernels (see cpu.hpp); an fft_plan overload
+// taking an `isa` runs a specific one. Transforms and convolutions have
+// `par` overloads that split the work among the threads of the shared
+// scheduler.
+#pragma once
+
+#include "fft/convolution.hpp"
+#include "fft/kernels.hpp"
+#include "fft/montgomery.hpp"
+#include "fft/ntt.hpp"
+#include "fft/plan.hpp"
+#include "fft/schedule.hpp"
@@ -0,0 +1,370 @@
+// Convolutions on top of the transforms: of real sequences by the complex
+// FFT, of residues by the NTT, and of big integers by two NTTs and the
+// Chinese remainder theorem.
+//
+// All of them multiply spectra pointwise in the bit-reversed order the
+// forward transforms leave, so no permutation pass runs. Real inputs go
+// through one complex transform of a + ib, whose spectrum Z gives
+// DFT(a) DFT(b) at k as (Z[k]^2 - conj(Z[n-k])^2) / 4i; in bit-reversed
+// order the partner of position p in [2^m, 2^(m+1)) is 3 * 2^m - 1 - p.
+//
+// When one sequence is much longer than the other, as when matching a
+// short template against a long signal, transforms of the whole output
+// would cost O((n + m) log(n + m)) and memory for all of it. Overlap-save
+// instead cuts the output into blocks of N - m + 1 for a transform length
+// N of about 8m: each block is the tail of a cyclic convolution of N input
+// points with the shorter sequence, whose spectrum is computed once, and
+// two blocks share one complex transform as its real and imaginary parts.
+// Blocks are independent, which is how the `par` overloads split them.
+//
+// Integers are multiplied in 16-bit pieces: a coefficient of the product
+// is a sum of at most 2^24 products below 2^32, under 2^56, and the two
+// primes 469762049 and 167772161 recover it exactly from its residues.
+// That bounds the product at 2^25 pieces, 2^24 32-bit limbs.
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../detail/bits.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "../span.hpp"
+#include "kernels.hpp"
+#include "montgomery.hpp"
+#include "ntt.hpp"
+#include "plan.hpp"
+
+namespace algoritmi {
+
+// Shorter sequences than this are convolved by the quadratic loop.
+inline constexpr std::size_t convolution_cutoff = 32;
+
+// Integers with fewer limbs than this (either factor) are multiplied by
+// the schoolbook loop.
+inline constexpr std::size_t bigint_ntt_cutoff = 96;
+
+namespace detail::fft {
+
+struct access {
+  template <class Plan, class... Args>
+  static void forward(Plan const& plan, Args... args) {
+    plan.forward_bit_reversed(args...);
+  }
+  template <class Plan, class... Args>
+  static void inverse(Plan const& plan, Args... args) {
+    plan.inverse_bit_reversed(args...);
+  }
+  // 1 / n with the factor R^-1 of a Montgomery product taken back:
+  // R^2 / n in Montgomery form.
+  template <std::uint32_t P>
+  static std::uint32_t product_scale(ntt_plan<P> const& plan) {
+    return montgomery<P>::to_mont(plan.n_inv_);
+  }
+};
+
+inline std::size_t bit_ceil(std::size_t n) noexcept {
+  return n <= 1 ? 1 : std::size_t{1} << bit_width(n - 1);
+}
+
+// Points handled per task by the elementwise passes.
+inline constexpr std::size_t pass_points = std::size_t{1} << 14;
+
+// Calls fn(first, last) on runs of [0, n).
+template <class Fn>
+void parallel_runs(std::size_t n, unsigned threads, Fn&& fn) {
+  if (n < parallel_threshold) threads = 1;
+  parallel_for((n + pass_points - 1) / pass_points, threads, [&](std::size_t t) {
+    fn(t * pass_points, std::min(n, (t + 1) * pass_points));
+  });
+}
+
+// out[i + j] += a[i] b[j], the inner loop over the longer a.
+inline void direct_convolution(double const* a, std::size_t na, double const* b, std::size_t nb,
+                               double* out) noexcept {
+  for (std::size_t j = 0; j < nb; ++j) {
+    double* const o = out + j;
+    double const bj = b[j];
+    for (std::size_t i = 0; i < na; ++i) o[i] += a[i] * bj;
+  }
+}
+
+// z = DFT(a + ib) in bit-reversed order -> DFT(a * b) / n, same order.
+inline void real_product(std::complex<double>* zc, std::size_t n, unsigned threads) {
+  double* const z = reinterpret_cast<double*>(zc);
+  double const half = 0.5 / static_cast<double>(n), quarter = 0.25 / static_cast<double>(n);
+  for (std::size_t p = 0; p < 2; ++p) {
+    z[2 * p] = z[2 * p] * z[2 * p + 1] / static_cast<double>(n);
+    z[2 * p + 1] = 0;
+  }
+  for (std::size_t s = 2; s < n; s *= 2) {
+    parallel_runs(s / 2, threads, [&](std::size_t i0, std::size_t i1) {
+      for (std::size_t i = i0; i < i1; ++i) {
+        double* const zp = z + 2 * (s + i);
+        double* const zq = z + 2 * (2 * s - 1 - i);
+        double const a = zp[0], b = zp[1], c = zq[0], d = zq[1];
+        double const re = (a * b + c * d) * half;
+        double const im = (b * b - a * a + c * c - d * d) * quarter;
+        zp[0] = zq[0] = re;
+        zp[1] = im;
+        zq[1] = -im;
+      }
+    });
+  }
+}
+
+// One transform of the whole output.
+inline void convolve_whole(double const* a, std::size_t na, double const* b, std::size_t nb,
+                           double* out, unsigned threads, std::pmr::memory_resource* mr) {
+  std::size_t const len = na + nb - 1, n = bit_ceil(len);
+  fft_plan const plan(n, mr);
+  scratch_buffer<std::complex<double>> z(n, mr, cache_line_size);
+  parallel_runs(n, threads, [&](std::size_t i0, std::size_t i1) {
+    for (std::size_t i = i0; i < i1; ++i)
+      z[i] = {i < na ? a[i] : 0.0, i < nb ? b[i] : 0.0};
+  });
+  kernel_table const& k = kernels();
+  double* const zd = reinterpret_cast<double*>(z.get());
+  access::forward(plan, k, zd, threads);
+  real_product(z.get(), n, threads);
+  access::inverse(plan, k, zd, threads);
+  parallel_runs(len, threads, [&](std::size_t i0, std::size_t i1) {
+    for (std::size_t i = i0; i < i1; ++i) out[i] = zd[2 * i];
+  });
+}
+
+// Overlap-save of the long x with the short h, block transforms of n.
+inline void convolve_blocks(double const* x, std::size_t nx, double const* h, std::size_t nh,
+                            std::size_t n, double* out, unsigned threads,
+                            std::pmr::memory_resource* mr) {
+  std::size_t const len = nx + nh - 1, step = n - nh + 1;
+  std::size_t const pairs = (len + 2 * step - 1) / (2 * step);
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, pairs));
+  std::pmr::memory_resource* const task_mr = task_resource(threads, mr);
+  fft_plan const plan(n, mr);
+  kernel_table const& k = kernels();
+
+  // H / n, bit-reversed.
+  scratch_buffer<std::complex<double>> spectrum(n, mr, cache_line_size);
+  for (std::size_t i = 0; i < n; ++i)
+    spectrum[i] = {i < nh ? h[i] / static_cast<double>(n) : 0.0, 0.0};
+  access::forward(plan, k, reinterpret_cast<double*>(spectrum.get()), 1);
+  double const* const hs = reinterpret_cast<double const*>(spectrum.get());
+
+  // A contiguous range of block pairs per thread, one buffer for all.
+  parallel_for(threads, threads, [&](std::size_t t) {
+    scratch_buffer<std::complex<double>> zb(n, task_mr, cache_line_size);
+    double* const z = reinterpret_cast<double*>(zb.get());
+    for (std::size_t r = pairs * t / threads; r < pairs * (t + 1) / threads; ++r) {
+      // Output blocks o0 (real part) and o0 + step (imaginary part) read
+      // x[o - nh + 1, o - nh + 1 + n).
+      std::size_t const o0 = 2 * r * step, o1 = o0 + step;
+      for (std::size_t i = 0; i < n; ++i) {
+        std::size_t const i0 = o0 + i, i1 = o1 + i;  // x index + nh - 1
+        z[2 * i] = i0 >= nh - 1 && i0 - (nh - 1) < nx ? x[i0 - (nh - 1)] : 0.0;
+        z[2 * i + 1] = i1 >= nh - 1 && i1 - (nh - 1) < nx ? x[i1 - (nh - 1)] : 0.0;
+      }
+      access::forward(plan, k, z, 1);
+      for (std::size_t i = 0; i < 2 * n; i += 2) {
+        double const a = z[i], b = z[i + 1], c = hs[i], d = hs[i + 1];
+        z[i] = a * c - b * d;
+        z[i + 1] = a * d + b * c;
+      }
+      access::inverse(plan, k, z, 1);
+      // Cyclic outputs [nh - 1, n) are linear ones; the first nh - 1 wrapped.
+      for (std::size_t part = 0; part < 2; ++part) {
+        std::size_t const o = part ? o1 : o0;
+        if (o >= len) break;
+        std::size_t const count = std::min(step, len - o);
+        for (std::size_t i = 0; i < count; ++i) out[o + i] = z[2 * (nh - 1 + i) + part];
+      }
+    }
+  });
+}
+
+inline std::pmr::vector<double> convolve(span<double const> a, span<double const> b,
+                                         unsigned threads, std::pmr::memory_resource* mr) {
+  std::pmr::vector<double> out(mr);
+  if (a.empty() || b.empty()) return out;
+  if (a.size() < b.size()) std::swap(a, b);
+  out.resize(a.size() + b.size() - 1);
+  if (b.size() < convolution_cutoff) {
+    direct_convolution(a.data(), a.size(), b.data(), b.size(), out.data());
+    return out;
+  }
+  std::size_t const block = std::max<std::size_t>(std::size_t{1} << 12, 8 * bit_ceil(b.size()));
+  if (bit_ceil(out.size()) <= 2 * block)
+    convolve_whole(a.data(), a.size(), b.data(), b.size(), out.data(), threads, mr);
+  else
+    convolve_blocks(a.data(), a.size(), b.data(), b.size(), block, out.data(), threads, mr);
+  return out;
+}
+
+// Cyclic convolution modulo P of a and b, each zero-padded to plan.size()
+// and reduced mod P, into fa (which then holds the first plan.size()
+// coefficients). fb is scratch of the same size.
+template <std::uint32_t P>
+void ntt_product(ntt_plan<P> const& plan, span<std::uint32_t const> a,
+                 span<std::uint32_t const> b, std::uint32_t* fa, std::uint32_t* fb,
+                 unsigned threads) {
+  using mont = montgomery<P>;
+  std::size_t const n = plan.size();
+  parallel_runs(n, threads, [&](std::size_t i0, std::size_t i1) {
+    for (std::size_t i = i0; i < i1; ++i) {
+      fa[i] = i < a.size() ? a[i] % P : 0;
+      fb[i] = i < b.size() ? b[i] % P : 0;
+    }
+  });
+  access::forward(plan, fa, threads);
+  access::forward(plan, fb, threads);
+  std::uint32_t const scale = access::product_scale(plan);
+  parallel_runs(n, threads, [&](std::size_t i0, std::size_t i1) {
+    for (std::size_t i = i0; i < i1; ++i) fa[i] = mont::mul(mont::mul(fa[i], fb[i]), scale);
+  });
+  access::inverse(plan, fa, threads);
+}
+
+template <std::uint32_t P>
+std::pmr::vector<std::uint32_t> convolve_mod(span<std::uint32_t const> a,
+                                             span<std::uint32_t const> b, unsigned threads,
+                                             std::pmr::memory_resource* mr) {
+  std::pmr::vector<std::uint32_t> out(mr);
+  if (a.empty() || b.empty()) return out;
+  std::size_t const len = a.size() + b.size() - 1;
+  if (std::min(a.size(), b.size()) < convolution_cutoff) {
+    out.assign(len, 0);
+    for (std::size_t j = 0; j < b.size(); ++j) {
+      std::uint64_t const bj = b[j] % P;
+      for (std::size_t i = 0; i < a.size(); ++i)
+        out[i + j] = static_cast<std::uint32_t>((out[i + j] + a[i] % P * bj) % P);
+    }
+    return out;
+  }
+  if (bit_ceil(len) > ntt_plan<P>::max_size())
+    throw std::length_error("convolve_mod: product longer than the modulus allows");
+  ntt_plan<P> const plan(bit_ceil(len), mr);
+  out.resize(plan.size());
+  scratch_buffer<std::uint32_t> fb(plan.size(), mr, cache_line_size);
+  ntt_product(plan, a, b, out.data(), fb.get(), threads);
+  out.resize(len);
+  return out;
+}
+
+inline constexpr std::uint32_t crt_p1 = 469762049, crt_p2 = 167772161;
+
+inline std::pmr::vector<std::uint32_t> bigint_multiply(span<std::uint32_t const> a,
+                                                       span<std::uint32_t const> b,
+                                                       unsigned threads,
+                                                       std::pmr::memory_resource* mr) {
+  std::pmr::vector<std::uint32_t> out(a.size() + b.size(), 0, mr);
+  if (a.empty() || b.empty()) return out;
+  if (std::min(a.size(), b.size()) < bigint_ntt_cutoff) {
+    if (a.size() < b.size()) std::swap(a, b);
+    for (std::size_t j = 0; j < b.size(); ++j) {
+      std::uint64_t carry = 0;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+        carry += std::uint64_t{a[i]} * b[j] + out[i + j];
+        out[i + j] = static_cast<std::uint32_t>(carry);
+        carry >>= 32;
+      }
+      out[a.size() + j] = static_cast<std::uint32_t>(carry);
+    }
+    return out;
+  }
+  std::size_t const pieces = 2 * out.size() - 1, n = bit_ceil(pieces);
+  if (n > ntt_plan<crt_p2>::max_size())
+    throw std::length_error("bigint_multiply: operands too long");
+
+  auto const split = [&](span<std::uint32_t const> x, std::pmr::vector<std::uint32_t>& v) {
+    v.resize(2 * x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      v[2 * i] = x[i] & 0xffff;
+      v[2 * i + 1] = x[i] >> 16;
+    }
+  };
+  std::pmr::vector<std::uint32_t> sa(mr), sb(mr);
+  split(a, sa);
+  split(b, sb);
+  scratch_buffer<std::uint32_t> r1(n, mr, cache_line_size), r2(n, mr, cache_line_size);
+  scratch_buffer<std::uint32_t> tmp(n, mr, cache_line_size);
+  ntt_product(ntt_plan<crt_p1>(n, mr), span<std::uint32_t const>(sa),
+              span<std::uint32_t const>(sb), r1.get(), tmp.get(), threads);
+  ntt_product(ntt_plan<crt_p2>(n, mr), span<std::uint32_t const>(sa),
+              span<std::uint32_t const>(sb), r2.get(), tmp.get(), threads);
+
+  // Garner: c = r1 + p1 ((r2 - r1) p1^-1 mod p2), then carries in base 2^16.
+  using m2 = montgomery<crt_p2>;
+  std::uint32_t const p1_inv = m2::pow(m2::to_mont(crt_p1 % crt_p2), crt_p2 - 2);
+  std::uint64_t carry = 0;
+  for (std::size_t i = 0; i < pieces; ++i) {
+    std::uint32_t const k = m2::mul(m2::sub(r2[i], r1[i] % crt_p2), p1_inv);
+    carry += r1[i] + std::uint64_t{crt_p1} * k;
+    if (i % 2 == 0)
+      out[i / 2] = static_cast<std::uint32_t>(carry & 0xffff);
+    else
+      out[i / 2] |= static_cast<std::uint32_t>(carry & 0xffff) << 16;
+    carry >>= 16;
+  }
+  out.back() |= static_cast<std::uint32_t>(carry) << 16;
+  return out;
+}
+
+}  // namespace detail::fft
+
+// a * b for real sequences: out[k] = sum a[i] b[k - i], a.size() + b.size()
+// - 1 values (none if either is empty). Sequences shorter than
+// convolution_cutoff take the direct loop, a long one against a short one
+// overlap-save blocks, others one transform of the whole output. Errors
+// are those of the FFT: about eps log2(n) times the norms of a and b.
+inline std::pmr::vector<double> convolve(
+    span<double const> a, span<double const> b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::fft::convolve(a, b, 1, mr);
+}
+
+inline std::pmr::vector<double> convolve(
+    parallel_policy policy, span<double const> a, span<double const> b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::fft::convolve(a, b, detail::resolve_threads(policy.threads), mr);
+}
+
+// a * b modulo P, exactly; inputs need not be reduced. Throws
+// std::length_error if the product needs a transform longer than
+// ntt_plan<P>::max_size().
+template <std::uint32_t P>
+std::pmr::vector<std::uint32_t> convolve_mod(
+    span<std::uint32_t const> a, span<std::uint32_t const> b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::fft::convolve_mod<P>(a, b, 1, mr);
+}
+
+template <std::uint32_t P>
+std::pmr::vector<std::uint32_t> convolve_mod(
+    parallel_policy policy, span<std::uint32_t const> a, span<std::uint32_t const> b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::fft::convolve_mod<P>(a, b, detail::resolve_threads(policy.threads), mr);
+}
+
+// Product of two unsigned integers given as little-endian 32-bit limbs:
+// a.size() + b.size() limbs, leading zeros kept. Throws std::length_error
+// above 2^24 limbs in all.
+inline std::pmr::vector<std::uint32_t> bigint_multiply(
+    span<std::uint32_t const> a, span<std::uint32_t const> b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::fft::bigint_multiply(a, b, 1, mr);
+}
+
+inline std::pmr::vector<std::uint32_t> bigint_multiply(
+    parallel_policy policy, span<std::uint32_t const> a, span<std::uint32_t const> b,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::fft::bigint_multiply(a, b, detail::resolve_threads(policy.threads), mr);
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,235 @@
+// Radix-4 butterflies of the complex FFT, one version per instruction set,
+// selected like the search kernels (see cpu.hpp).
+//
+// A stage of an n-point transform cuts the array into blocks of 4q points
+// and runs q butterflies on each; butterfly j combines points j, j + q,
+// j + 2q and j + 3q of its block. The forward transform runs decimation in
+// frequency (DIF): a 4-point DFT, then a multiply by the twiddles w^j,
+// w^2j, w^3j, w = exp(-2 pi i / 4q). The inverse runs decimation in time
+// (DIT), the same steps backwards with conjugated twiddles, so one table
+// serves both. Outputs 1 and 2 of each 4-point DFT trade places, which
+// leaves a forward transform in plain bit-reversed order whatever mix of
+// radix-4 and radix-2 stages it took (plan.hpp).
+//
+// Points are interleaved complex doubles. The AVX2 kernel holds two of
+// them per ymm register and so runs butterflies j and j + 1 together: the
+// complex multiplies are a movedup, two permutes and an fmaddsub (fmsubadd
+// for the conjugate), 6 instructions for 2 products. It needs FMA3 besides
+// AVX2; without it the scalar kernel runs, written out on the real and
+// imaginary parts because std::complex multiplication checks for NaNs.
+#pragma once
+
+#include <cstddef>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::fft {
+
+// `count` butterflies of a block of 4q points, from the one whose first
+// point is at x; w1, w2, w3 point at their twiddles w^j, w^2j, w^3j.
+using butterfly_fn = void (*)(double* x, std::size_t q, std::size_t count, double const* w1,
+                              double const* w2, double const* w3);
+
+// ---------------------------------------------------------------- scalar --
+
+inline void dif_scalar(double* x, std::size_t q, std::size_t count, double const* w1,
+                       double const* w2, double const* w3) noexcept {
+  double* x0 = x;
+  double* x1 = x + 2 * q;
+  double* x2 = x + 4 * q;
+  double* x3 = x + 6 * q;
+  for (std::size_t j = 0; j < 2 * count; j += 2) {
+    double const t0r = x0[j] + x2[j], t0i = x0[j + 1] + x2[j + 1];
+    double const t1r = x0[j] - x2[j], t1i = x0[j + 1] - x2[j + 1];
+    double const t2r = x1[j] + x3[j], t2i = x1[j + 1] + x3[j + 1];
+    double const t3r = x1[j] - x3[j], t3i = x1[j + 1] - x3[j + 1];
+    // y1 = t1 - i t3, y3 = t1 + i t3
+    double const y1r = t1r + t3i, y1i = t1i - t3r;
+    double const y2r = t0r - t2r, y2i = t0i - t2i;
+    double const y3r = t1r - t3i, y3i = t1i + t3r;
+    x0[j] = t0r + t2r;
+    x0[j + 1] = t0i + t2i;
+    x1[j] = y2r * w2[j] - y2i * w2[j + 1];
+    x1[j + 1] = y2r * w2[j + 1] + y2i * w2[j];
+    x2[j] = y1r * w1[j] - y1i * w1[j + 1];
+    x2[j + 1] = y1r * w1[j + 1] + y1i * w1[j];
+    x3[j] = y3r * w3[j] - y3i * w3[j + 1];
+    x3[j + 1] = y3r * w3[j + 1] + y3i * w3[j];
+  }
+}
+
+inline void dit_scalar(double* x, std::size_t q, std::size_t count, double const* w1,
+                       double const* w2, double const* w3) noexcept {
+  double* x0 = x;
+  double* x1 = x + 2 * q;
+  double* x2 = x + 4 * q;
+  double* x3 = x + 6 * q;
+  for (std::size_t j = 0; j < 2 * count; j += 2) {
+    // u2 = x1 conj(w2), u1 = x2 conj(w1), u3 = x3 conj(w3)
+    double const u2r = x1[j] * w2[j] + x1[j + 1] * w2[j + 1];
+    double const u2i = x1[j + 1] * w2[j] - x1[j] * w2[j + 1];
+    double const u1r = x2[j] * w1[j] + x2[j + 1] * w1[j + 1];
+    double const u1i = x2[j + 1] * w1[j] - x2[j] * w1[j + 1];
+    double const u3r = x3[j] * w3[j] + x3[j + 1] * w3[j + 1];
+    double const u3i = x3[j + 1] * w3[j] - x3[j] * w3[j + 1];
+    double const t0r = x0[j] + u2r, t0i = x0[j + 1] + u2i;
+    double const t1r = x0[j] - u2r, t1i = x0[j + 1] - u2i;
+    double const t2r = u1r + u3r, t2i = u1i + u3i;
+    double const t3r = u1r - u3r, t3i = u1i - u3i;
+    // a1 = t1 + i t3, a3 = t1 - i t3
+    x0[j] = t0r + t2r;
+    x0[j + 1] = t0i + t2i;
+    x1[j] = t1r - t3i;
+    x1[j + 1] = t1i + t3r;
+    x2[j] = t0r - t2r;
+    x2[j + 1] = t0i - t2i;
+    x3[j] = t1r + t3i;
+    x3[j + 1] = t1i - t3r;
+  }
+}
+
+// The twiddle-free stages: 4-point blocks (q = 1) and the radix-2 stage
+// that ends a transform of odd log2 n, over `count` consecutive points. The
+// inverse of a 4-point DIF block is the DIT one; a radix-2 block is its own
+// inverse.
+inline void dif4_blocks(double* x, std::size_t count) noexcept {
+  for (double* end = x + 2 * count; x != end; x += 8) {
+    double const t0r = x[0] + x[4], t0i = x[1] + x[5];
+    double const t1r = x[0] - x[4], t1i = x[1] - x[5];
+    double const t2r = x[2] + x[6], t2i = x[3] + x[7];
+    double const t3r = x[2] - x[6], t3i = x[3] - x[7];
+    x[0] = t0r + t2r;
+    x[1] = t0i + t2i;
+    x[2] = t0r - t2r;
+    x[3] = t0i - t2i;
+    x[4] = t1r + t3i;
+    x[5] = t1i - t3r;
+    x[6] = t1r - t3i;
+    x[7] = t1i + t3r;
+  }
+}
+
+inline void dit4_blocks(double* x, std::size_t count) noexcept {
+  for (double* end = x + 2 * count; x != end; x += 8) {
+    double const t0r = x[0] + x[2], t0i = x[1] + x[3];
+    double const t1r = x[0] - x[2], t1i = x[1] - x[3];
+    double const t2r = x[4] + x[6], t2i = x[5] + x[7];
+    double const t3r = x[4] - x[6], t3i = x[5] - x[7];
+    x[0] = t0r + t2r;
+    x[1] = t0i + t2i;
+    x[2] = t1r - t3i;
+    x[3] = t1i + t3r;
+    x[4] = t0r - t2r;
+    x[5] = t0i - t2i;
+    x[6] = t1r + t3i;
+    x[7] = t1i - t3r;
+  }
+}
+
+inline void radix2_blocks(double* x, std::size_t count) noexcept {
+  for (double* end = x + 2 * count; x != end; x += 4) {
+    double const ar = x[0], ai = x[1];
+    x[0] = ar + x[2];
+    x[1] = ai + x[3];
+    x[2] = ar - x[2];
+    x[3] = ai - x[3];
+  }
+}
+
+#if ALGORITMI_HAS_SIMD
+
+// ------------------------------------------------------------------ AVX2 --
+
+// a * w and a * conj(w) on two complex numbers.
+ALGORITMI_TARGET_AVX2_FMA inline __m256d cmul_avx2(__m256d a, __m256d w) noexcept {
+  __m256d const wi = _mm256_permute_pd(w, 0xF);
+  __m256d const as = _mm256_permute_pd(a, 0x5);
+  return _mm256_fmaddsub_pd(a, _mm256_movedup_pd(w), _mm256_mul_pd(as, wi));
+}
+
+ALGORITMI_TARGET_AVX2_FMA inline __m256d cmul_conj_avx2(__m256d a, __m256d w) noexcept {
+  __m256d const wi = _mm256_permute_pd(w, 0xF);
+  __m256d const as = _mm256_permute_pd(a, 0x5);
+  return _mm256_fmsubadd_pd(a, _mm256_movedup_pd(w), _mm256_mul_pd(as, wi));
+}
+
+// -i a on two complex numbers: (re, im) -> (im, -re).
+ALGORITMI_TARGET_AVX2_FMA inline __m256d times_minus_i_avx2(__m256d a) noexcept {
+  return _mm256_xor_pd(_mm256_permute_pd(a, 0x5), _mm256_set_pd(-0.0, 0.0, -0.0, 0.0));
+}
+
+ALGORITMI_TARGET_AVX2_FMA inline void dif_avx2(double* x, std::size_t q, std::size_t count,
+                                               double const* w1, double const* w2,
+                                               double const* w3) noexcept {
+  double* x0 = x;
+  double* x1 = x + 2 * q;
+  double* x2 = x + 4 * q;
+  double* x3 = x + 6 * q;
+  std::size_t j = 0;
+  for (; j + 4 <= 2 * count; j += 4) {
+    __m256d const a0 = _mm256_loadu_pd(x0 + j), a1 = _mm256_loadu_pd(x1 + j);
+    __m256d const a2 = _mm256_loadu_pd(x2 + j), a3 = _mm256_loadu_pd(x3 + j);
+    __m256d const t0 = _mm256_add_pd(a0, a2), t1 = _mm256_sub_pd(a0, a2);
+    __m256d const t2 = _mm256_add_pd(a1, a3);
+    __m256d const t3 = times_minus_i_avx2(_mm256_sub_pd(a1, a3));
+    _mm256_storeu_pd(x0 + j, _mm256_add_pd(t0, t2));
+    _mm256_storeu_pd(x1 + j, cmul_avx2(_mm256_sub_pd(t0, t2), _mm256_loadu_pd(w2 + j)));
+    _mm256_storeu_pd(x2 + j, cmul_avx2(_mm256_add_pd(t1, t3), _mm256_loadu_pd(w1 + j)));
+    _mm256_storeu_pd(x3 + j, cmul_avx2(_mm256_sub_pd(t1, t3), _mm256_loadu_pd(w3 + j)));
+  }
+  if (j < 2 * count) dif_scalar(x + j, q, count - j / 2, w1 + j, w2 + j, w3 + j);
+}
+
+ALGORITMI_TARGET_AVX2_FMA inline void dit_avx2(double* x, std::size_t q, std::size_t count,
+                                               double const* w1, double const* w2,
+                                               double const* w3) noexcept {
+  double* x0 = x;
+  double* x1 = x + 2 * q;
+  double* x2 = x + 4 * q;
+  double* x3 = x + 6 * q;
+  std::size_t j = 0;
+  for (; j + 4 <= 2 * count; j += 4) {
+    __m256d const u0 = _mm256_loadu_pd(x0 + j);
+    __m256d const u2 = cmul_conj_avx2(_mm256_loadu_pd(x1 + j), _mm256_loadu_pd(w2 + j));
+    __m256d const u1 = cmul_conj_avx2(_mm256_loadu_pd(x2 + j), _mm256_loadu_pd(w1 + j));
+    __m256d const u3 = cmul_conj_avx2(_mm256_loadu_pd(x3 + j), _mm256_loadu_pd(w3 + j));
+    __m256d const t0 = _mm256_add_pd(u0, u2), t1 = _mm256_sub_pd(u0, u2);
+    __m256d const t2 = _mm256_add_pd(u1, u3);
+    __m256d const t3 = times_minus_i_avx2(_mm256_sub_pd(u1, u3));
+    _mm256_storeu_pd(x0 + j, _mm256_add_pd(t0, t2));
+    _mm256_storeu_pd(x1 + j, _mm256_sub_pd(t1, t3));
+    _mm256_storeu_pd(x2 + j, _mm256_sub_pd(t0, t2));
+    _mm256_storeu_pd(x3 + j, _mm256_add_pd(t1, t3));
+  }
+  if (j < 2 * count) dit_scalar(x + j, q, count - j / 2, w1 + j, w2 + j, w3 + j);
+}
+
+#endif  // ALGORITMI_HAS_SIMD
+
+// ---------------------------------------------------------------- tables --
+
+struct kernel_table {
+  butterfly_fn dif;
+  butterfly_fn dit;
+};
+
+inline kernel_table make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  if (usable_isa(which) == isa::avx2 && cpu().fma) return {&dif_avx2, &dit_avx2};
+#else
+  (void)which;
+#endif
+  return {&dif_scalar, &dit_scalar};
+}
+
+inline kernel_table const& kernels() noexcept {
+  static kernel_table const table = make_kernel_table(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::fft
@@ -0,0 +1,101 @@
+// Arithmetic modulo an NTT prime in Montgomery form (Montgomery, "Modular
+// multiplication without trial division", 1985).
+//
+// A residue x is represented by xR mod P with R = 2^32; the product of two
+// representations is reduced by one 32 x 32 multiply, one 32 x 32 -> 64
+// multiply-add and a shift, where a plain `%` costs a 64-bit division. The
+// transforms keep data as plain residues and only twiddles in Montgomery
+// form: mul(x, wR) = x w, so no conversion pass is needed. Values stay
+// fully reduced, in [0, P).
+//
+// P must be an odd prime below 2^30 (so sums of two residues fit 32 bits
+// with room to spare) with P - 1 divisible by a large power of two: the
+// longest transform has 2^(trailing zeros of P - 1) points. The usual
+// choices are 998244353 = 119 * 2^23 + 1, 167772161 = 5 * 2^25 + 1 and
+// 469762049 = 7 * 2^26 + 1, all with primitive root 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace algoritmi::detail::fft {
+
+template <std::uint32_t P>
+struct montgomery {
+  static_assert(P % 2 == 1 && P > 2 && P < (std::uint32_t{1} << 30),
+                "montgomery: P must be an odd prime below 2^30");
+
+  static constexpr std::uint32_t mod = P;
+
+  // -P^-1 mod 2^32 by Newton's iteration, each step doubling the correct
+  // low bits.
+  static constexpr std::uint32_t neg_inverse() noexcept {
+    std::uint32_t inv = P;
+    for (int i = 0; i < 4; ++i) inv *= 2 - P * inv;
+    return 0 - inv;
+  }
+
+  static constexpr std::uint32_t neg_inv = neg_inverse();
+  // R^2 mod P, for to_mont.
+  static constexpr std::uint32_t r2 =
+      static_cast<std::uint32_t>((std::uint64_t{1} << 32) % P * ((std::uint64_t{1} << 32) % P) % P);
+
+  // t R^-1 mod P for t < P 2^32.
+  static constexpr std::uint32_t reduce(std::uint64_t t) noexcept {
+    std::uint32_t const m = static_cast<std::uint32_t>(t) * neg_inv;
+    std::uint32_t const r = static_cast<std::uint32_t>((t + std::uint64_t{m} * P) >> 32);
+    return r >= P ? r - P : r;
+  }
+
+  static constexpr std::uint32_t mul(std::uint32_t a, std::uint32_t b) noexcept {
+    return reduce(std::uint64_t{a} * b);
+  }
+  static constexpr std::uint32_t add(std::uint32_t a, std::uint32_t b) noexcept {
+    std::uint32_t const s = a + b;
+    return s >= P ? s - P : s;
+  }
+  static constexpr std::uint32_t sub(std::uint32_t a, std::uint32_t b) noexcept {
+    return a >= b ? a - b : a + P - b;
+  }
+
+  // x -> xR mod P and back; to_mont accepts any 32-bit x.
+  static constexpr std::uint32_t to_mont(std::uint32_t x) noexcept { return mul(x, r2); }
+  static constexpr std::uint32_t from_mont(std::uint32_t x) noexcept { return reduce(x); }
+
+  // (xR)^e R, i.e. Montgomery form in and out.
+  static constexpr std::uint32_t pow(std::uint32_t x, std::uint64_t e) noexcept {
+    std::uint32_t r = to_mont(1);
+    for (; e; e >>= 1, x = mul(x, x))
+      if (e & 1) r = mul(r, x);
+    return r;
+  }
+
+  // Largest power of two dividing P - 1: the longest transform.
+  static constexpr unsigned two_adicity() noexcept {
+    unsigned k = 0;
+    while (((P - 1) >> k & 1) == 0) ++k;
+    return k;
+  }
+
+  // Smallest generator of the multiplicative group: g^((P-1)/f) != 1 for
+  // every prime factor f of P - 1.
+  static constexpr std::uint32_t primitive_root() noexcept {
+    std::uint32_t factors[32] = {};
+    std::size_t count = 0;
+    std::uint32_t m = P - 1;
+    for (std::uint32_t f = 2; f <= m / f; ++f) {
+      if (m % f) continue;
+      factors[count++] = f;
+      while (m % f == 0) m /= f;
+    }
+    if (m > 1) factors[count++] = m;
+    for (std::uint32_t g = 2;; ++g) {
+      bool ok = true;
+      for (std::size_t i = 0; i < count && ok; ++i)
+        ok = pow(to_mont(g), (P - 1) / factors[i]) != to_mont(1);
+      if (ok) return g;
+    }
+  }
+};
+
+}  // namespace algoritmi::detail::fft
@@ -0,0 +1,269 @@
+// Number-theoretic transform: the DFT over the integers modulo a prime P
+// with 2^k | P - 1, where a primitive n-th root of unity exists for every
+// n = 2^j <= 2^k. Products of transforms are exact, which is what integer
+// convolution and big-integer multiplication need (convolution.hpp).
+//
+// The plan has the structure of the complex one (plan.hpp): radix-4 DIF
+// forward, DIT inverse, the stage order of schedule.hpp and bit-reversed
+// spectra in between. The 4-point DFTs multiply by J = g^((P-1)/4), a
+// square root of -1 standing in for -i, and all products are Montgomery
+// multiplications against twiddles kept in Montgomery form (montgomery.hpp).
+// Inverse twiddles are a second table: conjugation has no modular analogue.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../config.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/parallel.hpp"
+#include "../execution.hpp"
+#include "../span.hpp"
+#include "montgomery.hpp"
+#include "schedule.hpp"
+
+namespace algoritmi {
+namespace detail::fft {
+
+struct access;
+
+// 256 KiB of 32-bit residues, as for the complex transform.
+inline constexpr std::size_t modular_local_points = std::size_t{1} << 16;
+static_assert(modular_local_points >= 4 * task_butterflies);
+
+template <std::uint32_t P>
+struct modular_engine {
+  using mont = montgomery<P>;
+
+  std::uint32_t* x;
+  stage_plan plan;
+  std::uint32_t const* twiddles;  // forward or inverse table
+  std::size_t const* offsets;
+  std::uint32_t j4;  // J in Montgomery form
+  bool forward;
+
+  void blocks(unsigned s, std::size_t first, std::size_t count) const noexcept {
+    std::size_t const len = plan.length(s);
+    std::uint32_t* const p = x + first;
+    if (len == 2) {
+      for (std::size_t i = 0; i < count; i += 2) {
+        std::uint32_t const a = p[i], b = p[i + 1];
+        p[i] = mont::add(a, b);
+        p[i + 1] = mont::sub(a, b);
+      }
+      return;
+    }
+    std::size_t const q = len / 4;
+    if (q == 1) {
+      for (std::size_t b = 0; b < count; b += 4) {
+        std::uint32_t* const y = p + b;
+        forward ? dif(y, y + 1, y + 2, y + 3) : dit(y, y + 1, y + 2, y + 3);
+      }
+      return;
+    }
+    std::uint32_t const* const w = twiddles + offsets[s];
+    for (std::size_t b = 0; b < count; b += len) butterflies(p + b, q, q, w, w + q, w + 2 * q);
+  }
+
+  void part(unsigned s, std::size_t base, std::size_t j0, std::size_t j1) const noexcept {
+    constexpr std::size_t run = twiddle_run;
+    std::size_t const q = plan.length(s) / 4;
+    std::uint32_t const* const coarse = twiddles + offsets[s];
+    std::uint32_t const* const fine = coarse + 3 * (q / run);
+    alignas(cache_line_size) std::uint32_t w[3][run];
+    for (std::size_t j = j0; j < j1; j += run) {
+      for (std::size_t m = 0; m < 3; ++m) {
+        std::uint32_t const c = coarse[m * (q / run) + j / run];
+        for (std::size_t t = 0; t < run; ++t) w[m][t] = mont::mul(c, fine[m * run + t]);
+      }
+      butterflies(x + base + j, q, run, w[0], w[1], w[2]);
+    }
+  }
+
+  void butterflies(std::uint32_t* x0, std::size_t q, std::size_t count, std::uint32_t const* w1,
+                   std::uint32_t const* w2, std::uint32_t const* w3) const noexcept {
+    std::uint32_t* const x1 = x0 + q;
+    std::uint32_t* const x2 = x0 + 2 * q;
+    std::uint32_t* const x3 = x0 + 3 * q;
+    if (forward) {
+      for (std::size_t j = 0; j < count; ++j) {
+        dif(x0 + j, x1 + j, x2 + j, x3 + j);
+        x1[j] = mont::mul(x1[j], w2[j]);
+        x2[j] = mont::mul(x2[j], w1[j]);
+        x3[j] = mont::mul(x3[j], w3[j]);
+      }
+    } else {
+      for (std::size_t j = 0; j < count; ++j) {
+        x1[j] = mont::mul(x1[j], w2[j]);
+        x2[j] = mont::mul(x2[j], w1[j]);
+        x3[j] = mont::mul(x3[j], w3[j]);
+        dit(x0 + j, x1 + j, x2 + j, x3 + j);
+      }
+    }
+  }
+
+  // The 4-point DFTs of kernels.hpp, J in place of -i.
+  void dif(std::uint32_t* x0, std::uint32_t* x1, std::uint32_t* x2,
+           std::uint32_t* x3) const noexcept {
+    std::uint32_t const t0 = mont::add(*x0, *x2), t1 = mont::sub(*x0, *x2);
+    std::uint32_t const t2 = mont::add(*x1, *x3);
+    std::uint32_t const t3 = mont::mul(mont::sub(*x1, *x3), j4);
+    *x0 = mont::add(t0, t2);
+    *x1 = mont::sub(t0, t2);
+    *x2 = mont::add(t1, t3);
+    *x3 = mont::sub(t1, t3);
+  }
+
+  void dit(std::uint32_t* x0, std::uint32_t* x1, std::uint32_t* x2,
+           std::uint32_t* x3) const noexcept {
+    std::uint32_t const t0 = mont::add(*x0, *x1), t1 = mont::sub(*x0, *x1);
+    std::uint32_t const t2 = mont::add(*x2, *x3);
+    std::uint32_t const t3 = mont::mul(mont::sub(*x2, *x3), j4);
+    *x0 = mont::add(t0, t2);
+    *x1 = mont::sub(t1, t3);
+    *x2 = mont::sub(t0, t2);
+    *x3 = mont::add(t1, t3);
+  }
+};
+
+}  // namespace detail::fft
+
+// NTT modulo P, an odd prime below 2^30 (see montgomery.hpp), e.g.
+// ntt_plan<998244353>.
+template <std::uint32_t P>
+class ntt_plan {
+  using mont = detail::fft::montgomery<P>;
+  static_assert(mont::two_adicity() >= 2, "ntt_plan: 4 must divide P - 1");
+
+ public:
+  using value_type = std::uint32_t;
+  static constexpr std::uint32_t modulus = P;
+
+  // Longest transform modulo P.
+  static constexpr std::size_t max_size() noexcept {
+    return std::size_t{1} << mont::two_adicity();
+  }
+
+  // Throws std::invalid_argument unless n is a power of two at most
+  // max_size().
+  explicit ntt_plan(std::size_t n, std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : forward_(mr), inverse_(mr) {
+    using detail::fft::twiddle_run;
+    if (!detail::fft::is_power_of_two(n) || n > max_size())
+      throw std::invalid_argument("ntt_plan: size is not a power of two up to max_size()");
+    plan_.log_n = detail::fft::log2_exact(n);
+    std::size_t total = 0;
+    for (unsigned s = 0; s < plan_.stages(); ++s) {
+      offsets_[s] = total;
+      total += detail::fft::twiddle_count(plan_, s, local);
+    }
+    forward_.resize(total);
+    inverse_.resize(total);
+    std::uint32_t const g = mont::to_mont(root);
+    j4_ = mont::pow(g, (P - 1) / 4);
+    n_inv_ = mont::pow(mont::to_mont(static_cast<std::uint32_t>(n % P)), P - 2);
+    for (unsigned s = 0; s < plan_.stages(); ++s) {
+      std::size_t const len = plan_.length(s), q = len / 4;
+      if (len < 8) continue;
+      std::uint32_t const w = mont::pow(g, (P - 1) / len);
+      std::uint32_t const w_inv = mont::pow(g, (P - 1) - (P - 1) / len);
+      std::uint32_t* f = forward_.data() + offsets_[s];
+      std::uint32_t* b = inverse_.data() + offsets_[s];
+      // Appends w^(m step i) and its inverse for i < count.
+      auto const put = [&](std::size_t m, std::size_t step, std::size_t count) {
+        std::uint32_t const sf = mont::pow(w, m * step), sb = mont::pow(w_inv, m * step);
+        std::uint32_t xf = mont::to_mont(1), xb = xf;
+        for (std::size_t i = 0; i < count; ++i) {
+          *f++ = xf;
+          *b++ = xb;
+          xf = mont::mul(xf, sf);
+          xb = mont::mul(xb, sb);
+        }
+      };
+      if (len > local) {
+        for (std::size_t m = 1; m <= 3; ++m) put(m, twiddle_run, q / twiddle_run);
+        for (std::size_t m = 1; m <= 3; ++m) put(m, 1, twiddle_run);
+      } else {
+        for (std::size_t m = 1; m <= 3; ++m) put(m, 1, q);
+      }
+    }
+  }
+
+  std::size_t size() const noexcept { return plan_.size(); }
+
+  // x = NTT(x), x[k] = sum_j x[j] w^jk mod P for w = g^((P-1)/n), g the
+  // smallest primitive root. Every x[i] must be below P. Throws
+  // std::invalid_argument unless x.size() == size().
+  void forward(span<value_type> x) const { forward_on(x, 1); }
+
+  void forward(parallel_policy policy, span<value_type> x) const {
+    forward_on(x, detail::resolve_threads(policy.threads));
+  }
+
+  // x = inverse NTT(x), including the factor 1 / n.
+  void inverse(span<value_type> x) const { inverse_on(x, 1); }
+
+  void inverse(parallel_policy policy, span<value_type> x) const {
+    inverse_on(x, detail::resolve_threads(policy.threads));
+  }
+
+ private:
+  friend struct detail::fft::access;
+
+  static constexpr std::size_t local = detail::fft::modular_local_points;
+  static constexpr std::uint32_t root = mont::primitive_root();
+
+  // The bare transforms: forward ends and inverse starts in bit-reversed
+  // order, and inverse does not scale.
+  void forward_bit_reversed(std::uint32_t* x, unsigned threads) const {
+    detail::fft::modular_engine<P> engine{x, plan_, forward_.data(), offsets_.data(), j4_, true};
+    detail::fft::run_dif(engine, plan_, local, threads);
+  }
+
+  void inverse_bit_reversed(std::uint32_t* x, unsigned threads) const {
+    detail::fft::modular_engine<P> engine{x, plan_, inverse_.data(), offsets_.data(), j4_, false};
+    detail::fft::run_dit(engine, plan_, local, threads);
+  }
+
+  // x[i] = x[i] * factor / R for i in [0, size()), factor in Montgomery
+  // form (so factor = yR multiplies by y).
+  void scale(std::uint32_t* x, std::uint32_t factor, unsigned threads) const {
+    std::size_t const run = std::size_t{1} << 16;
+    if (size() < detail::fft::parallel_threshold) threads = 1;
+    detail::parallel_for((size() + run - 1) / run, threads, [&](std::size_t t) {
+      std::size_t const end = std::min(size(), (t + 1) * run);
+      for (std::size_t i = t * run; i < end; ++i) x[i] = mont::mul(x[i], factor);
+    });
+  }
+
+  void check(span<value_type> x) const {
+    if (x.size() != size()) throw std::invalid_argument("ntt_plan: array size differs from plan");
+  }
+
+  void forward_on(span<value_type> x, unsigned threads) const {
+    check(x);
+    forward_bit_reversed(x.data(), threads);
+    detail::fft::bit_reverse_permute(x.data(), plan_, threads);
+  }
+
+  void inverse_on(span<value_type> x, unsigned threads) const {
+    check(x);
+    detail::fft::bit_reverse_permute(x.data(), plan_, threads);
+    inverse_bit_reversed(x.data(), threads);
+    scale(x.data(), n_inv_, threads);
+  }
+
+  detail::fft::stage_plan plan_;
+  std::array<std::size_t, 32> offsets_{};
+  std::uint32_t j4_ = 0;
+  std::uint32_t n_inv_ = 0;  // Montgomery form
+  std::vector<std::uint32_t, detail::aligned_allocator<std::uint32_t>> forward_;
+  std::vector<std::uint32_t, detail::aligned_allocator<std::uint32_t>> inverse_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,208 @@
+// Complex FFT of a fixed power-of-two size with precomputed twiddles.
+//
+// The transform is iterative and in place: radix-4 stages (a radix-2 one
+// closes odd log2 n) in the cache-aware order of schedule.hpp, over the
+// butterflies of kernels.hpp. The forward transform runs decimation in
+// frequency and ends in bit-reversed order, the inverse decimation in time
+// and starts from it; forward() and inverse() add a bit-reversal
+// permutation to work in natural order, while the convolutions
+// (convolution.hpp) multiply spectra pointwise in bit-reversed order and
+// skip both permutations.
+//
+// Twiddles are computed once per plan, each from its own angle. Stages
+// that run block by block keep w^j, w^2j, w^3j in full, about
+// complex_local_points numbers over all of them; breadth-first stages keep
+// the two-level tables of schedule.hpp, whose products add one rounding.
+// A plan of n points thus takes O(n / twiddle_run) memory beyond a fixed
+// part, and as many sines and cosines. Forward uses exp(-2 pi i jk / n),
+// and the inverse scales by 1 / n, so inverse(forward(x)) == x up to
+// rounding.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/parallel.hpp"
+#include "../execution.hpp"
+#include "../span.hpp"
+#include "kernels.hpp"
+#include "schedule.hpp"
+
+namespace algoritmi {
+namespace detail::fft {
+
+struct access;
+
+// Blocks of at most this many points run all their stages at once:
+// 256 KiB of complex doubles, half a typical L2.
+inline constexpr std::size_t complex_local_points = std::size_t{1} << 14;
+static_assert(complex_local_points >= 4 * task_butterflies);
+
+// The stages of one plan over one array, for schedule.hpp.
+struct complex_engine {
+  butterfly_fn fn;
+  double* x;
+  stage_plan plan;
+  double const* twiddles;
+  std::size_t const* offsets;
+  bool forward;
+
+  void blocks(unsigned s, std::size_t first, std::size_t count) const noexcept {
+    std::size_t const len = plan.length(s), q = len / 4;
+    double* const p = x + 2 * first;
+    if (len == 2) {
+      radix2_blocks(p, count);
+    } else if (len == 4) {
+      forward ? dif4_blocks(p, count) : dit4_blocks(p, count);
+    } else {
+      double const* const w = twiddles + offsets[s];
+      for (std::size_t b = 0; b < count; b += len) fn(p + 2 * b, q, q, w, w + 2 * q, w + 4 * q);
+    }
+  }
+
+  void part(unsigned s, std::size_t base, std::size_t j0, std::size_t j1) const noexcept {
+    constexpr std::size_t run = twiddle_run;
+    std::size_t const q = plan.length(s) / 4;
+    double const* const coarse = twiddles + offsets[s];
+    double const* const fine = coarse + 6 * (q / run);
+    alignas(cache_line_size) double w[3][2 * run];
+    for (std::size_t j = j0; j < j1; j += run) {
+      for (std::size_t m = 0; m < 3; ++m) {
+        double const* const c = coarse + 2 * (m * (q / run) + j / run);
+        double const* const f = fine + 2 * m * run;
+        for (std::size_t t = 0; t < 2 * run; t += 2) {
+          w[m][t] = c[0] * f[t] - c[1] * f[t + 1];
+          w[m][t + 1] = c[0] * f[t + 1] + c[1] * f[t];
+        }
+      }
+      fn(x + 2 * (base + j), q, run, w[0], w[1], w[2]);
+    }
+  }
+};
+
+}  // namespace detail::fft
+
+class fft_plan {
+ public:
+  using value_type = std::complex<double>;
+
+  // Throws std::invalid_argument unless n is a power of two.
+  explicit fft_plan(std::size_t n, std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : twiddles_(mr) {
+    using detail::fft::twiddle_run;
+    if (!detail::fft::is_power_of_two(n))
+      throw std::invalid_argument("fft_plan: size is not a power of two");
+    plan_.log_n = detail::fft::log2_exact(n);
+    std::size_t total = 0;
+    for (unsigned s = 0; s < plan_.stages(); ++s) {
+      offsets_[s] = 2 * total;
+      total += detail::fft::twiddle_count(plan_, s, local);
+    }
+    twiddles_.resize(2 * total);
+    for (unsigned s = 0; s < plan_.stages(); ++s) {
+      std::size_t const len = plan_.length(s), q = len / 4;
+      double* tw = twiddles_.data() + offsets_[s];
+      // Appends w^e, e < len.
+      auto const put = [&](std::size_t e) {
+        double const angle = -2 * pi * static_cast<double>(e) / static_cast<double>(len);
+        *tw++ = std::cos(angle);
+        *tw++ = std::sin(angle);
+      };
+      if (len > local) {
+        for (std::size_t m = 1; m <= 3; ++m)
+          for (std::size_t j = 0; j < q; j += twiddle_run) put(m * j);
+        for (std::size_t m = 1; m <= 3; ++m)
+          for (std::size_t t = 0; t < twiddle_run; ++t) put(m * t);
+      } else if (len >= 8) {
+        for (std::size_t m = 1; m <= 3; ++m)
+          for (std::size_t j = 0; j < q; ++j) put(m * j);
+      }
+    }
+  }
+
+  std::size_t size() const noexcept { return plan_.size(); }
+
+  // x = DFT(x), x[k] = sum_j x[j] exp(-2 pi i jk / n). Throws
+  // std::invalid_argument unless x.size() == size().
+  void forward(span<value_type> x) const { forward_on(detail::fft::kernels(), x, 1); }
+
+  // The same with an explicit instruction set (clamped to the host's).
+  void forward(isa which, span<value_type> x) const {
+    forward_on(detail::fft::make_kernel_table(which), x, 1);
+  }
+
+  void forward(parallel_policy policy, span<value_type> x) const {
+    forward_on(detail::fft::kernels(), x, detail::resolve_threads(policy.threads));
+  }
+
+  // x = inverse DFT(x), scaled by 1 / n.
+  void inverse(span<value_type> x) const { inverse_on(detail::fft::kernels(), x, 1); }
+
+  void inverse(isa which, span<value_type> x) const {
+    inverse_on(detail::fft::make_kernel_table(which), x, 1);
+  }
+
+  void inverse(parallel_policy policy, span<value_type> x) const {
+    inverse_on(detail::fft::kernels(), x, detail::resolve_threads(policy.threads));
+  }
+
+ private:
+  friend struct detail::fft::access;
+
+  static constexpr std::size_t local = detail::fft::complex_local_points;
+  static constexpr double pi = 3.14159265358979323846;
+
+  // The bare transforms on interleaved complex doubles: forward ends and
+  // inverse starts in bit-reversed order, and inverse does not scale.
+  void forward_bit_reversed(detail::fft::kernel_table const& k, double* x,
+                            unsigned threads) const {
+    detail::fft::complex_engine engine{k.dif, x, plan_, twiddles_.data(), offsets_.data(), true};
+    detail::fft::run_dif(engine, plan_, local, threads);
+  }
+
+  void inverse_bit_reversed(detail::fft::kernel_table const& k, double* x,
+                            unsigned threads) const {
+    detail::fft::complex_engine engine{k.dit, x, plan_, twiddles_.data(), offsets_.data(), false};
+    detail::fft::run_dit(engine, plan_, local, threads);
+  }
+
+  void check(span<value_type> x) const {
+    if (x.size() != size()) throw std::invalid_argument("fft_plan: array size differs from plan");
+  }
+
+  void forward_on(detail::fft::kernel_table const& k, span<value_type> x, unsigned threads) const {
+    check(x);
+    forward_bit_reversed(k, reinterpret_cast<double*>(x.data()), threads);
+    detail::fft::bit_reverse_permute(x.data(), plan_, threads);
+  }
+
+  void inverse_on(detail::fft::kernel_table const& k, span<value_type> x, unsigned threads) const {
+    check(x);
+    detail::fft::bit_reverse_permute(x.data(), plan_, threads);
+    inverse_bit_reversed(k, reinterpret_cast<double*>(x.data()), threads);
+    double const scale = 1.0 / static_cast<double>(size());
+    double* const p = reinterpret_cast<double*>(x.data());
+    std::size_t const run = std::size_t{1} << 16;
+    std::size_t const doubles = 2 * size();
+    if (size() < detail::fft::parallel_threshold) threads = 1;
+    detail::parallel_for((doubles + run - 1) / run, threads, [&](std::size_t t) {
+      std::size_t const end = std::min(doubles, (t + 1) * run);
+      for (std::size_t i = t * run; i < end; ++i) p[i] *= scale;
+    });
+  }
+
+  detail::fft::stage_plan plan_;
+  std::array<std::size_t, 32> offsets_{};  // in doubles
+  std::vector<double, detail::aligned_allocator<double>> twiddles_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,140 @@
+// Stage order shared by the complex and modular transforms.
+//
+// An n-point transform, n = 2^k, runs ceil(k / 2) stages: radix-4 ones on
+// blocks of n, n / 4, n / 16, ... points, and a radix-2 stage on blocks
+// of 2 when k is odd. Run one after the other over the whole array, each
+// stage of a large transform would stream it through the cache again. So
+// the first stages, whose blocks exceed `local` points, run breadth-first,
+// split into runs of butterflies among the threads; from the first stage
+// whose blocks fit in the cache, each block runs all remaining stages
+// before the next one is touched. The inverse (DIT) runs the same plan
+// backwards. A transform's engine provides the stages:
+//
+//   engine.blocks(s, first, count)    stage s on the whole blocks covering
+//                                     points [first, first + count)
+//   engine.part(s, base, j0, j1)      butterflies [j0, j1) of stage s on
+//                                     the block at point `base`, called
+//                                     on breadth-first stages with j0 and
+//                                     j1 multiples of twiddle_run
+//
+// and bit_reverse_permute reorders points between bit-reversed and
+// natural order.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "../detail/bits.hpp"
+#include "../detail/parallel.hpp"
+
+namespace algoritmi::detail::fft {
+
+// Below this many points a parallel call runs on the calling thread.
+inline constexpr std::size_t parallel_threshold = std::size_t{1} << 16;
+
+// Butterflies per task in a breadth-first stage.
+inline constexpr std::size_t task_butterflies = std::size_t{1} << 11;
+
+// A breadth-first stage of q butterflies would need 3q twiddles, as much
+// memory as the data. Its plan keeps them in two levels instead, w^(a + b)
+// = w^a w^b for a a multiple of twiddle_run and b < twiddle_run: 3q /
+// twiddle_run coarse ones and 3 twiddle_run fine ones. part() expands a run
+// at a time into a buffer that stays in L1.
+inline constexpr std::size_t twiddle_run = 256;
+
+struct stage_plan {
+  unsigned log_n = 0;
+
+  std::size_t size() const noexcept { return std::size_t{1} << log_n; }
+  unsigned stages() const noexcept { return (log_n + 1) / 2; }
+  // Block length of stage s: 4^(stages - s), or 2 for a closing radix-2.
+  std::size_t length(unsigned s) const noexcept { return std::size_t{1} << (log_n - 2 * s); }
+  // First stage whose blocks are at most `local` points.
+  unsigned first_local(std::size_t local) const noexcept {
+    unsigned s = 0;
+    while (s < stages() && length(s) > local) ++s;
+    return s;
+  }
+};
+
+// Twiddles of stage s: three arrays of q for a stage run block by block,
+// [w^j | w^2j | w^3j], and for a breadth-first one the coarse arrays, then
+// the fine ones; none for the twiddle-free stages of 4 and 2 points.
+inline std::size_t twiddle_count(stage_plan const& plan, unsigned s, std::size_t local) noexcept {
+  std::size_t const len = plan.length(s), q = len / 4;
+  if (len > local) return 3 * (q / twiddle_run + twiddle_run);
+  return len >= 8 ? 3 * q : 0;
+}
+
+inline unsigned log2_exact(std::size_t n) noexcept {
+  return static_cast<unsigned>(countr_zero(n));
+}
+
+inline bool is_power_of_two(std::size_t n) noexcept { return n && (n & (n - 1)) == 0; }
+
+template <class Engine>
+void breadth_stage(Engine& engine, stage_plan const& plan, unsigned s, unsigned threads) {
+  std::size_t const len = plan.length(s), q = len / 4;
+  std::size_t const run = std::min(q, task_butterflies);
+  parallel_for(plan.size() / 4 / run, threads, [&](std::size_t t) {
+    std::size_t const i = t * run;
+    engine.part(s, i / q * len, i % q, i % q + run);
+  });
+}
+
+// Forward: stages 0, 1, ... leaving bit-reversed order.
+template <class Engine>
+void run_dif(Engine& engine, stage_plan const& plan, std::size_t local, unsigned threads) {
+  if (plan.size() < parallel_threshold) threads = 1;
+  unsigned const s0 = plan.first_local(local);
+  for (unsigned s = 0; s < s0; ++s) breadth_stage(engine, plan, s, threads);
+  if (s0 == plan.stages()) return;
+  std::size_t const len = plan.length(s0);
+  parallel_for(plan.size() / len, threads, [&](std::size_t b) {
+    for (unsigned s = s0; s < plan.stages(); ++s) engine.blocks(s, b * len, len);
+  });
+}
+
+// Inverse: the stages of run_dif in reverse, from bit-reversed order.
+template <class Engine>
+void run_dit(Engine& engine, stage_plan const& plan, std::size_t local, unsigned threads) {
+  if (plan.size() < parallel_threshold) threads = 1;
+  unsigned const s0 = plan.first_local(local);
+  if (s0 < plan.stages()) {
+    std::size_t const len = plan.length(s0);
+    parallel_for(plan.size() / len, threads, [&](std::size_t b) {
+      for (unsigned s = plan.stages(); s-- > s0;) engine.blocks(s, b * len, len);
+    });
+  }
+  for (unsigned s = s0; s-- > 0;) breadth_stage(engine, plan, s, threads);
+}
+
+inline std::size_t reverse_bits(std::size_t i, unsigned bits) noexcept {
+  std::size_t r = 0;
+  for (unsigned b = 0; b < bits; ++b, i >>= 1) r = (r << 1) | (i & 1);
+  return r;
+}
+
+// Swaps x[i] and x[rev(i)] for every i < rev(i). A task owns the smaller
+// index of each pair, so tasks never touch the same pair.
+template <class T>
+void bit_reverse_permute(T* x, stage_plan const& plan, unsigned threads) {
+  std::size_t const n = plan.size();
+  if (n <= 2) return;
+  if (n < parallel_threshold) threads = 1;
+  std::size_t const run = std::min(n, std::size_t{1} << 14);
+  parallel_for(n / run, threads, [&](std::size_t t) {
+    std::size_t const i0 = t * run;
+    std::size_t r = reverse_bits(i0, plan.log_n);
+    for (std::size_t i = i0; i < i0 + run; ++i) {
+      if (i < r) std::swap(x[i], x[r]);
+      // r = rev(i + 1): add one at the top bit, carrying downwards.
+      std::size_t bit = n >> 1;
+      for (; r & bit; bit >>= 1) r ^= bit;
+      r |= bit;
+    }
+  });
+}
+
+}  // namespace algoritmi::detail::fft
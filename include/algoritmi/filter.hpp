@@ -0,0 +1,28 @@
+// Probabilistic membership and cardinality: small summaries that answer
+// "possibly present" / "how many distinct" in front of an expensive lookup.
+//
+//   blocked_bloom_filter<Key>          dynamic set filter, one cache line per
+//                                      insert or lookup; mergeable
+//   xor_filter<Key[, Fingerprint]>     static filter, 9.84 bits per key at
+//                                      a 1/256 false-positive rate
+//   binary_fuse_filter<Key[, Fingerprint]>
+//                                      static filter, 9.0 bits per key at
+//                                      1/256, faster to build
+//   hyperloglog<Key>                   distinct count of a stream, sparse
+//                                      for small counts; mergeable
+//
+// None of them has false negatives. Keys are hashed with algoritmi::hash
+// and the result finalised to 64 uniform bits; a filter built in one
+// process and saved (persist.hpp) answers in another only if the hash
+// values are the same there, as for integers.
+//
+// Bloom probes and register merges run SIMD kernels picked at runtime like
+// the search kernels (see cpu.hpp); overloads taking an `isa` run a
+// specific one. The static filters hash and sort keys on the shared
+// scheduler when constructed with a parallel_policy.
+#pragma once
+
+#include "filter/bloom_filter.hpp"
+#include "filter/hyperloglog.hpp"
+#include "filter/kernels.hpp"
+#include "filter/xor_filter.hpp"
@@ -0,0 +1,138 @@
+// Cache-line-blocked Bloom filter (Putze, Sanders and Singler, 2007).
+//
+// A key picks one 64-byte block from the high bits of its hash and sets
+// one bit in each of the block's eight words, so an insert or a lookup
+// touches a single cache line (one miss instead of the k of a classic
+// Bloom filter) and the test is a few vector instructions (kernels.hpp).
+// The price is a slightly higher false-positive rate at the same size,
+// since blocks fill unevenly: about 1% at 10 bits per key, 0.4% at 12 and
+// 0.1% at 16, against 0.8%, 0.3% and 0.05% unblocked.
+//
+// Filters are dynamic (insert any time, no deletion) and of fixed size;
+// two of the same size merge by or-ing their words. contains() over a
+// batch prefetches the blocks of a group of keys before testing any, so
+// their misses overlap. A filter opened from an index file (persist.hpp)
+// probes the mapped words in place; inserting into it copies them first.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+
+#include "../cpu.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/borrowable.hpp"
+#include "../hash/hash.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+
+template <class Key, class Hash = hash<Key>>
+class blocked_bloom_filter {
+ public:
+  using key_type = Key;
+
+  static constexpr std::size_t block_bytes = cache_line_size;
+
+  // Room for `capacity` keys at `bits_per_key` bits each, rounded up to
+  // whole blocks. Throws std::invalid_argument unless bits_per_key > 0.
+  explicit blocked_bloom_filter(std::size_t capacity, double bits_per_key = 10,
+                                std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : words_(mr) {
+    if (!(bits_per_key > 0))
+      throw std::invalid_argument("blocked_bloom_filter: bits_per_key must be > 0");
+    double const bits = std::ceil(static_cast<double>(capacity) * bits_per_key);
+    std::size_t const blocks = static_cast<std::size_t>(bits / (block_bytes * 8)) + 1;
+    words_.own().assign(blocks * detail::filter::block_words, 0);
+  }
+
+  std::size_t blocks() const noexcept { return words_.size() / detail::filter::block_words; }
+  std::size_t memory_bytes() const noexcept { return words_.size() * 8; }
+
+  void insert(Key const& key) { insert_hash(hash_of(key)); }
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    auto& words = words_.own_copy();
+    auto const& k = detail::filter::kernels();
+    for (; first != last; ++first) k.bloom_insert(words.data(), blocks(), hash_of(*first));
+  }
+
+  // False for a key never inserted, except with the false-positive rate.
+  bool contains(Key const& key) const noexcept { return contains_hash(hash_of(key)); }
+
+  // out[i] = contains(keys[i]) for i in [0, count).
+  void contains(Key const* keys, std::size_t count, bool* out) const noexcept {
+    contains_batch(detail::filter::kernels(), keys, count, out);
+  }
+
+  // The same with an explicit instruction set (clamped to the host's).
+  bool contains(isa which, Key const& key) const noexcept {
+    return detail::filter::make_kernel_table(which).bloom_contains(words_.data(), blocks(),
+                                                                   hash_of(key));
+  }
+  void contains(isa which, Key const* keys, std::size_t count, bool* out) const noexcept {
+    contains_batch(detail::filter::make_kernel_table(which), keys, count, out);
+  }
+
+  // Keys already hashed to 64 uniform bits, for callers that hash once for
+  // several structures. insert_hash(h) pairs with contains_hash(h) only.
+  void insert_hash(std::uint64_t h) {
+    detail::filter::kernels().bloom_insert(words_.own_copy().data(), blocks(), h);
+  }
+  bool contains_hash(std::uint64_t h) const noexcept {
+    return detail::filter::kernels().bloom_contains(words_.data(), blocks(), h);
+  }
+
+  // Adds every key of `other`. Throws std::invalid_argument unless both
+  // filters have the same number of blocks.
+  void merge(blocked_bloom_filter const& other) {
+    if (other.words_.size() != words_.size())
+      throw std::invalid_argument("blocked_bloom_filter: merging filters of different sizes");
+    if (&other == this) return;
+    detail::filter::kernels().or_words(words_.own_copy().data(), other.words_.data(),
+                                       words_.size());
+  }
+
+  void clear() {
+    auto& words = words_.own_copy();
+    std::fill(words.begin(), words.end(), std::uint64_t{0});
+  }
+
+  // Fraction of bits set: with k = 8 bits per key, roughly fill^8 is the
+  // false-positive rate of the keys inserted so far.
+  double fill() const noexcept {
+    std::size_t ones = 0;
+    for (std::uint64_t w : words_) ones += static_cast<std::size_t>(detail::popcount(w));
+    return static_cast<double>(ones) / static_cast<double>(words_.size() * 64);
+  }
+
+ private:
+  blocked_bloom_filter() = default;
+
+  std::uint64_t hash_of(Key const& key) const noexcept {
+    return detail::filter::finalize(static_cast<std::uint64_t>(hash_(key)));
+  }
+
+  void contains_batch(detail::filter::kernel_table const& k, Key const* keys, std::size_t count,
+                      bool* out) const noexcept {
+    std::uint64_t hashes[detail::filter::batch_group];
+    for (std::size_t q0 = 0; q0 < count; q0 += detail::filter::batch_group) {
+      std::size_t const g = std::min(detail::filter::batch_group, count - q0);
+      for (std::size_t q = 0; q < g; ++q) hashes[q] = hash_of(keys[q0 + q]);
+      k.bloom_contains_batch(words_.data(), blocks(), hashes, g, out + q0);
+    }
+  }
+
+  friend struct detail::persist::access;
+
+  Hash hash_;
+  detail::borrowable_array<std::uint64_t, detail::aligned_allocator<std::uint64_t>> words_;
+};
+
+}  // namespace algoritmi
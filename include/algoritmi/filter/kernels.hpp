@@ -0,0 +1,234 @@
+// Kernels behind the filters and HyperLogLog, one version per instruction
+// set, selected like the search kernels (see cpu.hpp).
+//
+//   bloom_insert / bloom_contains
+//                      set or test a key's 8 bits in one 64-byte block
+//   bloom_contains_batch
+//                      the same for many hashes, prefetching blocks ahead
+//   or_words           dst |= src, for the union of two Bloom filters
+//   max_bytes          dst = max(dst, src), for merging HLL registers
+//
+// A Bloom key sets one bit in each of the block's eight 64-bit words, the
+// bit picked by the top 6 bits of (low half of the hash) * salt[i]. AVX2
+// computes all eight products with one multiply, turns them into two
+// vectors of one-hot words with variable shifts and tests the block with
+// two vptest, so a probe is one cache line and no data-dependent branch.
+// SSE4.2 has no variable 64-bit shift; its Bloom kernels are the scalar
+// ones and only the bulk kernels are vectorised.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::filter {
+
+// murmur3's 64-bit finaliser. User hashes of integers are the identity,
+// and the hash tables' mix() leaves runs of keys too evenly spread for
+// HyperLogLog's leading-zero counts; after this every output bit depends
+// on every input bit.
+inline std::uint64_t finalize(std::uint64_t h) noexcept {
+  h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+  h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+  return h ^ (h >> 33);
+}
+
+inline constexpr std::size_t block_words = cache_line_size / 8;
+static_assert(block_words == 8, "Bloom blocks are eight 64-bit words");
+
+// Odd multipliers for the bit of each word (as in Parquet's split-block
+// Bloom filter).
+alignas(32) inline constexpr std::uint32_t bloom_salt[8] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+// First word of the block of a hash: its high bits mapped onto [0, count).
+ALGORITMI_ALWAYS_INLINE std::size_t block_offset(std::size_t count, std::uint64_t h) noexcept {
+  return static_cast<std::size_t>(mulhi(h, count)) * block_words;
+}
+
+// Bit of word i of the block.
+ALGORITMI_ALWAYS_INLINE std::uint64_t bloom_bit(std::uint64_t h, unsigned i) noexcept {
+  return std::uint64_t{1} << ((static_cast<std::uint32_t>(h) * bloom_salt[i]) >> 26);
+}
+
+// Groups in which the batch kernels compute blocks and prefetch them
+// before testing any.
+inline constexpr std::size_t batch_group = 16;
+
+// ---------------------------------------------------------------- scalar --
+
+inline void bloom_insert_scalar(std::uint64_t* blocks, std::size_t count,
+                                std::uint64_t h) noexcept {
+  std::uint64_t* b = blocks + block_offset(count, h);
+  for (unsigned i = 0; i < block_words; ++i) b[i] |= bloom_bit(h, i);
+}
+
+inline bool bloom_contains_scalar(std::uint64_t const* blocks, std::size_t count,
+                                  std::uint64_t h) noexcept {
+  std::uint64_t const* b = blocks + block_offset(count, h);
+  // Every word is tested: no early exit to mispredict.
+  std::uint64_t missing = 0;
+  for (unsigned i = 0; i < block_words; ++i) missing |= ~b[i] & bloom_bit(h, i);
+  return missing == 0;
+}
+
+inline void or_words_scalar(std::uint64_t* dst, std::uint64_t const* src,
+                            std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) dst[i] |= src[i];
+}
+
+inline void max_bytes_scalar(std::uint8_t* dst, std::uint8_t const* src, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) dst[i] = dst[i] < src[i] ? src[i] : dst[i];
+}
+
+#define ALGORITMI_BLOOM_BATCH(TARGET, SUFFIX, PROBE)                                       \
+  TARGET inline void bloom_contains_batch_##SUFFIX(std::uint64_t const* blocks,            \
+                                                   std::size_t count,                      \
+                                                   std::uint64_t const* hashes,            \
+                                                   std::size_t n, bool* out) noexcept {    \
+    for (std::size_t q0 = 0; q0 < n; q0 += batch_group) {                                  \
+      std::size_t const g = n - q0 < batch_group ? n - q0 : batch_group;                   \
+      for (std::size_t q = 0; q < g; ++q)                                                  \
+        ALGORITMI_PREFETCH(blocks + block_offset(count, hashes[q0 + q]));                  \
+      for (std::size_t q = 0; q < g; ++q)                                                  \
+        out[q0 + q] = PROBE(blocks, count, hashes[q0 + q]);                                \
+    }                                                                                      \
+  }
+
+ALGORITMI_BLOOM_BATCH(, scalar, bloom_contains_scalar)
+
+#if ALGORITMI_HAS_SIMD
+
+// ---------------------------------------------------------------- SSE4.2 --
+
+ALGORITMI_TARGET_SSE42 inline void or_words_sse42(std::uint64_t* dst, std::uint64_t const* src,
+                                                  std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto* d = reinterpret_cast<__m128i*>(dst + i);
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+    _mm_storeu_si128(d, _mm_or_si128(_mm_loadu_si128(d), s));
+  }
+  for (; i < n; ++i) dst[i] |= src[i];
+}
+
+ALGORITMI_TARGET_SSE42 inline void max_bytes_sse42(std::uint8_t* dst, std::uint8_t const* src,
+                                                   std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto* d = reinterpret_cast<__m128i*>(dst + i);
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+    _mm_storeu_si128(d, _mm_max_epu8(_mm_loadu_si128(d), s));
+  }
+  max_bytes_scalar(dst + i, src + i, n - i);
+}
+
+// ------------------------------------------------------------------ AVX2 --
+
+// The key's bits as two vectors of four one-hot words.
+struct avx2_pattern {
+  __m256i lo, hi;
+};
+
+ALGORITMI_TARGET_AVX2 ALGORITMI_ALWAYS_INLINE avx2_pattern
+bloom_pattern(std::uint64_t h) noexcept {
+  __m256i const salt = _mm256_load_si256(reinterpret_cast<__m256i const*>(bloom_salt));
+  __m256i const x = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(h)));
+  __m256i const shift = _mm256_srli_epi32(_mm256_mullo_epi32(x, salt), 26);
+  __m256i const one = _mm256_set1_epi64x(1);
+  return {_mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shift))),
+          _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shift, 1)))};
+}
+
+ALGORITMI_TARGET_AVX2 inline void bloom_insert_avx2(std::uint64_t* blocks, std::size_t count,
+                                                    std::uint64_t h) noexcept {
+  auto* b = reinterpret_cast<__m256i*>(blocks + block_offset(count, h));
+  avx2_pattern const p = bloom_pattern(h);
+  _mm256_storeu_si256(b, _mm256_or_si256(_mm256_loadu_si256(b), p.lo));
+  _mm256_storeu_si256(b + 1, _mm256_or_si256(_mm256_loadu_si256(b + 1), p.hi));
+}
+
+ALGORITMI_TARGET_AVX2 ALGORITMI_ALWAYS_INLINE bool
+bloom_probe_avx2(std::uint64_t const* blocks, std::size_t count, std::uint64_t h) noexcept {
+  auto const* b = reinterpret_cast<__m256i const*>(blocks + block_offset(count, h));
+  avx2_pattern const p = bloom_pattern(h);
+  return _mm256_testc_si256(_mm256_loadu_si256(b), p.lo) &
+         _mm256_testc_si256(_mm256_loadu_si256(b + 1), p.hi);
+}
+
+ALGORITMI_TARGET_AVX2 inline bool bloom_contains_avx2(std::uint64_t const* blocks,
+                                                      std::size_t count,
+                                                      std::uint64_t h) noexcept {
+  return bloom_probe_avx2(blocks, count, h);
+}
+
+ALGORITMI_BLOOM_BATCH(ALGORITMI_TARGET_AVX2, avx2, bloom_probe_avx2)
+
+ALGORITMI_TARGET_AVX2 inline void or_words_avx2(std::uint64_t* dst, std::uint64_t const* src,
+                                                std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto* d = reinterpret_cast<__m256i*>(dst + i);
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+    _mm256_storeu_si256(d, _mm256_or_si256(_mm256_loadu_si256(d), s));
+  }
+  for (; i < n; ++i) dst[i] |= src[i];
+}
+
+ALGORITMI_TARGET_AVX2 inline void max_bytes_avx2(std::uint8_t* dst, std::uint8_t const* src,
+                                                 std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto* d = reinterpret_cast<__m256i*>(dst + i);
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+    _mm256_storeu_si256(d, _mm256_max_epu8(_mm256_loadu_si256(d), s));
+  }
+  max_bytes_scalar(dst + i, src + i, n - i);
+}
+
+#endif  // ALGORITMI_HAS_SIMD
+
+#undef ALGORITMI_BLOOM_BATCH
+
+struct kernel_table {
+  void (*bloom_insert)(std::uint64_t*, std::size_t, std::uint64_t) noexcept;
+  bool (*bloom_contains)(std::uint64_t const*, std::size_t, std::uint64_t) noexcept;
+  void (*bloom_contains_batch)(std::uint64_t const*, std::size_t, std::uint64_t const*,
+                               std::size_t, bool*) noexcept;
+  void (*or_words)(std::uint64_t*, std::uint64_t const*, std::size_t) noexcept;
+  void (*max_bytes)(std::uint8_t*, std::uint8_t const*, std::size_t) noexcept;
+};
+
+inline kernel_table make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  switch (usable_isa(which)) {
+    case isa::avx2:
+      return {&bloom_insert_avx2, &bloom_contains_avx2, &bloom_contains_batch_avx2,
+              &or_words_avx2, &max_bytes_avx2};
+    case isa::sse42:
+      return {&bloom_insert_scalar, &bloom_contains_scalar, &bloom_contains_batch_scalar,
+              &or_words_sse42, &max_bytes_sse42};
+    default:
+      break;
+  }
+#else
+  (void)which;
+#endif
+  return {&bloom_insert_scalar, &bloom_contains_scalar, &bloom_contains_batch_scalar,
+          &or_words_scalar, &max_bytes_scalar};
+}
+
+inline kernel_table const& kernels() noexcept {
+  static kernel_table const table = make_kernel_table(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::filter
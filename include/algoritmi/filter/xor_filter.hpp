@@ -0,0 +1,343 @@
+// Static xor filters (Graf and Lemire, 2020) and binary fuse filters
+// (Graf and Lemire, 2022).
+//
+// Both store one fingerprint per slot and answer contains(key) with
+// fingerprint(key) == F[h0] ^ F[h1] ^ F[h2] for three slots picked by the
+// key's hash: three independent loads, no branch, and a false-positive
+// rate of 2^-bits (1/256 with 8-bit fingerprints). Construction peels the
+// 3-hypergraph of keys over slots: a slot hit by a single key is removed
+// with that key until none is left, then fingerprints are assigned in
+// reverse so each key's equation holds. It succeeds with high probability
+// and otherwise retries with a new seed.
+//
+// An xor filter spreads the three slots over three thirds of 1.23n + 32
+// slots: 9.84 bits per key at 8 bits per fingerprint. A binary fuse filter
+// puts them in three consecutive segments of a window, which peels at
+// 1.125n slots for large n (9.0 bits per key) and, with the hashes sorted
+// first so that windows are filled in order, builds several times faster
+// as the working set moves along the array instead of spanning all of it.
+//
+// Keys are hashed, and the hashes sorted and deduplicated, on the shared
+// scheduler by the parallel_policy constructors; peeling is sequential.
+// Opened from an index file (persist.hpp), a filter probes the mapped
+// fingerprints in place.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../config.hpp"
+#include "../detail/bits.hpp"
+#include "../detail/borrowable.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "../hash/hash.hpp"
+#include "../sort/parallel_sort.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+namespace detail::filter {
+
+// Sizes of a filter's slot array.
+struct shape {
+  std::uint64_t segment_length = 0;        // slots per segment
+  std::uint64_t segment_count_length = 0;  // range of the first slot
+  std::uint64_t array_length = 0;
+
+  bool operator==(shape const& o) const noexcept {
+    return segment_length == o.segment_length &&
+           segment_count_length == o.segment_count_length && array_length == o.array_length;
+  }
+};
+
+// A bijection of h for each seed.
+inline std::uint64_t remix(std::uint64_t h, std::uint64_t seed) noexcept {
+  return finalize(h + seed);
+}
+
+inline std::uint64_t rotl(std::uint64_t x, unsigned r) noexcept {
+  return (x << r) | (x >> (64 - r));
+}
+
+struct xor_layout {
+  static constexpr char const* name = "xor_filter";
+  static constexpr std::uint32_t id = 1;
+
+  static shape make(std::size_t n) noexcept {
+    if (n == 0) return {};
+    auto const slots = static_cast<std::uint64_t>(std::ceil(1.23 * static_cast<double>(n)));
+    std::uint64_t const third = (32 + slots) / 3;
+    return {third, third, 3 * third};
+  }
+
+  static ALGORITMI_ALWAYS_INLINE std::array<std::uint64_t, 3> slots(shape const& s,
+                                                                    std::uint64_t h) noexcept {
+    std::uint64_t const third = s.segment_length;
+    return {mulhi(h, third), third + mulhi(rotl(h, 21), third),
+            2 * third + mulhi(rotl(h, 42), third)};
+  }
+};
+
+struct fuse_layout {
+  static constexpr char const* name = "binary_fuse_filter";
+  static constexpr std::uint32_t id = 2;
+
+  // Segment length and size factor as in the authors' implementation.
+  static shape make(std::size_t n) noexcept {
+    if (n == 0) return {};
+    double const dn = static_cast<double>(n);
+    std::uint64_t segment_length =
+        n == 1 ? 4
+               : std::uint64_t{1} << static_cast<unsigned>(std::floor(
+                     std::log(dn) / std::log(3.33) + 2.25));
+    if (segment_length > (std::uint64_t{1} << 18)) segment_length = std::uint64_t{1} << 18;
+    double const factor =
+        n <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * std::log(1e6) / std::log(dn));
+    auto const capacity = static_cast<std::uint64_t>(std::round(dn * factor));
+    std::uint64_t const segments = (capacity + segment_length - 1) / segment_length;
+    std::uint64_t const segment_count = segments <= 3 ? 1 : segments - 2;
+    return {segment_length, segment_count * segment_length, (segment_count + 2) * segment_length};
+  }
+
+  static ALGORITMI_ALWAYS_INLINE std::array<std::uint64_t, 3> slots(shape const& s,
+                                                                    std::uint64_t h) noexcept {
+    std::uint64_t const mask = s.segment_length - 1;
+    std::uint64_t const h0 = mulhi(h, s.segment_count_length);
+    std::uint64_t const h1 = (h0 + s.segment_length) ^ ((h >> 18) & mask);
+    std::uint64_t const h2 = (h0 + 2 * s.segment_length) ^ (h & mask);
+    return {h0, h1, h2};
+  }
+};
+
+template <class Fingerprint>
+ALGORITMI_ALWAYS_INLINE Fingerprint fingerprint(std::uint64_t h) noexcept {
+  return static_cast<Fingerprint>(h ^ (h >> 32));
+}
+
+// Solves F[h0] ^ F[h1] ^ F[h2] == fingerprint(h) for every h in the
+// distinct `hashes`; false if the hypergraph does not peel.
+template <class Layout, class Fingerprint>
+bool peel(shape const& s, std::uint64_t const* hashes, std::size_t n, Fingerprint* fingerprints,
+          std::pmr::memory_resource* mr) {
+  auto const slots = static_cast<std::size_t>(s.array_length);
+  // Per slot: 4 * (keys hitting it) + xor of which of their three slots it
+  // is, and the xor of their hashes, so a slot left with one key names it.
+  scratch_buffer<std::uint8_t> count(slots, mr);
+  scratch_buffer<std::uint64_t> xors(slots, mr);
+  std::fill(count.get(), count.get() + slots, std::uint8_t{0});
+  std::fill(xors.get(), xors.get() + slots, std::uint64_t{0});
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint64_t const h = hashes[i];
+    auto const p = Layout::slots(s, h);
+    for (unsigned j = 0; j < 3; ++j) {
+      std::uint8_t& c = count[p[j]];
+      c = static_cast<std::uint8_t>((c + 4) ^ j);
+      // 64 keys in one slot wrap the count; only duplicates get near that.
+      if (ALGORITMI_UNLIKELY(c < 4)) return false;
+      xors[p[j]] ^= h;
+    }
+  }
+
+  scratch_buffer<std::size_t> queue(slots, mr);
+  scratch_buffer<std::size_t> order(n, mr);
+  std::size_t queued = 0, peeled = 0;
+  for (std::size_t i = 0; i < slots; ++i)
+    if (count[i] >> 2 == 1) queue[queued++] = i;
+  while (queued > 0) {
+    std::size_t const i = queue[--queued];
+    if (count[i] >> 2 != 1) continue;
+    // Slot i keeps its key's hash and index from here on.
+    order[peeled++] = i;
+    std::uint64_t const h = xors[i];
+    unsigned const found = count[i] & 3u;
+    auto const p = Layout::slots(s, h);
+    for (unsigned j = 0; j < 3; ++j) {
+      if (j == found) continue;
+      std::uint8_t& c = count[p[j]];
+      c = static_cast<std::uint8_t>((c - 4) ^ j);
+      xors[p[j]] ^= h;
+      if (c >> 2 == 1) queue[queued++] = static_cast<std::size_t>(p[j]);
+    }
+  }
+  if (peeled != n) return false;
+
+  std::fill(fingerprints, fingerprints + slots, Fingerprint{0});
+  while (peeled > 0) {
+    std::size_t const i = order[--peeled];
+    std::uint64_t const h = xors[i];
+    auto const p = Layout::slots(s, h);
+    // F[i] is still zero, so xor-ing all three slots leaves the other two.
+    fingerprints[i] = static_cast<Fingerprint>(fingerprint<Fingerprint>(h) ^ fingerprints[p[0]] ^
+                                               fingerprints[p[1]] ^ fingerprints[p[2]]);
+  }
+  return true;
+}
+
+// Key counts from which the parallel constructors hash on several threads.
+inline constexpr std::size_t parallel_threshold = std::size_t{1} << 16;
+
+// Construction retries with fresh seeds this many times before giving up;
+// each attempt fails with probability well under 1% once n is past a few
+// dozen, and rarely needs a second try below that.
+inline constexpr unsigned max_attempts = 64;
+
+}  // namespace detail::filter
+
+// Layout is detail::filter::xor_layout or fuse_layout; use the aliases
+// xor_filter and binary_fuse_filter. Fingerprint is an unsigned 8, 16 or
+// 32-bit integer.
+template <class Layout, class Key, class Fingerprint, class Hash>
+class basic_xor_filter {
+  static_assert(std::is_same_v<Fingerprint, std::uint8_t> ||
+                    std::is_same_v<Fingerprint, std::uint16_t> ||
+                    std::is_same_v<Fingerprint, std::uint32_t>,
+                "fingerprints are 8, 16 or 32-bit unsigned integers");
+
+ public:
+  using key_type = Key;
+  using fingerprint_type = Fingerprint;
+
+  // Contains nothing.
+  basic_xor_filter() = default;
+
+  // A filter of the keys in [first, last); duplicates are allowed. Throws
+  // std::runtime_error in the practically impossible case that no seed
+  // gives a peelable hypergraph.
+  template <class InputIt>
+  basic_xor_filter(InputIt first, InputIt last,
+                   std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : fingerprints_(mr) {
+    std::pmr::vector<std::uint64_t> base(mr);
+    for (; first != last; ++first) base.push_back(hash_of(*first));
+    build(parallel_policy{1}, base, mr);
+  }
+
+  // Hashes the keys and sorts the hashes with up to policy.threads threads.
+  template <class RandomIt>
+  basic_xor_filter(parallel_policy policy, RandomIt first, RandomIt last,
+                   std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : fingerprints_(mr) {
+    auto const n = static_cast<std::size_t>(last - first);
+    std::pmr::vector<std::uint64_t> base(n, mr);
+    unsigned const threads = build_threads(policy, n);
+    std::size_t const tasks = threads > 1 ? 4 * std::size_t{threads} : 1;
+    detail::parallel_for(tasks, threads, [&](std::size_t c) {
+      for (std::size_t i = n * c / tasks; i < n * (c + 1) / tasks; ++i)
+        base[i] = hash_of(first[static_cast<std::ptrdiff_t>(i)]);
+    });
+    build(policy, base, mr);
+  }
+
+  // Distinct keys (by 64-bit hash) in the filter.
+  std::size_t size() const noexcept { return n_; }
+  bool empty() const noexcept { return n_ == 0; }
+  std::size_t memory_bytes() const noexcept { return fingerprints_.size() * sizeof(Fingerprint); }
+  double bits_per_key() const noexcept {
+    return n_ ? 8.0 * static_cast<double>(memory_bytes()) / static_cast<double>(n_) : 0.0;
+  }
+
+  // True for every key the filter was built from; for any other key, true
+  // with probability 2^-bits.
+  bool contains(Key const& key) const noexcept {
+    if (n_ == 0) return false;
+    return probe(detail::filter::remix(hash_of(key), seed_));
+  }
+
+  // out[i] = contains(keys[i]) for i in [0, count), loading the slots of
+  // a group of keys before testing any.
+  void contains(Key const* keys, std::size_t count, bool* out) const noexcept {
+    if (n_ == 0) {
+      std::fill(out, out + count, false);
+      return;
+    }
+    constexpr std::size_t group = 16;
+    std::uint64_t hashes[group];
+    for (std::size_t q0 = 0; q0 < count; q0 += group) {
+      std::size_t const g = std::min(group, count - q0);
+      for (std::size_t q = 0; q < g; ++q) {
+        hashes[q] = detail::filter::remix(hash_of(keys[q0 + q]), seed_);
+        auto const p = Layout::slots(shape_, hashes[q]);
+        ALGORITMI_PREFETCH(fingerprints_.data() + p[0]);
+        ALGORITMI_PREFETCH(fingerprints_.data() + p[1]);
+        ALGORITMI_PREFETCH(fingerprints_.data() + p[2]);
+      }
+      for (std::size_t q = 0; q < g; ++q) out[q0 + q] = probe(hashes[q]);
+    }
+  }
+
+ private:
+  std::uint64_t hash_of(Key const& key) const noexcept {
+    return detail::filter::finalize(static_cast<std::uint64_t>(hash_(key)));
+  }
+
+  bool probe(std::uint64_t h) const noexcept {
+    auto const p = Layout::slots(shape_, h);
+    Fingerprint const* f = fingerprints_.data();
+    return detail::filter::fingerprint<Fingerprint>(h) == (f[p[0]] ^ f[p[1]] ^ f[p[2]]);
+  }
+
+  static unsigned build_threads(parallel_policy policy, std::size_t n) {
+    unsigned const threads = detail::resolve_threads(policy.threads);
+    return n < detail::filter::parallel_threshold ? 1 : threads;
+  }
+
+  void build(parallel_policy policy, std::pmr::vector<std::uint64_t> const& base,
+             std::pmr::memory_resource* mr) {
+    std::size_t const n = base.size();
+    unsigned const threads = build_threads(policy, n);
+    std::size_t const tasks = threads > 1 ? 4 * std::size_t{threads} : 1;
+    std::pmr::vector<std::uint64_t> hashes(n, mr);
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (unsigned attempt = 0; attempt < detail::filter::max_attempts; ++attempt) {
+      seed = detail::filter::remix(seed, attempt);
+      detail::parallel_for(tasks, threads, [&](std::size_t c) {
+        for (std::size_t i = n * c / tasks; i < n * (c + 1) / tasks; ++i)
+          hashes[i] = detail::filter::remix(base[i], seed);
+      });
+      // Sorted hashes visit the slots roughly in order (the first slot is
+      // monotone in the hash) and make duplicates adjacent.
+      radix_sort(parallel_policy{threads}, hashes.begin(), hashes.end());
+      std::size_t const distinct =
+          static_cast<std::size_t>(std::unique(hashes.begin(), hashes.end()) - hashes.begin());
+      detail::filter::shape const s = Layout::make(distinct);
+      auto& fingerprints = fingerprints_.own();
+      fingerprints.resize(static_cast<std::size_t>(s.array_length));
+      if (detail::filter::peel<Layout>(s, hashes.data(), distinct, fingerprints.data(), mr)) {
+        n_ = distinct;
+        seed_ = seed;
+        shape_ = s;
+        return;
+      }
+    }
+    throw std::runtime_error(std::string(Layout::name) + ": construction failed");
+  }
+
+  friend struct detail::persist::access;
+
+  Hash hash_;
+  std::size_t n_ = 0;
+  std::uint64_t seed_ = 0;
+  detail::filter::shape shape_;
+  detail::borrowable_array<Fingerprint> fingerprints_;
+};
+
+template <class Key, class Fingerprint = std::uint8_t, class Hash = hash<Key>>
+using xor_filter = basic_xor_filter<detail::filter::xor_layout, Key, Fingerprint, Hash>;
+
+template <class Key, class Fingerprint = std::uint8_t, class Hash = hash<Key>>
+using binary_fuse_filter = basic_xor_filter<detail::filter::fuse_layout, Key, Fingerprint, Hash>;
+
+}  // namespace algoritmi
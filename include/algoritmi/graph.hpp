@@ -0,0 +1,24 @@
+// Graph algorithms on compressed-sparse-row adjacency.
+//
+//   csr_graph<W>            flat CSR graph built from an edge list
+//   bfs([par,] g, s)        direction-optimizing breadth-first search
+//   dijkstra(g, s)          radix-heap Dijkstra
+//   delta_stepping([par,] g, s[, delta])
+//   shortest_path_tree(g, dist, s)
+//   union_find, concurrent_union_find
+//                           disjoint sets; the second lock-free
+//   connected_components([par,] n, edges)
+//                           smallest vertex id of each vertex's component
+//   kruskal, filter_kruskal([par,] ...), boruvka([par,] ...)
+//                           minimum spanning forest of an edge list
+//
+// Every function and constructor takes an optional trailing
+// std::pmr::memory_resource* for its results and working storage.
+#pragma once
+
+#include "graph/bfs.hpp"
+#include "graph/components.hpp"
+#include "graph/csr_graph.hpp"
+#include "graph/shortest_paths.hpp"
+#include "graph/spanning_tree.hpp"
+#include "graph/union_find.hpp"
@@ -0,0 +1,230 @@
+// Direction-optimizing breadth-first search (Beamer, Asanovic, Patterson 2012).
+//
+// Small frontiers are expanded top-down (scan the frontier's out-edges).
+// Once the frontier's edges outnumber a fraction of the edges still
+// unexplored, the search switches to bottom-up: every unvisited vertex scans
+// its in-edges and stops at the first parent found in the frontier, which on
+// low-diameter graphs skips most edges. It switches back once the frontier
+// shrinks again. Bottom-up needs in-edges, so it is only used for symmetric
+// graphs or when the transpose is passed in.
+//
+// The result and all per-search state (frontiers, bitmaps, parent array)
+// are allocated from the memory resource argument. Parallel searches only
+// use it from the calling thread; per-task frontiers grow on the global heap.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../detail/bits.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "csr_graph.hpp"
+
+namespace algoritmi {
+
+struct bfs_result {
+  static constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+  std::pmr::vector<vertex_id> parent;     // no_vertex if unreached; parent[source] == source
+  std::pmr::vector<std::uint32_t> depth;  // hop count from the source, or unreached
+};
+
+namespace detail::graph {
+
+// Switch thresholds from the paper: go bottom-up when the frontier's edges
+// exceed 1/alpha of the unexplored edges, return to top-down when the
+// frontier holds fewer than 1/beta of the vertices and is shrinking.
+inline constexpr std::size_t bfs_alpha = 15;
+inline constexpr std::size_t bfs_beta = 18;
+
+struct bitmap {
+  std::pmr::vector<std::uint64_t> words;
+
+  bitmap(std::size_t n, std::pmr::memory_resource* mr) : words((n + 63) / 64, 0, mr) {}
+  bool test(std::size_t i) const noexcept { return (words[i >> 6] >> (i & 63)) & 1; }
+  void set(std::size_t i) noexcept { words[i >> 6] |= std::uint64_t{1} << (i & 63); }
+  void clear() noexcept { std::fill(words.begin(), words.end(), 0); }
+};
+
+template <class W>
+class bfs_state {
+ public:
+  bfs_state(csr_graph<W> const& out, csr_graph<W> const* in, unsigned threads,
+            std::pmr::memory_resource* mr)
+      : out_(out),
+        in_(in),
+        n_(out.num_vertices()),
+        threads_(threads),
+        mr_(mr),
+        parent_(out.num_vertices(), mr),
+        depth_(out.num_vertices(), bfs_result::unreached, mr),
+        front_(out.num_vertices(), mr),
+        next_(out.num_vertices(), mr) {
+    for (std::size_t v = 0; v < n_; ++v) parent_[v].store(no_vertex, std::memory_order_relaxed);
+  }
+
+  bfs_result run(vertex_id source) {
+    parent_[source].store(source, std::memory_order_relaxed);
+    depth_[source] = 0;
+    std::pmr::vector<vertex_id> frontier(1, source, mr_);
+    std::size_t edges_to_check = out_.num_edges();
+    std::size_t scout_count = out_.degree(source);
+    std::uint32_t level = 0;
+
+    while (!frontier.empty()) {
+      if (in_ && scout_count > edges_to_check / bfs_alpha) {
+        queue_to_bitmap(frontier);
+        std::size_t awake = frontier.size(), old_awake;
+        do {
+          old_awake = awake;
+          awake = bottom_up_step(++level);
+          std::swap(front_, next_);
+        } while (awake >= old_awake || awake > n_ / bfs_beta);
+        bitmap_to_queue(frontier);
+        scout_count = 1;
+      } else {
+        edges_to_check -= std::min(edges_to_check, scout_count);
+        scout_count = top_down_step(frontier, ++level);
+      }
+    }
+
+    bfs_result r{std::pmr::vector<vertex_id>(n_, mr_), std::move(depth_)};
+    for (std::size_t v = 0; v < n_; ++v) r.parent[v] = parent_[v].load(std::memory_order_relaxed);
+    return r;
+  }
+
+ private:
+  std::size_t task_count(std::size_t work) const noexcept {
+    return std::max<std::size_t>(1, std::min(work, std::size_t{threads_} * tasks_per_thread));
+  }
+
+  // Expands `frontier` in place; returns the out-degree sum of the new one.
+  std::size_t top_down_step(std::pmr::vector<vertex_id>& frontier, std::uint32_t level) {
+    std::size_t const tasks = task_count(frontier.size() / 64 + 1);
+    std::pmr::vector<std::pmr::vector<vertex_id>> local(tasks, task_resource(threads_, mr_));
+    std::pmr::vector<std::size_t> scout(tasks, 0, mr_);
+    parallel_for(tasks, threads_, [&](std::size_t t) {
+      std::size_t const b = frontier.size() * t / tasks, e = frontier.size() * (t + 1) / tasks;
+      for (std::size_t i = b; i < e; ++i) {
+        vertex_id const u = frontier[i];
+        for (vertex_id v : out_.neighbors(u)) {
+          vertex_id expected = no_vertex;
+          if (parent_[v].load(std::memory_order_relaxed) == no_vertex &&
+              parent_[v].compare_exchange_strong(expected, u, std::memory_order_relaxed)) {
+            depth_[v] = level;
+            local[t].push_back(v);
+            scout[t] += out_.degree(v);
+          }
+        }
+      }
+    });
+    frontier.clear();
+    std::size_t total = 0;
+    for (std::size_t t = 0; t < tasks; ++t) {
+      frontier.insert(frontier.end(), local[t].begin(), local[t].end());
+      total += scout[t];
+    }
+    return total;
+  }
+
+  // Returns the number of vertices discovered.
+  std::size_t bottom_up_step(std::uint32_t level) {
+    std::size_t const words = next_.words.size();
+    std::size_t const tasks = task_count(words);
+    std::pmr::vector<std::size_t> awake(tasks, 0, mr_);
+    parallel_for(tasks, threads_, [&](std::size_t t) {
+      // Tasks own whole bitmap words, so no two tasks write the same word.
+      std::size_t const wb = words * t / tasks, we = words * (t + 1) / tasks;
+      for (std::size_t w = wb; w < we; ++w) {
+        std::uint64_t bits = 0;
+        std::size_t const vb = w * 64, ve = std::min(n_, vb + 64);
+        for (std::size_t v = vb; v < ve; ++v) {
+          if (parent_[v].load(std::memory_order_relaxed) != no_vertex) continue;
+          for (vertex_id u : in_->neighbors(static_cast<vertex_id>(v))) {
+            if (front_.test(u)) {
+              parent_[v].store(u, std::memory_order_relaxed);
+              depth_[v] = level;
+              bits |= std::uint64_t{1} << (v - vb);
+              ++awake[t];
+              break;
+            }
+          }
+        }
+        next_.words[w] = bits;
+      }
+    });
+    std::size_t total = 0;
+    for (std::size_t a : awake) total += a;
+    return total;
+  }
+
+  void queue_to_bitmap(std::pmr::vector<vertex_id> const& frontier) {
+    front_.clear();
+    for (vertex_id v : frontier) front_.set(v);
+  }
+
+  void bitmap_to_queue(std::pmr::vector<vertex_id>& frontier) const {
+    frontier.clear();
+    for (std::size_t w = 0; w < front_.words.size(); ++w)
+      for (std::uint64_t bits = front_.words[w]; bits; bits &= bits - 1)
+        frontier.push_back(static_cast<vertex_id>(w * 64 + static_cast<std::size_t>(countr_zero(bits))));
+  }
+
+  csr_graph<W> const& out_;
+  csr_graph<W> const* in_;
+  std::size_t n_;
+  unsigned threads_;
+  std::pmr::memory_resource* mr_;
+  scratch_buffer<std::atomic<vertex_id>> parent_;
+  std::pmr::vector<std::uint32_t> depth_;
+  bitmap front_;
+  bitmap next_;
+};
+
+template <class W>
+bfs_result bfs(csr_graph<W> const& out, csr_graph<W> const* in, vertex_id source,
+               unsigned threads, std::pmr::memory_resource* mr) {
+  if (source >= out.num_vertices()) throw std::out_of_range("bfs: source out of range");
+  if (!in && out.symmetric()) in = &out;
+  return bfs_state<W>(out, in, threads, mr).run(source);
+}
+
+}  // namespace detail::graph
+
+// BFS over out-edges. Direction-optimizing if the graph is symmetric,
+// top-down only otherwise.
+template <class W>
+bfs_result bfs(csr_graph<W> const& g, vertex_id source,
+               std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::bfs(g, static_cast<csr_graph<W> const*>(nullptr), source, 1, mr);
+}
+
+// Direction-optimizing BFS on a directed graph; `in` is g.transpose().
+template <class W>
+bfs_result bfs(csr_graph<W> const& g, csr_graph<W> const& in, vertex_id source,
+               std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::bfs(g, &in, source, 1, mr);
+}
+
+template <class W>
+bfs_result bfs(parallel_policy policy, csr_graph<W> const& g, vertex_id source,
+               std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::bfs(g, static_cast<csr_graph<W> const*>(nullptr), source,
+                            detail::resolve_threads(policy.threads), mr);
+}
+
+template <class W>
+bfs_result bfs(parallel_policy policy, csr_graph<W> const& g, csr_graph<W> const& in,
+               vertex_id source, std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::bfs(g, &in, source, detail::resolve_threads(policy.threads), mr);
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,84 @@
+// Connected components of an undirected edge list.
+//
+// The sequential version joins the endpoints of every edge in a union_find.
+// The parallel one splits the edges among tasks that join them in one
+// concurrent_union_find, which needs no coordination beyond its CAS
+// operations; hooking edges in any order gives the same partition. Either
+// way the result labels each vertex with the smallest vertex id in its
+// component, so labels do not depend on the order of the work.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "../span.hpp"
+#include "csr_graph.hpp"
+#include "union_find.hpp"
+
+namespace algoritmi {
+namespace detail::graph {
+
+inline void check_edges(std::size_t n, span<edge const> edges) {
+  if (n > no_vertex) throw std::length_error("connected_components: too many vertices");
+  for (edge const& e : edges)
+    if (e.from >= n || e.to >= n)
+      throw std::out_of_range("connected_components: vertex id out of range");
+}
+
+}  // namespace detail::graph
+
+// label[v] = smallest vertex id connected to v.
+inline std::pmr::vector<vertex_id> connected_components(
+    std::size_t num_vertices, span<edge const> edges,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::graph::check_edges(num_vertices, edges);
+  union_find uf(num_vertices, mr);
+  for (edge const& e : edges) uf.unite(e.from, e.to);
+  // Increasing v: the first vertex seen of a set is its smallest.
+  std::pmr::vector<vertex_id> label(num_vertices, no_vertex, mr);
+  for (std::size_t v = 0; v < num_vertices; ++v) {
+    vertex_id const r = uf.find(static_cast<vertex_id>(v));
+    if (label[r] == no_vertex) label[r] = static_cast<vertex_id>(v);
+    label[v] = label[r];
+  }
+  return label;
+}
+
+inline std::pmr::vector<vertex_id> connected_components(
+    parallel_policy policy, std::size_t num_vertices, span<edge const> edges,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::graph::check_edges(num_vertices, edges);
+  unsigned const threads = detail::resolve_threads(policy.threads);
+  concurrent_union_find uf(num_vertices, mr);
+  std::size_t const slots = std::size_t{threads} * detail::tasks_per_thread;
+  auto split = [&](std::size_t count, auto&& body) {
+    std::size_t const tasks = std::max<std::size_t>(1, std::min(slots, count / 4096 + 1));
+    detail::parallel_for(tasks, threads, [&](std::size_t t) {
+      std::size_t const e = count * (t + 1) / tasks;
+      for (std::size_t i = count * t / tasks; i < e; ++i) body(i);
+    });
+  };
+  split(edges.size(), [&](std::size_t i) { uf.unite(edges[i].from, edges[i].to); });
+
+  detail::scratch_buffer<std::atomic<vertex_id>> smallest(num_vertices, mr);
+  split(num_vertices,
+        [&](std::size_t v) { smallest[v].store(no_vertex, std::memory_order_relaxed); });
+  split(num_vertices, [&](std::size_t v) {
+    detail::atomic_fetch_min(smallest[uf.find(static_cast<vertex_id>(v))],
+                             static_cast<vertex_id>(v));
+  });
+  std::pmr::vector<vertex_id> label(num_vertices, mr);
+  split(num_vertices, [&](std::size_t v) {
+    label[v] = smallest[uf.find(static_cast<vertex_id>(v))].load(std::memory_order_relaxed);
+  });
+  return label;
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,167 @@
+// Compressed-sparse-row graph.
+//
+// Three flat arrays: offsets (n + 1), targets (m) and, for weighted graphs,
+// weights (m). The out-neighbours of v are targets[offsets[v], offsets[v+1]).
+// Construction is a counting sort of the edge list by source, so building a
+// graph allocates those arrays plus one n-sized cursor array and nothing per
+// vertex, all from the memory resource passed to the constructor. A graph
+// opened from an index file (persist.hpp) uses the mapped arrays in place.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../detail/borrowable.hpp"
+#include "../span.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+
+using vertex_id = std::uint32_t;
+using edge_index = std::uint64_t;
+
+inline constexpr vertex_id no_vertex = std::numeric_limits<vertex_id>::max();
+
+struct edge {
+  vertex_id from;
+  vertex_id to;
+};
+
+template <class W>
+struct weighted_edge {
+  vertex_id from;
+  vertex_id to;
+  W weight;
+};
+
+template <class W = std::uint32_t>
+class csr_graph {
+  static_assert(std::is_arithmetic_v<W>, "edge weights must be arithmetic");
+
+ public:
+  using weight_type = W;
+
+  explicit csr_graph(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : offsets_(mr), targets_(mr), weights_(mr) {
+    offsets_.own().assign(1, 0);
+  }
+
+  // Unweighted graph. With `symmetrize`, every edge is also added reversed,
+  // producing an undirected graph.
+  csr_graph(std::size_t num_vertices, span<edge const> edges, bool symmetrize = false,
+            std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : offsets_(mr), targets_(mr), weights_(mr) {
+    build(num_vertices, edges, symmetrize, [](edge const&) { return W{}; }, false);
+  }
+
+  csr_graph(std::size_t num_vertices, span<weighted_edge<W> const> edges,
+            bool symmetrize = false,
+            std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : offsets_(mr), targets_(mr), weights_(mr) {
+    build(num_vertices, edges, symmetrize, [](weighted_edge<W> const& e) { return e.weight; },
+          true);
+  }
+
+  std::size_t num_vertices() const noexcept { return offsets_.size() - 1; }
+  std::size_t num_edges() const noexcept { return targets_.size(); }
+  bool weighted() const noexcept { return weighted_; }
+  // True if built with `symmetrize`: in-neighbours equal out-neighbours.
+  bool symmetric() const noexcept { return symmetric_; }
+
+  std::size_t degree(vertex_id v) const noexcept {
+    return static_cast<std::size_t>(offsets_[v + 1] - offsets_[v]);
+  }
+  span<vertex_id const> neighbors(vertex_id v) const noexcept {
+    return {targets_.data() + offsets_[v], degree(v)};
+  }
+  // Weights parallel to neighbors(v); empty for unweighted graphs.
+  span<W const> weights(vertex_id v) const noexcept {
+    if (!weighted_) return {};
+    return {weights_.data() + offsets_[v], degree(v)};
+  }
+
+  span<edge_index const> offsets() const noexcept { return offsets_; }
+  span<vertex_id const> targets() const noexcept { return targets_; }
+  span<W const> weights() const noexcept { return weights_; }
+
+  std::pmr::memory_resource* resource() const noexcept {
+    return offsets_.get_allocator().resource();
+  }
+
+  // Graph with every edge reversed (in-neighbour lists), allocated from `mr`
+  // (this graph's resource by default).
+  csr_graph transpose(std::pmr::memory_resource* mr = nullptr) const {
+    if (!mr) mr = resource();
+    csr_graph t(mr);
+    std::size_t const n = num_vertices();
+    t.weighted_ = weighted_;
+    t.symmetric_ = symmetric_;
+    auto& offsets = t.offsets_.own();
+    auto& targets = t.targets_.own();
+    auto& weights = t.weights_.own();
+    offsets.assign(n + 1, 0);
+    for (vertex_id u : targets_) ++offsets[u + 1];
+    for (std::size_t v = 0; v < n; ++v) offsets[v + 1] += offsets[v];
+    targets.resize(targets_.size());
+    if (weighted_) weights.resize(weights_.size());
+    std::pmr::vector<edge_index> cursor(offsets.begin(), offsets.end() - 1, mr);
+    for (std::size_t v = 0; v < n; ++v) {
+      for (edge_index e = offsets_[v]; e < offsets_[v + 1]; ++e) {
+        edge_index const slot = cursor[targets_[e]]++;
+        targets[slot] = static_cast<vertex_id>(v);
+        if (weighted_) weights[slot] = weights_[e];
+      }
+    }
+    return t;
+  }
+
+ private:
+  template <class Edge, class WeightOf>
+  void build(std::size_t n, span<Edge const> edges, bool symmetrize, WeightOf weight_of,
+             bool weighted) {
+    if (n >= no_vertex) throw std::length_error("csr_graph: too many vertices");
+    weighted_ = weighted;
+    symmetric_ = symmetrize;
+    auto& offsets = offsets_.own();
+    auto& targets = targets_.own();
+    auto& weights = weights_.own();
+    offsets.assign(n + 1, 0);
+    for (Edge const& e : edges) {
+      if (e.from >= n || e.to >= n) throw std::out_of_range("csr_graph: vertex id out of range");
+      ++offsets[e.from + 1];
+      if (symmetrize) ++offsets[e.to + 1];
+    }
+    for (std::size_t v = 0; v < n; ++v) offsets[v + 1] += offsets[v];
+
+    targets.resize(offsets[n]);
+    if (weighted) weights.resize(offsets[n]);
+    std::pmr::vector<edge_index> cursor(offsets.begin(), offsets.end() - 1, resource());
+    auto place = [&](vertex_id from, vertex_id to, W w) {
+      edge_index const slot = cursor[from]++;
+      targets[slot] = to;
+      if (weighted) weights[slot] = w;
+    };
+    for (Edge const& e : edges) {
+      W const w = weight_of(e);
+      place(e.from, e.to, w);
+      if (symmetrize) place(e.to, e.from, w);
+    }
+  }
+
+  friend struct detail::persist::access;
+
+  detail::borrowable_array<edge_index> offsets_;
+  detail::borrowable_array<vertex_id> targets_;
+  detail::borrowable_array<W> weights_;
+  bool weighted_ = false;
+  bool symmetric_ = false;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,232 @@
+// Single-source shortest paths on non-negatively weighted CSR graphs.
+//
+//   dijkstra(g, s)               label-setting search on a radix heap
+//   delta_stepping([par,] g, s)  bucketed label-correcting search that
+//                                relaxes a whole distance bucket at once,
+//                                in parallel with the policy overload
+//   shortest_path_tree(g, dist)  parent of every reached vertex
+//
+// Distances are std::uint64_t for integer weights and the weight type for
+// floating-point weights; unreachable vertices get infinite_distance<W>().
+// Results and working storage come from the trailing memory resource
+// argument (the parallel overload only uses it from the calling thread).
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "../heap/radix_heap.hpp"
+#include "../instrument/counters.hpp"
+#include "../sort/radix_sort.hpp"
+#include "csr_graph.hpp"
+
+namespace algoritmi {
+
+template <class W>
+using distance_t = std::conditional_t<std::is_integral_v<W>, std::uint64_t, W>;
+
+template <class W>
+constexpr distance_t<W> infinite_distance() noexcept {
+  using D = distance_t<W>;
+  if constexpr (std::numeric_limits<D>::has_infinity)
+    return std::numeric_limits<D>::infinity();
+  else
+    return std::numeric_limits<D>::max();
+}
+
+namespace detail::graph {
+
+template <class W>
+void require_weighted_nonnegative(csr_graph<W> const& g, char const* who) {
+  if (!g.weighted()) throw std::invalid_argument(std::string(who) + ": graph has no weights");
+  if constexpr (std::is_signed_v<W>) {
+    for (W w : g.weights())
+      if (w < W{0}) throw std::invalid_argument(std::string(who) + ": negative edge weight");
+  }
+}
+
+// Meyer & Sanders suggest a bucket width around max_weight / average_degree:
+// wide enough that a bucket has parallel work, narrow enough that few
+// vertices are relaxed more than once.
+template <class W>
+distance_t<W> default_delta(csr_graph<W> const& g) {
+  using D = distance_t<W>;
+  W max_w{0};
+  for (W w : g.weights()) max_w = std::max(max_w, w);
+  double const avg_degree =
+      g.num_vertices() ? static_cast<double>(g.num_edges()) / static_cast<double>(g.num_vertices()) : 1.0;
+  double const d = static_cast<double>(max_w) / std::max(1.0, avg_degree);
+  if constexpr (std::is_integral_v<W>)
+    return std::max<D>(1, static_cast<D>(d));
+  else
+    return d > 0 ? static_cast<D>(d) : D{1};
+}
+
+template <class W>
+std::pmr::vector<distance_t<W>> delta_stepping(csr_graph<W> const& g, vertex_id source,
+                                               distance_t<W> delta, unsigned threads,
+                                               std::pmr::memory_resource* mr) {
+  using D = distance_t<W>;
+  require_weighted_nonnegative(g, "delta_stepping");
+  std::size_t const n = g.num_vertices();
+  if (source >= n) throw std::out_of_range("delta_stepping: source out of range");
+  if (!(delta > D{0})) delta = default_delta(g);
+
+  scratch_buffer<std::atomic<D>> dist(n, mr);
+  for (std::size_t v = 0; v < n; ++v) dist[v].store(infinite_distance<W>(), std::memory_order_relaxed);
+  dist[source].store(D{0}, std::memory_order_relaxed);
+
+  // Each task slot keeps its own buckets between rounds; a slot is only ever
+  // run by one thread at a time, so its buckets need no locking.
+  std::size_t const slots = std::size_t{threads} * tasks_per_thread;
+  std::pmr::vector<std::pmr::vector<std::pmr::vector<vertex_id>>> bins(
+      slots, task_resource(threads, mr));
+  std::pmr::vector<vertex_id> frontier(1, source, mr);
+  std::size_t current = 0;
+
+  while (true) {
+    std::size_t const tasks = std::max<std::size_t>(1, std::min(slots, frontier.size() / 64 + 1));
+    parallel_for(tasks, threads, [&](std::size_t t) {
+      auto& my_bins = bins[t];
+      std::size_t const b = frontier.size() * t / tasks, e = frontier.size() * (t + 1) / tasks;
+      for (std::size_t i = b; i < e; ++i) {
+        vertex_id const u = frontier[i];
+        D const du = dist[u].load(std::memory_order_relaxed);
+        // Settled in an earlier bucket. Compare bucket indices computed the
+        // same way as on insertion; delta * current can round differently.
+        if (static_cast<std::size_t>(du / delta) < current) continue;
+        auto const nbrs = g.neighbors(u);
+        auto const ws = g.weights(u);
+        ALGORITMI_COUNT(relaxations, nbrs.size());
+        for (std::size_t k = 0; k < nbrs.size(); ++k) {
+          D const nd = du + static_cast<D>(ws[k]);
+          if (atomic_fetch_min(dist[nbrs[k]], nd)) {
+            std::size_t const bin = static_cast<std::size_t>(nd / delta);
+            if (bin >= my_bins.size()) my_bins.resize(bin + 1);
+            my_bins[bin].push_back(nbrs[k]);
+          }
+        }
+      }
+    });
+
+    // Next bucket: the lowest non-empty one at or after the current one.
+    std::size_t next = std::numeric_limits<std::size_t>::max();
+    for (auto const& slot : bins)
+      for (std::size_t b = current; b < slot.size() && b < next; ++b)
+        if (!slot[b].empty()) {
+          next = b;
+          break;
+        }
+    if (next == std::numeric_limits<std::size_t>::max()) break;
+    current = next;
+    frontier.clear();
+    for (auto& slot : bins) {
+      if (current < slot.size()) {
+        frontier.insert(frontier.end(), slot[current].begin(), slot[current].end());
+        slot[current].clear();
+      }
+    }
+  }
+
+  std::pmr::vector<D> result(n, mr);
+  for (std::size_t v = 0; v < n; ++v) result[v] = dist[v].load(std::memory_order_relaxed);
+  return result;
+}
+
+}  // namespace detail::graph
+
+// Dijkstra's algorithm with a monotone radix heap. Distances are mapped to
+// order-preserving unsigned integers, so floating-point weights work too.
+template <class W>
+std::pmr::vector<distance_t<W>> dijkstra(csr_graph<W> const& g, vertex_id source,
+                                         std::pmr::memory_resource* mr =
+                                             std::pmr::get_default_resource()) {
+  using D = distance_t<W>;
+  using traits = detail::radix::key_traits<D>;
+  detail::graph::require_weighted_nonnegative(g, "dijkstra");
+  std::size_t const n = g.num_vertices();
+  if (source >= n) throw std::out_of_range("dijkstra: source out of range");
+
+  std::pmr::vector<D> dist(n, infinite_distance<W>(), mr);
+  dist[source] = D{0};
+  radix_heap<typename traits::bits_type, vertex_id> heap(mr);
+  heap.push(traits::encode(D{0}), source);
+  while (!heap.empty()) {
+    auto const [key, u] = heap.pop();
+    D const du = dist[u];
+    if (traits::encode(du) != key) continue;  // stale entry
+    auto const nbrs = g.neighbors(u);
+    auto const ws = g.weights(u);
+    ALGORITMI_COUNT(relaxations, nbrs.size());
+    for (std::size_t k = 0; k < nbrs.size(); ++k) {
+      D const nd = du + static_cast<D>(ws[k]);
+      if (nd < dist[nbrs[k]]) {
+        dist[nbrs[k]] = nd;
+        heap.push(traits::encode(nd), nbrs[k]);
+      }
+    }
+  }
+  return dist;
+}
+
+// delta == 0 picks a bucket width from the graph (see default_delta).
+template <class W>
+std::pmr::vector<distance_t<W>> delta_stepping(
+    csr_graph<W> const& g, vertex_id source, distance_t<W> delta = distance_t<W>{0},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::delta_stepping(g, source, delta, 1, mr);
+}
+
+template <class W>
+std::pmr::vector<distance_t<W>> delta_stepping(
+    parallel_policy policy, csr_graph<W> const& g, vertex_id source,
+    distance_t<W> delta = distance_t<W>{0},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::delta_stepping(g, source, delta, detail::resolve_threads(policy.threads),
+                                       mr);
+}
+
+// Recovers a shortest-path tree from final distances: parent[v] is some u
+// with dist[u] + w(u, v) == dist[v]. parent[source] == source; unreached
+// vertices get no_vertex. The tree grows breadth-first from the source over
+// such tight edges, so every parent chain ends at the source even where
+// zero-weight cycles make tight edges point both ways.
+template <class W>
+std::pmr::vector<vertex_id> shortest_path_tree(
+    csr_graph<W> const& g, span<distance_t<W> const> dist, vertex_id source,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  std::size_t const n = g.num_vertices();
+  if (source >= n) throw std::out_of_range("shortest_path_tree: source out of range");
+  if (dist.size() != n) throw std::invalid_argument("shortest_path_tree: distance count mismatch");
+  std::pmr::vector<vertex_id> parent(n, no_vertex, mr);
+  parent[source] = source;
+  std::pmr::vector<vertex_id> queue(mr);
+  queue.reserve(n);
+  queue.push_back(source);
+  for (std::size_t head = 0; head < queue.size(); ++head) {
+    vertex_id const u = queue[head];
+    auto const nbrs = g.neighbors(u);
+    auto const ws = g.weights(u);
+    for (std::size_t k = 0; k < nbrs.size(); ++k) {
+      vertex_id const v = nbrs[k];
+      if (parent[v] == no_vertex && dist[u] + static_cast<distance_t<W>>(ws[k]) == dist[v]) {
+        parent[v] = u;
+        queue.push_back(v);
+      }
+    }
+  }
+  return parent;
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,311 @@
+// Minimum spanning forests of undirected, weighted edge lists.
+//
+//   kruskal(n, edges, m)                 sort by weight, join with union_find
+//   filter_kruskal([par,] n, edges, m)   Osipov, Sanders & Singler, "The
+//                                        Filter-Kruskal Minimum Spanning Tree
+//                                        Algorithm", 2009
+//   boruvka([par,] n, edges, m)          rounds of cheapest-edge contraction
+//
+// Each returns the indices in `edges` of a minimum spanning forest: a
+// minimum spanning tree of every connected component, n minus the number
+// of components edges in all. Self-loops are ignored; parallel edges are
+// fine. Weights must not be NaN. All three break ties between equal
+// weights by edge index, which makes the minimum forest unique: they
+// return the same edges, in different orders.
+//
+// Filter-Kruskal splits the edges around a sampled pivot weight, solves
+// the light part first and then drops every heavy edge whose endpoints it
+// already connected before sorting what is left; on graphs much denser
+// than a tree most edges are never sorted. The pivot is set to leave about
+// 2n light edges rather than half of them, so that one filter pass
+// usually discards nearly all the rest. The parallel overload runs the
+// partitions, the filter and the sorts on the scheduler. Boruvka instead
+// has every component pick its cheapest outgoing edge at once, so each
+// round halves the components at least and is a parallel pass over the
+// surviving edges, joined with concurrent_union_find.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "../primitives/partition.hpp"
+#include "../sort/parallel_sort.hpp"
+#include "../sort/radix_sort.hpp"
+#include "csr_graph.hpp"
+#include "union_find.hpp"
+
+namespace algoritmi {
+namespace detail::graph {
+
+// An input edge with its index, the unit every algorithm here moves.
+template <class W>
+struct edge_record {
+  W weight;
+  vertex_id from;
+  vertex_id to;
+  edge_index index;
+};
+
+template <class W>
+bool lighter(edge_record<W> const& a, edge_record<W> const& b) noexcept {
+  return a.weight < b.weight || (a.weight == b.weight && a.index < b.index);
+}
+
+// Copies the edges that are not self-loops, checking the endpoints.
+template <class W>
+std::pmr::vector<edge_record<W>> records(std::size_t n, weighted_edge<W> const* edges,
+                                         std::size_t m, char const* who,
+                                         std::pmr::memory_resource* mr) {
+  if (n > no_vertex) throw std::length_error(std::string(who) + ": too many vertices");
+  std::pmr::vector<edge_record<W>> out(mr);
+  out.reserve(m);
+  for (std::size_t i = 0; i < m; ++i) {
+    weighted_edge<W> const& e = edges[i];
+    if (e.from >= n || e.to >= n)
+      throw std::out_of_range(std::string(who) + ": vertex id out of range");
+    if (e.from != e.to) out.push_back({e.weight, e.from, e.to, static_cast<edge_index>(i)});
+  }
+  return out;
+}
+
+// Sorting by weight with a stable sort keeps equal weights in index order,
+// the order records() produced them in.
+template <class W>
+void sort_by_weight(edge_record<W>* first, edge_record<W>* last, unsigned threads,
+                    std::pmr::memory_resource* mr) {
+  auto const weight = [](edge_record<W> const& e) { return e.weight; };
+  if (threads > 1)
+    radix_sort(parallel_policy{threads}, first, last, weight, mr);
+  else
+    radix_sort(first, last, weight, mr);
+}
+
+// Stops early once the forest is a spanning tree of all n vertices.
+template <class UnionFind, class W>
+void kruskal_pass(UnionFind& uf, edge_record<W> const* first, edge_record<W> const* last,
+                  std::size_t n, std::pmr::vector<edge_index>& forest) {
+  for (; first != last && forest.size() + 1 < n; ++first)
+    if (uf.unite(first->from, first->to)) forest.push_back(first->index);
+}
+
+template <class W, class Pred>
+std::size_t partition_edges(edge_record<W>* data, std::size_t n, Pred pred, unsigned threads,
+                            std::pmr::memory_resource* mr) {
+  if (threads > 1) return stable_partition(parallel_policy{threads}, data, n, pred, mr);
+  return stable_partition(data, n, pred, mr);
+}
+
+// Stable copy of the edges satisfying pred; in and out must not overlap.
+template <class W, class Pred>
+std::size_t copy_edges(edge_record<W> const* in, std::size_t n, edge_record<W>* out, Pred pred,
+                       unsigned threads, std::pmr::memory_resource* mr) {
+  if (threads > 1) return copy_if(parallel_policy{threads}, in, n, out, pred, mr);
+  return copy_if(in, n, out, pred);
+}
+
+// Filter-Kruskal just sorts below this many edges, or below this many per
+// vertex, where filtering cannot discard enough to pay for its passes.
+inline constexpr std::size_t filter_base_edges = 1 << 14;
+inline constexpr std::size_t filter_min_degree = 4;
+inline constexpr std::size_t pivot_samples = 255;
+
+// The edges move between `data` and `scratch`, both m long, rather than
+// being partitioned in place: every pass is one stable copy, and no pass
+// allocates. Both halves keep index order, so ties are broken by index
+// exactly as in kruskal().
+template <class UnionFind, class W>
+void filter_kruskal(UnionFind& uf, edge_record<W>* data, edge_record<W>* scratch, std::size_t m,
+                    std::size_t n, std::pmr::vector<edge_index>& forest, unsigned threads,
+                    std::pmr::memory_resource* mr) {
+  while (m > 0 && forest.size() + 1 < n) {
+    if (m <= std::max(filter_base_edges, filter_min_degree * n)) {
+      // The sort's buffer is the scratch half.
+      std::pmr::monotonic_buffer_resource pool(scratch, m * sizeof(edge_record<W>), mr);
+      sort_by_weight(data, data + m, threads, &pool);
+      kruskal_pass(uf, data, data + m, n, forest);
+      return;
+    }
+    W samples[pivot_samples];
+    for (std::size_t i = 0; i < pivot_samples; ++i)
+      samples[i] = data[(2 * i + 1) * m / (2 * pivot_samples)].weight;
+    // About 2n light edges tend to connect most of the graph, after which
+    // the filter drops nearly all heavy ones; aim there, but at no more
+    // than half the edges.
+    std::size_t const rank = std::min(pivot_samples / 2, pivot_samples * 2 * n / m);
+    std::nth_element(samples, samples + rank, samples + pivot_samples);
+    W const pivot = samples[rank];
+    bool strict = false;
+    auto light = [&](edge_record<W> const& e) {
+      return strict ? e.weight < pivot : !(pivot < e.weight);
+    };
+    std::size_t count = copy_edges(data, m, scratch, light, threads, mr);
+    if (count == m) {
+      // The pivot is the largest weight: split off the edges equal to it.
+      strict = true;
+      count = copy_edges(data, m, scratch, light, threads, mr);
+      if (count == 0) {
+        // All weights are equal; index order is already weight order.
+        kruskal_pass(uf, data, data + m, n, forest);
+        return;
+      }
+    }
+    copy_edges(data, m, scratch + count, [&](edge_record<W> const& e) { return !light(e); },
+               threads, mr);
+    filter_kruskal(uf, scratch, data, count, n, forest, threads, mr);
+    m = copy_edges(
+        scratch + count, m - count, data + count,
+        [&uf](edge_record<W> const& e) { return uf.find(e.from) != uf.find(e.to); }, threads,
+        mr);
+    data += count;
+    scratch += count;
+  }
+}
+
+inline constexpr edge_index no_edge = std::numeric_limits<edge_index>::max();
+
+// Each round contracts the edges to their components' roots first, so the
+// rest of the round reads roots straight from the edge, and drops the
+// edges inside a component.
+template <class W>
+std::pmr::vector<edge_index> boruvka(std::size_t n, weighted_edge<W> const* edges, std::size_t m,
+                                     unsigned threads, std::pmr::memory_resource* mr) {
+  auto live = records(n, edges, m, "boruvka", mr);
+  concurrent_union_find uf(n, mr);
+  // cheapest[c]: root c's lightest outgoing edge, as its position in `live`
+  // or, when weights have at most 32 bits and positions fit in 32, as
+  // (weight bits, position): then a plain atomic minimum finds it without
+  // reading the edge the slot holds now.
+  scratch_buffer<std::atomic<edge_index>> cheapest(n, mr);
+  for (std::size_t v = 0; v < n; ++v) cheapest[v].store(no_edge, std::memory_order_relaxed);
+  bool const packed = sizeof(W) <= 4 && live.size() < 0xffffffffu;
+  auto offer = [&](vertex_id c, std::size_t pos) {
+    std::atomic<edge_index>& slot = cheapest[c];
+    edge_index cur = slot.load(std::memory_order_relaxed);
+    if constexpr (sizeof(W) <= 4) {
+      if (packed) {
+        edge_index const key =
+            edge_index{radix::key_traits<W>::encode(live[pos].weight)} << 32 | pos;
+        while (key < cur)
+          if (slot.compare_exchange_weak(cur, key, std::memory_order_relaxed)) return;
+        return;
+      }
+    }
+    while (cur == no_edge || lighter(live[pos], live[cur]))
+      if (slot.compare_exchange_weak(cur, pos, std::memory_order_relaxed)) return;
+  };
+
+  std::size_t const slots = std::size_t{threads} * tasks_per_thread;
+  std::pmr::vector<std::pmr::vector<edge_index>> picked(slots, task_resource(threads, mr));
+  std::pmr::vector<edge_index> forest(mr);
+  auto split = [&](std::size_t count, auto&& body) {
+    std::size_t const tasks = std::max<std::size_t>(1, std::min(slots, count / 4096 + 1));
+    parallel_for(tasks, threads, [&](std::size_t t) {
+      body(t, count * t / tasks, count * (t + 1) / tasks);
+    });
+  };
+
+  while (!live.empty()) {
+    split(live.size(), [&](std::size_t, std::size_t b, std::size_t e) {
+      for (std::size_t i = b; i < e; ++i) {
+        live[i].from = uf.find(live[i].from);
+        live[i].to = uf.find(live[i].to);
+      }
+    });
+    live.resize(partition_edges(
+        live.data(), live.size(), [](edge_record<W> const& e) { return e.from != e.to; },
+        threads, mr));
+    split(live.size(), [&](std::size_t, std::size_t b, std::size_t e) {
+      for (std::size_t i = b; i < e; ++i) {
+        offer(live[i].from, i);
+        offer(live[i].to, i);
+      }
+    });
+    // The cheapest edges under a strict order form a forest, except that
+    // two components may pick the same edge: only one unite succeeds.
+    split(n, [&](std::size_t t, std::size_t b, std::size_t e) {
+      for (std::size_t c = b; c < e; ++c) {
+        edge_index const slot = cheapest[c].load(std::memory_order_relaxed);
+        if (slot == no_edge) continue;
+        cheapest[c].store(no_edge, std::memory_order_relaxed);
+        std::size_t const pos = packed ? slot & 0xffffffffu : slot;
+        if (uf.unite(live[pos].from, live[pos].to)) picked[t].push_back(live[pos].index);
+      }
+    });
+    for (auto& p : picked) {
+      forest.insert(forest.end(), p.begin(), p.end());
+      p.clear();
+    }
+  }
+  return forest;
+}
+
+}  // namespace detail::graph
+
+template <class W>
+std::pmr::vector<edge_index> kruskal(
+    std::size_t num_vertices, weighted_edge<W> const* edges, std::size_t m,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  auto live = detail::graph::records(num_vertices, edges, m, "kruskal", mr);
+  detail::graph::sort_by_weight(live.data(), live.data() + live.size(), 1, mr);
+  union_find uf(num_vertices, mr);
+  std::pmr::vector<edge_index> forest(mr);
+  detail::graph::kruskal_pass(uf, live.data(), live.data() + live.size(), num_vertices,
+                              forest);
+  return forest;
+}
+
+template <class W>
+std::pmr::vector<edge_index> filter_kruskal(
+    std::size_t num_vertices, weighted_edge<W> const* edges, std::size_t m,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  auto live = detail::graph::records(num_vertices, edges, m, "filter_kruskal", mr);
+  union_find uf(num_vertices, mr);
+  std::pmr::vector<edge_index> forest(mr);
+  detail::scratch_buffer<detail::graph::edge_record<W>> scratch(live.size(), mr);
+  detail::graph::filter_kruskal(uf, live.data(), scratch.get(), live.size(), num_vertices,
+                                forest, 1, mr);
+  return forest;
+}
+
+// Finds in the parallel filter step run concurrently, so this one joins
+// with concurrent_union_find.
+template <class W>
+std::pmr::vector<edge_index> filter_kruskal(
+    parallel_policy policy, std::size_t num_vertices, weighted_edge<W> const* edges,
+    std::size_t m, std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  auto live = detail::graph::records(num_vertices, edges, m, "filter_kruskal", mr);
+  concurrent_union_find uf(num_vertices, mr);
+  std::pmr::vector<edge_index> forest(mr);
+  detail::scratch_buffer<detail::graph::edge_record<W>> scratch(live.size(), mr);
+  detail::graph::filter_kruskal(uf, live.data(), scratch.get(), live.size(), num_vertices,
+                                forest, detail::resolve_threads(policy.threads), mr);
+  return forest;
+}
+
+template <class W>
+std::pmr::vector<edge_index> boruvka(
+    std::size_t num_vertices, weighted_edge<W> const* edges, std::size_t m,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::boruvka(num_vertices, edges, m, 1, mr);
+}
+
+template <class W>
+std::pmr::vector<edge_index> boruvka(
+    parallel_policy policy, std::size_t num_vertices, weighted_edge<W> const* edges,
+    std::size_t m, std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  return detail::graph::boruvka(num_vertices, edges, m, detail::resolve_threads(policy.threads),
+                              mr);
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,147 @@
+// Disjoint sets over the integers [0, n).
+//
+// union_find links by rank and halves paths on find: every node visited
+// is pointed at its grandparent, which flattens trees about as well as full
+// compression in a single pass and without a second walk. Any sequence of
+// m operations costs O(m alpha(n)).
+//
+// concurrent_union_find is the lock-free version (Anderson & Woll, "Wait-free
+// parallel algorithms for the union-find problem", 1991): a node's parent and
+// rank share one 64-bit word, a root is linked with a single CAS that fails
+// if it stopped being a root or changed rank, and path halving is a CAS
+// that is simply dropped when it loses a race. Linking the root with the
+// smaller (rank, index) under the other keeps that pair strictly increasing
+// along every path, so racing unites can never close a cycle. find, unite
+// and same may be called from any number of threads at once.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.hpp"
+
+namespace algoritmi {
+
+class union_find {
+ public:
+  explicit union_find(std::size_t n = 0,
+                      std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : parent_(mr), rank_(mr), sets_(n) {
+    if (n > no_vertex) throw std::length_error("union_find: too many elements");
+    parent_.resize(n);
+    rank_.assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i) parent_[i] = static_cast<vertex_id>(i);
+  }
+
+  std::size_t size() const noexcept { return parent_.size(); }
+  // Number of disjoint sets.
+  std::size_t set_count() const noexcept { return sets_; }
+
+  // Representative of x's set.
+  vertex_id find(vertex_id x) noexcept {
+    while (parent_[x] != x) {
+      parent_[x] = parent_[parent_[x]];
+      x = parent_[x];
+    }
+    return x;
+  }
+
+  // Merges the sets of a and b; false if they were already one.
+  bool unite(vertex_id a, vertex_id b) noexcept {
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+    if (rank_[a] < rank_[b]) std::swap(a, b);
+    parent_[b] = a;
+    rank_[a] += rank_[a] == rank_[b];
+    --sets_;
+    return true;
+  }
+
+  bool same(vertex_id a, vertex_id b) noexcept { return find(a) == find(b); }
+
+ private:
+  std::pmr::vector<vertex_id> parent_;
+  std::pmr::vector<std::uint8_t> rank_;  // at most log2(n)
+  std::size_t sets_;
+};
+
+class concurrent_union_find {
+ public:
+  explicit concurrent_union_find(std::size_t n = 0,
+                                 std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : nodes_(checked_size(n), mr) {
+    for (std::size_t i = 0; i < n; ++i)
+      nodes_[i].store(pack(static_cast<vertex_id>(i), 0), std::memory_order_relaxed);
+  }
+
+  std::size_t size() const noexcept { return nodes_.size(); }
+
+  // Representative of x's set at some point during the call.
+  vertex_id find(vertex_id x) noexcept {
+    for (;;) {
+      std::uint64_t w = nodes_[x].load(std::memory_order_acquire);
+      vertex_id const p = parent(w);
+      if (p == x) return x;
+      vertex_id const g = parent(nodes_[p].load(std::memory_order_acquire));
+      if (g != p) nodes_[x].compare_exchange_weak(w, pack(g, rank(w)), std::memory_order_acq_rel);
+      x = g;
+    }
+  }
+
+  // Merges the sets of a and b; false if they were already one. Exactly one
+  // of several racing calls that join the same two sets returns true.
+  bool unite(vertex_id a, vertex_id b) noexcept {
+    for (;;) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return false;
+      std::uint64_t wa = nodes_[a].load(std::memory_order_acquire);
+      std::uint64_t wb = nodes_[b].load(std::memory_order_acquire);
+      if (parent(wa) != a || parent(wb) != b) continue;
+      // a goes under b: the smaller (rank, index) is the child.
+      if (rank(wa) > rank(wb) || (rank(wa) == rank(wb) && a > b)) {
+        std::swap(a, b);
+        std::swap(wa, wb);
+      }
+      if (!nodes_[a].compare_exchange_strong(wa, pack(b, rank(wa)), std::memory_order_acq_rel))
+        continue;
+      // Losing this race only leaves the rank lower than it could be.
+      if (rank(wa) == rank(wb))
+        nodes_[b].compare_exchange_strong(wb, pack(b, rank(wb) + 1), std::memory_order_acq_rel);
+      return true;
+    }
+  }
+
+  bool same(vertex_id a, vertex_id b) noexcept {
+    for (;;) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return true;
+      // a still a root means the two roots were distinct at the same time.
+      if (parent(nodes_[a].load(std::memory_order_acquire)) == a) return false;
+    }
+  }
+
+ private:
+  static std::size_t checked_size(std::size_t n) {
+    if (n > no_vertex) throw std::length_error("concurrent_union_find: too many elements");
+    return n;
+  }
+  static std::uint64_t pack(vertex_id parent, std::uint32_t rank) noexcept {
+    return std::uint64_t{rank} << 32 | parent;
+  }
+  static vertex_id parent(std::uint64_t w) noexcept { return static_cast<vertex_id>(w); }
+  static std::uint32_t rank(std::uint64_t w) noexcept {
+    return static_cast<std::uint32_t>(w >> 32);
+  }
+
+  std::pmr::vector<std::atomic<std::uint64_t>> nodes_;
+};
+
+}  // namespace algoritmi
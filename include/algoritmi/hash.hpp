@@ -0,0 +1,19 @@
+// Hash containers: open addressing over Swiss-table control bytes, probed
+// 16 slots at a time with SSE2.
+//
+//   flat_hash_map<K, V>  elements stored inline; fastest, but growth moves
+//   flat_hash_set<K>     them
+//   node_hash_map<K, V>  elements allocated one by one and never moved, so
+//   node_hash_set<K>     references survive rehashing
+//   hash<K>              default hasher; transparent for the string types
+//
+// The interface follows std::unordered_map (find, contains, insert,
+// emplace, try_emplace, insert_or_assign, operator[], at, erase, reserve,
+// rehash) minus the bucket API. Lookups are heterogeneous when both the
+// hasher and the equality define is_transparent, as the defaults do for
+// strings. Each container takes a std::pmr::memory_resource* last.
+#pragma once
+
+#include "hash/flat_hash_map.hpp"
+#include "hash/hash.hpp"
+#include "hash/node_hash_map.hpp"
@@ -0,0 +1,109 @@
+// Flat open-addressing hash map and set: elements live in the slot array.
+//
+// Lookups touch one control group and, usually, one slot. Growing moves the
+// elements, so pointers and references into the table are invalidated by
+// any insertion that rehashes (use node_hash_map when they must stay put);
+// iterators are invalidated likewise. Erasing never moves other elements.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "hash.hpp"
+#include "raw_table.hpp"
+
+namespace algoritmi {
+namespace detail::hash {
+
+template <class K, class V>
+struct flat_map_policy {
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K const, V>;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+
+  // The pair is stored as pair<const K, V> but moved on rehash as its
+  // layout-identical pair<K, V>, so string keys are moved rather than
+  // copied when the table grows (the same trick libc++ and Abseil use).
+  union slot_type {
+    slot_type() {}
+    ~slot_type() {}
+    value_type value;
+    std::pair<K, V> mutable_value;
+  };
+
+  static constexpr bool trivially_destructible = std::is_trivially_destructible_v<value_type>;
+
+  static K const& key(slot_type const* s) noexcept { return s->value.first; }
+  static K const& key_of(value_type const& v) noexcept { return v.first; }
+  static value_type& element(slot_type* s) noexcept { return s->value; }
+
+  template <class... Args>
+  static void construct(std::pmr::memory_resource*, slot_type* s, Args&&... args) {
+    ::new (static_cast<void*>(&s->value)) value_type(std::forward<Args>(args)...);
+  }
+  static void destroy(std::pmr::memory_resource*, slot_type* s) noexcept { s->value.~value_type(); }
+  static void transfer(std::pmr::memory_resource*, slot_type* dst, slot_type* src) {
+    ::new (static_cast<void*>(&dst->mutable_value)) std::pair<K, V>(std::move(src->mutable_value));
+    src->mutable_value.~pair();
+  }
+};
+
+template <class K>
+struct flat_set_policy {
+  using key_type = K;
+  using value_type = K;
+  using reference = K const&;
+  using const_reference = K const&;
+
+  union slot_type {
+    slot_type() {}
+    ~slot_type() {}
+    K value;
+  };
+
+  static constexpr bool trivially_destructible = std::is_trivially_destructible_v<K>;
+
+  static K const& key(slot_type const* s) noexcept { return s->value; }
+  static K const& key_of(K const& v) noexcept { return v; }
+  static K& element(slot_type* s) noexcept { return s->value; }
+
+  template <class... Args>
+  static void construct(std::pmr::memory_resource*, slot_type* s, Args&&... args) {
+    ::new (static_cast<void*>(&s->value)) K(std::forward<Args>(args)...);
+  }
+  static void destroy(std::pmr::memory_resource*, slot_type* s) noexcept { s->value.~K(); }
+  static void transfer(std::pmr::memory_resource*, slot_type* dst, slot_type* src) {
+    ::new (static_cast<void*>(&dst->value)) K(std::move(src->value));
+    src->value.~K();
+  }
+};
+
+}  // namespace detail::hash
+
+// Hash is applied through detail::hash::mix, so std::hash's identity hash
+// for integers is fine. With algoritmi::hash and std::equal_to<> (the
+// defaults) string-keyed tables accept std::string_view and const char*
+// in find, contains, count, erase, try_emplace and operator[].
+template <class K, class V, class Hash = hash<K>, class Eq = std::equal_to<>>
+class flat_hash_map : public detail::hash::raw_map<detail::hash::flat_map_policy<K, V>, Hash, Eq> {
+  using base = detail::hash::raw_map<detail::hash::flat_map_policy<K, V>, Hash, Eq>;
+
+ public:
+  using base::base;
+};
+
+template <class K, class Hash = hash<K>, class Eq = std::equal_to<>>
+class flat_hash_set : public detail::hash::raw_table<detail::hash::flat_set_policy<K>, Hash, Eq> {
+  using base = detail::hash::raw_table<detail::hash::flat_set_policy<K>, Hash, Eq>;
+
+ public:
+  using base::base;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,106 @@
+// Control bytes for the open-addressing tables (Swiss-table layout).
+//
+// Every slot has one control byte: empty, deleted (a tombstone), or full,
+// in which case it holds the low 7 bits of the slot's hash (H2). Probing
+// loads 16 control bytes at once and compares them against H2 in a single
+// SSE2 instruction, so one probe step filters 16 candidates and the full
+// keys are only compared for the ~1/128 false positives.
+//
+// The encodings are chosen so that "empty or deleted" is "less than the
+// sentinel" (all have the top bit set), which is one signed compare.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../config.hpp"
+#include "../detail/bits.hpp"
+
+#if ALGORITMI_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace algoritmi::detail::hash {
+
+using ctrl_t = std::int8_t;
+
+inline constexpr ctrl_t ctrl_empty = -128;    // 0b10000000
+inline constexpr ctrl_t ctrl_deleted = -2;    // 0b11111110
+inline constexpr ctrl_t ctrl_sentinel = -1;   // 0b11111111, ends iteration
+inline constexpr std::size_t group_width = 16;
+
+inline bool is_full(ctrl_t c) noexcept { return c >= 0; }
+inline bool is_empty_or_deleted(ctrl_t c) noexcept { return c < ctrl_sentinel; }
+
+// Control bytes of a table with no storage: a sentinel followed by a group
+// of empties, so lookups and iteration need no special case. Never written.
+inline ctrl_t* empty_group() noexcept {
+  alignas(group_width) static ctrl_t const bytes[group_width] = {
+      ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+      ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+      ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty};
+  return const_cast<ctrl_t*>(bytes);
+}
+
+// 16 control bytes. The match functions return a bitmask with bit i set
+// when byte i qualifies; walk it with countr_zero and `m &= m - 1`.
+#if ALGORITMI_SSE2
+
+struct group {
+  explicit group(ctrl_t const* p) noexcept
+      : ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))) {}
+
+  std::uint32_t match(std::uint8_t h2) const noexcept {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), ctrl)));
+  }
+  std::uint32_t match_empty() const noexcept {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(ctrl_empty), ctrl)));
+  }
+  std::uint32_t match_empty_or_deleted() const noexcept {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl)));
+  }
+  // Number of leading empty-or-deleted bytes; iteration skips them at once.
+  unsigned count_leading_empty_or_deleted() const noexcept {
+    return static_cast<unsigned>(countr_zero(match_empty_or_deleted() + 1));
+  }
+
+  __m128i ctrl;
+};
+
+#else
+
+struct group {
+  explicit group(ctrl_t const* p) noexcept {
+    for (std::size_t i = 0; i < group_width; ++i) ctrl[i] = p[i];
+  }
+
+  std::uint32_t match(std::uint8_t h2) const noexcept {
+    std::uint32_t m = 0;
+    for (std::size_t i = 0; i < group_width; ++i)
+      m |= std::uint32_t{ctrl[i] == static_cast<ctrl_t>(h2)} << i;
+    return m;
+  }
+  std::uint32_t match_empty() const noexcept {
+    std::uint32_t m = 0;
+    for (std::size_t i = 0; i < group_width; ++i) m |= std::uint32_t{ctrl[i] == ctrl_empty} << i;
+    return m;
+  }
+  std::uint32_t match_empty_or_deleted() const noexcept {
+    std::uint32_t m = 0;
+    for (std::size_t i = 0; i < group_width; ++i)
+      m |= std::uint32_t{is_empty_or_deleted(ctrl[i])} << i;
+    return m;
+  }
+  unsigned count_leading_empty_or_deleted() const noexcept {
+    return static_cast<unsigned>(countr_zero(match_empty_or_deleted() + 1));
+  }
+
+  ctrl_t ctrl[group_width];
+};
+
+#endif
+
+}  // namespace algoritmi::detail::hash
@@ -0,0 +1,55 @@
+// Default hasher for the hash tables, and the finaliser they apply on top.
+//
+// algoritmi::hash<K> is std::hash<K>, except that the string types hash
+// through std::string_view and are transparent, so a table keyed by
+// std::string can be probed with a string_view or a literal without
+// building a temporary string.
+//
+// Tables never use the user's hash value directly: std::hash of an integer
+// is the identity in libstdc++ and libc++, and the control bytes and probe
+// start are cut from the low and high bits. mix() spreads every input bit
+// over the whole word with one 64x64->128 multiply.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace algoritmi {
+
+template <class K>
+struct hash : std::hash<K> {};
+
+template <class CharT, class Traits, class Alloc>
+struct hash<std::basic_string<CharT, Traits, Alloc>> {
+  using is_transparent = void;
+  std::size_t operator()(std::basic_string_view<CharT, Traits> s) const noexcept {
+    return std::hash<std::basic_string_view<CharT, Traits>>{}(s);
+  }
+};
+
+template <class CharT, class Traits>
+struct hash<std::basic_string_view<CharT, Traits>>
+    : hash<std::basic_string<CharT, Traits>> {};
+
+namespace detail::hash {
+
+inline std::size_t mix(std::size_t h) noexcept {
+  constexpr std::uint64_t k = 0x9e3779b97f4a7c15ull;
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 const m = static_cast<unsigned __int128>(h) * k;
+  return static_cast<std::size_t>(static_cast<std::uint64_t>(m) ^
+                                  static_cast<std::uint64_t>(m >> 64));
+#else
+  // splitmix64 finaliser.
+  std::uint64_t z = static_cast<std::uint64_t>(h) + k;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return static_cast<std::size_t>(z ^ (z >> 31));
+#endif
+}
+
+}  // namespace detail::hash
+}  // namespace algoritmi
@@ -0,0 +1,103 @@
+// Node-based hash map and set: the same Swiss-table index, but each slot
+// holds a pointer to an element allocated separately from the memory
+// resource. Elements never move, so pointers and references stay valid
+// until the element is erased, even across rehashes, and growing the table
+// only copies pointers. Costs an allocation per element (a fixed_pool
+// sized node_size makes that cheap) and one more cache miss per lookup.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#include "hash.hpp"
+#include "raw_table.hpp"
+
+namespace algoritmi {
+namespace detail::hash {
+
+template <class Value, class Key, class KeyOf>
+struct node_policy {
+  using key_type = Key;
+  using value_type = Value;
+  using slot_type = Value*;
+
+  static constexpr bool trivially_destructible = false;
+
+  static Key const& key(slot_type const* s) noexcept { return KeyOf{}(**s); }
+  static Key const& key_of(Value const& v) noexcept { return KeyOf{}(v); }
+  static Value& element(slot_type* s) noexcept { return **s; }
+
+  template <class... Args>
+  static void construct(std::pmr::memory_resource* mr, slot_type* s, Args&&... args) {
+    void* p = mr->allocate(sizeof(Value), alignof(Value));
+    try {
+      *s = ::new (p) Value(std::forward<Args>(args)...);
+    } catch (...) {
+      mr->deallocate(p, sizeof(Value), alignof(Value));
+      throw;
+    }
+  }
+  static void destroy(std::pmr::memory_resource* mr, slot_type* s) noexcept {
+    (*s)->~Value();
+    mr->deallocate(*s, sizeof(Value), alignof(Value));
+  }
+  static void transfer(std::pmr::memory_resource*, slot_type* dst, slot_type* src) noexcept {
+    *dst = *src;
+  }
+};
+
+struct key_of_pair {
+  template <class P>
+  auto const& operator()(P const& p) const noexcept {
+    return p.first;
+  }
+};
+struct key_of_self {
+  template <class T>
+  T const& operator()(T const& v) const noexcept {
+    return v;
+  }
+};
+
+template <class K, class V>
+struct node_map_policy : node_policy<std::pair<K const, V>, K, key_of_pair> {
+  using mapped_type = V;
+  using reference = std::pair<K const, V>&;
+  using const_reference = std::pair<K const, V> const&;
+};
+
+template <class K>
+struct node_set_policy : node_policy<K, K, key_of_self> {
+  using reference = K const&;
+  using const_reference = K const&;
+};
+
+}  // namespace detail::hash
+
+template <class K, class V, class Hash = hash<K>, class Eq = std::equal_to<>>
+class node_hash_map : public detail::hash::raw_map<detail::hash::node_map_policy<K, V>, Hash, Eq> {
+  using base = detail::hash::raw_map<detail::hash::node_map_policy<K, V>, Hash, Eq>;
+
+ public:
+  // Bytes per element, for sizing a fixed_pool.
+  static constexpr std::size_t node_size = sizeof(std::pair<K const, V>);
+  static constexpr std::size_t node_align = alignof(std::pair<K const, V>);
+
+  using base::base;
+};
+
+template <class K, class Hash = hash<K>, class Eq = std::equal_to<>>
+class node_hash_set : public detail::hash::raw_table<detail::hash::node_set_policy<K>, Hash, Eq> {
+  using base = detail::hash::raw_table<detail::hash::node_set_policy<K>, Hash, Eq>;
+
+ public:
+  static constexpr std::size_t node_size = sizeof(K);
+  static constexpr std::size_t node_align = alignof(K);
+
+  using base::base;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,675 @@
+// Open-addressing table shared by the flat and node hash containers.
+//
+// Layout: one allocation holding capacity + 16 control bytes followed by
+// the slots. capacity is always 2^k - 1, so it doubles as the index mask.
+// Control byte `capacity` is a sentinel that stops iteration, and the 15
+// bytes after it mirror the first 15, so a group load at any position
+// reads 16 valid bytes without wrapping.
+//
+// A hash value is split in two: H1 (the high bits) picks where probing
+// starts and H2 (the low 7) goes into the control byte. Probing visits
+// groups of 16 in triangular order, which covers every group of a
+// power-of-two table; a lookup stops at the first group holding an empty
+// byte. The table grows at 7/8 full.
+//
+// The Policy says what a slot holds and how to build, destroy and move it:
+//
+//   key_type, value_type, reference, const_reference, slot_type
+//   key(slot_type const*)            -> key_type const&
+//   key_of(value_type const&)        -> key_type const&
+//   element(slot_type*)              -> reference
+//   construct(mr, slot_type*, args...)
+//   destroy(mr, slot_type*)
+//   transfer(mr, dst, src)           move-construct dst from src, end src
+//   trivially_destructible           destroy() may be skipped
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../config.hpp"
+#include "../detail/bits.hpp"
+#include "../instrument/counters.hpp"
+#include "group.hpp"
+#include "hash.hpp"
+
+namespace algoritmi::detail::persist {
+struct access;
+}
+
+namespace algoritmi::detail::hash {
+
+template <class T, class = void>
+struct is_transparent : std::false_type {};
+template <class T>
+struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+// key_arg<K> is K when both the hasher and the equality are transparent and
+// key_type otherwise. It has to name K directly (not via conditional_t) so
+// that K stays deducible in `template <class K> find(key_arg<K> const&)`.
+template <bool Transparent>
+struct key_arg_impl {
+  template <class K, class Key>
+  using type = Key;
+};
+template <>
+struct key_arg_impl<true> {
+  template <class K, class Key>
+  using type = K;
+};
+
+inline std::size_t normalize_capacity(std::size_t n) noexcept {
+  return n ? ~std::size_t{0} >> countl_zero(n) : 1;
+}
+
+// Elements a table of this capacity takes before it has to grow.
+inline std::size_t capacity_to_growth(std::size_t capacity) noexcept {
+  return capacity - capacity / 8;
+}
+
+// Smallest capacity (before normalising) whose growth limit is >= n.
+inline std::size_t growth_to_lower_bound(std::size_t n) noexcept {
+  return n + (n ? (n - 1) / 7 : 0);
+}
+
+class probe_seq {
+ public:
+  probe_seq(std::size_t h1, std::size_t mask) noexcept : mask_(mask), offset_(h1 & mask) {}
+  std::size_t offset() const noexcept { return offset_; }
+  std::size_t offset(std::size_t i) const noexcept { return (offset_ + i) & mask_; }
+  void next() noexcept {
+    index_ += group_width;
+    offset_ = (offset_ + index_) & mask_;
+  }
+
+ private:
+  std::size_t mask_;
+  std::size_t offset_;
+  std::size_t index_ = 0;
+};
+
+template <class Policy, class Hash, class Eq>
+class raw_table {
+  using slot_type = typename Policy::slot_type;
+  using key_arg_select =
+      key_arg_impl<is_transparent<Hash>::value && is_transparent<Eq>::value>;
+
+ protected:
+  template <class K>
+  using key_arg = typename key_arg_select::template type<K, typename Policy::key_type>;
+
+ public:
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using reference = typename Policy::reference;
+  using const_reference = typename Policy::const_reference;
+  using hasher = Hash;
+  using key_equal = Eq;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  template <bool Const>
+  class basic_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename Policy::value_type;
+    using reference = std::conditional_t<Const, const_reference, typename Policy::reference>;
+    using pointer = std::add_pointer_t<std::remove_reference_t<reference>>;
+    using difference_type = std::ptrdiff_t;
+
+    basic_iterator() = default;
+    template <bool C = Const, class = std::enable_if_t<C>>
+    basic_iterator(basic_iterator<false> other) noexcept  // NOLINT: iterator -> const_iterator
+        : ctrl_(other.ctrl_), slot_(other.slot_) {}
+
+    reference operator*() const noexcept { return Policy::element(slot_); }
+    pointer operator->() const noexcept { return std::addressof(**this); }
+
+    basic_iterator& operator++() noexcept {
+      ++ctrl_;
+      ++slot_;
+      skip_empty_or_deleted();
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept {
+      basic_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(basic_iterator a, basic_iterator b) noexcept {
+      return a.ctrl_ == b.ctrl_;
+    }
+    friend bool operator!=(basic_iterator a, basic_iterator b) noexcept {
+      return a.ctrl_ != b.ctrl_;
+    }
+
+   private:
+    friend class raw_table;
+    template <bool>
+    friend class basic_iterator;
+
+    basic_iterator(ctrl_t* ctrl, slot_type* slot) noexcept : ctrl_(ctrl), slot_(slot) {}
+
+    // Stops at the next full slot or at the sentinel.
+    void skip_empty_or_deleted() noexcept {
+      while (is_empty_or_deleted(*ctrl_)) {
+        unsigned const n = group(ctrl_).count_leading_empty_or_deleted();
+        ctrl_ += n;
+        slot_ += n;
+      }
+    }
+
+    ctrl_t* ctrl_ = nullptr;
+    slot_type* slot_ = nullptr;
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  raw_table() noexcept(std::is_nothrow_default_constructible_v<Hash> &&
+                       std::is_nothrow_default_constructible_v<Eq>)
+      : raw_table(std::size_t{0}) {}
+
+  explicit raw_table(std::size_t bucket_count, Hash const& hash = Hash(), Eq const& eq = Eq(),
+                     std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : hash_(hash), eq_(eq), mr_(mr) {
+    if (bucket_count) resize(normalize_capacity(bucket_count));
+  }
+
+  explicit raw_table(std::pmr::memory_resource* mr) : raw_table(std::size_t{0}, Hash(), Eq(), mr) {}
+
+  template <class InputIt>
+  raw_table(InputIt first, InputIt last, std::size_t bucket_count = 0, Hash const& hash = Hash(),
+            Eq const& eq = Eq(), std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : raw_table(bucket_count, hash, eq, mr) {
+    insert(first, last);
+  }
+
+  raw_table(std::initializer_list<value_type> init, std::size_t bucket_count = 0,
+            Hash const& hash = Hash(), Eq const& eq = Eq(),
+            std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : raw_table(init.begin(), init.end(), bucket_count, hash, eq, mr) {}
+
+  // Copies into a table sized for other.size(), on the same resource. The
+  // elements are known to be distinct, so each one is hashed and placed
+  // without a lookup.
+  raw_table(raw_table const& other) : hash_(other.hash_), eq_(other.eq_), mr_(other.mr_) {
+    reserve(other.size_);
+    try {
+      for (std::size_t i = 0; i < other.capacity_; ++i) {
+        if (!is_full(other.ctrl_[i])) continue;
+        slot_type* src = other.slots_ + i;
+        std::size_t const h = hash_of(Policy::key(src));
+        std::size_t const target = find_first_non_full(h);
+        Policy::construct(mr_, slots_ + target, Policy::element(src));
+        set_ctrl(target, h2(h));
+        ++size_;
+        --growth_left_;
+      }
+    } catch (...) {
+      destroy_slots();
+      deallocate();
+      throw;
+    }
+  }
+
+  raw_table(raw_table&& other) noexcept
+      : hash_(std::move(other.hash_)),
+        eq_(std::move(other.eq_)),
+        mr_(other.mr_),
+        ctrl_(std::exchange(other.ctrl_, empty_group())),
+        slots_(std::exchange(other.slots_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        growth_left_(std::exchange(other.growth_left_, 0)) {}
+
+  raw_table& operator=(raw_table other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~raw_table() {
+    destroy_slots();
+    deallocate();
+  }
+
+  void swap(raw_table& other) noexcept {
+    using std::swap;
+    swap(hash_, other.hash_);
+    swap(eq_, other.eq_);
+    swap(mr_, other.mr_);
+    swap(ctrl_, other.ctrl_);
+    swap(slots_, other.slots_);
+    swap(size_, other.size_);
+    swap(capacity_, other.capacity_);
+    swap(growth_left_, other.growth_left_);
+  }
+  friend void swap(raw_table& a, raw_table& b) noexcept { a.swap(b); }
+
+  iterator begin() noexcept {
+    iterator it = iterator_at(0);
+    it.skip_empty_or_deleted();
+    return it;
+  }
+  iterator end() noexcept { return iterator_at(capacity_); }
+  const_iterator begin() const noexcept { return const_cast<raw_table*>(this)->begin(); }
+  const_iterator end() const noexcept { return const_cast<raw_table*>(this)->end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t size() const noexcept { return size_; }
+  std::size_t max_size() const noexcept {
+    return (std::numeric_limits<std::size_t>::max() / 2) / (sizeof(slot_type) + 1);
+  }
+  std::size_t capacity() const noexcept { return capacity_; }
+  std::size_t bucket_count() const noexcept { return capacity_; }
+  float load_factor() const noexcept {
+    return capacity_ ? static_cast<float>(size_) / static_cast<float>(capacity_) : 0.0f;
+  }
+  float max_load_factor() const noexcept { return 7.0f / 8.0f; }
+
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return eq_; }
+  std::pmr::memory_resource* resource() const noexcept { return mr_; }
+
+  // Destroys the elements and keeps the storage.
+  void clear() noexcept {
+    destroy_slots();
+    size_ = 0;
+    if (capacity_) {
+      reset_ctrl();
+      growth_left_ = capacity_to_growth(capacity_);
+    }
+  }
+
+  // Makes room for n elements in total without further growth.
+  void reserve(std::size_t n) {
+    if (n > size_ + growth_left_) resize(normalize_capacity(growth_to_lower_bound(n)));
+  }
+
+  // Sets the capacity to at least max(n, what size() needs); rehash(0) on an
+  // empty table frees the storage. Moving into the new table hashes each
+  // element once and skips the duplicate check.
+  void rehash(std::size_t n) {
+    if (n == 0 && size_ == 0) {
+      deallocate();
+      return;
+    }
+    std::size_t const cap = normalize_capacity(std::max(n, growth_to_lower_bound(size_)));
+    if (n == 0 || cap > capacity_) resize(cap);
+  }
+
+  template <class K = key_type>
+  iterator find(key_arg<K> const& key) {
+    return iterator_at(find_index(key));
+  }
+  template <class K = key_type>
+  const_iterator find(key_arg<K> const& key) const {
+    return const_cast<raw_table*>(this)->iterator_at(find_index(key));
+  }
+  template <class K = key_type>
+  bool contains(key_arg<K> const& key) const {
+    return find_index(key) != capacity_;
+  }
+  template <class K = key_type>
+  std::size_t count(key_arg<K> const& key) const {
+    return contains(key) ? 1 : 0;
+  }
+  template <class K = key_type>
+  std::pair<iterator, iterator> equal_range(key_arg<K> const& key) {
+    iterator it = find(key);
+    if (it == end()) return {it, it};
+    return {it, std::next(it)};
+  }
+
+  // Starts loading the control group and slot that a lookup of key would
+  // touch first; for batched lookups that would otherwise miss one by one.
+  template <class K = key_type>
+  void prefetch(key_arg<K> const& key) const noexcept {
+    std::size_t const offset = (hash_of(key) >> 7) & capacity_;
+    ALGORITMI_PREFETCH(ctrl_ + offset);
+    ALGORITMI_PREFETCH(slots_ + offset);
+  }
+
+  std::pair<iterator, bool> insert(value_type const& value) {
+    return emplace_key(Policy::key_of(value), value);
+  }
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return emplace_key(Policy::key_of(value), std::move(value));
+  }
+  iterator insert(const_iterator, value_type const& value) { return insert(value).first; }
+  iterator insert(const_iterator, value_type&& value) { return insert(std::move(value)).first; }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                    typename std::iterator_traits<InputIt>::iterator_category>)
+      reserve(size_ + static_cast<std::size_t>(std::distance(first, last)));
+    for (; first != last; ++first) emplace(*first);
+  }
+  void insert(std::initializer_list<value_type> init) { insert(init.begin(), init.end()); }
+
+  // Builds the element first to learn its key, then moves it into place
+  // (for node tables that move is a pointer copy).
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    slot_type tmp;
+    Policy::construct(mr_, &tmp, std::forward<Args>(args)...);
+    std::pair<std::size_t, bool> r;
+    try {
+      r = find_or_prepare_insert(Policy::key(&tmp));
+    } catch (...) {
+      Policy::destroy(mr_, &tmp);
+      throw;
+    }
+    if (r.second)
+      Policy::transfer(mr_, slots_ + r.first, &tmp);
+    else
+      Policy::destroy(mr_, &tmp);
+    return {iterator_at(r.first), r.second};
+  }
+  template <class... Args>
+  iterator emplace_hint(const_iterator, Args&&... args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  // Removes the element at pos; returns the iterator after it.
+  iterator erase(const_iterator pos) noexcept {
+    iterator it(pos.ctrl_, pos.slot_);
+    iterator next = std::next(it);
+    erase_at(static_cast<std::size_t>(it.ctrl_ - ctrl_));
+    return next;
+  }
+  iterator erase(iterator pos) noexcept { return erase(const_iterator(pos)); }
+  iterator erase(const_iterator first, const_iterator last) noexcept {
+    while (first != last) first = erase(first);
+    return iterator(last.ctrl_, last.slot_);
+  }
+  template <class K = key_type>
+  std::size_t erase(key_arg<K> const& key) {
+    std::size_t const i = find_index(key);
+    if (i == capacity_) return 0;
+    erase_at(i);
+    return 1;
+  }
+
+  friend bool operator==(raw_table const& a, raw_table const& b) {
+    if (a.size_ != b.size_) return false;
+    for (auto const& v : a) {
+      auto it = b.find(Policy::key_of(v));
+      if (it == b.end() || !(*it == v)) return false;
+    }
+    return true;
+  }
+  friend bool operator!=(raw_table const& a, raw_table const& b) { return !(a == b); }
+
+ protected:
+  template <class K>
+  std::size_t hash_of(K const& key) const {
+    return mix(hash_(key));
+  }
+  static std::uint8_t h2(std::size_t h) noexcept { return static_cast<std::uint8_t>(h & 0x7f); }
+
+  iterator iterator_at(std::size_t i) noexcept { return iterator(ctrl_ + i, slots_ + i); }
+
+  // Slot index of key, or capacity_ when absent.
+  template <class K>
+  std::size_t find_index(K const& key) const {
+    std::size_t const h = hash_of(key);
+    probe_seq seq(h >> 7, capacity_);
+    for (;;) {
+      ALGORITMI_COUNT(probes, 1);
+      group const g(ctrl_ + seq.offset());
+      for (std::uint32_t m = g.match(h2(h)); m; m &= m - 1) {
+        std::size_t const i = seq.offset(static_cast<std::size_t>(countr_zero(m)));
+        if (ALGORITMI_LIKELY(eq_(Policy::key(slots_ + i), key))) return i;
+      }
+      if (ALGORITMI_LIKELY(g.match_empty())) return capacity_;
+      seq.next();
+    }
+  }
+
+  // {slot of key, false} when present; otherwise claims a slot for it and
+  // returns {slot, true}, leaving the caller to construct the element there.
+  template <class K>
+  std::pair<std::size_t, bool> find_or_prepare_insert(K const& key) {
+    std::size_t const h = hash_of(key);
+    probe_seq seq(h >> 7, capacity_);
+    for (;;) {
+      ALGORITMI_COUNT(probes, 1);
+      group const g(ctrl_ + seq.offset());
+      for (std::uint32_t m = g.match(h2(h)); m; m &= m - 1) {
+        std::size_t const i = seq.offset(static_cast<std::size_t>(countr_zero(m)));
+        if (ALGORITMI_LIKELY(eq_(Policy::key(slots_ + i), key))) return {i, false};
+      }
+      if (ALGORITMI_LIKELY(g.match_empty())) break;
+      seq.next();
+    }
+    return {prepare_insert(h), true};
+  }
+
+  // Looks key up and, when absent, constructs the element from args.
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace_key(K const& key, Args&&... args) {
+    auto const [i, inserted] = find_or_prepare_insert(key);
+    if (inserted) {
+      try {
+        Policy::construct(mr_, slots_ + i, std::forward<Args>(args)...);
+      } catch (...) {
+        erase_meta(i);
+        throw;
+      }
+    }
+    return {iterator_at(i), inserted};
+  }
+
+ private:
+  std::size_t find_first_non_full(std::size_t h) const noexcept {
+    probe_seq seq(h >> 7, capacity_);
+    for (;;) {
+      ALGORITMI_COUNT(probes, 1);
+      std::uint32_t const m = group(ctrl_ + seq.offset()).match_empty_or_deleted();
+      if (m) return seq.offset(static_cast<std::size_t>(countr_zero(m)));
+      seq.next();
+    }
+  }
+
+  std::size_t prepare_insert(std::size_t h) {
+    std::size_t target = find_first_non_full(h);
+    // Reusing a tombstone does not use up growth; filling an empty does.
+    if (ALGORITMI_UNLIKELY(growth_left_ == 0 && !(ctrl_[target] == ctrl_deleted))) {
+      rehash_and_grow();
+      target = find_first_non_full(h);
+    }
+    growth_left_ -= ctrl_[target] == ctrl_empty;
+    set_ctrl(target, h2(h));
+    ++size_;
+    return target;
+  }
+
+  // Out of room: if tombstones hold at least a fifth of the table, rebuild
+  // at the same size to drop them; otherwise double.
+  void rehash_and_grow() {
+    if (capacity_ > group_width && size_ * 32 <= capacity_ * 25)
+      resize(capacity_);
+    else
+      resize(capacity_ * 2 + 1);
+  }
+
+  void set_ctrl(std::size_t i, ctrl_t c) noexcept {
+    ctrl_[i] = c;
+    ctrl_[((i - (group_width - 1)) & capacity_) + ((group_width - 1) & capacity_)] = c;
+  }
+  void set_ctrl(std::size_t i, std::uint8_t h) noexcept { set_ctrl(i, static_cast<ctrl_t>(h)); }
+
+  void erase_at(std::size_t i) noexcept {
+    Policy::destroy(mr_, slots_ + i);
+    erase_meta(i);
+  }
+
+  // A slot can go straight back to empty when no probe ever passed over
+  // it: that holds if the full run through it, read from the groups
+  // before and after, is shorter than a group. Otherwise it becomes a
+  // tombstone so longer probe chains stay intact.
+  void erase_meta(std::size_t i) noexcept {
+    --size_;
+    std::size_t const before = (i - group_width) & capacity_;
+    std::uint32_t const empty_after = group(ctrl_ + i).match_empty();
+    std::uint32_t const empty_before = group(ctrl_ + before).match_empty();
+    bool const was_never_full =
+        empty_before && empty_after &&
+        static_cast<std::size_t>(countr_zero(empty_after) + countl_zero(empty_before) - 48) <
+            group_width;
+    set_ctrl(i, was_never_full ? ctrl_empty : ctrl_deleted);
+    growth_left_ += was_never_full;
+  }
+
+  static std::size_t slot_offset(std::size_t capacity) noexcept {
+    std::size_t const a = alignof(slot_type);
+    return (capacity + group_width + a - 1) & ~(a - 1);
+  }
+  static std::size_t alloc_size(std::size_t capacity) noexcept {
+    return slot_offset(capacity) + capacity * sizeof(slot_type);
+  }
+  static constexpr std::size_t alloc_align =
+      alignof(slot_type) > group_width ? alignof(slot_type) : group_width;
+
+  void reset_ctrl() noexcept {
+    std::memset(ctrl_, static_cast<unsigned char>(ctrl_empty), capacity_ + group_width);
+    ctrl_[capacity_] = ctrl_sentinel;
+  }
+
+  // Moves every element into a fresh table of new_capacity.
+  void resize(std::size_t new_capacity) {
+    assert(((new_capacity + 1) & new_capacity) == 0);
+    if (new_capacity > max_size()) throw std::length_error("hash table too large");
+    ctrl_t* const old_ctrl = ctrl_;
+    slot_type* const old_slots = slots_;
+    std::size_t const old_capacity = capacity_;
+
+    auto* raw = static_cast<char*>(mr_->allocate(alloc_size(new_capacity), alloc_align));
+    ctrl_ = reinterpret_cast<ctrl_t*>(raw);
+    slots_ = reinterpret_cast<slot_type*>(raw + slot_offset(new_capacity));
+    capacity_ = new_capacity;
+    reset_ctrl();
+    growth_left_ = capacity_to_growth(capacity_) - size_;
+
+    for (std::size_t i = 0; i < old_capacity; ++i) {
+      if (!is_full(old_ctrl[i])) continue;
+      std::size_t const h = hash_of(Policy::key(old_slots + i));
+      std::size_t const target = find_first_non_full(h);
+      set_ctrl(target, h2(h));
+      Policy::transfer(mr_, slots_ + target, old_slots + i);
+    }
+    if (old_capacity)
+      mr_->deallocate(old_ctrl, alloc_size(old_capacity), alloc_align);
+  }
+
+  void destroy_slots() noexcept {
+    if constexpr (!Policy::trivially_destructible) {
+      for (std::size_t i = 0; i < capacity_; ++i)
+        if (is_full(ctrl_[i])) Policy::destroy(mr_, slots_ + i);
+    }
+  }
+
+  // Frees the storage; the elements must already be gone.
+  void deallocate() noexcept {
+    if (capacity_) mr_->deallocate(ctrl_, alloc_size(capacity_), alloc_align);
+    ctrl_ = empty_group();
+    slots_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    growth_left_ = 0;
+  }
+
+  friend struct detail::persist::access;
+
+  Hash hash_;
+  Eq eq_;
+  std::pmr::memory_resource* mr_;
+  ctrl_t* ctrl_ = empty_group();
+  slot_type* slots_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+  std::size_t growth_left_ = 0;
+};
+
+// Map operations on top of raw_table: keyed insertion that only builds the
+// mapped value when the key is new.
+template <class Policy, class Hash, class Eq>
+class raw_map : public raw_table<Policy, Hash, Eq> {
+  using base = raw_table<Policy, Hash, Eq>;
+  template <class K>
+  using key_arg = typename base::template key_arg<K>;
+
+ public:
+  using mapped_type = typename Policy::mapped_type;
+  using typename base::iterator;
+  using typename base::key_type;
+
+  using base::base;
+
+  template <class K = key_type, class... Args>
+  std::pair<iterator, bool> try_emplace(key_arg<K> const& key, Args&&... args) {
+    return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+  // The K* parameter keeps K from deducing to a reference, which would turn
+  // these rvalue overloads into forwarding references.
+  template <class K = key_type, class... Args, K* = nullptr>
+  std::pair<iterator, bool> try_emplace(key_arg<K>&& key, Args&&... args) {
+    return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class K = key_type, class M>
+  std::pair<iterator, bool> insert_or_assign(key_arg<K> const& key, M&& obj) {
+    auto r = try_emplace(key, std::forward<M>(obj));
+    if (!r.second) r.first->second = std::forward<M>(obj);
+    return r;
+  }
+  template <class K = key_type, class M, K* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(key_arg<K>&& key, M&& obj) {
+    auto r = try_emplace(std::move(key), std::forward<M>(obj));
+    if (!r.second) r.first->second = std::forward<M>(obj);
+    return r;
+  }
+
+  template <class K = key_type>
+  mapped_type& operator[](key_arg<K> const& key) {
+    return try_emplace(key).first->second;
+  }
+  template <class K = key_type, K* = nullptr>
+  mapped_type& operator[](key_arg<K>&& key) {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  template <class K = key_type>
+  mapped_type& at(key_arg<K> const& key) {
+    auto it = this->find(key);
+    if (it == this->end()) throw std::out_of_range("hash map: key not found");
+    return it->second;
+  }
+  template <class K = key_type>
+  mapped_type const& at(key_arg<K> const& key) const {
+    auto it = this->find(key);
+    if (it == this->end()) throw std::out_of_range("hash map: key not found");
+    return it->second;
+  }
+};
+
+}  // namespace algoritmi::detail::hash
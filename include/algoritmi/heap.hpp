@@ -0,0 +1,17 @@
+// Priority queues. All are min-heaps: top() is the smallest element under
+// the comparator (std::priority_queue uses the opposite convention).
+//
+//   dary_heap<T, D = 4>     implicit D-ary heap whose sibling groups sit in
+//                           one cache line; push, pop, replace_top
+//   radix_heap<Key, Value>  monotone heap for unsigned keys (keys pushed
+//                           are never below the last popped one)
+//   pairing_heap<T>         addressable heap: push returns a handle for
+//                           O(1) decrease_key, update, erase and merge
+//
+// Each takes a std::pmr::memory_resource* for its storage; pairing_heap
+// allocates one node per element and pairs well with a fixed_pool.
+#pragma once
+
+#include "heap/dary_heap.hpp"
+#include "heap/pairing_heap.hpp"
+#include "heap/radix_heap.hpp"
@@ -0,0 +1,276 @@
+// Implicit d-ary min-heap laid out for cache lines.
+//
+// Node i's children are i*D + 1 .. i*D + D. The array starts D - 1 slots
+// before a cache-line boundary, so every sibling group begins at a multiple
+// of D elements from the boundary: when D * sizeof(T) divides 64 (4 x u64,
+// 8 x u64, 8 x u32...) a group never straddles two lines, and choosing the
+// best child costs one cache miss instead of D. A 4-ary heap is also half
+// as deep as a binary one.
+//
+// pop() moves the hole left by the root down to a leaf along the best
+// children without comparing against the displaced last element, then
+// sifts that element up from there; it nearly always belongs near the
+// bottom, so this saves about one comparison per level.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../config.hpp"
+
+namespace algoritmi {
+
+// top() is the smallest element under Compare (std::less gives a min-heap,
+// the opposite of std::priority_queue's convention).
+template <class T, std::size_t D = 4, class Compare = std::less<T>>
+class dary_heap {
+  static_assert(D >= 2, "dary_heap needs at least two children per node");
+
+ public:
+  using value_type = T;
+  using value_compare = Compare;
+  static constexpr std::size_t arity = D;
+
+  explicit dary_heap(Compare comp = Compare(),
+                     std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : comp_(std::move(comp)), mr_(mr) {}
+
+  explicit dary_heap(std::pmr::memory_resource* mr) : dary_heap(Compare(), mr) {}
+
+  // Builds a heap from [first, last) in O(n).
+  template <class InputIt>
+  dary_heap(InputIt first, InputIt last, Compare comp = Compare(),
+            std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : dary_heap(std::move(comp), mr) {
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                    typename std::iterator_traits<InputIt>::iterator_category>)
+      reserve(static_cast<std::size_t>(std::distance(first, last)));
+    for (; first != last; ++first) {
+      if (size_ == capacity_) grow(size_ + 1);
+      ::new (static_cast<void*>(data_ + size_)) T(*first);
+      ++size_;
+    }
+    if (size_ > 1)
+      for (std::size_t i = (size_ - 2) / D + 1; i-- > 0;) {
+        T x = std::move(data_[i]);
+        sift_down(i, std::move(x));
+      }
+  }
+
+  // Delegates so that the destructor frees the buffer if a copy throws;
+  // uninitialized_copy_n has already destroyed the copied prefix.
+  dary_heap(dary_heap const& other) : dary_heap(other.comp_, other.mr_) {
+    reserve(other.size_);
+    std::uninitialized_copy_n(other.data_, other.size_, data_);
+    size_ = other.size_;
+  }
+
+  dary_heap(dary_heap&& other) noexcept
+      : comp_(std::move(other.comp_)),
+        mr_(other.mr_),
+        data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)) {}
+
+  dary_heap& operator=(dary_heap other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~dary_heap() {
+    clear();
+    deallocate();
+  }
+
+  void swap(dary_heap& other) noexcept {
+    using std::swap;
+    swap(comp_, other.comp_);
+    swap(mr_, other.mr_);
+    swap(data_, other.data_);
+    swap(size_, other.size_);
+    swap(capacity_, other.capacity_);
+  }
+
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t size() const noexcept { return size_; }
+  std::size_t capacity() const noexcept { return capacity_; }
+  std::pmr::memory_resource* resource() const noexcept { return mr_; }
+
+  // Smallest element. Requires !empty().
+  T const& top() const noexcept {
+    assert(size_ > 0);
+    return data_[0];
+  }
+
+  void push(T const& value) { emplace(value); }
+  void push(T&& value) { emplace(std::move(value)); }
+
+  template <class... Args>
+  void emplace(Args&&... args) {
+    if (size_ == capacity_) grow(size_ + 1);
+    ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+    std::size_t const hole = size_++;
+    T x = std::move(data_[hole]);
+    sift_up(hole, std::move(x));
+  }
+
+  // Removes and returns the smallest element. Requires !empty().
+  T pop() {
+    assert(size_ > 0);
+    T result = std::move(data_[0]);
+    std::size_t const last = --size_;
+    if (last > 0) {
+      T x = std::move(data_[last]);
+      data_[last].~T();
+      sift_to_leaf(std::move(x));
+    } else {
+      data_[0].~T();
+    }
+    return result;
+  }
+
+  // pop() followed by push(value), in a single pass. Requires !empty().
+  T replace_top(T value) {
+    assert(size_ > 0);
+    T result = std::move(data_[0]);
+    sift_down(0, std::move(value));
+    return result;
+  }
+
+  void reserve(std::size_t n) {
+    if (n > capacity_) grow(n);
+  }
+
+  // Keeps the storage.
+  void clear() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) std::destroy_n(data_, size_);
+    size_ = 0;
+  }
+
+ private:
+  static constexpr std::size_t pad = D - 1;
+  static constexpr std::size_t align =
+      alignof(T) > cache_line_size ? alignof(T) : std::size_t{cache_line_size};
+
+  static std::size_t first_child(std::size_t i) noexcept { return i * D + 1; }
+
+  // Index of the best of the N elements starting at c. A tournament rather
+  // than a linear scan keeps the dependency chain at log2(N), and the
+  // arithmetic select keeps it free of branches: on random keys which child
+  // wins is a coin flip, and mispredictions cost more than the misses.
+  template <std::size_t N>
+  ALGORITMI_ALWAYS_INLINE std::size_t best_of(std::size_t c) const {
+    if constexpr (N == 1) {
+      return c;
+    } else {
+      std::size_t const a = best_of<N / 2>(c);
+      std::size_t const b = best_of<N - N / 2>(c + N / 2);
+      return a + (b - a) * static_cast<std::size_t>(comp_(data_[b], data_[a]));
+    }
+  }
+
+  // Best child in a partial group [c, c + count), count < D.
+  std::size_t best_child(std::size_t c, std::size_t count) const {
+    std::size_t best = c;
+    for (std::size_t k = 1; k < count; ++k)
+      if (comp_(data_[c + k], data_[best])) best = c + k;
+    return best;
+  }
+
+  // The D * D grandchildren of a node are contiguous, so fetching them one
+  // level early takes a couple of line fills and hides the latency that the
+  // branchless child selection would otherwise serialise on. May point past
+  // the end; prefetches never fault.
+  ALGORITMI_ALWAYS_INLINE void prefetch_grandchildren(std::size_t i) const noexcept {
+    char const* p = reinterpret_cast<char const*>(data_ + first_child(first_child(i)));
+    for (std::size_t b = 0; b < D * D * sizeof(T); b += cache_line_size) ALGORITMI_PREFETCH(p + b);
+  }
+
+  void sift_up(std::size_t hole, T x) {
+    while (hole > 0) {
+      std::size_t const parent = (hole - 1) / D;
+      if (!comp_(x, data_[parent])) break;
+      data_[hole] = std::move(data_[parent]);
+      hole = parent;
+    }
+    data_[hole] = std::move(x);
+  }
+
+  // Top-down sift with an early exit; used by replace_top and heapify.
+  void sift_down(std::size_t hole, T x) {
+    for (;;) {
+      std::size_t const c = first_child(hole);
+      if (c >= size_) break;
+      std::size_t const best = size_ - c >= D ? best_of<D>(c) : best_child(c, size_ - c);
+      if (!comp_(data_[best], x)) break;
+      data_[hole] = std::move(data_[best]);
+      hole = best;
+    }
+    data_[hole] = std::move(x);
+  }
+
+  // Bottom-up sift from the root for pop().
+  void sift_to_leaf(T x) {
+    std::size_t hole = 0;
+    // Full groups: the trip count is the constant D.
+    while (first_child(hole) + D <= size_) {
+      prefetch_grandchildren(hole);
+      std::size_t const best = best_of<D>(first_child(hole));
+      data_[hole] = std::move(data_[best]);
+      hole = best;
+    }
+    std::size_t const c = first_child(hole);
+    if (c < size_) {
+      std::size_t const best = best_child(c, size_ - c);
+      data_[hole] = std::move(data_[best]);
+      hole = best;
+    }
+    sift_up(hole, std::move(x));
+  }
+
+  void grow(std::size_t min_capacity) {
+    std::size_t cap = capacity_ ? capacity_ * 2 : std::max<std::size_t>(16, D * 4);
+    if (cap < min_capacity) cap = min_capacity;
+    if (cap > (std::numeric_limits<std::size_t>::max() / sizeof(T)) - pad)
+      throw std::bad_array_new_length();
+    auto* raw = static_cast<T*>(mr_->allocate((cap + pad) * sizeof(T), align));
+    T* fresh = raw + pad;
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      std::uninitialized_move_n(data_, size_, fresh);
+    } else {
+      try {
+        std::uninitialized_copy_n(data_, size_, fresh);
+      } catch (...) {
+        mr_->deallocate(raw, (cap + pad) * sizeof(T), align);
+        throw;
+      }
+    }
+    if constexpr (!std::is_trivially_destructible_v<T>) std::destroy_n(data_, size_);
+    deallocate();
+    data_ = fresh;
+    capacity_ = cap;
+  }
+
+  void deallocate() noexcept {
+    if (data_) mr_->deallocate(data_ - pad, (capacity_ + pad) * sizeof(T), align);
+    data_ = nullptr;
+    capacity_ = 0;
+  }
+
+  Compare comp_;
+  std::pmr::memory_resource* mr_;
+  T* data_ = nullptr;  // cache-line aligned storage starts pad slots earlier
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+};
+
+}  // namespace algoritmi
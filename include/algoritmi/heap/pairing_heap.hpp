@@ -0,0 +1,264 @@
+// Addressable pairing heap (Fredman, Sedgewick, Sleator, Tarjan 1986).
+//
+// push() returns a handle that stays valid until the element is popped or
+// erased. push, top, merge and decrease_key are O(1) (decrease_key
+// amortised, conjectured o(log n)); pop is O(log n) amortised, using the
+// standard two-pass pairing: merge children in pairs left to right, then
+// fold the pairs right to left.
+//
+// Nodes are allocated one at a time from the memory resource; a fixed_pool
+// sized for node_size makes push/pop allocation-free once warm.
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace algoritmi {
+
+// top() is the smallest element under Compare.
+template <class T, class Compare = std::less<T>>
+class pairing_heap {
+  struct node {
+    template <class... Args>
+    explicit node(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T value;
+    node* child = nullptr;
+    node* next = nullptr;  // next sibling
+    node* prev = nullptr;  // previous sibling, or the parent for a first child
+  };
+
+ public:
+  using value_type = T;
+  using value_compare = Compare;
+
+  // Bytes per element, for sizing a fixed_pool.
+  static constexpr std::size_t node_size = sizeof(node);
+  static constexpr std::size_t node_align = alignof(node);
+
+  class handle {
+   public:
+    handle() = default;
+    T const& value() const noexcept { return n_->value; }
+    explicit operator bool() const noexcept { return n_ != nullptr; }
+    bool operator==(handle other) const noexcept { return n_ == other.n_; }
+    bool operator!=(handle other) const noexcept { return n_ != other.n_; }
+
+   private:
+    friend class pairing_heap;
+    explicit handle(node* n) : n_(n) {}
+    node* n_ = nullptr;
+  };
+
+  explicit pairing_heap(Compare comp = Compare(),
+                        std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : comp_(std::move(comp)), alloc_(mr) {}
+
+  explicit pairing_heap(std::pmr::memory_resource* mr) : pairing_heap(Compare(), mr) {}
+
+  pairing_heap(pairing_heap const&) = delete;
+  pairing_heap& operator=(pairing_heap const&) = delete;
+
+  pairing_heap(pairing_heap&& other) noexcept
+      : comp_(std::move(other.comp_)),
+        alloc_(other.alloc_),
+        root_(std::exchange(other.root_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  ~pairing_heap() { clear(); }
+
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t size() const noexcept { return size_; }
+  std::pmr::memory_resource* resource() const noexcept { return alloc_.resource(); }
+
+  // Smallest element. Requires !empty().
+  T const& top() const noexcept {
+    assert(root_);
+    return root_->value;
+  }
+  handle top_handle() const noexcept { return handle(root_); }
+
+  handle push(T const& value) { return emplace(value); }
+  handle push(T&& value) { return emplace(std::move(value)); }
+
+  template <class... Args>
+  handle emplace(Args&&... args) {
+    node* n = alloc_.allocate(1);
+    try {
+      ::new (static_cast<void*>(n)) node(std::forward<Args>(args)...);
+    } catch (...) {
+      alloc_.deallocate(n, 1);
+      throw;
+    }
+    root_ = root_ ? link(root_, n) : n;
+    ++size_;
+    return handle(n);
+  }
+
+  // Removes and returns the smallest element. Requires !empty().
+  T pop() {
+    assert(root_);
+    node* old = root_;
+    root_ = combine_children(old);
+    --size_;
+    T result = std::move(old->value);
+    destroy(old);
+    return result;
+  }
+
+  // Replaces h's value with one that is not greater (!comp(old, value)).
+  void decrease_key(handle h, T value) {
+    node* n = h.n_;
+    assert(!comp_(n->value, value));
+    n->value = std::move(value);
+    if (n == root_) return;
+    cut(n);
+    root_ = link(root_, n);
+  }
+
+  // Replaces h's value with any value.
+  void update(handle h, T value) {
+    node* n = h.n_;
+    if (!comp_(n->value, value)) {
+      decrease_key(h, std::move(value));
+      return;
+    }
+    // Increase: detach the subtree, re-merge the node's children, and link
+    // the node back in as a singleton.
+    n->value = std::move(value);
+    if (n == root_) {
+      node* rest = combine_children(n);
+      n->child = nullptr;
+      root_ = rest ? link(rest, n) : n;
+      return;
+    }
+    cut(n);
+    node* rest = combine_children(n);
+    n->child = nullptr;
+    root_ = link(root_, n);
+    if (rest) root_ = link(root_, rest);
+  }
+
+  // Removes the element behind h.
+  void erase(handle h) {
+    node* n = h.n_;
+    if (n == root_) {
+      pop();
+      return;
+    }
+    cut(n);
+    node* rest = combine_children(n);
+    if (rest) root_ = link(root_, rest);
+    --size_;
+    destroy(n);
+  }
+
+  // Moves every element of `other` into this heap in O(1). Handles into
+  // `other` stay valid and now refer to this heap. Both heaps must use the
+  // same memory resource.
+  void merge(pairing_heap& other) {
+    if (this == &other || !other.root_) return;
+    if (resource() != other.resource() && !resource()->is_equal(*other.resource()))
+      throw std::invalid_argument("pairing_heap::merge: different memory resources");
+    root_ = root_ ? link(root_, other.root_) : other.root_;
+    size_ += other.size_;
+    other.root_ = nullptr;
+    other.size_ = 0;
+  }
+
+  void clear() noexcept {
+    // Iterative teardown: splice each node's children into the sibling
+    // chain instead of recursing.
+    node* list = root_;
+    while (list) {
+      node* n = list;
+      if (n->child) {
+        node* last = n->child;
+        while (last->next) last = last->next;
+        last->next = n->next;
+        list = n->child;
+      } else {
+        list = n->next;
+      }
+      destroy(n);
+    }
+    root_ = nullptr;
+    size_ = 0;
+  }
+
+ private:
+  // Makes the larger root the first child of the smaller; returns the new
+  // root. Both arguments must be roots (no siblings, no parent).
+  node* link(node* a, node* b) noexcept {
+    if (comp_(b->value, a->value)) std::swap(a, b);
+    b->prev = a;
+    b->next = a->child;
+    if (a->child) a->child->prev = b;
+    a->child = b;
+    return a;
+  }
+
+  // Detaches n (and its subtree) from its parent or sibling list.
+  void cut(node* n) noexcept {
+    if (n->prev->child == n)
+      n->prev->child = n->next;
+    else
+      n->prev->next = n->next;
+    if (n->next) n->next->prev = n->prev;
+    n->next = nullptr;
+    n->prev = nullptr;
+  }
+
+  // Two-pass pairing of n's children; returns the merged root or nullptr.
+  node* combine_children(node* n) noexcept {
+    node* first = n->child;
+    if (!first) return nullptr;
+    // Pass 1: link pairs left to right, chaining the results through `prev`
+    // so pass 2 can walk them back.
+    node* pairs = nullptr;
+    while (first) {
+      node* a = first;
+      node* b = a->next;
+      if (!b) {
+        a->next = nullptr;
+        a->prev = pairs;
+        pairs = a;
+        break;
+      }
+      first = b->next;
+      a->next = b->next = nullptr;
+      a->prev = b->prev = nullptr;
+      node* m = link(a, b);
+      m->prev = pairs;
+      pairs = m;
+    }
+    // Pass 2: fold right to left.
+    node* root = pairs;
+    pairs = pairs->prev;
+    root->prev = nullptr;
+    while (pairs) {
+      node* next = pairs->prev;
+      pairs->prev = nullptr;
+      root = link(pairs, root);
+      pairs = next;
+    }
+    return root;
+  }
+
+  void destroy(node* n) noexcept {
+    n->~node();
+    alloc_.deallocate(n, 1);
+  }
+
+  Compare comp_;
+  std::pmr::polymorphic_allocator<node> alloc_;
+  node* root_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace algoritmi
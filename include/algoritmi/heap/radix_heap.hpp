@@ -0,0 +1,99 @@
+// Monotone radix heap for unsigned integer keys.
+//
+// Valid when keys are never smaller than the last extracted minimum, which
+// holds for Dijkstra-style searches. Bucket i holds keys whose highest bit
+// differing from the last minimum is bit i-1, so each element moves to a
+// lower bucket at most sizeof(Key) * 8 times over its lifetime: pushes are
+// O(1) and pops amortised O(log C) for key range C, with no comparisons
+// between elements.
+//
+// Bucket storage comes from the memory resource passed to the constructor;
+// clear() keeps it, so a heap reused across searches stops allocating.
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../detail/bits.hpp"
+
+namespace algoritmi {
+
+template <class Key, class Value>
+class radix_heap {
+  static_assert(std::is_unsigned_v<Key> && sizeof(Key) <= 8, "radix_heap keys must be unsigned");
+  static constexpr std::size_t bits = sizeof(Key) * 8;
+
+ public:
+  using key_type = Key;
+  using value_type = std::pair<Key, Value>;
+
+  explicit radix_heap(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : buckets_(bits + 1, mr) {}
+
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t size() const noexcept { return size_; }
+
+  // Smallest key extracted so far (0 before the first pop).
+  Key last_min() const noexcept { return last_; }
+
+  // Requires key >= last_min().
+  void push(Key key, Value value) {
+    assert(key >= last_);
+    buckets_[bucket_of(key)].emplace_back(key, std::move(value));
+    ++size_;
+  }
+
+  // Smallest element. Requires !empty(). Not const: may redistribute a bucket.
+  value_type const& top() {
+    refill();
+    return buckets_[0].back();
+  }
+
+  value_type pop() {
+    refill();
+    value_type v = std::move(buckets_[0].back());
+    buckets_[0].pop_back();
+    --size_;
+    return v;
+  }
+
+  void clear() noexcept {
+    for (auto& b : buckets_) b.clear();
+    size_ = 0;
+    last_ = 0;
+  }
+
+ private:
+
+  std::size_t bucket_of(Key key) const noexcept {
+    return static_cast<std::size_t>(detail::bit_width(static_cast<std::uint64_t>(key ^ last_)));
+  }
+
+  // Makes bucket 0 non-empty by moving the first non-empty bucket's contents
+  // down relative to its minimum.
+  void refill() {
+    assert(size_ > 0);
+    if (!buckets_[0].empty()) return;
+    std::size_t i = 1;
+    while (buckets_[i].empty()) ++i;
+    Key new_last = std::numeric_limits<Key>::max();
+    for (auto const& e : buckets_[i])
+      if (e.first < new_last) new_last = e.first;
+    last_ = new_last;
+    for (auto& e : buckets_[i]) buckets_[bucket_of(e.first)].push_back(std::move(e));
+    buckets_[i].clear();
+  }
+
+  // Inner vectors inherit the outer allocator's resource.
+  std::pmr::vector<std::pmr::vector<value_type>> buckets_;
+  std::size_t size_ = 0;
+  Key last_ = 0;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,46 @@
+// Opt-in instrumentation, compiled out unless ALGORITMI_INSTRUMENT is 1
+// (CMake: -DALGORITMI_INSTRUMENT=ON).
+//
+//   read_counters()              algorithm events summed over all threads:
+//                                counter::comparisons, swaps, probes,
+//                                relaxations
+//   perf_counters hw             cycles, instructions, cache and branch
+//                                misses of this thread (Linux perf events)
+//   hw.start(); ...; hw.stop()   counts for the code in between
+//   profile(hw, fn)              both, for one call of fn()
+//
+// Instrumented builds pay a thread-local add per event in the hot loops,
+// so their timings are not comparable with uninstrumented ones. The counts
+// say where time goes: a sort that got slower while comparisons stayed put
+// is missing cache, not doing more work.
+//
+//   algoritmi::perf_counters hw;
+//   auto const p = algoritmi::profile(hw, [&] { algoritmi::sort(v.begin(), v.end(), by_name); });
+//   p.events[algoritmi::counter::comparisons];     // comparator calls
+//   p.hardware[algoritmi::hw_event::cache_misses]  // if p.hardware.has(...)
+#pragma once
+
+#include <utility>
+
+#include "instrument/counters.hpp"
+#include "instrument/perf_counters.hpp"
+
+namespace algoritmi {
+
+struct call_profile {
+  perf_sample hardware;
+  counter_snapshot events;
+};
+
+template <class Fn>
+call_profile profile(perf_counters& hw, Fn&& fn) {
+  call_profile p;
+  counter_snapshot const before = read_counters();
+  hw.start();
+  std::forward<Fn>(fn)();
+  p.hardware = hw.stop();
+  p.events = read_counters() - before;
+  return p;
+}
+
+}  // namespace algoritmi
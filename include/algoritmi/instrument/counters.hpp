@@ -0,0 +1,145 @@
+// Algorithm event counters: comparisons, swaps, probes, relaxations.
+//
+// Hot paths bump a counter with ALGORITMI_COUNT(name, n). With
+// ALGORITMI_INSTRUMENT off (the default) the macro expands to nothing and
+// its argument is not evaluated. With it on, each thread adds to its own
+// block of counters, so counting costs a thread-local add and no shared
+// cache line; read_counters() sums the blocks of all live threads and of
+// the threads that have exited.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "../config.hpp"
+
+namespace algoritmi {
+
+enum class counter : unsigned char {
+  comparisons,  // calls of the comparator in comparison sorts
+  swaps,        // elements exchanged while partitioning
+  probes,       // control groups inspected by hash table lookups and inserts
+  relaxations,  // edges relaxed by shortest-path searches
+};
+
+inline constexpr std::size_t counter_count = 4;
+
+inline char const* to_string(counter c) noexcept {
+  switch (c) {
+    case counter::comparisons:
+      return "comparisons";
+    case counter::swaps:
+      return "swaps";
+    case counter::probes:
+      return "probes";
+    default:
+      return "relaxations";
+  }
+}
+
+// Whether this build counts anything at all.
+inline constexpr bool instrumentation_enabled = ALGORITMI_INSTRUMENT != 0;
+
+// Counter totals at one point in time; subtract two to get the events in
+// between.
+struct counter_snapshot {
+  std::array<std::uint64_t, counter_count> values{};
+
+  std::uint64_t operator[](counter c) const noexcept {
+    return values[static_cast<std::size_t>(c)];
+  }
+
+  friend counter_snapshot operator-(counter_snapshot a, counter_snapshot const& b) noexcept {
+    for (std::size_t i = 0; i < counter_count; ++i) a.values[i] -= b.values[i];
+    return a;
+  }
+};
+
+namespace detail::instrument {
+
+// One per thread. Only the owning thread writes; readers on other threads
+// load the counts, hence atomics with relaxed plain-store updates.
+struct thread_block {
+  std::array<std::atomic<std::uint64_t>, counter_count> counts{};
+  thread_block* prev = nullptr;
+  thread_block* next = nullptr;
+};
+
+struct registry {
+  std::mutex mutex;
+  thread_block* head = nullptr;
+  std::array<std::uint64_t, counter_count> retired{};  // from exited threads
+};
+
+// Never destroyed: thread blocks may outlive static destruction.
+inline registry& global_registry() {
+  static registry* r = new registry;
+  return *r;
+}
+
+class thread_slot {
+ public:
+  thread_slot() {
+    registry& r = global_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    block_.next = r.head;
+    if (r.head) r.head->prev = &block_;
+    r.head = &block_;
+  }
+
+  ~thread_slot() {
+    registry& r = global_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (std::size_t i = 0; i < counter_count; ++i)
+      r.retired[i] += block_.counts[i].load(std::memory_order_relaxed);
+    (block_.prev ? block_.prev->next : r.head) = block_.next;
+    if (block_.next) block_.next->prev = block_.prev;
+  }
+
+  thread_slot(thread_slot const&) = delete;
+  thread_slot& operator=(thread_slot const&) = delete;
+
+  thread_block& block() noexcept { return block_; }
+
+ private:
+  thread_block block_;
+};
+
+inline thread_block& local_block() {
+  thread_local thread_slot slot;
+  return slot.block();
+}
+
+inline void add(counter c, std::uint64_t n) {
+  auto& count = local_block().counts[static_cast<std::size_t>(c)];
+  count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+}  // namespace detail::instrument
+
+// Totals over every thread since the program started; all zero when
+// instrumentation is compiled out.
+inline counter_snapshot read_counters() {
+  counter_snapshot s;
+  if constexpr (instrumentation_enabled) {
+    auto& r = detail::instrument::global_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    s.values = r.retired;
+    for (auto* b = r.head; b; b = b->next)
+      for (std::size_t i = 0; i < counter_count; ++i)
+        s.values[i] += b->counts[i].load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+}  // namespace algoritmi
+
+#if ALGORITMI_INSTRUMENT
+#define ALGORITMI_COUNT(name, n) \
+  ::algoritmi::detail::instrument::add(::algoritmi::counter::name, static_cast<std::uint64_t>(n))
+#else
+#define ALGORITMI_COUNT(name, n) ((void)0)
+#endif
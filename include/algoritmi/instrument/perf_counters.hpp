@@ -0,0 +1,145 @@
+// Hardware performance counters of the calling thread (Linux
+// perf_event_open): cycles, instructions, cache misses, branch mispredicts.
+//
+// The events are opened as one group, so they are started, stopped and
+// read together and describe exactly the same stretch of execution. Only
+// user-space events of the opening thread are counted: threads a parallel
+// call runs on are not included. Hosts may refuse some or all events
+// (kernel.perf_event_paranoid, virtual machines without a PMU); those read
+// as missing rather than failing. Without ALGORITMI_INSTRUMENT, or off
+// Linux, nothing is opened and every event is missing.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "../config.hpp"
+
+#if ALGORITMI_INSTRUMENT && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ALGORITMI_PERF_EVENTS 1
+#else
+#define ALGORITMI_PERF_EVENTS 0
+#endif
+
+namespace algoritmi {
+
+enum class hw_event : unsigned char { cycles, instructions, cache_misses, branch_misses };
+
+inline constexpr std::size_t hw_event_count = 4;
+
+inline char const* to_string(hw_event e) noexcept {
+  switch (e) {
+    case hw_event::cycles:
+      return "cycles";
+    case hw_event::instructions:
+      return "instructions";
+    case hw_event::cache_misses:
+      return "cache_misses";
+    default:
+      return "branch_misses";
+  }
+}
+
+// Counts for one start()/stop() interval.
+struct perf_sample {
+  std::array<std::uint64_t, hw_event_count> values{};
+  std::array<bool, hw_event_count> valid{};
+
+  bool has(hw_event e) const noexcept { return valid[static_cast<std::size_t>(e)]; }
+  std::uint64_t operator[](hw_event e) const noexcept {
+    return values[static_cast<std::size_t>(e)];
+  }
+};
+
+class perf_counters {
+ public:
+  perf_counters() noexcept {
+#if ALGORITMI_PERF_EVENTS
+    static constexpr std::uint64_t configs[hw_event_count] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    for (std::size_t i = 0; i < hw_event_count; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof attr;
+      attr.config = configs[i];
+      attr.disabled = leader_ < 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+      // The first event that opens leads the group.
+      long const fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, PERF_FLAG_FD_CLOEXEC);
+      if (fd < 0) continue;
+      fds_[i] = static_cast<int>(fd);
+      if (leader_ < 0) leader_ = fds_[i];
+      if (::ioctl(fds_[i], PERF_EVENT_IOC_ID, &ids_[i]) != 0) {
+        close_all();
+        return;
+      }
+    }
+#endif
+  }
+
+  ~perf_counters() { close_all(); }
+
+  perf_counters(perf_counters const&) = delete;
+  perf_counters& operator=(perf_counters const&) = delete;
+
+  // Whether at least one event could be opened.
+  bool available() const noexcept { return leader_ >= 0; }
+
+  bool available(hw_event e) const noexcept { return fds_[static_cast<std::size_t>(e)] >= 0; }
+
+  // Zeroes and enables the group.
+  void start() noexcept {
+#if ALGORITMI_PERF_EVENTS
+    if (leader_ < 0) return;
+    ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  // Disables the group and returns the counts since start().
+  perf_sample stop() noexcept {
+    perf_sample s;
+#if ALGORITMI_PERF_EVENTS
+    if (leader_ < 0) return s;
+    ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // {nr, {value, id} * nr}
+    std::uint64_t buf[1 + 2 * hw_event_count] = {};
+    if (::read(leader_, buf, sizeof buf) <= 0) return s;
+    std::size_t const nr = buf[0] < hw_event_count ? static_cast<std::size_t>(buf[0])
+                                                   : hw_event_count;
+    for (std::size_t k = 0; k < nr; ++k)
+      for (std::size_t i = 0; i < hw_event_count; ++i)
+        if (fds_[i] >= 0 && ids_[i] == buf[2 + 2 * k]) {
+          s.values[i] = buf[1 + 2 * k];
+          s.valid[i] = true;
+        }
+#endif
+    return s;
+  }
+
+ private:
+  void close_all() noexcept {
+#if ALGORITMI_PERF_EVENTS
+    for (int& fd : fds_)
+      if (fd >= 0) ::close(fd);
+#endif
+    fds_.fill(-1);
+    leader_ = -1;
+  }
+
+  std::array<int, hw_event_count> fds_{-1, -1, -1, -1};
+  std::array<std::uint64_t, hw_event_count> ids_{};
+  int leader_ = -1;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,21 @@
+// Dense matrix kernels over row-major float and double matrices.
+//
+//   matrix<T>, matrix_view<T>      owning matrix, strided view of a block
+//   gemm(alpha, a, b, beta, c)     c = alpha * a * b + beta * c, packed and
+//                                  cache-blocked around a register-tiled
+//                                  micro-kernel
+//   multiply(a, b)                 a * b, Strassen above strassen_cutoff
+//   strassen_multiply(a, b, cut)   Strassen with an explicit cutoff
+//   transpose(a[, b])              cache-oblivious out-of-place transpose
+//
+// The gemm micro-kernels use AVX2 with FMA when the host has both, picked
+// at runtime like the search kernels (see cpu.hpp); an overload taking an
+// `isa` runs a specific one. gemm, the multiplies and transpose have `par`
+// overloads that split the work among the threads of the shared scheduler.
+#pragma once
+
+#include "linalg/gemm.hpp"
+#include "linalg/kernels.hpp"
+#include "linalg/matrix.hpp"
+#include "linalg/strassen.hpp"
+#include "linalg/transpose.hpp"
@@ -0,0 +1,209 @@
+// General matrix multiply, C = alpha * A * B + beta * C, in the layered
+// blocking of Goto and van de Geijn ("Anatomy of high-performance matrix
+// multiplication", 2008) as refined by BLIS.
+//
+// The loop over k is cut into kc-deep panels and the loop over columns
+// into nc-wide ones. Each kc x nc block of B is packed once into
+// nr-column slivers; each mc x kc block of A into mr-row slivers; then the
+// micro-kernel (kernels.hpp) sweeps the mr x nr tiles of the C block with
+// both operands streaming contiguously from cache. Packing costs O(mk + kn)
+// per panel against the O(mnk) multiply-adds and removes the strides, TLB
+// misses and cache-set conflicts of the naive loops; tiles at the ragged
+// edges are computed in a buffer and added in. The parallel overload splits
+// the mc-row blocks of C among threads after packing B cooperatively, so
+// every thread reads the same packed B from the shared cache.
+//
+// beta == 0 overwrites C without reading it (NaNs there do not survive),
+// and alpha == 0 only scales C, as in BLAS.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../cpu.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "kernels.hpp"
+#include "matrix.hpp"
+
+namespace algoritmi {
+namespace detail::linalg {
+
+// Keeps views out of template argument deduction, so a matrix converts to
+// one: gemm(1.0, a, b, 0.0, c) on matrix<double>s.
+template <class T>
+struct type_identity {
+  using type = T;
+};
+template <class T>
+using identity_t = typename type_identity<T>::type;
+
+template <class T>
+inline constexpr bool gemm_type_v = std::is_same_v<T, double> || std::is_same_v<T, float>;
+
+// Below this many multiply-adds a parallel call runs on the calling thread.
+inline constexpr std::size_t parallel_threshold = std::size_t{1} << 21;
+
+inline std::size_t round_up(std::size_t x, std::size_t to) noexcept {
+  return (x + to - 1) / to * to;
+}
+
+// a as mr-row slivers, each kc x mr in k-major order, the last one padded
+// with zero rows.
+template <class T>
+void pack_a(matrix_view<T const> a, T* out) noexcept {
+  constexpr std::size_t mr = blocking<T>::mr;
+  std::size_t const kc = a.cols();
+  for (std::size_t i0 = 0; i0 < a.rows(); i0 += mr, out += mr * kc) {
+    std::size_t const h = std::min(mr, a.rows() - i0);
+    for (std::size_t i = 0; i < h; ++i) {
+      T const* src = a.row(i0 + i);
+      for (std::size_t p = 0; p < kc; ++p) out[p * mr + i] = src[p];
+    }
+    for (std::size_t i = h; i < mr; ++i)
+      for (std::size_t p = 0; p < kc; ++p) out[p * mr + i] = T{};
+  }
+}
+
+// b as nr-column slivers, each kc x nr in k-major order, the last one
+// padded with zero columns.
+template <class T>
+void pack_b(matrix_view<T const> b, T* out) noexcept {
+  constexpr std::size_t nr = blocking<T>::nr;
+  std::size_t const kc = b.rows();
+  for (std::size_t j0 = 0; j0 < b.cols(); j0 += nr) {
+    std::size_t const w = std::min(nr, b.cols() - j0);
+    for (std::size_t p = 0; p < kc; ++p, out += nr) {
+      T const* src = b.row(p) + j0;
+      std::copy(src, src + w, out);
+      std::fill(out + w, out + nr, T{});
+    }
+  }
+}
+
+template <class T>
+void scale(matrix_view<T> c, T beta) noexcept {
+  if (beta == T{1}) return;
+  for (std::size_t i = 0; i < c.rows(); ++i) {
+    T* row = c.row(i);
+    if (beta == T{})
+      std::fill(row, row + c.cols(), T{});
+    else
+      for (std::size_t j = 0; j < c.cols(); ++j) row[j] *= beta;
+  }
+}
+
+// c += alpha * a * b for a packed mc x kc block of A and kc x nc of B.
+template <class T>
+void macro_kernel(micro_kernel<T> micro, std::size_t kc, T const* a, T const* b, matrix_view<T> c,
+                  T alpha) noexcept {
+  constexpr std::size_t mr = blocking<T>::mr, nr = blocking<T>::nr;
+  for (std::size_t jr = 0; jr < c.cols(); jr += nr) {
+    std::size_t const w = std::min(nr, c.cols() - jr);
+    for (std::size_t ir = 0; ir < c.rows(); ir += mr) {
+      std::size_t const h = std::min(mr, c.rows() - ir);
+      T const* as = a + ir * kc;
+      T const* bs = b + jr * kc;
+      if (h == mr && w == nr) {
+        micro(kc, as, bs, &c(ir, jr), c.stride(), alpha);
+        continue;
+      }
+      alignas(cache_line_size) T tile[mr * nr] = {};
+      micro(kc, as, bs, tile, nr, alpha);
+      for (std::size_t i = 0; i < h; ++i)
+        for (std::size_t j = 0; j < w; ++j) c(ir + i, jr + j) += tile[i * nr + j];
+    }
+  }
+}
+
+template <class T>
+void gemm(micro_kernel<T> micro, T alpha, matrix_view<T const> a, matrix_view<T const> b, T beta,
+          matrix_view<T> c, unsigned threads, std::pmr::memory_resource* mr) {
+  using blk = blocking<T>;
+  std::size_t const m = c.rows(), n = c.cols(), k = a.cols();
+  if (m == 0 || n == 0) return;
+  if (k == 0 || alpha == T{}) {
+    scale(c, beta);
+    return;
+  }
+  std::size_t const row_blocks = (m + blk::mc - 1) / blk::mc;
+  if (m * n * k < parallel_threshold) threads = 1;
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, row_blocks));
+  std::pmr::memory_resource* const task_mr = task_resource(threads, mr);
+
+  std::size_t const ncb = std::min(blk::nc, round_up(n, blk::nr));
+  scratch_buffer<T> packed_b(std::min(blk::kc, k) * ncb, mr, cache_line_size);
+  for (std::size_t jc = 0; jc < n; jc += blk::nc) {
+    std::size_t const nb = std::min(blk::nc, n - jc);
+    for (std::size_t pc = 0; pc < k; pc += blk::kc) {
+      std::size_t const kb = std::min(blk::kc, k - pc);
+      // Whole slivers per thread.
+      std::size_t const slivers = (nb + blk::nr - 1) / blk::nr;
+      parallel_for(threads, threads, [&](std::size_t t) {
+        std::size_t const s0 = slivers * t / threads, s1 = slivers * (t + 1) / threads;
+        std::size_t const j0 = s0 * blk::nr, j1 = std::min(nb, s1 * blk::nr);
+        if (j0 < j1) pack_b(b.block(pc, jc + j0, kb, j1 - j0), packed_b.get() + j0 * kb);
+      });
+      T const beta_pc = pc == 0 ? beta : T{1};
+      parallel_for(row_blocks, threads, [&](std::size_t r) {
+        std::size_t const ic = r * blk::mc;
+        std::size_t const mb = std::min(blk::mc, m - ic);
+        scratch_buffer<T> packed_a(round_up(mb, blk::mr) * kb, task_mr, cache_line_size);
+        pack_a(a.block(ic, pc, mb, kb), packed_a.get());
+        matrix_view<T> const cb = c.block(ic, jc, mb, nb);
+        scale(cb, beta_pc);
+        macro_kernel(micro, kb, packed_a.get(), packed_b.get(), cb, alpha);
+      });
+    }
+  }
+}
+
+template <class T>
+void check_gemm(matrix_view<T const> a, matrix_view<T const> b, matrix_view<T> c) {
+  if (a.rows() != c.rows() || b.cols() != c.cols() || a.cols() != b.rows())
+    throw std::invalid_argument("gemm: dimensions do not match");
+}
+
+}  // namespace detail::linalg
+
+// C = alpha * A * B + beta * C for float or double matrices. C must not
+// overlap A or B. Throws std::invalid_argument unless A is m x k, B k x n
+// and C m x n.
+template <class T>
+void gemm(T alpha, detail::linalg::identity_t<matrix_view<T const>> a,
+          detail::linalg::identity_t<matrix_view<T const>> b, T beta,
+          detail::linalg::identity_t<matrix_view<T>> c,
+          std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  static_assert(detail::linalg::gemm_type_v<T>, "gemm: T must be float or double");
+  detail::linalg::check_gemm(a, b, c);
+  detail::linalg::gemm(detail::linalg::kernels().gemm<T>(), alpha, a, b, beta, c, 1, mr);
+}
+
+// The same with an explicit instruction set (clamped to the host's).
+template <class T>
+void gemm(isa which, T alpha, detail::linalg::identity_t<matrix_view<T const>> a,
+          detail::linalg::identity_t<matrix_view<T const>> b, T beta,
+          detail::linalg::identity_t<matrix_view<T>> c,
+          std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  static_assert(detail::linalg::gemm_type_v<T>, "gemm: T must be float or double");
+  detail::linalg::check_gemm(a, b, c);
+  detail::linalg::gemm(detail::linalg::make_kernel_table(which).gemm<T>(), alpha, a, b, beta, c,
+                       1, mr);
+}
+
+template <class T>
+void gemm(parallel_policy policy, T alpha, detail::linalg::identity_t<matrix_view<T const>> a,
+          detail::linalg::identity_t<matrix_view<T const>> b, T beta,
+          detail::linalg::identity_t<matrix_view<T>> c,
+          std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  static_assert(detail::linalg::gemm_type_v<T>, "gemm: T must be float or double");
+  detail::linalg::check_gemm(a, b, c);
+  detail::linalg::gemm(detail::linalg::kernels().gemm<T>(), alpha, a, b, beta, c,
+                       detail::resolve_threads(policy.threads), mr);
+}
+
+}  // namespace algoritmi
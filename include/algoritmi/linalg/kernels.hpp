@@ -0,0 +1,166 @@
+// GEMM micro-kernels, one version per instruction set, selected like the
+// search kernels (see cpu.hpp).
+//
+// A micro-kernel adds alpha * A * B to an mr x nr tile of C, where A is an
+// mr-row sliver of the left operand and B an nr-column sliver of the right
+// one, both packed (gemm.hpp) so that step p of the k loop reads mr
+// consecutive elements of A and nr of B. The AVX2 kernels keep the whole
+// tile in twelve ymm registers: 6 x 8 doubles or 6 x 16 floats, updated by
+// one broadcast of A and two FMAs against the two vectors of B per row.
+// That is 12 FMAs per 2 loads of B and 6 broadcasts, enough to keep both
+// FMA ports busy from L1. They need FMA3 besides AVX2; without it, as at
+// the SSE4.2 level, the portable kernel runs, which the compiler
+// vectorises for the baseline instruction set.
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::linalg {
+
+// Register tile (mr x nr) and cache blocks: an mc x kc block of A stays in
+// L2 while the micro-kernels stream kc x nr slivers of a kc x nc block of
+// B from L1 and L3. The values are those BLIS uses on Haswell.
+template <class T>
+struct blocking;
+
+template <>
+struct blocking<double> {
+  static constexpr std::size_t mr = 6, nr = 8;
+  static constexpr std::size_t mc = 72, kc = 256, nc = 4080;
+};
+
+template <>
+struct blocking<float> {
+  static constexpr std::size_t mr = 6, nr = 16;
+  static constexpr std::size_t mc = 144, kc = 256, nc = 4080;
+};
+
+template <class T>
+using micro_kernel = void (*)(std::size_t kc, T const* a, T const* b, T* c, std::size_t ldc,
+                              T alpha);
+
+// ---------------------------------------------------------------- scalar --
+
+template <class T>
+void micro_scalar(std::size_t kc, T const* a, T const* b, T* c, std::size_t ldc,
+                  T alpha) noexcept {
+  constexpr std::size_t mr = blocking<T>::mr, nr = blocking<T>::nr;
+  T acc[mr][nr] = {};
+  for (std::size_t p = 0; p < kc; ++p, a += mr, b += nr)
+    for (std::size_t i = 0; i < mr; ++i)
+      for (std::size_t j = 0; j < nr; ++j) acc[i][j] += a[i] * b[j];
+  for (std::size_t i = 0; i < mr; ++i)
+    for (std::size_t j = 0; j < nr; ++j) c[i * ldc + j] += alpha * acc[i][j];
+}
+
+#if ALGORITMI_HAS_SIMD
+
+// ------------------------------------------------------------------ AVX2 --
+
+#define ALGORITMI_GEMM_ROW(i, broadcast, fmadd) \
+  {                                            \
+    auto const ai = broadcast(a + i);          \
+    c##i##0 = fmadd(ai, b0, c##i##0);          \
+    c##i##1 = fmadd(ai, b1, c##i##1);          \
+  }
+
+// Row i of the tile: c += alpha * acc, in two vectors of w elements.
+#define ALGORITMI_GEMM_STORE(i, loadu, storeu, fmadd, w)                \
+  storeu(c + i * ldc, fmadd(va, c##i##0, loadu(c + i * ldc)));          \
+  storeu(c + i * ldc + w, fmadd(va, c##i##1, loadu(c + i * ldc + w)));
+
+ALGORITMI_TARGET_AVX2_FMA inline void micro_avx2(std::size_t kc, double const* a,
+                                                 double const* b, double* c, std::size_t ldc,
+                                                 double alpha) noexcept {
+  __m256d c00 = _mm256_setzero_pd(), c01 = c00, c10 = c00, c11 = c00, c20 = c00, c21 = c00;
+  __m256d c30 = c00, c31 = c00, c40 = c00, c41 = c00, c50 = c00, c51 = c00;
+  for (std::size_t p = 0; p < kc; ++p, a += 6, b += 8) {
+    __m256d const b0 = _mm256_loadu_pd(b);
+    __m256d const b1 = _mm256_loadu_pd(b + 4);
+    ALGORITMI_GEMM_ROW(0, _mm256_broadcast_sd, _mm256_fmadd_pd)
+    ALGORITMI_GEMM_ROW(1, _mm256_broadcast_sd, _mm256_fmadd_pd)
+    ALGORITMI_GEMM_ROW(2, _mm256_broadcast_sd, _mm256_fmadd_pd)
+    ALGORITMI_GEMM_ROW(3, _mm256_broadcast_sd, _mm256_fmadd_pd)
+    ALGORITMI_GEMM_ROW(4, _mm256_broadcast_sd, _mm256_fmadd_pd)
+    ALGORITMI_GEMM_ROW(5, _mm256_broadcast_sd, _mm256_fmadd_pd)
+  }
+  __m256d const va = _mm256_set1_pd(alpha);
+  ALGORITMI_GEMM_STORE(0, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, 4)
+  ALGORITMI_GEMM_STORE(1, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, 4)
+  ALGORITMI_GEMM_STORE(2, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, 4)
+  ALGORITMI_GEMM_STORE(3, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, 4)
+  ALGORITMI_GEMM_STORE(4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, 4)
+  ALGORITMI_GEMM_STORE(5, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, 4)
+}
+
+ALGORITMI_TARGET_AVX2_FMA inline void micro_avx2(std::size_t kc, float const* a, float const* b,
+                                                 float* c, std::size_t ldc,
+                                                 float alpha) noexcept {
+  __m256 c00 = _mm256_setzero_ps(), c01 = c00, c10 = c00, c11 = c00, c20 = c00, c21 = c00;
+  __m256 c30 = c00, c31 = c00, c40 = c00, c41 = c00, c50 = c00, c51 = c00;
+  for (std::size_t p = 0; p < kc; ++p, a += 6, b += 16) {
+    __m256 const b0 = _mm256_loadu_ps(b);
+    __m256 const b1 = _mm256_loadu_ps(b + 8);
+    ALGORITMI_GEMM_ROW(0, _mm256_broadcast_ss, _mm256_fmadd_ps)
+    ALGORITMI_GEMM_ROW(1, _mm256_broadcast_ss, _mm256_fmadd_ps)
+    ALGORITMI_GEMM_ROW(2, _mm256_broadcast_ss, _mm256_fmadd_ps)
+    ALGORITMI_GEMM_ROW(3, _mm256_broadcast_ss, _mm256_fmadd_ps)
+    ALGORITMI_GEMM_ROW(4, _mm256_broadcast_ss, _mm256_fmadd_ps)
+    ALGORITMI_GEMM_ROW(5, _mm256_broadcast_ss, _mm256_fmadd_ps)
+  }
+  __m256 const va = _mm256_set1_ps(alpha);
+  ALGORITMI_GEMM_STORE(0, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, 8)
+  ALGORITMI_GEMM_STORE(1, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, 8)
+  ALGORITMI_GEMM_STORE(2, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, 8)
+  ALGORITMI_GEMM_STORE(3, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, 8)
+  ALGORITMI_GEMM_STORE(4, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, 8)
+  ALGORITMI_GEMM_STORE(5, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, 8)
+}
+
+#undef ALGORITMI_GEMM_ROW
+#undef ALGORITMI_GEMM_STORE
+
+#endif  // ALGORITMI_HAS_SIMD
+
+// ---------------------------------------------------------------- tables --
+
+struct kernel_table {
+  micro_kernel<double> gemm_f64;
+  micro_kernel<float> gemm_f32;
+
+  template <class T>
+  micro_kernel<T> gemm() const noexcept {
+    if constexpr (std::is_same_v<T, double>)
+      return gemm_f64;
+    else
+      return gemm_f32;
+  }
+};
+
+inline kernel_table make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  if (usable_isa(which) == isa::avx2 && cpu().fma) {
+    micro_kernel<double> const f64 = &micro_avx2;
+    micro_kernel<float> const f32 = &micro_avx2;
+    return {f64, f32};
+  }
+#else
+  (void)which;
+#endif
+  return {&micro_scalar<double>, &micro_scalar<float>};
+}
+
+inline kernel_table const& kernels() noexcept {
+  static kernel_table const table = make_kernel_table(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::linalg
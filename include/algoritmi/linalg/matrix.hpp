@@ -0,0 +1,91 @@
+// Dense row-major matrices: matrix<T> owns its elements, matrix_view<T> is
+// a rectangle of rows `stride` elements apart inside someone else's array,
+// such as a block of a larger matrix.
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "../detail/aligned.hpp"
+
+namespace algoritmi {
+
+template <class T>
+class matrix_view {
+ public:
+  using value_type = std::remove_const_t<T>;
+
+  constexpr matrix_view() noexcept = default;
+  constexpr matrix_view(T* data, std::size_t rows, std::size_t cols) noexcept
+      : matrix_view(data, rows, cols, cols) {}
+  constexpr matrix_view(T* data, std::size_t rows, std::size_t cols, std::size_t stride) noexcept
+      : data_(data), rows_(rows), cols_(cols), stride_(stride) {}
+
+  // A mutable view converts to a read-only one.
+  template <class U, class = std::enable_if_t<std::is_same_v<U const, T> && !std::is_const_v<U>>>
+  constexpr matrix_view(matrix_view<U> v) noexcept
+      : data_(v.data()), rows_(v.rows()), cols_(v.cols()), stride_(v.stride()) {}
+
+  constexpr T* data() const noexcept { return data_; }
+  constexpr std::size_t rows() const noexcept { return rows_; }
+  constexpr std::size_t cols() const noexcept { return cols_; }
+  constexpr std::size_t stride() const noexcept { return stride_; }
+  constexpr bool empty() const noexcept { return rows_ == 0 || cols_ == 0; }
+
+  constexpr T* row(std::size_t i) const noexcept { return data_ + i * stride_; }
+  constexpr T& operator()(std::size_t i, std::size_t j) const noexcept {
+    return data_[i * stride_ + j];
+  }
+
+  // The rows x cols rectangle whose top-left element is (i, j).
+  constexpr matrix_view block(std::size_t i, std::size_t j, std::size_t rows,
+                              std::size_t cols) const noexcept {
+    return matrix_view(data_ + i * stride_ + j, rows, cols, stride_);
+  }
+
+ private:
+  T* data_ = nullptr;
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t stride_ = 0;
+};
+
+// Rows are contiguous (stride == cols) and the array starts on a cache
+// line.
+template <class T>
+class matrix {
+ public:
+  using value_type = T;
+
+  explicit matrix(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : data_(mr) {}
+  // rows x cols value-initialised elements.
+  matrix(std::size_t rows, std::size_t cols,
+         std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : rows_(rows), cols_(cols), data_(rows * cols, T{}, mr) {}
+
+  std::size_t rows() const noexcept { return rows_; }
+  std::size_t cols() const noexcept { return cols_; }
+  bool empty() const noexcept { return data_.empty(); }
+
+  T* data() noexcept { return data_.data(); }
+  T const* data() const noexcept { return data_.data(); }
+  T* row(std::size_t i) noexcept { return data_.data() + i * cols_; }
+  T const* row(std::size_t i) const noexcept { return data_.data() + i * cols_; }
+  T& operator()(std::size_t i, std::size_t j) noexcept { return data_[i * cols_ + j]; }
+  T const& operator()(std::size_t i, std::size_t j) const noexcept { return data_[i * cols_ + j]; }
+
+  matrix_view<T> view() noexcept { return {data_.data(), rows_, cols_}; }
+  matrix_view<T const> view() const noexcept { return {data_.data(), rows_, cols_}; }
+  operator matrix_view<T>() noexcept { return view(); }
+  operator matrix_view<T const>() const noexcept { return view(); }
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::vector<T, detail::aligned_allocator<T>> data_;
+};
+
+}  // namespace algoritmi
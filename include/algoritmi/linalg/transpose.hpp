@@ -0,0 +1,103 @@
+// Out-of-place transpose, cache-oblivious (Frigo, Leiserson, Prokop and
+// Ramachandran, 1999).
+//
+// A row-major transpose reads one matrix along rows and writes the other
+// along columns, so the naive loop misses on nearly every write once a
+// column of the output no longer fits in cache. Halving the longer side
+// until both fit a small tile keeps the rows read and the rows written by
+// each tile resident at every cache level at once, without knowing their
+// sizes. The parallel overload hands out square tiles of the input, each
+// transposed the same way.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
+
+#include "../detail/parallel.hpp"
+#include "../execution.hpp"
+#include "gemm.hpp"
+#include "matrix.hpp"
+
+namespace algoritmi {
+namespace detail::linalg {
+
+// Tiles of at most leaf x leaf elements are copied directly, one output
+// row at a time; tasks of the parallel overload are task_tile x task_tile.
+inline constexpr std::size_t transpose_leaf = 32;
+inline constexpr std::size_t transpose_task_tile = 256;
+
+template <class T>
+void transpose(T const* a, std::size_t lda, T* b, std::size_t ldb, std::size_t rows,
+               std::size_t cols) {
+  while (rows > transpose_leaf || cols > transpose_leaf) {
+    if (rows >= cols) {
+      std::size_t const h = rows / 2;
+      transpose(a, lda, b, ldb, h, cols);
+      a += h * lda;
+      b += h;
+      rows -= h;
+    } else {
+      std::size_t const h = cols / 2;
+      transpose(a, lda, b, ldb, rows, h);
+      a += h;
+      b += h * ldb;
+      cols -= h;
+    }
+  }
+  for (std::size_t j = 0; j < cols; ++j)
+    for (std::size_t i = 0; i < rows; ++i) b[j * ldb + i] = a[i * lda + j];
+}
+
+template <class T>
+void check_transpose(matrix_view<T const> a, matrix_view<T> b) {
+  if (b.rows() != a.cols() || b.cols() != a.rows())
+    throw std::invalid_argument("transpose: output must be a.cols() x a.rows()");
+}
+
+}  // namespace detail::linalg
+
+// b = the transpose of a. b must not overlap a. Throws
+// std::invalid_argument unless b is a.cols() x a.rows().
+template <class T>
+void transpose(detail::linalg::identity_t<matrix_view<T const>> a, matrix_view<T> b) {
+  detail::linalg::check_transpose(a, b);
+  detail::linalg::transpose(a.data(), a.stride(), b.data(), b.stride(), a.rows(), a.cols());
+}
+
+template <class T>
+void transpose(parallel_policy policy, detail::linalg::identity_t<matrix_view<T const>> a,
+               matrix_view<T> b) {
+  using detail::linalg::transpose_task_tile;
+  detail::linalg::check_transpose(a, b);
+  std::size_t const tile_rows = (a.rows() + transpose_task_tile - 1) / transpose_task_tile;
+  std::size_t const tile_cols = (a.cols() + transpose_task_tile - 1) / transpose_task_tile;
+  std::size_t const tiles = tile_rows * tile_cols;
+  unsigned const threads = tiles > 1 ? detail::resolve_threads(policy.threads) : 1;
+  detail::parallel_for(tiles, threads, [&](std::size_t t) {
+    std::size_t const i = t / tile_cols * transpose_task_tile;
+    std::size_t const j = t % tile_cols * transpose_task_tile;
+    std::size_t const h = std::min(transpose_task_tile, a.rows() - i);
+    std::size_t const w = std::min(transpose_task_tile, a.cols() - j);
+    detail::linalg::transpose(&a(i, j), a.stride(), &b(j, i), b.stride(), h, w);
+  });
+}
+
+template <class T>
+matrix<T> transpose(matrix<T> const& a,
+                    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  matrix<T> b(a.cols(), a.rows(), mr);
+  transpose<T>(a.view(), b.view());
+  return b;
+}
+
+template <class T>
+matrix<T> transpose(parallel_policy policy, matrix<T> const& a,
+                    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  matrix<T> b(a.cols(), a.rows(), mr);
+  transpose<T>(policy, a.view(), b.view());
+  return b;
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,16 @@
+// Memory resources for temporary and container storage.
+//
+//   arena        monotonic bump allocator; reset() reuses its memory, so a
+//                request loop that resets it per request stops calling malloc
+//   fixed_pool   free-list pool of equal-sized blocks for node-based
+//                structures
+//
+// Both derive from std::pmr::memory_resource. Every container and algorithm
+// in the library that allocates takes a `std::pmr::memory_resource*`
+// (defaulting to std::pmr::get_default_resource()) for its storage and
+// scratch space. Arenas and pools are not thread-safe: parallel overloads
+// only use the resource from the calling thread.
+#pragma once
+
+#include "memory/arena.hpp"
+#include "memory/pool.hpp"
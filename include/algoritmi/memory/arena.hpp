@@ -0,0 +1,165 @@
+// Monotonic arena usable as a std::pmr::memory_resource.
+//
+// Allocation is a pointer bump; deallocation is a no-op. reset() makes all
+// memory reusable without returning it upstream, and merges the chunks
+// acquired so far into one chunk of their combined size. A request loop that
+// resets the arena once per request therefore stops calling malloc after
+// its first few iterations.
+//
+//   algoritmi::arena a;
+//   for (auto& req : requests) {
+//     a.reset();
+//     auto dist = algoritmi::dijkstra(g, req.source, &a);  // no mallocs
+//   }
+//
+// Not thread-safe; use one arena per thread.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+namespace algoritmi {
+
+class arena final : public std::pmr::memory_resource {
+ public:
+  explicit arena(std::size_t initial_bytes = 64 * 1024,
+                 std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream), next_size_(initial_bytes < min_chunk ? min_chunk : initial_bytes) {}
+
+  // Uses caller-provided storage (e.g. a stack buffer) before going upstream.
+  // The buffer is never freed by the arena.
+  arena(void* buffer, std::size_t bytes,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream),
+        initial_(static_cast<std::byte*>(buffer)),
+        initial_size_(bytes),
+        cur_(static_cast<std::byte*>(buffer)),
+        end_(static_cast<std::byte*>(buffer) + bytes),
+        next_size_(bytes < min_chunk ? min_chunk : bytes * 2) {}
+
+  arena(arena const&) = delete;
+  arena& operator=(arena const&) = delete;
+
+  ~arena() override { release(); }
+
+  // Makes all memory available again. Pointers handed out before are
+  // invalidated. Allocates at most once (to merge chunks), then never again
+  // for the same peak usage.
+  void reset() {
+    used_before_current_ = 0;
+    if (chunks_ && chunks_->next) {
+      std::size_t total = 0;
+      for (chunk* c = chunks_; c; c = c->next) total += c->size;
+      free_chunks();
+      add_chunk(total);
+    }
+    if (chunks_) {
+      cur_ = chunks_->data();
+      end_ = chunks_->data() + chunks_->size;
+    } else {
+      cur_ = initial_;
+      end_ = initial_ + initial_size_;
+    }
+  }
+
+  // Returns every chunk to the upstream resource.
+  void release() noexcept {
+    free_chunks();
+    used_before_current_ = 0;
+    cur_ = initial_;
+    end_ = initial_ + initial_size_;
+  }
+
+  // Bytes handed out since the last reset (including alignment padding).
+  std::size_t bytes_used() const noexcept {
+    return used_before_current_ + static_cast<std::size_t>(cur_ - current_begin());
+  }
+
+  // Bytes owned by the arena, excluding a caller-provided buffer.
+  std::size_t bytes_reserved() const noexcept {
+    std::size_t total = 0;
+    for (chunk* c = chunks_; c; c = c->next) total += c->size;
+    return total;
+  }
+
+  std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+ private:
+  static constexpr std::size_t min_chunk = 4096;
+
+  struct alignas(std::max_align_t) chunk {
+    chunk* next;
+    std::size_t size;  // usable bytes after the header
+    std::byte* data() noexcept { return reinterpret_cast<std::byte*>(this + 1); }
+  };
+
+  std::byte* current_begin() const noexcept {
+    if (!current_chunk_) return initial_;
+    return current_chunk_->data();
+  }
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (void* p = bump(bytes, alignment)) return p;
+    std::size_t need = bytes + alignment;
+    std::size_t size = next_size_;
+    while (size < need) size *= 2;
+    used_before_current_ += static_cast<std::size_t>(cur_ - current_begin());
+    add_chunk(size);
+    next_size_ = size * 2;
+    return bump(bytes, alignment);
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+
+  void* bump(std::size_t bytes, std::size_t alignment) noexcept {
+    auto const p = reinterpret_cast<std::uintptr_t>(cur_);
+    auto const aligned = (p + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    if (cur_ == nullptr || aligned + bytes > reinterpret_cast<std::uintptr_t>(end_)) return nullptr;
+    cur_ = reinterpret_cast<std::byte*>(aligned + bytes);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  // New chunks go to the end of the list so reset() starts from the oldest.
+  void add_chunk(std::size_t size) {
+    void* mem = upstream_->allocate(sizeof(chunk) + size, alignof(chunk));
+    chunk* c = ::new (mem) chunk{nullptr, size};
+    if (!chunks_) {
+      chunks_ = c;
+    } else {
+      chunk* last = chunks_;
+      while (last->next) last = last->next;
+      last->next = c;
+    }
+    current_chunk_ = c;
+    cur_ = c->data();
+    end_ = c->data() + size;
+  }
+
+  void free_chunks() noexcept {
+    for (chunk* c = chunks_; c;) {
+      chunk* next = c->next;
+      upstream_->deallocate(c, sizeof(chunk) + c->size, alignof(chunk));
+      c = next;
+    }
+    chunks_ = nullptr;
+    current_chunk_ = nullptr;
+  }
+
+  std::pmr::memory_resource* upstream_;
+  std::byte* initial_ = nullptr;
+  std::size_t initial_size_ = 0;
+  chunk* chunks_ = nullptr;
+  chunk* current_chunk_ = nullptr;
+  std::byte* cur_ = nullptr;
+  std::byte* end_ = nullptr;
+  std::size_t next_size_;
+  std::size_t used_before_current_ = 0;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,121 @@
+// Fixed-size block pool usable as a std::pmr::memory_resource.
+//
+// Requests up to block_size bytes are served from an intrusive free list,
+// refilled a chunk at a time from the upstream resource; freed blocks go back
+// on the list and are reused LIFO, so a node-based structure that reaches a
+// steady size stops allocating. Larger requests are forwarded upstream.
+//
+// Not thread-safe; use one pool per thread.
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+
+#include "../config.hpp"
+
+namespace algoritmi {
+
+class fixed_pool final : public std::pmr::memory_resource {
+ public:
+  // Blocks are aligned to `block_align` (a power of two). blocks_per_chunk
+  // is the size of the first refill; later refills double it.
+  explicit fixed_pool(std::size_t block_size, std::size_t block_align = alignof(std::max_align_t),
+                      std::size_t blocks_per_chunk = 64,
+                      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream), align_(block_align), next_blocks_(blocks_per_chunk ? blocks_per_chunk : 1) {
+    if (block_align == 0 || (block_align & (block_align - 1)) != 0)
+      throw std::invalid_argument("fixed_pool: alignment must be a power of two");
+    std::size_t const min = sizeof(free_block) > block_size ? sizeof(free_block) : block_size;
+    std::size_t const slot = slot_align();
+    block_ = (min + slot - 1) & ~(slot - 1);
+  }
+
+  fixed_pool(fixed_pool const&) = delete;
+  fixed_pool& operator=(fixed_pool const&) = delete;
+
+  ~fixed_pool() override { release(); }
+
+  // Returns every chunk upstream. Outstanding blocks become invalid.
+  void release() noexcept {
+    for (chunk* c = chunks_; c;) {
+      chunk* next = c->next;
+      upstream_->deallocate(c, c->bytes, c->align);
+      c = next;
+    }
+    chunks_ = nullptr;
+    free_ = nullptr;
+  }
+
+  std::size_t block_size() const noexcept { return block_; }
+  std::size_t blocks_in_use() const noexcept { return in_use_; }
+  std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+ private:
+  struct free_block {
+    free_block* next;
+  };
+
+  struct chunk {
+    chunk* next;
+    std::size_t bytes;
+    std::size_t align;
+  };
+
+  // Blocks hold a free_block link while free, so they are aligned for it
+  // even when block_align is smaller.
+  std::size_t slot_align() const noexcept {
+    return align_ > alignof(free_block) ? align_ : alignof(free_block);
+  }
+
+  bool fits(std::size_t bytes, std::size_t alignment) const noexcept {
+    return bytes <= block_ && alignment <= align_;
+  }
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (ALGORITMI_UNLIKELY(!fits(bytes, alignment))) return upstream_->allocate(bytes, alignment);
+    if (ALGORITMI_UNLIKELY(!free_)) refill();
+    free_block* b = free_;
+    free_ = b->next;
+    ++in_use_;
+    return b;
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    if (ALGORITMI_UNLIKELY(!fits(bytes, alignment))) return upstream_->deallocate(p, bytes, alignment);
+    free_ = ::new (p) free_block{free_};
+    --in_use_;
+  }
+
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+
+  // Carves a new chunk into blocks; the chunk header sits in the first
+  // slot-aligned bytes.
+  void refill() {
+    std::size_t const slot = slot_align();
+    std::size_t const header = (sizeof(chunk) + slot - 1) & ~(slot - 1);
+    std::size_t const align = slot > alignof(chunk) ? slot : alignof(chunk);
+    std::size_t const bytes = header + next_blocks_ * block_;
+    auto* mem = static_cast<std::byte*>(upstream_->allocate(bytes, align));
+    chunks_ = ::new (mem) chunk{chunks_, bytes, align};
+    // Thread the free list in address order so fresh blocks are handed out
+    // sequentially.
+    for (std::size_t i = next_blocks_; i-- > 0;) {
+      free_ = ::new (mem + header + i * block_) free_block{free_};
+    }
+    next_blocks_ *= 2;
+  }
+
+  std::pmr::memory_resource* upstream_;
+  std::size_t align_;
+  std::size_t block_ = 0;
+  std::size_t next_blocks_;
+  std::size_t in_use_ = 0;
+  chunk* chunks_ = nullptr;
+  free_block* free_ = nullptr;
+};
+
+}  // namespace algoritmi
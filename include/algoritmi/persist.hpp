@@ -0,0 +1,29 @@
+// Index files: built structures written once and opened with mmap.
+//
+//   index_writer(path)            add(name, data, n), add_value, save(...),
+//                                 commit(); atomic replace of path
+//   index_file(path[, options])   array<T>(name), value<T>(name), verify()
+//   save(writer, name, x)         csr_graph, static_search_tree,
+//                                 eytzinger_index, flat_hash_map/set,
+//                                 rank_select_bitvector, elias_fano,
+//                                 wavelet_matrix, blocked_bloom_filter,
+//                                 xor_filter, binary_fuse_filter,
+//                                 hyperloglog
+//   load<X>(file, name)           X using the mapped arrays in place
+//   flat_hash_map_view<K, V>      read-only lookups in a saved map or set
+//   flat_hash_set_view<K>
+//   format_error                  bad or mismatched file
+//
+// A file is a header, 64-byte-aligned sections and a directory of named,
+// typed, checksummed sections (persist/format.hpp). Opening one validates
+// the header and directory and nothing else, so it takes the same time for
+// any file size; the data is paged in as queries touch it. Plain arrays
+// such as a suffix array, its text and LCP array are added with add() and
+// read back with array<T>(), which the string functions take as pointers.
+// Files are only read on machines of the writer's byte order and with the
+// same format_version.
+#pragma once
+
+#include "persist/format.hpp"
+#include "persist/index_file.hpp"
+#include "persist/structures.hpp"
@@ -0,0 +1,130 @@
+// On-disk layout of an index file.
+//
+//   offset 0      file_header (64 bytes)
+//   64 * k        section payloads, each starting on a 64-byte boundary
+//   64 * k        directory: one section_entry (64 bytes) per section
+//
+// Every field is a fixed-width integer in the writer's byte order, which the
+// header records; a reader on the other byte order rejects the file rather
+// than swapping. Payloads are raw arrays of trivially copyable elements, so
+// a mapped file is used in place: the page-aligned mapping plus 64-byte
+// section offsets give every array the alignment the in-memory structures
+// use. The version is bumped whenever the layout of the header, the
+// directory or a structure's sections changes.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace algoritmi::detail::persist {
+
+inline constexpr char magic[8] = {'A', 'L', 'G', 'O', 'I', 'D', 'X', '\0'};
+inline constexpr std::uint32_t format_version = 1;
+inline constexpr std::uint32_t byte_order_mark = 0x01020304;
+inline constexpr std::size_t section_alignment = 64;
+inline constexpr std::size_t max_name_length = 31;
+
+struct file_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint64_t file_size;
+  std::uint64_t directory_offset;
+  std::uint32_t section_count;
+  std::uint32_t reserved;
+  std::uint64_t directory_checksum;
+  std::uint8_t padding[16];
+};
+
+struct section_entry {
+  char name[max_name_length + 1];  // NUL-terminated
+  std::uint64_t offset;
+  std::uint64_t bytes;
+  std::uint32_t element_size;
+  std::uint32_t element_kind;
+  std::uint64_t checksum;
+};
+
+static_assert(sizeof(file_header) == 64 && sizeof(section_entry) == 64);
+static_assert(std::is_trivially_copyable_v<file_header> &&
+              std::is_trivially_copyable_v<section_entry>);
+
+// What an element is, beyond its size, so that reading u32 where f32 was
+// written fails: 1 unsigned, 2 signed, 3 floating point, 0 anything else.
+template <class T>
+constexpr std::uint32_t element_kind() noexcept {
+  if constexpr (std::is_floating_point_v<T>) return 3;
+  else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) return 2;
+  else if constexpr (std::is_integral_v<T>) return 1;
+  else return 0;
+}
+
+inline constexpr std::uint64_t align_up(std::uint64_t x) noexcept {
+  return (x + section_alignment - 1) & ~std::uint64_t{section_alignment - 1};
+}
+
+// Part of the format, so it never changes: four multiply-xorshift lanes
+// over 8-byte words, several bytes per cycle. Fed incrementally so that a
+// section can be written in chunks; the result only depends on the bytes.
+class checksummer {
+ public:
+  void update(void const* data, std::size_t bytes) noexcept {
+    if (bytes == 0) return;
+    auto const* p = static_cast<unsigned char const*>(data);
+    total_ += bytes;
+    if (buffered_) {
+      std::size_t const take = bytes < 32 - buffered_ ? bytes : 32 - buffered_;
+      std::memcpy(buffer_ + buffered_, p, take);
+      buffered_ += take;
+      p += take;
+      bytes -= take;
+      if (buffered_ < 32) return;
+      block(buffer_);
+      buffered_ = 0;
+    }
+    for (; bytes >= 32; p += 32, bytes -= 32) block(p);
+    std::memcpy(buffer_, p, bytes);
+    buffered_ = bytes;
+  }
+
+  std::uint64_t finish() const noexcept {
+    unsigned char tail[32] = {};
+    std::memcpy(tail, buffer_, buffered_);
+    std::uint64_t h[4] = {h_[0], h_[1], h_[2], h_[3]};
+    for (int l = 0; l < 4; ++l) h[l] = step(h[l], word(tail + 8 * l));
+    std::uint64_t r = total_;
+    for (int l = 0; l < 4; ++l) r = step(r, h[l]);
+    return r;
+  }
+
+ private:
+  static constexpr std::uint64_t k = 0x9e3779b97f4a7c15ull;
+
+  static std::uint64_t step(std::uint64_t x, std::uint64_t w) noexcept {
+    x = (x ^ w) * 0xff51afd7ed558ccdull;
+    return x ^ (x >> 32);
+  }
+  static std::uint64_t word(unsigned char const* p) noexcept {
+    std::uint64_t w;
+    std::memcpy(&w, p, 8);
+    return w;
+  }
+  void block(unsigned char const* p) noexcept {
+    for (int l = 0; l < 4; ++l) h_[l] = step(h_[l], word(p + 8 * l));
+  }
+
+  std::uint64_t h_[4] = {k, k * 3, k * 5, k * 7};
+  std::uint64_t total_ = 0;
+  unsigned char buffer_[32] = {};
+  std::size_t buffered_ = 0;
+};
+
+inline std::uint64_t checksum(void const* data, std::size_t bytes) noexcept {
+  checksummer c;
+  c.update(data, bytes);
+  return c.finish();
+}
+
+}  // namespace algoritmi::detail::persist
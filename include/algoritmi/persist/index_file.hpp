@@ -0,0 +1,280 @@
+// Writing and opening index files (layout in format.hpp).
+//
+// index_writer appends named sections to `<path>.tmp` and, on commit(),
+// writes the directory and header, syncs, and renames the file over
+// `path`: readers see the old file or the complete new one, never a torn
+// one. index_file maps a file read-only, checks the header and directory,
+// and hands out sections as spans into the mapping. Opening costs one
+// mmap and a pass over the directory; pages are read as they are touched.
+//
+// Errors in the file itself throw format_error; I/O failures throw
+// std::system_error as elsewhere.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../detail/file.hpp"
+#include "../span.hpp"
+#include "format.hpp"
+
+namespace algoritmi {
+
+class format_error : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+class index_writer {
+ public:
+  explicit index_writer(std::filesystem::path path)
+      : path_(std::move(path)),
+        temp_(path_.string() + ".tmp"),
+        out_(detail::file::create(temp_)) {
+    offset_ = sizeof(detail::persist::file_header);
+  }
+
+  index_writer(index_writer const&) = delete;
+  index_writer& operator=(index_writer const&) = delete;
+
+  // An uncommitted file is removed; the previous one at `path` stays.
+  ~index_writer() {
+    if (!committed_) {
+      out_ = detail::file();
+      std::error_code ignored;
+      std::filesystem::remove(temp_, ignored);
+    }
+  }
+
+  // Adds data[0, n) as section `name`: at most 31 bytes, unique in the file.
+  template <class T>
+  void add(std::string_view name, T const* data, std::size_t n) {
+    static_assert(std::is_trivially_copyable_v<T>, "sections hold trivially copyable elements");
+    section s = open(name, sizeof(T), detail::persist::element_kind<T>());
+    write(s, data, n * sizeof(T));
+    close(s);
+  }
+  template <class T>
+  void add(std::string_view name, span<T const> data) {
+    add(name, data.data(), data.size());
+  }
+  template <class T>
+  void add_value(std::string_view name, T const& value) {
+    add(name, &value, 1);
+  }
+
+  // Adds a section of n elements produced in chunks by fill(T* out, first,
+  // count), which writes elements [first, first + count): for sections
+  // that are not stored contiguously in memory.
+  template <class T, class Fill>
+  void add_generated(std::string_view name, std::size_t n, Fill&& fill) {
+    static_assert(std::is_trivially_copyable_v<T>, "sections hold trivially copyable elements");
+    constexpr std::size_t chunk = std::max<std::size_t>(1, (std::size_t{1} << 16) / sizeof(T));
+    section s = open(name, sizeof(T), detail::persist::element_kind<T>());
+    std::vector<T> buffer(std::min(n, chunk));
+    for (std::size_t first = 0; first < n; first += chunk) {
+      std::size_t const count = std::min(chunk, n - first);
+      fill(buffer.data(), first, count);
+      write(s, buffer.data(), count * sizeof(T));
+    }
+    close(s);
+  }
+
+  bool contains(std::string_view name) const noexcept { return find(name) != nullptr; }
+
+  void commit() {
+    using namespace detail::persist;
+    if (committed_) throw std::logic_error("index_writer: already committed");
+    std::uint64_t const directory = offset_;
+    std::size_t const dir_bytes = sections_.size() * sizeof(section_entry);
+    out_.write_at(sections_.data(), dir_bytes, directory);
+
+    file_header h{};
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = format_version;
+    h.byte_order = byte_order_mark;
+    h.file_size = directory + dir_bytes;
+    h.directory_offset = directory;
+    h.section_count = static_cast<std::uint32_t>(sections_.size());
+    h.directory_checksum = checksum(sections_.data(), dir_bytes);
+    out_.write_at(&h, sizeof(h), 0);
+    out_.sync();
+    out_ = detail::file();
+    std::filesystem::rename(temp_, path_);
+    committed_ = true;
+  }
+
+ private:
+  detail::persist::section_entry const* find(std::string_view name) const noexcept {
+    for (auto const& s : sections_)
+      if (name == s.name) return &s;
+    return nullptr;
+  }
+
+  struct section {
+    detail::persist::section_entry entry;
+    detail::persist::checksummer sum;
+  };
+
+  section open(std::string_view name, std::uint32_t element_size, std::uint32_t kind) const {
+    using namespace detail::persist;
+    if (committed_) throw std::logic_error("index_writer: already committed");
+    if (name.empty() || name.size() > max_name_length)
+      throw std::invalid_argument("index_writer: section name must have 1 to 31 bytes");
+    if (contains(name))
+      throw std::invalid_argument("index_writer: duplicate section " + std::string(name));
+    section s{};
+    std::memcpy(s.entry.name, name.data(), name.size());
+    s.entry.offset = offset_;
+    s.entry.element_size = element_size;
+    s.entry.element_kind = kind;
+    return s;
+  }
+
+  void write(section& s, void const* data, std::size_t bytes) {
+    if (bytes == 0) return;
+    out_.write_at(data, bytes, s.entry.offset + s.entry.bytes);
+    s.sum.update(data, bytes);
+    s.entry.bytes += bytes;
+  }
+
+  void close(section& s) {
+    using namespace detail::persist;
+    s.entry.checksum = s.sum.finish();
+    // Zero the gap so that the file's contents never depend on memory.
+    std::uint64_t const end = s.entry.offset + s.entry.bytes;
+    static constexpr char zeros[section_alignment] = {};
+    if (align_up(end) > end) out_.write_at(zeros, align_up(end) - end, end);
+    offset_ = align_up(end);
+    sections_.push_back(s.entry);
+  }
+
+  std::filesystem::path path_;
+  std::filesystem::path temp_;
+  detail::file out_;
+  std::uint64_t offset_;
+  std::vector<detail::persist::section_entry> sections_;
+  bool committed_ = false;
+};
+
+struct open_options {
+  // Fault the whole file in at open instead of page by page on first use.
+  bool prefault = false;
+  // Checksum every section at open: reads the whole file.
+  bool verify = false;
+};
+
+class index_file {
+ public:
+  explicit index_file(std::filesystem::path const& path, open_options options = {})
+      : map_(detail::file::open_read(path),
+             options.prefault ? detail::map_access::populate : detail::map_access::random),
+        path_(path) {
+    validate();
+    if (options.verify) verify();
+  }
+
+  std::uint32_t version() const noexcept { return header().version; }
+  std::size_t size_bytes() const noexcept { return map_.size(); }
+  std::size_t section_count() const noexcept { return header().section_count; }
+  std::string_view section_name(std::size_t i) const noexcept { return directory()[i].name; }
+  bool contains(std::string_view name) const noexcept { return find(name) != nullptr; }
+
+  // Section `name` as an array of T, pointing into the mapping: valid while
+  // this object lives. Throws format_error if the section is missing or
+  // was written with a different element type.
+  template <class T>
+  span<T const> array(std::string_view name) const {
+    static_assert(std::is_trivially_copyable_v<T>, "sections hold trivially copyable elements");
+    detail::persist::section_entry const& e = section(name);
+    if (e.element_size != sizeof(T) || e.element_kind != detail::persist::element_kind<T>())
+      fail("section " + std::string(name) + " has a different element type");
+    return {reinterpret_cast<T const*>(map_.data() + e.offset),
+            static_cast<std::size_t>(e.bytes / sizeof(T))};
+  }
+
+  template <class T>
+  T const& value(std::string_view name) const {
+    span<T const> const a = array<T>(name);
+    if (a.size() != 1) fail("section " + std::string(name) + " is not a single value");
+    return a[0];
+  }
+
+  // Recomputes every section's checksum.
+  void verify() const {
+    for (std::size_t i = 0; i < section_count(); ++i) {
+      detail::persist::section_entry const& e = directory()[i];
+      if (detail::persist::checksum(map_.data() + e.offset, e.bytes) != e.checksum)
+        fail("checksum mismatch in section " + std::string(e.name));
+    }
+  }
+
+ private:
+  [[noreturn]] void fail(std::string const& what) const {
+    throw format_error(path_.string() + ": " + what);
+  }
+
+  detail::persist::file_header const& header() const noexcept {
+    return *reinterpret_cast<detail::persist::file_header const*>(map_.data());
+  }
+  detail::persist::section_entry const* directory() const noexcept {
+    return reinterpret_cast<detail::persist::section_entry const*>(map_.data() +
+                                                                   header().directory_offset);
+  }
+
+  detail::persist::section_entry const* find(std::string_view name) const noexcept {
+    detail::persist::section_entry const* const dir = directory();
+    for (std::size_t i = 0; i < section_count(); ++i)
+      if (name == dir[i].name) return dir + i;
+    return nullptr;
+  }
+
+  detail::persist::section_entry const& section(std::string_view name) const {
+    detail::persist::section_entry const* e = find(name);
+    if (!e) fail("no section " + std::string(name));
+    return *e;
+  }
+
+  void validate() const {
+    using namespace detail::persist;
+    std::uint64_t const size = map_.size();
+    if (size < sizeof(file_header) || std::memcmp(header().magic, magic, sizeof(magic)) != 0)
+      fail("not an index file");
+    file_header const& h = header();
+    if (h.byte_order != byte_order_mark) fail("written on a machine of the other byte order");
+    if (h.version != format_version)
+      fail("format version " + std::to_string(h.version) + ", expected " +
+           std::to_string(format_version));
+    if (h.file_size != size) fail("truncated or extended");
+    std::uint64_t const dir_bytes = std::uint64_t{h.section_count} * sizeof(section_entry);
+    if (h.directory_offset % section_alignment != 0 || h.directory_offset > size ||
+        dir_bytes > size - h.directory_offset)
+      fail("directory out of bounds");
+    if (checksum(map_.data() + h.directory_offset, dir_bytes) != h.directory_checksum)
+      fail("directory checksum mismatch");
+    section_entry const* const dir = directory();
+    for (std::size_t i = 0; i < h.section_count; ++i) {
+      section_entry const& e = dir[i];
+      if (std::memchr(e.name, '\0', sizeof(e.name)) == nullptr) fail("bad section name");
+      if (e.offset % section_alignment != 0 || e.offset > h.directory_offset ||
+          e.bytes > h.directory_offset - e.offset || e.element_size == 0 ||
+          e.bytes % e.element_size != 0)
+        fail("section " + std::string(e.name) + " out of bounds");
+    }
+  }
+
+  detail::mapped_file map_;
+  std::filesystem::path path_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,601 @@
+// Saving the static structures into an index file and opening them from
+// one without copying.
+//
+// save(writer, name, x) adds x's arrays as sections `name.<part>`, and
+// load<X>(file, name) returns an X whose arrays point into the mapping:
+// it answers queries at once, the pages it touches are read on demand, and
+// it must not outlive the index_file. Hash tables come back as read-only
+// views (flat_hash_map_view, flat_hash_set_view) that probe the stored
+// control bytes and entries exactly as the table did, so they need the
+// same Hash, and one whose values do not change between processes.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "../detail/bits.hpp"
+#include "../filter/bloom_filter.hpp"
+#include "../filter/hyperloglog.hpp"
+#include "../filter/xor_filter.hpp"
+#include "../graph/csr_graph.hpp"
+#include "../hash/flat_hash_map.hpp"
+#include "../search/eytzinger.hpp"
+#include "../search/static_tree.hpp"
+#include "../span.hpp"
+#include "../succinct/bitvector.hpp"
+#include "../succinct/elias_fano.hpp"
+#include "../succinct/wavelet_matrix.hpp"
+#include "index_file.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+
+inline std::string part(std::string_view name, char const* suffix) {
+  return std::string(name) + suffix;
+}
+
+struct graph_meta {
+  std::uint32_t weighted;
+  std::uint32_t symmetric;
+};
+
+struct bitvector_meta {
+  std::uint64_t size;
+  std::uint64_t ones;
+};
+
+struct elias_fano_meta {
+  std::uint64_t size;
+  std::uint64_t back;
+  std::uint32_t low_bits;
+  std::uint32_t unused;
+};
+
+struct table_meta {
+  std::uint64_t size;
+  std::uint64_t capacity;
+  std::uint32_t key_size;
+  std::uint32_t mapped_size;
+};
+
+struct xor_filter_meta {
+  std::uint64_t size;
+  std::uint64_t seed;
+  std::uint64_t segment_length;
+  std::uint64_t segment_count_length;
+  std::uint32_t fingerprint_size;
+  std::uint32_t layout;
+};
+
+struct hyperloglog_meta {
+  std::uint32_t precision;
+  std::uint32_t sparse;
+};
+
+// What a hash table slot is stored as: the element without the table's
+// slot union around it.
+template <class K, class V>
+struct map_entry {
+  K key;
+  V value;
+};
+
+// Reaches into the structures' private arrays; befriended by each of them.
+struct access {
+  template <class W>
+  static void save(index_writer& w, std::string_view name, csr_graph<W> const& g) {
+    w.add<edge_index>(part(name, ".offsets"), g.offsets_);
+    w.add<vertex_id>(part(name, ".targets"), g.targets_);
+    w.add<W>(part(name, ".weights"), g.weights_);
+    w.add_value(part(name, ".meta"), graph_meta{g.weighted_, g.symmetric_});
+  }
+
+  template <class W>
+  static csr_graph<W> load_graph(index_file const& f, std::string_view name) {
+    csr_graph<W> g;
+    g.offsets_.borrow(f.array<edge_index>(part(name, ".offsets")));
+    g.targets_.borrow(f.array<vertex_id>(part(name, ".targets")));
+    g.weights_.borrow(f.array<W>(part(name, ".weights")));
+    auto const& meta = f.value<graph_meta>(part(name, ".meta"));
+    g.weighted_ = meta.weighted != 0;
+    g.symmetric_ = meta.symmetric != 0;
+    if (g.offsets_.empty() || g.offsets_[g.offsets_.size() - 1] != g.targets_.size() ||
+        (g.weighted_ && g.weights_.size() != g.targets_.size()))
+      throw format_error(std::string(name) + ": inconsistent csr_graph sections");
+    return g;
+  }
+
+  template <class T>
+  static void save(index_writer& w, std::string_view name, static_search_tree<T> const& t) {
+    w.add<std::size_t>(part(name, ".offsets"), t.offsets_);
+    w.add<T>(part(name, ".tree"), t.tree_);
+    w.add_value<std::uint64_t>(part(name, ".size"), t.n_);
+  }
+
+  template <class T>
+  static static_search_tree<T> load_tree(index_file const& f, std::string_view name) {
+    static_search_tree<T> t;
+    t.offsets_.borrow(f.array<std::size_t>(part(name, ".offsets")));
+    t.tree_.borrow(f.array<T>(part(name, ".tree")));
+    t.n_ = static_cast<std::size_t>(f.value<std::uint64_t>(part(name, ".size")));
+    // Recompute the layer layout build() gives n_ keys; the lookups trust
+    // the offsets, so any other layout is rejected.
+    constexpr std::size_t B = static_search_tree<T>::node_keys;
+    bool ok = t.n_ <= t.tree_.size();
+    std::size_t blocks = std::max<std::size_t>(1, t.n_ / B + (t.n_ % B != 0));
+    std::size_t total = 0, h = 0;
+    for (; ok; ++h) {
+      ok = h < t.offsets_.size() && t.offsets_[h] == total;
+      total += blocks * B;
+      if (blocks == 1) break;
+      blocks = (blocks + B) / (B + 1);
+    }
+    if (!ok || h + 1 != t.offsets_.size() || total != t.tree_.size())
+      throw format_error(std::string(name) + ": inconsistent static_search_tree sections");
+    return t;
+  }
+
+  template <class T, class Rank>
+  static void save(index_writer& w, std::string_view name, eytzinger_index<T, Rank> const& e) {
+    w.add<T>(part(name, ".keys"), e.keys_);
+    w.add<Rank>(part(name, ".rank"), e.rank_);
+  }
+
+  template <class T, class Rank>
+  static eytzinger_index<T, Rank> load_eytzinger(index_file const& f, std::string_view name) {
+    eytzinger_index<T, Rank> e;
+    e.keys_.borrow(f.array<T>(part(name, ".keys")));
+    e.rank_.borrow(f.array<Rank>(part(name, ".rank")));
+    if (e.keys_.size() != e.rank_.size())
+      throw format_error(std::string(name) + ": inconsistent eytzinger_index sections");
+    e.n_ = e.keys_.empty() ? 0 : e.keys_.size() - 1;
+    return e;
+  }
+
+  static void save(index_writer& w, std::string_view name, rank_select_bitvector const& b) {
+    w.add<std::uint64_t>(part(name, ".words"), b.words_);
+    w.add<std::uint64_t>(part(name, ".chunks"), b.chunks_);
+    w.add<std::uint64_t>(part(name, ".entries"), b.entries_);
+    w.add<std::uint32_t>(part(name, ".samples1"), b.samples1_);
+    w.add<std::uint32_t>(part(name, ".samples0"), b.samples0_);
+    w.add_value(part(name, ".meta"), bitvector_meta{b.size_, b.ones_});
+  }
+
+  static rank_select_bitvector load_bitvector(index_file const& f, std::string_view name) {
+    using namespace detail::succinct;
+    rank_select_bitvector b;
+    b.words_.borrow(f.array<std::uint64_t>(part(name, ".words")));
+    b.chunks_.borrow(f.array<std::uint64_t>(part(name, ".chunks")));
+    b.entries_.borrow(f.array<std::uint64_t>(part(name, ".entries")));
+    b.samples1_.borrow(f.array<std::uint32_t>(part(name, ".samples1")));
+    b.samples0_.borrow(f.array<std::uint32_t>(part(name, ".samples0")));
+    auto const& meta = f.value<bitvector_meta>(part(name, ".meta"));
+    b.size_ = static_cast<std::size_t>(meta.size);
+    b.ones_ = static_cast<std::size_t>(meta.ones);
+    std::size_t const superblocks = b.size_ / superblock_bits + 1;
+    if (meta.ones > meta.size || b.words_.size() != superblocks * superblock_words ||
+        b.entries_.size() != superblocks ||
+        b.chunks_.size() != ((superblocks - 1) >> chunk_shift) + 1 ||
+        b.samples1_.size() != b.ones_ / select_sample + 2 ||
+        b.samples0_.size() != (b.size_ - b.ones_) / select_sample + 2)
+      throw format_error(std::string(name) + ": inconsistent rank_select_bitvector sections");
+    return b;
+  }
+
+  static void save(index_writer& w, std::string_view name, elias_fano const& e) {
+    w.add<std::uint64_t>(part(name, ".lows"), e.lows_);
+    save(w, part(name, ".high"), e.high_);
+    w.add_value(part(name, ".meta"), elias_fano_meta{e.n_, e.back_, e.low_bits_, 0});
+  }
+
+  static elias_fano load_elias_fano(index_file const& f, std::string_view name) {
+    elias_fano e;
+    e.lows_.borrow(f.array<std::uint64_t>(part(name, ".lows")));
+    e.high_ = load_bitvector(f, part(name, ".high"));
+    auto const& meta = f.value<elias_fano_meta>(part(name, ".meta"));
+    e.n_ = static_cast<std::size_t>(meta.size);
+    e.back_ = meta.back;
+    e.low_bits_ = meta.low_bits;
+    if (e.low_bits_ > 63 || e.lows_.size() != (e.n_ * e.low_bits_ + 63) / 64 ||
+        e.high_.count_ones() != e.n_ ||
+        (e.n_ && e.high_.size() != e.n_ + (e.back_ >> e.low_bits_) + 1))
+      throw format_error(std::string(name) + ": inconsistent elias_fano sections");
+    return e;
+  }
+
+  static void save(index_writer& w, std::string_view name, wavelet_matrix const& m) {
+    w.add<std::size_t>(part(name, ".zeros"), m.zeros_);
+    w.add_value<std::uint64_t>(part(name, ".size"), m.n_);
+    for (std::size_t l = 0; l < m.levels_.size(); ++l)
+      save(w, part(name, (".level" + std::to_string(l)).c_str()), m.levels_[l]);
+  }
+
+  static wavelet_matrix load_wavelet_matrix(index_file const& f, std::string_view name) {
+    wavelet_matrix m;
+    m.zeros_.borrow(f.array<std::size_t>(part(name, ".zeros")));
+    m.n_ = static_cast<std::size_t>(f.value<std::uint64_t>(part(name, ".size")));
+    if (m.zeros_.size() > 64)
+      throw format_error(std::string(name) + ": inconsistent wavelet_matrix sections");
+    for (std::size_t l = 0; l < m.zeros_.size(); ++l) {
+      m.levels_.push_back(load_bitvector(f, part(name, (".level" + std::to_string(l)).c_str())));
+      if (m.levels_[l].size() != m.n_ || m.levels_[l].count_zeros() != m.zeros_[l])
+        throw format_error(std::string(name) + ": inconsistent wavelet_matrix sections");
+    }
+    return m;
+  }
+
+  template <class K, class H>
+  static void save(index_writer& w, std::string_view name, blocked_bloom_filter<K, H> const& b) {
+    w.add<std::uint64_t>(part(name, ".words"), b.words_);
+  }
+
+  template <class K, class H>
+  static blocked_bloom_filter<K, H> load_bloom(index_file const& f, std::string_view name) {
+    blocked_bloom_filter<K, H> b;
+    b.words_.borrow(f.array<std::uint64_t>(part(name, ".words")));
+    if (b.words_.empty() || b.words_.size() % filter::block_words != 0)
+      throw format_error(std::string(name) + ": inconsistent blocked_bloom_filter sections");
+    return b;
+  }
+
+  template <class L, class K, class F, class H>
+  static void save(index_writer& w, std::string_view name,
+                   basic_xor_filter<L, K, F, H> const& x) {
+    w.add<F>(part(name, ".fp"), x.fingerprints_);
+    w.add_value(part(name, ".meta"),
+                xor_filter_meta{x.n_, x.seed_, x.shape_.segment_length,
+                                x.shape_.segment_count_length,
+                                static_cast<std::uint32_t>(sizeof(F)), L::id});
+  }
+
+  template <class L, class K, class F, class H>
+  static basic_xor_filter<L, K, F, H> load_xor_filter(index_file const& f,
+                                                       std::string_view name) {
+    basic_xor_filter<L, K, F, H> x;
+    x.fingerprints_.borrow(f.array<F>(part(name, ".fp")));
+    auto const& meta = f.value<xor_filter_meta>(part(name, ".meta"));
+    x.n_ = static_cast<std::size_t>(meta.size);
+    x.seed_ = meta.seed;
+    x.shape_ = L::make(x.n_);
+    if (meta.fingerprint_size != sizeof(F) || meta.layout != L::id ||
+        meta.segment_length != x.shape_.segment_length ||
+        meta.segment_count_length != x.shape_.segment_count_length ||
+        x.fingerprints_.size() != x.shape_.array_length)
+      throw format_error(std::string(name) + ": inconsistent " + L::name + " sections");
+    return x;
+  }
+
+  template <class K, class H>
+  static void save(index_writer& w, std::string_view name, hyperloglog<K, H> const& h) {
+    h.flush();
+    w.add<std::uint8_t>(part(name, ".registers"), h.registers_);
+    w.add<std::uint32_t>(part(name, ".sparse"), h.sparse_);
+    w.add_value(part(name, ".meta"), hyperloglog_meta{h.p_, h.is_sparse_});
+  }
+
+  template <class K, class H>
+  static hyperloglog<K, H> load_hyperloglog(index_file const& f, std::string_view name) {
+    auto const& meta = f.value<hyperloglog_meta>(part(name, ".meta"));
+    using counter = hyperloglog<K, H>;
+    if (meta.precision < counter::min_precision || meta.precision > counter::max_precision)
+      throw format_error(std::string(name) + ": inconsistent hyperloglog sections");
+    counter h(meta.precision);
+    h.registers_.borrow(f.array<std::uint8_t>(part(name, ".registers")));
+    h.sparse_.borrow(f.array<std::uint32_t>(part(name, ".sparse")));
+    h.is_sparse_ = meta.sparse != 0;
+    bool const ok = h.is_sparse_
+                        ? h.registers_.empty() && h.sparse_.size() <= h.sparse_limit() &&
+                              std::is_sorted(h.sparse_.begin(), h.sparse_.end())
+                        : h.registers_.size() == h.register_count() && h.sparse_.empty();
+    if (!ok) throw format_error(std::string(name) + ": inconsistent hyperloglog sections");
+    return h;
+  }
+
+  // Entry is map_entry<K, V> for maps and K for sets; `store` copies one
+  // element into a zeroed entry.
+  template <class Entry, class Table, class Store>
+  static void save_table(index_writer& w, std::string_view name, Table const& t,
+                         std::uint32_t mapped_size, Store store) {
+    using hash::group_width;
+    w.add<hash::ctrl_t>(part(name, ".ctrl"), t.ctrl_, t.capacity_ + group_width);
+    // Empty slots hold no element; they are written as zeros.
+    w.add_generated<Entry>(part(name, ".entries"), t.capacity_,
+                           [&](Entry* out, std::size_t first, std::size_t count) {
+                             std::memset(static_cast<void*>(out), 0, count * sizeof(Entry));
+                             for (std::size_t i = 0; i < count; ++i)
+                               if (hash::is_full(t.ctrl_[first + i]))
+                                 store(out[i], t.slots_[first + i].value);
+                           });
+    using key_type = typename Table::key_type;
+    w.add_value(part(name, ".meta"),
+                table_meta{t.size_, t.capacity_, sizeof(key_type), mapped_size});
+  }
+};
+
+// The probing half of raw_table, over stored control bytes and entries.
+template <class Entry, class Key, class Hash, class Eq, class KeyOf>
+class table_view {
+  using key_arg_select =
+      hash::key_arg_impl<hash::is_transparent<Hash>::value && hash::is_transparent<Eq>::value>;
+
+ protected:
+  template <class K>
+  using key_arg = typename key_arg_select::template type<K, Key>;
+
+ public:
+  table_view() = default;
+  table_view(index_file const& f, std::string_view name, std::uint32_t mapped_size,
+             Hash const& h, Eq const& eq)
+      : hash_(h), eq_(eq) {
+    ctrl_ = f.array<hash::ctrl_t>(part(name, ".ctrl"));
+    entries_ = f.array<Entry>(part(name, ".entries"));
+    auto const& meta = f.value<table_meta>(part(name, ".meta"));
+    size_ = static_cast<std::size_t>(meta.size);
+    capacity_ = static_cast<std::size_t>(meta.capacity);
+    if (meta.key_size != sizeof(Key) || meta.mapped_size != mapped_size ||
+        ((capacity_ + 1) & capacity_) != 0 || ctrl_.size() != capacity_ + hash::group_width ||
+        entries_.size() != capacity_ || size_ > capacity_)
+      throw format_error(std::string(name) + ": inconsistent hash table sections");
+  }
+
+  std::size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t capacity() const noexcept { return capacity_; }
+
+ protected:
+  // The matching entry, or nullptr.
+  template <class K>
+  Entry const* find_entry(K const& key) const {
+    if (capacity_ == 0) return nullptr;
+    std::size_t const h = hash::mix(hash_(key));
+    hash::probe_seq seq(h >> 7, capacity_);
+    for (;;) {
+      hash::group const g(ctrl_.data() + seq.offset());
+      for (std::uint32_t m = g.match(static_cast<std::uint8_t>(h & 0x7f)); m; m &= m - 1) {
+        std::size_t const i = seq.offset(static_cast<std::size_t>(countr_zero(m)));
+        if (ALGORITMI_LIKELY(eq_(KeyOf{}(entries_[i]), key))) return &entries_[i];
+      }
+      if (ALGORITMI_LIKELY(g.match_empty())) return nullptr;
+      seq.next();
+    }
+  }
+
+ private:
+  Hash hash_;
+  Eq eq_;
+  span<hash::ctrl_t const> ctrl_;
+  span<Entry const> entries_;
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+};
+
+struct entry_key {
+  template <class K, class V>
+  K const& operator()(map_entry<K, V> const& e) const noexcept {
+    return e.key;
+  }
+  template <class K>
+  K const& operator()(K const& k) const noexcept {
+    return k;
+  }
+};
+
+template <class X>
+struct loader;
+
+template <class W>
+struct loader<csr_graph<W>> {
+  static csr_graph<W> load(index_file const& f, std::string_view name) {
+    return access::load_graph<W>(f, name);
+  }
+};
+
+template <class T>
+struct loader<static_search_tree<T>> {
+  static static_search_tree<T> load(index_file const& f, std::string_view name) {
+    return access::load_tree<T>(f, name);
+  }
+};
+
+template <class T, class Rank>
+struct loader<eytzinger_index<T, Rank>> {
+  static eytzinger_index<T, Rank> load(index_file const& f, std::string_view name) {
+    return access::load_eytzinger<T, Rank>(f, name);
+  }
+};
+
+template <>
+struct loader<rank_select_bitvector> {
+  static rank_select_bitvector load(index_file const& f, std::string_view name) {
+    return access::load_bitvector(f, name);
+  }
+};
+
+template <>
+struct loader<elias_fano> {
+  static elias_fano load(index_file const& f, std::string_view name) {
+    return access::load_elias_fano(f, name);
+  }
+};
+
+template <>
+struct loader<wavelet_matrix> {
+  static wavelet_matrix load(index_file const& f, std::string_view name) {
+    return access::load_wavelet_matrix(f, name);
+  }
+};
+
+}  // namespace detail::persist
+
+// Read-only flat_hash_map over a mapped file. K and V must be trivially
+// copyable; Hash and Eq must be those the map was built with.
+template <class K, class V, class Hash = hash<K>, class Eq = std::equal_to<>>
+class flat_hash_map_view
+    : public detail::persist::table_view<detail::persist::map_entry<K, V>, K, Hash, Eq,
+                                         detail::persist::entry_key> {
+  using base = detail::persist::table_view<detail::persist::map_entry<K, V>, K, Hash, Eq,
+                                           detail::persist::entry_key>;
+  template <class Q>
+  using key_arg = typename base::template key_arg<Q>;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+
+  flat_hash_map_view() = default;
+  flat_hash_map_view(index_file const& f, std::string_view name, Hash const& h = Hash(),
+                     Eq const& eq = Eq())
+      : base(f, name, sizeof(V), h, eq) {}
+
+  // The value stored for key, or nullptr.
+  template <class Q = K>
+  V const* find(key_arg<Q> const& key) const {
+    auto const* e = this->find_entry(key);
+    return e ? &e->value : nullptr;
+  }
+  template <class Q = K>
+  bool contains(key_arg<Q> const& key) const {
+    return this->find_entry(key) != nullptr;
+  }
+};
+
+template <class K, class Hash = hash<K>, class Eq = std::equal_to<>>
+class flat_hash_set_view
+    : public detail::persist::table_view<K, K, Hash, Eq, detail::persist::entry_key> {
+  using base = detail::persist::table_view<K, K, Hash, Eq, detail::persist::entry_key>;
+  template <class Q>
+  using key_arg = typename base::template key_arg<Q>;
+
+ public:
+  using key_type = K;
+
+  flat_hash_set_view() = default;
+  flat_hash_set_view(index_file const& f, std::string_view name, Hash const& h = Hash(),
+                     Eq const& eq = Eq())
+      : base(f, name, 0, h, eq) {}
+
+  template <class Q = K>
+  bool contains(key_arg<Q> const& key) const {
+    return this->find_entry(key) != nullptr;
+  }
+};
+
+namespace detail::persist {
+
+template <class K, class H>
+struct loader<blocked_bloom_filter<K, H>> {
+  static blocked_bloom_filter<K, H> load(index_file const& f, std::string_view name) {
+    return access::load_bloom<K, H>(f, name);
+  }
+};
+
+template <class L, class K, class F, class H>
+struct loader<basic_xor_filter<L, K, F, H>> {
+  static basic_xor_filter<L, K, F, H> load(index_file const& f, std::string_view name) {
+    return access::load_xor_filter<L, K, F, H>(f, name);
+  }
+};
+
+template <class K, class H>
+struct loader<hyperloglog<K, H>> {
+  static hyperloglog<K, H> load(index_file const& f, std::string_view name) {
+    return access::load_hyperloglog<K, H>(f, name);
+  }
+};
+
+template <class K, class V, class Hash, class Eq>
+struct loader<flat_hash_map_view<K, V, Hash, Eq>> {
+  static flat_hash_map_view<K, V, Hash, Eq> load(index_file const& f, std::string_view name) {
+    return {f, name};
+  }
+};
+
+template <class K, class Hash, class Eq>
+struct loader<flat_hash_set_view<K, Hash, Eq>> {
+  static flat_hash_set_view<K, Hash, Eq> load(index_file const& f, std::string_view name) {
+    return {f, name};
+  }
+};
+
+}  // namespace detail::persist
+
+template <class W>
+void save(index_writer& w, std::string_view name, csr_graph<W> const& g) {
+  detail::persist::access::save(w, name, g);
+}
+
+template <class T>
+void save(index_writer& w, std::string_view name, static_search_tree<T> const& t) {
+  detail::persist::access::save(w, name, t);
+}
+
+template <class T, class Rank>
+void save(index_writer& w, std::string_view name, eytzinger_index<T, Rank> const& e) {
+  detail::persist::access::save(w, name, e);
+}
+
+inline void save(index_writer& w, std::string_view name, rank_select_bitvector const& b) {
+  detail::persist::access::save(w, name, b);
+}
+
+inline void save(index_writer& w, std::string_view name, elias_fano const& e) {
+  detail::persist::access::save(w, name, e);
+}
+
+inline void save(index_writer& w, std::string_view name, wavelet_matrix const& m) {
+  detail::persist::access::save(w, name, m);
+}
+
+template <class K, class H>
+void save(index_writer& w, std::string_view name, blocked_bloom_filter<K, H> const& b) {
+  detail::persist::access::save(w, name, b);
+}
+
+template <class L, class K, class F, class H>
+void save(index_writer& w, std::string_view name, basic_xor_filter<L, K, F, H> const& x) {
+  detail::persist::access::save(w, name, x);
+}
+
+// Saves the counter after folding in its pending updates.
+template <class K, class H>
+void save(index_writer& w, std::string_view name, hyperloglog<K, H> const& h) {
+  detail::persist::access::save(w, name, h);
+}
+
+template <class K, class V, class Hash, class Eq>
+void save(index_writer& w, std::string_view name, flat_hash_map<K, V, Hash, Eq> const& m) {
+  static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                "only maps of trivially copyable keys and values can be saved");
+  using entry = detail::persist::map_entry<K, V>;
+  detail::persist::access::save_table<entry>(w, name, m, sizeof(V),
+                                             [](entry& out, std::pair<K const, V> const& v) {
+                                               out.key = v.first;
+                                               out.value = v.second;
+                                             });
+}
+
+template <class K, class Hash, class Eq>
+void save(index_writer& w, std::string_view name, flat_hash_set<K, Hash, Eq> const& s) {
+  static_assert(std::is_trivially_copyable_v<K>,
+                "only sets of trivially copyable keys can be saved");
+  detail::persist::access::save_table<K>(w, name, s, 0, [](K& out, K const& k) { out = k; });
+}
+
+// The structure saved as `name`, using the file's memory: X is csr_graph<W>,
+// static_search_tree<T>, eytzinger_index<T, Rank>, rank_select_bitvector,
+// elias_fano, wavelet_matrix, blocked_bloom_filter<K>, xor_filter<K, F>,
+// binary_fuse_filter<K, F>, hyperloglog<K>, flat_hash_map_view or
+// flat_hash_set_view.
+// Throws format_error if the sections are missing or do not fit together.
+template <class X>
+X load(index_file const& f, std::string_view name) {
+  return detail::persist::loader<X>::load(f, name);
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,24 @@
+// Data-parallel building blocks over arrays.
+//
+//   inclusive_scan(in, n, out[, op])      out[i] = in[0] op ... op in[i]
+//   exclusive_scan(in, n, out[, init, op])
+//                                         out[i] = init op ... op in[i - 1];
+//                                         returns the total
+//   reduce(in, n[, init, op])             init op in[0] op ... op in[n - 1]
+//   compact(in, flags, n, out)            keeps in[i] where flags[i] != 0
+//   copy_if(in, n, out, pred)             keeps the elements satisfying pred
+//   stable_partition(data, n, pred)       matches first, both groups in order
+//   histogram(keys, n, bins[, bin_of])    pmr::vector of counts per bin
+//
+// Sums of 32/64-bit integers and compaction of 4/8-byte elements run SIMD
+// kernels picked at runtime like the search kernels (see cpu.hpp); overloads
+// taking an `isa` run a specific one. Overloads taking algoritmi::par split
+// the input into tiles and find each tile's offset with a single-pass
+// decoupled look-back scan (primitives/lookback.hpp).
+#pragma once
+
+#include "primitives/histogram.hpp"
+#include "primitives/kernels.hpp"
+#include "primitives/lookback.hpp"
+#include "primitives/partition.hpp"
+#include "primitives/scan.hpp"
@@ -0,0 +1,105 @@
+// Counting keys into bins.
+//
+// Consecutive equal keys make a single counter array stall on its own
+// increments (each waits for the previous store to retire), so up to 4096
+// bins are counted into four interleaved 32-bit sub-histograms that are
+// summed at the end. x86 has no SIMD scatter-increment short of AVX-512
+// conflict detection, so this is the fast single-thread kernel. The
+// parallel overload counts a chunk per thread and adds the tables up.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "lookback.hpp"
+
+namespace algoritmi {
+namespace detail::prims {
+
+struct identity_bin {
+  template <class T>
+  constexpr std::size_t operator()(T const& x) const noexcept {
+    return static_cast<std::size_t>(x);
+  }
+};
+
+inline constexpr std::size_t max_split_bins = 4096;
+// Elements per round of sub-histograms: no 32-bit counter can overflow.
+inline constexpr std::size_t split_round = std::size_t{1} << 31;
+
+template <class T, class BinFn>
+void add_counts(T const* keys, std::size_t n, std::size_t bins, BinFn& bin_of, std::size_t* counts,
+                std::pmr::memory_resource* mr) {
+  auto bin = [&](T const& key) {
+    std::size_t const b = static_cast<std::size_t>(bin_of(key));
+    assert(b < bins);
+    return b;
+  };
+  if (bins > max_split_bins || n < 4 * bins) {
+    for (std::size_t i = 0; i < n; ++i) ++counts[bin(keys[i])];
+    return;
+  }
+  scratch_buffer<std::uint32_t> sub(4 * bins, mr, cache_line_size);
+  std::uint32_t* const c0 = sub.get();
+  std::uint32_t* const c1 = c0 + bins;
+  std::uint32_t* const c2 = c1 + bins;
+  std::uint32_t* const c3 = c2 + bins;
+  for (std::size_t b = 0; b < n; b += split_round) {
+    std::size_t const end = n - b < split_round ? n : b + split_round;
+    std::fill(c0, c0 + 4 * bins, std::uint32_t{0});
+    std::size_t i = b;
+    for (; i + 4 <= end; i += 4) {
+      ++c0[bin(keys[i])];
+      ++c1[bin(keys[i + 1])];
+      ++c2[bin(keys[i + 2])];
+      ++c3[bin(keys[i + 3])];
+    }
+    for (; i < end; ++i) ++c0[bin(keys[i])];
+    for (std::size_t k = 0; k < bins; ++k)
+      counts[k] += std::size_t{c0[k]} + c1[k] + c2[k] + c3[k];
+  }
+}
+
+}  // namespace detail::prims
+
+// counts[k] = number of i with bin_of(keys[i]) == k, for k < bins. Every
+// key must map below bins. The default bin is the key itself.
+template <class T, class BinFn = detail::prims::identity_bin>
+std::pmr::vector<std::size_t> histogram(
+    T const* keys, std::size_t n, std::size_t bins, BinFn bin_of = {},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  std::pmr::vector<std::size_t> counts(bins, 0, mr);
+  detail::prims::add_counts(keys, n, bins, bin_of, counts.data(), mr);
+  return counts;
+}
+
+// Multi-threaded version: one table per thread, summed at the end.
+template <class T, class BinFn = detail::prims::identity_bin>
+std::pmr::vector<std::size_t> histogram(
+    parallel_policy policy, T const* keys, std::size_t n, std::size_t bins, BinFn bin_of = {},
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::prims::threads_for(policy, n);
+  if (threads <= 1) return histogram(keys, n, bins, std::move(bin_of), mr);
+  std::pmr::vector<std::size_t> local(threads * bins, 0, mr);
+  std::pmr::memory_resource* const task_mr = detail::task_resource(threads, mr);
+  detail::parallel_for(threads, threads, [&](std::size_t c) {
+    std::size_t const b = n * c / threads;
+    std::size_t const e = n * (c + 1) / threads;
+    BinFn fn = bin_of;
+    detail::prims::add_counts(keys + b, e - b, bins, fn, local.data() + c * bins, task_mr);
+  });
+  std::pmr::vector<std::size_t> counts(bins, 0, mr);
+  for (unsigned c = 0; c < threads; ++c)
+    for (std::size_t k = 0; k < bins; ++k) counts[k] += local[c * bins + k];
+  return counts;
+}
+
+}  // namespace algoritmi
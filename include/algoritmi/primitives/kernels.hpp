@@ -0,0 +1,389 @@
+// Single-thread kernels behind the parallel primitives, one version per
+// instruction set, selected like the search kernels (see cpu.hpp).
+//
+//   reduce_add     sum of 32/64-bit integers, four vector accumulators
+//   inclusive_add  prefix sums: log2(lanes) shift-and-add steps inside a
+//   exclusive_add  vector, then the running carry broadcast from its last lane
+//   compact        keeps the words whose flag byte is non-zero: the flags of
+//                  8 (or 4) words form a mask that indexes a permutation
+//                  table, the permuted vector is written with a masked store
+//
+// Integer sums wrap, as unsigned arithmetic does; the scalar versions
+// compute in the unsigned type for the same result. Compaction only has
+// an AVX2 version (SSE4.2 has no variable cross-lane permute or masked
+// store), so the SSE4.2 entry is the scalar one.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::prims {
+
+template <class T>
+inline constexpr bool simd_int_v = std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                   (sizeof(T) == 4 || sizeof(T) == 8);
+
+// ---------------------------------------------------------------- scalar --
+
+template <class T>
+T reduce_add_scalar(T const* p, std::size_t n, T init) noexcept {
+  using U = std::make_unsigned_t<T>;
+  U a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    a0 += static_cast<U>(p[i]);
+    a1 += static_cast<U>(p[i + 1]);
+    a2 += static_cast<U>(p[i + 2]);
+    a3 += static_cast<U>(p[i + 3]);
+  }
+  for (; i < n; ++i) a0 += static_cast<U>(p[i]);
+  return static_cast<T>(static_cast<U>(init) + a0 + a1 + a2 + a3);
+}
+
+template <class T>
+T inclusive_add_scalar(T const* in, std::size_t n, T* out, T carry) noexcept {
+  using U = std::make_unsigned_t<T>;
+  U c = static_cast<U>(carry);
+  for (std::size_t i = 0; i < n; ++i) {
+    c += static_cast<U>(in[i]);
+    out[i] = static_cast<T>(c);
+  }
+  return static_cast<T>(c);
+}
+
+template <class T>
+T exclusive_add_scalar(T const* in, std::size_t n, T* out, T carry) noexcept {
+  using U = std::make_unsigned_t<T>;
+  U c = static_cast<U>(carry);
+  for (std::size_t i = 0; i < n; ++i) {
+    U const x = static_cast<U>(in[i]);
+    out[i] = static_cast<T>(c);
+    c += x;
+  }
+  return static_cast<T>(c);
+}
+
+template <class W>
+std::size_t compact_scalar(W const* in, std::uint8_t const* flags, std::size_t n,
+                           W* out) noexcept {
+  // memcpy: the words may be the bytes of floats or small structs.
+  std::size_t w = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    if (flags[i]) std::memcpy(out + w++, in + i, sizeof(W));
+  return w;
+}
+
+#if ALGORITMI_HAS_SIMD
+
+// Permutation tables for compaction: entry m lists, one byte per 32-bit
+// lane, the lanes whose bit is set in m, packed to the front.
+constexpr std::array<std::uint64_t, 256> make_compact_lut32() noexcept {
+  std::array<std::uint64_t, 256> lut{};
+  for (unsigned m = 0; m < 256; ++m) {
+    std::uint64_t e = 0;
+    unsigned k = 0;
+    for (unsigned lane = 0; lane < 8; ++lane)
+      if (m >> lane & 1) e |= std::uint64_t{lane} << (8 * k++);
+    lut[m] = e;
+  }
+  return lut;
+}
+// Same for 64-bit lanes, as pairs of 32-bit lane indices.
+constexpr std::array<std::uint64_t, 16> make_compact_lut64() noexcept {
+  std::array<std::uint64_t, 16> lut{};
+  for (unsigned m = 0; m < 16; ++m) {
+    std::uint64_t e = 0;
+    unsigned k = 0;
+    for (unsigned lane = 0; lane < 4; ++lane)
+      if (m >> lane & 1) {
+        e |= std::uint64_t{2 * lane} << (8 * k++);
+        e |= std::uint64_t{2 * lane + 1} << (8 * k++);
+      }
+    lut[m] = e;
+  }
+  return lut;
+}
+inline constexpr std::array<std::uint64_t, 256> compact_lut32 = make_compact_lut32();
+inline constexpr std::array<std::uint64_t, 16> compact_lut64 = make_compact_lut64();
+
+// ---------------------------------------------------------------- SSE4.2 --
+
+template <std::size_t Width>
+struct sse_int_ops;
+
+template <>
+struct sse_int_ops<4> {
+  using vec = __m128i;
+  static constexpr std::size_t lanes = 4;
+  ALGORITMI_TARGET_SSE42 static vec zero() { return _mm_setzero_si128(); }
+  ALGORITMI_TARGET_SSE42 static vec load(void const* p) {
+    return _mm_loadu_si128(static_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static void store(void* p, vec v) {
+    _mm_storeu_si128(static_cast<__m128i*>(p), v);
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::uint64_t x) {
+    return _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(x)));
+  }
+  ALGORITMI_TARGET_SSE42 static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+  ALGORITMI_TARGET_SSE42 static vec sub(vec a, vec b) { return _mm_sub_epi32(a, b); }
+  ALGORITMI_TARGET_SSE42 static vec prefix(vec x) {
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+  }
+  ALGORITMI_TARGET_SSE42 static vec last(vec x) { return _mm_shuffle_epi32(x, 0xff); }
+};
+
+template <>
+struct sse_int_ops<8> {
+  using vec = __m128i;
+  static constexpr std::size_t lanes = 2;
+  ALGORITMI_TARGET_SSE42 static vec zero() { return _mm_setzero_si128(); }
+  ALGORITMI_TARGET_SSE42 static vec load(void const* p) {
+    return _mm_loadu_si128(static_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static void store(void* p, vec v) {
+    _mm_storeu_si128(static_cast<__m128i*>(p), v);
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::uint64_t x) {
+    return _mm_set1_epi64x(static_cast<long long>(x));
+  }
+  ALGORITMI_TARGET_SSE42 static vec add(vec a, vec b) { return _mm_add_epi64(a, b); }
+  ALGORITMI_TARGET_SSE42 static vec sub(vec a, vec b) { return _mm_sub_epi64(a, b); }
+  ALGORITMI_TARGET_SSE42 static vec prefix(vec x) {
+    return _mm_add_epi64(x, _mm_slli_si128(x, 8));
+  }
+  ALGORITMI_TARGET_SSE42 static vec last(vec x) { return _mm_unpackhi_epi64(x, x); }
+};
+
+// ------------------------------------------------------------------ AVX2 --
+
+template <std::size_t Width>
+struct avx2_int_ops;
+
+template <>
+struct avx2_int_ops<4> {
+  using vec = __m256i;
+  static constexpr std::size_t lanes = 8;
+  ALGORITMI_TARGET_AVX2 static vec zero() { return _mm256_setzero_si256(); }
+  ALGORITMI_TARGET_AVX2 static vec load(void const* p) {
+    return _mm256_loadu_si256(static_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static void store(void* p, vec v) {
+    _mm256_storeu_si256(static_cast<__m256i*>(p), v);
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::uint64_t x) {
+    return _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(x)));
+  }
+  ALGORITMI_TARGET_AVX2 static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+  ALGORITMI_TARGET_AVX2 static vec sub(vec a, vec b) { return _mm256_sub_epi32(a, b); }
+  // Scans each 128-bit half, then adds the low half's total to the high one.
+  ALGORITMI_TARGET_AVX2 static vec prefix(vec x) {
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    vec const low_total = _mm256_shuffle_epi32(x, 0xff);
+    return _mm256_add_epi32(x, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+  }
+  ALGORITMI_TARGET_AVX2 static vec last(vec x) {
+    return _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+  }
+};
+
+template <>
+struct avx2_int_ops<8> {
+  using vec = __m256i;
+  static constexpr std::size_t lanes = 4;
+  ALGORITMI_TARGET_AVX2 static vec zero() { return _mm256_setzero_si256(); }
+  ALGORITMI_TARGET_AVX2 static vec load(void const* p) {
+    return _mm256_loadu_si256(static_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static void store(void* p, vec v) {
+    _mm256_storeu_si256(static_cast<__m256i*>(p), v);
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::uint64_t x) {
+    return _mm256_set1_epi64x(static_cast<long long>(x));
+  }
+  ALGORITMI_TARGET_AVX2 static vec add(vec a, vec b) { return _mm256_add_epi64(a, b); }
+  ALGORITMI_TARGET_AVX2 static vec sub(vec a, vec b) { return _mm256_sub_epi64(a, b); }
+  ALGORITMI_TARGET_AVX2 static vec prefix(vec x) {
+    x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+    vec const low_total = _mm256_shuffle_epi32(x, 0xee);
+    return _mm256_add_epi64(x, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+  }
+  ALGORITMI_TARGET_AVX2 static vec last(vec x) { return _mm256_permute4x64_epi64(x, 0xff); }
+};
+
+// Kernel bodies, instantiated once per target. The vector loops work on the
+// bit patterns; the scalar head and tail use the unsigned type.
+#define ALGORITMI_PRIMITIVE_KERNELS(TARGET, SUFFIX, OPS)                                 \
+  template <class T>                                                                     \
+  TARGET T reduce_add_##SUFFIX(T const* p, std::size_t n, T init) noexcept {             \
+    using ops = OPS<sizeof(T)>;                                                          \
+    using U = std::make_unsigned_t<T>;                                                   \
+    constexpr std::size_t L = ops::lanes;                                                \
+    auto a0 = ops::zero(), a1 = ops::zero(), a2 = ops::zero(), a3 = ops::zero();         \
+    std::size_t i = 0;                                                                   \
+    for (; i + 4 * L <= n; i += 4 * L) {                                                 \
+      a0 = ops::add(a0, ops::load(p + i));                                               \
+      a1 = ops::add(a1, ops::load(p + i + L));                                           \
+      a2 = ops::add(a2, ops::load(p + i + 2 * L));                                       \
+      a3 = ops::add(a3, ops::load(p + i + 3 * L));                                       \
+    }                                                                                    \
+    for (; i + L <= n; i += L) a0 = ops::add(a0, ops::load(p + i));                      \
+    a0 = ops::add(ops::add(a0, a1), ops::add(a2, a3));                                   \
+    U lanes[L];                                                                          \
+    ops::store(lanes, a0);                                                               \
+    U s = static_cast<U>(init);                                                          \
+    for (std::size_t j = 0; j < L; ++j) s += lanes[j];                                   \
+    for (; i < n; ++i) s += static_cast<U>(p[i]);                                        \
+    return static_cast<T>(s);                                                            \
+  }                                                                                      \
+                                                                                         \
+  template <class T>                                                                     \
+  TARGET T inclusive_add_##SUFFIX(T const* in, std::size_t n, T* out, T carry) noexcept { \
+    using ops = OPS<sizeof(T)>;                                                          \
+    constexpr std::size_t L = ops::lanes;                                                \
+    auto c = ops::set1(static_cast<std::uint64_t>(carry));                               \
+    std::size_t i = 0;                                                                   \
+    for (; i + L <= n; i += L) {                                                         \
+      auto const x = ops::add(ops::prefix(ops::load(in + i)), c);                        \
+      ops::store(out + i, x);                                                            \
+      c = ops::last(x);                                                                  \
+    }                                                                                    \
+    T lanes[L];                                                                          \
+    ops::store(lanes, c);                                                                \
+    return inclusive_add_scalar(in + i, n - i, out + i, lanes[0]);                       \
+  }                                                                                      \
+                                                                                         \
+  template <class T>                                                                     \
+  TARGET T exclusive_add_##SUFFIX(T const* in, std::size_t n, T* out, T carry) noexcept { \
+    using ops = OPS<sizeof(T)>;                                                          \
+    constexpr std::size_t L = ops::lanes;                                                \
+    auto c = ops::set1(static_cast<std::uint64_t>(carry));                               \
+    std::size_t i = 0;                                                                   \
+    for (; i + L <= n; i += L) {                                                         \
+      auto const v = ops::load(in + i);                                                  \
+      auto const x = ops::add(ops::prefix(v), c);                                        \
+      ops::store(out + i, ops::sub(x, v));                                               \
+      c = ops::last(x);                                                                  \
+    }                                                                                    \
+    T lanes[L];                                                                          \
+    ops::store(lanes, c);                                                                \
+    return exclusive_add_scalar(in + i, n - i, out + i, lanes[0]);                       \
+  }
+
+ALGORITMI_PRIMITIVE_KERNELS(ALGORITMI_TARGET_SSE42, sse42, sse_int_ops)
+ALGORITMI_PRIMITIVE_KERNELS(ALGORITMI_TARGET_AVX2, avx2, avx2_int_ops)
+
+#undef ALGORITMI_PRIMITIVE_KERNELS
+
+// The masked store writes only the kept lanes, so compaction may run in
+// place (out <= in) and never writes past the last kept element.
+ALGORITMI_TARGET_AVX2 inline std::size_t compact_avx2(std::uint32_t const* in,
+                                                      std::uint8_t const* flags, std::size_t n,
+                                                      std::uint32_t* out) noexcept {
+  __m256i const lane_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  std::size_t w = 0, i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i const f = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(flags + i));
+    unsigned const m =
+        ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(f, _mm_setzero_si128()))) & 0xff;
+    __m256i const idx =
+        _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(compact_lut32[m])));
+    __m256i const packed = _mm256_permutevar8x32_epi32(
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i)), idx);
+    int const c = popcount(m);
+    _mm256_maskstore_epi32(reinterpret_cast<int*>(out + w),
+                           _mm256_cmpgt_epi32(_mm256_set1_epi32(c), lane_index), packed);
+    w += static_cast<std::size_t>(c);
+  }
+  return w + compact_scalar(in + i, flags + i, n - i, out + w);
+}
+
+ALGORITMI_TARGET_AVX2 inline std::size_t compact_avx2(std::uint64_t const* in,
+                                                      std::uint8_t const* flags, std::size_t n,
+                                                      std::uint64_t* out) noexcept {
+  __m256i const lane_index = _mm256_setr_epi64x(0, 1, 2, 3);
+  std::size_t w = 0, i = 0;
+  for (; i + 4 <= n; i += 4) {
+    std::uint32_t f;
+    std::memcpy(&f, flags + i, 4);
+    __m128i const zero = _mm_cmpeq_epi8(_mm_cvtsi32_si128(static_cast<int>(f)), _mm_setzero_si128());
+    unsigned const m = ~static_cast<unsigned>(_mm_movemask_epi8(zero)) & 0xf;
+    __m256i const idx =
+        _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(compact_lut64[m])));
+    __m256i const packed = _mm256_permutevar8x32_epi32(
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i)), idx);
+    int const c = popcount(m);
+    _mm256_maskstore_epi64(reinterpret_cast<long long*>(out + w),
+                           _mm256_cmpgt_epi64(_mm256_set1_epi64x(c), lane_index), packed);
+    w += static_cast<std::size_t>(c);
+  }
+  return w + compact_scalar(in + i, flags + i, n - i, out + w);
+}
+
+#endif  // ALGORITMI_HAS_SIMD
+
+// Function table for one integer type, resolved for a given instruction set.
+template <class T>
+struct kernel_table {
+  T (*reduce_add)(T const*, std::size_t, T) noexcept;
+  T (*inclusive_add)(T const*, std::size_t, T*, T) noexcept;
+  T (*exclusive_add)(T const*, std::size_t, T*, T) noexcept;
+};
+
+template <class T>
+kernel_table<T> make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  switch (usable_isa(which)) {
+    case isa::avx2:
+      return {&reduce_add_avx2<T>, &inclusive_add_avx2<T>, &exclusive_add_avx2<T>};
+    case isa::sse42:
+      return {&reduce_add_sse42<T>, &inclusive_add_sse42<T>, &exclusive_add_sse42<T>};
+    default:
+      break;
+  }
+#else
+  (void)which;
+#endif
+  return {&reduce_add_scalar<T>, &inclusive_add_scalar<T>, &exclusive_add_scalar<T>};
+}
+
+template <class T>
+kernel_table<T> const& kernels() noexcept {
+  static kernel_table<T> const table = make_kernel_table<T>(active_isa());
+  return table;
+}
+
+// Compaction of W-bit words (W = uint32_t or uint64_t).
+template <class W>
+using compact_fn = std::size_t (*)(W const*, std::uint8_t const*, std::size_t, W*) noexcept;
+
+template <class W>
+compact_fn<W> make_compact(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  if (usable_isa(which) == isa::avx2) return static_cast<compact_fn<W>>(&compact_avx2);
+#else
+  (void)which;
+#endif
+  return &compact_scalar<W>;
+}
+
+template <class W>
+compact_fn<W> compact_kernel() noexcept {
+  static compact_fn<W> const fn = make_compact<W>(active_isa());
+  return fn;
+}
+
+}  // namespace algoritmi::detail::prims
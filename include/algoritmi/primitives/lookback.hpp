@@ -0,0 +1,123 @@
+// Single-pass chunked scan with decoupled look-back (Merrill & Garland,
+// "Single-pass Parallel Prefix Scan with Decoupled Look-back", 2016).
+//
+// The input is cut into tiles that workers claim in increasing order. A
+// tile first publishes its own aggregate, then walks back over its
+// predecessors, combining their aggregates until it meets one that has
+// already published its inclusive prefix. It publishes its own inclusive
+// prefix as soon as it knows it, before doing its local work, so the
+// walks stay short. Every element is read from memory once and written
+// once; the second read of a tile comes from cache.
+//
+// Tiles are claimed in order and each tile publishes its aggregate before
+// it waits on anything, so a walk only ever waits on tiles that are being
+// worked on: there is no deadlock, whatever the thread count.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "../config.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+
+namespace algoritmi::detail::prims {
+
+// Elements per tile: large enough that the look-back costs nothing per
+// element, small enough that a tile is still in L2 for its second pass.
+inline constexpr std::size_t tile_size = std::size_t{1} << 16;
+
+// Inputs below this size run on the calling thread.
+inline constexpr std::size_t parallel_threshold = std::size_t{1} << 18;
+
+inline std::size_t tile_count(std::size_t n) noexcept { return (n + tile_size - 1) / tile_size; }
+
+// Worker threads for n elements under `policy`: 1 means run sequentially.
+inline unsigned threads_for(parallel_policy policy, std::size_t n) {
+  unsigned const threads = resolve_threads(policy.threads);
+  if (threads <= 1 || n < parallel_threshold) return 1;
+  std::size_t const tiles = tile_count(n);
+  return tiles < threads ? static_cast<unsigned>(tiles) : threads;
+}
+
+template <class T>
+struct alignas(cache_line_size) tile_status {
+  static constexpr std::uint8_t pending = 0, aggregate_ready = 1, prefix_ready = 2;
+  std::atomic<std::uint8_t> state;
+  T aggregate;  // written before state = aggregate_ready
+  T inclusive;  // written before state = prefix_ready
+};
+
+// Thrown inside a worker whose look-back can no longer finish because
+// another tile failed; the failing tile's own exception is the one reported.
+struct lookback_aborted {};
+
+// Calls tile_fn(worker, tile, prefix_of) for every tile in [0, tiles).
+// tile_fn computes the tile's aggregate, calls prefix_of(aggregate) exactly
+// once and gets back the combined aggregate of all earlier tiles (nullopt
+// for tile 0), then finishes the tile. `worker` is in [0, threads), for
+// per-worker scratch space. op must be associative; it is never assumed to
+// be commutative.
+template <class T, class Op, class TileFn>
+void lookback_scan(std::size_t tiles, unsigned threads, Op&& op, TileFn&& tile_fn,
+                   std::pmr::memory_resource* mr) {
+  using status = tile_status<T>;
+  scratch_buffer<status> st(tiles, mr, alignof(status));
+  for (std::size_t t = 0; t < tiles; ++t)
+    st[t].state.store(status::pending, std::memory_order_relaxed);
+  std::atomic<std::size_t> next{0};
+  std::atomic<bool> failed{false};
+
+  auto wait = [&](std::size_t j) {
+    std::uint8_t s;
+    for (unsigned spins = 0; (s = st[j].state.load(std::memory_order_acquire)) == status::pending;
+         ++spins) {
+      if (failed.load(std::memory_order_relaxed)) throw lookback_aborted{};
+      if (spins >= 64) std::this_thread::yield();
+    }
+    return s;
+  };
+
+  parallel_for(threads, threads, [&](std::size_t worker) {
+    try {
+      for (;;) {
+        std::size_t const t = next.fetch_add(1, std::memory_order_relaxed);
+        if (t >= tiles || failed.load(std::memory_order_relaxed)) return;
+        auto prefix_of = [&, t](T const& aggregate) -> std::optional<T> {
+          status& self = st[t];
+          if (t == 0) {
+            self.inclusive = aggregate;
+            self.state.store(status::prefix_ready, std::memory_order_release);
+            return std::nullopt;
+          }
+          self.aggregate = aggregate;
+          self.state.store(status::aggregate_ready, std::memory_order_release);
+          std::size_t j = t - 1;
+          std::uint8_t s = wait(j);
+          T prefix = s == status::prefix_ready ? st[j].inclusive : st[j].aggregate;
+          while (s != status::prefix_ready) {
+            s = wait(--j);
+            prefix = op(s == status::prefix_ready ? st[j].inclusive : st[j].aggregate, prefix);
+          }
+          self.inclusive = op(prefix, aggregate);
+          self.state.store(status::prefix_ready, std::memory_order_release);
+          return prefix;
+        };
+        tile_fn(static_cast<unsigned>(worker), t, prefix_of);
+      }
+    } catch (lookback_aborted const&) {
+      return;
+    } catch (...) {
+      failed.store(true, std::memory_order_relaxed);
+      throw;
+    }
+  });
+}
+
+}  // namespace algoritmi::detail::prims
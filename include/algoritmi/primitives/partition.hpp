@@ -0,0 +1,258 @@
+// Stream compaction and stable partition.
+//
+// Predicates are evaluated a block at a time into flag bytes, then the
+// flags drive the compaction kernel, so the data movement has no
+// data-dependent branch. Trivially copyable 4- and 8-byte elements use the
+// AVX2 kernel; other trivially copyable types a scalar loop. The parallel
+// overloads find each tile's output offset with the decoupled look-back
+// scan over match counts.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include "../cpu.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "kernels.hpp"
+#include "lookback.hpp"
+
+namespace algoritmi {
+namespace detail::prims {
+
+template <class T>
+inline constexpr bool compact_kernel_v =
+    std::is_trivially_copyable_v<T> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+template <class T>
+using word_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+// Flags evaluated per block on the sequential path.
+inline constexpr std::size_t flag_block = 512;
+
+template <class T>
+std::size_t compact_with(compact_fn<word_t<T>> fn, T const* in, std::uint8_t const* flags,
+                         std::size_t n, T* out) noexcept {
+  using W = word_t<T>;
+  return fn(reinterpret_cast<W const*>(in), flags, n, reinterpret_cast<W*>(out));
+}
+
+// Keeps in[i] where flags[i] != 0; out may be in.
+template <class T>
+std::size_t compact_flags(T const* in, std::uint8_t const* flags, std::size_t n, T* out) {
+  if constexpr (compact_kernel_v<T>) {
+    return compact_with(compact_kernel<word_t<T>>(), in, flags, n, out);
+  } else {
+    std::size_t w = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      if (flags[i]) out[w++] = in[i];
+    return w;
+  }
+}
+
+template <class T, class Pred>
+std::size_t eval_flags(T const* in, std::size_t n, Pred& pred, std::uint8_t* flags) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    bool const keep = static_cast<bool>(pred(in[i]));
+    flags[i] = keep;
+    count += keep;
+  }
+  return count;
+}
+
+inline void invert_flags(std::uint8_t* flags, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) flags[i] = !flags[i];
+}
+
+inline std::size_t count_flags(std::uint8_t const* flags, std::size_t n) noexcept {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) count += flags[i] != 0;
+  return count;
+}
+
+struct tile_range {
+  std::size_t begin, size;
+};
+
+inline tile_range tile_of(std::size_t t, std::size_t n) noexcept {
+  std::size_t const b = t * tile_size;
+  return {b, n - b < tile_size ? n - b : tile_size};
+}
+
+template <class T>
+std::size_t parallel_compact(T const* in, std::uint8_t const* flags, std::size_t n, T* out,
+                             unsigned threads, std::pmr::memory_resource* mr) {
+  std::size_t total = 0;
+  lookback_scan<std::size_t>(
+      tile_count(n), threads, std::plus<>(),
+      [&](unsigned, std::size_t t, auto&& prefix_of) {
+        tile_range const r = tile_of(t, n);
+        std::size_t const count = count_flags(flags + r.begin, r.size);
+        std::size_t const before = prefix_of(count).value_or(0);
+        compact_flags(in + r.begin, flags + r.begin, r.size, out + before);
+        if (r.begin + r.size == n) total = before + count;
+      },
+      mr);
+  return total;
+}
+
+template <class T, class Pred>
+std::size_t parallel_copy_if(T const* in, std::size_t n, T* out, Pred& pred, unsigned threads,
+                             std::pmr::memory_resource* mr) {
+  scratch_buffer<std::uint8_t> flags(threads * tile_size, mr, cache_line_size);
+  std::size_t total = 0;
+  lookback_scan<std::size_t>(
+      tile_count(n), threads, std::plus<>(),
+      [&](unsigned worker, std::size_t t, auto&& prefix_of) {
+        tile_range const r = tile_of(t, n);
+        std::uint8_t* const f = flags.get() + worker * tile_size;
+        std::size_t const count = eval_flags(in + r.begin, r.size, pred, f);
+        std::size_t const before = prefix_of(count).value_or(0);
+        compact_flags(in + r.begin, f, r.size, out + before);
+        if (r.begin + r.size == n) total = before + count;
+      },
+      mr);
+  return total;
+}
+
+// Each tile sends its matches to tmp[before, ...) and its non-matches to a
+// block at the back of tmp, tiles in reverse order, since the final start
+// of the non-matches is only known once every tile is done. A second pass
+// copies both back.
+template <class T, class Pred>
+std::size_t parallel_stable_partition(T* data, std::size_t n, Pred& pred, unsigned threads,
+                                      std::pmr::memory_resource* mr) {
+  std::size_t const tiles = tile_count(n);
+  scratch_buffer<T> tmp(n, mr, cache_line_size);
+  scratch_buffer<std::uint8_t> flags(threads * tile_size, mr, cache_line_size);
+  scratch_buffer<std::size_t> matches_before(tiles, mr);
+  std::size_t total = 0;
+  lookback_scan<std::size_t>(
+      tiles, threads, std::plus<>(),
+      [&](unsigned worker, std::size_t t, auto&& prefix_of) {
+        tile_range const r = tile_of(t, n);
+        std::uint8_t* const f = flags.get() + worker * tile_size;
+        std::size_t const count = eval_flags(data + r.begin, r.size, pred, f);
+        std::size_t const before = prefix_of(count).value_or(0);
+        matches_before[t] = before;
+        compact_flags(data + r.begin, f, r.size, tmp.get() + before);
+        invert_flags(f, r.size);
+        std::size_t const rest_end = n - (r.begin - before);
+        compact_flags(data + r.begin, f, r.size, tmp.get() + rest_end - (r.size - count));
+        if (r.begin + r.size == n) total = before + count;
+      },
+      mr);
+  parallel_for(tiles, threads, [&](std::size_t t) {
+    tile_range const r = tile_of(t, n);
+    std::size_t const before = matches_before[t];
+    std::size_t const count = (t + 1 < tiles ? matches_before[t + 1] : total) - before;
+    std::size_t const rest = r.size - count;
+    std::size_t const rest_before = r.begin - before;
+    std::copy_n(tmp.get() + before, count, data + before);
+    std::copy_n(tmp.get() + (n - rest_before - rest), rest, data + total + rest_before);
+  });
+  return total;
+}
+
+}  // namespace detail::prims
+
+// Copies in[i] where flags[i] != 0 to out, in order; returns how many. out
+// needs room for that many only, and may be in.
+template <class T>
+std::size_t compact(T const* in, std::uint8_t const* flags, std::size_t n, T* out) {
+  return detail::prims::compact_flags(in, flags, n, out);
+}
+
+// Copies the elements satisfying pred to out, in order; returns how many.
+template <class T, class Pred>
+std::size_t copy_if(T const* in, std::size_t n, T* out, Pred pred) {
+  constexpr std::size_t B = detail::prims::flag_block;
+  std::uint8_t flags[B];
+  std::size_t w = 0;
+  for (std::size_t b = 0; b < n; b += B) {
+    std::size_t const len = n - b < B ? n - b : B;
+    detail::prims::eval_flags(in + b, len, pred, flags);
+    w += detail::prims::compact_flags(in + b, flags, len, out + w);
+  }
+  return w;
+}
+
+// Reorders data so the elements satisfying pred come first, both groups
+// keeping their relative order; returns the number satisfying pred.
+// Trivially copyable types use the flag kernels with up to n elements of
+// scratch from mr; others go to std::stable_partition.
+template <class T, class Pred>
+std::size_t stable_partition(T* data, std::size_t n, Pred pred,
+                             std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  if constexpr (!std::is_trivially_copyable_v<T>) {
+    (void)mr;
+    return static_cast<std::size_t>(std::stable_partition(data, data + n, pred) - data);
+  } else {
+    constexpr std::size_t B = detail::prims::flag_block;
+    detail::scratch_buffer<T> rest(n, mr);
+    std::uint8_t flags[B];
+    std::size_t w = 0, r = 0;
+    for (std::size_t b = 0; b < n; b += B) {
+      std::size_t const len = n - b < B ? n - b : B;
+      detail::prims::eval_flags(data + b, len, pred, flags);
+      // Matches compact in place over elements already read, so the block's
+      // non-matches are saved first.
+      detail::prims::invert_flags(flags, len);
+      r += detail::prims::compact_flags(data + b, flags, len, rest.get() + r);
+      detail::prims::invert_flags(flags, len);
+      w += detail::prims::compact_flags(data + b, flags, len, data + w);
+    }
+    std::copy_n(rest.get(), r, data + w);
+    return w;
+  }
+}
+
+template <class T>
+std::size_t compact(isa which, T const* in, std::uint8_t const* flags, std::size_t n,
+                    T* out) noexcept {
+  static_assert(detail::prims::compact_kernel_v<T>,
+                "isa overloads take trivially copyable 4- or 8-byte elements");
+  using W = detail::prims::word_t<T>;
+  return detail::prims::compact_with(detail::prims::make_compact<W>(which), in, flags, n, out);
+}
+
+// Multi-threaded versions; sequential below a few hundred thousand
+// elements. In these the output of a tile starts where the look-back says,
+// so out must not overlap in.
+template <class T>
+std::size_t compact(parallel_policy policy, T const* in, std::uint8_t const* flags, std::size_t n,
+                    T* out, std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::prims::threads_for(policy, n);
+  if (threads <= 1) return compact(in, flags, n, out);
+  return detail::prims::parallel_compact(in, flags, n, out, threads, mr);
+}
+
+template <class T, class Pred>
+std::size_t copy_if(parallel_policy policy, T const* in, std::size_t n, T* out, Pred pred,
+                    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::prims::threads_for(policy, n);
+  if (threads <= 1) return copy_if(in, n, out, std::move(pred));
+  return detail::prims::parallel_copy_if(in, n, out, pred, threads, mr);
+}
+
+// Uses n elements of scratch plus a tile of flags per thread from mr.
+template <class T, class Pred>
+std::size_t stable_partition(parallel_policy policy, T* data, std::size_t n, Pred pred,
+                             std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    unsigned const threads = detail::prims::threads_for(policy, n);
+    if (threads > 1) return detail::prims::parallel_stable_partition(data, n, pred, threads, mr);
+  } else {
+    (void)policy;
+  }
+  return stable_partition(data, n, std::move(pred), mr);
+}
+
+}  // namespace algoritmi
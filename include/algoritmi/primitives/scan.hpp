@@ -0,0 +1,225 @@
+// Prefix sums and reductions over arrays.
+//
+// Sums (std::plus) of 32/64-bit integers run the SIMD kernels; any other
+// associative op runs a scalar loop. The parallel overloads use the
+// decoupled look-back scan in lookback.hpp and apply op in input order, so
+// op need not be commutative.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../cpu.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "kernels.hpp"
+#include "lookback.hpp"
+
+namespace algoritmi {
+namespace detail::prims {
+
+// Keeps init out of template argument deduction: reduce(p, n, 0) on int64s.
+template <class T>
+struct type_identity {
+  using type = T;
+};
+template <class T>
+using identity_t = typename type_identity<T>::type;
+
+// Whether (T, Op) can use the integer add kernels.
+template <class T, class Op>
+inline constexpr bool add_kernel_v =
+    simd_int_v<T> && (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>>);
+
+// Combines partial sums the way the kernels do: signed sums wrap too.
+struct wrapping_plus {
+  template <class T>
+  T operator()(T a, T b) const noexcept {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+  }
+};
+
+template <class T, class Op>
+decltype(auto) combiner(Op& op) noexcept {
+  if constexpr (add_kernel_v<T, Op>)
+    return wrapping_plus{};
+  else
+    return (op);
+}
+
+template <class T, class Op>
+T fold(T const* in, std::size_t n, T init, Op& op) {
+  if constexpr (add_kernel_v<T, Op>) {
+    return kernels<T>().reduce_add(in, n, init);
+  } else {
+    for (std::size_t i = 0; i < n; ++i) init = op(std::move(init), in[i]);
+    return init;
+  }
+}
+
+// out[i] = carry op in[0] op ... op in[i]; returns the last value.
+template <class T, class Op>
+T scan_from(T const* in, std::size_t n, T* out, T carry, Op& op) {
+  if constexpr (add_kernel_v<T, Op>) {
+    return kernels<T>().inclusive_add(in, n, out, carry);
+  } else {
+    for (std::size_t i = 0; i < n; ++i) out[i] = carry = op(carry, in[i]);
+    return carry;
+  }
+}
+
+// out[i] = carry op in[0] op ... op in[i - 1]; returns the total.
+template <class T, class Op>
+T exclusive_from(T const* in, std::size_t n, T* out, T carry, Op& op) {
+  if constexpr (add_kernel_v<T, Op>) {
+    return kernels<T>().exclusive_add(in, n, out, carry);
+  } else {
+    for (std::size_t i = 0; i < n; ++i) {
+      T next = op(carry, in[i]);
+      out[i] = std::move(carry);
+      carry = std::move(next);
+    }
+    return carry;
+  }
+}
+
+template <class T, class Op>
+T tile_aggregate(T const* in, std::size_t n, Op& op) {
+  if constexpr (add_kernel_v<T, Op>) {
+    return kernels<T>().reduce_add(in, n, T{0});
+  } else {
+    return fold(in + 1, n - 1, in[0], op);
+  }
+}
+
+template <class T, class Op>
+void parallel_scan(T const* in, std::size_t n, T* out, std::optional<T> const& init,
+                   bool inclusive, Op& op, unsigned threads, std::pmr::memory_resource* mr) {
+  auto&& combine = combiner<T>(op);
+  lookback_scan<T>(
+      tile_count(n), threads, combine,
+      [&](unsigned, std::size_t t, auto&& prefix_of) {
+        std::size_t const b = t * tile_size;
+        std::size_t const len = (n - b < tile_size) ? n - b : tile_size;
+        std::optional<T> prefix = prefix_of(tile_aggregate(in + b, len, op));
+        if (init) prefix = prefix ? combine(*init, *prefix) : *init;
+        if (inclusive) {
+          if (prefix) {
+            scan_from(in + b, len, out + b, std::move(*prefix), op);
+          } else {
+            T const first = in[b];
+            out[b] = first;
+            scan_from(in + b + 1, len - 1, out + b + 1, first, op);
+          }
+        } else {
+          exclusive_from(in + b, len, out + b, std::move(*prefix), op);
+        }
+      },
+      mr);
+}
+
+// Reduction of each tile into its slot, then a fold of the slots in order.
+template <class T, class Op>
+T parallel_reduce(T const* in, std::size_t n, T init, Op& op, unsigned threads,
+                  std::pmr::memory_resource* mr) {
+  std::size_t const tiles = tile_count(n);
+  std::pmr::vector<std::optional<T>> partial(tiles, mr);
+  parallel_for(tiles, threads, [&](std::size_t t) {
+    std::size_t const b = t * tile_size;
+    std::size_t const len = (n - b < tile_size) ? n - b : tile_size;
+    partial[t] = tile_aggregate(in + b, len, op);
+  });
+  auto&& combine = combiner<T>(op);
+  for (auto& p : partial) init = combine(std::move(init), std::move(*p));
+  return init;
+}
+
+}  // namespace detail::prims
+
+// out[i] = in[0] op in[1] op ... op in[i]. out may be in.
+template <class T, class Op = std::plus<>>
+void inclusive_scan(T const* in, std::size_t n, T* out, Op op = {}) {
+  if (n == 0) return;
+  if constexpr (detail::prims::add_kernel_v<T, Op>) {
+    detail::prims::kernels<T>().inclusive_add(in, n, out, T{0});
+  } else {
+    T const first = in[0];
+    out[0] = first;
+    detail::prims::scan_from(in + 1, n - 1, out + 1, first, op);
+  }
+}
+
+// out[i] = init op in[0] op ... op in[i - 1]; returns init op (all of in),
+// the value out[n] would have. out may be in.
+template <class T, class Op = std::plus<>>
+T exclusive_scan(T const* in, std::size_t n, T* out, detail::prims::identity_t<T> init = T{},
+                 Op op = {}) {
+  return detail::prims::exclusive_from(in, n, out, std::move(init), op);
+}
+
+// init op in[0] op ... op in[n - 1], grouped in any order.
+template <class T, class Op = std::plus<>>
+T reduce(T const* in, std::size_t n, detail::prims::identity_t<T> init = T{}, Op op = {}) {
+  return detail::prims::fold(in, n, std::move(init), op);
+}
+
+// Sums with a specific kernel, clamped to what the host supports.
+template <class T>
+void inclusive_scan(isa which, T const* in, std::size_t n, T* out) noexcept {
+  static_assert(detail::prims::simd_int_v<T>, "isa overloads take 32/64-bit integers");
+  detail::prims::make_kernel_table<T>(which).inclusive_add(in, n, out, T{0});
+}
+
+template <class T>
+T exclusive_scan(isa which, T const* in, std::size_t n, T* out,
+                 detail::prims::identity_t<T> init = T{}) noexcept {
+  static_assert(detail::prims::simd_int_v<T>, "isa overloads take 32/64-bit integers");
+  return detail::prims::make_kernel_table<T>(which).exclusive_add(in, n, out, init);
+}
+
+template <class T>
+T reduce(isa which, T const* in, std::size_t n, detail::prims::identity_t<T> init = T{}) noexcept {
+  static_assert(detail::prims::simd_int_v<T>, "isa overloads take 32/64-bit integers");
+  return detail::prims::make_kernel_table<T>(which).reduce_add(in, n, init);
+}
+
+// Multi-threaded versions; sequential below a few hundred thousand
+// elements. Tile status words (a cache line per 64K elements) come from mr.
+template <class T, class Op = std::plus<>>
+void inclusive_scan(parallel_policy policy, T const* in, std::size_t n, T* out, Op op = {},
+                    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::prims::threads_for(policy, n);
+  if (threads <= 1) return inclusive_scan(in, n, out, std::move(op));
+  detail::prims::parallel_scan(in, n, out, std::optional<T>(), true, op, threads, mr);
+}
+
+template <class T, class Op = std::plus<>>
+T exclusive_scan(parallel_policy policy, T const* in, std::size_t n, T* out,
+                 detail::prims::identity_t<T> init = T{}, Op op = {},
+                 std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::prims::threads_for(policy, n);
+  if (threads <= 1) return exclusive_scan(in, n, out, std::move(init), std::move(op));
+  // The last input element is read before the scan may overwrite it.
+  T const last = in[n - 1];
+  detail::prims::parallel_scan(in, n, out, std::optional<T>(std::move(init)), false, op, threads,
+                               mr);
+  return detail::prims::combiner<T>(op)(out[n - 1], last);
+}
+
+template <class T, class Op = std::plus<>>
+T reduce(parallel_policy policy, T const* in, std::size_t n,
+         detail::prims::identity_t<T> init = T{}, Op op = {},
+         std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::prims::threads_for(policy, n);
+  if (threads <= 1) return reduce(in, n, std::move(init), std::move(op));
+  return detail::prims::parallel_reduce(in, n, std::move(init), op, threads, mr);
+}
+
+}  // namespace algoritmi
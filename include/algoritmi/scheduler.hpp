@@ -0,0 +1,63 @@
+// Fork-join scheduling shared by every parallel algorithm.
+//
+//   task_scheduler(options)          work-stealing pool: Chase-Lev deque per
+//                                    thread, worker count, optional pinning
+//   default_scheduler()              the one used unless told otherwise
+//   set_default_executor(&e)         run all parallel algorithms on e
+//   scoped_executor use(e)           same, for this thread and this scope
+//   pool_executor(submit, n)         executor over an application's thread
+//                                    pool, given a way to submit a job
+//   parallel_for(par, first, last, fn[, grain])
+//                                    fn(i) for each i, in parallel
+//   parallel_invoke(f, g)            f() and g() in parallel
+//
+// Parallel calls made from inside a task run on the same threads: a thread
+// waiting for its children steals work rather than blocking, so nested
+// parallelism never oversubscribes the machine.
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "execution.hpp"
+#include "scheduler/chase_lev_deque.hpp"
+#include "scheduler/executor.hpp"
+#include "scheduler/task_scheduler.hpp"
+
+namespace algoritmi {
+
+// Calls fn(i) for every i in [first, last), in chunks of `grain` indices
+// spread over up to policy.threads threads.
+template <class Fn>
+void parallel_for(parallel_policy policy, std::size_t first, std::size_t last, Fn&& fn,
+                  std::size_t grain = 1) {
+  if (last <= first) return;
+  if (grain == 0) grain = 1;
+  std::size_t const chunks = (last - first + grain - 1) / grain;
+  executor& e = current_executor();
+  unsigned const threads = policy.threads ? policy.threads : e.concurrency();
+  auto chunk = [&](std::size_t c) {
+    std::size_t const b = first + c * grain;
+    std::size_t const end = last - b < grain ? last : b + grain;
+    for (std::size_t i = b; i < end; ++i) fn(i);
+  };
+  if (threads <= 1 || chunks == 1) {
+    for (std::size_t c = 0; c < chunks; ++c) chunk(c);
+    return;
+  }
+  e.bulk(chunks, threads, task_fn(chunk));
+}
+
+// Runs f() and g(), possibly at the same time; rethrows the first exception.
+template <class F, class G>
+void parallel_invoke(F&& f, G&& g) {
+  auto both = [&](std::size_t i) {
+    if (i == 0)
+      std::forward<F>(f)();
+    else
+      std::forward<G>(g)();
+  };
+  current_executor().bulk(2, 2, task_fn(both));
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,90 @@
+// Work-stealing deque (Chase & Lev, "Dynamic Circular Work-Stealing Deque",
+// SPAA 2005), with the C11 memory orderings of Lê, Pop, Cohen and Zappa
+// Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models",
+// PPoPP 2013.
+//
+// The owner pushes and pops at the bottom without atomic read-modify-write
+// except when taking the last element; thieves take from the top with one
+// CAS. The ring has a fixed capacity: fork-join recursion pushes a few
+// entries per nesting level, so a full deque means the caller should just
+// run the task itself, which push() signals by returning false.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../config.hpp"
+
+namespace algoritmi::detail::sched {
+
+template <class T, std::size_t Capacity = 1024>
+class chase_lev_deque {
+  static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+ public:
+  chase_lev_deque() noexcept {
+    for (auto& slot : ring_) slot.store(nullptr, std::memory_order_relaxed);
+  }
+  chase_lev_deque(chase_lev_deque const&) = delete;
+  chase_lev_deque& operator=(chase_lev_deque const&) = delete;
+
+  // Owner only.
+  bool push(T* item) noexcept {
+    std::int64_t const b = bottom_.load(std::memory_order_relaxed);
+    std::int64_t const t = top_.load(std::memory_order_acquire);
+    if (b - t >= static_cast<std::int64_t>(Capacity)) return false;
+    ring_[static_cast<std::size_t>(b) & (Capacity - 1)].store(item, std::memory_order_relaxed);
+    // A release store where the paper has a release fence: the same plain
+    // store on x86, and visible to ThreadSanitizer, which ignores fences.
+    bottom_.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only: the most recently pushed item, or nullptr.
+  T* pop() noexcept {
+    std::int64_t const b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = ring_[static_cast<std::size_t>(b) & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+      // Last element: race the thieves for it.
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed))
+        item = nullptr;
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread: the oldest item, or nullptr if empty or another thief won.
+  T* steal() noexcept {
+    std::int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t const b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    T* item = ring_[static_cast<std::size_t>(t) & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      return nullptr;
+    return item;
+  }
+
+  // Approximate; for idle checks only.
+  bool empty() const noexcept {
+    return top_.load(std::memory_order_relaxed) >= bottom_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  alignas(cache_line_size) std::atomic<std::int64_t> top_{0};
+  alignas(cache_line_size) std::atomic<std::int64_t> bottom_{0};
+  alignas(cache_line_size) std::array<std::atomic<T*>, Capacity> ring_;
+};
+
+}  // namespace algoritmi::detail::sched
@@ -0,0 +1,180 @@
+// The interface parallel algorithms run on, and an adapter for thread pools
+// that live outside the library.
+//
+// Every parallel algorithm reduces to bulk(tasks, threads, fn): call fn(i)
+// for each i in [0, tasks) with at most `threads` of them running at once,
+// return when all are done, rethrow the first exception. task_scheduler is
+// the built-in implementation; pool_executor runs the same contract on an
+// application's pool given only a way to submit a job to it.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace algoritmi {
+namespace detail {
+
+inline unsigned hardware_threads() noexcept {
+  unsigned const n = std::thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+}  // namespace detail
+
+// Non-owning reference to a callable taking a task index; cheap to copy and
+// valid as long as the callable it refers to.
+class task_fn {
+ public:
+  template <class Fn, class = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, task_fn>>>
+  task_fn(Fn& fn) noexcept
+      : ctx_(const_cast<void*>(static_cast<void const*>(std::addressof(fn)))),
+        call_([](void* ctx, std::size_t i) { (*static_cast<Fn*>(ctx))(i); }) {}
+
+  void operator()(std::size_t i) const { call_(ctx_, i); }
+
+ private:
+  void* ctx_;
+  void (*call_)(void*, std::size_t);
+};
+
+class executor {
+ public:
+  virtual ~executor() = default;
+
+  // Threads that can run tasks at once, the calling thread included. What
+  // algorithmi::par uses when it is not given a thread count.
+  virtual unsigned concurrency() const noexcept = 0;
+
+  // Calls fn(i) for every i in [0, tasks) on up to `threads` threads, the
+  // caller included, and returns when all calls have returned. After a task
+  // throws, unstarted tasks are skipped and the first exception is
+  // rethrown here. May be called from inside a task.
+  virtual void bulk(std::size_t tasks, unsigned threads, task_fn fn) = 0;
+};
+
+namespace detail::sched {
+
+// Executor override for the current thread: set by scoped_executor, and by
+// the threads an executor runs tasks on, so that nested calls stay on it.
+inline executor*& thread_executor() noexcept {
+  thread_local executor* e = nullptr;
+  return e;
+}
+
+inline std::atomic<executor*>& global_executor() noexcept {
+  static std::atomic<executor*> e{nullptr};
+  return e;
+}
+
+// Task indices handed out from a shared counter to whichever threads take
+// part, so early finishers keep taking work.
+class claim_counter {
+ public:
+  claim_counter(std::size_t tasks, task_fn fn) noexcept : tasks_(tasks), fn_(fn) {}
+
+  void run() {
+    for (;;) {
+      std::size_t const i = next_.fetch_add(1, std::memory_order_relaxed);
+      if (i >= tasks_) return;
+      try {
+        fn_(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) error_ = std::current_exception();
+        next_.store(tasks_, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void rethrow() const {
+    if (error_) std::rethrow_exception(error_);
+  }
+
+ private:
+  std::size_t tasks_;
+  task_fn fn_;
+  std::atomic<std::size_t> next_{0};
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+// State shared with the jobs pool_executor submits. A job may start after
+// bulk() has returned, so it lives on the heap and a job only touches the
+// counter if it gets in before the caller closes the door.
+class pool_job {
+ public:
+  pool_job(std::size_t tasks, task_fn fn) : claims_(tasks, fn) {}
+
+  void help() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (closed_) return;
+      ++active_;
+    }
+    claims_.run();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--active_ == 0 && closed_) idle_.notify_all();
+  }
+
+  // Caller: takes part, then waits for the helpers that got in.
+  void run_and_wait() {
+    claims_.run();
+    std::unique_lock<std::mutex> lock(mutex_);
+    closed_ = true;
+    idle_.wait(lock, [&] { return active_ == 0; });
+    lock.unlock();
+    claims_.rethrow();
+  }
+
+ private:
+  claim_counter claims_;
+  std::mutex mutex_;
+  std::condition_variable idle_;
+  unsigned active_ = 0;
+  bool closed_ = false;
+};
+
+}  // namespace detail::sched
+
+// Runs parallel algorithms on an application's thread pool. `submit` is
+// called with a std::function<void()> to run once on some pool thread;
+// jobs that start late or never do cost nothing, since the calling thread
+// takes part and can finish the work alone. Nested calls from pool threads
+// submit more jobs, so the pool's own size bounds the thread count.
+template <class Submit>
+class pool_executor final : public executor {
+ public:
+  pool_executor(Submit submit, unsigned concurrency)
+      : submit_(std::move(submit)), concurrency_(concurrency ? concurrency : 1) {}
+
+  unsigned concurrency() const noexcept override { return concurrency_; }
+
+  void bulk(std::size_t tasks, unsigned threads, task_fn fn) override {
+    if (tasks == 0) return;
+    std::size_t const helpers = std::min<std::size_t>(tasks, threads ? threads : 1) - 1;
+    auto job = std::make_shared<detail::sched::pool_job>(tasks, fn);
+    for (std::size_t h = 0; h < helpers; ++h)
+      submit_(std::function<void()>([job, self = this] {
+        executor*& current = detail::sched::thread_executor();
+        executor* const saved = std::exchange(current, self);
+        job->help();
+        current = saved;
+      }));
+    job->run_and_wait();
+  }
+
+ private:
+  Submit submit_;
+  unsigned concurrency_;
+};
+
+}  // namespace algoritmi
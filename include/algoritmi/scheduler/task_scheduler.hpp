@@ -0,0 +1,349 @@
+// Work-stealing fork-join scheduler, and the choice of executor the parallel
+// algorithms run on.
+//
+// Each thread owns a slot with a Chase-Lev deque. bulk() splits its
+// claimers in halves: the right half is pushed where idle threads can steal
+// it, the left half runs at once, and the join pops the right half back if
+// nobody took it. A thread waiting at a join steals other work instead of
+// blocking, so a parallel call made from inside a task just pushes onto the
+// same deques: nesting never adds threads.
+//
+// Slot 0 belongs to whichever outside thread calls bulk() first; it takes
+// part in its own call like a worker. A second outside caller at the same
+// time hands its call to the workers through a locked queue and sleeps.
+// Idle workers spin briefly, then sleep until new work is pushed.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../config.hpp"
+#include "chase_lev_deque.hpp"
+#include "executor.hpp"
+
+namespace algoritmi {
+
+struct scheduler_options {
+  unsigned threads = 0;      // caller included; 0 selects the hardware thread count
+  bool pin_threads = false;  // bind worker i to the i-th CPU the process may use (Linux)
+};
+
+namespace detail::sched {
+
+struct task {
+  void (*execute)(task&);
+  std::atomic<bool> done{false};
+};
+
+struct alignas(cache_line_size) worker_slot {
+  chase_lev_deque<task> deque;
+  std::uint64_t rng = 0;  // victim selection; owner only
+};
+
+inline void pin_current_thread(unsigned index) noexcept {
+#if defined(__linux__)
+  cpu_set_t allowed;
+  if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+  int const count = CPU_COUNT(&allowed);
+  if (count <= 0) return;
+  int target = static_cast<int>(index % static_cast<unsigned>(count));
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &allowed) || target-- > 0) continue;
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    ::pthread_setaffinity_np(::pthread_self(), sizeof(one), &one);
+    return;
+  }
+#else
+  (void)index;
+#endif
+}
+
+}  // namespace detail::sched
+
+class task_scheduler final : public executor {
+ public:
+  explicit task_scheduler(scheduler_options options = {})
+      : slot_count_(options.threads ? options.threads : detail::hardware_threads()),
+        slots_(new detail::sched::worker_slot[slot_count_]) {
+    for (unsigned i = 0; i < slot_count_; ++i) slots_[i].rng = 0x9e3779b97f4a7c15ULL * (i + 1);
+    workers_.reserve(slot_count_ - 1);
+    for (unsigned i = 1; i < slot_count_; ++i)
+      workers_.emplace_back([this, i, pin = options.pin_threads] { worker_main(i, pin); });
+  }
+
+  task_scheduler(task_scheduler const&) = delete;
+  task_scheduler& operator=(task_scheduler const&) = delete;
+
+  // No bulk() call may be running.
+  ~task_scheduler() override {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_.store(true, std::memory_order_relaxed);
+      ++wake_epoch_;
+    }
+    sleep_cv_.notify_all();
+    for (auto& w : workers_) w.join();
+  }
+
+  unsigned concurrency() const noexcept override { return slot_count_; }
+
+  void bulk(std::size_t tasks, unsigned threads, task_fn fn) override {
+    if (tasks == 0) return;
+    unsigned const claimers =
+        static_cast<unsigned>(std::min<std::size_t>(tasks, threads ? threads : 1));
+    detail::sched::claim_counter claims(tasks, fn);
+    context& here = current();
+    if (claimers <= 1 || workers_.empty()) {
+      claims.run();
+    } else if (here.owner == this) {
+      run_claimers(*here.self, claims, claimers);
+    } else if (!caller_slot_busy_.exchange(true, std::memory_order_acquire)) {
+      caller_slot const use(*this);
+      run_claimers(slots_[0], claims, claimers);
+    } else {
+      split_task root{{&execute_root}, this, &claims, claimers};
+      {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        injected_.push_back(&root);
+        injected_count_.fetch_add(1, std::memory_order_relaxed);
+      }
+      wake_one();
+      std::unique_lock<std::mutex> lock(done_mutex_);
+      done_cv_.wait(lock, [&] { return root.done.load(std::memory_order_acquire); });
+    }
+    claims.rethrow();
+  }
+
+ private:
+  using task = detail::sched::task;
+  using slot = detail::sched::worker_slot;
+
+  struct context {
+    task_scheduler* owner;
+    slot* self;
+  };
+  static context& current() noexcept {
+    thread_local context c{nullptr, nullptr};
+    return c;
+  }
+
+  // The calling thread works as slot 0 for the scope and, like a worker,
+  // sees this scheduler as its executor; both are restored on exit.
+  class caller_slot {
+   public:
+    explicit caller_slot(task_scheduler& s) noexcept
+        : sched_(s), saved_(current()), saved_executor_(detail::sched::thread_executor()) {
+      current() = {&s, &s.slots_[0]};
+      detail::sched::thread_executor() = &s;
+    }
+    caller_slot(caller_slot const&) = delete;
+    caller_slot& operator=(caller_slot const&) = delete;
+    ~caller_slot() {
+      current() = saved_;
+      detail::sched::thread_executor() = saved_executor_;
+      sched_.caller_slot_busy_.store(false, std::memory_order_release);
+    }
+
+   private:
+    task_scheduler& sched_;
+    context saved_;
+    executor* saved_executor_;
+  };
+
+  struct split_task : task {
+    task_scheduler* scheduler;
+    detail::sched::claim_counter* claims;
+    unsigned count;
+  };
+
+  static void execute_split(task& t) {
+    auto& s = static_cast<split_task&>(t);
+    s.scheduler->run_claimers(*current().self, *s.claims, s.count);
+    s.done.store(true, std::memory_order_release);
+  }
+
+  // The caller sleeps on done_cv_; once done is set the task may be gone.
+  static void execute_root(task& t) {
+    auto& s = static_cast<split_task&>(t);
+    task_scheduler* const sched = s.scheduler;
+    sched->run_claimers(*current().self, *s.claims, s.count);
+    std::lock_guard<std::mutex> lock(sched->done_mutex_);
+    s.done.store(true, std::memory_order_release);
+    sched->done_cv_.notify_all();
+  }
+
+  void run_claimers(slot& self, detail::sched::claim_counter& claims, unsigned count) {
+    if (count > 1) {
+      split_task right{{&execute_split}, this, &claims, count / 2};
+      if (self.deque.push(&right)) {
+        wake_one();
+        run_claimers(self, claims, count - count / 2);
+        join(self, right);
+        return;
+      }
+    }
+    claims.run();
+  }
+
+  // Runs other work until t is done; t itself if nobody stole it.
+  void join(slot& self, task& t) {
+    while (!t.done.load(std::memory_order_acquire)) {
+      task* next = self.deque.pop();
+      if (!next) next = steal(self);
+      if (next)
+        next->execute(*next);
+      else
+        std::this_thread::yield();
+    }
+  }
+
+  task* steal(slot& self) noexcept {
+    std::uint64_t x = self.rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    self.rng = x;
+    unsigned const start = static_cast<unsigned>(x % slot_count_);
+    for (unsigned k = 0; k < slot_count_; ++k) {
+      slot& victim = slots_[(start + k) % slot_count_];
+      if (&victim == &self) continue;
+      if (task* t = victim.deque.steal()) return t;
+    }
+    return nullptr;
+  }
+
+  task* take_injected() {
+    if (injected_count_.load(std::memory_order_relaxed) == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(inject_mutex_);
+    if (injected_.empty()) return nullptr;
+    task* t = injected_.front();
+    injected_.pop_front();
+    injected_count_.fetch_sub(1, std::memory_order_relaxed);
+    return t;
+  }
+
+  bool work_visible() const noexcept {
+    if (injected_count_.load(std::memory_order_relaxed) != 0) return true;
+    for (unsigned i = 0; i < slot_count_; ++i)
+      if (!slots_[i].deque.empty()) return true;
+    return false;
+  }
+
+  // Pairs with the fence in worker_main: either the sleeper sees the new
+  // work in its last scan, or this sees the sleeper.
+  void wake_one() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      ++wake_epoch_;
+    }
+    sleep_cv_.notify_one();
+  }
+
+  void worker_main(unsigned index, bool pin) {
+    if (pin) detail::sched::pin_current_thread(index);
+    slot& self = slots_[index];
+    current() = {this, &self};
+    detail::sched::thread_executor() = this;
+    unsigned idle = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+      task* t = self.deque.pop();
+      if (!t) t = steal(self);
+      if (!t) t = take_injected();
+      if (t) {
+        t->execute(*t);
+        idle = 0;
+        continue;
+      }
+      if (++idle < 64) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      std::uint64_t const epoch = wake_epoch_;
+      sleepers_.fetch_add(1, std::memory_order_relaxed);
+      lock.unlock();
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool const work = work_visible();
+      lock.lock();
+      if (!work)
+        sleep_cv_.wait(lock, [&] {
+          return stop_.load(std::memory_order_relaxed) || wake_epoch_ != epoch;
+        });
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      idle = 0;
+    }
+  }
+
+  unsigned slot_count_;
+  std::unique_ptr<slot[]> slots_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> caller_slot_busy_{false};
+
+  std::mutex inject_mutex_;
+  std::deque<task*> injected_;
+  std::atomic<std::size_t> injected_count_{0};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::uint64_t wake_epoch_ = 0;
+  std::atomic<unsigned> sleepers_{0};
+  std::atomic<bool> stop_{false};
+
+  std::mutex done_mutex_;
+  std::condition_variable done_cv_;
+};
+
+// The scheduler used when no other executor is selected: one slot per
+// hardware thread, started on first use.
+inline task_scheduler& default_scheduler() {
+  static task_scheduler scheduler;
+  return scheduler;
+}
+
+// Executor for parallel calls made on this thread: a scoped_executor if one
+// is active, else the one given to set_default_executor, else
+// default_scheduler(). Tasks run by an executor see that executor here.
+inline executor& current_executor() {
+  if (executor* e = detail::sched::thread_executor()) return *e;
+  if (executor* e = detail::sched::global_executor().load(std::memory_order_acquire)) return *e;
+  return default_scheduler();
+}
+
+// Process-wide executor; nullptr restores default_scheduler(). The
+// executor must outlive every parallel call that uses it.
+inline void set_default_executor(executor* e) noexcept {
+  detail::sched::global_executor().store(e, std::memory_order_release);
+}
+
+// Routes parallel calls on this thread to `e` until the end of the scope.
+class scoped_executor {
+ public:
+  explicit scoped_executor(executor& e) noexcept : saved_(detail::sched::thread_executor()) {
+    detail::sched::thread_executor() = &e;
+  }
+  scoped_executor(scoped_executor const&) = delete;
+  scoped_executor& operator=(scoped_executor const&) = delete;
+  ~scoped_executor() { detail::sched::thread_executor() = saved_; }
+
+ private:
+  executor* saved_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,85 @@
+// Searching sorted and unsorted arrays.
+//
+//   find_first(data, n, key)      index of the first element == key, or n
+//   count_less(data, n, key)      number of elements < key (any order)
+//   lower_bound(data, n, key)     first index with data[i] >= key (sorted)
+//   binary_search(data, n, key)   whether a sorted array contains key
+//   branchless_lower_bound(first, last, key[, comp])
+//                                 generic iterator version, no SIMD
+//   eytzinger_index<T>            BFS-ordered copy of a sorted array
+//   static_search_tree<T>         implicit B+-tree over 64-byte nodes, with
+//                                 batched, prefetch-interleaved lookups
+//
+// For 32/64-bit integers, float and double the pointer overloads run SIMD
+// kernels (AVX2: 8 x 32-bit keys per compare, SSE4.2 as fallback), selected
+// once per process from CPUID; see cpu.hpp. Overloads taking an `isa` run a
+// specific implementation, clamped to what the host supports.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+
+#include "cpu.hpp"
+#include "search/eytzinger.hpp"
+#include "search/kernels.hpp"
+#include "search/static_tree.hpp"
+
+namespace algoritmi {
+
+template <class T>
+std::size_t find_first(T const* data, std::size_t n, T key) noexcept {
+  return detail::search::kernels<T>().find_first(data, n, key);
+}
+
+template <class T>
+std::size_t count_less(T const* data, std::size_t n, T key) noexcept {
+  return detail::search::kernels<T>().count_less(data, n, key);
+}
+
+template <class T>
+std::size_t lower_bound(T const* data, std::size_t n, T key) noexcept {
+  return detail::search::kernels<T>().lower_bound(data, n, key);
+}
+
+template <class T>
+bool binary_search(T const* data, std::size_t n, T key) noexcept {
+  std::size_t const i = lower_bound(data, n, key);
+  return i < n && !(key < data[i]);
+}
+
+template <class T>
+std::size_t find_first(isa which, T const* data, std::size_t n, T key) noexcept {
+  return detail::search::make_kernel_table<T>(which).find_first(data, n, key);
+}
+
+template <class T>
+std::size_t count_less(isa which, T const* data, std::size_t n, T key) noexcept {
+  return detail::search::make_kernel_table<T>(which).count_less(data, n, key);
+}
+
+template <class T>
+std::size_t lower_bound(isa which, T const* data, std::size_t n, T key) noexcept {
+  return detail::search::make_kernel_table<T>(which).lower_bound(data, n, key);
+}
+
+// std::lower_bound without the unpredictable branch: each step advances by
+// 0 or half computed arithmetically, so the cost is a fixed log2(n) iterations.
+template <class RandomIt, class T, class Compare>
+RandomIt branchless_lower_bound(RandomIt first, RandomIt last, T const& key, Compare comp) {
+  auto len = last - first;
+  if (len == 0) return first;
+  while (len > 1) {
+    auto const half = len / 2;
+    first += half * static_cast<decltype(half)>(comp(first[half - 1], key));
+    len -= half;
+  }
+  return comp(*first, key) ? first + 1 : first;
+}
+
+template <class RandomIt, class T>
+RandomIt branchless_lower_bound(RandomIt first, RandomIt last, T const& key) {
+  return branchless_lower_bound(first, last, key, std::less<>());
+}
+
+}  // namespace algoritmi
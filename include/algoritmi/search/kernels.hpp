@@ -0,0 +1,382 @@
+// Search kernels over contiguous arrays, one version per instruction set.
+//
+// Every kernel family is written once against a small "lane ops" interface
+// (load, broadcast, equal/less masks) and stamped out for scalar, SSE4.2 and
+// AVX2. Unsigned integers are compared after flipping the sign bit because
+// SSE/AVX2 only provide signed integer comparisons.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::search {
+
+template <class T>
+inline constexpr bool simd_key_v =
+    std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t> ||
+    std::is_same_v<T, std::int64_t> || std::is_same_v<T, std::uint64_t> ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Size of the final window lower_bound scans linearly, in elements. A
+// couple of cache lines: cheaper to compare all at once than to keep halving.
+template <class T>
+inline constexpr std::size_t window_v = 128 / sizeof(T);
+
+// ---------------------------------------------------------------- scalar --
+
+template <class T>
+std::size_t find_first_scalar(T const* p, std::size_t n, T key) noexcept {
+  for (std::size_t i = 0; i < n; ++i)
+    if (p[i] == key) return i;
+  return n;
+}
+
+template <class T>
+std::size_t count_less_scalar(T const* p, std::size_t n, T key) noexcept {
+  std::size_t c = 0;
+  for (std::size_t i = 0; i < n; ++i) c += p[i] < key;
+  return c;
+}
+
+// Branchless binary search: the step is selected arithmetically,
+// and both candidate midpoints of the next step are prefetched.
+template <class T>
+ALGORITMI_ALWAYS_INLINE T const* narrow(T const* first, std::size_t& len, T key,
+                                        std::size_t stop) noexcept {
+  while (len > stop) {
+    std::size_t const half = len / 2;
+    ALGORITMI_PREFETCH(first + half / 2);
+    ALGORITMI_PREFETCH(first + half + half / 2);
+    // Arithmetic select: compilers turn a ternary here back into a branch.
+    first += half * static_cast<std::size_t>(first[half - 1] < key);
+    len -= half;
+  }
+  return first;
+}
+
+template <class T>
+std::size_t lower_bound_scalar(T const* p, std::size_t n, T key) noexcept {
+  std::size_t len = n;
+  T const* first = narrow(p, len, key, 1);
+  if (len == 0) return 0;
+  return static_cast<std::size_t>(first - p) + (*first < key);
+}
+
+// One-lane version of the lane-ops interface below, for layouts (such as
+// static_search_tree) that stamp a single kernel body out for every target.
+template <class T>
+struct scalar_ops {
+  using vec = T;
+  static constexpr unsigned lanes = 1;
+  static T load(T const* p) noexcept { return *p; }
+  static T set1(T k) noexcept { return k; }
+  static unsigned eq(T a, T k) noexcept { return a == k; }
+  static unsigned lt(T a, T k) noexcept { return a < k; }
+};
+
+#if ALGORITMI_HAS_SIMD
+
+// ---------------------------------------------------------------- SSE4.2 --
+
+template <class T>
+struct sse_ops;
+
+template <>
+struct sse_ops<std::int32_t> {
+  using vec = __m128i;
+  static constexpr unsigned lanes = 4;
+  ALGORITMI_TARGET_SSE42 static vec load(std::int32_t const* p) {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::int32_t k) { return _mm_set1_epi32(k); }
+  ALGORITMI_TARGET_SSE42 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, k))));
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, a))));
+  }
+};
+
+template <>
+struct sse_ops<std::uint32_t> {
+  using vec = __m128i;
+  static constexpr unsigned lanes = 4;
+  ALGORITMI_TARGET_SSE42 static vec bias() { return _mm_set1_epi32(INT32_MIN); }
+  ALGORITMI_TARGET_SSE42 static vec load(std::uint32_t const* p) {
+    return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)), bias());
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::uint32_t k) {
+    return _mm_xor_si128(_mm_set1_epi32(static_cast<int>(k)), bias());
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned eq(vec a, vec k) { return sse_ops<std::int32_t>::eq(a, k); }
+  ALGORITMI_TARGET_SSE42 static unsigned lt(vec a, vec k) { return sse_ops<std::int32_t>::lt(a, k); }
+};
+
+template <>
+struct sse_ops<std::int64_t> {
+  using vec = __m128i;
+  static constexpr unsigned lanes = 2;
+  ALGORITMI_TARGET_SSE42 static vec load(std::int64_t const* p) {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::int64_t k) { return _mm_set1_epi64x(k); }
+  ALGORITMI_TARGET_SSE42 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(a, k))));
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, a))));
+  }
+};
+
+template <>
+struct sse_ops<std::uint64_t> {
+  using vec = __m128i;
+  static constexpr unsigned lanes = 2;
+  ALGORITMI_TARGET_SSE42 static vec bias() { return _mm_set1_epi64x(INT64_MIN); }
+  ALGORITMI_TARGET_SSE42 static vec load(std::uint64_t const* p) {
+    return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)), bias());
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(std::uint64_t k) {
+    return _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(k)), bias());
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned eq(vec a, vec k) { return sse_ops<std::int64_t>::eq(a, k); }
+  ALGORITMI_TARGET_SSE42 static unsigned lt(vec a, vec k) { return sse_ops<std::int64_t>::lt(a, k); }
+};
+
+template <>
+struct sse_ops<float> {
+  using vec = __m128;
+  static constexpr unsigned lanes = 4;
+  ALGORITMI_TARGET_SSE42 static vec load(float const* p) { return _mm_loadu_ps(p); }
+  ALGORITMI_TARGET_SSE42 static vec set1(float k) { return _mm_set1_ps(k); }
+  ALGORITMI_TARGET_SSE42 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(a, k)));
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(a, k)));
+  }
+};
+
+template <>
+struct sse_ops<double> {
+  using vec = __m128d;
+  static constexpr unsigned lanes = 2;
+  ALGORITMI_TARGET_SSE42 static vec load(double const* p) { return _mm_loadu_pd(p); }
+  ALGORITMI_TARGET_SSE42 static vec set1(double k) { return _mm_set1_pd(k); }
+  ALGORITMI_TARGET_SSE42 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(a, k)));
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(_mm_movemask_pd(_mm_cmplt_pd(a, k)));
+  }
+};
+
+// ------------------------------------------------------------------ AVX2 --
+
+template <class T>
+struct avx2_ops;
+
+template <>
+struct avx2_ops<std::int32_t> {
+  using vec = __m256i;
+  static constexpr unsigned lanes = 8;
+  ALGORITMI_TARGET_AVX2 static vec load(std::int32_t const* p) {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::int32_t k) { return _mm256_set1_epi32(k); }
+  ALGORITMI_TARGET_AVX2 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(
+        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, k))));
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(
+        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, a))));
+  }
+};
+
+template <>
+struct avx2_ops<std::uint32_t> {
+  using vec = __m256i;
+  static constexpr unsigned lanes = 8;
+  ALGORITMI_TARGET_AVX2 static vec bias() { return _mm256_set1_epi32(INT32_MIN); }
+  ALGORITMI_TARGET_AVX2 static vec load(std::uint32_t const* p) {
+    return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)), bias());
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::uint32_t k) {
+    return _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(k)), bias());
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned eq(vec a, vec k) { return avx2_ops<std::int32_t>::eq(a, k); }
+  ALGORITMI_TARGET_AVX2 static unsigned lt(vec a, vec k) { return avx2_ops<std::int32_t>::lt(a, k); }
+};
+
+template <>
+struct avx2_ops<std::int64_t> {
+  using vec = __m256i;
+  static constexpr unsigned lanes = 4;
+  ALGORITMI_TARGET_AVX2 static vec load(std::int64_t const* p) {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::int64_t k) { return _mm256_set1_epi64x(k); }
+  ALGORITMI_TARGET_AVX2 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, k))));
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, a))));
+  }
+};
+
+template <>
+struct avx2_ops<std::uint64_t> {
+  using vec = __m256i;
+  static constexpr unsigned lanes = 4;
+  ALGORITMI_TARGET_AVX2 static vec bias() { return _mm256_set1_epi64x(INT64_MIN); }
+  ALGORITMI_TARGET_AVX2 static vec load(std::uint64_t const* p) {
+    return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)), bias());
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(std::uint64_t k) {
+    return _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(k)), bias());
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned eq(vec a, vec k) { return avx2_ops<std::int64_t>::eq(a, k); }
+  ALGORITMI_TARGET_AVX2 static unsigned lt(vec a, vec k) { return avx2_ops<std::int64_t>::lt(a, k); }
+};
+
+template <>
+struct avx2_ops<float> {
+  using vec = __m256;
+  static constexpr unsigned lanes = 8;
+  ALGORITMI_TARGET_AVX2 static vec load(float const* p) { return _mm256_loadu_ps(p); }
+  ALGORITMI_TARGET_AVX2 static vec set1(float k) { return _mm256_set1_ps(k); }
+  ALGORITMI_TARGET_AVX2 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, k, _CMP_EQ_OQ)));
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, k, _CMP_LT_OQ)));
+  }
+};
+
+template <>
+struct avx2_ops<double> {
+  using vec = __m256d;
+  static constexpr unsigned lanes = 4;
+  ALGORITMI_TARGET_AVX2 static vec load(double const* p) { return _mm256_loadu_pd(p); }
+  ALGORITMI_TARGET_AVX2 static vec set1(double k) { return _mm256_set1_pd(k); }
+  ALGORITMI_TARGET_AVX2 static unsigned eq(vec a, vec k) {
+    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, k, _CMP_EQ_OQ)));
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned lt(vec a, vec k) {
+    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, k, _CMP_LT_OQ)));
+  }
+};
+
+// Kernel bodies, instantiated once per target. Four vectors are tested per
+// iteration of find_first so the early-exit branch is taken rarely.
+#define ALGORITMI_SEARCH_KERNELS(TARGET, SUFFIX, OPS)                                    \
+  template <class T>                                                                     \
+  TARGET std::size_t find_first_##SUFFIX(T const* p, std::size_t n, T key) noexcept {    \
+    using ops = OPS<T>;                                                                  \
+    constexpr std::size_t L = ops::lanes;                                                \
+    auto const k = ops::set1(key);                                                       \
+    std::size_t i = 0;                                                                   \
+    for (; i + 4 * L <= n; i += 4 * L) {                                                 \
+      std::uint64_t const m = std::uint64_t{ops::eq(ops::load(p + i), k)} |              \
+                              std::uint64_t{ops::eq(ops::load(p + i + L), k)} << L |     \
+                              std::uint64_t{ops::eq(ops::load(p + i + 2 * L), k)} << 2 * L | \
+                              std::uint64_t{ops::eq(ops::load(p + i + 3 * L), k)} << 3 * L; \
+      if (m) return i + static_cast<std::size_t>(countr_zero(m));                        \
+    }                                                                                    \
+    for (; i + L <= n; i += L) {                                                         \
+      unsigned const m = ops::eq(ops::load(p + i), k);                                   \
+      if (m) return i + static_cast<std::size_t>(countr_zero(m));                        \
+    }                                                                                    \
+    for (; i < n; ++i)                                                                   \
+      if (p[i] == key) return i;                                                         \
+    return n;                                                                            \
+  }                                                                                      \
+                                                                                         \
+  template <class T>                                                                     \
+  TARGET std::size_t count_less_##SUFFIX(T const* p, std::size_t n, T key) noexcept {    \
+    using ops = OPS<T>;                                                                  \
+    constexpr std::size_t L = ops::lanes;                                                \
+    auto const k = ops::set1(key);                                                       \
+    std::size_t c = 0, i = 0;                                                            \
+    for (; i + L <= n; i += L)                                                           \
+      c += static_cast<std::size_t>(popcount(ops::lt(ops::load(p + i), k)));             \
+    for (; i < n; ++i) c += p[i] < key;                                                  \
+    return c;                                                                            \
+  }                                                                                      \
+                                                                                         \
+  template <class T>                                                                     \
+  TARGET std::size_t count_less_window_##SUFFIX(T const* p, T key) noexcept {            \
+    using ops = OPS<T>;                                                                  \
+    auto const k = ops::set1(key);                                                       \
+    std::size_t c = 0;                                                                   \
+    for (std::size_t i = 0; i < window_v<T>; i += ops::lanes)                            \
+      c += static_cast<std::size_t>(popcount(ops::lt(ops::load(p + i), k)));             \
+    return c;                                                                            \
+  }                                                                                      \
+                                                                                         \
+  /* Branchless halving down to a fixed-size window, then one vector count. */           \
+  template <class T>                                                                     \
+  TARGET std::size_t lower_bound_##SUFFIX(T const* p, std::size_t n, T key) noexcept {   \
+    constexpr std::size_t W = window_v<T>;                                               \
+    if (n <= W) return count_less_##SUFFIX(p, n, key);                                   \
+    std::size_t len = n;                                                                 \
+    T const* first = narrow(p, len, key, W);                                             \
+    /* Widen to exactly W elements: anything pulled in on the left is < key. */          \
+    T const* const start = first + W <= p + n ? first : p + n - W;                       \
+    return static_cast<std::size_t>(start - p) + count_less_window_##SUFFIX(start, key);  \
+  }
+
+ALGORITMI_SEARCH_KERNELS(ALGORITMI_TARGET_SSE42, sse42, sse_ops)
+ALGORITMI_SEARCH_KERNELS(ALGORITMI_TARGET_AVX2, avx2, avx2_ops)
+
+#undef ALGORITMI_SEARCH_KERNELS
+
+#endif  // ALGORITMI_HAS_SIMD
+
+// Function table for one key type, resolved for a given instruction set.
+template <class T>
+struct kernel_table {
+  std::size_t (*find_first)(T const*, std::size_t, T) noexcept;
+  std::size_t (*count_less)(T const*, std::size_t, T) noexcept;
+  std::size_t (*lower_bound)(T const*, std::size_t, T) noexcept;
+};
+
+template <class T>
+kernel_table<T> make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  if constexpr (simd_key_v<T>) {
+    switch (usable_isa(which)) {
+      case isa::avx2:
+        return {&find_first_avx2<T>, &count_less_avx2<T>, &lower_bound_avx2<T>};
+      case isa::sse42:
+        return {&find_first_sse42<T>, &count_less_sse42<T>, &lower_bound_sse42<T>};
+      default:
+        break;
+    }
+  }
+#else
+  (void)which;
+#endif
+  return {&find_first_scalar<T>, &count_less_scalar<T>, &lower_bound_scalar<T>};
+}
+
+// Table for active_isa(), built once per key type on first use.
+template <class T>
+kernel_table<T> const& kernels() noexcept {
+  static kernel_table<T> const table = make_kernel_table<T>(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::search
@@ -0,0 +1,248 @@
+// Immutable sorted-key index in implicit B+-tree ("S+ tree") layout.
+//
+// Keys are grouped into 64-byte nodes (16 x 32-bit or 8 x 64-bit keys).
+// The sorted keys themselves form the leaf layer; each upper layer holds, for
+// every child after the first, the smallest key of that child's subtree.
+// Child positions are computed (node * (B + 1) + rank), so there are no
+// pointers, and a lookup touches exactly one cache line per layer: about
+// log_17(n) lines instead of the log_2(n) of a binary search. Ranks within a
+// node are computed with one or two vector compares.
+//
+// lower_bound_batch() walks a group of queries down the tree level by level
+// and prefetches each query's next node before moving on to the next query,
+// so the memory latencies of a group overlap instead of adding up.
+//
+// A tree opened from an index file (persist.hpp) searches the mapped
+// layers in place.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/aligned.hpp"
+#include "../detail/bits.hpp"
+#include "../detail/borrowable.hpp"
+#include "../span.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+namespace detail::stree {
+
+// Read-only description of a built tree handed to the kernels.
+template <class T>
+struct view {
+  T const* data;
+  std::size_t const* offsets;  // start of each layer; layer 0 holds the leaves
+  unsigned height;
+  std::size_t n;
+};
+
+inline constexpr std::size_t batch_group = 16;
+
+#define ALGORITMI_STREE_KERNELS(TARGET, SUFFIX, OPS)                                     \
+  template <class T>                                                                     \
+  TARGET ALGORITMI_ALWAYS_INLINE std::size_t node_rank_##SUFFIX(                         \
+      T const* node, typename OPS<T>::vec k) noexcept {                                  \
+    using ops = OPS<T>;                                                                  \
+    std::size_t c = 0;                                                                   \
+    for (std::size_t j = 0; j < cache_line_size / sizeof(T); j += ops::lanes) {          \
+      if constexpr (ops::lanes == 1)                                                     \
+        c += ops::lt(ops::load(node + j), k);                                            \
+      else                                                                               \
+        c += static_cast<std::size_t>(popcount(ops::lt(ops::load(node + j), k)));        \
+    }                                                                                    \
+    return c;                                                                            \
+  }                                                                                      \
+                                                                                         \
+  template <class T>                                                                     \
+  TARGET std::size_t lower_bound_##SUFFIX(view<T> const& t, T key) noexcept {            \
+    constexpr std::size_t B = cache_line_size / sizeof(T);                               \
+    auto const k = OPS<T>::set1(key);                                                    \
+    std::size_t node = 0;                                                                \
+    for (unsigned h = t.height - 1; h > 0; --h)                                          \
+      node = node * (B + 1) + node_rank_##SUFFIX(t.data + t.offsets[h] + node * B, k);   \
+    std::size_t const r = node * B + node_rank_##SUFFIX(t.data + node * B, k);           \
+    return r < t.n ? r : t.n;                                                            \
+  }                                                                                      \
+                                                                                         \
+  template <class T>                                                                     \
+  TARGET void lower_bound_batch_##SUFFIX(view<T> const& t, T const* keys,                \
+                                         std::size_t count, std::size_t* out) noexcept { \
+    constexpr std::size_t B = cache_line_size / sizeof(T);                               \
+    std::size_t node[batch_group];                                                       \
+    for (std::size_t q0 = 0; q0 < count; q0 += batch_group) {                            \
+      std::size_t const g = std::min(batch_group, count - q0);                           \
+      for (std::size_t j = 0; j < g; ++j) node[j] = 0;                                   \
+      for (unsigned h = t.height - 1; h > 0; --h) {                                      \
+        T const* layer = t.data + t.offsets[h];                                          \
+        T const* below = t.data + t.offsets[h - 1];                                      \
+        for (std::size_t j = 0; j < g; ++j) {                                            \
+          auto const k = OPS<T>::set1(keys[q0 + j]);                                     \
+          node[j] = node[j] * (B + 1) + node_rank_##SUFFIX(layer + node[j] * B, k);      \
+          ALGORITMI_PREFETCH(below + node[j] * B);                                       \
+        }                                                                                \
+      }                                                                                  \
+      for (std::size_t j = 0; j < g; ++j) {                                              \
+        auto const k = OPS<T>::set1(keys[q0 + j]);                                       \
+        std::size_t const r = node[j] * B + node_rank_##SUFFIX(t.data + node[j] * B, k); \
+        out[q0 + j] = r < t.n ? r : t.n;                                                 \
+      }                                                                                  \
+    }                                                                                    \
+  }
+
+ALGORITMI_STREE_KERNELS(, scalar, search::scalar_ops)
+#if ALGORITMI_HAS_SIMD
+ALGORITMI_STREE_KERNELS(ALGORITMI_TARGET_SSE42, sse42, search::sse_ops)
+ALGORITMI_STREE_KERNELS(ALGORITMI_TARGET_AVX2, avx2, search::avx2_ops)
+#endif
+
+#undef ALGORITMI_STREE_KERNELS
+
+template <class T>
+struct kernel_table {
+  std::size_t (*lower_bound)(view<T> const&, T) noexcept;
+  void (*lower_bound_batch)(view<T> const&, T const*, std::size_t, std::size_t*) noexcept;
+};
+
+template <class T>
+kernel_table<T> make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  if constexpr (search::simd_key_v<T>) {
+    switch (usable_isa(which)) {
+      case isa::avx2:
+        return {&lower_bound_avx2<T>, &lower_bound_batch_avx2<T>};
+      case isa::sse42:
+        return {&lower_bound_sse42<T>, &lower_bound_batch_sse42<T>};
+      default:
+        break;
+    }
+  }
+#else
+  (void)which;
+#endif
+  return {&lower_bound_scalar<T>, &lower_bound_batch_scalar<T>};
+}
+
+template <class T>
+kernel_table<T> const& kernels() noexcept {
+  static kernel_table<T> const table = make_kernel_table<T>(active_isa());
+  return table;
+}
+
+template <class T>
+constexpr T padding_key() noexcept {
+  if constexpr (std::numeric_limits<T>::has_infinity)
+    return std::numeric_limits<T>::infinity();
+  else
+    return std::numeric_limits<T>::max();
+}
+
+}  // namespace detail::stree
+
+// T must be an arithmetic type with sizeof(T) dividing the cache line.
+// Floating-point keys must not be NaN.
+template <class T>
+class static_search_tree {
+  static_assert(std::is_arithmetic_v<T> && cache_line_size % sizeof(T) == 0);
+
+ public:
+  static constexpr std::size_t node_keys = cache_line_size / sizeof(T);
+
+  static_search_tree() { build({}); }
+
+  // [first, last) must be sorted in ascending order. The tree and its
+  // build buffer are allocated from `mr`.
+  template <class InputIt>
+  static_search_tree(InputIt first, InputIt last,
+                     std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : offsets_(mr), tree_(mr) {
+    std::pmr::vector<T> sorted(first, last, mr);
+    build(sorted);
+  }
+
+  std::size_t size() const noexcept { return n_; }
+  bool empty() const noexcept { return n_ == 0; }
+  unsigned height() const noexcept { return static_cast<unsigned>(offsets_.size()); }
+  std::size_t memory_bytes() const noexcept { return tree_.size() * sizeof(T); }
+
+  // Position of the first key >= `key` in the original sorted sequence, or
+  // size() if there is none.
+  std::size_t lower_bound(T key) const noexcept {
+    return detail::stree::kernels<T>().lower_bound(view(), key);
+  }
+
+  bool contains(T key) const noexcept {
+    std::size_t const r = lower_bound(key);
+    return r < n_ && !(key < tree_[r]);
+  }
+
+  // out[i] = lower_bound(keys[i]) for i in [0, count).
+  void lower_bound_batch(T const* keys, std::size_t count, std::size_t* out) const noexcept {
+    detail::stree::kernels<T>().lower_bound_batch(view(), keys, count, out);
+  }
+
+  // Same as above with an explicit instruction set (clamped to the host's).
+  std::size_t lower_bound(isa which, T key) const noexcept {
+    return detail::stree::make_kernel_table<T>(which).lower_bound(view(), key);
+  }
+  void lower_bound_batch(isa which, T const* keys, std::size_t count,
+                         std::size_t* out) const noexcept {
+    detail::stree::make_kernel_table<T>(which).lower_bound_batch(view(), keys, count, out);
+  }
+
+ private:
+  static constexpr std::size_t B = node_keys;
+
+  detail::stree::view<T> view() const noexcept {
+    return {tree_.data(), offsets_.data(), height(), n_};
+  }
+
+  void build(span<T const> sorted) {
+    n_ = sorted.size();
+    std::pmr::vector<std::size_t> blocks(1, std::max<std::size_t>(1, (n_ + B - 1) / B),
+                                         offsets_.get_allocator());
+    while (blocks.back() > 1) blocks.push_back((blocks.back() + B) / (B + 1));
+
+    auto& offsets = offsets_.own();
+    auto& tree = tree_.own();
+    offsets.assign(blocks.size(), 0);
+    std::size_t total = 0;
+    for (std::size_t h = 0; h < blocks.size(); ++h) {
+      offsets[h] = total;
+      total += blocks[h] * B;
+    }
+    T const pad = detail::stree::padding_key<T>();
+    tree.assign(total, pad);
+    std::copy(sorted.begin(), sorted.end(), tree.begin());
+
+    // Separator j of node m in layer h is the first key of child
+    // m * (B + 1) + j + 1, i.e. of that child's leftmost leaf.
+    for (std::size_t h = 1; h < blocks.size(); ++h) {
+      for (std::size_t i = 0; i < blocks[h] * B; ++i) {
+        std::size_t const m = i / B, j = i % B;
+        std::size_t leaf = m * (B + 1) + j + 1;
+        for (std::size_t l = 1; l < h; ++l) leaf *= B + 1;
+        tree[offsets[h] + i] = leaf * B < n_ ? tree[leaf * B] : pad;
+      }
+    }
+  }
+
+  friend struct detail::persist::access;
+
+  std::size_t n_ = 0;
+  detail::borrowable_array<std::size_t> offsets_;
+  detail::borrowable_array<T, detail::aligned_allocator<T>> tree_;
+};
+
+}  // namespace algoritmi
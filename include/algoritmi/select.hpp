@@ -0,0 +1,32 @@
+// Selection and order statistics: exact ranks of arrays, approximate ones
+// of streams.
+//
+//   nth_element(first, nth, last[, comp, mr])
+//                                      *nth in sorted position, smaller
+//                                      elements before it; O(n) worst case
+//   nth_elements(first, last, ranks[, comp, mr])
+//                                      the same for many ranks at once
+//   quantiles(first, last, qs[, comp, mr])
+//                                      pmr::vector of the elements of rank
+//                                      floor(q * (n - 1)) for each q
+//   kll_sketch<T[, Compare]>           mergeable quantile sketch of any
+//                                      ordered type, O(1/k) rank error
+//   tdigest                            mergeable sketch of doubles, most
+//                                      accurate in the tails (p99, p99.9)
+//
+// nth_element picks Floyd-Rivest sample pivots and falls back to median of
+// medians on adversarial inputs. For 32/64-bit integers, float and double
+// in contiguous storage it partitions with branch-free SIMD kernels picked
+// at runtime like the search kernels (see cpu.hpp); overloads taking an
+// `isa` run a specific one.
+//
+// Exact selection over a whole array vs a sketch: a sketch costs one
+// update per value and a few KB however long the stream, and sketches of
+// shards merge, so per-thread or per-host sketches give global p50/p99/p999
+// without holding the samples.
+#pragma once
+
+#include "select/kernels.hpp"
+#include "select/kll_sketch.hpp"
+#include "select/nth_element.hpp"
+#include "select/tdigest.hpp"
@@ -0,0 +1,189 @@
+// Partition kernels behind nth_element for arithmetic keys, one version per
+// instruction set, selected like the search kernels (see cpu.hpp).
+//
+//   partition_less   moves the elements < pivot to the front, the others
+//   partition_leq    after them (<= pivot for the second); both stable
+//
+// A vector of keys is compared with the pivot (the search kernels' lane
+// ops), the mask indexes a permutation table, and the matching lanes are
+// packed to the front of the array while the others are packed into a
+// spill buffer that is copied back behind them at the end. The write
+// position never passes the read position, so the front half works in
+// place; full vectors are stored and the next store overwrites the unused
+// lanes. No branch depends on the data, which is where a comparison-based
+// partition around a median-like pivot loses half its time.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+#include "../primitives/kernels.hpp"
+#include "../search/kernels.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::select {
+
+using search::simd_key_v;
+
+// ---------------------------------------------------------------- scalar --
+
+// Branchless: every element is written to both sides, the side that does
+// not take it overwrites it with the next one.
+template <class T, bool OrEqual>
+std::size_t partition_scalar(T* data, std::size_t n, T pivot, T* spill) noexcept {
+  std::size_t l = 0, r = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    T const x = data[i];
+    bool const left = OrEqual ? !(pivot < x) : x < pivot;
+    data[l] = x;
+    spill[r] = x;
+    l += left;
+    r += !left;
+  }
+  std::memcpy(data + l, spill, r * sizeof(T));
+  return l;
+}
+
+#if ALGORITMI_HAS_SIMD
+
+// pshufb tables: entry m lists the bytes of the lanes whose bit is set in
+// m, packed to the front (the remaining bytes are don't-care).
+template <unsigned Lanes>
+constexpr std::array<std::array<std::uint8_t, 16>, (1u << Lanes)> make_shuffle_lut() noexcept {
+  constexpr unsigned width = 16 / Lanes;
+  std::array<std::array<std::uint8_t, 16>, (1u << Lanes)> lut{};
+  for (unsigned m = 0; m < (1u << Lanes); ++m) {
+    unsigned k = 0;
+    for (unsigned lane = 0; lane < Lanes; ++lane)
+      if (m >> lane & 1)
+        for (unsigned b = 0; b < width; ++b)
+          lut[m][k++] = static_cast<std::uint8_t>(lane * width + b);
+    for (; k < 16; ++k) lut[m][k] = 0;
+  }
+  return lut;
+}
+alignas(16) inline constexpr auto shuffle_lut4 = make_shuffle_lut<4>();
+alignas(16) inline constexpr auto shuffle_lut2 = make_shuffle_lut<2>();
+
+// ---------------------------------------------------------------- SSE4.2 --
+
+template <std::size_t Width>
+struct sse_pack_ops {
+  using vec = __m128i;
+  ALGORITMI_TARGET_SSE42 static vec load(void const* p) {
+    return _mm_loadu_si128(static_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static void store(void* p, vec v) {
+    _mm_storeu_si128(static_cast<__m128i*>(p), v);
+  }
+  ALGORITMI_TARGET_SSE42 static vec pack(vec v, unsigned m) {
+    auto const& lut = Width == 4 ? shuffle_lut4[m] : shuffle_lut2[m];
+    return _mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<__m128i const*>(lut.data())));
+  }
+};
+
+// ------------------------------------------------------------------ AVX2 --
+
+template <std::size_t Width>
+struct avx2_pack_ops {
+  using vec = __m256i;
+  ALGORITMI_TARGET_AVX2 static vec load(void const* p) {
+    return _mm256_loadu_si256(static_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static void store(void* p, vec v) {
+    _mm256_storeu_si256(static_cast<__m256i*>(p), v);
+  }
+  ALGORITMI_TARGET_AVX2 static vec pack(vec v, unsigned m) {
+    std::uint64_t const e = Width == 4 ? prims::compact_lut32[m] : prims::compact_lut64[m];
+    __m256i const idx = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(e)));
+    return _mm256_permutevar8x32_epi32(v, idx);
+  }
+};
+
+// The comparison masks come from CMP (the search lane ops, which bias
+// unsigned keys), the packing works on the raw bits through PACK.
+#define ALGORITMI_SELECT_KERNELS(TARGET, SUFFIX, CMP, PACK)                              \
+  template <class T, bool OrEqual>                                                       \
+  TARGET std::size_t partition_##SUFFIX(T* data, std::size_t n, T pivot, T* spill) noexcept { \
+    using cmp = CMP<T>;                                                                  \
+    using pack = PACK<sizeof(T)>;                                                        \
+    constexpr std::size_t L = cmp::lanes;                                                \
+    constexpr unsigned full = (1u << L) - 1;                                             \
+    auto const p = cmp::set1(pivot);                                                     \
+    std::size_t l = 0, r = 0, i = 0;                                                     \
+    for (; i + L <= n; i += L) {                                                         \
+      auto const keys = cmp::load(data + i);                                             \
+      unsigned const m = OrEqual ? full & ~cmp::lt(p, keys) : cmp::lt(keys, p);          \
+      auto const v = pack::load(data + i);                                               \
+      pack::store(data + l, pack::pack(v, m));                                           \
+      pack::store(spill + r, pack::pack(v, full & ~m));                                  \
+      std::size_t const c = static_cast<std::size_t>(popcount(m));                       \
+      l += c;                                                                            \
+      r += L - c;                                                                        \
+    }                                                                                    \
+    for (; i < n; ++i) {                                                                 \
+      T const x = data[i];                                                               \
+      bool const left = OrEqual ? !(pivot < x) : x < pivot;                              \
+      data[l] = x;                                                                       \
+      spill[r] = x;                                                                      \
+      l += left;                                                                         \
+      r += !left;                                                                        \
+    }                                                                                    \
+    std::memcpy(data + l, spill, r * sizeof(T));                                         \
+    return l;                                                                            \
+  }
+
+ALGORITMI_SELECT_KERNELS(ALGORITMI_TARGET_SSE42, sse42, search::sse_ops, sse_pack_ops)
+ALGORITMI_SELECT_KERNELS(ALGORITMI_TARGET_AVX2, avx2, search::avx2_ops, avx2_pack_ops)
+
+#undef ALGORITMI_SELECT_KERNELS
+
+#endif  // ALGORITMI_HAS_SIMD
+
+// Both partitions of one key type, resolved for a given instruction set.
+// `spill` must hold n elements.
+template <class T>
+struct kernel_table {
+  std::size_t (*partition_less)(T*, std::size_t, T, T*) noexcept;
+  std::size_t (*partition_leq)(T*, std::size_t, T, T*) noexcept;
+};
+
+// Empty for other key types, which never reach the kernels.
+template <class T>
+kernel_table<T> make_kernel_table(isa which) noexcept {
+  if constexpr (simd_key_v<T>) {
+#if ALGORITMI_HAS_SIMD
+    switch (usable_isa(which)) {
+      case isa::avx2:
+        return {&partition_avx2<T, false>, &partition_avx2<T, true>};
+      case isa::sse42:
+        return {&partition_sse42<T, false>, &partition_sse42<T, true>};
+      default:
+        break;
+    }
+#else
+    (void)which;
+#endif
+    return {&partition_scalar<T, false>, &partition_scalar<T, true>};
+  } else {
+    (void)which;
+    return {nullptr, nullptr};
+  }
+}
+
+template <class T>
+kernel_table<T> const& kernels() noexcept {
+  static kernel_table<T> const table = make_kernel_table<T>(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::select
@@ -0,0 +1,391 @@
+// Exact selection: nth_element, several ranks at once, quantiles.
+//
+// The pivot comes from a sample around the wanted rank (Floyd and Rivest,
+// 1975, in Kiwiel's formulation): a subrange of n^(2/3) elements around nth
+// is itself selected recursively and its element at nth becomes the pivot,
+// shifted by a few standard deviations towards the far end so that nth
+// lands on the short side. One partition then leaves about min(k, n - k)
+// elements, and n + min(k, n - k) + o(n) comparisons select the k-th of n,
+// against ~3n for median-of-3 quickselect. Ranges of up to 600 elements use
+// median-of-3 pivots, and those of up to 24 are sorted.
+//
+// Samples are taken in place, so adversarial inputs can still defeat them:
+// when three rounds in a row fail to halve the range the selection
+// switches to median of medians (Blum, Floyd, Pratt, Rivest and Tarjan),
+// which guarantees 30% of the range on either side of its pivot. The worst
+// case is O(n), the typical one close to a single pass.
+//
+// For 32/64-bit integers, float and double in contiguous storage under the
+// default ascending order, the partitions are the SIMD kernels of
+// select/kernels.hpp: two pivots bracketing nth's rank in a sample split
+// the range in two branch-free passes (the first over all of it, the second
+// over the side holding nth), after which nth lies in a band of a few
+// percent of the range. The kernels need a scratch array as large as the
+// range, taken from a std::pmr::memory_resource.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../cpu.hpp"
+#include "../detail/scratch.hpp"
+#include "../instrument/counters.hpp"
+#include "../sort/pdqsort.hpp"
+#include "../sort/small_sort.hpp"
+#include "../span.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+namespace detail::select {
+
+inline constexpr std::ptrdiff_t sort_threshold = 24;
+inline constexpr std::ptrdiff_t floyd_rivest_threshold = 600;
+// Below this the comparison-based selection is faster than the two SIMD
+// passes plus the sample.
+inline constexpr std::ptrdiff_t simd_threshold = 2048;
+// Rounds allowed to halve the range before falling back.
+inline constexpr int halving_rounds = 3;
+
+using smallsort::counted;
+
+// Whether [It, Compare] can use the SIMD partition kernels.
+template <class It, class Compare, class T = typename std::iterator_traits<It>::value_type>
+inline constexpr bool simd_v = smallsort::contiguous_v<It> && simd_key_v<T> &&
+                               smallsort::is_default_compare<T, Compare>::value &&
+                               !smallsort::is_descending<Compare>::value;
+
+template <class It, class Compare>
+void sort_small(It first, It last, Compare comp) {
+  using T = typename std::iterator_traits<It>::value_type;
+  if constexpr (smallsort::cheap_v<T, Compare>) {
+    if (last - first <= static_cast<std::ptrdiff_t>(small_sort_max)) {
+      small_sort(first, last, comp);
+      return;
+    }
+  }
+  pdq::insertion_sort(first, last, comp);
+}
+
+// pdq::partition_right without its sentinel: the pivot (at *begin) may be
+// the largest element of the range. Elements equal to it go right; returns
+// the position the pivot ends up at.
+template <class It, class Compare>
+It partition_pivot(It begin, It end, Compare comp) {
+  using T = typename std::iterator_traits<It>::value_type;
+  T pivot(std::move(*begin));
+  It first = begin;
+  It last = end;
+
+  while (++first < end && comp(*first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
+  } else {
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  while (first < last) {
+    std::iter_swap(first, last);
+    ALGORITMI_COUNT(swaps, 1);
+    while (comp(*++first, pivot)) {
+    }
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  It pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}
+
+// Partitions around the value at pivot_pos and narrows [first, last) to
+// the side holding nth; returns false once nth is in place. When the pivot
+// equals the element left of the range (so every element here is >= it),
+// its copies are grouped on the left instead and skipped, which keeps
+// runs of duplicates from stalling the selection.
+template <class It, class Compare>
+bool narrow(It& first, It nth, It& last, It pivot_pos, bool& leftmost, Compare comp) {
+  std::iter_swap(first, pivot_pos);
+  if (!leftmost && !comp(*(first - 1), *first)) {
+    It const pos = pdq::partition_left(first, last, comp);
+    if (nth <= pos) return false;
+    first = pos + 1;
+    return true;
+  }
+  It const pos = partition_pivot(first, last, comp);
+  if (nth == pos) return false;
+  if (nth < pos) {
+    last = pos;
+  } else {
+    first = pos + 1;
+    leftmost = false;
+  }
+  return true;
+}
+
+template <class It, class Compare>
+void median_of_medians(It first, It nth, It last, Compare comp, bool leftmost = true) {
+  while (last - first > sort_threshold) {
+    // Medians of groups of five, gathered at the front.
+    It medians = first;
+    for (It g = first; last - g >= 5; g += 5) {
+      pdq::insertion_sort(g, g + 5, comp);
+      std::iter_swap(medians++, g + 2);
+    }
+    It const mid = first + (medians - first) / 2;
+    median_of_medians(first, mid, medians, comp);
+    if (!narrow(first, nth, last, mid, leftmost, comp)) return;
+  }
+  sort_small(first, last, comp);
+}
+
+template <class It, class Compare>
+void select_loop(It first, It nth, It last, Compare comp, bool leftmost = true) {
+  using diff_t = typename std::iterator_traits<It>::difference_type;
+  diff_t checkpoint = last - first;
+  int rounds = 0;
+  while (last - first > sort_threshold) {
+    diff_t const n = last - first;
+    if (++rounds > halving_rounds) {
+      if (n > checkpoint / 2) {
+        median_of_medians(first, nth, last, comp, leftmost);
+        return;
+      }
+      checkpoint = n;
+      rounds = 1;
+    }
+
+    It pivot;
+    if (n > floyd_rivest_threshold) {
+      // Select nth within a sample subrange around it; the window is
+      // shifted away from the nearer end so nth falls on the short side.
+      double const size = static_cast<double>(n);
+      double const i = static_cast<double>(nth - first);
+      double const z = std::log(size);
+      double const s = 0.5 * std::exp(2.0 * z / 3.0);
+      double const sd = 0.5 * std::sqrt(z * s * (size - s) / size) * (i < size / 2 ? -1 : 1);
+      auto const lo = static_cast<diff_t>(std::max(0.0, i - i * s / size + sd));
+      auto const hi = static_cast<diff_t>(std::min(size, i + (size - i) * s / size + sd + 1));
+      select_loop(first + lo, nth, first + hi, comp);
+      pivot = nth;
+    } else {
+      diff_t const s2 = n / 2;
+      pdq::sort3(first + 1, first + s2, last - 1, comp);
+      pivot = first + s2;
+    }
+    if (!narrow(first, nth, last, pivot, leftmost, comp)) return;
+  }
+  sort_small(first, last, comp);
+}
+
+// The SIMD path: two pivots from a strided sample bracket nth's rank, two
+// kernel passes cut the range down to the band between them.
+template <class T>
+void select_simd(kernel_table<T> const& k, T* first, T* nth, T* last, T* spill) {
+  std::ptrdiff_t checkpoint = last - first;
+  int rounds = 0;
+  while (last - first > simd_threshold) {
+    std::ptrdiff_t const n = last - first;
+    if (++rounds > halving_rounds) {
+      if (n > checkpoint / 2) break;
+      checkpoint = n;
+      rounds = 1;
+    }
+
+    double const size = static_cast<double>(n);
+    double const z = std::log(size);
+    auto const s = static_cast<std::ptrdiff_t>(0.5 * std::exp(2.0 * z / 3.0));
+    std::ptrdiff_t const stride = n / s;
+    for (std::ptrdiff_t j = 0; j < s; ++j) spill[j] = first[j * stride + stride / 2];
+    // nth's expected rank in the sample, +- four standard deviations.
+    auto const rank = static_cast<std::ptrdiff_t>(static_cast<double>(nth - first) / size *
+                                                  static_cast<double>(s));
+    auto const gap = static_cast<std::ptrdiff_t>(std::sqrt(static_cast<double>(s) * z) / 2) + 1;
+    std::ptrdiff_t const lo_rank = std::max<std::ptrdiff_t>(0, rank - gap);
+    std::ptrdiff_t const hi_rank = std::min<std::ptrdiff_t>(s - 1, rank + gap);
+    auto const less = counted(std::less<T>());
+    select_loop(spill, spill + lo_rank, spill + s, less);
+    select_loop(spill + lo_rank, spill + hi_rank, spill + s, less);
+    T const lo = spill[lo_rank];
+    T const hi = spill[hi_rank];
+
+    // Cut the larger side first, so the second pass reads the smaller one.
+    auto const count = static_cast<std::size_t>(n);
+    if (nth - first < n / 2) {
+      std::size_t const le = k.partition_leq(first, count, hi, spill);
+      if (nth >= first + le) {
+        first += le;
+        continue;
+      }
+      last = first + le;
+      std::size_t const lt = k.partition_less(first, le, lo, spill);
+      if (nth < first + lt) {
+        last = first + lt;
+        continue;
+      }
+      first += lt;
+    } else {
+      std::size_t const lt = k.partition_less(first, count, lo, spill);
+      if (nth < first + lt) {
+        last = first + lt;
+        continue;
+      }
+      first += lt;
+      std::size_t const le = k.partition_leq(first, count - lt, hi, spill);
+      if (nth >= first + le) {
+        first += le;
+        continue;
+      }
+      last = first + le;
+    }
+    // Everything in [lo, hi]; with lo == hi that is a run of equal keys.
+    if (!(lo < hi)) return;
+  }
+  select_loop(first, nth, last, counted(std::less<T>()));
+}
+
+template <class It, class Compare>
+void select(kernel_table<typename std::iterator_traits<It>::value_type> const& k, It first,
+            It nth, It last, Compare comp, std::pmr::memory_resource* mr) {
+  using T = typename std::iterator_traits<It>::value_type;
+  if (nth >= last || last - first < 2) return;
+  if constexpr (simd_v<It, Compare>) {
+    if (last - first > simd_threshold) {
+      auto const n = static_cast<std::size_t>(last - first);
+      scratch_buffer<T> spill(n, mr);
+      T* const p = &*first;
+      select_simd(k, p, p + (nth - first), p + n, spill.get());
+      return;
+    }
+  } else {
+    (void)k;
+    (void)mr;
+  }
+  auto const c = counted(comp);
+  select_loop(first, nth, last, c);
+}
+
+// Ranks [rank_first, rank_last) are sorted, distinct and relative to base;
+// each level of the recursion is one selection pass over its range.
+template <class It, class Compare>
+void multi_select(kernel_table<typename std::iterator_traits<It>::value_type> const& k, It first,
+                  It last, std::size_t const* rank_first, std::size_t const* rank_last,
+                  std::size_t base, Compare comp, std::pmr::memory_resource* mr) {
+  while (rank_first != rank_last) {
+    std::size_t const* const mid = rank_first + (rank_last - rank_first) / 2;
+    It const nth = first + static_cast<std::ptrdiff_t>(*mid - base);
+    select(k, first, nth, last, comp, mr);
+    multi_select(k, first, nth, rank_first, mid, base, comp, mr);
+    base = *mid + 1;
+    first = nth + 1;
+    rank_first = mid + 1;
+  }
+}
+
+template <class It, class Compare>
+void nth_elements(kernel_table<typename std::iterator_traits<It>::value_type> const& k, It first,
+                  It last, span<std::size_t const> ranks, Compare comp,
+                  std::pmr::memory_resource* mr) {
+  auto const n = static_cast<std::size_t>(last - first);
+  scratch_buffer<std::size_t> sorted(ranks.size(), mr);
+  std::size_t* const r = sorted.get();
+  for (std::size_t i = 0; i < ranks.size(); ++i) {
+    if (ranks[i] >= n) throw std::out_of_range("nth_elements: rank past the end of the range");
+    r[i] = ranks[i];
+  }
+  std::sort(r, r + ranks.size());
+  std::size_t* const end = std::unique(r, r + ranks.size());
+  multi_select(k, first, last, r, end, 0, comp, mr);
+}
+
+}  // namespace detail::select
+
+// Rearranges [first, last) so that *nth is the element a sort would put
+// there, with nothing after it less and nothing before it greater. Not
+// stable. O(n) worst case; scratch for the SIMD path comes from `mr`.
+template <class RandomIt, class Compare>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last, Compare comp,
+                 std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  detail::select::select(detail::select::kernels<T>(), first, nth, last, comp, mr);
+}
+
+template <class RandomIt>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last) {
+  algoritmi::nth_element(first, nth, last,
+                         std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+// Same as above with an explicit instruction set (clamped to the host's).
+template <class T>
+void nth_element(isa which, T* first, T* nth, T* last,
+                 std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::select::select(detail::select::make_kernel_table<T>(which), first, nth, last,
+                         std::less<T>(), mr);
+}
+
+// nth_element for every rank in `ranks` (any order, duplicates allowed):
+// afterwards first[r] is in sorted position for each r, and the elements
+// between two consecutive ranks are in between them. Costs O(n log m) for
+// m distinct ranks. Throws std::out_of_range for a rank >= last - first.
+template <class RandomIt, class Compare>
+void nth_elements(RandomIt first, RandomIt last, span<std::size_t const> ranks, Compare comp,
+                  std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  detail::select::nth_elements(detail::select::kernels<T>(), first, last, ranks, comp, mr);
+}
+
+template <class RandomIt>
+void nth_elements(RandomIt first, RandomIt last, span<std::size_t const> ranks) {
+  nth_elements(first, last, ranks,
+               std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+template <class T>
+void nth_elements(isa which, T* first, T* last, span<std::size_t const> ranks,
+                  std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::select::nth_elements(detail::select::make_kernel_table<T>(which), first, last, ranks,
+                               std::less<T>(), mr);
+}
+
+// The element of rank floor(q * (n - 1)) for each q in [0, 1] (the "lower"
+// quantile: always an element of the input, p50 of {1, 2, 3, 4} is 2), in
+// the order of `qs`. Rearranges [first, last) like nth_elements. Throws
+// std::invalid_argument for an empty range or q outside [0, 1].
+template <class RandomIt, class Compare>
+std::pmr::vector<typename std::iterator_traits<RandomIt>::value_type> quantiles(
+    RandomIt first, RandomIt last, span<double const> qs, Compare comp,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  auto const n = static_cast<std::size_t>(last - first);
+  if (n == 0 && !qs.empty()) throw std::invalid_argument("quantiles: empty range");
+  std::pmr::vector<std::size_t> ranks(qs.size(), mr);
+  for (std::size_t i = 0; i < qs.size(); ++i) {
+    if (!(qs[i] >= 0.0 && qs[i] <= 1.0))
+      throw std::invalid_argument("quantiles: q must be in [0, 1]");
+    ranks[i] = static_cast<std::size_t>(qs[i] * static_cast<double>(n - 1));
+  }
+  nth_elements(first, last, span<std::size_t const>(ranks.data(), ranks.size()), comp, mr);
+  std::pmr::vector<typename std::iterator_traits<RandomIt>::value_type> out(mr);
+  out.reserve(qs.size());
+  for (std::size_t r : ranks) out.push_back(first[static_cast<std::ptrdiff_t>(r)]);
+  return out;
+}
+
+template <class RandomIt>
+std::pmr::vector<typename std::iterator_traits<RandomIt>::value_type> quantiles(
+    RandomIt first, RandomIt last, span<double const> qs) {
+  return quantiles(first, last, qs,
+                   std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+}  // namespace algoritmi
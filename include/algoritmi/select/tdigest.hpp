@@ -0,0 +1,206 @@
+// Merging t-digest (Dunning and Ertl, 2019) for streaming percentiles of
+// doubles.
+//
+// The digest is a sorted list of centroids (mean, weight). New values are
+// buffered and folded in by one radix sort and one merge pass; a centroid
+// may only grow while the q-range it covers spans at most one unit of the
+// scale function k(q) = compression / (2 pi) * asin(2q - 1), whose slope
+// is infinite at q = 0 and q = 1. Centroids near the median therefore hold
+// many values and those in the tails a handful, down to single values at
+// the extremes, so the relative error of p99 and p99.9 is far smaller than
+// a uniform rank bound gives. Quantiles interpolate between centroid means.
+//
+// At most ~compression centroids are kept (200 is ~3 KB with a buffer of
+// the same order); digests merge by pooling centroids, so shards of a
+// stream can be summarised separately and combined.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../sort/radix_sort.hpp"
+
+namespace algoritmi {
+
+class tdigest {
+ public:
+  struct centroid {
+    double mean;
+    double weight;
+  };
+
+  // Throws std::invalid_argument unless compression >= 10.
+  explicit tdigest(double compression = 200,
+                   std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : compression_(compression), centroids_(mr), buffer_(mr) {
+    if (!(compression >= 10)) throw std::invalid_argument("tdigest: compression must be >= 10");
+    buffer_.reserve(buffer_capacity());
+  }
+
+  bool empty() const noexcept { return total_ == 0; }
+  // Sum of the weights added.
+  double count() const noexcept { return total_; }
+  double compression() const noexcept { return compression_; }
+
+  // Requires !empty().
+  double min() const noexcept {
+    assert(!empty());
+    return min_;
+  }
+  double max() const noexcept {
+    assert(!empty());
+    return max_;
+  }
+
+  // Adds x with weight w > 0. NaNs are ignored.
+  void add(double x, double w = 1.0) {
+    if (std::isnan(x) || !(w > 0)) return;
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+    total_ += w;
+    buffer_.push_back({x, w});
+    if (buffer_.size() >= buffer_capacity()) flush();
+  }
+
+  // Adds everything `other` has seen.
+  void merge(tdigest const& other) {
+    if (&other == this) {
+      tdigest const copy(*this);
+      merge(copy);
+      return;
+    }
+    other.flush();
+    if (other.empty()) return;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    total_ += other.total_;
+    for (centroid const& c : other.centroids_) {
+      buffer_.push_back(c);
+      if (buffer_.size() >= buffer_capacity()) flush();
+    }
+  }
+
+  // Estimated value of rank q in [0, 1]. Requires !empty().
+  double quantile(double q) const {
+    assert(!empty());
+    flush();
+    if (q <= 0) return min_;
+    if (q >= 1) return max_;
+    std::size_t const n = centroids_.size();
+    if (n == 1) return centroids_[0].mean;
+
+    // A centroid's mean sits at the middle of the weight it covers; the
+    // first and last half-centroids reach out to the exact extremes.
+    double const index = q * total_;
+    centroid const& first = centroids_[0];
+    if (index < first.weight / 2)
+      return min_ + (first.mean - min_) * index / (first.weight / 2);
+    double cum = 0;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+      centroid const& a = centroids_[i];
+      centroid const& b = centroids_[i + 1];
+      double const lo = cum + a.weight / 2;
+      double const hi = cum + a.weight + b.weight / 2;
+      if (index < hi) return a.mean + (b.mean - a.mean) * (index - lo) / (hi - lo);
+      cum += a.weight;
+    }
+    centroid const& last = centroids_[n - 1];
+    double const lo = total_ - last.weight / 2;
+    return last.mean + (max_ - last.mean) * std::min(1.0, (index - lo) / (last.weight / 2));
+  }
+
+  // Estimated fraction of the weight at values <= x. Requires !empty().
+  double cdf(double x) const {
+    assert(!empty());
+    flush();
+    if (x < min_) return 0;
+    if (x >= max_) return 1;
+    std::size_t const n = centroids_.size();
+    centroid const& first = centroids_[0];
+    if (x < first.mean) {
+      double const span = first.mean - min_;
+      return span > 0 ? (x - min_) / span * (first.weight / 2) / total_ : 0;
+    }
+    double cum = 0;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+      centroid const& a = centroids_[i];
+      centroid const& b = centroids_[i + 1];
+      if (x < b.mean) {
+        double const lo = cum + a.weight / 2;
+        double const hi = cum + a.weight + b.weight / 2;
+        return (lo + (hi - lo) * (x - a.mean) / (b.mean - a.mean)) / total_;
+      }
+      cum += a.weight;
+    }
+    centroid const& last = centroids_[n - 1];
+    double const lo = total_ - last.weight / 2;
+    return (lo + (x - last.mean) / (max_ - last.mean) * (last.weight / 2)) / total_;
+  }
+
+  // The centroids in order of their means, after folding in the buffer.
+  std::pmr::vector<centroid> const& centroids() const {
+    flush();
+    return centroids_;
+  }
+
+ private:
+  std::size_t buffer_capacity() const noexcept {
+    return static_cast<std::size_t>(5 * compression_);
+  }
+
+  // k(q) and its inverse, for the limit on the next centroid's right edge.
+  double scale(double q) const noexcept {
+    return compression_ / (2 * pi) * std::asin(2 * q - 1);
+  }
+  double inverse_scale(double k) const noexcept {
+    double const a = std::min(std::max(2 * pi * k / compression_, -pi / 2), pi / 2);
+    return (std::sin(a) + 1) / 2;
+  }
+
+  // Sorts the buffer into the centroids and merges greedily left to right.
+  void flush() const {
+    if (buffer_.empty()) return;
+    buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+    radix_sort(buffer_.begin(), buffer_.end(), [](centroid const& c) { return c.mean; },
+               buffer_.get_allocator().resource());
+    centroids_.clear();
+    double total = 0;
+    for (centroid const& c : buffer_) total += c.weight;
+
+    centroid cur = buffer_[0];
+    double left = 0;  // weight before cur
+    double limit = total * inverse_scale(scale(0) + 1);
+    for (std::size_t i = 1; i < buffer_.size(); ++i) {
+      centroid const& c = buffer_[i];
+      if (left + cur.weight + c.weight <= limit) {
+        cur.weight += c.weight;
+        cur.mean += (c.mean - cur.mean) * c.weight / cur.weight;
+      } else {
+        centroids_.push_back(cur);
+        left += cur.weight;
+        limit = total * inverse_scale(scale(left / total) + 1);
+        cur = c;
+      }
+    }
+    centroids_.push_back(cur);
+    buffer_.clear();
+  }
+
+  static constexpr double pi = 3.14159265358979323846;
+
+  double compression_;
+  // Queries fold the buffer in, so both are caches of the same state.
+  mutable std::pmr::vector<centroid> centroids_;
+  mutable std::pmr::vector<centroid> buffer_;
+  double total_ = 0;
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+};
+
+}  // namespace algoritmi
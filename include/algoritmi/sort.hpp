@@ -0,0 +1,88 @@
+// Sorting entry points.
+//
+//   algoritmi::sort(first, last)            radix sort for arithmetic keys,
+//                                           pdqsort otherwise
+//   algoritmi::sort(first, last, comp)      pdqsort
+//   algoritmi::sort(algoritmi::par, ...)    same, multi-threaded above a few
+//                                           million elements
+//
+// The individual algorithms (radix_sort, pdqsort) are available directly
+// when a specific one is wanted, e.g. radix_sort with a key extractor.
+// radix_sort(first, last, key, mr) and pdqsort(par, first, last, comp, mr)
+// take their scratch space from a std::pmr::memory_resource.
+//
+//   external_sort<T>(in, out[, comp, options])  files of fixed-size records
+//                                           larger than memory (POSIX)
+//   loser_tree<T>                           k-way merge tournament
+//
+//   small_sort(first, last[, comp])         at most small_sort_max elements,
+//                                           in SIMD registers where possible
+//   static_sort<N>(first[, comp])           unrolled sorting network
+//   sorting_network<N>()                    its comparator pairs
+//   branchless_insertion_sort(first, last[, comp])
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+#include "execution.hpp"
+#include "sort/loser_tree.hpp"
+#include "sort/parallel_sort.hpp"
+#include "sort/pdqsort.hpp"
+#include "sort/radix_sort.hpp"
+#include "sort/small_sort.hpp"
+
+#if __has_include(<unistd.h>)
+#include "sort/external_sort.hpp"
+#endif
+
+namespace algoritmi {
+namespace detail {
+
+template <class RandomIt>
+inline constexpr bool radix_sortable_v =
+    std::is_arithmetic_v<typename std::iterator_traits<RandomIt>::value_type> &&
+    !std::is_same_v<typename std::iterator_traits<RandomIt>::value_type, bool>;
+
+// Radix sort does a fixed number of passes per key byte, so wide keys need
+// larger inputs before it overtakes pdqsort.
+template <class RandomIt>
+inline bool prefer_radix(RandomIt first, RandomIt last) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  return last - first >= static_cast<std::ptrdiff_t>(256 * sizeof(T));
+}
+
+}  // namespace detail
+
+template <class RandomIt>
+void sort(RandomIt first, RandomIt last) {
+  if constexpr (detail::radix_sortable_v<RandomIt>) {
+    if (detail::prefer_radix(first, last)) {
+      radix_sort(first, last);
+      return;
+    }
+  }
+  pdqsort(first, last);
+}
+
+template <class RandomIt, class Compare>
+void sort(RandomIt first, RandomIt last, Compare comp) {
+  pdqsort(first, last, comp);
+}
+
+template <class RandomIt>
+void sort(parallel_policy policy, RandomIt first, RandomIt last) {
+  if constexpr (detail::radix_sortable_v<RandomIt>)
+    radix_sort(policy, first, last);
+  else
+    pdqsort(policy, first, last);
+}
+
+template <class RandomIt, class Compare>
+void sort(parallel_policy policy, RandomIt first, RandomIt last, Compare comp) {
+  pdqsort(policy, first, last, comp);
+}
+
+}  // namespace algoritmi
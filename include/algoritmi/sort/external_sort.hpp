@@ -0,0 +1,337 @@
+// External merge sort for files of fixed-size records that do not fit in
+// memory.
+//
+// Pass 0 cuts the input into runs as large as the memory budget allows,
+// sorts each with the in-memory sorter and writes it back out. Two run
+// buffers alternate: while one is sorted and written, the next run is
+// already being read into the other by a background I/O thread, so the
+// disk never waits for the CPU and the other way round.
+//
+// Merge passes combine up to `fan_in` runs with a loser tree. Each run is
+// read in blocks, again double-buffered: the block after the current one is
+// in flight while the current one is consumed, and the output alternates
+// between two blocks the same way. With the default 1 MiB blocks a 1 GiB
+// budget merges ~500 runs at once, so 100 GB inputs finish in one merge
+// pass; fewer runs than fit are merged in one pass with smaller blocks
+// rather than two.
+//
+// Records are raw bytes: T must be trivially copyable, and the input size
+// a multiple of sizeof(T). Intermediate files live in the temporary
+// directory and are unlinked as soon as they are created.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../config.hpp"
+#include "../detail/file.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "loser_tree.hpp"
+#include "parallel_sort.hpp"
+#include "pdqsort.hpp"
+#include "radix_sort.hpp"
+
+namespace algoritmi {
+
+struct external_sort_options {
+  // Bytes of record buffers held at once, in-memory sort scratch included.
+  std::size_t memory_budget = std::size_t{256} << 20;
+  // Read size per run while merging.
+  std::size_t block_bytes = std::size_t{1} << 20;
+  // Directory for intermediate runs; empty selects temp_directory_path().
+  std::filesystem::path temp_dir;
+  // Read the input through a memory mapping instead of pread.
+  bool use_mmap = false;
+};
+
+struct external_sort_stats {
+  std::uint64_t records = 0;
+  std::size_t runs = 0;          // sorted runs written by pass 0
+  std::size_t merge_passes = 0;  // 0 when the input fit in one run
+};
+
+namespace detail::external {
+
+// Smallest block a merge uses before it prefers an extra pass instead.
+inline constexpr std::size_t min_merge_block = std::size_t{64} << 10;
+
+struct run {
+  std::uint64_t first;  // in records
+  std::uint64_t count;
+};
+
+class input {
+ public:
+  input(std::filesystem::path const& path, bool use_mmap) : file_(file::open_read(path)) {
+    if (use_mmap)
+      map_.emplace(file_);
+    else
+      file_.advise_sequential();
+  }
+
+  std::uint64_t size() const { return file_.size(); }
+
+  void read(void* dst, std::size_t bytes, std::uint64_t offset) const {
+    if (map_)
+      std::memcpy(dst, map_->data() + offset, bytes);
+    else
+      file_.read_at(dst, bytes, offset);
+  }
+
+ private:
+  file file_;
+  std::optional<mapped_file> map_;
+};
+
+// Pass 0: sorts consecutive chunks of run_records records and writes each
+// to `out` at its input position.
+template <class T, class SortRun>
+std::pmr::vector<run> form_runs(input const& in, file const& out, std::uint64_t records,
+                                std::size_t run_records, SortRun sort_run,
+                                std::pmr::memory_resource* mr) {
+  std::pmr::vector<run> runs(mr);
+  if (records == 0) return runs;
+  std::uint64_t const count = (records + run_records - 1) / run_records;
+  auto chunk = [&](std::uint64_t r) {
+    std::uint64_t const first = r * run_records;
+    return run{first, std::min<std::uint64_t>(run_records, records - first)};
+  };
+  std::size_t const buffer = static_cast<std::size_t>(std::min<std::uint64_t>(run_records, records));
+  scratch_buffer<T> a(buffer, mr, cache_line_size);
+  scratch_buffer<T> b(count > 1 ? buffer : 0, mr, cache_line_size);
+  T* const buf[2] = {a.get(), b.get()};
+  runs.reserve(static_cast<std::size_t>(count));
+
+  io_worker io;  // after the buffers: its destructor drains pending jobs
+  auto read = [&](std::uint64_t r) {
+    run const c = chunk(r);
+    T* const dst = buf[r & 1];
+    return io.submit([&in, c, dst] { in.read(dst, c.count * sizeof(T), c.first * sizeof(T)); });
+  };
+  std::future<void> next = read(0);
+  std::future<void> written;
+  for (std::uint64_t r = 0; r < count; ++r) {
+    next.get();
+    if (r + 1 < count) next = read(r + 1);
+    run const c = chunk(r);
+    T* const cur = buf[r & 1];
+    sort_run(cur, cur + c.count);
+    if (written.valid()) written.get();
+    written = io.submit(
+        [&out, c, cur] { out.write_at(cur, c.count * sizeof(T), c.first * sizeof(T)); });
+    runs.push_back(c);
+  }
+  written.get();
+  return runs;
+}
+
+// Merges the k runs of `src` into `dst` starting at record `dst_first`.
+template <class T, class Compare>
+void merge_runs(file const& src, run const* runs, std::size_t k, file const& dst,
+                std::uint64_t dst_first, std::size_t block, Compare const& comp,
+                std::pmr::memory_resource* mr) {
+  struct reader {
+    T* buf[2];
+    unsigned active;
+    T const* cur;
+    T const* end;
+    std::uint64_t next;  // next record to request
+    std::uint64_t stop;
+    std::size_t pending_count;
+    std::future<void> pending;
+  };
+
+  scratch_buffer<T> storage(2 * (k + 1) * block, mr, cache_line_size);
+  std::pmr::vector<reader> readers(k, mr);
+  io_worker io;
+
+  auto request = [&](reader& r, unsigned which) {
+    std::size_t const n = static_cast<std::size_t>(std::min<std::uint64_t>(block, r.stop - r.next));
+    r.pending_count = n;
+    if (n == 0) return;
+    T* const to = r.buf[which];
+    std::uint64_t const at = r.next;
+    r.pending = io.submit([&src, to, n, at] { src.read_at(to, n * sizeof(T), at * sizeof(T)); });
+    r.next += n;
+  };
+  // Switches to the block in flight and requests the one after it; false
+  // once the run is used up.
+  auto advance = [&](reader& r) {
+    if (r.pending_count == 0) return false;
+    r.pending.get();
+    r.active ^= 1;
+    r.cur = r.buf[r.active];
+    r.end = r.cur + r.pending_count;
+    request(r, r.active ^ 1);
+    return true;
+  };
+
+  loser_tree<T, Compare> tree(k, comp, mr);
+  for (std::size_t i = 0; i < k; ++i) {
+    reader& r = readers[i];
+    r.buf[0] = storage.get() + 2 * i * block;
+    r.buf[1] = r.buf[0] + block;
+    r.active = 1;
+    r.next = runs[i].first;
+    r.stop = runs[i].first + runs[i].count;
+    request(r, 0);
+  }
+  for (std::size_t i = 0; i < k; ++i) tree.set(i, advance(readers[i]) ? readers[i].cur : nullptr);
+  tree.build();
+
+  T* const out_buf[2] = {storage.get() + 2 * k * block, storage.get() + (2 * k + 1) * block};
+  std::future<void> out_pending[2];
+  unsigned out_active = 0;
+  T* out = out_buf[0];
+  std::uint64_t out_pos = dst_first;
+  auto flush = [&] {
+    T* const from = out_buf[out_active];
+    std::size_t const n = static_cast<std::size_t>(out - from);
+    std::uint64_t const at = out_pos;
+    out_pending[out_active] =
+        io.submit([&dst, from, n, at] { dst.write_at(from, n * sizeof(T), at * sizeof(T)); });
+    out_pos += n;
+    out_active ^= 1;
+    if (out_pending[out_active].valid()) out_pending[out_active].get();
+    out = out_buf[out_active];
+  };
+
+  while (!tree.empty()) {
+    reader& r = readers[tree.top_source()];
+    *out++ = *r.cur;
+    if (out == out_buf[out_active] + block) flush();
+    ++r.cur;
+    tree.replace_top((r.cur != r.end || advance(r)) ? r.cur : nullptr);
+  }
+  if (out != out_buf[out_active]) flush();
+  for (auto& f : out_pending)
+    if (f.valid()) f.get();
+}
+
+template <class T, class Compare, class SortRun>
+external_sort_stats sort_file(std::filesystem::path const& input_path,
+                              std::filesystem::path const& output_path, Compare const& comp,
+                              external_sort_options const& options, bool sort_in_place,
+                              SortRun sort_run, std::pmr::memory_resource* mr) {
+  static_assert(std::is_trivially_copyable_v<T>, "external_sort sorts raw records");
+  constexpr std::size_t rec = sizeof(T);
+
+  std::error_code ec;
+  if (std::filesystem::equivalent(input_path, output_path, ec))
+    throw std::invalid_argument("external_sort: input and output are the same file");
+
+  input const in(input_path, options.use_mmap);
+  std::uint64_t const bytes = in.size();
+  if (bytes % rec != 0)
+    throw std::invalid_argument("external_sort: input size is not a multiple of the record size");
+  std::uint64_t const records = bytes / rec;
+
+  // Two run buffers, plus as much again for sorters that need scratch.
+  std::size_t const run_records = options.memory_budget / rec / (sort_in_place ? 2 : 3);
+  std::size_t const block_limit = std::max<std::size_t>(options.block_bytes / rec, 1);
+  if (run_records == 0 || options.memory_budget / rec < 6)
+    throw std::invalid_argument("external_sort: memory budget below six records");
+
+  external_sort_stats stats;
+  stats.records = records;
+  file const output = file::create(output_path);
+  if (records <= run_records) {
+    stats.runs = records ? 1 : 0;
+    form_runs<T>(in, output, records, run_records, sort_run, mr);
+    return stats;
+  }
+
+  std::filesystem::path const dir =
+      options.temp_dir.empty() ? std::filesystem::temp_directory_path() : options.temp_dir;
+  file current = file::anonymous(dir);
+  std::pmr::vector<run> runs = form_runs<T>(in, current, records, run_records, sort_run, mr);
+  stats.runs = runs.size();
+
+  // A merge of k runs holds 2k + 2 blocks. Merge everything at once if the
+  // blocks stay reasonably large, else in groups of fan_in.
+  std::size_t const budget_records = options.memory_budget / rec;
+  std::size_t const min_block = std::max<std::size_t>(min_merge_block / rec, 1);
+  while (runs.size() > 1) {
+    std::size_t block = std::min(block_limit, budget_records / (2 * (runs.size() + 1)));
+    std::size_t fan_in = runs.size();
+    if (block < min_block) {
+      block = std::min(block_limit, budget_records / 6);
+      fan_in = std::max<std::size_t>(budget_records / block / 2 - 1, 2);
+    }
+    bool const last = runs.size() <= fan_in;
+    std::optional<file> next;
+    if (!last) next.emplace(file::anonymous(dir));
+    file const& target = last ? output : *next;
+
+    std::pmr::vector<run> merged(mr);
+    std::uint64_t pos = 0;
+    for (std::size_t g = 0; g < runs.size(); g += fan_in) {
+      std::size_t const k = std::min(fan_in, runs.size() - g);
+      std::uint64_t total = 0;
+      for (std::size_t i = g; i < g + k; ++i) total += runs[i].count;
+      merge_runs<T>(current, runs.data() + g, k, target, pos, block, comp, mr);
+      merged.push_back({pos, total});
+      pos += total;
+    }
+    ++stats.merge_passes;
+    runs = std::move(merged);
+    if (!last) current = std::move(*next);
+  }
+  return stats;
+}
+
+}  // namespace detail::external
+
+// Sorts the records of `input` into `output` (created or truncated). The
+// in-memory sorter is radix_sort when Compare is std::less on an
+// arithmetic type and pdqsort otherwise; scratch buffers come from `mr`,
+// and their size is bounded by options.memory_budget.
+template <class T, class Compare = std::less<T>>
+external_sort_stats external_sort(std::filesystem::path const& input,
+                                  std::filesystem::path const& output, Compare comp = Compare(),
+                                  external_sort_options const& options = {},
+                                  std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  constexpr bool radix = std::is_arithmetic_v<T> && std::is_same_v<Compare, std::less<T>>;
+  return detail::external::sort_file<T>(
+      input, output, comp, options, !radix,
+      [&](T* first, T* last) {
+        if constexpr (radix)
+          radix_sort(first, last, identity_key{}, mr);
+        else
+          pdqsort(first, last, comp);
+      },
+      mr);
+}
+
+// Same, with runs sorted on all cores. Input and merging stay on one
+// background I/O thread each; the merge itself is sequential.
+template <class T, class Compare = std::less<T>>
+external_sort_stats external_sort(parallel_policy policy, std::filesystem::path const& input,
+                                  std::filesystem::path const& output, Compare comp = Compare(),
+                                  external_sort_options const& options = {},
+                                  std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  constexpr bool radix = std::is_arithmetic_v<T> && std::is_same_v<Compare, std::less<T>>;
+  return detail::external::sort_file<T>(
+      input, output, comp, options, false,
+      [&](T* first, T* last) {
+        if constexpr (radix)
+          radix_sort(policy, first, last, identity_key{}, mr);
+        else
+          pdqsort(policy, first, last, comp, mr);
+      },
+      mr);
+}
+
+}  // namespace algoritmi
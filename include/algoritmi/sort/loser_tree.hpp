@@ -0,0 +1,91 @@
+// Tournament tree of losers for k-way merging (Knuth, TAOCP vol. 3, 5.4.1).
+//
+// Each internal node remembers the source that lost the match played there
+// and the overall winner sits on top. Replacing the winner's head replays
+// only the matches on its leaf-to-root path: exactly ceil(log2 k)
+// comparisons, against log2 k to 2 log2 k for a binary heap, and without
+// reading the sibling of every node on the path.
+//
+// The tree holds pointers to the current head of each source, not copies,
+// so records of any size cost the same to move through it. Ties go to the
+// lower source index, so merging runs in input order is stable.
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace algoritmi {
+
+template <class T, class Compare = std::less<T>>
+class loser_tree {
+ public:
+  explicit loser_tree(std::size_t k, Compare comp = Compare(),
+                      std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : comp_(std::move(comp)), heads_(k, nullptr, mr), tree_(k ? k : 1, 0, mr) {}
+
+  std::size_t sources() const noexcept { return heads_.size(); }
+
+  // Sets the head of source i; nullptr marks it as exhausted. Set every
+  // source, then build().
+  void set(std::size_t i, T const* head) noexcept { heads_[i] = head; }
+
+  void build() {
+    std::size_t const k = heads_.size();
+    if (k <= 1) {
+      tree_[0] = 0;
+      return;
+    }
+    // Node j has children 2j and 2j + 1; leaf i is node k + i. That is a
+    // complete binary tree for any k, powers of two or not.
+    std::pmr::vector<std::uint32_t> winner(2 * k, 0, heads_.get_allocator().resource());
+    for (std::size_t i = 0; i < k; ++i) winner[k + i] = static_cast<std::uint32_t>(i);
+    for (std::size_t j = k - 1; j > 0; --j) {
+      std::uint32_t a = winner[2 * j];
+      std::uint32_t b = winner[2 * j + 1];
+      if (beats(b, a)) std::swap(a, b);
+      winner[j] = a;
+      tree_[j] = b;
+    }
+    tree_[0] = winner[1];
+  }
+
+  bool empty() const noexcept { return heads_.empty() || heads_[tree_[0]] == nullptr; }
+  // Source holding the smallest head. Requires !empty().
+  std::size_t top_source() const noexcept { return tree_[0]; }
+  T const& top() const noexcept {
+    assert(!empty());
+    return *heads_[tree_[0]];
+  }
+
+  // Gives the winning source a new head (nullptr once it is exhausted).
+  void replace_top(T const* head) noexcept(noexcept(std::declval<Compare&>()(
+      std::declval<T const&>(), std::declval<T const&>()))) {
+    std::uint32_t s = tree_[0];
+    heads_[s] = head;
+    for (std::size_t j = (s + heads_.size()) / 2; j > 0; j /= 2)
+      if (beats(tree_[j], s)) std::swap(tree_[j], s);
+    tree_[0] = s;
+  }
+
+ private:
+  // Whether source a's head goes before source b's. Exhausted sources lose
+  // to everything; equal heads go to the lower index.
+  bool beats(std::uint32_t a, std::uint32_t b) const {
+    T const* const x = heads_[a];
+    T const* const y = heads_[b];
+    if (!x) return false;
+    if (!y) return true;
+    return a < b ? !comp_(*y, *x) : comp_(*x, *y);
+  }
+
+  Compare comp_;
+  std::pmr::vector<T const*> heads_;
+  std::pmr::vector<std::uint32_t> tree_;  // [0] winner, [1, k) losers
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,238 @@
+// Multi-threaded sorting: LSD radix sort with per-thread histograms, and a
+// sample sort for arbitrary comparators that splits the input into buckets
+// and sorts them with pdqsort on all cores.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+#include "../detail/parallel.hpp"
+#include "../detail/scratch.hpp"
+#include "../execution.hpp"
+#include "../instrument/counters.hpp"
+#include "pdqsort.hpp"
+#include "radix_sort.hpp"
+
+namespace algoritmi {
+namespace detail::psort {
+
+// Inputs below this size are sorted on the calling thread; the cost of
+// spawning workers and the extra histogram passes do not pay off earlier.
+inline constexpr std::size_t parallel_threshold = std::size_t{1} << 22;
+
+struct chunking {
+  std::size_t n, chunks;
+  std::size_t begin(std::size_t c) const noexcept { return n * c / chunks; }
+  std::size_t end(std::size_t c) const noexcept { return n * (c + 1) / chunks; }
+};
+
+template <class Src, class Dst, class Enc>
+void parallel_lsd_pass(Src src, Dst dst, Enc const& enc, unsigned shift, chunking const& ch,
+                       std::size_t* counts /* chunks x 256 */, unsigned threads) {
+  constexpr std::size_t B = radix::buckets;
+  parallel_for(ch.chunks, threads, [&](std::size_t c) {
+    std::size_t* cnt = counts + c * B;
+    std::fill(cnt, cnt + B, std::size_t{0});
+    for (std::size_t i = ch.begin(c); i < ch.end(c); ++i)
+      ++cnt[static_cast<std::size_t>(enc(src[i]) >> shift) & (B - 1)];
+  });
+  // Digit-major, chunk-minor prefix sum keeps the pass stable.
+  std::size_t sum = 0;
+  for (std::size_t d = 0; d < B; ++d) {
+    for (std::size_t c = 0; c < ch.chunks; ++c) {
+      std::size_t const v = counts[c * B + d];
+      counts[c * B + d] = sum;
+      sum += v;
+    }
+  }
+  parallel_for(ch.chunks, threads, [&](std::size_t c) {
+    radix::scatter(src + ch.begin(c), src + ch.end(c), dst, enc, shift, counts + c * B);
+  });
+}
+
+template <class It, class KeyFn>
+void parallel_radix_sort(It first, It last, KeyFn key, unsigned threads,
+                         std::pmr::memory_resource* mr) {
+  using T = typename std::iterator_traits<It>::value_type;
+  radix::encoder<KeyFn> const enc{std::move(key)};
+  using bits = std::decay_t<decltype(enc(*first))>;
+  constexpr unsigned passes = sizeof(bits);
+  std::size_t const n = static_cast<std::size_t>(last - first);
+  chunking const ch{n, threads};
+
+  // Global byte histograms, used only to skip passes that would not move
+  // anything; one pass over the input in parallel.
+  std::pmr::vector<std::size_t> global(ch.chunks * passes * radix::buckets, 0, mr);
+  parallel_for(ch.chunks, threads, [&](std::size_t c) {
+    std::size_t* g = global.data() + c * passes * radix::buckets;
+    for (std::size_t i = ch.begin(c); i < ch.end(c); ++i) {
+      bits const b = enc(first[i]);
+      for (unsigned p = 0; p < passes; ++p)
+        ++g[p * radix::buckets + ((b >> (8 * p)) & (radix::buckets - 1))];
+    }
+  });
+  bool needed[passes];
+  bits const b0 = enc(first[0]);
+  for (unsigned p = 0; p < passes; ++p) {
+    std::size_t const d = (b0 >> (8 * p)) & (radix::buckets - 1);
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < ch.chunks; ++c)
+      total += global[c * passes * radix::buckets + p * radix::buckets + d];
+    needed[p] = total != n;
+  }
+
+  scratch_buffer<T> buffer(n, mr);
+  std::pmr::vector<std::size_t> counts(ch.chunks * radix::buckets, mr);
+  bool in_buffer = false;
+  for (unsigned p = 0; p < passes; ++p) {
+    if (!needed[p]) continue;
+    if (in_buffer)
+      parallel_lsd_pass(buffer.get(), first, enc, 8 * p, ch, counts.data(), threads);
+    else
+      parallel_lsd_pass(first, buffer.get(), enc, 8 * p, ch, counts.data(), threads);
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    T* buf = buffer.get();
+    parallel_for(ch.chunks, threads, [&](std::size_t c) {
+      std::move(buf + ch.begin(c), buf + ch.end(c), first + ch.begin(c));
+    });
+  }
+}
+
+// Sample sort: pick splitters from a sorted random sample, distribute the
+// elements into buckets (classification is a branchless walk over the
+// splitters), then sort the buckets independently. Buckets outnumber
+// threads several times over so uneven buckets still balance.
+template <class It, class Compare>
+void parallel_sample_sort(It first, It last, Compare comp, unsigned threads,
+                          std::pmr::memory_resource* mr) {
+  using T = typename std::iterator_traits<It>::value_type;
+  std::size_t const n = static_cast<std::size_t>(last - first);
+
+  std::size_t buckets = 1;
+  while (buckets < std::size_t{8} * threads && buckets < 256) buckets <<= 1;
+  std::size_t const oversample = 16;
+
+  // Deterministic pseudo-random sample so runs are reproducible.
+  std::pmr::vector<T> sample(mr);
+  sample.reserve(buckets * oversample);
+  std::uint64_t state = 0x9e3779b97f4a7c15ULL ^ n;
+  for (std::size_t i = 0; i < buckets * oversample; ++i) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    sample.push_back(first[static_cast<std::ptrdiff_t>(state % n)]);
+  }
+  pdqsort(sample.begin(), sample.end(), comp);
+  // splitters[1..buckets-1] in implicit binary-tree (Eytzinger) order so the
+  // classification loop has a fixed trip count and no data-dependent branch.
+  std::pmr::vector<T> splitters(buckets, mr);
+  {
+    std::size_t next = oversample;
+    auto fill = [&](auto& self, std::size_t k) -> void {
+      if (k >= buckets) return;
+      self(self, 2 * k);
+      splitters[k] = sample[next - 1];
+      next += oversample;
+      self(self, 2 * k + 1);
+    };
+    fill(fill, 1);
+  }
+  unsigned log_buckets = 0;
+  while ((std::size_t{1} << log_buckets) < buckets) ++log_buckets;
+
+  chunking const ch{n, threads};
+  scratch_buffer<std::uint8_t> bucket_of(n, mr);
+  std::pmr::vector<std::size_t> counts(ch.chunks * buckets, 0, mr);
+  parallel_for(ch.chunks, threads, [&](std::size_t c) {
+    std::size_t* cnt = counts.data() + c * buckets;
+    for (std::size_t i = ch.begin(c); i < ch.end(c); ++i) {
+      std::size_t k = 1;
+      for (unsigned l = 0; l < log_buckets; ++l) k = 2 * k + comp(splitters[k], first[i]);
+      std::size_t const b = k - buckets;
+      bucket_of[i] = static_cast<std::uint8_t>(b);
+      ++cnt[b];
+    }
+    ALGORITMI_COUNT(comparisons, (ch.end(c) - ch.begin(c)) * log_buckets);
+  });
+
+  std::pmr::vector<std::size_t> bucket_begin(buckets + 1, 0, mr);
+  std::size_t sum = 0;
+  for (std::size_t b = 0; b < buckets; ++b) {
+    bucket_begin[b] = sum;
+    for (std::size_t c = 0; c < ch.chunks; ++c) {
+      std::size_t const v = counts[c * buckets + b];
+      counts[c * buckets + b] = sum;
+      sum += v;
+    }
+  }
+  bucket_begin[buckets] = n;
+
+  scratch_buffer<T> buffer(n, mr);
+  T* buf = buffer.get();
+  parallel_for(ch.chunks, threads, [&](std::size_t c) {
+    std::size_t* off = counts.data() + c * buckets;
+    for (std::size_t i = ch.begin(c); i < ch.end(c); ++i) buf[off[bucket_of[i]]++] = std::move(first[i]);
+  });
+
+  // Largest buckets first so a big straggler does not start last.
+  std::pmr::vector<std::size_t> order(buckets, mr);
+  for (std::size_t b = 0; b < buckets; ++b) order[b] = b;
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return bucket_begin[a + 1] - bucket_begin[a] > bucket_begin[b + 1] - bucket_begin[b];
+  });
+  parallel_for(buckets, threads, [&](std::size_t i) {
+    std::size_t const b = order[i];
+    T* lo = buf + bucket_begin[b];
+    T* hi = buf + bucket_begin[b + 1];
+    pdqsort(lo, hi, comp);
+    std::move(lo, hi, first + static_cast<std::ptrdiff_t>(bucket_begin[b]));
+  });
+}
+
+}  // namespace detail::psort
+
+// Parallel stable radix sort; falls back to the sequential version for small
+// inputs or a single thread.
+template <class RandomIt, class KeyFn>
+void radix_sort(parallel_policy policy, RandomIt first, RandomIt last, KeyFn key,
+                std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::resolve_threads(policy.threads);
+  auto const n = static_cast<std::size_t>(last - first);
+  if (threads <= 1 || n < detail::psort::parallel_threshold) {
+    radix_sort(first, last, std::move(key), mr);
+    return;
+  }
+  detail::psort::parallel_radix_sort(first, last, std::move(key), threads, mr);
+}
+
+template <class RandomIt>
+void radix_sort(parallel_policy policy, RandomIt first, RandomIt last) {
+  radix_sort(policy, first, last, identity_key{});
+}
+
+// Parallel unstable comparison sort. Scratch space (n elements plus n bytes)
+// comes from `mr`.
+template <class RandomIt, class Compare>
+void pdqsort(parallel_policy policy, RandomIt first, RandomIt last, Compare comp,
+             std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  unsigned const threads = detail::resolve_threads(policy.threads);
+  auto const n = static_cast<std::size_t>(last - first);
+  if (threads <= 1 || n < detail::psort::parallel_threshold) {
+    pdqsort(first, last, comp);
+    return;
+  }
+  detail::psort::parallel_sample_sort(first, last, comp, threads, mr);
+}
+
+template <class RandomIt>
+void pdqsort(parallel_policy policy, RandomIt first, RandomIt last) {
+  pdqsort(policy, first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,453 @@
+// Pattern-defeating quicksort (Orson Peters, 2021).
+//
+// Introsort-style quicksort that detects and exploits common input patterns:
+// already-sorted runs finish in linear time, inputs with many equal keys are
+// split three-ways, adversarial pivots are broken up by deterministic swaps
+// and the heapsort fallback bounds the worst case at O(n log n). For
+// arithmetic keys under the default ordering, partitioning uses the
+// branchless block scheme (BlockQuicksort) to avoid mispredictions, and
+// ranges of up to small_sort_max such keys are finished by small_sort.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "../config.hpp"
+#include "../instrument/counters.hpp"
+#include "small_sort.hpp"
+
+namespace algoritmi {
+namespace detail::pdq {
+
+inline constexpr std::ptrdiff_t insertion_sort_threshold = 24;
+inline constexpr std::ptrdiff_t ninther_threshold = 128;
+inline constexpr std::size_t partial_insertion_sort_limit = 8;
+inline constexpr std::size_t block_size = 64;
+
+template <class T>
+inline int log2(T n) {
+  int log = 0;
+  while (n >>= 1) ++log;
+  return log;
+}
+
+// Comparators for which the branchless partition is both legal (cheap,
+// side-effect free) and profitable.
+using smallsort::counted;
+using smallsort::is_default_compare;
+
+template <class Iter, class Compare>
+struct use_branchless
+    : std::bool_constant<
+          is_default_compare<typename std::iterator_traits<Iter>::value_type, Compare>::value &&
+          std::is_arithmetic_v<typename std::iterator_traits<Iter>::value_type>> {};
+
+template <class Iter, class Compare>
+inline void insertion_sort(Iter begin, Iter end, Compare comp) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  if (begin == end) return;
+  for (Iter cur = begin + 1; cur != end; ++cur) {
+    Iter sift = cur;
+    Iter sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      T tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (sift != begin && comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+// Requires *(begin - 1) to compare no greater than any element in the range.
+template <class Iter, class Compare>
+inline void unguarded_insertion_sort(Iter begin, Iter end, Compare comp) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  if (begin == end) return;
+  for (Iter cur = begin + 1; cur != end; ++cur) {
+    Iter sift = cur;
+    Iter sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      T tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+// Insertion sort that gives up once it has moved more than a handful of
+// elements. Returns true if the range ended up sorted.
+template <class Iter, class Compare>
+inline bool partial_insertion_sort(Iter begin, Iter end, Compare comp) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  if (begin == end) return true;
+  std::size_t limit = 0;
+  for (Iter cur = begin + 1; cur != end; ++cur) {
+    Iter sift = cur;
+    Iter sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      T tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (sift != begin && comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+      limit += static_cast<std::size_t>(cur - sift);
+    }
+    if (limit > partial_insertion_sort_limit) return false;
+  }
+  return true;
+}
+
+template <class Iter, class Compare>
+inline void sort2(Iter a, Iter b, Compare comp) {
+  if (comp(*b, *a)) std::iter_swap(a, b);
+}
+
+template <class Iter, class Compare>
+inline void sort3(Iter a, Iter b, Iter c, Compare comp) {
+  sort2(a, b, comp);
+  sort2(b, c, comp);
+  sort2(a, b, comp);
+}
+
+template <class Iter>
+inline void swap_offsets(Iter first, Iter last, unsigned char* offsets_l,
+                         unsigned char* offsets_r, std::size_t num, bool use_swaps) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  ALGORITMI_COUNT(swaps, num);
+  if (use_swaps) {
+    // Needed when the counts match exactly: the cyclic permutation below
+    // would otherwise leave one element in the wrong half.
+    for (std::size_t i = 0; i < num; ++i)
+      std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+  } else if (num > 0) {
+    Iter l = first + offsets_l[0];
+    Iter r = last - offsets_r[0];
+    T tmp(std::move(*l));
+    *l = std::move(*r);
+    for (std::size_t i = 1; i < num; ++i) {
+      l = first + offsets_l[i];
+      *r = std::move(*l);
+      r = last - offsets_r[i];
+      *l = std::move(*r);
+    }
+    *r = std::move(tmp);
+  }
+}
+
+// Partitions [begin, end) around *begin. Elements equal to the pivot go to
+// the right. Returns the pivot position and whether the range was already
+// partitioned.
+template <class Iter, class Compare>
+inline std::pair<Iter, bool> partition_right_branchless(Iter begin, Iter end, Compare comp) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  T pivot(std::move(*begin));
+  Iter first = begin;
+  Iter last = end;
+
+  while (comp(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
+  } else {
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  bool const already_partitioned = first >= last;
+  if (!already_partitioned) {
+    std::iter_swap(first, last);
+    ALGORITMI_COUNT(swaps, 1);
+    ++first;
+
+    alignas(cache_line_size) unsigned char offsets_l[block_size];
+    alignas(cache_line_size) unsigned char offsets_r[block_size];
+
+    Iter offsets_l_base = first;
+    Iter offsets_r_base = last;
+    std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+    while (first < last) {
+      std::size_t const num_unknown = static_cast<std::size_t>(last - first);
+      std::size_t const left_split =
+          num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      std::size_t const right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+      // Record offsets of misplaced elements without branching on the
+      // comparison result.
+      if (left_split >= block_size) {
+        for (std::size_t i = 0; i < block_size;) {
+          offsets_l[num_l] = static_cast<unsigned char>(i++);
+          num_l += !comp(*first, pivot);
+          ++first;
+          offsets_l[num_l] = static_cast<unsigned char>(i++);
+          num_l += !comp(*first, pivot);
+          ++first;
+          offsets_l[num_l] = static_cast<unsigned char>(i++);
+          num_l += !comp(*first, pivot);
+          ++first;
+          offsets_l[num_l] = static_cast<unsigned char>(i++);
+          num_l += !comp(*first, pivot);
+          ++first;
+        }
+      } else {
+        for (std::size_t i = 0; i < left_split;) {
+          offsets_l[num_l] = static_cast<unsigned char>(i++);
+          num_l += !comp(*first, pivot);
+          ++first;
+        }
+      }
+
+      if (right_split >= block_size) {
+        for (std::size_t i = 0; i < block_size;) {
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+        }
+      } else {
+        for (std::size_t i = 0; i < right_split;) {
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+        }
+      }
+
+      std::size_t const num = std::min(num_l, num_r);
+      swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                   num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        offsets_l_base = first;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        offsets_r_base = last;
+      }
+    }
+
+    // One side may still hold unswapped elements; move them to the boundary.
+    ALGORITMI_COUNT(swaps, num_l + num_r);
+    if (num_l) {
+      while (num_l--) std::iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+      first = last;
+    }
+    if (num_r) {
+      while (num_r--) {
+        std::iter_swap(offsets_r_base - offsets_r[start_r + num_r], first);
+        ++first;
+      }
+      last = first;
+    }
+  }
+
+  Iter pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+template <class Iter, class Compare>
+inline std::pair<Iter, bool> partition_right(Iter begin, Iter end, Compare comp) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  T pivot(std::move(*begin));
+  Iter first = begin;
+  Iter last = end;
+
+  while (comp(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
+  } else {
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  bool const already_partitioned = first >= last;
+  while (first < last) {
+    std::iter_swap(first, last);
+    ALGORITMI_COUNT(swaps, 1);
+    while (comp(*++first, pivot)) {
+    }
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  Iter pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+// Used when the pivot equals an element left of the range: everything equal
+// to the pivot goes left and never needs to be looked at again.
+template <class Iter, class Compare>
+inline Iter partition_left(Iter begin, Iter end, Compare comp) {
+  using T = typename std::iterator_traits<Iter>::value_type;
+  T pivot(std::move(*begin));
+  Iter first = begin;
+  Iter last = end;
+
+  while (comp(pivot, *--last)) {
+  }
+  if (last + 1 == end) {
+    while (first < last && !comp(pivot, *++first)) {
+    }
+  } else {
+    while (!comp(pivot, *++first)) {
+    }
+  }
+
+  while (first < last) {
+    std::iter_swap(first, last);
+    ALGORITMI_COUNT(swaps, 1);
+    while (comp(pivot, *--last)) {
+    }
+    while (!comp(pivot, *++first)) {
+    }
+  }
+
+  Iter pivot_pos = last;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}
+
+template <class Iter, class Compare, bool Branchless>
+void pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bool leftmost = true) {
+  using diff_t = typename std::iterator_traits<Iter>::difference_type;
+
+  // Tail-recurse on the right partition, recurse on the left.
+  while (true) {
+    diff_t const size = end - begin;
+
+    if constexpr (smallsort::cheap_v<typename std::iterator_traits<Iter>::value_type, Compare>) {
+      if (size <= static_cast<diff_t>(small_sort_max)) {
+        small_sort(begin, end, comp);
+        return;
+      }
+    }
+    if (size < insertion_sort_threshold) {
+      if (leftmost)
+        insertion_sort(begin, end, comp);
+      else
+        unguarded_insertion_sort(begin, end, comp);
+      return;
+    }
+
+    diff_t const s2 = size / 2;
+    if (size > ninther_threshold) {
+      sort3(begin, begin + s2, end - 1, comp);
+      sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+      sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+      std::iter_swap(begin, begin + s2);
+    } else {
+      sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    // If the pivot equals the element left of the range, every element here
+    // is >= pivot; group the equal ones on the left and skip them.
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, comp) + 1;
+      continue;
+    }
+
+    std::pair<Iter, bool> const part = Branchless ? partition_right_branchless(begin, end, comp)
+                                                  : partition_right(begin, end, comp);
+    Iter const pivot_pos = part.first;
+    bool const already_partitioned = part.second;
+
+    diff_t const l_size = pivot_pos - begin;
+    diff_t const r_size = end - (pivot_pos + 1);
+    bool const highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, comp);
+        std::sort_heap(begin, end, comp);
+        return;
+      }
+
+      // Break up patterns that defeat the pivot choice.
+      ALGORITMI_COUNT(swaps, (l_size >= insertion_sort_threshold ? 2 : 0) +
+                                 (l_size > ninther_threshold ? 4 : 0) +
+                                 (r_size >= insertion_sort_threshold ? 2 : 0) +
+                                 (r_size > ninther_threshold ? 4 : 0));
+      if (l_size >= insertion_sort_threshold) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > ninther_threshold) {
+          std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= insertion_sort_threshold) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+        if (r_size > ninther_threshold) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          std::iter_swap(end - 2, end - (1 + r_size / 4));
+          std::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp) &&
+               partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      // Balanced partition with no swaps: guess the input was nearly sorted.
+      return;
+    }
+
+    pdqsort_loop<Iter, Compare, Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+}  // namespace detail::pdq
+
+// Sorts [first, last) with `comp`. Not stable. O(n log n) worst case,
+// O(n) on sorted, reverse-sorted and few-distinct-key inputs.
+template <class RandomIt, class Compare>
+void pdqsort(RandomIt first, RandomIt last, Compare comp) {
+  if (first == last) return;
+  auto const c = detail::pdq::counted(comp);
+  detail::pdq::pdqsort_loop<RandomIt, std::remove_const_t<decltype(c)>,
+                            detail::pdq::use_branchless<RandomIt, Compare>::value>(
+      first, last, c, detail::pdq::log2(last - first));
+}
+
+template <class RandomIt>
+void pdqsort(RandomIt first, RandomIt last) {
+  pdqsort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+// Forces the branchless partition for comparators the heuristic does not
+// recognise (e.g. a lambda comparing a member). Only worth it when the
+// comparison is cheap and has no side effects.
+template <class RandomIt, class Compare>
+void pdqsort_branchless(RandomIt first, RandomIt last, Compare comp) {
+  if (first == last) return;
+  auto const c = detail::pdq::counted(comp);
+  detail::pdq::pdqsort_loop<RandomIt, std::remove_const_t<decltype(c)>, true>(
+      first, last, c, detail::pdq::log2(last - first));
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,202 @@
+// Least-significant-digit radix sort for integer and floating-point keys.
+//
+// Keys are mapped to unsigned integers whose natural order matches the key
+// order (sign bit flipped for signed integers, IEEE-754 total-order trick for
+// floats), then sorted one byte at a time. All byte histograms are built in a
+// single read pass, and passes in which every key has the same byte are
+// skipped, so narrow key ranges cost fewer passes.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include "../detail/scratch.hpp"
+
+namespace algoritmi {
+namespace detail::radix {
+
+template <class K, class = void>
+struct key_traits;
+
+template <class K>
+struct key_traits<K, std::enable_if_t<std::is_integral_v<K> && std::is_unsigned_v<K>>> {
+  using bits_type = K;
+  static constexpr bits_type encode(K k) noexcept { return k; }
+};
+
+template <class K>
+struct key_traits<K, std::enable_if_t<std::is_integral_v<K> && std::is_signed_v<K>>> {
+  using bits_type = std::make_unsigned_t<K>;
+  static constexpr bits_type encode(K k) noexcept {
+    return static_cast<bits_type>(static_cast<bits_type>(k) ^
+                                  (bits_type{1} << (sizeof(K) * 8 - 1)));
+  }
+};
+
+template <class K>
+struct key_traits<K, std::enable_if_t<std::is_floating_point_v<K>>> {
+  static_assert(sizeof(K) == 4 || sizeof(K) == 8, "only IEEE-754 float and double");
+  using bits_type = std::conditional_t<sizeof(K) == 4, std::uint32_t, std::uint64_t>;
+  // Negative values: flip every bit; positive values: flip the sign bit.
+  // NaNs end up at the extremes according to their sign bit; -0.0 sorts
+  // before +0.0.
+  static bits_type encode(K k) noexcept {
+    bits_type b;
+    std::memcpy(&b, &k, sizeof b);
+    constexpr unsigned shift = sizeof(K) * 8 - 1;
+    bits_type const mask = static_cast<bits_type>(-static_cast<bits_type>(b >> shift)) |
+                           (bits_type{1} << shift);
+    return b ^ mask;
+  }
+};
+
+template <class K>
+using bits_t = typename key_traits<K>::bits_type;
+
+struct identity_key {
+  template <class T>
+  constexpr T const& operator()(T const& x) const noexcept {
+    return x;
+  }
+};
+
+template <class KeyFn, class T>
+using key_type_t = std::decay_t<std::invoke_result_t<KeyFn&, T const&>>;
+
+// Encoded key of an element, as an unsigned integer.
+template <class KeyFn>
+struct encoder {
+  KeyFn key;
+  template <class T>
+  auto operator()(T const& x) const {
+    using K = key_type_t<KeyFn const, T>;
+    return key_traits<K>::encode(std::invoke(key, x));
+  }
+};
+
+inline constexpr std::size_t buckets = 256;
+
+// Below this size the histogram setup dominates; a stable merge sort is
+// faster and keeps the overall sort stable.
+inline constexpr std::ptrdiff_t min_size = 256;
+
+// Stable merge sort for small inputs: insertion-sorted runs, then bottom-up
+// merges ping-ponging through `buffer` (capacity >= n). Unlike
+// std::stable_sort it never allocates.
+template <class It, class T, class Less>
+void merge_sort(It first, It last, T* buffer, Less less) {
+  constexpr std::size_t run = 16;
+  std::size_t const n = static_cast<std::size_t>(last - first);
+  for (std::size_t b = 0; b < n; b += run) {
+    It const lo = first + static_cast<std::ptrdiff_t>(b);
+    It const hi = first + static_cast<std::ptrdiff_t>(std::min(n, b + run));
+    for (It i = lo + 1; i < hi; ++i) {
+      T x = std::move(*i);
+      It j = i;
+      for (; j != lo && less(x, *(j - 1)); --j) *j = std::move(*(j - 1));
+      *j = std::move(x);
+    }
+  }
+  bool in_buffer = false;
+  auto merge_pass = [&](auto src, auto dst, std::size_t width) {
+    for (std::size_t lo = 0; lo < n; lo += 2 * width) {
+      std::size_t const mid = std::min(n, lo + width), hi = std::min(n, lo + 2 * width);
+      std::merge(std::make_move_iterator(src + lo), std::make_move_iterator(src + mid),
+                 std::make_move_iterator(src + mid), std::make_move_iterator(src + hi), dst + lo,
+                 less);
+    }
+  };
+  for (std::size_t width = run; width < n; width *= 2) {
+    if (in_buffer)
+      merge_pass(buffer, first, width);
+    else
+      merge_pass(first, buffer, width);
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) std::move(buffer, buffer + n, first);
+}
+
+template <class Src, class Dst, class Enc>
+inline void scatter(Src first, Src last, Dst out, Enc const& enc, unsigned shift,
+                    std::size_t* offsets) {
+  for (; first != last; ++first) {
+    std::size_t const d = static_cast<std::size_t>(enc(*first) >> shift) & (buckets - 1);
+    out[offsets[d]++] = std::move(*first);
+  }
+}
+
+// Turns counts into exclusive prefix sums in place. Returns false if a single
+// bucket holds every element, i.e. the pass would not move anything.
+inline bool prefix_sum(std::size_t* counts, std::size_t n) {
+  std::size_t sum = 0;
+  for (std::size_t d = 0; d < buckets; ++d) {
+    std::size_t const c = counts[d];
+    if (c == n) return false;
+    counts[d] = sum;
+    sum += c;
+  }
+  return true;
+}
+
+// Sorts [first, last) using `buffer` (capacity >= n) as ping-pong storage.
+template <class It, class T, class Enc>
+void lsd_sort(It first, It last, T* buffer, Enc const& enc) {
+  using bits = std::decay_t<decltype(enc(*first))>;
+  constexpr unsigned passes = sizeof(bits);
+  std::size_t const n = static_cast<std::size_t>(last - first);
+
+  std::size_t counts[passes][buckets] = {};
+  for (It it = first; it != last; ++it) {
+    bits const b = enc(*it);
+    for (unsigned p = 0; p < passes; ++p) ++counts[p][(b >> (8 * p)) & (buckets - 1)];
+  }
+
+  bool in_buffer = false;
+  for (unsigned p = 0; p < passes; ++p) {
+    if (!prefix_sum(counts[p], n)) continue;
+    if (in_buffer)
+      scatter(buffer, buffer + n, first, enc, 8 * p, counts[p]);
+    else
+      scatter(first, last, buffer, enc, 8 * p, counts[p]);
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) std::move(buffer, buffer + n, first);
+}
+
+}  // namespace detail::radix
+
+// Key extractor that sorts elements by their own value.
+using identity_key = detail::radix::identity_key;
+
+// Stable sort of [first, last) by key(element), ascending. The key must be
+// an integral or floating-point type. Uses n elements of scratch space from
+// `mr`; with an arena the call does not touch the global heap.
+template <class RandomIt, class KeyFn>
+void radix_sort(RandomIt first, RandomIt last, KeyFn key,
+                std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  detail::radix::encoder<KeyFn> const enc{std::move(key)};
+  auto const n = last - first;
+  if (n < 2) return;
+  detail::scratch_buffer<T> buffer(static_cast<std::size_t>(n), mr);
+  if (n < detail::radix::min_size) {
+    detail::radix::merge_sort(first, last, buffer.get(),
+                              [&](T const& a, T const& b) { return enc(a) < enc(b); });
+    return;
+  }
+  detail::radix::lsd_sort(first, last, buffer.get(), enc);
+}
+
+template <class RandomIt>
+void radix_sort(RandomIt first, RandomIt last) {
+  radix_sort(first, last, identity_key{});
+}
+
+}  // namespace algoritmi
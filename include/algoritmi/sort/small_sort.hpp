@@ -0,0 +1,712 @@
+// Sorting for inputs of at most a few dozen elements.
+//
+// At this size a general-purpose sort is dominated by branch mispredictions:
+// every comparison of random keys is a coin flip. The routines here replace
+// data-dependent branches with data-independent work.
+//
+//   sorting_network<N>()   the comparator pairs of an N-input network,
+//                          generated at compile time by Batcher's merge
+//                          exchange (Knuth, TAOCP 5.2.2, algorithm M). It is
+//                          the smallest known network up to N = 8 and within
+//                          a few comparators of the best known up to 32.
+//   static_sort<N>         runs that network fully unrolled; for arithmetic
+//                          keys each comparator is a conditional move pair.
+//   branchless_insertion_sort
+//                          insertion sort whose inner loop always runs to the
+//                          front, compare-exchanging instead of searching.
+//   small_sort             any n <= small_sort_max; 32- and 64-bit integer
+//                          and floating-point keys under std::less/greater
+//                          are sorted inside SIMD registers (a bitonic network
+//                          of lane-wise min/max and shuffles), other cheap
+//                          keys by the unrolled networks. Registers win for
+//                          32-bit keys (with SSE4.2 only above 16 of them);
+//                          64-bit keys use them with AVX2 above 16, below
+//                          which the scalar networks are as fast.
+//
+// pdqsort uses small_sort for its base cases where it applies.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../instrument/counters.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#elif ALGORITMI_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace algoritmi {
+
+// Largest input small_sort is meant for; larger ones are still sorted, by
+// branchless insertion sort.
+inline constexpr std::size_t small_sort_max = 32;
+
+// One comparator of a sorting network: orders elements lo < hi.
+struct network_pair {
+  std::uint8_t lo, hi;
+};
+
+namespace detail::smallsort {
+
+// ---------------------------------------------------------------- networks --
+
+// Knuth's algorithm M. Returns the number of comparators and writes them
+// to `out` unless it is null.
+constexpr std::size_t merge_exchange(std::size_t n, network_pair* out) {
+  std::size_t count = 0;
+  if (n < 2) return 0;
+  std::size_t t = 0;
+  while ((std::size_t{1} << t) < n) ++t;
+  for (std::size_t p = std::size_t{1} << (t - 1); p > 0; p /= 2) {
+    std::size_t q = std::size_t{1} << (t - 1), r = 0, d = p;
+    for (;;) {
+      for (std::size_t i = 0; i + d < n; ++i) {
+        if ((i & p) != r) continue;
+        if (out) out[count] = {static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i + d)};
+        ++count;
+      }
+      if (q == p) break;
+      d = q - p;
+      q /= 2;
+      r = p;
+    }
+  }
+  return count;
+}
+
+template <std::size_t N>
+constexpr auto make_network() {
+  std::array<network_pair, merge_exchange(N, nullptr)> net{};
+  merge_exchange(N, net.data());
+  return net;
+}
+
+template <std::size_t N>
+inline constexpr auto network_v = make_network<N>();
+
+// Comparators for which a compare-exchange can be two conditional moves:
+// the standard orderings of arithmetic types.
+template <class T, class Compare>
+struct is_default_compare : std::false_type {};
+template <class T>
+struct is_default_compare<T, std::less<T>> : std::true_type {};
+template <class T>
+struct is_default_compare<T, std::greater<T>> : std::true_type {};
+template <class T>
+struct is_default_compare<T, std::less<>> : std::true_type {};
+template <class T>
+struct is_default_compare<T, std::greater<>> : std::true_type {};
+
+template <class Compare>
+struct is_descending : std::false_type {};
+template <class T>
+struct is_descending<std::greater<T>> : std::true_type {};
+
+#if ALGORITMI_INSTRUMENT
+// Counts comparator calls (ALGORITMI_INSTRUMENT builds). Kernel selection
+// looks through it, so an instrumented sort takes the same paths; SIMD
+// kernels never call the comparator and count nothing.
+template <class Compare>
+struct counting_compare {
+  mutable Compare comp;
+
+  template <class A, class B>
+  bool operator()(A&& a, B&& b) const {
+    ALGORITMI_COUNT(comparisons, 1);
+    return comp(std::forward<A>(a), std::forward<B>(b));
+  }
+};
+
+template <class T, class Compare>
+struct is_default_compare<T, counting_compare<Compare>> : is_default_compare<T, Compare> {};
+template <class Compare>
+struct is_descending<counting_compare<Compare>> : is_descending<Compare> {};
+#endif
+
+// The comparator sorts should call: comp itself, or comp wrapped to count.
+template <class Compare>
+inline auto counted(Compare comp) {
+#if ALGORITMI_INSTRUMENT
+  return counting_compare<Compare>{comp};
+#else
+  return comp;
+#endif
+}
+
+template <class T, class Compare>
+inline constexpr bool cheap_v = is_default_compare<T, Compare>::value && std::is_arithmetic_v<T>;
+
+template <class T>
+inline constexpr bool sse_float_v = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// minss/maxss pick exactly like the selects in compare_exchange, which
+// compilers otherwise turn back into a branch for floating-point keys.
+template <class T, bool Descending>
+ALGORITMI_ALWAYS_INLINE void compare_exchange_fp(T& a, T& b) noexcept {
+#if ALGORITMI_SSE2
+  if constexpr (std::is_same_v<T, float>) {
+    __m128 const x = _mm_set_ss(a), y = _mm_set_ss(b);
+    a = _mm_cvtss_f32(Descending ? _mm_max_ss(y, x) : _mm_min_ss(y, x));
+    b = _mm_cvtss_f32(Descending ? _mm_min_ss(x, y) : _mm_max_ss(x, y));
+  } else {
+    __m128d const x = _mm_set_sd(a), y = _mm_set_sd(b);
+    a = _mm_cvtsd_f64(Descending ? _mm_max_sd(y, x) : _mm_min_sd(y, x));
+    b = _mm_cvtsd_f64(Descending ? _mm_min_sd(x, y) : _mm_max_sd(x, y));
+  }
+#else
+  T const x = a, y = b;
+  bool const swap = Descending ? x < y : y < x;
+  a = swap ? y : x;
+  b = swap ? x : y;
+#endif
+}
+
+template <class T, class Compare>
+ALGORITMI_ALWAYS_INLINE void compare_exchange(T& a, T& b, Compare& comp) {
+  if constexpr (cheap_v<T, Compare> && sse_float_v<T>) {
+    compare_exchange_fp<T, is_descending<Compare>::value>(a, b);
+  } else if constexpr (cheap_v<T, Compare>) {
+    T const x = a, y = b;
+    bool const swap = comp(y, x);
+    a = swap ? y : x;
+    b = swap ? x : y;
+  } else if (comp(b, a)) {
+    using std::swap;
+    swap(a, b);
+  }
+}
+
+template <std::size_t N, class Ref, class Compare, std::size_t... I>
+ALGORITMI_ALWAYS_INLINE void run_network(Ref v, Compare& comp, std::index_sequence<I...>) {
+  (compare_exchange(v[network_v<N>[I].lo], v[network_v<N>[I].hi], comp), ...);
+}
+
+// Sorts the first N elements of `v` (a pointer or random-access iterator).
+template <std::size_t N, class Ref, class Compare>
+ALGORITMI_ALWAYS_INLINE void network_sort(Ref v, Compare& comp) {
+  run_network<N>(v, comp, std::make_index_sequence<network_v<N>.size()>());
+}
+
+// Arithmetic keys are sorted in a local copy so the compiler can keep the
+// whole network in registers.
+template <std::size_t N, class RandomIt, class Compare>
+ALGORITMI_ALWAYS_INLINE void static_sort(RandomIt first, Compare& comp) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  if constexpr (N < 2) {
+    return;
+  } else if constexpr (cheap_v<T, Compare>) {
+    T v[N];
+    for (std::size_t i = 0; i < N; ++i) v[i] = first[static_cast<std::ptrdiff_t>(i)];
+    network_sort<N>(v, comp);
+    for (std::size_t i = 0; i < N; ++i) first[static_cast<std::ptrdiff_t>(i)] = v[i];
+  } else {
+    network_sort<N>(first, comp);
+  }
+}
+
+// The sorted prefix stays sorted while a new element is compare-exchanged
+// towards the front, so no comparison decides how far to go.
+template <class RandomIt, class Compare>
+void branchless_insertion_sort(RandomIt first, RandomIt last, Compare& comp) {
+  auto const n = last - first;
+  for (decltype(last - first) i = 1; i < n; ++i)
+    for (auto j = i; j > 0; --j) compare_exchange(first[j - 1], first[j], comp);
+}
+
+// Exact networks up to here; the 17- to 32-input networks run on a copy
+// padded with keys that sort last.
+inline constexpr std::size_t exact_networks = 16;
+
+template <class T, bool Descending>
+constexpr T padding() noexcept {
+  if constexpr (Descending)
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::lowest();
+  else
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::max();
+}
+
+template <class T, bool Descending, std::size_t N>
+void network_sort_n(T* p) noexcept {
+  std::conditional_t<Descending, std::greater<T>, std::less<T>> comp;
+  static_sort<N>(p, comp);
+}
+
+// One function per size: inlining every network into a single switch makes
+// the compiler give up on keeping any of them in registers.
+template <class T, bool Descending, std::size_t... N>
+constexpr std::array<void (*)(T*) noexcept, sizeof...(N)> make_network_table(
+    std::index_sequence<N...>) noexcept {
+  return {&network_sort_n<T, Descending, N>...};
+}
+
+// Scalar small sort of an arithmetic array.
+template <class T, bool Descending>
+void sort_scalar(T* p, std::size_t n) noexcept {
+  static constexpr auto table =
+      make_network_table<T, Descending>(std::make_index_sequence<exact_networks + 1>());
+  if (n <= exact_networks) return table[n](p);
+  using comp_t = std::conditional_t<Descending, std::greater<T>, std::less<T>>;
+  comp_t comp;
+  if (n > small_sort_max) {
+    branchless_insertion_sort(p, p + n, comp);
+    return;
+  }
+  T v[small_sort_max];
+  for (std::size_t i = 0; i < small_sort_max; ++i) v[i] = i < n ? p[i] : padding<T, Descending>();
+  network_sort<small_sort_max>(v, comp);
+  for (std::size_t i = 0; i < n; ++i) p[i] = v[i];
+}
+
+// ------------------------------------------------------------------- SIMD --
+
+template <class T>
+inline constexpr bool simd_key_v =
+    std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t> ||
+    std::is_same_v<T, std::int64_t> || std::is_same_v<T, std::uint64_t> ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+constexpr std::size_t top_bit(std::size_t x) noexcept {
+  std::size_t top = 1;
+  while (top * 2 <= x) top *= 2;
+  return top;
+}
+
+// Lanes of a `lanes`-wide vector whose index has the highest bit of m set:
+// the upper element of every pair a compare-exchange across i ^ m forms.
+constexpr unsigned upper_lanes(unsigned m, unsigned lanes) noexcept {
+  unsigned mask = 0;
+  for (unsigned i = 0; i < lanes; ++i)
+    if (i & top_bit(m)) mask |= 1u << i;
+  return mask;
+}
+
+// Repeats every bit of `mask` `width` times, turning a lane mask into one
+// over narrower lanes.
+constexpr unsigned widen_mask(unsigned mask, unsigned width) noexcept {
+  unsigned out = 0;
+  for (unsigned i = 0; mask >> i; ++i)
+    if (mask >> i & 1) out |= ((1u << width) - 1) << (i * width);
+  return out;
+}
+
+// Immediate for a 4 x 32-bit shuffle moving lane i ^ m into lane i.
+constexpr int xor_shuffle(unsigned m) noexcept {
+  int imm = 0;
+  for (unsigned i = 0; i < 4; ++i) imm |= static_cast<int>((i ^ m) & 3) << (2 * i);
+  return imm;
+}
+
+template <class T>
+ALGORITMI_ALWAYS_INLINE std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t> bits_of(
+    T x) noexcept {
+  std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t> b;
+  std::memcpy(&b, &x, sizeof b);
+  return b;
+}
+
+#if ALGORITMI_HAS_SIMD
+
+// All vectors are integer registers whatever the key type; floating-point
+// min/max reinterpret them. min(x, y) is x < y ? x : y and max(x, y) is
+// x > y ? x : y, like minps/maxps, so a compare-exchange that takes
+// min(lo, hi) and max(hi, lo) always keeps both inputs, even for keys that
+// compare equal without being identical (-0.0 and 0.0). Unsigned 64-bit
+// keys have their sign bit flipped between load and store, as there is
+// only a signed 64-bit compare.
+struct sse_sort_ops {
+  using vec = __m128i;
+  static constexpr unsigned bytes = 16;
+  // Below this many keys the scalar networks are faster.
+  template <class T>
+  static constexpr std::size_t min_keys = sizeof(T) == 4 ? exact_networks + 1 : small_sort_max + 1;
+
+  template <class T>
+  ALGORITMI_TARGET_SSE42 static vec encode(vec v) {
+    if constexpr (std::is_same_v<T, std::uint64_t>)
+      return _mm_xor_si128(v, _mm_set1_epi64x(INT64_MIN));
+    else
+      return v;
+  }
+  template <class T>
+  ALGORITMI_TARGET_SSE42 static vec fill(T x) {
+    if constexpr (sizeof(T) == 4)
+      return _mm_set1_epi32(bits_of(x));
+    else
+      return encode<T>(_mm_set1_epi64x(bits_of(x)));
+  }
+  template <class T>
+  ALGORITMI_TARGET_SSE42 static vec load(T const* p, std::size_t count, T pad) {
+    constexpr std::size_t L = bytes / sizeof(T);
+    if (count >= L) return encode<T>(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+    alignas(16) T buf[L];
+    for (std::size_t i = 0; i < L; ++i) buf[i] = i < count ? p[i] : pad;
+    return encode<T>(_mm_load_si128(reinterpret_cast<__m128i const*>(buf)));
+  }
+  template <class T>
+  ALGORITMI_TARGET_SSE42 static void store(T* p, std::size_t count, vec v) {
+    constexpr std::size_t L = bytes / sizeof(T);
+    v = encode<T>(v);
+    if (count >= L) return _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+    alignas(16) T buf[L];
+    _mm_store_si128(reinterpret_cast<__m128i*>(buf), v);
+    for (std::size_t i = 0; i < count; ++i) p[i] = buf[i];
+  }
+  // One compare serves both min and max of the same pair.
+  ALGORITMI_TARGET_SSE42 static vec lt64(vec x, vec y) { return _mm_cmpgt_epi64(y, x); }
+  template <class T>
+  ALGORITMI_TARGET_SSE42 static vec min(vec x, vec y) {
+    if constexpr (std::is_same_v<T, std::int32_t>) return _mm_min_epi32(x, y);
+    if constexpr (std::is_same_v<T, std::uint32_t>) return _mm_min_epu32(x, y);
+    if constexpr (std::is_same_v<T, float>)
+      return _mm_castps_si128(_mm_min_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(y)));
+    if constexpr (std::is_same_v<T, double>)
+      return _mm_castpd_si128(_mm_min_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(y)));
+    if constexpr (sizeof(T) == 8 && std::is_integral_v<T>)
+      return _mm_blendv_epi8(y, x, lt64(x, y));
+  }
+  template <class T>
+  ALGORITMI_TARGET_SSE42 static vec max(vec x, vec y) {
+    if constexpr (std::is_same_v<T, std::int32_t>) return _mm_max_epi32(x, y);
+    if constexpr (std::is_same_v<T, std::uint32_t>) return _mm_max_epu32(x, y);
+    if constexpr (std::is_same_v<T, float>)
+      return _mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(y)));
+    if constexpr (std::is_same_v<T, double>)
+      return _mm_castpd_si128(_mm_max_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(y)));
+    if constexpr (sizeof(T) == 8 && std::is_integral_v<T>)
+      return _mm_blendv_epi8(x, y, lt64(x, y));
+  }
+  // Lane i of the result is lane i ^ M of v.
+  template <class T, unsigned M>
+  ALGORITMI_TARGET_SSE42 static vec permute(vec v) {
+    if constexpr (M == 0) return v;
+    constexpr int imm = xor_shuffle(M);
+    if constexpr (M != 0 && sizeof(T) == 4) return _mm_shuffle_epi32(v, imm);
+    if constexpr (M != 0 && sizeof(T) == 8) return _mm_shuffle_epi32(v, 0x4e);
+  }
+  // Lanes set in Mask from b, the others from a.
+  template <class T, unsigned Mask>
+  ALGORITMI_TARGET_SSE42 static vec blend(vec a, vec b) {
+    constexpr int imm = static_cast<int>(widen_mask(Mask, sizeof(T) / 2));
+    return _mm_blend_epi16(a, b, imm);
+  }
+};
+
+// Masks for partial loads: 32-bit lane i of (lane_window + 8 - k) is set
+// iff i < k.
+alignas(64) inline constexpr std::int32_t lane_window[16] = {-1, -1, -1, -1, -1, -1, -1, -1};
+
+struct avx2_sort_ops {
+  using vec = __m256i;
+  static constexpr unsigned bytes = 32;
+  template <class T>
+  static constexpr std::size_t min_keys = sizeof(T) == 4 ? 0 : exact_networks + 1;
+
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static vec encode(vec v) {
+    if constexpr (std::is_same_v<T, std::uint64_t>)
+      return _mm256_xor_si256(v, _mm256_set1_epi64x(INT64_MIN));
+    else
+      return v;
+  }
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static vec fill(T x) {
+    if constexpr (sizeof(T) == 4)
+      return _mm256_set1_epi32(bits_of(x));
+    else
+      return encode<T>(_mm256_set1_epi64x(bits_of(x)));
+  }
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static vec window(std::size_t count) {
+    std::size_t const words = count * sizeof(T) / 4;
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lane_window + 8 - words));
+  }
+  // Always masked, even for whole registers: one mispredicted branch costs
+  // more than the mask. Lanes past `count` are never touched.
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static vec load(T const* p, std::size_t count, T pad) {
+    vec const m = window<T>(count);
+    vec const v = sizeof(T) == 4
+                      ? _mm256_maskload_epi32(reinterpret_cast<int const*>(p), m)
+                      : _mm256_maskload_epi64(reinterpret_cast<long long const*>(p), m);
+    return _mm256_blendv_epi8(fill(pad), encode<T>(v), m);
+  }
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static void store(T* p, std::size_t count, vec v) {
+    v = encode<T>(v);
+    if constexpr (sizeof(T) == 4)
+      _mm256_maskstore_epi32(reinterpret_cast<int*>(p), window<T>(count), v);
+    else
+      _mm256_maskstore_epi64(reinterpret_cast<long long*>(p), window<T>(count), v);
+  }
+  ALGORITMI_TARGET_AVX2 static vec lt64(vec x, vec y) { return _mm256_cmpgt_epi64(y, x); }
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static vec min(vec x, vec y) {
+    if constexpr (std::is_same_v<T, std::int32_t>) return _mm256_min_epi32(x, y);
+    if constexpr (std::is_same_v<T, std::uint32_t>) return _mm256_min_epu32(x, y);
+    if constexpr (std::is_same_v<T, float>)
+      return _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y)));
+    if constexpr (std::is_same_v<T, double>)
+      return _mm256_castpd_si256(_mm256_min_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y)));
+    if constexpr (sizeof(T) == 8 && std::is_integral_v<T>)
+      return _mm256_blendv_epi8(y, x, lt64(x, y));
+  }
+  template <class T>
+  ALGORITMI_TARGET_AVX2 static vec max(vec x, vec y) {
+    if constexpr (std::is_same_v<T, std::int32_t>) return _mm256_max_epi32(x, y);
+    if constexpr (std::is_same_v<T, std::uint32_t>) return _mm256_max_epu32(x, y);
+    if constexpr (std::is_same_v<T, float>)
+      return _mm256_castps_si256(_mm256_max_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y)));
+    if constexpr (std::is_same_v<T, double>)
+      return _mm256_castpd_si256(_mm256_max_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y)));
+    if constexpr (sizeof(T) == 8 && std::is_integral_v<T>)
+      return _mm256_blendv_epi8(x, y, lt64(x, y));
+  }
+  // In-lane shuffles where they suffice; they are cheaper than crossing the
+  // 128-bit halves.
+  template <class T, unsigned M>
+  ALGORITMI_TARGET_AVX2 static vec permute(vec v) {
+    constexpr int imm = xor_shuffle(M);
+    if constexpr (sizeof(T) == 4) {
+      if constexpr ((M & 3) != 0) v = _mm256_shuffle_epi32(v, imm);
+      if constexpr ((M & 4) != 0) v = _mm256_permute4x64_epi64(v, 0x4e);
+      return v;
+    } else if constexpr (M == 1) {
+      return _mm256_shuffle_epi32(v, 0x4e);
+    } else if constexpr (M != 0) {
+      return _mm256_permute4x64_epi64(v, imm);
+    } else {
+      return v;
+    }
+  }
+  template <class T, unsigned Mask>
+  ALGORITMI_TARGET_AVX2 static vec blend(vec a, vec b) {
+    constexpr int imm = static_cast<int>(widen_mask(Mask, sizeof(T) / 4));
+    return _mm256_blend_epi32(a, b, imm);
+  }
+};
+
+// Bitonic sorting network over K registers of L lanes, element i being lane
+// i % L of register i / L. Every block of 2s elements is sorted by flipping
+// (i against i ^ (2s - 1)) and then half-cleaning at distances s / 2 ... 1,
+// which leaves all blocks ascending; descending order swaps min and max.
+// Distances below L are shuffles within a register; larger ones pair whole
+// registers.
+#define ALGORITMI_SMALL_SORT_KERNELS(TARGET, SUFFIX, OPS)                                 \
+  template <class T, bool Desc, unsigned M, std::size_t K>                                \
+  TARGET ALGORITMI_ALWAYS_INLINE void layer_##SUFFIX(OPS::vec* r) noexcept {              \
+    constexpr unsigned L = OPS::bytes / sizeof(T);                                        \
+    if constexpr (M < L) {                                                                \
+      for (std::size_t k = 0; k < K; ++k) {                                               \
+        OPS::vec const p = OPS::permute<T, M>(r[k]);                                      \
+        OPS::vec const lo = Desc ? OPS::max<T>(r[k], p) : OPS::min<T>(r[k], p);           \
+        OPS::vec const hi = Desc ? OPS::min<T>(r[k], p) : OPS::max<T>(r[k], p);           \
+        r[k] = OPS::blend<T, upper_lanes(M, L)>(lo, hi);                                  \
+      }                                                                                   \
+    } else {                                                                              \
+      constexpr std::size_t J = M / L;                                                    \
+      constexpr unsigned lane = M % L;                                                    \
+      for (std::size_t k = 0; k < K; ++k) {                                               \
+        if (k & top_bit(J)) continue;                                                     \
+        std::size_t const j = k ^ J;                                                      \
+        OPS::vec const b = OPS::permute<T, lane>(r[j]);                                   \
+        OPS::vec const lo = Desc ? OPS::max<T>(r[k], b) : OPS::min<T>(r[k], b);           \
+        OPS::vec const hi = Desc ? OPS::min<T>(b, r[k]) : OPS::max<T>(b, r[k]);           \
+        r[k] = lo;                                                                        \
+        r[j] = OPS::permute<T, lane>(hi);                                                 \
+      }                                                                                   \
+    }                                                                                     \
+  }                                                                                       \
+                                                                                          \
+  template <class T, bool Desc, std::size_t K, unsigned D>                                \
+  TARGET ALGORITMI_ALWAYS_INLINE void clean_##SUFFIX(OPS::vec* r) noexcept {              \
+    if constexpr (D > 0) {                                                                \
+      layer_##SUFFIX<T, Desc, D, K>(r);                                                   \
+      clean_##SUFFIX<T, Desc, K, D / 2>(r);                                               \
+    }                                                                                     \
+  }                                                                                       \
+                                                                                          \
+  template <class T, bool Desc, std::size_t K, unsigned S>                                \
+  TARGET ALGORITMI_ALWAYS_INLINE void bitonic_##SUFFIX(OPS::vec* r) noexcept {            \
+    if constexpr (S < K * (OPS::bytes / sizeof(T))) {                                     \
+      layer_##SUFFIX<T, Desc, 2 * S - 1, K>(r);                                           \
+      clean_##SUFFIX<T, Desc, K, S / 2>(r);                                               \
+      bitonic_##SUFFIX<T, Desc, K, 2 * S>(r);                                             \
+    }                                                                                     \
+  }                                                                                       \
+                                                                                          \
+  template <class T, bool Desc, std::size_t K>                                            \
+  TARGET ALGORITMI_ALWAYS_INLINE void sort_regs_##SUFFIX(T* p, std::size_t n) noexcept {  \
+    constexpr std::size_t L = OPS::bytes / sizeof(T);                                     \
+    T const pad = padding<T, Desc>();                                                     \
+    OPS::vec r[K];                                                                        \
+    /* Register k holds count[k] elements, 0 to L, starting at p + first[k]. */           \
+    std::size_t first[K], count[K];                                                       \
+    for (std::size_t k = 0; k < K; ++k) {                                                 \
+      first[k] = k * L < n ? k * L : n;                                                   \
+      count[k] = n - first[k] < L ? n - first[k] : L;                                     \
+      r[k] = OPS::load<T>(p + first[k], count[k], pad);                                   \
+    }                                                                                     \
+    bitonic_##SUFFIX<T, Desc, K, 1>(r);                                                   \
+    for (std::size_t k = 0; k < K; ++k) OPS::store<T>(p + first[k], count[k], r[k]);      \
+  }                                                                                       \
+                                                                                          \
+  template <class T, bool Desc>                                                           \
+  TARGET void sort_##SUFFIX(T* p, std::size_t n) noexcept {                               \
+    constexpr std::size_t L = OPS::bytes / sizeof(T);                                     \
+    if constexpr (OPS::min_keys<T> <= small_sort_max) {                                   \
+      if (n >= OPS::min_keys<T>) {                                                        \
+        if (n <= L) return sort_regs_##SUFFIX<T, Desc, 1>(p, n);                          \
+        if (n <= 2 * L) return sort_regs_##SUFFIX<T, Desc, 2>(p, n);                      \
+        if (n <= 4 * L) return sort_regs_##SUFFIX<T, Desc, 4>(p, n);                      \
+        if constexpr (8 * L <= small_sort_max)                                            \
+          if (n <= 8 * L) return sort_regs_##SUFFIX<T, Desc, 8>(p, n);                    \
+      }                                                                                   \
+    }                                                                                     \
+    sort_scalar<T, Desc>(p, n);                                                           \
+  }
+
+ALGORITMI_SMALL_SORT_KERNELS(ALGORITMI_TARGET_SSE42, sse42, sse_sort_ops)
+ALGORITMI_SMALL_SORT_KERNELS(ALGORITMI_TARGET_AVX2, avx2, avx2_sort_ops)
+
+#undef ALGORITMI_SMALL_SORT_KERNELS
+
+#endif  // ALGORITMI_HAS_SIMD
+
+template <class T>
+struct kernel_table {
+  void (*ascending)(T*, std::size_t) noexcept;
+  void (*descending)(T*, std::size_t) noexcept;
+};
+
+template <class T>
+kernel_table<T> make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  if constexpr (simd_key_v<T>) {
+    switch (usable_isa(which)) {
+      case isa::avx2:
+        return {&sort_avx2<T, false>, &sort_avx2<T, true>};
+      case isa::sse42:
+        return {&sort_sse42<T, false>, &sort_sse42<T, true>};
+      default:
+        break;
+    }
+  }
+#else
+  (void)which;
+#endif
+  return {&sort_scalar<T, false>, &sort_scalar<T, true>};
+}
+
+template <class T>
+kernel_table<T> const& kernels() noexcept {
+  static kernel_table<T> const table = make_kernel_table<T>(active_isa());
+  return table;
+}
+
+// Iterators whose elements are known to be contiguous, so the kernels can
+// work in place instead of on a copy.
+template <class It, class T = typename std::iterator_traits<It>::value_type>
+inline constexpr bool contiguous_v =
+    std::is_pointer_v<It> || std::is_same_v<It, typename std::vector<T>::iterator> ||
+    std::is_same_v<It, typename std::pmr::vector<T>::iterator> ||
+    std::is_same_v<It, typename std::array<T, 1>::iterator>;
+
+template <class RandomIt, class Compare>
+void small_sort(kernel_table<typename std::iterator_traits<RandomIt>::value_type> const& k,
+                RandomIt first, RandomIt last, Compare& comp) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  auto const n = static_cast<std::size_t>(last - first);
+  auto const sort = is_descending<Compare>::value ? k.descending : k.ascending;
+  if constexpr (contiguous_v<RandomIt>) {
+    sort(&*first, n);
+  } else if (n > small_sort_max) {
+    branchless_insertion_sort(first, last, comp);
+  } else {
+    T v[small_sort_max];
+    std::copy(first, last, v);
+    sort(v, n);
+    std::copy(v, v + n, first);
+  }
+}
+
+}  // namespace detail::smallsort
+
+// The comparators of the N-input network static_sort<N> runs, in order;
+// those within one round of the merge touch disjoint elements.
+template <std::size_t N>
+constexpr auto sorting_network() noexcept {
+  static_assert(N <= 256, "sorting_network: indices are 8-bit");
+  return detail::smallsort::network_v<N>;
+}
+
+// Sorts first[0, N) with a fully unrolled sorting network. Not stable.
+template <std::size_t N, class RandomIt, class Compare>
+void static_sort(RandomIt first, Compare comp) {
+  static_assert(N <= 64, "static_sort: use small_sort or pdqsort for larger inputs");
+  detail::smallsort::static_sort<N>(first, comp);
+}
+
+template <std::size_t N, class RandomIt>
+void static_sort(RandomIt first) {
+  static_sort<N>(first, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+// Insertion sort without data-dependent branches: O(n^2) compare-exchanges
+// whatever the input. Only worth it for cheap comparisons and n below a few
+// dozen.
+template <class RandomIt, class Compare>
+void branchless_insertion_sort(RandomIt first, RandomIt last, Compare comp) {
+  detail::smallsort::branchless_insertion_sort(first, last, comp);
+}
+
+template <class RandomIt>
+void branchless_insertion_sort(RandomIt first, RandomIt last) {
+  branchless_insertion_sort(first, last,
+                            std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+// Sorts [first, last) of at most small_sort_max elements. Not stable.
+template <class RandomIt, class Compare>
+void small_sort(RandomIt first, RandomIt last, Compare comp) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  if (last - first < 2) return;
+  if constexpr (detail::smallsort::cheap_v<T, Compare>)
+    detail::smallsort::small_sort(detail::smallsort::kernels<T>(), first, last, comp);
+  else
+    detail::smallsort::branchless_insertion_sort(first, last, comp);
+}
+
+template <class RandomIt>
+void small_sort(RandomIt first, RandomIt last) {
+  small_sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+// Same as above with an explicit instruction set (clamped to the host's).
+template <class RandomIt, class Compare>
+void small_sort(isa which, RandomIt first, RandomIt last, Compare comp) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  if (last - first < 2) return;
+  if constexpr (detail::smallsort::cheap_v<T, Compare>)
+    detail::smallsort::small_sort(detail::smallsort::make_kernel_table<T>(which), first, last,
+                                  comp);
+  else
+    detail::smallsort::branchless_insertion_sort(first, last, comp);
+}
+
+}  // namespace algoritmi
@@ -0,0 +1,37 @@
+// Non-owning view of a contiguous array (C++17 stand-in for std::span).
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace algoritmi {
+
+template <class T>
+class span {
+ public:
+  using element_type = T;
+  using iterator = T*;
+
+  constexpr span() noexcept = default;
+  constexpr span(T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+  constexpr span(T* first, T* last) noexcept : data_(first), size_(static_cast<std::size_t>(last - first)) {}
+
+  // Any contiguous container exposing data() and size(), e.g. std::vector.
+  template <class C, class = std::enable_if_t<
+                         std::is_convertible_v<decltype(std::declval<C&>().data()), T*>>>
+  constexpr span(C& c) noexcept : data_(c.data()), size_(c.size()) {}
+
+  constexpr T* data() const noexcept { return data_; }
+  constexpr std::size_t size() const noexcept { return size_; }
+  constexpr bool empty() const noexcept { return size_ == 0; }
+  constexpr T* begin() const noexcept { return data_; }
+  constexpr T* end() const noexcept { return data_ + size_; }
+  constexpr T& operator[](std::size_t i) const noexcept { return data_[i]; }
+
+ private:
+  T* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,25 @@
+// String search and indexing over byte strings.
+//
+//   find_substring(text, pattern[, from])
+//                                 first occurrence at or after from, or npos
+//   substring_searcher            one pattern prepared for many searches;
+//                                 find, count
+//   aho_corasick                  many patterns at once over a double-array
+//                                 trie; for_each_match, find_all,
+//                                 contains_any
+//   suffix_array(text)            SA-IS, O(n)
+//   lcp_array(text, sa)           Kasai, O(n)
+//   suffix_range(text, sa, p)     suffix-array positions starting with p
+//
+// Substring search runs a first/last-byte filter over 32 (AVX2) or 16
+// (SSE4.2) positions per step, picked at runtime like the search kernels
+// (see cpu.hpp), and falls back to the linear-time two-way algorithm on
+// inputs the filter handles badly. Aho-Corasick skips text that cannot
+// start a pattern with a SIMD byte-set scan. Overloads taking an `isa` run
+// a specific implementation.
+#pragma once
+
+#include "strings/aho_corasick.hpp"
+#include "strings/kernels.hpp"
+#include "strings/substring.hpp"
+#include "strings/suffix_array.hpp"
@@ -0,0 +1,302 @@
+// Multi-pattern search: an Aho-Corasick automaton over a double-array trie
+// (Aoe, "An efficient digital search algorithm by using a double-array
+// structure", 1989).
+//
+// A state is a cell index. Its child on byte c sits at cell base + c, and
+// is really its child if that cell's check field holds the state. One
+// 8-byte load per transition tests and follows an edge, and the whole
+// trie is two flat arrays whatever the alphabet. Children are placed by
+// first fit while the trie is built breadth-first from the sorted patterns,
+// which packs the cells densely.
+//
+// Failure links are followed on a mismatch as usual; reports walk a chain
+// of suffix states that end a pattern, so states without output cost one
+// compare. While the automaton sits at the root it skips ahead with the
+// SIMD byte-set kernel to the next byte that starts a pattern, if few
+// bytes do.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../cpu.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+
+class aho_corasick {
+ public:
+  struct match {
+    std::size_t pattern;  // index in the sequence the automaton was built from
+    std::size_t begin;    // text[begin, end) equals that pattern
+    std::size_t end;
+  };
+
+  // Root skipping pays off when the bytes that start a pattern are rare in
+  // the text; with more distinct first bytes than this it is left off.
+  static constexpr unsigned prefilter_max_starts = 16;
+
+  explicit aho_corasick(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : cells_(mr), links_(mr), outputs_(mr), length_(mr), same_(mr) {
+    cells_.assign(alphabet + 1, cell{0, none});
+    cells_[0].check = 0;
+    links_.assign(cells_.size(), link{0, none});
+    outputs_.assign(cells_.size(), output{none, none});
+  }
+
+  // Builds the automaton for the patterns in [first, last), each convertible
+  // to std::string_view and not empty. Equal patterns are all reported.
+  template <class InputIt>
+  aho_corasick(InputIt first, InputIt last,
+               std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : cells_(mr), links_(mr), outputs_(mr), length_(mr), same_(mr) {
+    std::pmr::vector<std::string_view> patterns(mr);
+    for (; first != last; ++first) patterns.emplace_back(*first);
+    build(patterns);
+  }
+
+  std::size_t pattern_count() const noexcept { return length_.size(); }
+  std::size_t state_count() const noexcept { return states_; }
+  std::size_t memory_bytes() const noexcept {
+    return cells_.size() * (sizeof(cell) + sizeof(link) + sizeof(output)) +
+           length_.size() * 2 * sizeof(std::uint32_t);
+  }
+
+  // Calls fn(match) for every occurrence of every pattern, in order of
+  // their end position; occurrences ending at the same byte are reported
+  // longest first.
+  template <class Fn>
+  void for_each_match(std::string_view text, Fn&& fn) const {
+    scan(detail::strings::kernels(), text, [&](match const& m) {
+      fn(m);
+      return true;
+    });
+  }
+
+  // Same as above with an explicit instruction set (clamped to the host's).
+  template <class Fn>
+  void for_each_match(isa which, std::string_view text, Fn&& fn) const {
+    scan(detail::strings::make_kernel_table(which), text, [&](match const& m) {
+      fn(m);
+      return true;
+    });
+  }
+
+  std::pmr::vector<match> find_all(
+      std::string_view text,
+      std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const {
+    std::pmr::vector<match> out(mr);
+    for_each_match(text, [&](match const& m) { out.push_back(m); });
+    return out;
+  }
+
+  // Whether any pattern occurs in `text`; stops at the first occurrence.
+  bool contains_any(std::string_view text) const {
+    return !scan(detail::strings::kernels(), text, [](match const&) { return false; });
+  }
+
+ private:
+  static constexpr std::uint32_t none = ~std::uint32_t{0};
+  static constexpr std::size_t alphabet = 256;
+  static constexpr std::size_t place_window = 16 * alphabet;
+
+  struct cell {
+    std::uint32_t base;   // children at base + byte
+    std::uint32_t check;  // parent state; `none` if the cell is free
+  };
+  struct link {
+    std::uint32_t fail;    // longest proper suffix that is a state
+    std::uint32_t report;  // first state on the suffix chain ending a pattern
+  };
+  struct output {
+    std::uint32_t pattern;  // first pattern ending exactly here
+    std::uint32_t next;     // next state on the report chain
+  };
+
+  // Returns false as soon as `report` does.
+  template <class Report>
+  bool scan(detail::strings::kernel_table const& k, std::string_view text,
+            Report&& report) const {
+    auto const* t = reinterpret_cast<unsigned char const*>(text.data());
+    std::size_t const n = text.size();
+    cell const* const cells = cells_.data();
+    link const* const links = links_.data();
+    std::uint32_t s = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (s == 0 && skip_root_) {
+        i += k.find_in_set(t + i, n - i, starts_);
+        if (i == n) break;
+      }
+      std::uint32_t const c = t[i];
+      for (;;) {
+        std::uint32_t const next = cells[s].base + c;
+        if (cells[next].check == s) {
+          s = next;
+          break;
+        }
+        if (s == 0) break;
+        s = links[s].fail;
+      }
+      for (std::uint32_t u = links[s].report; u != none; u = outputs_[u].next)
+        for (std::uint32_t p = outputs_[u].pattern; p != none; p = same_[p])
+          if (!report(match{p, i + 1 - length_[p], i + 1})) return false;
+    }
+    return true;
+  }
+
+  struct pending {
+    std::uint32_t state;
+    std::uint32_t lo, hi;  // range of the sorted patterns below this state
+    std::uint32_t depth;
+  };
+  struct placed {
+    std::uint32_t state, parent;
+    unsigned char label;
+  };
+
+  bool is_free(std::size_t cell_index) {
+    if (cell_index >= cells_.size()) {
+      if (cell_index + alphabet >= none) throw std::length_error("aho_corasick: too many states");
+      cells_.resize(std::max(cells_.size() * 2, cell_index + alphabet + 1), cell{0, none});
+    }
+    return cells_[cell_index].check == none;
+  }
+
+  void build(std::pmr::vector<std::string_view> const& patterns) {
+    std::pmr::memory_resource* const mr = cells_.get_allocator().resource();
+    std::size_t const count = patterns.size();
+    if (count >= none) throw std::length_error("aho_corasick: too many patterns");
+    length_.resize(count);
+    same_.assign(count, none);
+    for (std::size_t i = 0; i < count; ++i) {
+      if (patterns[i].empty()) throw std::invalid_argument("aho_corasick: empty pattern");
+      if (patterns[i].size() >= none) throw std::length_error("aho_corasick: pattern too long");
+      length_[i] = static_cast<std::uint32_t>(patterns[i].size());
+    }
+
+    // Sorted, a node's patterns form a range: those ending at the node come
+    // first, then one sub-range per child byte in increasing order.
+    std::pmr::vector<std::uint32_t> order(count, mr);
+    for (std::size_t i = 0; i < count; ++i) order[i] = static_cast<std::uint32_t>(i);
+    std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+      return patterns[a] < patterns[b];
+    });
+    auto byte_at = [&](std::uint32_t k, std::uint32_t depth) {
+      return static_cast<unsigned char>(patterns[order[k]][depth]);
+    };
+
+    cells_.assign(alphabet + 1, cell{0, none});
+    cells_[0].check = 0;  // taken; never a child since every base is >= 1
+    std::pmr::vector<placed> bfs(mr);
+    std::pmr::vector<std::pair<std::uint32_t, std::uint32_t>> ends(mr);  // (state, pattern)
+    std::pmr::vector<pending> queue(mr);
+    queue.push_back({0, 0, static_cast<std::uint32_t>(count), 0});
+    bfs.push_back({0, 0, 0});
+    std::size_t first_free = 1, used_end = 1;
+    unsigned char labels[alphabet];
+    std::uint32_t bounds[alphabet + 1];
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+      pending const node = queue[head];
+      std::uint32_t k = node.lo;
+      if (k < node.hi && length_[order[k]] == node.depth) {
+        ends.emplace_back(node.state, order[k]);
+        for (++k; k < node.hi && length_[order[k]] == node.depth; ++k)
+          same_[order[k - 1]] = order[k];
+      }
+      unsigned children = 0;
+      for (; k < node.hi; ++k) {
+        unsigned char const c = byte_at(k, node.depth);
+        if (children == 0 || labels[children - 1] != c) {
+          labels[children] = c;
+          bounds[children++] = k;
+        }
+      }
+      if (children == 0) continue;
+      bounds[children] = node.hi;
+
+      // First fit, from the first free cell but no further back than
+      // place_window cells before the end of the used part: holes behind
+      // that are given up, as darts-clone does, or every node with many
+      // children would rescan the whole array. A nearly full stretch is
+      // skipped for good as well.
+      first_free = std::max(first_free, used_end > place_window ? used_end - place_window : 1);
+      while (!is_free(first_free)) ++first_free;
+      std::size_t base = 0, taken = 0, pos = first_free;
+      for (;; ++pos) {
+        if (!is_free(pos)) {
+          ++taken;
+          continue;
+        }
+        if (pos <= labels[0]) continue;
+        base = pos - labels[0];
+        bool fits = true;
+        for (unsigned j = 1; j < children && fits; ++j) fits = is_free(base + labels[j]);
+        if (fits) break;
+      }
+      if (taken * 20 >= (pos - first_free + 1) * 19) first_free = pos;
+      cells_[node.state].base = static_cast<std::uint32_t>(base);
+      for (unsigned j = 0; j < children; ++j) {
+        auto const child = static_cast<std::uint32_t>(base + labels[j]);
+        cells_[child].check = node.state;
+        used_end = std::max<std::size_t>(used_end, child + 1);
+        queue.push_back({child, bounds[j], bounds[j + 1], node.depth + 1});
+        bfs.push_back({child, node.state, labels[j]});
+      }
+      if (node.state == 0) {
+        for (unsigned j = 0; j < children; ++j) starts_.insert(labels[j]);
+        skip_root_ = children <= prefilter_max_starts;
+      }
+    }
+    states_ = bfs.size();
+
+    // Every lookup reads base + byte, so the array must reach past the
+    // largest base by a full alphabet.
+    std::size_t top = 0;
+    for (placed const& p : bfs) top = std::max<std::size_t>(top, p.state);
+    for (placed const& p : bfs) top = std::max<std::size_t>(top, cells_[p.state].base);
+    cells_.resize(top + alphabet + 1, cell{0, none});
+    cells_.shrink_to_fit();
+
+    links_.assign(cells_.size(), link{0, none});
+    outputs_.assign(cells_.size(), output{none, none});
+    for (auto const& [state, pattern] : ends) outputs_[state].pattern = pattern;
+    // Breadth-first order: a state's failure target is shallower, so done.
+    for (std::size_t i = 1; i < bfs.size(); ++i) {
+      placed const p = bfs[i];
+      std::uint32_t fail = 0;
+      if (p.parent != 0) {
+        for (std::uint32_t f = links_[p.parent].fail;; f = links_[f].fail) {
+          std::uint32_t const next = cells_[f].base + p.label;
+          if (cells_[next].check == f) {
+            fail = next;
+            break;
+          }
+          if (f == 0) break;
+        }
+      }
+      links_[p.state].fail = fail;
+      outputs_[p.state].next = links_[fail].report;
+      links_[p.state].report =
+          outputs_[p.state].pattern != none ? p.state : outputs_[p.state].next;
+    }
+  }
+
+  std::pmr::vector<cell> cells_;
+  std::pmr::vector<link> links_;
+  std::pmr::vector<output> outputs_;
+  std::pmr::vector<std::uint32_t> length_;
+  std::pmr::vector<std::uint32_t> same_;  // next pattern equal to this one
+  std::size_t states_ = 1;
+  detail::strings::byte_set starts_;
+  bool skip_root_ = false;
+};
+
+}  // namespace algoritmi
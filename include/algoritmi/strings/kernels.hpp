@@ -0,0 +1,210 @@
+// Byte-scanning kernels behind the string algorithms, one version per
+// instruction set, selected like the search kernels (see cpu.hpp).
+//
+//   filter_find  substring candidates by first and last byte: a vector of
+//                text and the same vector shifted by m - 1 are compared with
+//                the two bytes, and only positions where both match are
+//                checked with memcmp (W. Muła, "SIMD-friendly algorithms for
+//                substring searching"). Gives up, and hands the rest of the
+//                text to the two-way search, once the false positives cost
+//                more than a few compares per byte scanned.
+//   find_in_set  first byte belonging to a set of up to 256 values: two
+//                PSHUFB lookups over the low nibble return the set's bitmap
+//                row, a third selects the bit for the high nibble
+//                (Hyperscan's "truffle").
+//
+// The scalar filter_find rules nothing out, so the scalar path is the plain
+// two-way search.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::strings {
+
+inline constexpr std::size_t npos = std::string_view::npos;
+
+// Set of byte values as a 16 x 16 bit matrix: row c & 15, bit c >> 4, with
+// the rows for bytes below 128 and from 128 up kept apart so that PSHUFB,
+// which zeroes lanes whose index has the top bit set, does the split.
+struct byte_set {
+  alignas(16) std::uint8_t low[16] = {};
+  alignas(16) std::uint8_t high[16] = {};
+
+  void insert(unsigned char c) noexcept {
+    std::uint8_t* const rows = c < 128 ? low : high;
+    rows[c & 15] |= static_cast<std::uint8_t>(1u << ((c >> 4) & 7));
+  }
+  bool contains(unsigned char c) const noexcept {
+    std::uint8_t const* const rows = c < 128 ? low : high;
+    return (rows[c & 15] >> ((c >> 4) & 7)) & 1;
+  }
+};
+
+// ---------------------------------------------------------------- scalar --
+
+// Needs 2 <= m <= n. Returns the first match, or npos with `resume` set to
+// the first position that was not ruled out.
+inline std::size_t filter_find_scalar(char const*, std::size_t, char const*, std::size_t,
+                                      std::size_t& resume) noexcept {
+  resume = 0;
+  return npos;
+}
+
+// Index of the first byte in `set`, or n.
+inline std::size_t find_in_set_scalar(unsigned char const* p, std::size_t n,
+                                      byte_set const& set) noexcept {
+  for (std::size_t i = 0; i < n; ++i)
+    if (set.contains(p[i])) return i;
+  return n;
+}
+
+#if ALGORITMI_HAS_SIMD
+
+struct sse_byte_ops {
+  using vec = __m128i;
+  static constexpr std::size_t width = 16;
+  ALGORITMI_TARGET_SSE42 static vec load(void const* p) {
+    return _mm_loadu_si128(static_cast<__m128i const*>(p));
+  }
+  ALGORITMI_TARGET_SSE42 static vec set1(char c) { return _mm_set1_epi8(c); }
+  // Lanes where a == x and b == y.
+  ALGORITMI_TARGET_SSE42 static unsigned both(vec a, vec x, vec b, vec y) {
+    return static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, x), _mm_cmpeq_epi8(b, y))));
+  }
+  ALGORITMI_TARGET_SSE42 static vec table(std::uint8_t const* rows) { return load(rows); }
+  ALGORITMI_TARGET_SSE42 static vec bit_table() {
+    return _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  }
+  ALGORITMI_TARGET_SSE42 static unsigned in_set(vec v, vec low, vec high, vec bits) {
+    vec const rows = _mm_or_si128(_mm_shuffle_epi8(low, v),
+                                  _mm_shuffle_epi8(high, _mm_xor_si128(v, _mm_set1_epi8(-128))));
+    vec const col = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(7));
+    vec const hit = _mm_and_si128(rows, _mm_shuffle_epi8(bits, col));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(hit, _mm_setzero_si128()))) &
+           0xffffu;
+  }
+};
+
+struct avx2_byte_ops {
+  using vec = __m256i;
+  static constexpr std::size_t width = 32;
+  ALGORITMI_TARGET_AVX2 static vec load(void const* p) {
+    return _mm256_loadu_si256(static_cast<__m256i const*>(p));
+  }
+  ALGORITMI_TARGET_AVX2 static vec set1(char c) { return _mm256_set1_epi8(c); }
+  ALGORITMI_TARGET_AVX2 static unsigned both(vec a, vec x, vec b, vec y) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, x), _mm256_cmpeq_epi8(b, y))));
+  }
+  // PSHUFB works within 128-bit lanes, so the tables are repeated in both.
+  ALGORITMI_TARGET_AVX2 static vec table(std::uint8_t const* rows) {
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const*>(rows)));
+  }
+  ALGORITMI_TARGET_AVX2 static vec bit_table() {
+    return _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+  }
+  ALGORITMI_TARGET_AVX2 static unsigned in_set(vec v, vec low, vec high, vec bits) {
+    vec const rows = _mm256_or_si256(
+        _mm256_shuffle_epi8(low, v),
+        _mm256_shuffle_epi8(high, _mm256_xor_si256(v, _mm256_set1_epi8(-128))));
+    vec const col = _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(7));
+    vec const hit = _mm256_and_si256(rows, _mm256_shuffle_epi8(bits, col));
+    return ~static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+  }
+};
+
+// The filter stops after comparing 4 bytes per byte scanned plus this many,
+// which keeps the whole search linear on inputs such as "aaa...ab" in "aaa...a".
+inline constexpr std::size_t filter_slack = 4096;
+
+#define ALGORITMI_STRING_KERNELS(TARGET, SUFFIX, OPS)                                        \
+  TARGET inline std::size_t filter_find_##SUFFIX(char const* t, std::size_t n, char const* p, \
+                                                 std::size_t m, std::size_t& resume) noexcept { \
+    using ops = OPS;                                                                         \
+    constexpr std::size_t W = ops::width;                                                    \
+    auto const first = ops::set1(p[0]);                                                      \
+    auto const last = ops::set1(p[m - 1]);                                                   \
+    std::size_t const end = n - m + 1; /* candidate starts are [0, end) */                   \
+    std::size_t checked = 0, i = 0;                                                          \
+    for (; i + W <= end; i += W) {                                                           \
+      unsigned mask = ops::both(ops::load(t + i), first, ops::load(t + i + m - 1), last);    \
+      while (mask) {                                                                         \
+        std::size_t const j = i + static_cast<std::size_t>(countr_zero(mask));               \
+        if (std::memcmp(t + j + 1, p + 1, m - 2) == 0) return j;                             \
+        checked += m;                                                                        \
+        if (checked > 4 * i + filter_slack) {                                                \
+          resume = j + 1;                                                                    \
+          return npos;                                                                       \
+        }                                                                                    \
+        mask &= mask - 1;                                                                    \
+      }                                                                                      \
+    }                                                                                        \
+    resume = i;                                                                              \
+    return npos;                                                                             \
+  }                                                                                          \
+                                                                                             \
+  TARGET inline std::size_t find_in_set_##SUFFIX(unsigned char const* p, std::size_t n,      \
+                                                 byte_set const& set) noexcept {             \
+    using ops = OPS;                                                                         \
+    constexpr std::size_t W = ops::width;                                                    \
+    auto const low = ops::table(set.low);                                                    \
+    auto const high = ops::table(set.high);                                                  \
+    auto const bits = ops::bit_table();                                                      \
+    std::size_t i = 0;                                                                       \
+    for (; i + W <= n; i += W) {                                                             \
+      unsigned const m = ops::in_set(ops::load(p + i), low, high, bits);                     \
+      if (m) return i + static_cast<std::size_t>(countr_zero(m));                            \
+    }                                                                                        \
+    return i + find_in_set_scalar(p + i, n - i, set);                                        \
+  }
+
+ALGORITMI_STRING_KERNELS(ALGORITMI_TARGET_SSE42, sse42, sse_byte_ops)
+ALGORITMI_STRING_KERNELS(ALGORITMI_TARGET_AVX2, avx2, avx2_byte_ops)
+
+#undef ALGORITMI_STRING_KERNELS
+
+#endif  // ALGORITMI_HAS_SIMD
+
+struct kernel_table {
+  std::size_t (*filter_find)(char const*, std::size_t, char const*, std::size_t,
+                             std::size_t&) noexcept;
+  std::size_t (*find_in_set)(unsigned char const*, std::size_t, byte_set const&) noexcept;
+};
+
+inline kernel_table make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  switch (usable_isa(which)) {
+    case isa::avx2:
+      return {&filter_find_avx2, &find_in_set_avx2};
+    case isa::sse42:
+      return {&filter_find_sse42, &find_in_set_sse42};
+    default:
+      break;
+  }
+#else
+  (void)which;
+#endif
+  return {&filter_find_scalar, &find_in_set_scalar};
+}
+
+// Table for active_isa(), built once on first use.
+inline kernel_table const& kernels() noexcept {
+  static kernel_table const table = make_kernel_table(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::strings
@@ -0,0 +1,183 @@
+// Substring search: a SIMD first/last-byte filter in front of the two-way
+// algorithm (Crochemore & Perrin, "Two-way string-matching", JACM 1991).
+//
+// The filter handles ordinary text at vector speed. Two-way takes over
+// where the filter gives up, or on hosts without SIMD: it runs in O(n + m)
+// time and O(1) space whatever the input, by splitting the pattern at a
+// critical factorization and matching the right part first.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#include "../cpu.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+namespace detail::strings {
+
+class two_way {
+ public:
+  // The pattern must outlive the object and have at least one byte.
+  explicit two_way(std::string_view pattern) noexcept
+      : p_(reinterpret_cast<unsigned char const*>(pattern.data())),
+        m_(static_cast<std::ptrdiff_t>(pattern.size())) {
+    std::ptrdiff_t p1, p2;
+    std::ptrdiff_t const s1 = maximal_suffix(false, p1);
+    std::ptrdiff_t const s2 = maximal_suffix(true, p2);
+    ell_ = s1 > s2 ? s1 : s2;
+    period_ = s1 > s2 ? p1 : p2;
+    periodic_ = ell_ + 1 <= m_ - period_ && std::memcmp(p_, p_ + period_, ell_ + 1) == 0;
+    if (!periodic_) period_ = std::max(ell_ + 1, m_ - ell_ - 1) + 1;
+  }
+
+  // First match in t[0, n), or npos.
+  std::size_t search(char const* text, std::size_t n) const noexcept {
+    auto const* t = reinterpret_cast<unsigned char const*>(text);
+    std::ptrdiff_t const last = static_cast<std::ptrdiff_t>(n) - m_;
+    if (periodic_) {
+      // The prefix matched before a shift by the period is known to match
+      // again; `memory` is its last index.
+      std::ptrdiff_t j = 0, memory = -1;
+      while (j <= last) {
+        std::ptrdiff_t i = std::max(ell_, memory) + 1;
+        while (i < m_ && p_[i] == t[i + j]) ++i;
+        if (i < m_) {
+          j += i - ell_;
+          memory = -1;
+          continue;
+        }
+        i = ell_;
+        while (i > memory && p_[i] == t[i + j]) --i;
+        if (i <= memory) return static_cast<std::size_t>(j);
+        j += period_;
+        memory = m_ - period_ - 1;
+      }
+    } else {
+      std::ptrdiff_t j = 0;
+      while (j <= last) {
+        std::ptrdiff_t i = ell_ + 1;
+        while (i < m_ && p_[i] == t[i + j]) ++i;
+        if (i < m_) {
+          j += i - ell_;
+          continue;
+        }
+        i = ell_;
+        while (i >= 0 && p_[i] == t[i + j]) --i;
+        if (i < 0) return static_cast<std::size_t>(j);
+        j += period_;
+      }
+    }
+    return npos;
+  }
+
+ private:
+  // Start (minus one) of the lexicographically greatest suffix under the
+  // byte order, or under its reverse, and that suffix's period.
+  std::ptrdiff_t maximal_suffix(bool reversed, std::ptrdiff_t& period) const noexcept {
+    std::ptrdiff_t ms = -1, j = 0, k = 1;
+    period = 1;
+    while (j + k < m_) {
+      unsigned char const a = p_[j + k], b = p_[ms + k];
+      if (reversed ? a > b : a < b) {
+        j += k;
+        k = 1;
+        period = j - ms;
+      } else if (a == b) {
+        if (k != period) {
+          ++k;
+        } else {
+          j += period;
+          k = 1;
+        }
+      } else {
+        ms = j++;
+        k = period = 1;
+      }
+    }
+    return ms;
+  }
+
+  unsigned char const* p_;
+  std::ptrdiff_t m_;
+  std::ptrdiff_t ell_ = -1;   // critical position: the right part starts at ell_ + 1
+  std::ptrdiff_t period_ = 1;
+  bool periodic_ = false;
+};
+
+// First match of `pattern` in `text` at or after `from`. `prepared`, if
+// given, is the two-way state for `pattern`; otherwise it is built only if
+// the filter gives up.
+inline std::size_t find_from(kernel_table const& k, std::string_view text,
+                             std::string_view pattern, std::size_t from,
+                             two_way const* prepared) noexcept {
+  std::size_t const n = text.size(), m = pattern.size();
+  if (from > n || m > n - from) return npos;
+  if (m == 0) return from;
+  char const* const t = text.data() + from;
+  std::size_t const len = n - from;
+  if (m == 1) {
+    void const* hit = std::memchr(t, pattern[0], len);
+    return hit ? static_cast<std::size_t>(static_cast<char const*>(hit) - text.data()) : npos;
+  }
+  std::size_t resume = 0;
+  std::size_t const hit = k.filter_find(t, len, pattern.data(), m, resume);
+  if (hit != npos) return from + hit;
+  if (m > len - resume) return npos;
+  std::size_t const rest = prepared ? prepared->search(t + resume, len - resume)
+                                    : two_way(pattern).search(t + resume, len - resume);
+  return rest == npos ? npos : from + resume + rest;
+}
+
+}  // namespace detail::strings
+
+// Position of the first occurrence of `pattern` in `text` at or after
+// `from`, or std::string_view::npos. An empty pattern matches at `from`.
+inline std::size_t find_substring(std::string_view text, std::string_view pattern,
+                                  std::size_t from = 0) noexcept {
+  return detail::strings::find_from(detail::strings::kernels(), text, pattern, from, nullptr);
+}
+
+inline std::size_t find_substring(isa which, std::string_view text, std::string_view pattern,
+                                  std::size_t from = 0) noexcept {
+  return detail::strings::find_from(detail::strings::make_kernel_table(which), text, pattern,
+                                    from, nullptr);
+}
+
+// One pattern searched for in many texts, or many times in one: the
+// two-way factorization is computed once. The pattern's characters are not
+// copied and must outlive the searcher.
+class substring_searcher {
+ public:
+  explicit substring_searcher(std::string_view pattern) noexcept
+      : pattern_(pattern), two_way_(pattern.empty() ? std::string_view(" ") : pattern) {}
+
+  std::string_view pattern() const noexcept { return pattern_; }
+
+  std::size_t find(std::string_view text, std::size_t from = 0) const noexcept {
+    return detail::strings::find_from(detail::strings::kernels(), text, pattern_, from,
+                                      &two_way_);
+  }
+
+  std::size_t find(isa which, std::string_view text, std::size_t from = 0) const noexcept {
+    return detail::strings::find_from(detail::strings::make_kernel_table(which), text, pattern_,
+                                      from, &two_way_);
+  }
+
+  // Number of occurrences in `text`, overlapping ones included.
+  std::size_t count(std::string_view text) const noexcept {
+    std::size_t c = 0;
+    for (std::size_t i = find(text); i != npos; i = find(text, i + 1)) ++c;
+    return c;
+  }
+
+ private:
+  static constexpr std::size_t npos = detail::strings::npos;
+
+  std::string_view pattern_;
+  detail::strings::two_way two_way_;
+};
+
+}  // namespace algoritmi
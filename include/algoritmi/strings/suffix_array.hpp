@@ -0,0 +1,196 @@
+// Suffix arrays by induced sorting (Nong, Zhang & Chan, "Two Efficient
+// Algorithms for Linear Time Suffix Array Construction", 2011), and LCP
+// arrays by Kasai et al.'s algorithm (CPM 2001).
+//
+// SA-IS classifies each suffix as S (smaller than the next) or L, sorts
+// only the leftmost-S suffixes, and induces the order of all the others
+// from them in two bucket passes. Sorting the LMS suffixes is the same
+// problem on a text of about half the length, named by their LMS
+// substrings, so the whole is O(n). The layout follows the AtCoder Library
+// implementation; buffers come from the caller's memory resource.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../detail/scratch.hpp"
+
+namespace algoritmi {
+namespace detail::strings {
+
+// Below this length comparison sorting is faster than the bucket passes.
+inline constexpr std::size_t sais_naive_threshold = 16;
+
+template <class I, class S>
+void suffix_sort_naive(S const* s, I n, I* sa) {
+  for (I i = 0; i < n; ++i) sa[i] = i;
+  std::sort(sa, sa + n, [&](I a, I b) {
+    return std::lexicographical_compare(s + a, s + n, s + b, s + n);
+  });
+}
+
+// sa[0, n) = suffix array of s[0, n), whose symbols are in [0, upper].
+// Needs n <= max(I) - 2: the all-ones value marks an empty slot.
+template <class I, class S>
+void sa_is(S const* s, I n, I upper, I* sa, std::pmr::memory_resource* mr) {
+  constexpr I empty = std::numeric_limits<I>::max();
+  if (n < sais_naive_threshold) {
+    suffix_sort_naive(s, n, sa);
+    return;
+  }
+
+  scratch_buffer<unsigned char> ls(n, mr);  // 1 for S-type
+  ls[n - 1] = 0;
+  for (I i = n - 1; i-- > 0;) ls[i] = s[i] == s[i + 1] ? ls[i + 1] : s[i] < s[i + 1];
+
+  // Bucket c holds its L-type suffixes from sum_l[c], its S-type ones from
+  // sum_s[c]. An S-type symbol is never the largest, so upper + 1 entries do.
+  scratch_buffer<I> sum_l(std::size_t{upper} + 1, mr), sum_s(std::size_t{upper} + 1, mr);
+  scratch_buffer<I> buf(std::size_t{upper} + 1, mr);
+  std::fill(sum_l.get(), sum_l.get() + sum_l.size(), I{0});
+  std::fill(sum_s.get(), sum_s.get() + sum_s.size(), I{0});
+  for (I i = 0; i < n; ++i) {
+    if (!ls[i])
+      ++sum_s[s[i]];
+    else
+      ++sum_l[s[i] + 1];
+  }
+  for (I c = 0; c <= upper; ++c) {
+    sum_s[c] += sum_l[c];
+    if (c < upper) sum_l[c + 1] += sum_s[c];
+  }
+
+  // Places the LMS suffixes in the given order, then induces L-type
+  // suffixes left to right and S-type ones right to left. `v - 1 < n`
+  // rejects both v == 0 and empty slots.
+  auto induce = [&](I const* lms, I count) {
+    std::fill(sa, sa + n, empty);
+    std::copy(sum_s.get(), sum_s.get() + sum_s.size(), buf.get());
+    for (I k = 0; k < count; ++k) sa[buf[s[lms[k]]]++] = lms[k];
+    std::copy(sum_l.get(), sum_l.get() + sum_l.size(), buf.get());
+    sa[buf[s[n - 1]]++] = n - 1;
+    for (I i = 0; i < n; ++i) {
+      I const v = sa[i] - 1;
+      if (v < n && !ls[v]) sa[buf[s[v]]++] = v;
+    }
+    std::copy(sum_l.get(), sum_l.get() + sum_l.size(), buf.get());
+    for (I i = n; i-- > 0;) {
+      I const v = sa[i] - 1;
+      if (v < n && ls[v]) sa[--buf[s[v] + 1]] = v;
+    }
+  };
+
+  scratch_buffer<I> lms_map(std::size_t{n} + 1, mr);
+  std::fill(lms_map.get(), lms_map.get() + lms_map.size(), empty);
+  I m = 0;
+  for (I i = 1; i < n; ++i)
+    if (!ls[i - 1] && ls[i]) lms_map[i] = m++;
+  scratch_buffer<I> lms(m, mr);
+  for (I i = 1, k = 0; i < n; ++i)
+    if (!ls[i - 1] && ls[i]) lms[k++] = i;
+
+  induce(lms.get(), m);
+  if (m == 0) return;
+
+  // Name the LMS substrings in their induced order; equal ones share a name.
+  scratch_buffer<I> sorted(m, mr);
+  for (I i = 0, k = 0; i < n; ++i)
+    if (lms_map[sa[i]] != empty) sorted[k++] = sa[i];
+  scratch_buffer<I> rec_s(m, mr);
+  I rec_upper = 0;
+  rec_s[lms_map[sorted[0]]] = 0;
+  for (I k = 1; k < m; ++k) {
+    I l = sorted[k - 1], r = sorted[k];
+    I const end_l = lms_map[l] + 1 < m ? lms[lms_map[l] + 1] : n;
+    I const end_r = lms_map[r] + 1 < m ? lms[lms_map[r] + 1] : n;
+    bool same = end_l - l == end_r - r;
+    if (same) {
+      while (l < end_l && s[l] == s[r]) ++l, ++r;
+      same = l < n && r < n && s[l] == s[r];
+    }
+    if (!same) ++rec_upper;
+    rec_s[lms_map[sorted[k]]] = rec_upper;
+  }
+
+  scratch_buffer<I> rec_sa(m, mr);
+  sa_is(rec_s.get(), m, rec_upper, rec_sa.get(), mr);
+  for (I k = 0; k < m; ++k) sorted[k] = lms[rec_sa[k]];
+  induce(sorted.get(), m);
+}
+
+template <class Index>
+void check_text_size(std::size_t n, char const* who) {
+  static_assert(std::is_unsigned_v<Index>, "Index must be an unsigned integer type");
+  if (n > std::size_t{std::numeric_limits<Index>::max()} - 2)
+    throw std::length_error(std::string(who) + ": text too long for Index type");
+}
+
+}  // namespace detail::strings
+
+// sa[i] = start of the i-th smallest suffix of `text`, bytes compared as
+// unsigned. Index bounds the text length (2^32 - 3 bytes by default) and
+// sets the memory: SA-IS needs about 2n Index values of scratch besides
+// the result.
+template <class Index = std::uint32_t>
+std::pmr::vector<Index> suffix_array(
+    std::string_view text, std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::strings::check_text_size<Index>(text.size(), "suffix_array");
+  auto const n = static_cast<Index>(text.size());
+  std::pmr::vector<Index> sa(n, mr);
+  detail::strings::sa_is(reinterpret_cast<unsigned char const*>(text.data()), n, Index{255},
+                         sa.data(), mr);
+  return sa;
+}
+
+// lcp[i] = length of the longest common prefix of the suffixes at sa[i - 1]
+// and sa[i]; lcp[0] = 0. `sa` is the suffix array of `text`. Kasai's
+// algorithm visits suffixes in text order, where each LCP is at least the
+// previous one minus one, so the compares total O(n).
+template <class Index>
+std::pmr::vector<Index> lcp_array(
+    std::string_view text, Index const* sa,
+    std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  detail::strings::check_text_size<Index>(text.size(), "lcp_array");
+  std::size_t const n = text.size();
+  std::pmr::vector<Index> lcp(n, Index{0}, mr);
+  detail::scratch_buffer<Index> rank(n, mr);
+  for (std::size_t i = 0; i < n; ++i) rank[sa[i]] = static_cast<Index>(i);
+  std::size_t h = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t const r = rank[i];
+    if (r == 0) {
+      h = 0;
+      continue;
+    }
+    std::size_t const j = sa[r - 1];
+    while (i + h < n && j + h < n && text[i + h] == text[j + h]) ++h;
+    lcp[r] = static_cast<Index>(h);
+    if (h > 0) --h;
+  }
+  return lcp;
+}
+
+// [first, last) range of suffix-array positions whose suffixes start with
+// `pattern`, found by two binary searches in O(m log n).
+template <class Index>
+std::pair<std::size_t, std::size_t> suffix_range(std::string_view text, Index const* sa,
+                                                 std::string_view pattern) noexcept {
+  std::size_t const m = pattern.size();
+  auto prefix = [&](Index i) { return text.substr(i, m); };
+  Index const* const first = std::lower_bound(
+      sa, sa + text.size(), pattern, [&](Index i, std::string_view p) { return prefix(i) < p; });
+  Index const* const last = std::upper_bound(
+      first, sa + text.size(), pattern, [&](std::string_view p, Index i) { return p < prefix(i); });
+  return {static_cast<std::size_t>(first - sa), static_cast<std::size_t>(last - sa)};
+}
+
+}  // namespace algoritmi
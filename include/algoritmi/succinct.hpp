@@ -0,0 +1,21 @@
+// Compressed static structures that answer queries without decompressing.
+//
+//   rank_select_bitvector(words, n)   bits plus a ~3% index; rank0/rank1,
+//                                     select0/select1 in constant time
+//   elias_fano(first, last)           non-decreasing integers in about
+//                                     2 + log2(u / n) bits each; operator[],
+//                                     lower_bound, sequential decode
+//   wavelet_matrix(first, last)       integer sequence in log2(sigma) bits
+//                                     per value; access, rank, select,
+//                                     quantile, count_less over ranges
+//
+// Rank and select run POPCNT (SSE4.2) or POPCNT + BMI2 (AVX2) kernels
+// picked at runtime (see cpu.hpp); the bitvector has overloads taking an
+// `isa`. All three can be saved to an index file and used from the mapping
+// (persist.hpp).
+#pragma once
+
+#include "succinct/bitvector.hpp"
+#include "succinct/elias_fano.hpp"
+#include "succinct/kernels.hpp"
+#include "succinct/wavelet_matrix.hpp"
@@ -0,0 +1,169 @@
+// Immutable bitvector with constant-time rank and select.
+//
+// The bits are stored as they are, 64 per word, and the rank/select index
+// (succinct/kernels.hpp) adds 64 bits per 2048 plus a select sample per
+// 8192 ones and per 8192 zeros: about 3.2% on top of the bits. Queries run
+// POPCNT and BMI2 kernels picked at runtime (see cpu.hpp); overloads
+// taking an `isa` run a specific implementation. A bitvector opened from an
+// index file (persist.hpp) answers queries from the mapped arrays.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+#include "../detail/borrowable.hpp"
+#include "../span.hpp"
+#include "kernels.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+
+class rank_select_bitvector {
+ public:
+  rank_select_bitvector() : rank_select_bitvector(span<std::uint64_t const>(), 0) {}
+
+  // The first n bits of `words`, bit i being bit i % 64 of words[i / 64].
+  rank_select_bitvector(span<std::uint64_t const> words, std::size_t n,
+                        std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : words_(mr), chunks_(mr), entries_(mr), samples1_(mr), samples0_(mr) {
+    if (words.size() < (n + 63) / 64)
+      throw std::invalid_argument("rank_select_bitvector: fewer words than bits");
+    build(words, n);
+  }
+
+  // One bit per element of [first, last), set where the element is true.
+  template <class InputIt>
+  rank_select_bitvector(InputIt first, InputIt last,
+                        std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : words_(mr), chunks_(mr), entries_(mr), samples1_(mr), samples0_(mr) {
+    std::pmr::vector<std::uint64_t> words(mr);
+    std::size_t n = 0;
+    for (; first != last; ++first, ++n) {
+      if (n % 64 == 0) words.push_back(0);
+      words.back() |= std::uint64_t{static_cast<bool>(*first)} << (n % 64);
+    }
+    build(words, n);
+  }
+
+  std::size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t count_ones() const noexcept { return ones_; }
+  std::size_t count_zeros() const noexcept { return size_ - ones_; }
+  std::size_t memory_bytes() const noexcept {
+    return words_.size() * 8 + chunks_.size() * 8 + entries_.size() * 8 +
+           (samples1_.size() + samples0_.size()) * 4;
+  }
+
+  bool operator[](std::size_t i) const noexcept { return words_[i / 64] >> (i % 64) & 1; }
+
+  // The bits, padded with zeros to a whole number of 2048-bit superblocks.
+  span<std::uint64_t const> words() const noexcept { return words_; }
+
+  // Number of ones (zeros) in [0, i), for i <= size().
+  std::size_t rank1(std::size_t i) const noexcept {
+    return static_cast<std::size_t>(detail::succinct::kernels().rank1(view(), i));
+  }
+  std::size_t rank0(std::size_t i) const noexcept { return i - rank1(i); }
+
+  // Position of the one (zero) with k ones (zeros) before it, for
+  // k < count_ones() (count_zeros()).
+  std::size_t select1(std::size_t k) const noexcept {
+    return static_cast<std::size_t>(detail::succinct::kernels().select1(view(), k));
+  }
+  std::size_t select0(std::size_t k) const noexcept {
+    return static_cast<std::size_t>(detail::succinct::kernels().select0(view(), k));
+  }
+
+  // Same as above with an explicit instruction set (clamped to the host's).
+  std::size_t rank1(isa which, std::size_t i) const noexcept {
+    return static_cast<std::size_t>(detail::succinct::make_kernel_table(which).rank1(view(), i));
+  }
+  std::size_t select1(isa which, std::size_t k) const noexcept {
+    return static_cast<std::size_t>(
+        detail::succinct::make_kernel_table(which).select1(view(), k));
+  }
+  std::size_t select0(isa which, std::size_t k) const noexcept {
+    return static_cast<std::size_t>(
+        detail::succinct::make_kernel_table(which).select0(view(), k));
+  }
+
+ private:
+  detail::succinct::view view() const noexcept {
+    return {words_.data(), chunks_.data(), entries_.data(), samples1_.data(), samples0_.data()};
+  }
+
+  void build(span<std::uint64_t const> bits, std::size_t n) {
+    using namespace detail::succinct;
+    // Superblock indices are stored in 32 bits; that allows 8 TiB of bits.
+    if (n / superblock_bits >= 0xffffffff)
+      throw std::length_error("rank_select_bitvector: too many bits");
+    size_ = n;
+    // Always one superblock past the last full one, so that rank1(size())
+    // reads an entry and select never runs off the words.
+    std::size_t const superblocks = n / superblock_bits + 1;
+    auto& words = words_.own();
+    words.assign(superblocks * superblock_words, 0);
+    std::copy(bits.begin(), bits.begin() + n / 64, words.begin());
+    if (n % 64) words[n / 64] = bits[n / 64] & ((std::uint64_t{1} << (n % 64)) - 1);
+
+    auto& chunks = chunks_.own();
+    auto& entries = entries_.own();
+    chunks.assign(((superblocks - 1) >> chunk_shift) + 1, 0);
+    entries.resize(superblocks);
+    std::uint64_t ones = 0;
+    for (std::size_t sb = 0; sb < superblocks; ++sb) {
+      if (sb % (std::size_t{1} << chunk_shift) == 0) chunks[sb >> chunk_shift] = ones;
+      std::uint64_t entry = (ones - chunks[sb >> chunk_shift]) << 32;
+      for (std::size_t b = 0; b < 4; ++b) {
+        std::uint64_t c = 0;
+        for (std::size_t w = 0; w < block_words; ++w)
+          c += static_cast<std::uint64_t>(
+              detail::popcount(words[sb * superblock_words + b * block_words + w]));
+        if (b < 3) entry |= c << (10 * b);
+        ones += c;
+      }
+      entries[sb] = entry;
+    }
+    ones_ = static_cast<std::size_t>(ones);
+    sample<true>(samples1_.own(), ones_);
+    sample<false>(samples0_.own(), size_ - ones_);
+  }
+
+  // samples[j] = last superblock with at most j * select_sample ones (zeros)
+  // before it, plus one entry past the last full sample.
+  template <bool Ones, class Vector>
+  void sample(Vector& samples, std::size_t count) {
+    using namespace detail::succinct;
+    detail::succinct::view const v = view();
+    std::size_t const superblocks = entries_.size();
+    samples.resize(count / select_sample + 2);
+    std::size_t j = 0;
+    for (std::size_t sb = 0; sb < superblocks && j < samples.size(); ++sb) {
+      std::uint64_t const next =
+          sb + 1 < superblocks ? count_before<Ones>(v, sb + 1) : ~std::uint64_t{0};
+      for (; j < samples.size() && j * select_sample < next; ++j)
+        samples[j] = static_cast<std::uint32_t>(sb);
+    }
+  }
+
+  friend struct detail::persist::access;
+
+  std::size_t size_ = 0;
+  std::size_t ones_ = 0;
+  detail::borrowable_array<std::uint64_t> words_;
+  detail::borrowable_array<std::uint64_t> chunks_;
+  detail::borrowable_array<std::uint64_t> entries_;
+  detail::borrowable_array<std::uint32_t> samples1_;
+  detail::borrowable_array<std::uint32_t> samples0_;
+};
+
+}  // namespace algoritmi
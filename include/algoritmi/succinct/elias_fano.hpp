@@ -0,0 +1,127 @@
+// Elias-Fano encoding of a non-decreasing sequence of integers.
+//
+// n values below u take about n * (2 + log2(u / n)) bits, within half a
+// bit per value of the best possible for such sequences, and support
+// random access and successor queries without decompressing. Each value is
+// split into its low l = floor(log2(u / n)) bits, stored verbatim, and its
+// high part, stored in unary in a bitvector: value i sets bit high_i + i.
+// Access is a select1 on that bitvector, lower_bound a select0 followed by
+// a scan over the values that share the high part of the key. Sequential
+// decoding walks the set bits of the upper half directly.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../detail/bits.hpp"
+#include "../detail/borrowable.hpp"
+#include "bitvector.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+
+class elias_fano {
+ public:
+  elias_fano() = default;
+
+  // [first, last) must be non-decreasing.
+  template <class ForwardIt>
+  elias_fano(ForwardIt first, ForwardIt last,
+             std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : lows_(mr) {
+    n_ = static_cast<std::size_t>(std::distance(first, last));
+    if (n_ == 0) return;
+    back_ = static_cast<std::uint64_t>(*std::next(first, static_cast<std::ptrdiff_t>(n_ - 1)));
+    std::uint64_t const universe = back_ + (back_ != ~std::uint64_t{0});
+    low_bits_ = universe / n_ ? static_cast<unsigned>(detail::bit_width(universe / n_) - 1) : 0;
+    std::uint64_t const low_mask = (std::uint64_t{1} << low_bits_) - 1;
+
+    std::size_t const high_size = n_ + static_cast<std::size_t>(back_ >> low_bits_) + 1;
+    std::pmr::vector<std::uint64_t> high((high_size + 63) / 64, 0, mr);
+    auto& lows = lows_.own();
+    lows.assign((n_ * low_bits_ + 63) / 64, 0);
+    std::uint64_t prev = 0;
+    std::size_t i = 0;
+    for (; first != last; ++first, ++i) {
+      std::uint64_t const v = static_cast<std::uint64_t>(*first);
+      if (v < prev) throw std::invalid_argument("elias_fano: sequence is not sorted");
+      prev = v;
+      std::size_t const h = static_cast<std::size_t>(v >> low_bits_) + i;
+      high[h / 64] |= std::uint64_t{1} << (h % 64);
+      if (low_bits_) {
+        std::size_t const bit = i * low_bits_;
+        lows[bit / 64] |= (v & low_mask) << (bit % 64);
+        if (bit % 64 + low_bits_ > 64) lows[bit / 64 + 1] |= (v & low_mask) >> (64 - bit % 64);
+      }
+    }
+    high_ = rank_select_bitvector(high, high_size, mr);
+  }
+
+  std::size_t size() const noexcept { return n_; }
+  bool empty() const noexcept { return n_ == 0; }
+  // The largest value; 0 if empty.
+  std::uint64_t back() const noexcept { return back_; }
+  std::size_t memory_bytes() const noexcept {
+    return lows_.size() * 8 + high_.memory_bytes();
+  }
+
+  // The i-th value, i < size().
+  std::uint64_t operator[](std::size_t i) const noexcept {
+    return (static_cast<std::uint64_t>(high_.select1(i) - i) << low_bits_) | low(i);
+  }
+
+  // Index of the first value >= key, or size() if there is none.
+  std::size_t lower_bound(std::uint64_t key) const noexcept {
+    if (n_ == 0 || key > back_) return n_;
+    std::uint64_t const h = key >> low_bits_;
+    // Values with high part >= h start after the h-th zero.
+    std::size_t pos = h ? high_.select0(static_cast<std::size_t>(h - 1)) + 1 : 0;
+    std::size_t i = pos - static_cast<std::size_t>(h);
+    // The run of ones at pos are the values whose high part is h.
+    std::uint64_t const* words = high_.words().data();
+    std::uint64_t const key_low = key & ((std::uint64_t{1} << low_bits_) - 1);
+    while ((words[pos / 64] >> (pos % 64) & 1) && low(i) < key_low) ++pos, ++i;
+    return i;
+  }
+
+  // Writes values [first, first + count) to out; first + count <= size().
+  void decode(std::size_t first, std::size_t count, std::uint64_t* out) const noexcept {
+    if (count == 0) return;
+    std::uint64_t const* words = high_.words().data();
+    std::size_t pos = high_.select1(first);
+    std::size_t w = pos / 64;
+    std::uint64_t bits = words[w] & (~std::uint64_t{0} << (pos % 64));
+    for (std::size_t i = first; i < first + count; ++i) {
+      while (bits == 0) bits = words[++w];
+      std::size_t const p = w * 64 + static_cast<std::size_t>(detail::countr_zero(bits));
+      bits &= bits - 1;
+      out[i - first] = (static_cast<std::uint64_t>(p - i) << low_bits_) | low(i);
+    }
+  }
+
+ private:
+  std::uint64_t low(std::size_t i) const noexcept {
+    if (low_bits_ == 0) return 0;
+    std::size_t const bit = i * low_bits_;
+    std::uint64_t v = lows_[bit / 64] >> (bit % 64);
+    if (bit % 64 + low_bits_ > 64) v |= lows_[bit / 64 + 1] << (64 - bit % 64);
+    return v & ((std::uint64_t{1} << low_bits_) - 1);
+  }
+
+  friend struct detail::persist::access;
+
+  std::size_t n_ = 0;
+  std::uint64_t back_ = 0;
+  unsigned low_bits_ = 0;
+  detail::borrowable_array<std::uint64_t> lows_;
+  rank_select_bitvector high_;
+};
+
+}  // namespace algoritmi
@@ -0,0 +1,170 @@
+// Rank and select over a bitvector in "poppy" layout (Zhou, Andersen &
+// Kaminsky, "Space-efficient, high-performance rank & select structures on
+// uncompressed bit sequences", 2013), one version per instruction set.
+//
+// Bits are grouped into 2048-bit superblocks of four 512-bit blocks. One
+// 64-bit entry per superblock holds the number of ones before it (relative
+// to a 64-bit count every 2^32 bits) and the counts of its first three
+// blocks, so a rank reads that entry and at most eight words of one block:
+// two cache lines. Select finds the superblock from a sample taken every
+// 8192 ones (or zeros), then the block from the entry and the word by
+// popcounts. The scalar kernels locate a bit within a word with broadword
+// arithmetic, the AVX2 ones with BMI2 pdep.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../config.hpp"
+#include "../cpu.hpp"
+#include "../detail/bits.hpp"
+
+#if ALGORITMI_HAS_SIMD
+#include <immintrin.h>
+#endif
+
+namespace algoritmi::detail::succinct {
+
+inline constexpr std::uint64_t block_bits = 512;
+inline constexpr std::uint64_t block_words = block_bits / 64;
+inline constexpr std::uint64_t superblock_bits = 2048;
+inline constexpr std::uint64_t superblock_words = superblock_bits / 64;
+// Superblocks per 2^32-bit chunk, the span of one absolute count.
+inline constexpr unsigned chunk_shift = 21;
+inline constexpr std::uint64_t select_sample = 8192;
+
+// Read-only description of a built bitvector handed to the kernels.
+struct view {
+  std::uint64_t const* words;    // whole superblocks, zero past the end
+  std::uint64_t const* chunks;   // ones before each 2^32-bit chunk
+  std::uint64_t const* entries;  // per superblock: relative rank << 32 | 3 x 10-bit counts
+  std::uint32_t const* samples1;  // superblock holding one number j * select_sample
+  std::uint32_t const* samples0;  // same for zeros
+};
+
+template <bool Ones>
+ALGORITMI_ALWAYS_INLINE std::uint64_t count_before(view const& v, std::uint64_t sb) noexcept {
+  std::uint64_t const ones = v.chunks[sb >> chunk_shift] + (v.entries[sb] >> 32);
+  return Ones ? ones : sb * superblock_bits - ones;
+}
+
+// Last superblock with fewer than k + 1 ones (zeros) before it.
+template <bool Ones>
+ALGORITMI_ALWAYS_INLINE std::uint64_t find_superblock(view const& v, std::uint64_t k) noexcept {
+  std::uint32_t const* samples = Ones ? v.samples1 : v.samples0;
+  std::uint64_t lo = samples[k / select_sample];
+  std::uint64_t hi = samples[k / select_sample + 1];
+  while (hi - lo > 8) {
+    std::uint64_t const mid = lo + (hi - lo + 1) / 2;
+    if (count_before<Ones>(v, mid) <= k)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  while (lo < hi && count_before<Ones>(v, lo + 1) <= k) ++lo;
+  return lo;
+}
+
+// Position of the set bit with k set bits below it; k < popcount(x).
+inline int select_in_word(std::uint64_t x, std::uint64_t k) noexcept {
+  constexpr std::uint64_t ones8 = 0x0101010101010101;
+  constexpr std::uint64_t high8 = 0x8080808080808080;
+  std::uint64_t s = x - (x >> 1 & 0x5555555555555555);
+  s = (s & 0x3333333333333333) + (s >> 2 & 0x3333333333333333);
+  s = (s + (s >> 4)) & 0x0f0f0f0f0f0f0f0f;
+  s *= ones8;  // byte b: set bits in bytes 0..b
+  // Bytes whose running count exceeds k keep their high bit.
+  std::uint64_t const over = ((s | high8) - (k + 1) * ones8) & high8;
+  int const shift = countr_zero(over) & ~7;
+  k -= (s << 8) >> shift & 0xff;
+  x >>= shift;
+  for (; k; --k) x &= x - 1;
+  return shift + countr_zero(x);
+}
+
+#if ALGORITMI_HAS_SIMD
+ALGORITMI_TARGET_AVX2 inline int select_in_word_bmi2(std::uint64_t x, std::uint64_t k) noexcept {
+  return countr_zero(_pdep_u64(std::uint64_t{1} << k, x));
+}
+#endif
+
+// popcount() inlined into a target function compiles to the popcnt
+// instruction; the scalar kernels get the generic bit-counting sequence.
+#define ALGORITMI_SUCCINCT_KERNELS(TARGET, SUFFIX, SELECT)                                \
+  TARGET inline std::uint64_t rank1_##SUFFIX(view const& v, std::uint64_t i) noexcept {   \
+    std::uint64_t const sb = i / superblock_bits;                                         \
+    std::uint64_t const e = v.entries[sb];                                                \
+    std::uint64_t const block = i / block_bits % 4;                                       \
+    std::uint64_t r = v.chunks[sb >> chunk_shift] + (e >> 32);                            \
+    r += (e & 1023) * (block > 0) + (e >> 10 & 1023) * (block > 1) +                      \
+         (e >> 20 & 1023) * (block > 2);                                                  \
+    std::uint64_t const* w = v.words + i / block_bits * block_words;                      \
+    /* All eight words of the block, masked: no branch on the position. */                \
+    std::uint64_t const full = i % block_bits / 64, bit = i % 64;                         \
+    for (std::uint64_t j = 0; j < block_words; ++j) {                                     \
+      std::uint64_t const at = j == full;                                                 \
+      std::uint64_t const mask = (std::uint64_t{0} - (j < full)) | ((at << bit) - at);    \
+      r += static_cast<std::uint64_t>(popcount(w[j] & mask));                             \
+    }                                                                                     \
+    return r;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  template <bool Ones>                                                                    \
+  TARGET std::uint64_t select_##SUFFIX(view const& v, std::uint64_t k) noexcept {         \
+    std::uint64_t const sb = find_superblock<Ones>(v, k);                                 \
+    std::uint64_t const e = v.entries[sb];                                                \
+    k -= count_before<Ones>(v, sb);                                                       \
+    std::uint64_t const* w = v.words + sb * superblock_words;                             \
+    for (unsigned b = 0; b < 3; ++b) {                                                    \
+      std::uint64_t const ones = e >> (10 * b) & 1023;                                    \
+      std::uint64_t const c = Ones ? ones : block_bits - ones;                            \
+      if (k < c) break;                                                                   \
+      k -= c;                                                                             \
+      w += block_words;                                                                   \
+    }                                                                                     \
+    for (;; ++w) {                                                                        \
+      std::uint64_t const x = Ones ? *w : ~*w;                                            \
+      std::uint64_t const c = static_cast<std::uint64_t>(popcount(x));                    \
+      if (k < c)                                                                          \
+        return static_cast<std::uint64_t>(w - v.words) * 64 +                             \
+               static_cast<std::uint64_t>(SELECT(x, k));                                  \
+      k -= c;                                                                             \
+    }                                                                                     \
+  }
+
+ALGORITMI_SUCCINCT_KERNELS(, scalar, select_in_word)
+#if ALGORITMI_HAS_SIMD
+ALGORITMI_SUCCINCT_KERNELS(ALGORITMI_TARGET_SSE42, sse42, select_in_word)
+ALGORITMI_SUCCINCT_KERNELS(ALGORITMI_TARGET_AVX2, avx2, select_in_word_bmi2)
+#endif
+
+#undef ALGORITMI_SUCCINCT_KERNELS
+
+struct kernel_table {
+  std::uint64_t (*rank1)(view const&, std::uint64_t) noexcept;
+  std::uint64_t (*select1)(view const&, std::uint64_t) noexcept;
+  std::uint64_t (*select0)(view const&, std::uint64_t) noexcept;
+};
+
+inline kernel_table make_kernel_table(isa which) noexcept {
+#if ALGORITMI_HAS_SIMD
+  switch (usable_isa(which)) {
+    case isa::avx2:
+      return {&rank1_avx2, &select_avx2<true>, &select_avx2<false>};
+    case isa::sse42:
+      return {&rank1_sse42, &select_sse42<true>, &select_sse42<false>};
+    default:
+      break;
+  }
+#else
+  (void)which;
+#endif
+  return {&rank1_scalar, &select_scalar<true>, &select_scalar<false>};
+}
+
+inline kernel_table const& kernels() noexcept {
+  static kernel_table const table = make_kernel_table(active_isa());
+  return table;
+}
+
+}  // namespace algoritmi::detail::succinct
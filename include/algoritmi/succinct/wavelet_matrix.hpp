@@ -0,0 +1,166 @@
+// Wavelet matrix (Claude, Navarro & Ordonez, "The wavelet matrix", 2015):
+// a sequence of n integers below 2^b in n * b bits plus the rank/select
+// index, answering access, rank, select and order-statistic queries over
+// any range in O(b) bitvector operations.
+//
+// Level l holds bit b - 1 - l of every value, in the order the values have
+// after being stably partitioned by their higher bits, zeros first at each
+// level. This is a wavelet tree with the nodes of each level concatenated
+// and no pointers: a query follows one value (or one range) down the
+// levels with a rank per level, and moves up with a select.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+#include "../detail/bits.hpp"
+#include "../detail/borrowable.hpp"
+#include "bitvector.hpp"
+
+namespace algoritmi {
+namespace detail::persist {
+struct access;
+}
+
+class wavelet_matrix {
+ public:
+  wavelet_matrix() = default;
+
+  // The values of [first, last), converted to std::uint64_t.
+  template <class InputIt>
+  wavelet_matrix(InputIt first, InputIt last,
+                 std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+      : levels_(mr), zeros_(mr) {
+    std::pmr::vector<std::uint64_t> cur(mr);
+    for (; first != last; ++first) cur.push_back(static_cast<std::uint64_t>(*first));
+    n_ = cur.size();
+    std::uint64_t top = 0;
+    for (std::uint64_t v : cur) top |= v;
+    unsigned const bits = std::max(1, detail::bit_width(top));
+
+    std::pmr::vector<std::uint64_t> next(n_, mr);
+    std::pmr::vector<std::uint64_t> words((n_ + 63) / 64, mr);
+    auto& zeros = zeros_.own();
+    levels_.reserve(bits);
+    for (unsigned l = 0; l < bits; ++l) {
+      unsigned const shift = bits - 1 - l;
+      std::fill(words.begin(), words.end(), 0);
+      std::size_t z = 0;
+      for (std::size_t i = 0; i < n_; ++i)
+        if (cur[i] >> shift & 1)
+          words[i / 64] |= std::uint64_t{1} << (i % 64);
+        else
+          next[z++] = cur[i];
+      zeros.push_back(z);
+      for (std::size_t i = 0; i < n_; ++i)
+        if (cur[i] >> shift & 1) next[z++] = cur[i];
+      levels_.emplace_back(words, n_, mr);
+      cur.swap(next);
+    }
+  }
+
+  std::size_t size() const noexcept { return n_; }
+  bool empty() const noexcept { return n_ == 0; }
+  // Bits per value: values are below 2^bits().
+  unsigned bits() const noexcept { return static_cast<unsigned>(levels_.size()); }
+  std::size_t memory_bytes() const noexcept {
+    std::size_t bytes = zeros_.size() * 8;
+    for (auto const& level : levels_) bytes += level.memory_bytes();
+    return bytes;
+  }
+
+  // The i-th value, i < size().
+  std::uint64_t operator[](std::size_t i) const noexcept {
+    std::uint64_t v = 0;
+    for (std::size_t l = 0; l < levels_.size(); ++l) {
+      bool const bit = levels_[l][i];
+      i = bit ? zeros_[l] + levels_[l].rank1(i) : levels_[l].rank0(i);
+      v = v << 1 | bit;
+    }
+    return v;
+  }
+
+  // Occurrences of `value` in [0, i), for i <= size().
+  std::size_t rank(std::uint64_t value, std::size_t i) const noexcept {
+    if (!representable(value)) return 0;
+    std::size_t s = 0;
+    for (std::size_t l = 0; l < levels_.size(); ++l) descend(l, bit(value, l), s, i);
+    return i - s;
+  }
+
+  // Position of the occurrence of `value` with k occurrences before it, or
+  // size() if there are not that many.
+  std::size_t select(std::uint64_t value, std::size_t k) const noexcept {
+    if (!representable(value)) return n_;
+    std::size_t s = 0, e = n_;
+    for (std::size_t l = 0; l < levels_.size(); ++l) descend(l, bit(value, l), s, e);
+    if (e - s <= k) return n_;
+    std::size_t p = s + k;
+    for (std::size_t l = levels_.size(); l-- > 0;)
+      p = bit(value, l) ? levels_[l].select1(p - zeros_[l]) : levels_[l].select0(p);
+    return p;
+  }
+
+  // The value of rank k (0-based) among [first, last), for k < last - first.
+  std::uint64_t quantile(std::size_t first, std::size_t last, std::size_t k) const noexcept {
+    std::uint64_t v = 0;
+    for (std::size_t l = 0; l < levels_.size(); ++l) {
+      std::size_t const s1 = levels_[l].rank1(first), e1 = levels_[l].rank1(last);
+      std::size_t const z = (last - first) - (e1 - s1);
+      bool const bit = k >= z;
+      if (bit) k -= z;
+      descend(l, bit, first, last, s1, e1);
+      v = v << 1 | bit;
+    }
+    return v;
+  }
+
+  // Number of values below `value` in [first, last).
+  std::size_t count_less(std::size_t first, std::size_t last, std::uint64_t value) const noexcept {
+    if (!representable(value)) return last - first;
+    std::size_t c = 0;
+    for (std::size_t l = 0; l < levels_.size(); ++l) {
+      std::size_t const s1 = levels_[l].rank1(first), e1 = levels_[l].rank1(last);
+      bool const b = bit(value, l);
+      if (b) c += (last - first) - (e1 - s1);
+      descend(l, b, first, last, s1, e1);
+    }
+    return c;
+  }
+
+ private:
+  bool representable(std::uint64_t value) const noexcept {
+    return levels_.size() >= 64 || value >> levels_.size() == 0;
+  }
+  bool bit(std::uint64_t value, std::size_t l) const noexcept {
+    return value >> (levels_.size() - 1 - l) & 1;
+  }
+
+  // Maps the range [s, e) of level l to the range its `bit` elements
+  // occupy on level l + 1; s1 and e1 are the ones before s and e.
+  void descend(std::size_t l, bool bit, std::size_t& s, std::size_t& e, std::size_t s1,
+               std::size_t e1) const noexcept {
+    if (bit) {
+      s = zeros_[l] + s1;
+      e = zeros_[l] + e1;
+    } else {
+      s -= s1;
+      e -= e1;
+    }
+  }
+  void descend(std::size_t l, bool bit, std::size_t& s, std::size_t& e) const noexcept {
+    descend(l, bit, s, e, levels_[l].rank1(s), levels_[l].rank1(e));
+  }
+
+  friend struct detail::persist::access;
+
+  std::size_t n_ = 0;
+  std::pmr::vector<rank_select_bitvector> levels_;
+  detail::borrowable_array<std::size_t> zeros_;  // per level
+};
+
+}  // namespace algoritmi
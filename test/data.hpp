@@ -0,0 +1,228 @@
+// Input generators for the test runner: random data and the shapes that
+// break algorithms tuned for it.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <algoritmi/sort/pdqsort.hpp>
+
+namespace algoritmi::test {
+
+// splitmix64, as in the benchmarks.
+class Rng {
+ public:
+  explicit Rng(std::uint64_t seed = 0x9e3779b97f4a7c15ULL) : state_(seed) {}
+
+  std::uint64_t next() noexcept {
+    std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, bound); bound > 0.
+  std::uint64_t below(std::uint64_t bound) noexcept {
+    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+  }
+
+  // Uniform in [lo, hi].
+  std::uint64_t between(std::uint64_t lo, std::uint64_t hi) noexcept {
+    return lo + (hi - lo == std::numeric_limits<std::uint64_t>::max() ? next()
+                                                                      : below(hi - lo + 1));
+  }
+
+  double uniform() noexcept { return (next() >> 11) * 0x1.0p-53; }
+
+  bool coin() noexcept { return next() >> 63; }
+
+ private:
+  std::uint64_t state_;
+};
+
+// A size for one random round: mostly small, where edge cases live, with
+// an occasional large one. Sizes just around SIMD widths and block
+// boundaries come up often because the small range is dense.
+inline std::size_t random_size(Rng& rng, std::size_t max) {
+  std::uint64_t const r = rng.below(8);
+  std::size_t const cap = r < 4 ? 70 : r < 7 ? 1100 : max;
+  return static_cast<std::size_t>(rng.below(std::min(cap, max) + 1));
+}
+
+enum class shape {
+  random,
+  sorted,
+  reversed,
+  organ_pipe,  // ascending then descending
+  sawtooth,    // ascending runs of random length
+  few_unique,  // many duplicates: eight distinct values
+  all_equal,
+  nearly_sorted,  // sorted with a few random swaps
+  killer,         // McIlroy's quicksort adversary, see killer_ranks()
+};
+
+inline constexpr shape all_shapes[] = {
+    shape::random,     shape::sorted,    shape::reversed,      shape::organ_pipe, shape::sawtooth,
+    shape::few_unique, shape::all_equal, shape::nearly_sorted, shape::killer};
+
+inline char const* to_string(shape s) noexcept {
+  switch (s) {
+    case shape::random: return "random";
+    case shape::sorted: return "sorted";
+    case shape::reversed: return "reversed";
+    case shape::organ_pipe: return "organ_pipe";
+    case shape::sawtooth: return "sawtooth";
+    case shape::few_unique: return "few_unique";
+    case shape::all_equal: return "all_equal";
+    case shape::nearly_sorted: return "nearly_sorted";
+    case shape::killer: return "killer";
+  }
+  return "?";
+}
+
+// Ranks forming McIlroy's adversary for `sort` ("A Killer Adversary for
+// Quicksort", Software: Practice and Experience, 1999). Every element
+// starts as "gas", larger than any frozen value; a comparison between two
+// gas elements freezes one of them to the next smallest value, choosing
+// the one that looks like the pivot. Sorting the resulting values again
+// replays the same comparisons, which drive a quicksort that picks pivots
+// from a few samples into quadratic time.
+template <class Sort>
+std::vector<std::size_t> killer_ranks(std::size_t n, Sort sort) {
+  std::size_t const gas = n;
+  std::vector<std::size_t> val(n, gas), index(n);
+  std::iota(index.begin(), index.end(), std::size_t{0});
+  std::size_t solid = 0, candidate = 0;
+  sort(index.begin(), index.end(), [&](std::size_t x, std::size_t y) {
+    if (val[x] == gas && val[y] == gas) val[x == candidate ? x : y] = solid++;
+    if (val[x] == gas)
+      candidate = x;
+    else if (val[y] == gas)
+      candidate = y;
+    return val[x] < val[y];
+  });
+  for (auto& v : val)
+    if (v == gas) v = solid++;
+  return val;
+}
+
+// The r-th smallest of a family of distinct-enough values of T.
+template <class T>
+T value_of_rank(std::uint64_t r) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    std::string s(8, 'a');
+    for (int i = 7; i >= 0; --i, r /= 26) s[static_cast<std::size_t>(i)] = char('a' + r % 26);
+    return s;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return static_cast<T>(r) * static_cast<T>(0.5) - static_cast<T>(1000);
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<T>(static_cast<std::int64_t>(r) + std::numeric_limits<T>::min() / 2);
+  } else {
+    return static_cast<T>(r);
+  }
+}
+
+// Any value of T: full-range bit patterns for integers, finite values of
+// mixed magnitude and sign (zeros of both signs included) for floating
+// point, short lowercase strings.
+template <class T>
+T random_value(Rng& rng) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    std::string s(rng.below(6), 'a');
+    for (auto& c : s) c = static_cast<char>('a' + rng.below(4));
+    return s;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    switch (rng.below(8)) {
+      case 0: return T(0);
+      case 1: return -T(0);
+      case 2: return std::numeric_limits<T>::max() * static_cast<T>(rng.uniform() - 0.5);
+      case 3: return std::numeric_limits<T>::denorm_min() * static_cast<T>(rng.below(100));
+      default: return static_cast<T>((rng.uniform() - 0.5) * 2e6);
+    }
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return rng.coin();
+  } else {
+    std::uint64_t const bits = rng.next();
+    T x;
+    std::memcpy(&x, &bits, sizeof(T));
+    return x;
+  }
+}
+
+template <class T>
+char const* type_name() noexcept {
+  constexpr std::size_t log = sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3;
+  constexpr char const* signed_names[] = {"i8", "i16", "i32", "i64"};
+  constexpr char const* unsigned_names[] = {"u8", "u16", "u32", "u64"};
+  if constexpr (std::is_same_v<T, std::string>) {
+    return "string";
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return sizeof(T) == 4 ? "f32" : "f64";
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return "bool";
+  } else if constexpr (std::is_signed_v<T>) {
+    return signed_names[log];
+  } else {
+    return unsigned_names[log];
+  }
+}
+
+// "<what> <type> <shape> n=<n>", the usual case label.
+template <class T>
+std::string describe(char const* what, shape s, std::size_t n) {
+  return std::string(what) + ' ' + type_name<T>() + ' ' + to_string(s) +
+         " n=" + std::to_string(n);
+}
+
+template <class T>
+std::vector<T> make_input(shape s, std::size_t n, Rng& rng) {
+  std::vector<T> v;
+  v.reserve(n);
+  switch (s) {
+    case shape::random:
+      for (std::size_t i = 0; i < n; ++i) v.push_back(random_value<T>(rng));
+      break;
+    case shape::sorted:
+    case shape::reversed:
+    case shape::nearly_sorted:
+      for (std::size_t i = 0; i < n; ++i) v.push_back(value_of_rank<T>(i));
+      if (s == shape::reversed) std::reverse(v.begin(), v.end());
+      if (s == shape::nearly_sorted && n > 1)
+        for (std::size_t k = 0; k < 1 + n / 64; ++k)
+          std::swap(v[rng.below(n)], v[rng.below(n)]);
+      break;
+    case shape::organ_pipe:
+      for (std::size_t i = 0; i < n; ++i) v.push_back(value_of_rank<T>(std::min(i, n - 1 - i)));
+      break;
+    case shape::sawtooth: {
+      std::size_t const run = 1 + rng.below(64);
+      for (std::size_t i = 0; i < n; ++i) v.push_back(value_of_rank<T>(i % run));
+      break;
+    }
+    case shape::few_unique: {
+      T values[8];
+      for (auto& x : values) x = random_value<T>(rng);
+      for (std::size_t i = 0; i < n; ++i) v.push_back(values[rng.below(8)]);
+      break;
+    }
+    case shape::all_equal:
+      v.assign(n, random_value<T>(rng));
+      break;
+    case shape::killer:
+      for (std::size_t r : killer_ranks(n, [](auto first, auto last, auto comp) {
+             pdqsort(first, last, comp);
+           }))
+        v.push_back(value_of_rank<T>(r));
+      break;
+  }
+  return v;
+}
+
+}  // namespace algoritmi::test
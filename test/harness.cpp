@@ -0,0 +1,121 @@
+#include "harness.hpp"
+
+#include <algoritmi/scheduler.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace algoritmi::test {
+
+std::vector<Test>& registry() {
+  static std::vector<Test> tests;
+  return tests;
+}
+
+std::vector<isa> const& host_isas() {
+  static std::vector<isa> const list = [] {
+    std::vector<isa> v;
+    for (isa i : {isa::scalar, isa::sse42, isa::avx2})
+      if (usable_isa(i) == i) v.push_back(i);
+    return v;
+  }();
+  return list;
+}
+
+namespace {
+
+struct Row {
+  std::string name;
+  std::size_t cases;
+  std::size_t checks;
+  std::size_t failures;
+  std::vector<std::string> messages;
+};
+
+bool selected(std::string const& name, std::vector<std::string> const& filters) {
+  if (filters.empty()) return true;
+  return std::any_of(filters.begin(), filters.end(), [&](std::string const& f) {
+    return name.find(f) != std::string::npos;
+  });
+}
+
+// FNV-1a of the test name mixed into the seed, so a test's inputs do not
+// depend on which other tests run.
+std::uint64_t seed_for(std::uint64_t seed, std::string const& name) {
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : name) h = (h ^ c) * 0x100000001b3ULL;
+  return seed ^ h;
+}
+
+std::string format_row(Row const& r) {
+  return r.name + '\t' + std::to_string(r.cases) + '\t' + std::to_string(r.checks) + '\t' +
+         std::to_string(r.failures) + '\t' + (r.failures ? "FAIL" : "ok");
+}
+
+}  // namespace
+
+int run_all(Options const& opt) {
+  auto tests = registry();
+  std::sort(tests.begin(), tests.end(),
+            [](Test const& a, Test const& b) { return a.name < b.name; });
+
+  if (opt.list_only) {
+    for (auto const& t : tests) std::cout << t.name << '\n';
+    return 0;
+  }
+
+  // Parallel overloads run on a pool of opt.threads workers whatever the
+  // machine, so their fork-join paths are taken on small hosts too.
+  task_scheduler pool(scheduler_options{opt.threads});
+  set_default_executor(&pool);
+
+  std::vector<Row> rows;
+  std::size_t failed = 0;
+  for (auto const& t : tests) {
+    if (!selected(t.name, opt.filters)) continue;
+    Context ctx(seed_for(opt.seed, t.name), opt.scale);
+    auto const t0 = std::chrono::steady_clock::now();
+    try {
+      t.fn(ctx);
+    } catch (std::exception const& e) {
+      ctx.fail(std::string("uncaught exception: ") + e.what());
+    } catch (...) {
+      ctx.fail("uncaught exception");
+    }
+    double const ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    Row r{t.name, ctx.cases(), ctx.checks(), ctx.failures(), ctx.messages()};
+    std::cerr << format_row(r) << '\t' << static_cast<long>(ms) << " ms\n";
+    for (auto const& m : r.messages) std::cerr << "  " << m << '\n';
+    failed += r.failures ? 1 : 0;
+    rows.push_back(std::move(r));
+  }
+  set_default_executor(nullptr);
+
+  std::ofstream out(opt.out);
+  if (!out) {
+    std::cerr << "algoritmi_test: cannot open " << opt.out << " for writing\n";
+    return 1;
+  }
+  // Like the bench report, fixed header and rows sorted by name; with the
+  // same seed and scale two reports of passing runs are identical.
+  out << "# algoritmi test v1\n";
+  out << "# seed=" << opt.seed << " scale=" << opt.scale << " threads=" << opt.threads
+      << " isa=" << to_string(active_isa()) << " isas=";
+  for (isa i : host_isas()) out << to_string(i) << (i == host_isas().back() ? "" : ",");
+  out << '\n';
+  out << "test\tcases\tchecks\tfailures\tresult\n";
+  for (auto const& r : rows) out << format_row(r) << '\n';
+  for (auto const& r : rows)
+    for (auto const& m : r.messages) out << "# FAIL " << r.name << ": " << m << '\n';
+  out << "# " << rows.size() - failed << " of " << rows.size() << " tests passed\n";
+  std::cerr << rows.size() - failed << " of " << rows.size() << " tests passed\n";
+  if (!out) return 1;
+  return failed ? 1 : 0;
+}
+
+}  // namespace algoritmi::test
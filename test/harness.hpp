@@ -0,0 +1,132 @@
+// Randomized differential test runner for Algoritmi.
+//
+// Tests register themselves with ALGORITMI_TEST and compare an algorithm's
+// output with a slow reference (std:: algorithms, brute force, textbook
+// dynamic programs) on generated inputs. Each test gets its own random
+// generator seeded from --seed and its name, so a failure reproduces with
+// the same seed whatever else runs. Failed checks are recorded with the
+// input they ran on (set_case) and the run continues; the report lists them
+// at the end.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <algoritmi/cpu.hpp>
+
+#include "data.hpp"
+
+namespace algoritmi::test {
+
+class Context {
+ public:
+  Context(std::uint64_t seed, double scale) : rng_(seed), seed_(seed), scale_(scale) {}
+
+  Rng& rng() noexcept { return rng_; }
+  std::uint64_t seed() const noexcept { return seed_; }
+
+  // Number of random rounds for a test whose default is `base`, scaled by
+  // --scale (at least one).
+  std::size_t rounds(std::size_t base) const noexcept {
+    double const r = static_cast<double>(base) * scale_;
+    return r < 1.0 ? 1 : static_cast<std::size_t>(r);
+  }
+
+  // Describes the input the following checks run on; shown with failures.
+  void set_case(std::string label) {
+    label_ = std::move(label);
+    ++cases_;
+  }
+
+  bool check(bool ok, char const* expr, char const* file, int line) {
+    ++checks_;
+    if (!ok) fail(std::string(file) + ":" + std::to_string(line) + ": " + expr);
+    return ok;
+  }
+
+  void fail(std::string what) {
+    ++failures_;
+    if (messages_.size() < max_messages) {
+      if (!label_.empty()) what += " [" + label_ + "]";
+      messages_.push_back(std::move(what));
+    }
+  }
+
+  std::size_t cases() const noexcept { return cases_; }
+  std::size_t checks() const noexcept { return checks_; }
+  std::size_t failures() const noexcept { return failures_; }
+  std::vector<std::string> const& messages() const noexcept { return messages_; }
+
+ private:
+  static constexpr std::size_t max_messages = 8;
+
+  Rng rng_;
+  std::uint64_t seed_;
+  double scale_;
+  std::string label_;
+  std::size_t cases_ = 0;
+  std::size_t checks_ = 0;
+  std::size_t failures_ = 0;
+  std::vector<std::string> messages_;
+};
+
+// The instruction sets this host can run, scalar first. Tests of the
+// overloads taking an `isa` loop over these.
+std::vector<isa> const& host_isas();
+
+using TestFn = void (*)(Context&);
+
+struct Test {
+  std::string name;
+  TestFn fn;
+};
+
+std::vector<Test>& registry();
+
+struct Registration {
+  Registration(char const* name, TestFn fn) { registry().push_back(Test{name, fn}); }
+};
+
+struct Options {
+  std::uint64_t seed = 1;
+  double scale = 1.0;
+  unsigned threads = 4;  // workers of the scheduler parallel overloads run on
+  std::vector<std::string> filters;  // substring match; empty runs everything
+  std::string out = "test_output.txt";
+  bool list_only = false;
+};
+
+// Runs every registered test selected by `opt` and writes the report.
+// Returns a process exit code: 0 if every check passed.
+int run_all(Options const& opt);
+
+}  // namespace algoritmi::test
+
+#define ALGORITMI_TEST_CONCAT_(a, b) a##b
+#define ALGORITMI_TEST_CONCAT(a, b) ALGORITMI_TEST_CONCAT_(a, b)
+
+// ALGORITMI_TEST("module/algorithm", fn)
+#define ALGORITMI_TEST(name, fn)                                            \
+  static ::algoritmi::test::Registration ALGORITMI_TEST_CONCAT(             \
+      algoritmi_test_reg_, __LINE__)(name, fn)
+
+// Records a failure of `cond` in context `t` and carries on; evaluates to
+// whether it held.
+#define ALGORITMI_CHECK(t, ...)                                             \
+  (t).check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+// Checks that `expr` throws an exception of type `Ex`.
+#define ALGORITMI_CHECK_THROWS(t, Ex, ...)                                  \
+  do {                                                                      \
+    bool algoritmi_thrown_ = false;                                         \
+    try {                                                                   \
+      (void)(__VA_ARGS__);                                                  \
+    } catch (Ex const&) {                                                   \
+      algoritmi_thrown_ = true;                                             \
+    }                                                                       \
+    (t).check(algoritmi_thrown_, "throws " #Ex ": " #__VA_ARGS__, __FILE__, \
+              __LINE__);                                                    \
+  } while (0)
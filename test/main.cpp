@@ -0,0 +1,73 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "harness.hpp"
+
+namespace {
+
+void usage() {
+  std::cerr <<
+      "usage: algoritmi_test [options] [filter...]\n"
+      "  --seed=N        random seed (default 1)\n"
+      "  --scale=X       multiply the number of random rounds by X (default 1)\n"
+      "  --threads=N     workers for the parallel overloads (default 4)\n"
+      "  --out=PATH      report file (default test_output.txt)\n"
+      "  --list          print test names and exit\n"
+      "Filters are substrings; a test runs if it matches any of them.\n"
+      "ALGORITMI_ISA=scalar|sse42 caps the kernels the default overloads pick.\n";
+}
+
+bool parse_unsigned(char const* text, unsigned long long& out) {
+  char* end = nullptr;
+  out = std::strtoull(text, &end, 0);
+  return end != text && *end == '\0';
+}
+
+char const* value_of(char const* arg, char const* flag) {
+  std::size_t const len = std::strlen(flag);
+  if (std::strncmp(arg, flag, len) == 0 && arg[len] == '=') return arg + len + 1;
+  return nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  algoritmi::test::Options opt;
+  for (int i = 1; i < argc; ++i) {
+    char const* a = argv[i];
+    char const* v = nullptr;
+    bool ok = true;
+    unsigned long long u = 0;
+    if ((v = value_of(a, "--seed"))) {
+      ok = parse_unsigned(v, u);
+      opt.seed = u;
+    } else if ((v = value_of(a, "--scale"))) {
+      opt.scale = std::strtod(v, nullptr);
+      ok = opt.scale > 0.0;
+    } else if ((v = value_of(a, "--threads"))) {
+      ok = parse_unsigned(v, u) && u >= 1 && u <= 256;
+      opt.threads = static_cast<unsigned>(u);
+    } else if ((v = value_of(a, "--out"))) {
+      opt.out = v;
+    } else if (std::strcmp(a, "--out") == 0 && i + 1 < argc) {
+      opt.out = argv[++i];
+    } else if (std::strcmp(a, "--list") == 0) {
+      opt.list_only = true;
+    } else if (std::strcmp(a, "--help") == 0 || std::strcmp(a, "-h") == 0) {
+      usage();
+      return 0;
+    } else if (a[0] == '-') {
+      ok = false;
+    } else {
+      opt.filters.emplace_back(a);
+    }
+    if (!ok) {
+      std::cerr << "algoritmi_test: bad argument '" << a << "'\n";
+      usage();
+      return 2;
+    }
+  }
+  return algoritmi::test::run_all(opt);
+}
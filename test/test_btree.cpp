@@ -0,0 +1,276 @@
+// btree_map against std::map driven by the same random operation sequence.
+//
+//   btree/btree_map    insertion, erase (by key and iterator), lookups,
+//                      bounds, traversal both ways, copies; default and
+//                      one-line nodes, SIMD and comparator searches;
+//                      inserts whose allocations fail
+//   btree/lower_bound  lower_bound with every instruction set
+//   btree/bulk_load    sorted_unique construction, then updates
+//
+// Keys come from a range about the size of the operation count so that
+// nodes fill, split, borrow and merge all the time.
+#include <algoritmi/btree.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+template <class K>
+K make_key(Rng& rng, std::uint64_t range) {
+  std::uint64_t const r = rng.below(range);
+  if constexpr (std::is_same_v<K, std::string>)
+    return std::to_string(r * 7919 % range);
+  else if constexpr (std::is_floating_point_v<K>)
+    return static_cast<K>(r) * K(0.5) - K(100);
+  else if constexpr (std::is_signed_v<K>)
+    return static_cast<K>(static_cast<std::int64_t>(r) - static_cast<std::int64_t>(range / 2));
+  else
+    return static_cast<K>(r);
+}
+
+template <class Map, class Ref>
+bool same_contents(Map const& map, Ref const& ref) {
+  if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+  auto it = map.begin();
+  for (auto const& [k, v] : ref) {
+    if (it == map.end() || !((*it).first == k) || !((*it).second == v)) return false;
+    ++it;
+  }
+  if (it != map.end()) return false;
+  // And backwards.
+  auto r = ref.rbegin();
+  for (auto back = map.end(); back != map.begin() && r != ref.rend(); ++r)
+    if (!((*--back).first == r->first)) return false;
+  return r == ref.rend();
+}
+
+// new_delete_resource() that throws std::bad_alloc on every `period`-th
+// request and counts the blocks it has out.
+class failing_resource : public std::pmr::memory_resource {
+ public:
+  explicit failing_resource(std::uint64_t period) : period_(period) {}
+  std::size_t outstanding = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    if (++requests_ % period_ == 0) throw std::bad_alloc();
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, align);
+    ++outstanding;
+    return p;
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    --outstanding;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+
+  std::uint64_t period_;
+  std::uint64_t requests_ = 0;
+};
+
+template <class Map>
+void map_case(Context& t, char const* what) {
+  using K = typename Map::key_type;
+  using Ref = std::map<K, std::uint64_t, typename Map::key_compare>;
+  std::size_t const ops = random_size(t.rng(), 30000);
+  std::uint64_t const range = 1 + t.rng().below(ops + 1);
+  Map map;
+  Ref ref;
+  t.set_case(std::string(what) + ' ' + type_name<K>() + " ops=" + std::to_string(ops) +
+             " range=" + std::to_string(range));
+  bool ok = true;
+  for (std::size_t op = 0; ok && op < ops; ++op) {
+    K const key = make_key<K>(t.rng(), range);
+    std::uint64_t const value = t.rng().next();
+    switch (t.rng().below(12)) {
+      case 0:
+      case 1:
+        ok = map.insert({key, value}).second == ref.insert({key, value}).second;
+        break;
+      case 2:
+        ok = map.try_emplace(key, value).second == ref.try_emplace(key, value).second;
+        break;
+      case 3:
+        ok = map.insert_or_assign(key, value).second == ref.insert_or_assign(key, value).second;
+        break;
+      case 4:
+        map[key] += value;
+        ref[key] += value;
+        break;
+      case 5:
+      case 6:
+        ok = map.erase(key) == ref.erase(key);
+        break;
+      case 7: {
+        // Erase a run starting at the lower bound through iterators.
+        auto it = map.lower_bound(key);
+        auto r = ref.lower_bound(key);
+        for (std::uint64_t k = t.rng().below(6); ok && k > 0 && r != ref.end(); --k) {
+          ok = it != map.end() && (*it).first == r->first;
+          it = map.erase(it);
+          r = ref.erase(r);
+        }
+        ok = ok && (r == ref.end() ? it == map.end() : (*it).first == r->first);
+        break;
+      }
+      case 8: {
+        auto const it = map.find(key);
+        auto const r = ref.find(key);
+        ok = (it == map.end()) == (r == ref.end()) && (r == ref.end() || (*it).second == r->second);
+        ok = ok && map.contains(key) == (r != ref.end()) && map.count(key) == ref.count(key);
+        if (r != ref.end())
+          ok = ok && map.at(key) == r->second;
+        else
+          ALGORITMI_CHECK_THROWS(t, std::out_of_range, map.at(key));
+        break;
+      }
+      case 9: {
+        auto const lb = map.lower_bound(key);
+        auto const ub = map.upper_bound(key);
+        auto const rlb = ref.lower_bound(key);
+        auto const rub = ref.upper_bound(key);
+        ok = (rlb == ref.end() ? lb == map.end() : (*lb).first == rlb->first) &&
+             (rub == ref.end() ? ub == map.end() : (*ub).first == rub->first);
+        break;
+      }
+      case 10:
+        if (t.rng().below(128) == 0) {
+          Map copy(map);
+          ok = same_contents(copy, ref);
+          Map moved(std::move(copy));
+          map = moved;
+        } else if (t.rng().below(512) == 0) {
+          map.clear();
+          ref.clear();
+        }
+        break;
+      default:
+        if (t.rng().below(256) == 0) ok = same_contents(map, ref);
+        break;
+    }
+    ok = ok && map.size() == ref.size();
+  }
+  ALGORITMI_CHECK(t, ok && same_contents(map, ref));
+}
+
+void test_btree_map(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    map_case<btree_map<std::int32_t, std::uint64_t>>(t, "btree_map");
+    map_case<btree_map<std::uint64_t, std::uint64_t>>(t, "btree_map");
+    map_case<btree_map<double, std::uint64_t>>(t, "btree_map");
+    map_case<btree_map<std::string, std::uint64_t>>(t, "btree_map");
+    // The smallest nodes: tall trees, and every operation near a boundary.
+    map_case<btree_map<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, 64>>(
+        t, "btree_map 64-byte nodes");
+    map_case<btree_map<std::int32_t, std::uint64_t, std::greater<std::int32_t>, 64>>(
+        t, "btree_map greater");
+  }
+
+  // An insert whose node allocation fails leaves the map as it was.
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::uint64_t const period = 2 + t.rng().below(6);
+    std::size_t const ops = random_size(t.rng(), 20000);
+    t.set_case("btree_map bad_alloc period=" + std::to_string(period) +
+               " ops=" + std::to_string(ops));
+    failing_resource mr(period);
+    {
+      btree_map<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, 64> map(&mr);
+      std::map<std::uint64_t, std::uint64_t> ref;
+      bool ok = true;
+      for (std::size_t op = 0; ok && op < ops; ++op) {
+        std::uint64_t const key = t.rng().below(4 * ops + 1);
+        try {
+          map.insert({key, op});
+          ref.insert({key, op});
+        } catch (std::bad_alloc const&) {
+        }
+        ok = map.size() == ref.size() && (op % 256 != 0 || same_contents(map, ref));
+      }
+      ALGORITMI_CHECK(t, ok && same_contents(map, ref));
+    }
+    ALGORITMI_CHECK(t, mr.outstanding == 0);
+  }
+}
+
+template <class K>
+void lower_bound_types(Context& t) {
+  std::size_t const n = random_size(t.rng(), 100000);
+  auto keys = make_input<K>(shape::random, n, t.rng());
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  std::vector<std::pair<K, std::uint32_t>> pairs;
+  for (K const& k : keys) pairs.push_back({k, static_cast<std::uint32_t>(pairs.size())});
+  btree_map<K, std::uint32_t> const map(sorted_unique, pairs.begin(), pairs.end());
+  t.set_case(describe<K>("btree lower_bound", shape::random, keys.size()));
+  bool ok = map.size() == keys.size();
+  for (std::size_t q = 0; ok && q < 2000; ++q) {
+    K key = random_value<K>(t.rng());
+    if (!keys.empty() && q % 2) key = keys[t.rng().below(keys.size())];
+    auto const at = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+    auto const rank = static_cast<std::size_t>(at);
+    for (isa which : host_isas()) {
+      auto const it = map.lower_bound(which, key);
+      ok = ok && (rank == keys.size() ? it == map.end() : (*it).second == rank);
+    }
+  }
+  ALGORITMI_CHECK(t, ok);
+}
+
+void test_lower_bound(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    lower_bound_types<std::int32_t>(t);
+    lower_bound_types<std::uint32_t>(t);
+    lower_bound_types<std::int64_t>(t);
+    lower_bound_types<std::uint64_t>(t);
+    lower_bound_types<float>(t);
+    lower_bound_types<double>(t);
+  }
+}
+
+void test_bulk_load(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    std::size_t const n = random_size(t.rng(), 50000);
+    std::map<std::uint64_t, std::uint64_t> ref;
+    while (ref.size() < n) ref.emplace(t.rng().below(4 * n + 1), t.rng().next());
+    btree_map<std::uint64_t, std::uint64_t> map(sorted_unique, ref.begin(), ref.end());
+    t.set_case("bulk_load n=" + std::to_string(n));
+    ALGORITMI_CHECK(t, same_contents(map, ref));
+    // Full leaves: the first insertions split them.
+    bool ok = true;
+    for (std::size_t i = 0; ok && i < n / 2 + 8; ++i) {
+      std::uint64_t const key = t.rng().below(4 * n + 1);
+      if (t.rng().coin())
+        ok = map.insert({key, i}).second == ref.insert({key, i}).second;
+      else
+        ok = map.erase(key) == ref.erase(key);
+    }
+    ALGORITMI_CHECK(t, ok && same_contents(map, ref));
+  }
+  std::vector<std::pair<int, int>> const unsorted = {{1, 0}, {3, 0}, {3, 0}};
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument,
+                         (btree_map<int, int>(sorted_unique, unsorted.begin(), unsorted.end())));
+}
+
+ALGORITMI_TEST("btree/btree_map", test_btree_map);
+ALGORITMI_TEST("btree/lower_bound", test_lower_bound);
+ALGORITMI_TEST("btree/bulk_load", test_bulk_load);
+
+}  // namespace
+}  // namespace algoritmi::test
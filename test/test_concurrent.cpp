@@ -0,0 +1,257 @@
+// Queues: sequential behaviour against std::deque, then real threads.
+//
+//   concurrent/spsc_queue       try_push/try_pop and the bulk calls; one
+//                               producer and one consumer thread
+//   concurrent/mpmc_queue       full and empty edges; several producers and
+//                               consumers
+//   concurrent/segmented_queue  across many segments; several producers and
+//                               consumers
+//
+// With threads every item must arrive exactly once, and the items of one
+// producer must reach any one consumer in the order they were pushed.
+// Waiting threads yield, so the tests also finish on a single core.
+#include <algoritmi/concurrent.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+template <class Q>
+bool try_push(Q& q, std::string const& s) {
+  if constexpr (std::is_same_v<Q, segmented_queue<std::string>>) {
+    q.push(s);
+    return true;
+  } else {
+    return q.try_push(s);
+  }
+}
+
+// Random pushes and pops on one thread; a bounded queue must refuse
+// exactly when it holds `capacity` items.
+template <class Q>
+void sequential_case(Context& t, Q& q, std::size_t capacity, char const* what) {
+  std::size_t const ops = random_size(t.rng(), 50000);
+  std::deque<std::string> ref;
+  t.set_case(std::string(what) + " sequential ops=" + std::to_string(ops) +
+             " capacity=" + std::to_string(capacity));
+  bool ok = true;
+  // Long runs of one kind of operation fill and drain the queue.
+  std::uint64_t bias = 50;
+  for (std::size_t op = 0; ok && op < ops; ++op) {
+    if (op % 256 == 0) bias = t.rng().below(101);
+    if (t.rng().below(100) < bias) {
+      std::string const s = std::to_string(t.rng().next());
+      bool const pushed = try_push(q, s);
+      ok = pushed == (ref.size() < capacity);
+      if (pushed) ref.push_back(s);
+    } else {
+      std::string out;
+      bool const popped = q.try_pop(out);
+      ok = popped == !ref.empty() && (!popped || out == ref.front());
+      if (popped) ref.pop_front();
+    }
+  }
+  std::string out;
+  while (ok && q.try_pop(out)) {
+    ok = !ref.empty() && out == ref.front();
+    ref.pop_front();
+  }
+  ALGORITMI_CHECK(t, ok && ref.empty());
+}
+
+// Per consumer, the items received in order; items are producer << 32 | seq.
+using received = std::vector<std::vector<std::uint64_t>>;
+
+bool exactly_once_in_order(received const& got, std::size_t producers, std::size_t per_producer) {
+  std::vector<std::vector<bool>> seen(producers, std::vector<bool>(per_producer));
+  std::size_t total = 0;
+  for (auto const& items : got) {
+    std::vector<std::int64_t> last(producers, -1);
+    for (std::uint64_t item : items) {
+      std::size_t const p = static_cast<std::size_t>(item >> 32);
+      auto const seq = static_cast<std::int64_t>(item & 0xffffffff);
+      if (p >= producers || static_cast<std::size_t>(seq) >= per_producer || seq <= last[p] ||
+          seen[p][static_cast<std::size_t>(seq)])
+        return false;
+      last[p] = seq;
+      seen[p][static_cast<std::size_t>(seq)] = true;
+      ++total;
+    }
+  }
+  return total == producers * per_producer;
+}
+
+// push(item) and try_pop(item) are the queue's; consumers stop once all
+// items have been taken.
+template <class Push, class Pop>
+received run_threads(std::size_t producers, std::size_t consumers, std::size_t per_producer,
+                     Push push, Pop pop) {
+  received got(consumers);
+  std::atomic<std::size_t> taken{0};
+  std::size_t const total = producers * per_producer;
+  std::vector<std::thread> threads;
+  for (std::size_t c = 0; c < consumers; ++c)
+    threads.emplace_back([&, c] {
+      std::uint64_t item;
+      while (taken.load(std::memory_order_relaxed) < total) {
+        if (pop(item)) {
+          got[c].push_back(item);
+          taken.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  for (std::size_t p = 0; p < producers; ++p)
+    threads.emplace_back([&, p] {
+      for (std::uint64_t s = 0; s < per_producer; ++s)
+        while (!push(std::uint64_t{p} << 32 | s)) std::this_thread::yield();
+    });
+  for (auto& th : threads) th.join();
+  return got;
+}
+
+// Counts live instances; construction from a negative int throws.
+struct counted {
+  static inline int live = 0;
+  int value = 0;
+
+  counted(int v) : value(v) {
+    if (v < 0) throw std::runtime_error("counted: negative");
+    ++live;
+  }
+  counted(counted&& other) noexcept : value(other.value) { ++live; }
+  counted& operator=(counted&&) noexcept = default;
+  ~counted() { --live; }
+};
+
+void test_spsc_queue(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(8); ++round) {
+    std::size_t const requested = 1 + t.rng().below(300);
+    spsc_queue<std::string> q(requested);
+    ALGORITMI_CHECK(t, q.capacity() >= requested);
+    sequential_case(t, q, q.capacity(), "spsc_queue");
+  }
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const per = 20000 + t.rng().below(20000);
+    spsc_queue<std::uint64_t> q(1 + t.rng().below(1000));
+    bool const bulk = round % 2;
+    t.set_case(std::string("spsc_queue threads") + (bulk ? " bulk" : "") +
+               " items=" + std::to_string(per));
+    std::vector<std::uint64_t> staged;
+    auto const got = run_threads(
+        1, 1, per,
+        [&](std::uint64_t item) {
+          if (!bulk) return q.try_push(item);
+          // Batches of up to 16, pushed as far as they fit.
+          staged.push_back(item);
+          if (staged.size() < 16 && (item & 0xffffffff) + 1 < per) return true;
+          std::size_t done = 0;
+          while (done < staged.size()) {
+            done += q.push_bulk(staged.begin() + static_cast<std::ptrdiff_t>(done),
+                                staged.size() - done);
+            if (done < staged.size()) std::this_thread::yield();
+          }
+          staged.clear();
+          return true;
+        },
+        [&](std::uint64_t& item) {
+          if (!bulk) return q.try_pop(item);
+          std::uint64_t buf[1];
+          if (q.pop_bulk(buf, 1) == 0) return false;
+          item = buf[0];
+          return true;
+        });
+    ALGORITMI_CHECK(t, exactly_once_in_order(got, 1, per) && q.empty());
+  }
+
+  // A throwing element pushes none of its batch and leaks nothing.
+  t.set_case("spsc_queue push_bulk throws");
+  {
+    spsc_queue<counted> q(8);
+    int const items[] = {1, 2, -1, 4};
+    ALGORITMI_CHECK_THROWS(t, std::runtime_error, q.push_bulk(items, 4));
+    ALGORITMI_CHECK(t, q.empty() && counted::live == 0);
+    ALGORITMI_CHECK(t, q.push_bulk(items, 2) == 2 && counted::live == 2);
+  }
+  ALGORITMI_CHECK(t, counted::live == 0);
+}
+
+void test_mpmc_queue(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(8); ++round) {
+    std::size_t const requested = 2 + t.rng().below(300);
+    mpmc_queue<std::string> q(requested);
+    ALGORITMI_CHECK(t, q.capacity() >= requested);
+    sequential_case(t, q, q.capacity(), "mpmc_queue");
+  }
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const producers = 1 + t.rng().below(4), consumers = 1 + t.rng().below(4);
+    std::size_t const per = 5000 + t.rng().below(10000);
+    mpmc_queue<std::uint64_t> q(2 + t.rng().below(500));
+    t.set_case("mpmc_queue threads " + std::to_string(producers) + 'p' +
+               std::to_string(consumers) + "c items=" + std::to_string(per));
+    auto const got = run_threads(
+        producers, consumers, per, [&](std::uint64_t item) { return q.try_push(item); },
+        [&](std::uint64_t& item) { return q.try_pop(item); });
+    ALGORITMI_CHECK(t, exactly_once_in_order(got, producers, per));
+  }
+
+  // A throwing constructor claims no cell: the queue keeps working.
+  t.set_case("mpmc_queue emplace throws");
+  {
+    mpmc_queue<counted> q(2);
+    ALGORITMI_CHECK_THROWS(t, std::runtime_error, q.try_emplace(-1));
+    counted out(0);
+    bool ok = q.try_emplace(1) && q.try_emplace(2) && !q.try_emplace(3);
+    ok = ok && q.try_pop(out) && out.value == 1 && q.try_pop(out) && out.value == 2;
+    ALGORITMI_CHECK(t, ok && !q.try_pop(out) && counted::live == 1);
+  }
+  ALGORITMI_CHECK(t, counted::live == 0);
+}
+
+void test_segmented_queue(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(8); ++round) {
+    segmented_queue<std::string> q;
+    sequential_case(t, q, ~std::size_t{0}, "segmented_queue");
+    ALGORITMI_CHECK(t, q.empty());
+  }
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const producers = 1 + t.rng().below(4), consumers = 1 + t.rng().below(4);
+    std::size_t const per = 5000 + t.rng().below(10000);
+    segmented_queue<std::uint64_t> q;
+    t.set_case("segmented_queue threads " + std::to_string(producers) + 'p' +
+               std::to_string(consumers) + "c items=" + std::to_string(per));
+    auto const got = run_threads(
+        producers, consumers, per,
+        [&](std::uint64_t item) {
+          q.push(item);
+          return true;
+        },
+        [&](std::uint64_t& item) { return q.try_pop(item); });
+    ALGORITMI_CHECK(t, exactly_once_in_order(got, producers, per) && q.empty());
+  }
+  // Items left in the queue are destroyed with it.
+  {
+    segmented_queue<std::unique_ptr<int>> q;
+    for (int i = 0; i < 10000; ++i) q.push(std::make_unique<int>(i));
+  }
+}
+
+ALGORITMI_TEST("concurrent/spsc_queue", test_spsc_queue);
+ALGORITMI_TEST("concurrent/mpmc_queue", test_mpmc_queue);
+ALGORITMI_TEST("concurrent/segmented_queue", test_segmented_queue);
+
+}  // namespace
+}  // namespace algoritmi::test
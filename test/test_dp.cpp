@@ -0,0 +1,210 @@
+// Dynamic programming against the full O(mn) tables.
+//
+//   dp/edit_distance   edit_distance (bounded too), edit_distance_matcher,
+//                      lcs_length
+//   dp/alignment       global_alignment_score, global_alignment's edit
+//                      script, longest_common_subsequence
+//   dp/local           local_alignment_score, every instruction set, with
+//                      scores that overflow the 16-bit lanes
+//   dp/knapsack        knapsack_value and knapsack's subset
+//
+// Strings run across the 64-byte blocks of the bit-parallel versions and
+// come from small alphabets, or are near-copies of each other, so that
+// distances are neither trivial nor maximal.
+#include <algoritmi/dp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+std::string random_string(Rng& rng, std::size_t n, unsigned sigma) {
+  std::string s(n, 'a');
+  for (auto& c : s) c = static_cast<char>(sigma == 256 ? rng.below(256) : 'a' + rng.below(sigma));
+  return s;
+}
+
+// b is a random string, or a with a few edits.
+std::pair<std::string, std::string> string_pair(Rng& rng, std::size_t max) {
+  static constexpr unsigned sigmas[] = {1, 2, 4, 26, 256};
+  unsigned const sigma = sigmas[rng.below(5)];
+  std::string a = random_string(rng, random_size(rng, max), sigma);
+  if (rng.coin()) return {a, random_string(rng, random_size(rng, max), sigma)};
+  std::string b = a;
+  for (std::size_t k = rng.below(1 + b.size() / 8 + 2); k > 0; --k) {
+    std::size_t const at = rng.below(b.size() + 1);
+    switch (rng.below(3)) {
+      case 0: b.insert(at, random_string(rng, 1, sigma)); break;
+      case 1:
+        if (at < b.size()) b.erase(at, 1);
+        break;
+      default:
+        if (at < b.size()) b[at] = random_string(rng, 1, sigma)[0];
+        break;
+    }
+  }
+  return {a, b};
+}
+
+std::string label(char const* what, std::string const& a, std::string const& b) {
+  return std::string(what) + " m=" + std::to_string(a.size()) + " n=" + std::to_string(b.size());
+}
+
+// Global (Needleman-Wunsch) or local (Smith-Waterman) score, full table.
+std::int64_t table_score(std::string_view a, std::string_view b, alignment_scoring const& s,
+                         bool local) {
+  std::vector<std::int64_t> prev(b.size() + 1), cur(b.size() + 1);
+  std::int64_t best = 0;
+  for (std::size_t j = 0; j <= b.size(); ++j)
+    prev[j] = local ? 0 : static_cast<std::int64_t>(j) * s.gap;
+  for (std::size_t i = 1; i <= a.size(); ++i) {
+    cur[0] = local ? 0 : static_cast<std::int64_t>(i) * s.gap;
+    for (std::size_t j = 1; j <= b.size(); ++j) {
+      std::int64_t const diag = prev[j - 1] + (a[i - 1] == b[j - 1] ? s.match : s.mismatch);
+      cur[j] = std::max({diag, prev[j] + s.gap, cur[j - 1] + s.gap});
+      if (local) cur[j] = std::max<std::int64_t>(cur[j], 0);
+      best = std::max(best, cur[j]);
+    }
+    std::swap(prev, cur);
+  }
+  return local ? best : prev[b.size()];
+}
+
+std::size_t table_edit_distance(std::string_view a, std::string_view b) {
+  auto const d = -table_score(a, b, {0, -1, -1}, false);
+  return static_cast<std::size_t>(d);
+}
+
+std::size_t table_lcs(std::string_view a, std::string_view b) {
+  return static_cast<std::size_t>(table_score(a, b, {1, 0, 0}, false));
+}
+
+void test_edit_distance(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(200); ++round) {
+    auto const [a, b] = string_pair(t.rng(), 1500);
+    std::size_t const expect = table_edit_distance(a, b);
+    t.set_case(label("edit_distance", a, b));
+    ALGORITMI_CHECK(t, edit_distance(a, b) == expect && edit_distance(b, a) == expect);
+    std::size_t const max = t.rng().below(expect + 8);
+    ALGORITMI_CHECK(t, edit_distance(a, b, max) == std::min(expect, max + 1));
+    edit_distance_matcher matcher(a);
+    ALGORITMI_CHECK(t, matcher.distance(b) == expect);
+    ALGORITMI_CHECK(t, matcher.distance(b, max) == std::min(expect, max + 1));
+    ALGORITMI_CHECK(t, matcher.distance(a) == 0);
+    ALGORITMI_CHECK(t, lcs_length(a, b) == table_lcs(a, b));
+  }
+}
+
+bool valid_script(alignment const& al, std::string_view a, std::string_view b) {
+  std::size_t i = 0, j = 0;
+  for (edit_op op : al.ops) {
+    bool const both = op == edit_op::match || op == edit_op::substitute;
+    if ((op != edit_op::insert && i == a.size()) || (op != edit_op::remove && j == b.size()))
+      return false;
+    if (both && (a[i] == b[j]) != (op == edit_op::match)) return false;
+    i += op != edit_op::insert;
+    j += op != edit_op::remove;
+  }
+  return i == a.size() && j == b.size();
+}
+
+void test_alignment(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(120); ++round) {
+    auto const [a, b] = string_pair(t.rng(), 600);
+    alignment_scoring const s{static_cast<std::int64_t>(t.rng().below(5)),
+                              -static_cast<std::int64_t>(t.rng().below(5)),
+                              -static_cast<std::int64_t>(t.rng().below(5))};
+    std::int64_t const expect = table_score(a, b, s, false);
+    t.set_case(label("global_alignment", a, b) + " scoring=" + std::to_string(s.match) + '/' +
+               std::to_string(s.mismatch) + '/' + std::to_string(s.gap));
+    ALGORITMI_CHECK(t, global_alignment_score(a, b, s) == expect);
+    auto const al = global_alignment(a, b, s);
+    ALGORITMI_CHECK(t, al.score == expect && valid_script(al, a, b));
+
+    auto const lcs = longest_common_subsequence(a, b);
+    auto const is_subsequence = [&](std::string_view of) {
+      std::size_t k = 0;
+      for (char c : of)
+        if (k < lcs.size() && lcs[k] == c) ++k;
+      return k == lcs.size();
+    };
+    ALGORITMI_CHECK(t, lcs.size() == table_lcs(a, b) && is_subsequence(a) && is_subsequence(b));
+  }
+}
+
+void test_local(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(120); ++round) {
+    auto const [a, b] = string_pair(t.rng(), 2000);
+    // Mostly small scores; sometimes large enough that the best score, or
+    // a single step, leaves the 16-bit range.
+    std::int64_t const scale = round % 8 == 7 ? 100 + t.rng().below(20000) : 1;
+    alignment_scoring const s{scale * static_cast<std::int64_t>(1 + t.rng().below(4)),
+                              -scale * static_cast<std::int64_t>(t.rng().below(5)),
+                              -scale * static_cast<std::int64_t>(1 + t.rng().below(4))};
+    std::int64_t const expect = table_score(a, b, s, true);
+    t.set_case(label("local_alignment", a, b) + " scoring=" + std::to_string(s.match) + '/' +
+               std::to_string(s.mismatch) + '/' + std::to_string(s.gap));
+    ALGORITMI_CHECK(t, local_alignment_score(a, b, s) == expect);
+    for (isa which : host_isas())
+      ALGORITMI_CHECK(t, local_alignment_score(a, b, s, which) == expect);
+  }
+}
+
+void test_knapsack(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(100); ++round) {
+    std::size_t const n = t.rng().below(60);
+    std::size_t const capacity = t.rng().below(2000);
+    std::vector<std::size_t> weights(n);
+    std::vector<std::int64_t> values(n);
+    for (std::size_t k = 0; k < n; ++k) {
+      weights[k] = t.rng().below(round % 2 ? 50 : capacity + 2);
+      values[k] = static_cast<std::int64_t>(t.rng().below(1000));
+    }
+    // best[i][c]: items [0, i), capacity c.
+    std::vector<std::vector<std::int64_t>> best(n + 1, std::vector<std::int64_t>(capacity + 1));
+    for (std::size_t i = 1; i <= n; ++i)
+      for (std::size_t c = 0; c <= capacity; ++c) {
+        best[i][c] = best[i - 1][c];
+        if (weights[i - 1] <= c)
+          best[i][c] = std::max(best[i][c], best[i - 1][c - weights[i - 1]] + values[i - 1]);
+      }
+    std::int64_t const expect = best[n][capacity];
+    span<std::size_t const> const w(weights);
+    span<std::int64_t const> const v(values);
+    t.set_case("knapsack n=" + std::to_string(n) + " capacity=" + std::to_string(capacity));
+    ALGORITMI_CHECK(t, knapsack_value(w, v, capacity) == expect);
+    auto const r = knapsack(w, v, capacity);
+    std::size_t weight = 0;
+    std::int64_t value = 0;
+    for (std::size_t k : r.items) {
+      weight += k < n ? weights[k] : capacity + 1;
+      value += k < n ? values[k] : 0;
+    }
+    ALGORITMI_CHECK(t, r.value == expect && value == expect && weight <= capacity &&
+                           std::adjacent_find(r.items.begin(), r.items.end(),
+                                              std::greater_equal<>()) == r.items.end());
+  }
+  std::vector<std::size_t> const w = {1, 2};
+  std::vector<std::int64_t> const v = {1};
+  span<std::size_t const> const ws(w);
+  span<std::int64_t const> const vs(v);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, knapsack_value(ws, vs, 3));
+}
+
+ALGORITMI_TEST("dp/edit_distance", test_edit_distance);
+ALGORITMI_TEST("dp/alignment", test_alignment);
+ALGORITMI_TEST("dp/local", test_local);
+ALGORITMI_TEST("dp/knapsack", test_knapsack);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,382 @@
+// Transforms and convolutions against direct sums.
+//
+//   fft/plan        every power of two up to 2^11 and random ones, against
+//                   the DFT in long double (all bins, or sampled bins past
+//                   the breadth-first threshold); every instruction set,
+//                   par, round trips; argument errors
+//   fft/ntt         three primes against the DFT modulo P, exact round
+//                   trips, par; sizes above max_size()
+//   fft/convolve    the direct, whole-transform and overlap-save paths of
+//                   convolve(), par; convolve_mod against the quadratic
+//                   loop, and large products by evaluation at a point
+//   fft/bigint      bigint_multiply against schoolbook on both sides of
+//                   bigint_ntt_cutoff, all-ones limbs, large products by
+//                   their residues
+#include <algoritmi/fft.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+using cplx = std::complex<double>;
+
+constexpr long double pi = 3.141592653589793238462643383279502884L;
+
+// Sizes to check in full against the quadratic DFT; above, sampled bins.
+constexpr std::size_t dft_full_max = std::size_t{1} << 11;
+
+std::vector<cplx> random_complex(Rng& rng, std::size_t n) {
+  std::vector<cplx> x(n);
+  for (auto& v : x) v = cplx(2 * rng.uniform() - 1, 2 * rng.uniform() - 1);
+  return x;
+}
+
+// exp(-2 pi i j / n) for j < n in long double.
+std::vector<std::complex<long double>> roots(std::size_t n) {
+  std::vector<std::complex<long double>> w(n);
+  for (std::size_t j = 0; j < n; ++j) w[j] = std::polar(1.0L, -2 * pi * j / n);
+  return w;
+}
+
+// Bin k of the DFT of x, the exponent reduced exactly.
+std::complex<long double> dft_bin(std::vector<cplx> const& x,
+                                  std::vector<std::complex<long double>> const& w,
+                                  std::size_t k) {
+  std::size_t const n = x.size();
+  std::complex<long double> s = 0;
+  for (std::size_t j = 0; j < n; ++j) s += std::complex<long double>(x[j]) * w[j * k % n];
+  return s;
+}
+
+// The bins to compare: all of them for small n, else a few random ones
+// and the ends.
+std::vector<std::size_t> bins(Rng& rng, std::size_t n) {
+  std::vector<std::size_t> k;
+  if (n <= dft_full_max) {
+    for (std::size_t i = 0; i < n; ++i) k.push_back(i);
+  } else {
+    k = {0, 1, n / 2, n - 1};
+    for (int i = 0; i < 8; ++i) k.push_back(rng.below(n));
+  }
+  return k;
+}
+
+void plan_case(Context& t, std::size_t n) {
+  Rng& rng = t.rng();
+  fft_plan const plan(n);
+  auto const x = random_complex(rng, n);
+  auto const k = bins(rng, n);
+  auto const w = roots(n);
+  std::vector<std::complex<long double>> want;
+  for (std::size_t i : k) want.push_back(dft_bin(x, w, i));
+  // FFT error grows as eps log2 n times the norm of x, at most sqrt(2n).
+  long double const eps = std::numeric_limits<double>::epsilon();
+  long double const log_n = std::log2(static_cast<long double>(n)) + 1;
+  long double const bound = 8 * eps * log_n * std::sqrt(2.0L * n);
+  auto const matches = [&](std::vector<cplx> const& y) {
+    for (std::size_t i = 0; i < k.size(); ++i)
+      if (!(std::abs(std::complex<long double>(y[k[i]]) - want[i]) <= bound)) return false;
+    return true;
+  };
+  auto const round_trip = [&](std::vector<cplx> const& y) {
+    for (std::size_t i = 0; i < n; ++i)
+      if (!(std::abs(y[i] - x[i]) <= 16 * eps * log_n)) return false;
+    return true;
+  };
+
+  std::string const label = "fft n=" + std::to_string(n);
+  t.set_case(label);
+  ALGORITMI_CHECK(t, plan.size() == n);
+  auto y = x;
+  plan.forward(y);
+  ALGORITMI_CHECK(t, matches(y));
+  plan.inverse(y);
+  ALGORITMI_CHECK(t, round_trip(y));
+  for (isa which : host_isas()) {
+    t.set_case(label + " " + to_string(which));
+    y = x;
+    plan.forward(which, y);
+    ALGORITMI_CHECK(t, matches(y));
+    plan.inverse(which, y);
+    ALGORITMI_CHECK(t, round_trip(y));
+  }
+  t.set_case(label + " par");
+  y = x;
+  plan.forward(par, y);
+  ALGORITMI_CHECK(t, matches(y));
+  plan.inverse(par, y);
+  ALGORITMI_CHECK(t, round_trip(y));
+}
+
+void test_plan(Context& t) {
+  for (std::size_t n = 1; n <= dft_full_max; n *= 2) plan_case(t, n);
+  for (std::size_t round = 0; round < t.rounds(6); ++round)
+    plan_case(t, std::size_t{1} << t.rng().below(15));
+  // Breadth-first stages: an odd and an even number of them past
+  // complex_local_points, and a closing radix-2 stage.
+  plan_case(t, std::size_t{1} << 15);
+  plan_case(t, std::size_t{1} << 17);
+  plan_case(t, std::size_t{1} << 18);
+
+  t.set_case("fft errors");
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, fft_plan(0));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, fft_plan(12));
+  fft_plan const plan(8);
+  std::vector<cplx> x(4);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, plan.forward(x));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, plan.inverse(par, x));
+}
+
+std::uint64_t pow_mod(std::uint64_t b, std::uint64_t e, std::uint64_t m) {
+  std::uint64_t r = 1 % m;
+  for (b %= m; e; e >>= 1, b = b * b % m)
+    if (e & 1) r = r * b % m;
+  return r;
+}
+
+// Smallest primitive root of the prime p, found independently of
+// montgomery.hpp.
+std::uint64_t primitive_root(std::uint64_t p) {
+  std::vector<std::uint64_t> factors;
+  std::uint64_t m = p - 1;
+  for (std::uint64_t f = 2; f * f <= m; ++f)
+    if (m % f == 0) {
+      factors.push_back(f);
+      while (m % f == 0) m /= f;
+    }
+  if (m > 1) factors.push_back(m);
+  for (std::uint64_t g = 2;; ++g) {
+    bool ok = true;
+    for (std::uint64_t f : factors) ok = ok && pow_mod(g, (p - 1) / f, p) != 1;
+    if (ok) return g;
+  }
+}
+
+template <std::uint32_t P>
+void ntt_case(Context& t, std::size_t n) {
+  Rng& rng = t.rng();
+  ntt_plan<P> const plan(n);
+  std::vector<std::uint32_t> x(n);
+  for (auto& v : x) v = static_cast<std::uint32_t>(rng.below(P));
+  std::vector<std::uint64_t> powers(n);
+  std::uint64_t const w = pow_mod(primitive_root(P), (P - 1) / n, P);
+  for (std::size_t i = 0, p = 1; i < n; ++i, p = p * w % P) powers[i] = p;
+  auto const k = bins(rng, n);
+  std::vector<std::uint32_t> want;
+  for (std::size_t i : k) {
+    std::uint64_t s = 0;
+    for (std::size_t j = 0; j < n; ++j) s = (s + x[j] * powers[j * i % n]) % P;
+    want.push_back(static_cast<std::uint32_t>(s));
+  }
+  auto const matches = [&](std::vector<std::uint32_t> const& y) {
+    for (std::size_t i = 0; i < k.size(); ++i)
+      if (y[k[i]] != want[i]) return false;
+    return true;
+  };
+
+  t.set_case("ntt P=" + std::to_string(P) + " n=" + std::to_string(n));
+  ALGORITMI_CHECK(t, plan.size() == n);
+  auto y = x;
+  plan.forward(y);
+  ALGORITMI_CHECK(t, matches(y));
+  auto z = x;
+  plan.forward(par, z);
+  ALGORITMI_CHECK(t, z == y);
+  plan.inverse(y);
+  ALGORITMI_CHECK(t, y == x);
+  plan.inverse(par, z);
+  ALGORITMI_CHECK(t, z == x);
+}
+
+void test_ntt(Context& t) {
+  for (std::size_t n = 1; n <= dft_full_max; n *= 2) ntt_case<998244353>(t, n);
+  for (std::size_t n = 1; n <= ntt_plan<7681>::max_size(); n *= 2) ntt_case<7681>(t, n);
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    ntt_case<998244353>(t, std::size_t{1} << t.rng().below(16));
+    ntt_case<469762049>(t, std::size_t{1} << t.rng().below(16));
+  }
+  // Breadth-first stages past modular_local_points.
+  ntt_case<998244353>(t, std::size_t{1} << 17);
+  ntt_case<469762049>(t, std::size_t{1} << 18);
+
+  t.set_case("ntt errors");
+  ALGORITMI_CHECK(t, ntt_plan<7681>::max_size() == 512);
+  ALGORITMI_CHECK(t, ntt_plan<998244353>::max_size() == std::size_t{1} << 23);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, ntt_plan<7681>(1024));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, ntt_plan<7681>(6));
+  ntt_plan<7681> const plan(16);
+  std::vector<std::uint32_t> x(32);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, plan.forward(x));
+}
+
+std::vector<double> random_real(Rng& rng, std::size_t n) {
+  std::vector<double> x(n);
+  for (auto& v : x) v = 2 * rng.uniform() - 1;
+  return x;
+}
+
+void convolve_case(Context& t, std::size_t na, std::size_t nb) {
+  Rng& rng = t.rng();
+  auto const a = random_real(rng, na), b = random_real(rng, nb);
+  std::vector<long double> want(na && nb ? na + nb - 1 : 0);
+  long double norm_a = 0, norm_b = 0;
+  for (std::size_t i = 0; i < na; ++i)
+    for (std::size_t j = 0; j < nb; ++j) want[i + j] += static_cast<long double>(a[i]) * b[j];
+  for (double v : a) norm_a += static_cast<long double>(v) * v;
+  for (double v : b) norm_b += static_cast<long double>(v) * v;
+  long double const eps = std::numeric_limits<double>::epsilon();
+  long double const bound =
+      16 * eps * (std::log2(static_cast<long double>(na + nb + 1)) + 1) *
+      std::sqrt(norm_a * norm_b);
+  auto const matches = [&](std::pmr::vector<double> const& c) {
+    if (c.size() != want.size()) return false;
+    for (std::size_t i = 0; i < c.size(); ++i)
+      if (!(std::fabs(c[i] - want[i]) <= bound)) return false;
+    return true;
+  };
+
+  std::string const label = "convolve " + std::to_string(na) + " * " + std::to_string(nb);
+  t.set_case(label);
+  ALGORITMI_CHECK(t, matches(convolve(a, b)));
+  ALGORITMI_CHECK(t, matches(convolve(b, a)));
+  t.set_case(label + " par");
+  ALGORITMI_CHECK(t, matches(convolve(par, a, b)));
+}
+
+template <std::uint32_t P>
+void convolve_mod_case(Context& t, std::size_t na, std::size_t nb) {
+  Rng& rng = t.rng();
+  std::vector<std::uint32_t> a(na), b(nb);
+  for (auto& v : a) v = static_cast<std::uint32_t>(rng.next());
+  for (auto& v : b) v = static_cast<std::uint32_t>(rng.next());
+  t.set_case("convolve_mod P=" + std::to_string(P) + " " + std::to_string(na) + " * " +
+             std::to_string(nb));
+  auto const c = convolve_mod<P>(a, b);
+  ALGORITMI_CHECK(t, convolve_mod<P>(par, a, b) == c);
+  if (!ALGORITMI_CHECK(t, c.size() == (na && nb ? na + nb - 1 : 0))) return;
+  if (na * nb <= 4000000) {
+    std::vector<std::uint64_t> want(c.size());
+    for (std::size_t i = 0; i < na; ++i)
+      for (std::size_t j = 0; j < nb; ++j)
+        want[i + j] = (want[i + j] + std::uint64_t{a[i] % P} * (b[j] % P)) % P;
+    ALGORITMI_CHECK(t, std::equal(c.begin(), c.end(), want.begin()));
+    return;
+  }
+  // c(r) = a(r) b(r) at a random point.
+  std::uint64_t const r = rng.below(P);
+  auto const eval = [&](auto const& v) {
+    std::uint64_t s = 0;
+    for (std::size_t i = v.size(); i-- > 0;) s = (s * r + v[i] % P) % P;
+    return s;
+  };
+  bool reduced = std::all_of(c.begin(), c.end(), [](std::uint32_t v) { return v < P; });
+  ALGORITMI_CHECK(t, reduced && eval(c) == eval(a) * eval(b) % P);
+}
+
+void test_convolve(Context& t) {
+  convolve_case(t, 0, 5);
+  convolve_case(t, 1, 1);
+  for (std::size_t round = 0; round < t.rounds(20); ++round)
+    convolve_case(t, 1 + random_size(t.rng(), 3000), 1 + random_size(t.rng(), 400));
+  // One transform of the whole output, then overlap-save with one, two
+  // and an odd number of blocks.
+  convolve_case(t, 3000, 3000);
+  convolve_case(t, 7000, 40);
+  convolve_case(t, 12000, 40);
+  convolve_case(t, 100000, 37);
+  convolve_case(t, 50000, 600);
+
+  convolve_mod_case<998244353>(t, 0, 3);
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    std::size_t const na = 1 + random_size(t.rng(), 2000), nb = 1 + random_size(t.rng(), 2000);
+    convolve_mod_case<998244353>(t, na, nb);
+    convolve_mod_case<469762049>(t, na, nb);
+  }
+  convolve_mod_case<7681>(t, 200, 313);
+  convolve_mod_case<998244353>(t, 70000, 90000);
+
+  t.set_case("convolve_mod errors");
+  std::vector<std::uint32_t> const x(300);
+  ALGORITMI_CHECK_THROWS(t, std::length_error, convolve_mod<7681>(x, x));
+}
+
+std::vector<std::uint32_t> schoolbook(std::vector<std::uint32_t> const& a,
+                                      std::vector<std::uint32_t> const& b) {
+  std::vector<std::uint32_t> c(a.size() + b.size());
+  for (std::size_t j = 0; j < b.size(); ++j) {
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      carry += std::uint64_t{a[i]} * b[j] + c[i + j];
+      c[i + j] = static_cast<std::uint32_t>(carry);
+      carry >>= 32;
+    }
+    c[a.size() + j] = static_cast<std::uint32_t>(carry);
+  }
+  return c;
+}
+
+// The integer in little-endian limbs x, modulo m < 2^31.
+std::uint64_t residue(span<std::uint32_t const> x, std::uint64_t m) {
+  std::uint64_t r = 0;
+  for (std::size_t i = x.size(); i-- > 0;) r = ((r << 32) + x[i]) % m;
+  return r;
+}
+
+void bigint_case(Context& t, std::vector<std::uint32_t> const& a,
+                 std::vector<std::uint32_t> const& b) {
+  std::string const label =
+      "bigint " + std::to_string(a.size()) + " * " + std::to_string(b.size());
+  t.set_case(label);
+  auto const c = bigint_multiply(a, b);
+  if (!ALGORITMI_CHECK(t, c.size() == a.size() + b.size())) return;
+  if (a.size() * b.size() <= 10000000) {
+    auto const want = schoolbook(a, b);
+    ALGORITMI_CHECK(t, std::equal(c.begin(), c.end(), want.begin()));
+  } else {
+    for (std::uint64_t m : {2147483647ULL, 1000000007ULL})
+      ALGORITMI_CHECK(t, residue(c, m) == residue(a, m) * residue(b, m) % m);
+  }
+  t.set_case(label + " par");
+  ALGORITMI_CHECK(t, bigint_multiply(par, a, b) == c);
+}
+
+std::vector<std::uint32_t> random_limbs(Rng& rng, std::size_t n) {
+  std::vector<std::uint32_t> x(n);
+  for (auto& v : x) v = static_cast<std::uint32_t>(rng.next());
+  return x;
+}
+
+void test_bigint(Context& t) {
+  Rng& rng = t.rng();
+  bigint_case(t, {}, {7});
+  bigint_case(t, {0xffffffff}, {0xffffffff});
+  for (std::size_t round = 0; round < t.rounds(30); ++round)
+    bigint_case(t, random_limbs(rng, 1 + random_size(rng, 2000)),
+                random_limbs(rng, 1 + random_size(rng, 2000)));
+  // Either side of the cutoff, and carries through every limb.
+  bigint_case(t, random_limbs(rng, bigint_ntt_cutoff - 1), random_limbs(rng, 5000));
+  bigint_case(t, random_limbs(rng, bigint_ntt_cutoff), random_limbs(rng, 5000));
+  std::vector<std::uint32_t> const ones(3000, 0xffffffff);
+  bigint_case(t, ones, ones);
+  // Transforms with breadth-first stages.
+  bigint_case(t, random_limbs(rng, 50000), random_limbs(rng, 40000));
+}
+
+ALGORITMI_TEST("fft/plan", test_plan);
+ALGORITMI_TEST("fft/ntt", test_ntt);
+ALGORITMI_TEST("fft/convolve", test_convolve);
+ALGORITMI_TEST("fft/bigint", test_bigint);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,251 @@
+// Filters against the exact set of inserted keys, HyperLogLog against the
+// exact distinct count.
+//
+//   filter/bloom          no false negatives on every instruction set,
+//                         single and batched, false-positive rate, merge
+//   filter/xor            xor and binary fuse filters with 8 and 16-bit
+//                         fingerprints: no false negatives, false-positive
+//                         rate, duplicates, string keys, par construction
+//   filter/hyperloglog    estimate error from a handful of keys to
+//                         millions, sparse and dense merges on every
+//                         instruction set, argument errors
+#include <algoritmi/filter.hpp>
+
+#include <algoritmi/scheduler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// n distinct keys, and as many others none of which is among them.
+void split_keys(Rng& rng, std::size_t n, std::vector<std::uint64_t>& in,
+                std::vector<std::uint64_t>& out) {
+  std::unordered_set<std::uint64_t> seen;
+  in.clear();
+  out.clear();
+  while (in.size() < n) {
+    std::uint64_t const k = rng.next();
+    if (seen.insert(k).second) in.push_back(k);
+  }
+  while (out.size() < std::max<std::size_t>(n, 20000)) {
+    std::uint64_t const k = rng.next();
+    if (seen.insert(k).second) out.push_back(k);
+  }
+}
+
+template <class Filter>
+double false_positive_rate(Filter const& f, std::vector<std::uint64_t> const& out) {
+  std::size_t hits = 0;
+  for (std::uint64_t k : out) hits += f.contains(k);
+  return static_cast<double>(hits) / static_cast<double>(out.size());
+}
+
+void test_bloom(Context& t) {
+  std::vector<std::uint64_t> in, out;
+  for (std::size_t round = 0; round < t.rounds(10); ++round) {
+    std::size_t const n = random_size(t.rng(), 30000);
+    split_keys(t.rng(), n, in, out);
+    blocked_bloom_filter<std::uint64_t> bloom(n);
+    // Half one at a time, half as a range.
+    for (std::size_t i = 0; i < n / 2; ++i) bloom.insert(in[i]);
+    bloom.insert(in.begin() + static_cast<std::ptrdiff_t>(n / 2), in.end());
+    t.set_case("bloom n=" + std::to_string(n));
+    ALGORITMI_CHECK(t, bloom.memory_bytes() >= n * 10 / 8);
+
+    for (isa which : host_isas()) {
+      t.set_case("bloom " + std::string(to_string(which)) + " n=" + std::to_string(n));
+      bool ok = true;
+      for (std::size_t i = 0; ok && i < n; ++i) ok = bloom.contains(which, in[i]);
+      std::unique_ptr<bool[]> found(new bool[n + 1]);
+      bloom.contains(which, in.data(), n, found.get());
+      for (std::size_t i = 0; ok && i < n; ++i) ok = found[i];
+      ALGORITMI_CHECK(t, ok);
+      // Both kernels agree on the keys that were never inserted.
+      std::unique_ptr<bool[]> probed(new bool[out.size()]);
+      bloom.contains(which, out.data(), out.size(), probed.get());
+      for (std::size_t i = 0; ok && i < out.size(); ++i)
+        ok = probed[i] == bloom.contains(out[i]) && probed[i] == bloom.contains(which, out[i]);
+      ALGORITMI_CHECK(t, ok);
+    }
+    // 1% expected at 10 bits per key once the filter is well filled.
+    if (n >= 5000) ALGORITMI_CHECK(t, false_positive_rate(bloom, out) < 0.02);
+
+    // Two halves merged set exactly the bits of the whole.
+    t.set_case("bloom merge n=" + std::to_string(n));
+    blocked_bloom_filter<std::uint64_t> a(n), b(n);
+    for (std::size_t i = 0; i < n; ++i) (i % 2 ? a : b).insert(in[i]);
+    a.merge(b);
+    a.merge(a);
+    bool ok = true;
+    for (std::size_t i = 0; ok && i < n; ++i) ok = a.contains(in[i]);
+    ALGORITMI_CHECK(t, ok && a.fill() == bloom.fill());
+  }
+
+  t.set_case("bloom errors");
+  blocked_bloom_filter<std::string> strings(100, 12);
+  strings.insert("alpha");
+  strings.insert(std::string("beta"));
+  ALGORITMI_CHECK(t, strings.contains("alpha") && strings.contains("beta"));
+  blocked_bloom_filter<std::string> other(100000);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, strings.merge(other));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, blocked_bloom_filter<int>(10, 0));
+  strings.clear();
+  ALGORITMI_CHECK(t, !strings.contains("alpha") && strings.fill() == 0);
+}
+
+template <class Filter>
+void check_static_filter(Context& t, char const* name, std::vector<std::uint64_t> const& in,
+                         std::vector<std::uint64_t> const& out, double max_rate) {
+  std::size_t const n = in.size();
+  t.set_case(std::string(name) + " n=" + std::to_string(n));
+  // Every key twice, in two places.
+  std::vector<std::uint64_t> keys(in);
+  keys.insert(keys.end(), in.begin(), in.end());
+  Filter const f(keys.begin(), keys.end());
+  ALGORITMI_CHECK(t, f.size() == n && f.empty() == (n == 0));
+  bool ok = true;
+  for (std::size_t i = 0; ok && i < n; ++i) ok = f.contains(in[i]);
+  std::unique_ptr<bool[]> found(new bool[n + 1]);
+  f.contains(in.data(), n, found.get());
+  for (std::size_t i = 0; ok && i < n; ++i) ok = found[i];
+  ALGORITMI_CHECK(t, ok);
+  std::unique_ptr<bool[]> probed(new bool[out.size()]);
+  f.contains(out.data(), out.size(), probed.get());
+  for (std::size_t i = 0; ok && i < out.size(); ++i) ok = probed[i] == f.contains(out[i]);
+  ALGORITMI_CHECK(t, ok);
+  if (n == 0) ALGORITMI_CHECK(t, false_positive_rate(f, out) == 0);
+  if (n >= 1000) ALGORITMI_CHECK(t, false_positive_rate(f, out) < max_rate);
+}
+
+void test_xor(Context& t) {
+  std::vector<std::uint64_t> in, out;
+  for (std::size_t round = 0; round < t.rounds(16); ++round) {
+    std::size_t const n = round < 4 ? round : random_size(t.rng(), 50000);
+    split_keys(t.rng(), n, in, out);
+    // 2^-8 and 2^-16 expected.
+    check_static_filter<xor_filter<std::uint64_t>>(t, "xor_filter", in, out, 0.008);
+    check_static_filter<binary_fuse_filter<std::uint64_t>>(t, "binary_fuse_filter", in, out,
+                                                           0.008);
+    check_static_filter<xor_filter<std::uint64_t, std::uint16_t>>(t, "xor_filter16", in, out,
+                                                                  0.0005);
+    check_static_filter<binary_fuse_filter<std::uint64_t, std::uint16_t>>(
+        t, "binary_fuse_filter16", in, out, 0.0005);
+  }
+
+  t.set_case("xor sizes");
+  std::vector<std::uint64_t> many;
+  split_keys(t.rng(), 200000, many, in);
+  xor_filter<std::uint64_t> const x(many.begin(), many.end());
+  binary_fuse_filter<std::uint64_t> const fuse(many.begin(), many.end());
+  ALGORITMI_CHECK(t, x.bits_per_key() < 9.9 && fuse.bits_per_key() < 9.5);
+
+  // The parallel build makes the same filter.
+  t.set_case("xor par");
+  binary_fuse_filter<std::uint64_t> const fuse_par(par.with_threads(4), many.begin(),
+                                                   many.end());
+  xor_filter<std::uint64_t> const x_par(par.with_threads(4), many.begin(), many.end());
+  bool ok = fuse_par.size() == fuse.size() && x_par.size() == x.size();
+  for (std::size_t i = 0; ok && i < many.size(); ++i)
+    ok = fuse_par.contains(many[i]) && x_par.contains(many[i]);
+  for (std::size_t i = 0; ok && i < in.size(); ++i)
+    ok = fuse_par.contains(in[i]) == fuse.contains(in[i]) &&
+         x_par.contains(in[i]) == x.contains(in[i]);
+  ALGORITMI_CHECK(t, ok);
+
+  t.set_case("xor strings");
+  std::vector<std::string> words;
+  for (std::size_t i = 0; i < 5000; ++i) words.push_back("key" + std::to_string(i * 7919));
+  binary_fuse_filter<std::string> const by_word(words.begin(), words.end());
+  ok = by_word.size() == words.size();
+  for (std::size_t i = 0; ok && i < words.size(); ++i) ok = by_word.contains(words[i]);
+  ALGORITMI_CHECK(t, ok);
+  xor_filter<std::string> const none;
+  ALGORITMI_CHECK(t, none.empty() && !none.contains("key0"));
+}
+
+void test_hyperloglog(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(12); ++round) {
+    unsigned const p = 4 + static_cast<unsigned>(t.rng().below(15));
+    std::size_t const n = round < 2 ? round * 5 : random_size(t.rng(), 300000);
+    t.set_case("hyperloglog p=" + std::to_string(p) + " n=" + std::to_string(n));
+    hyperloglog<std::uint64_t> one(p), a(p), b(p);
+    std::uint64_t const base = t.rng().next();
+    for (std::size_t i = 0; i < n; ++i) {
+      // Every key twice: duplicates do not count.
+      std::uint64_t const k = base + i;
+      one.add(k);
+      one.add(k);
+      (i % 3 ? a : b).add(k);
+    }
+    double const truth = static_cast<double>(n);
+    double const error = std::abs(one.estimate() - truth) / std::max(1.0, truth);
+    // Sparse counts are nearly exact; dense ones within 6 standard errors,
+    // 1.04 / sqrt(m). Below 64 registers the error is far from normal (a
+    // 16-register estimate can be off by 2.6x), so only its order is checked.
+    double const m = static_cast<double>(one.register_count());
+    auto const bound = [&](hyperloglog<std::uint64_t> const& h) {
+      if (h.is_sparse()) return 0.01;
+      return m >= 64 ? 6 * 1.04 / std::sqrt(m) : 4.0;
+    };
+    ALGORITMI_CHECK(t, error <= bound(one));
+    if (n == 0) ALGORITMI_CHECK(t, one.estimate() == 0);
+
+    // Merging loses nothing: the same registers as one counter of all keys.
+    for (isa which : host_isas()) {
+      t.set_case("hyperloglog merge " + std::string(to_string(which)) + " p=" +
+                 std::to_string(p) + " n=" + std::to_string(n));
+      hyperloglog<std::uint64_t> merged(p);
+      merged.merge(which, a);
+      merged.merge(which, b);
+      merged.merge(which, merged);
+      if (merged.is_sparse() == one.is_sparse())
+        ALGORITMI_CHECK(t, merged.estimate() == one.estimate());
+      else
+        ALGORITMI_CHECK(t, std::abs(merged.estimate() - truth) / std::max(1.0, truth) <=
+                               bound(merged));
+    }
+    // A dense counter absorbing a sparse one, and the reverse.
+    hyperloglog<std::uint64_t> small(p);
+    for (std::uint64_t i = 0; i < 3; ++i) small.add(~base - i);
+    hyperloglog<std::uint64_t> big = one;
+    big.merge(small);
+    small.merge(one);
+    // Each against the true count, within its own bound: merging into
+    // `small` can turn it dense even when `one` is still sparse.
+    double const want = truth + 3;
+    ALGORITMI_CHECK(t, std::abs(big.estimate() - want) / want <= bound(big) &&
+                           std::abs(small.estimate() - want) / want <= bound(small));
+  }
+
+  t.set_case("hyperloglog large");
+  hyperloglog<std::uint64_t> large;
+  for (std::uint64_t i = 0; i < 3000000; ++i) large.add(i);
+  ALGORITMI_CHECK(t, !large.is_sparse() && large.memory_bytes() == large.register_count());
+  ALGORITMI_CHECK(t, std::abs(large.estimate() / 3e6 - 1) < 0.035);
+  large.clear();
+  ALGORITMI_CHECK(t, large.is_sparse() && large.estimate() == 0);
+
+  t.set_case("hyperloglog errors");
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, hyperloglog<int>(3));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, hyperloglog<int>(19));
+  hyperloglog<int> p10(10), p12(12);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, p10.merge(p12));
+}
+
+ALGORITMI_TEST("filter/bloom", test_bloom);
+ALGORITMI_TEST("filter/xor", test_xor);
+ALGORITMI_TEST("filter/hyperloglog", test_hyperloglog);
+
+}  // namespace
+}  // namespace algoritmi::test
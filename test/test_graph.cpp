@@ -0,0 +1,382 @@
+// Graph algorithms against textbook versions on random graphs.
+//
+//   graph/csr_graph         adjacency against the edge list; transpose
+//   graph/bfs               depths against a queue BFS; parents are tree edges
+//   graph/shortest_paths    dijkstra and delta_stepping (seq, par) against
+//                           Bellman-Ford; shortest_path_tree
+//   graph/union_find        both versions against relabelling; concurrent
+//                           unions from several threads
+//   graph/components        connected_components (seq, par)
+//   graph/spanning_forest   kruskal, filter_kruskal, boruvka (seq, par)
+//                           against a sorted-edge Kruskal
+//
+// Graphs mix random edges with self-loops, parallel edges, long paths and
+// stars, and are sometimes large enough for the parallel and
+// direction-optimizing paths to kick in.
+#include <algoritmi/graph.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+struct random_graph {
+  std::size_t n = 0;
+  std::vector<weighted_edge<std::uint32_t>> edges;
+
+  std::vector<edge> unweighted() const {
+    std::vector<edge> out;
+    for (auto const& e : edges) out.push_back({e.from, e.to});
+    return out;
+  }
+  std::string label(char const* what) const {
+    return std::string(what) + " n=" + std::to_string(n) + " m=" + std::to_string(edges.size());
+  }
+};
+
+// Weights in [0, max_weight]; small maxima make many ties.
+random_graph make_graph(Rng& rng, bool large = false) {
+  random_graph g;
+  g.n = large ? 20000 + rng.below(40000) : 1 + rng.below(700);
+  std::size_t const m = large ? g.n * (2 + rng.below(10)) : rng.below(4 * g.n + 1);
+  std::uint32_t const max_weight = rng.coin() ? 10 : 1000000;
+  auto const vertex = [&] { return static_cast<vertex_id>(rng.below(g.n)); };
+  auto const weight = [&] { return static_cast<std::uint32_t>(rng.below(max_weight + 1)); };
+  switch (rng.below(4)) {
+    case 0:  // a long path, then random edges
+      for (std::size_t v = 1; v < g.n; ++v)
+        g.edges.push_back({static_cast<vertex_id>(v - 1), static_cast<vertex_id>(v), weight()});
+      break;
+    case 1:  // a star around a random hub
+      for (vertex_id hub = vertex(), v = 0; v < g.n; ++v) g.edges.push_back({hub, v, weight()});
+      break;
+    default:
+      break;
+  }
+  for (std::size_t i = 0; i < m; ++i) g.edges.push_back({vertex(), vertex(), weight()});
+  return g;
+}
+
+// Adjacency lists in edge order, optionally with reversed copies.
+std::vector<std::vector<std::pair<vertex_id, std::uint32_t>>> adjacency(random_graph const& g,
+                                                                         bool symmetric) {
+  std::vector<std::vector<std::pair<vertex_id, std::uint32_t>>> adj(g.n);
+  for (auto const& e : g.edges) {
+    adj[e.from].push_back({e.to, e.weight});
+    if (symmetric) adj[e.to].push_back({e.from, e.weight});
+  }
+  return adj;
+}
+
+void test_csr_graph(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    auto const g = make_graph(t.rng());
+    bool const symmetric = t.rng().coin();
+    csr_graph<std::uint32_t> const csr(g.n, span<weighted_edge<std::uint32_t> const>(g.edges),
+                                       symmetric);
+    auto const adj = adjacency(g, symmetric);
+    t.set_case(g.label(symmetric ? "csr_graph symmetric" : "csr_graph"));
+    bool ok = csr.num_vertices() == g.n && csr.weighted() && csr.symmetric() == symmetric;
+    std::size_t edges = 0;
+    for (vertex_id v = 0; ok && v < g.n; ++v) {
+      std::vector<std::pair<vertex_id, std::uint32_t>> got, expect = adj[v];
+      for (std::size_t k = 0; k < csr.degree(v); ++k)
+        got.push_back({csr.neighbors(v)[k], csr.weights(v)[k]});
+      std::sort(got.begin(), got.end());
+      std::sort(expect.begin(), expect.end());
+      ok = got == expect;
+      edges += got.size();
+    }
+    ALGORITMI_CHECK(t, ok && edges == csr.num_edges());
+
+    auto const tr = csr.transpose();
+    ok = tr.num_edges() == csr.num_edges();
+    std::vector<std::vector<std::pair<vertex_id, std::uint32_t>>> back(g.n);
+    for (vertex_id u = 0; u < g.n; ++u)
+      for (std::size_t k = 0; k < csr.degree(u); ++k)
+        back[csr.neighbors(u)[k]].push_back({u, csr.weights(u)[k]});
+    for (vertex_id v = 0; ok && v < g.n; ++v) {
+      std::vector<std::pair<vertex_id, std::uint32_t>> got;
+      for (std::size_t k = 0; k < tr.degree(v); ++k)
+        got.push_back({tr.neighbors(v)[k], tr.weights(v)[k]});
+      std::sort(got.begin(), got.end());
+      std::sort(back[v].begin(), back[v].end());
+      ok = got == back[v];
+    }
+    ALGORITMI_CHECK(t, ok);
+  }
+}
+
+std::vector<std::uint32_t> reference_bfs(random_graph const& g, bool symmetric, vertex_id s) {
+  auto const adj = adjacency(g, symmetric);
+  std::vector<std::uint32_t> depth(g.n, bfs_result::unreached);
+  std::queue<vertex_id> q;
+  depth[s] = 0;
+  q.push(s);
+  while (!q.empty()) {
+    vertex_id const u = q.front();
+    q.pop();
+    for (auto const& [v, w] : adj[u])
+      if (depth[v] == bfs_result::unreached) {
+        depth[v] = depth[u] + 1;
+        q.push(v);
+      }
+  }
+  return depth;
+}
+
+bool valid_bfs(csr_graph<std::uint32_t> const& csr, bfs_result const& r, vertex_id s,
+               std::vector<std::uint32_t> const& depth) {
+  if (!std::equal(depth.begin(), depth.end(), r.depth.begin(), r.depth.end())) return false;
+  for (vertex_id v = 0; v < csr.num_vertices(); ++v) {
+    vertex_id const p = r.parent[v];
+    if (depth[v] == bfs_result::unreached) {
+      if (p != no_vertex) return false;
+    } else if (v == s) {
+      if (p != s) return false;
+    } else {
+      auto const nbrs = csr.neighbors(p);
+      if (p >= csr.num_vertices() || depth[p] + 1 != depth[v] ||
+          std::find(nbrs.begin(), nbrs.end(), v) == nbrs.end())
+        return false;
+    }
+  }
+  return true;
+}
+
+void test_bfs(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(16); ++round) {
+    auto const g = make_graph(t.rng(), round % 4 == 3);
+    auto const edges = g.unweighted();
+    bool const symmetric = t.rng().coin();
+    csr_graph<std::uint32_t> const csr(g.n, span<edge const>(edges), symmetric);
+    auto const in = csr.transpose();
+    auto const s = static_cast<vertex_id>(t.rng().below(g.n));
+    auto const depth = reference_bfs(g, symmetric, s);
+    t.set_case(g.label(symmetric ? "bfs symmetric" : "bfs"));
+    ALGORITMI_CHECK(t, valid_bfs(csr, bfs(csr, s), s, depth));
+    ALGORITMI_CHECK(t, valid_bfs(csr, bfs(csr, in, s), s, depth));
+    ALGORITMI_CHECK(t, valid_bfs(csr, bfs(par, csr, s), s, depth));
+    ALGORITMI_CHECK(t, valid_bfs(csr, bfs(par, csr, in, s), s, depth));
+  }
+  csr_graph<std::uint32_t> const empty;
+  ALGORITMI_CHECK_THROWS(t, std::out_of_range, bfs(empty, 0));
+}
+
+template <class W>
+std::vector<distance_t<W>> bellman_ford(csr_graph<W> const& g, vertex_id s) {
+  std::vector<distance_t<W>> dist(g.num_vertices(), infinite_distance<W>());
+  dist[s] = 0;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (vertex_id u = 0; u < g.num_vertices(); ++u) {
+      if (dist[u] == infinite_distance<W>()) continue;
+      for (std::size_t k = 0; k < g.degree(u); ++k) {
+        auto const d = dist[u] + static_cast<distance_t<W>>(g.weights(u)[k]);
+        if (d < dist[g.neighbors(u)[k]]) {
+          dist[g.neighbors(u)[k]] = d;
+          changed = true;
+        }
+      }
+    }
+  }
+  return dist;
+}
+
+template <class W>
+bool valid_tree(csr_graph<W> const& g, std::vector<distance_t<W>> const& dist, vertex_id s) {
+  auto const parent = shortest_path_tree(g, span<distance_t<W> const>(dist), s);
+  for (vertex_id v = 0; v < g.num_vertices(); ++v) {
+    vertex_id const p = parent[v];
+    if (dist[v] == infinite_distance<W>() || v == s) {
+      if (p != (v == s ? s : no_vertex)) return false;
+      continue;
+    }
+    if (p == no_vertex) return false;
+    bool edge = false;
+    for (std::size_t k = 0; k < g.degree(p); ++k)
+      edge = edge || (g.neighbors(p)[k] == v &&
+                      dist[p] + static_cast<distance_t<W>>(g.weights(p)[k]) == dist[v]);
+    if (!edge) return false;
+    // The parent chain reaches s: zero-weight cycles must not close on
+    // themselves.
+    vertex_id u = v;
+    for (std::size_t steps = 0; u != s && steps < g.num_vertices(); ++steps) u = parent[u];
+    if (u != s) return false;
+  }
+  return true;
+}
+
+template <class W>
+void shortest_paths_case(Context& t, random_graph const& rg) {
+  // Integer-valued weights, so floating-point sums are exact too.
+  std::vector<weighted_edge<W>> edges;
+  for (auto const& e : rg.edges) edges.push_back({e.from, e.to, static_cast<W>(e.weight)});
+  csr_graph<W> const g(rg.n, span<weighted_edge<W> const>(edges), t.rng().coin());
+  auto const s = static_cast<vertex_id>(t.rng().below(rg.n));
+  auto const expect = bellman_ford(g, s);
+  auto const same = [&](auto const& got) {
+    return std::equal(got.begin(), got.end(), expect.begin(), expect.end());
+  };
+  t.set_case(rg.label((std::string("shortest paths ") + type_name<W>()).c_str()));
+  ALGORITMI_CHECK(t, same(dijkstra(g, s)));
+  ALGORITMI_CHECK(t, same(delta_stepping(g, s)));
+  ALGORITMI_CHECK(t, same(delta_stepping(par, g, s)));
+  ALGORITMI_CHECK(t, same(delta_stepping(par, g, s, distance_t<W>(1 + t.rng().below(100)))));
+  ALGORITMI_CHECK(t, valid_tree(g, expect, s));
+}
+
+void test_shortest_paths(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(12); ++round) {
+    auto const g = make_graph(t.rng(), round % 6 == 5);
+    shortest_paths_case<std::uint32_t>(t, g);
+    shortest_paths_case<std::uint8_t>(t, g);
+    shortest_paths_case<double>(t, g);
+  }
+  // Tight edges in both directions between 1 and 2, neither on a path
+  // from 0 until 3 is reached.
+  t.set_case("shortest path tree zero-weight cycle");
+  std::vector<weighted_edge<std::uint32_t>> const zero = {
+      {0, 3, 5}, {3, 2, 0}, {1, 2, 0}, {2, 1, 0}};
+  csr_graph<std::uint32_t> const cycle(4, span<weighted_edge<std::uint32_t> const>(zero));
+  ALGORITMI_CHECK(t, valid_tree(cycle, bellman_ford(cycle, 0), 0));
+
+  csr_graph<std::uint32_t> const unweighted(2, span<edge const>());
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, dijkstra(unweighted, 0));
+  std::vector<weighted_edge<int>> negative = {{0, 1, -1}};
+  csr_graph<int> const g(2, span<weighted_edge<int> const>(negative));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, delta_stepping(g, 0));
+}
+
+// Component labels by repeated relabelling: O(n m), obviously right.
+std::vector<vertex_id> reference_components(std::size_t n, std::vector<edge> const& edges) {
+  std::vector<vertex_id> label(n);
+  std::iota(label.begin(), label.end(), vertex_id{0});
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto const& e : edges) {
+      vertex_id const m = std::min(label[e.from], label[e.to]);
+      if (label[e.from] != m || label[e.to] != m) {
+        label[e.from] = label[e.to] = m;
+        changed = true;
+      }
+    }
+  }
+  return label;
+}
+
+void test_union_find(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    auto const g = make_graph(t.rng(), round % 5 == 4);
+    auto const edges = g.unweighted();
+    auto const label = reference_components(g.n, edges);
+    std::size_t const sets =
+        static_cast<std::size_t>(std::count_if(label.begin(), label.end(), [&, v = vertex_id{0}](
+                                                   vertex_id l) mutable { return l == v++; }));
+    t.set_case(g.label("union_find"));
+    union_find uf(g.n);
+    for (auto const& e : edges) uf.unite(e.from, e.to);
+    bool ok = uf.set_count() == sets;
+    for (std::size_t i = 0; ok && i < 1000; ++i) {
+      auto const a = static_cast<vertex_id>(t.rng().below(g.n));
+      auto const b = static_cast<vertex_id>(t.rng().below(g.n));
+      ok = uf.same(a, b) == (label[a] == label[b]);
+    }
+    ALGORITMI_CHECK(t, ok);
+
+    // Unions from four threads at once, then queries.
+    t.set_case(g.label("concurrent_union_find"));
+    concurrent_union_find cuf(g.n);
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> merges{0};
+    for (unsigned k = 0; k < 4; ++k)
+      threads.emplace_back([&, k] {
+        for (std::size_t i = k; i < edges.size(); i += 4)
+          if (cuf.unite(edges[i].from, edges[i].to)) merges.fetch_add(1);
+      });
+    for (auto& th : threads) th.join();
+    ok = merges.load() == g.n - sets;
+    for (vertex_id v = 0; ok && v < g.n; ++v) ok = cuf.same(v, label[v]);
+    ALGORITMI_CHECK(t, ok);
+  }
+}
+
+void test_components(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    auto const g = make_graph(t.rng(), round % 5 == 4);
+    auto const edges = g.unweighted();
+    auto const expect = reference_components(g.n, edges);
+    auto const same = [&](auto const& got) {
+      return std::equal(got.begin(), got.end(), expect.begin(), expect.end());
+    };
+    t.set_case(g.label("connected_components"));
+    ALGORITMI_CHECK(t, same(connected_components(g.n, span<edge const>(edges))));
+    ALGORITMI_CHECK(t, same(connected_components(par, g.n, span<edge const>(edges))));
+  }
+  std::vector<edge> bad = {{0, 5}};
+  ALGORITMI_CHECK_THROWS(t, std::out_of_range, connected_components(2, span<edge const>(bad)));
+}
+
+// Kruskal over a stable sort by weight: ties go to the lower edge index,
+// which the library's forests follow too, so the forest is unique.
+std::vector<edge_index> reference_forest(random_graph const& g) {
+  std::vector<edge_index> order(g.edges.size());
+  std::iota(order.begin(), order.end(), edge_index{0});
+  std::stable_sort(order.begin(), order.end(), [&](edge_index a, edge_index b) {
+    return g.edges[a].weight < g.edges[b].weight;
+  });
+  auto label = std::vector<vertex_id>(g.n);
+  std::iota(label.begin(), label.end(), vertex_id{0});
+  auto find = [&](vertex_id x) {
+    while (label[x] != x) x = label[x] = label[label[x]];
+    return x;
+  };
+  std::vector<edge_index> forest;
+  for (edge_index i : order) {
+    vertex_id const a = find(g.edges[i].from), b = find(g.edges[i].to);
+    if (a == b) continue;
+    label[a] = b;
+    forest.push_back(i);
+  }
+  std::sort(forest.begin(), forest.end());
+  return forest;
+}
+
+void test_spanning_forest(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(16); ++round) {
+    auto const g = make_graph(t.rng(), round % 4 == 3);
+    auto const expect = reference_forest(g);
+    auto const same = [&](auto got) {
+      std::sort(got.begin(), got.end());
+      return std::equal(got.begin(), got.end(), expect.begin(), expect.end());
+    };
+    auto const* e = g.edges.data();
+    std::size_t const m = g.edges.size();
+    t.set_case(g.label("spanning forest"));
+    ALGORITMI_CHECK(t, same(kruskal(g.n, e, m)));
+    ALGORITMI_CHECK(t, same(filter_kruskal(g.n, e, m)));
+    ALGORITMI_CHECK(t, same(filter_kruskal(par, g.n, e, m)));
+    ALGORITMI_CHECK(t, same(boruvka(g.n, e, m)));
+    ALGORITMI_CHECK(t, same(boruvka(par, g.n, e, m)));
+  }
+}
+
+ALGORITMI_TEST("graph/csr_graph", test_csr_graph);
+ALGORITMI_TEST("graph/bfs", test_bfs);
+ALGORITMI_TEST("graph/shortest_paths", test_shortest_paths);
+ALGORITMI_TEST("graph/union_find", test_union_find);
+ALGORITMI_TEST("graph/components", test_components);
+ALGORITMI_TEST("graph/spanning_forest", test_spanning_forest);
+
+}  // namespace
+}  // namespace algoritmi::test
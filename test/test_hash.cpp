@@ -0,0 +1,268 @@
+// Hash containers against std::unordered_map and std::unordered_set driven
+// by the same random operation sequence.
+//
+//   hash/flat_hash_map    every mutator, lookups, copies, rehashing
+//   hash/flat_hash_set
+//   hash/node_hash_map    as above, plus reference stability
+//   hash/node_hash_set
+//   hash/heterogeneous    string_view and char const* lookups on string keys
+//
+// Keys come from a small range so that hits, misses, and erase-then-insert
+// on tombstones all happen often. A deliberately poor hasher piles
+// everything into a few probe groups.
+#include <algoritmi/hash.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// Only 32 distinct hashes: long probe sequences and many equal H2 bytes.
+struct poor_hash {
+  std::size_t operator()(std::uint64_t x) const noexcept {
+    return (x % 32) * 0x9e3779b97f4a7c15ULL;
+  }
+};
+
+template <class K>
+K make_key(Rng& rng, std::uint64_t range) {
+  std::uint64_t const r = rng.below(range);
+  if constexpr (std::is_same_v<K, std::string>)
+    return "key-" + std::to_string(r) + (r % 3 ? "" : "-with-a-longer-tail");
+  else
+    return static_cast<K>(r);
+}
+
+template <class Map, class Ref>
+bool same_contents(Map const& map, Ref const& ref) {
+  if (map.size() != ref.size() || map.empty() != ref.empty()) return false;
+  std::size_t n = 0;
+  for (auto const& x : map) {
+    ++n;
+    if constexpr (std::is_same_v<typename Map::key_type, typename Map::value_type>) {
+      if (!ref.count(x)) return false;
+    } else {
+      auto const it = ref.find(x.first);
+      if (it == ref.end() || !(it->second == x.second)) return false;
+    }
+  }
+  return n == ref.size();
+}
+
+template <class Map, class Ref>
+void map_case(Context& t, char const* what) {
+  using K = typename Map::key_type;
+  std::size_t const ops = random_size(t.rng(), 40000);
+  std::uint64_t const range = 1 + t.rng().below(2 * ops + 1);
+  Map map;
+  Ref ref;
+  t.set_case(std::string(what) + ' ' + type_name<K>() + " ops=" + std::to_string(ops) +
+             " range=" + std::to_string(range));
+  bool ok = true;
+  for (std::size_t op = 0; ok && op < ops; ++op) {
+    K const key = make_key<K>(t.rng(), range);
+    auto const value = static_cast<std::uint32_t>(t.rng().next());
+    switch (t.rng().below(12)) {
+      case 0: {
+        auto const a = map.insert({key, value});
+        auto const b = ref.insert({key, value});
+        ok = a.second == b.second && a.first->second == b.first->second;
+        break;
+      }
+      case 1: {
+        auto const a = map.emplace(key, value);
+        auto const b = ref.emplace(key, value);
+        ok = a.second == b.second && a.first->first == key;
+        break;
+      }
+      case 2:
+        ok = map.try_emplace(key, value).second == ref.try_emplace(key, value).second;
+        break;
+      case 3:
+        ok = map.insert_or_assign(key, value).second == ref.insert_or_assign(key, value).second;
+        break;
+      case 4:
+        map[key] += value;
+        ref[key] += value;
+        break;
+      case 5:
+      case 6:
+        ok = map.erase(key) == ref.erase(key);
+        break;
+      case 7: {
+        auto const it = map.find(key);
+        ok = (it == map.end()) == (ref.find(key) == ref.end());
+        if (ok && it != map.end()) {
+          map.erase(it);
+          ref.erase(key);
+        }
+        break;
+      }
+      case 8:
+        ok = map.count(key) == ref.count(key) && map.contains(key) == (ref.count(key) != 0);
+        if (ref.count(key))
+          ok = ok && map.at(key) == ref.at(key);
+        else
+          ALGORITMI_CHECK_THROWS(t, std::out_of_range, map.at(key));
+        break;
+      case 9:
+        if (t.rng().below(64) == 0) {
+          map.rehash(t.rng().below(2 * map.size() + 2));
+        } else if (t.rng().below(64) == 0) {
+          Map copy(map);
+          ok = copy == map && same_contents(copy, ref);
+          map = std::move(copy);
+        } else if (t.rng().below(256) == 0) {
+          map.clear();
+          ref.clear();
+        }
+        break;
+      default: {
+        auto const it = map.find(key);
+        auto const r = ref.find(key);
+        ok = (it == map.end()) == (r == ref.end()) && (r == ref.end() || it->second == r->second);
+        break;
+      }
+    }
+    ok = ok && map.size() == ref.size();
+  }
+  ALGORITMI_CHECK(t, ok && same_contents(map, ref));
+}
+
+template <class Set, class Ref>
+void set_case(Context& t, char const* what) {
+  using K = typename Set::key_type;
+  std::size_t const ops = random_size(t.rng(), 40000);
+  std::uint64_t const range = 1 + t.rng().below(2 * ops + 1);
+  Set set;
+  Ref ref;
+  t.set_case(std::string(what) + ' ' + type_name<K>() + " ops=" + std::to_string(ops) +
+             " range=" + std::to_string(range));
+  bool ok = true;
+  for (std::size_t op = 0; ok && op < ops; ++op) {
+    K const key = make_key<K>(t.rng(), range);
+    switch (t.rng().below(6)) {
+      case 0:
+      case 1:
+        ok = set.insert(key).second == ref.insert(key).second;
+        break;
+      case 2:
+        ok = set.erase(key) == ref.erase(key);
+        break;
+      case 3:
+        if (t.rng().below(64) == 0) {
+          Set const copy(set);
+          ok = copy == set;
+        } else if (t.rng().below(64) == 0) {
+          set.reserve(t.rng().below(4 * set.size() + 2));
+        }
+        break;
+      default:
+        ok = set.contains(key) == (ref.count(key) != 0);
+        break;
+    }
+    ok = ok && set.size() == ref.size();
+  }
+  ALGORITMI_CHECK(t, ok && same_contents(set, ref));
+}
+
+void test_flat_hash_map(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    map_case<flat_hash_map<std::uint64_t, std::uint32_t>,
+             std::unordered_map<std::uint64_t, std::uint32_t>>(t, "flat_hash_map");
+    map_case<flat_hash_map<std::uint32_t, std::uint32_t>,
+             std::unordered_map<std::uint32_t, std::uint32_t>>(t, "flat_hash_map");
+    map_case<flat_hash_map<std::string, std::uint32_t>,
+             std::unordered_map<std::string, std::uint32_t>>(t, "flat_hash_map");
+    map_case<flat_hash_map<std::uint64_t, std::uint32_t, poor_hash>,
+             std::unordered_map<std::uint64_t, std::uint32_t>>(t, "flat_hash_map poor_hash");
+  }
+}
+
+void test_flat_hash_set(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    set_case<flat_hash_set<std::uint64_t>, std::unordered_set<std::uint64_t>>(t, "flat_hash_set");
+    set_case<flat_hash_set<std::string>, std::unordered_set<std::string>>(t, "flat_hash_set");
+    set_case<flat_hash_set<std::uint64_t, poor_hash>, std::unordered_set<std::uint64_t>>(
+        t, "flat_hash_set poor_hash");
+  }
+}
+
+void test_node_hash_map(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    map_case<node_hash_map<std::uint64_t, std::uint32_t>,
+             std::unordered_map<std::uint64_t, std::uint32_t>>(t, "node_hash_map");
+    map_case<node_hash_map<std::string, std::uint32_t>,
+             std::unordered_map<std::string, std::uint32_t>>(t, "node_hash_map");
+  }
+  // Addresses survive any amount of growth.
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const n = random_size(t.rng(), 100000);
+    node_hash_map<std::uint64_t, std::uint64_t> map;
+    std::vector<std::pair<std::uint64_t, std::uint64_t const*>> seen;
+    t.set_case("node_hash_map stability n=" + std::to_string(n));
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uint64_t const key = t.rng().next();
+      auto const it = map.try_emplace(key, key ^ 1).first;
+      if (i % 7 == 0) seen.push_back({key, &it->second});
+    }
+    bool ok = true;
+    for (auto const& [key, address] : seen)
+      ok = ok && &map.at(key) == address && *address == (key ^ 1);
+    ALGORITMI_CHECK(t, ok);
+  }
+}
+
+void test_node_hash_set(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    set_case<node_hash_set<std::uint64_t>, std::unordered_set<std::uint64_t>>(t, "node_hash_set");
+    set_case<node_hash_set<std::string>, std::unordered_set<std::string>>(t, "node_hash_set");
+  }
+}
+
+void test_heterogeneous(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(10); ++round) {
+    std::size_t const n = random_size(t.rng(), 5000);
+    flat_hash_map<std::string, std::size_t> flat;
+    node_hash_set<std::string> node;
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < n; ++i) {
+      keys.push_back(make_key<std::string>(t.rng(), 4 * n + 1));
+      flat.try_emplace(keys.back(), keys.back().size());
+      node.insert(keys.back());
+    }
+    t.set_case("heterogeneous n=" + std::to_string(n));
+    bool ok = true;
+    for (std::size_t i = 0; ok && i < 256; ++i) {
+      std::string const key = make_key<std::string>(t.rng(), 4 * n + 1);
+      bool const present = std::find(keys.begin(), keys.end(), key) != keys.end();
+      std::string_view const view = key;
+      auto const it = flat.find(view);
+      ok = (it != flat.end()) == present && (!present || it->second == key.size()) &&
+           flat.contains(key.c_str()) == present && node.contains(view) == present &&
+           node.count(key.c_str()) == std::size_t{present};
+    }
+    ALGORITMI_CHECK(t, ok);
+  }
+}
+
+ALGORITMI_TEST("hash/flat_hash_map", test_flat_hash_map);
+ALGORITMI_TEST("hash/flat_hash_set", test_flat_hash_set);
+ALGORITMI_TEST("hash/node_hash_map", test_node_hash_map);
+ALGORITMI_TEST("hash/node_hash_set", test_node_hash_set);
+ALGORITMI_TEST("hash/heterogeneous", test_heterogeneous);
+
+}  // namespace
+}  // namespace algoritmi::test
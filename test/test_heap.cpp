@@ -0,0 +1,240 @@
+// Heaps against std::multiset driven by the same random operation sequence.
+//
+//   heap/dary_heap      push, pop, replace_top, bulk construction; D = 2, 4, 8;
+//                       a copy that throws partway
+//   heap/radix_heap     monotone push/pop, keys at the bucket boundaries
+//   heap/pairing_heap   handles: decrease_key, update, erase, merge
+#include <algoritmi/heap.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// Counts live instances; a copy throws once copies_left reaches zero.
+struct fragile {
+  static inline int live = 0;
+  static inline int copies_left = -1;
+  int value;
+
+  explicit fragile(int v) : value(v) { ++live; }
+  fragile(fragile const& other) : value(other.value) {
+    if (copies_left == 0) throw std::runtime_error("fragile: copy");
+    --copies_left;
+    ++live;
+  }
+  fragile(fragile&& other) noexcept : value(other.value) { ++live; }
+  fragile& operator=(fragile const&) = default;
+  fragile& operator=(fragile&&) noexcept = default;
+  ~fragile() { --live; }
+  bool operator<(fragile const& other) const noexcept { return value < other.value; }
+};
+
+// new_delete_resource() that counts the blocks it has out.
+class tracking_resource : public std::pmr::memory_resource {
+ public:
+  std::size_t outstanding = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, align);
+    ++outstanding;
+    return p;
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    --outstanding;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+template <class T, std::size_t D, class Compare>
+void dary_case(Context& t, shape s) {
+  std::size_t const n = random_size(t.rng(), 5000);
+  auto const init = make_input<T>(s, n, t.rng());
+  dary_heap<T, D, Compare> heap(init.begin(), init.end());
+  std::multiset<T, Compare> ref(init.begin(), init.end());
+  t.set_case(describe<T>(("dary_heap D=" + std::to_string(D)).c_str(), s, n));
+  bool ok = heap.size() == ref.size();
+  for (std::size_t op = 0; ok && op < 4 * n + 16; ++op) {
+    std::uint64_t const r = t.rng().below(10);
+    if (r < 4) {
+      T const x = random_value<T>(t.rng());
+      heap.push(x);
+      ref.insert(x);
+    } else if (ref.empty()) {
+      continue;
+    } else if (r < 8) {
+      ok = heap.top() == *ref.begin() && heap.pop() == *ref.begin();
+      ref.erase(ref.begin());
+    } else {
+      T const x = random_value<T>(t.rng());
+      ok = heap.replace_top(x) == *ref.begin();
+      ref.erase(ref.begin());
+      ref.insert(x);
+    }
+    ok = ok && heap.size() == ref.size();
+  }
+  while (ok && !ref.empty()) {
+    ok = heap.pop() == *ref.begin();
+    ref.erase(ref.begin());
+  }
+  ALGORITMI_CHECK(t, ok && heap.empty());
+}
+
+void test_dary_heap(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(3); ++round) {
+    for (shape s : all_shapes) {
+      dary_case<std::int32_t, 2, std::less<>>(t, s);
+      dary_case<std::uint64_t, 4, std::less<>>(t, s);
+      dary_case<double, 8, std::greater<>>(t, s);
+      dary_case<std::string, 4, std::less<>>(t, s);
+    }
+  }
+
+  // A copy that throws partway leaks neither elements nor the buffer.
+  t.set_case("dary_heap copy throws");
+  {
+    tracking_resource mr;
+    {
+      using heap_type = dary_heap<fragile, 4, std::less<>>;
+      heap_type heap(&mr);
+      for (int i = 0; i < 100; ++i) heap.emplace(i);
+      fragile::copies_left = 40;
+      ALGORITMI_CHECK_THROWS(t, std::runtime_error, heap_type{heap});
+      fragile::copies_left = -1;
+      ALGORITMI_CHECK(t, fragile::live == 100 && mr.outstanding == 1);
+    }
+    ALGORITMI_CHECK(t, fragile::live == 0 && mr.outstanding == 0);
+  }
+}
+
+template <class Key>
+void radix_case(Context& t) {
+  radix_heap<Key, std::uint32_t> heap;
+  std::multiset<std::pair<Key, std::uint32_t>> ref;
+  std::size_t const ops = random_size(t.rng(), 20000);
+  t.set_case(std::string("radix_heap ") + type_name<Key>() + " ops=" + std::to_string(ops));
+  bool ok = true;
+  for (std::size_t op = 0; ok && op < ops; ++op) {
+    if (ref.empty() || t.rng().below(3) != 0) {
+      // Keys at or just above the last minimum, or anywhere above it, or at
+      // the extremes, so every bucket and the top one are used.
+      Key const last = heap.last_min();
+      Key const room = static_cast<Key>(std::numeric_limits<Key>::max() - last);
+      Key key;
+      switch (t.rng().below(4)) {
+        case 0: key = last; break;
+        case 1:
+          key = static_cast<Key>(last + t.rng().below(std::min<std::uint64_t>(room, 64) + 1));
+          break;
+        case 2: key = std::numeric_limits<Key>::max(); break;
+        default: key = static_cast<Key>(last + t.rng().between(0, room)); break;
+      }
+      auto const id = static_cast<std::uint32_t>(op);
+      heap.push(key, id);
+      ref.insert({key, id});
+    } else {
+      auto const top = heap.pop();
+      // Equal keys may come out in any order.
+      auto const it = ref.find(top);
+      ok = top.first == ref.begin()->first && it != ref.end();
+      if (ok) ref.erase(it);
+    }
+    ok = ok && heap.size() == ref.size();
+  }
+  ALGORITMI_CHECK(t, ok);
+}
+
+void test_radix_heap(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(10); ++round) {
+    radix_case<std::uint8_t>(t);
+    radix_case<std::uint32_t>(t);
+    radix_case<std::uint64_t>(t);
+  }
+}
+
+void test_pairing_heap(Context& t) {
+  using heap_t = pairing_heap<std::pair<std::int64_t, std::uint32_t>>;
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    std::size_t const ops = random_size(t.rng(), 20000);
+    heap_t heaps[2];
+    std::set<std::pair<std::int64_t, std::uint32_t>> refs[2];
+    std::vector<heap_t::handle> handles;  // by id; empty once popped or erased
+    t.set_case("pairing_heap ops=" + std::to_string(ops));
+    bool ok = true;
+    auto const value = [](std::int64_t key, std::uint32_t id) { return std::make_pair(key, id); };
+    for (std::size_t op = 0; ok && op < ops; ++op) {
+      int const h = static_cast<int>(t.rng().below(2));
+      auto& heap = heaps[h];
+      auto& ref = refs[h];
+      std::uint64_t const r = t.rng().below(16);
+      // A live element of heap h, if any.
+      std::uint32_t victim = ~0u;
+      if (!ref.empty()) {
+        auto const key = static_cast<std::int64_t>(t.rng().below(2000)) - 1000;
+        auto it = ref.lower_bound(value(key, 0));
+        if (it == ref.end()) it = ref.begin();
+        victim = it->second;
+      }
+      if (r < 6 || ref.empty()) {
+        auto const id = static_cast<std::uint32_t>(handles.size());
+        auto const v = value(static_cast<std::int64_t>(t.rng().below(2000)) - 1000, id);
+        handles.push_back(heap.push(v));
+        ref.insert(v);
+      } else if (r < 9) {
+        auto const top = heap.pop();
+        ok = top == *ref.begin();
+        ref.erase(ref.begin());
+        handles[top.second] = {};
+      } else if (r < 11) {
+        auto const old = handles[victim].value();
+        auto const v = value(old.first - static_cast<std::int64_t>(t.rng().below(500)), victim);
+        heap.decrease_key(handles[victim], v);
+        ref.erase(old);
+        ref.insert(v);
+      } else if (r < 13) {
+        auto const old = handles[victim].value();
+        auto const v = value(static_cast<std::int64_t>(t.rng().below(2000)) - 1000, victim);
+        heap.update(handles[victim], v);
+        ref.erase(old);
+        ref.insert(v);
+      } else if (r < 15) {
+        ref.erase(handles[victim].value());
+        heap.erase(handles[victim]);
+        handles[victim] = {};
+      } else {
+        heaps[0].merge(heaps[1]);
+        refs[0].insert(refs[1].begin(), refs[1].end());
+        refs[1].clear();
+        ok = heaps[1].empty();
+      }
+      for (int k = 0; k < 2; ++k) {
+        ok = ok && heaps[k].size() == refs[k].size();
+        ok = ok && (refs[k].empty() || heaps[k].top() == *refs[k].begin());
+      }
+    }
+    ALGORITMI_CHECK(t, ok);
+  }
+}
+
+ALGORITMI_TEST("heap/dary_heap", test_dary_heap);
+ALGORITMI_TEST("heap/radix_heap", test_radix_heap);
+ALGORITMI_TEST("heap/pairing_heap", test_pairing_heap);
+
+}  // namespace
+}  // namespace algoritmi::test
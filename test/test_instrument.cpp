@@ -0,0 +1,157 @@
+// Instrumentation: the counters count exactly what they claim, from every
+// thread, and cost nothing when compiled out.
+//
+//   instrument/comparisons  comparator calls of pdqsort against the calls
+//                           the comparator saw itself
+//   instrument/events       swaps, hash probes and Dijkstra relaxations
+//                           against what the inputs imply
+//   instrument/threads      counts from threads that are running and that
+//                           have exited both reach read_counters()
+//   instrument/perf         hardware counters either work or report missing
+//
+// Default builds check that every counter stays at zero; the
+// algoritmi_test_instrument target builds the same checks with
+// ALGORITMI_INSTRUMENT=1.
+#include <algoritmi/instrument.hpp>
+
+#include <algoritmi/graph.hpp>
+#include <algoritmi/hash.hpp>
+#include <algoritmi/sort.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// A comparator the kernel selection does not recognise, so every
+// comparison goes through it.
+struct counting_less {
+  std::uint64_t* calls;
+  bool operator()(std::uint64_t a, std::uint64_t b) const {
+    ++*calls;
+    return a < b;
+  }
+};
+
+std::uint64_t expected(std::uint64_t count) { return instrumentation_enabled ? count : 0; }
+
+void test_comparisons(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(30); ++round) {
+    shape const s = all_shapes[round % std::size(all_shapes)];
+    std::size_t const n = random_size(t.rng(), 100000);
+    auto v = make_input<std::uint64_t>(s, n, t.rng());
+    t.set_case(describe<std::uint64_t>("pdqsort counting_less", s, n));
+    std::uint64_t calls = 0;
+    counter_snapshot const before = read_counters();
+    pdqsort(v.begin(), v.end(), counting_less{&calls});
+    counter_snapshot const d = read_counters() - before;
+    ALGORITMI_CHECK(t, d[counter::comparisons] == expected(calls));
+    ALGORITMI_CHECK(t, d[counter::probes] == 0 && d[counter::relaxations] == 0);
+  }
+}
+
+void test_events(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    std::size_t const n = 1000 + random_size(t.rng(), 100000);
+    t.set_case("events n=" + std::to_string(n));
+
+    // A reversed input has to be rearranged by swaps.
+    auto v = make_input<std::uint32_t>(shape::reversed, n, t.rng());
+    counter_snapshot before = read_counters();
+    pdqsort(v.begin(), v.end());
+    counter_snapshot d = read_counters() - before;
+    ALGORITMI_CHECK(t, instrumentation_enabled ? d[counter::swaps] > 0 : d[counter::swaps] == 0);
+
+    // Every insert and every lookup inspects at least one group.
+    flat_hash_map<std::uint64_t, std::uint64_t> map;
+    before = read_counters();
+    for (std::size_t i = 0; i < n; ++i) map.insert_or_assign(t.rng().next(), i);
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < n; ++i) found += map.contains(t.rng().next());
+    d = read_counters() - before;
+    ALGORITMI_CHECK(t, found < n);
+    ALGORITMI_CHECK(t, instrumentation_enabled ? d[counter::probes] >= 2 * n
+                                               : d[counter::probes] == 0);
+
+    // Dijkstra scans each reachable vertex's edges exactly once.
+    std::size_t const vertices = 1 + n / 8;
+    std::vector<weighted_edge<std::uint32_t>> edges;
+    for (std::size_t i = 0; i < n; ++i)
+      edges.push_back({static_cast<vertex_id>(t.rng().below(vertices)),
+                       static_cast<vertex_id>(t.rng().below(vertices)),
+                       static_cast<std::uint32_t>(t.rng().below(1000))});
+    csr_graph<std::uint32_t> const g(vertices, span<weighted_edge<std::uint32_t> const>(edges));
+    before = read_counters();
+    auto const dist = dijkstra(g, 0);
+    d = read_counters() - before;
+    std::uint64_t reachable_edges = 0;
+    for (vertex_id u = 0; u < vertices; ++u)
+      if (dist[u] != infinite_distance<std::uint32_t>()) reachable_edges += g.neighbors(u).size();
+    ALGORITMI_CHECK(t, d[counter::relaxations] == expected(reachable_edges));
+  }
+}
+
+void test_threads(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(10); ++round) {
+    std::size_t const threads = 1 + t.rng().below(4);
+    t.set_case("threads=" + std::to_string(threads));
+    std::vector<std::uint64_t> calls(threads);
+    std::vector<std::vector<std::uint64_t>> inputs;
+    for (std::size_t k = 0; k < threads; ++k)
+      inputs.push_back(make_input<std::uint64_t>(shape::random, random_size(t.rng(), 20000),
+                                                 t.rng()));
+    counter_snapshot const before = read_counters();
+    // Half the threads are still alive when the counters are read.
+    std::atomic<std::size_t> done{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> pool;
+    for (std::size_t k = 0; k < threads; ++k)
+      pool.emplace_back([&, k] {
+        pdqsort(inputs[k].begin(), inputs[k].end(), counting_less{&calls[k]});
+        done.fetch_add(1);
+        if (k % 2)
+          while (!release.load()) std::this_thread::yield();
+      });
+    while (done.load() < threads) std::this_thread::yield();
+    for (std::size_t k = 0; k < threads; k += 2) pool[k].join();
+    counter_snapshot const d = read_counters() - before;
+    release.store(true);
+    for (std::size_t k = 1; k < threads; k += 2) pool[k].join();
+    std::uint64_t total = 0;
+    for (std::uint64_t c : calls) total += c;
+    ALGORITMI_CHECK(t, d[counter::comparisons] == expected(total));
+  }
+}
+
+void test_perf(Context& t) {
+  perf_counters hw;
+  t.set_case(std::string("perf available=") + (hw.available() ? "yes" : "no"));
+  ALGORITMI_CHECK(t, instrumentation_enabled || !hw.available());
+  std::vector<std::uint64_t> v = make_input<std::uint64_t>(shape::random, 100000, t.rng());
+  std::uint64_t calls = 0;
+  call_profile const p = profile(hw, [&] { pdqsort(v.begin(), v.end(), counting_less{&calls}); });
+  ALGORITMI_CHECK(t, calls > 0 && p.events[counter::comparisons] == expected(calls));
+  for (std::size_t i = 0; i < hw_event_count; ++i) {
+    auto const e = static_cast<hw_event>(i);
+    ALGORITMI_CHECK(t, p.hardware.has(e) == hw.available(e));
+    if (p.hardware.has(e) && e == hw_event::instructions)
+      ALGORITMI_CHECK(t, p.hardware[e] >= calls);  // at least one per call
+    if (!p.hardware.has(e)) ALGORITMI_CHECK(t, p.hardware[e] == 0);
+  }
+}
+
+ALGORITMI_TEST("instrument/comparisons", test_comparisons);
+ALGORITMI_TEST("instrument/events", test_events);
+ALGORITMI_TEST("instrument/threads", test_threads);
+ALGORITMI_TEST("instrument/perf", test_perf);
+
+}  // namespace
+}  // namespace algoritmi::test
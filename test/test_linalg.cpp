@@ -0,0 +1,270 @@
+// Matrix kernels against the textbook triple loop.
+//
+//   linalg/gemm         float and double, sizes on both sides of the
+//                       register tile and cache blocks, strided views,
+//                       alpha and beta (beta = 0 over NaNs), every
+//                       instruction set and par; argument errors
+//   linalg/strassen     odd sizes at small cutoffs, multiply() on both
+//                       sides of strassen_cutoff, par
+//   linalg/transpose    several element types, views inside larger
+//                       matrices, par
+#include <algoritmi/linalg.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+template <class T>
+char const* type_name() {
+  return sizeof(T) == 8 ? "f64" : "f32";
+}
+
+template <class T>
+void fill_random(Rng& rng, matrix_view<T> m) {
+  for (std::size_t i = 0; i < m.rows(); ++i)
+    for (std::size_t j = 0; j < m.cols(); ++j) m(i, j) = static_cast<T>(2 * rng.uniform() - 1);
+}
+
+// A rows x cols view at a random offset inside a larger random matrix.
+template <class T>
+matrix_view<T> embedded(Rng& rng, matrix<T>& storage, std::size_t rows, std::size_t cols) {
+  std::size_t const top = rng.below(3), left = rng.below(3);
+  storage = matrix<T>(rows + top + rng.below(3), cols + left + rng.below(3));
+  fill_random(rng, storage.view());
+  return storage.view().block(top, left, rows, cols);
+}
+
+// alpha * a * b + beta * c in long double, and the bound on the rounding
+// error of computing it in T: k + 2 roundings of each |term|.
+template <class T>
+void reference(T alpha, matrix_view<T const> a, matrix_view<T const> b, T beta,
+               matrix_view<T const> c, std::vector<long double>& want,
+               std::vector<long double>& bound) {
+  std::size_t const m = c.rows(), n = c.cols(), k = a.cols();
+  long double const eps = std::numeric_limits<T>::epsilon();
+  want.assign(m * n, 0);
+  bound.assign(m * n, 0);
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < n; ++j) {
+      long double s = 0, abs = 0;
+      for (std::size_t p = 0; p < k; ++p) {
+        long double const x = static_cast<long double>(a(i, p)) * b(p, j);
+        s += x;
+        abs += std::fabs(x);
+      }
+      long double const old = beta == 0 ? 0 : static_cast<long double>(beta) * c(i, j);
+      want[i * n + j] = alpha * s + old;
+      bound[i * n + j] = (k + 2) * eps * (std::fabs(alpha) * abs + std::fabs(old)) + 1e-30L;
+    }
+}
+
+template <class T>
+bool close(matrix_view<T const> c, std::vector<long double> const& want,
+           std::vector<long double> const& bound, long double slack = 1) {
+  for (std::size_t i = 0; i < c.rows(); ++i)
+    for (std::size_t j = 0; j < c.cols(); ++j) {
+      long double const d = std::fabs(c(i, j) - want[i * c.cols() + j]);
+      if (!(d <= slack * bound[i * c.cols() + j])) return false;
+    }
+  return true;
+}
+
+template <class T>
+void gemm_case(Context& t, std::size_t m, std::size_t n, std::size_t k) {
+  Rng& rng = t.rng();
+  matrix<T> sa, sb, sc;
+  auto const a = embedded(rng, sa, m, k);
+  auto const b = embedded(rng, sb, k, n);
+  auto const c0 = embedded(rng, sc, m, n);
+  T const alpha = rng.coin() ? T{1} : static_cast<T>(4 * rng.uniform() - 2);
+  T const beta = static_cast<T>(rng.below(3)) - T{1} + (rng.coin() ? T{0} : T{0.5});
+  // beta == 0 must not read C.
+  if (beta == 0 && m && n) c0(rng.below(m), rng.below(n)) = std::numeric_limits<T>::quiet_NaN();
+  std::vector<long double> want, bound;
+  reference<T>(alpha, a, b, beta, c0, want, bound);
+  std::string const label = std::string("gemm ") + type_name<T>() + " " + std::to_string(m) +
+                            "x" + std::to_string(k) + "x" + std::to_string(n) +
+                            " alpha=" + std::to_string(alpha) + " beta=" + std::to_string(beta);
+
+  matrix<T> c(m, n);
+  auto const reset = [&] {
+    for (std::size_t i = 0; i < m; ++i) std::copy(c0.row(i), c0.row(i) + n, c.row(i));
+  };
+  t.set_case(label);
+  reset();
+  gemm(alpha, a, b, beta, c);
+  ALGORITMI_CHECK(t, close<T>(c, want, bound));
+  for (isa which : host_isas()) {
+    t.set_case(label + " " + to_string(which));
+    reset();
+    gemm(which, alpha, a, b, beta, c);
+    ALGORITMI_CHECK(t, close<T>(c, want, bound));
+  }
+  t.set_case(label + " par");
+  reset();
+  gemm(par, alpha, a, b, beta, c.view());
+  ALGORITMI_CHECK(t, close<T>(c, want, bound));
+}
+
+void test_gemm(Context& t) {
+  // The edges of the register tile and of the cache blocks, then random.
+  std::size_t const dims[][3] = {{0, 0, 0}, {0, 5, 3}, {4, 0, 3}, {3, 4, 0}, {1, 1, 1},
+                                 {6, 8, 1}, {6, 16, 7}, {7, 17, 256}, {73, 9, 257},
+                                 {145, 33, 100}};
+  for (auto const& d : dims) {
+    gemm_case<double>(t, d[0], d[1], d[2]);
+    gemm_case<float>(t, d[0], d[1], d[2]);
+  }
+  for (std::size_t round = 0; round < t.rounds(12); ++round) {
+    std::size_t const m = 1 + t.rng().below(160), n = 1 + t.rng().below(160);
+    std::size_t const k = 1 + t.rng().below(600);
+    gemm_case<double>(t, m, n, k);
+    gemm_case<float>(t, m, n, k);
+  }
+  // Large enough for the parallel overload to split rows and pack B in
+  // parallel; B wider than one nc panel.
+  gemm_case<double>(t, 300, 4100, 3);
+  gemm_case<float>(t, 400, 300, 300);
+
+  t.set_case("gemm errors");
+  matrix<double> a(3, 4), b(5, 2), c(3, 2);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, gemm(1.0, a, b, 0.0, c));
+  matrix<double> b2(4, 2), c2(2, 2);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, gemm(par, 1.0, a, b2, 0.0, c2));
+}
+
+// Strassen's rounding error is bounded normwise, not elementwise, and
+// grows with the depth of the recursion; entries are in [-1, 1].
+template <class T>
+void strassen_case(Context& t, std::size_t m, std::size_t k, std::size_t n, std::size_t cutoff) {
+  matrix<T> a(m, k), b(k, n);
+  fill_random(t.rng(), a.view());
+  fill_random(t.rng(), b.view());
+  matrix<T> const zero(m, n);
+  std::vector<long double> want, bound;
+  reference<T>(1, a, b, 0, zero, want, bound);
+  long double const eps = std::numeric_limits<T>::epsilon();
+  std::fill(bound.begin(), bound.end(), 1000 * (k + 1) * eps);
+  std::string const label = std::string("strassen ") + type_name<T>() + " " + std::to_string(m) +
+                            "x" + std::to_string(k) + "x" + std::to_string(n) +
+                            " cutoff=" + std::to_string(cutoff);
+  t.set_case(label);
+  matrix<T> const c = strassen_multiply(a, b, cutoff);
+  ALGORITMI_CHECK(t, c.rows() == m && c.cols() == n && close<T>(c, want, bound));
+  t.set_case(label + " par");
+  matrix<T> const c_par = strassen_multiply(par, a, b, cutoff);
+  ALGORITMI_CHECK(t, close<T>(c_par, want, bound));
+}
+
+void test_strassen(Context& t) {
+  strassen_case<double>(t, 0, 4, 4, 1);
+  strassen_case<double>(t, 1, 1, 1, 0);
+  for (std::size_t round = 0; round < t.rounds(10); ++round) {
+    std::size_t const m = 1 + t.rng().below(120), k = 1 + t.rng().below(120);
+    std::size_t const n = 1 + t.rng().below(120);
+    std::size_t const cutoff = std::size_t{1} << t.rng().below(6);
+    strassen_case<double>(t, m, k, n, cutoff);
+    strassen_case<float>(t, m, k, n, cutoff);
+  }
+
+  // Below the cutoff multiply() is gemm exactly; above it, close to gemm.
+  t.set_case("multiply small");
+  matrix<double> a(50, 70), b(70, 30);
+  fill_random(t.rng(), a.view());
+  fill_random(t.rng(), b.view());
+  matrix<double> c(50, 30);
+  gemm(1.0, a, b, 0.0, c);
+  matrix<double> const small = multiply(a, b);
+  ALGORITMI_CHECK(t, std::equal(small.data(), small.data() + 50 * 30, c.data()));
+
+  t.set_case("multiply large");
+  std::size_t const m = strassen_cutoff + 3, k = strassen_cutoff + 2, n = strassen_cutoff + 1;
+  matrix<double> la(m, k), lb(k, n), lc(m, n);
+  fill_random(t.rng(), la.view());
+  fill_random(t.rng(), lb.view());
+  gemm(par, 1.0, la, lb, 0.0, lc);
+  matrix<double> const large = multiply(par, la, lb);
+  double worst = 0;
+  for (std::size_t i = 0; i < m * n; ++i)
+    worst = std::max(worst, std::fabs(large.data()[i] - lc.data()[i]));
+  ALGORITMI_CHECK(t, worst < 1e-10);
+
+  t.set_case("multiply errors");
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, multiply(a, a));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, strassen_multiply(par, b, b, 8));
+}
+
+template <class T, class Make>
+void transpose_case(Context& t, char const* name, std::size_t rows, std::size_t cols,
+                    Make make) {
+  Rng& rng = t.rng();
+  t.set_case(std::string("transpose ") + name + " " + std::to_string(rows) + "x" +
+             std::to_string(cols));
+  std::size_t const top = rng.below(3), left = rng.below(3);
+  matrix<T> big(rows + top + 1, cols + left + 2);
+  for (std::size_t i = 0; i < big.rows(); ++i)
+    for (std::size_t j = 0; j < big.cols(); ++j) big(i, j) = make(rng);
+  matrix_view<T const> const a = big.view().block(top, left, rows, cols);
+  auto const matches = [&](matrix_view<T const> b) {
+    for (std::size_t i = 0; i < rows; ++i)
+      for (std::size_t j = 0; j < cols; ++j)
+        if (!(b(j, i) == a(i, j))) return false;
+    return true;
+  };
+  // Into a block of a larger matrix, whose border stays untouched.
+  matrix<T> out(cols + 2, rows + 1);
+  T const border = make(rng);
+  for (std::size_t i = 0; i < out.rows(); ++i)
+    for (std::size_t j = 0; j < out.cols(); ++j) out(i, j) = border;
+  transpose<T>(a, out.view().block(1, 0, cols, rows));
+  bool ok = matches(matrix_view<T const>(out.view()).block(1, 0, cols, rows));
+  for (std::size_t j = 0; j < out.cols(); ++j) ok = ok && out(0, j) == border;
+  for (std::size_t i = 0; i < out.rows(); ++i) ok = ok && out(i, rows) == border;
+  ALGORITMI_CHECK(t, ok);
+
+  matrix<T> owned(rows, cols);
+  for (std::size_t i = 0; i < rows; ++i)
+    for (std::size_t j = 0; j < cols; ++j) owned(i, j) = a(i, j);
+  ALGORITMI_CHECK(t, matches(transpose(owned)) && matches(transpose(par, owned)));
+}
+
+void test_transpose(Context& t) {
+  auto const doubles = [](Rng& rng) { return rng.uniform(); };
+  auto const bytes = [](Rng& rng) { return static_cast<std::uint8_t>(rng.next()); };
+  auto const strings = [](Rng& rng) { return std::to_string(rng.below(1000)); };
+  std::size_t const dims[][2] = {{0, 0}, {0, 7}, {5, 0}, {1, 1}, {1, 300}, {300, 1},
+                                 {16, 16}, {17, 33}, {256, 257}, {700, 300}};
+  for (auto const& d : dims) {
+    transpose_case<double>(t, "f64", d[0], d[1], doubles);
+    transpose_case<std::uint8_t>(t, "u8", d[0], d[1], bytes);
+  }
+  for (std::size_t round = 0; round < t.rounds(10); ++round) {
+    std::size_t const rows = random_size(t.rng(), 600), cols = random_size(t.rng(), 600);
+    transpose_case<double>(t, "f64", rows, cols, doubles);
+    transpose_case<std::uint32_t>(t, "u32", rows, cols,
+                                  [](Rng& rng) { return static_cast<std::uint32_t>(rng.next()); });
+    transpose_case<std::string>(t, "string", rows % 50, cols % 70, strings);
+  }
+
+  t.set_case("transpose errors");
+  matrix<int> a(3, 4), b(3, 4);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, transpose<int>(a, b.view()));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, transpose<int>(par, a, b.view()));
+}
+
+ALGORITMI_TEST("linalg/gemm", test_gemm);
+ALGORITMI_TEST("linalg/strassen", test_strassen);
+ALGORITMI_TEST("linalg/transpose", test_transpose);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,169 @@
+// Memory resources: every block handed out is aligned, lies apart from the
+// others and keeps its contents until it is freed.
+//
+//   memory/arena       random sizes and alignments, reset cycles, caller
+//                      buffers; no upstream calls once reset has merged
+//   memory/fixed_pool  random allocate/deallocate against a live set,
+//                      oversized requests, blocks_in_use
+//
+// Each live block is filled with a byte derived from its number and checked
+// before it is freed, so blocks that overlap show up as clobbered bytes.
+#include <algoritmi/memory.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// Upstream that counts what it is asked for.
+class counting_resource final : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations = 0;
+  std::size_t outstanding = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    ++outstanding;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    --outstanding;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+struct block {
+  unsigned char* p;
+  std::size_t bytes;
+  std::size_t align;
+  unsigned char fill;
+};
+
+block take(std::pmr::memory_resource& r, std::size_t bytes, std::size_t align,
+           std::size_t number) {
+  auto* p = static_cast<unsigned char*>(r.allocate(bytes, align));
+  auto const fill = static_cast<unsigned char>(number * 131 + 7);
+  std::memset(p, fill, bytes);
+  return {p, bytes, align, fill};
+}
+
+bool intact(block const& b) {
+  return std::all_of(b.p, b.p + b.bytes, [&](unsigned char c) { return c == b.fill; });
+}
+
+bool aligned(block const& b) {
+  return reinterpret_cast<std::uintptr_t>(b.p) % b.align == 0;
+}
+
+bool disjoint(std::vector<block> blocks) {
+  std::sort(blocks.begin(), blocks.end(), [](block const& a, block const& b) { return a.p < b.p; });
+  for (std::size_t i = 1; i < blocks.size(); ++i)
+    if (blocks[i - 1].p + blocks[i - 1].bytes > blocks[i].p) return false;
+  return true;
+}
+
+std::size_t random_align(Rng& rng) { return std::size_t{1} << rng.below(8); }
+
+void test_arena(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(60); ++round) {
+    counting_resource upstream;
+    std::size_t const initial = t.rng().below(8192);
+    std::vector<unsigned char> buffer(round % 3 == 0 ? t.rng().below(4096) : 0);
+    {
+      arena a = buffer.empty() ? arena(initial, &upstream)
+                               : arena(buffer.data(), buffer.size(), &upstream);
+      std::size_t const blocks = random_size(t.rng(), 2000);
+      t.set_case("arena initial=" + std::to_string(initial) +
+                 " buffer=" + std::to_string(buffer.size()) + " blocks=" + std::to_string(blocks));
+      bool ok = true;
+      std::size_t upstream_settled = 0;
+      for (std::size_t cycle = 0; ok && cycle < 4; ++cycle) {
+        // The same request sequence each cycle. The first cycle may spill
+        // out of a caller buffer, which reset() then skips; after the
+        // second reset the merged chunk holds all of it.
+        Rng sizes(t.seed() + round);
+        std::vector<block> live;
+        std::size_t requested = 0;
+        for (std::size_t k = 0; k < blocks; ++k) {
+          std::size_t const bytes = 1 + sizes.below(sizes.below(16) == 0 ? 4096 : 64);
+          live.push_back(take(a, bytes, random_align(sizes), k));
+          requested += bytes;
+        }
+        ok = a.bytes_used() >= requested && disjoint(live) &&
+             std::all_of(live.begin(), live.end(), intact) &&
+             std::all_of(live.begin(), live.end(), aligned);
+        if (cycle > 1) ok = ok && upstream.allocations == upstream_settled;
+        a.reset();
+        ok = ok && a.bytes_used() == 0;
+        if (cycle == 1) upstream_settled = upstream.allocations;
+      }
+      ALGORITMI_CHECK(t, ok);
+    }
+    ALGORITMI_CHECK(t, upstream.outstanding == 0);
+  }
+}
+
+void test_fixed_pool(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(60); ++round) {
+    counting_resource upstream;
+    std::size_t const block_size = 1 + t.rng().below(200);
+    std::size_t const block_align = random_align(t.rng());
+    std::size_t const ops = random_size(t.rng(), 20000);
+    {
+      fixed_pool pool(block_size, block_align, t.rng().below(100), &upstream);
+      t.set_case("fixed_pool block_size=" + std::to_string(block_size) +
+                 " align=" + std::to_string(block_align) + " ops=" + std::to_string(ops));
+      ALGORITMI_CHECK(t, pool.block_size() >= block_size && pool.block_size() % block_align == 0 &&
+                             pool.block_size() % alignof(void*) == 0);
+      std::vector<block> live;
+      std::size_t pooled = 0;
+      bool ok = true;
+      // Phases of mostly allocating and mostly freeing.
+      std::uint64_t bias = 60;
+      for (std::size_t op = 0; ok && op < ops; ++op) {
+        if (op % 512 == 0) bias = 20 + t.rng().below(61);
+        if (live.empty() || t.rng().below(100) < bias) {
+          bool const oversized = t.rng().below(32) == 0;
+          std::size_t const bytes = oversized ? pool.block_size() + 1 + t.rng().below(100)
+                                              : 1 + t.rng().below(block_size);
+          std::size_t const align = oversized ? alignof(std::max_align_t) : block_align;
+          live.push_back(take(pool, bytes, align, op));
+          pooled += !oversized;
+        } else {
+          std::size_t const k = t.rng().below(live.size());
+          ok = intact(live[k]) && aligned(live[k]);
+          pooled -= live[k].bytes <= pool.block_size();
+          pool.deallocate(live[k].p, live[k].bytes, live[k].align);
+          live[k] = live.back();
+          live.pop_back();
+        }
+        ok = ok && pool.blocks_in_use() == pooled;
+      }
+      ok = ok && disjoint(live) && std::all_of(live.begin(), live.end(), intact);
+      ALGORITMI_CHECK(t, ok);
+      for (auto const& b : live) pool.deallocate(b.p, b.bytes, b.align);
+      ALGORITMI_CHECK(t, pool.blocks_in_use() == 0);
+    }
+    ALGORITMI_CHECK(t, upstream.outstanding == 0);
+  }
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, fixed_pool(16, 24));
+}
+
+ALGORITMI_TEST("memory/arena", test_arena);
+ALGORITMI_TEST("memory/fixed_pool", test_fixed_pool);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,203 @@
+// Index files: every saved structure answers like the one it was saved
+// from, and damaged files are refused.
+//
+//   persist/roundtrip   each structure save()d, load()ed from the mapping
+//                       and queried alongside the original
+//   persist/errors      missing sections, wrong element types, truncation
+//                       and corrupted bytes
+#include <algoritmi/persist.hpp>
+
+#include <algoritmi/filter.hpp>
+#include <algoritmi/graph.hpp>
+#include <algoritmi/hash.hpp>
+#include <algoritmi/search.hpp>
+#include <algoritmi/succinct.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+std::filesystem::path temp_path(Context& t, char const* what) {
+  return std::filesystem::temp_directory_path() /
+         ("algoritmi_test_" + std::to_string(t.seed()) + '_' + what + ".idx");
+}
+
+void test_roundtrip(Context& t) {
+  auto const path = temp_path(t, "roundtrip");
+  for (std::size_t round = 0; round < t.rounds(12); ++round) {
+    std::size_t const n = random_size(t.rng(), 50000);
+    t.set_case("roundtrip n=" + std::to_string(n));
+
+    std::vector<weighted_edge<float>> edges;
+    std::size_t const vertices = 1 + n / 4;
+    for (std::size_t i = 0; i < n; ++i)
+      edges.push_back({static_cast<vertex_id>(t.rng().below(vertices)),
+                       static_cast<vertex_id>(t.rng().below(vertices)),
+                       static_cast<float>(t.rng().uniform())});
+    csr_graph<float> const graph(vertices, span<weighted_edge<float> const>(edges));
+    auto keys = make_input<std::uint64_t>(round % 2 ? shape::few_unique : shape::random, n,
+                                          t.rng());
+    std::sort(keys.begin(), keys.end());
+    static_search_tree<std::uint64_t> const tree(keys.begin(), keys.end());
+    eytzinger_index<std::uint64_t> const eytzinger(keys.begin(), keys.end());
+    elias_fano const ef(keys.begin(), keys.end());
+    std::vector<bool> bits(n);
+    for (std::size_t i = 0; i < n; ++i) bits[i] = t.rng().below(3) == 0;
+    rank_select_bitvector const bv(bits.begin(), bits.end());
+    std::vector<std::uint32_t> seq(n);
+    for (auto& x : seq) x = static_cast<std::uint32_t>(t.rng().below(1000));
+    wavelet_matrix const wm(seq.begin(), seq.end());
+    blocked_bloom_filter<std::uint64_t> bloom(n);
+    bloom.insert(keys.begin(), keys.end());
+    binary_fuse_filter<std::uint64_t> const fuse(keys.begin(), keys.end());
+    xor_filter<std::uint64_t, std::uint16_t> const xf(keys.begin(), keys.end());
+    // Dense or sparse depending on n.
+    hyperloglog<std::uint64_t> hll(12);
+    hll.add(keys.begin(), keys.end());
+    flat_hash_map<std::uint64_t, std::uint32_t> map;
+    flat_hash_set<std::uint32_t> set;
+    for (std::size_t i = 0; i < n; ++i) {
+      map.insert_or_assign(keys[i] ^ 0x5555, static_cast<std::uint32_t>(i));
+      set.insert(seq[i]);
+    }
+
+    {
+      index_writer w(path);
+      save(w, "graph", graph);
+      save(w, "tree", tree);
+      save(w, "eytzinger", eytzinger);
+      save(w, "elias_fano", ef);
+      save(w, "bits", bv);
+      save(w, "wavelet", wm);
+      save(w, "bloom", bloom);
+      save(w, "fuse", fuse);
+      save(w, "xor", xf);
+      save(w, "hll", hll);
+      save(w, "map", map);
+      save(w, "set", set);
+      w.add("seq", seq.data(), seq.size());
+      w.add_value("n", std::uint64_t{n});
+      w.commit();
+    }
+    index_file const f(path, open_options{round % 2 == 0, true});
+    ALGORITMI_CHECK(t, f.value<std::uint64_t>("n") == n);
+    auto const stored = f.array<std::uint32_t>("seq");
+    ALGORITMI_CHECK(t, std::equal(stored.begin(), stored.end(), seq.begin(), seq.end()));
+
+    auto const g = load<csr_graph<float>>(f, "graph");
+    bool ok = g.num_vertices() == graph.num_vertices() && g.num_edges() == graph.num_edges();
+    for (vertex_id v = 0; ok && v < vertices; ++v)
+      ok = std::equal(g.neighbors(v).begin(), g.neighbors(v).end(), graph.neighbors(v).begin(),
+                      graph.neighbors(v).end()) &&
+           std::equal(g.weights(v).begin(), g.weights(v).end(), graph.weights(v).begin(),
+                      graph.weights(v).end());
+    ALGORITMI_CHECK(t, ok);
+
+    auto const tree2 = load<static_search_tree<std::uint64_t>>(f, "tree");
+    auto const eytzinger2 = load<eytzinger_index<std::uint64_t>>(f, "eytzinger");
+    auto const ef2 = load<elias_fano>(f, "elias_fano");
+    auto const bv2 = load<rank_select_bitvector>(f, "bits");
+    auto const wm2 = load<wavelet_matrix>(f, "wavelet");
+    auto const bloom2 = load<blocked_bloom_filter<std::uint64_t>>(f, "bloom");
+    auto const fuse2 = load<binary_fuse_filter<std::uint64_t>>(f, "fuse");
+    auto const xf2 = load<xor_filter<std::uint64_t, std::uint16_t>>(f, "xor");
+    auto hll2 = load<hyperloglog<std::uint64_t>>(f, "hll");
+    ALGORITMI_CHECK(t, hll2.estimate() == hll.estimate() && hll2.is_sparse() == hll.is_sparse());
+    // Updating a loaded counter copies the mapped registers first.
+    for (std::uint64_t i = 0; i < 5000; ++i) hll2.add(i);
+    ALGORITMI_CHECK(t, hll2.estimate() > hll.estimate() &&
+                           load<hyperloglog<std::uint64_t>>(f, "hll").estimate() == hll.estimate());
+    auto const map2 = load<flat_hash_map_view<std::uint64_t, std::uint32_t>>(f, "map");
+    auto const set2 = load<flat_hash_set_view<std::uint32_t>>(f, "set");
+    ALGORITMI_CHECK(t, tree2.size() == n && ef2.size() == n && bv2.size() == n &&
+                           wm2.size() == n && map2.size() == map.size() &&
+                           set2.size() == set.size());
+    for (std::size_t q = 0; ok && q < 1000; ++q) {
+      std::uint64_t const key = n && q % 2 ? keys[t.rng().below(n)] : t.rng().next();
+      std::size_t const i = t.rng().below(n + 1);
+      auto const it = map.find(key ^ 0x5555);
+      auto const* v = map2.find(key ^ 0x5555);
+      auto const small = static_cast<std::uint32_t>(key % 1100);
+      ok = tree2.lower_bound(key) == tree.lower_bound(key) &&
+           eytzinger2.lower_bound(key) == eytzinger.lower_bound(key) &&
+           ef2.lower_bound(key) == ef.lower_bound(key) && bv2.rank1(i) == bv.rank1(i) &&
+           wm2.rank(small, i) == wm.rank(small, i) &&
+           (it == map.end() ? v == nullptr : v != nullptr && *v == it->second) &&
+           set2.contains(small) == set.contains(small) &&
+           bloom2.contains(key) == bloom.contains(key) &&
+           fuse2.contains(key) == fuse.contains(key) && xf2.contains(key) == xf.contains(key);
+      if (ok && i < n) ok = ef2[i] == ef[i] && wm2[i] == wm[i] && bv2[i] == bv[i];
+    }
+    ALGORITMI_CHECK(t, ok);
+  }
+  std::filesystem::remove(path);
+}
+
+void test_errors(Context& t) {
+  auto const path = temp_path(t, "errors");
+  std::vector<std::uint64_t> data(1000);
+  for (auto& x : data) x = t.rng().next();
+  {
+    index_writer w(path);
+    w.add("data", data.data(), data.size());
+    w.add_value("pi", 3.25);
+    // A static_search_tree of 1000 keys whose offsets run past the tree.
+    std::size_t const offsets[] = {0, 1000, 1112, 1200};
+    w.add("tree.offsets", offsets, 4);
+    w.add("tree.tree", data.data(), data.size());
+    w.add_value("tree.size", std::uint64_t{1000});
+    w.commit();
+  }
+  t.set_case("errors");
+  {
+    index_file const f(path, open_options{false, true});
+    ALGORITMI_CHECK(t, f.section_count() == 5 && f.contains("data") && !f.contains("nope"));
+    ALGORITMI_CHECK(t, f.value<double>("pi") == 3.25);
+    ALGORITMI_CHECK_THROWS(t, format_error, f.array<std::uint64_t>("nope"));
+    ALGORITMI_CHECK_THROWS(t, format_error, f.array<std::int64_t>("data"));
+    ALGORITMI_CHECK_THROWS(t, format_error, f.array<std::uint32_t>("data"));
+    ALGORITMI_CHECK_THROWS(t, format_error, f.value<std::uint64_t>("data"));
+    ALGORITMI_CHECK_THROWS(t, format_error, load<elias_fano>(f, "data"));
+    ALGORITMI_CHECK_THROWS(t, format_error, load<hyperloglog<int>>(f, "data"));
+    ALGORITMI_CHECK_THROWS(t, format_error, load<static_search_tree<std::uint64_t>>(f, "tree"));
+  }
+
+  // Flip one byte of the data: opening still works, verifying does not.
+  auto const size = std::filesystem::file_size(path);
+  std::vector<char> bytes(size);
+  std::ifstream(path, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(size));
+  auto const it = std::search(bytes.begin(), bytes.end(), reinterpret_cast<char const*>(&data[7]),
+                              reinterpret_cast<char const*>(&data[8]));
+  ALGORITMI_CHECK(t, it != bytes.end());
+  if (it != bytes.end()) {
+    *it = static_cast<char>(*it ^ 0x10);
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(bytes.data(), static_cast<std::streamsize>(size));
+    index_file const f(path);
+    ALGORITMI_CHECK_THROWS(t, format_error, f.verify());
+    ALGORITMI_CHECK_THROWS(t, format_error, index_file(path, open_options{false, true}));
+  }
+
+  // Truncated, and not an index file at all.
+  std::filesystem::resize_file(path, size - 64);
+  ALGORITMI_CHECK_THROWS(t, format_error, index_file(path));
+  std::ofstream(path, std::ios::trunc) << "not an index file, but long enough to have a header "
+                                          "if it were one: padding padding padding padding";
+  ALGORITMI_CHECK_THROWS(t, format_error, index_file(path));
+  std::filesystem::remove(path);
+}
+
+ALGORITMI_TEST("persist/roundtrip", test_roundtrip);
+ALGORITMI_TEST("persist/errors", test_errors);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,251 @@
+// Data-parallel primitives against their std:: counterparts.
+//
+//   primitives/scan        inclusive_scan, exclusive_scan, reduce: default
+//                          dispatch, every instruction set, par; additions and
+//                          a non-commutative operator
+//   primitives/compact     compact (in place too), copy_if
+//   primitives/partition   stable_partition, trivially copyable or not
+//   primitives/histogram   identity bins and a custom bin function
+//
+// Every fourth round is large enough (above the 2^18-element threshold,
+// spanning several look-back tiles) for the par overloads to split.
+#include <algoritmi/primitives.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+std::size_t round_size(Context& t, std::size_t round) {
+  if (round % 4 == 3)
+    return detail::prims::parallel_threshold +
+           t.rng().below(3 * detail::prims::tile_size + detail::prims::tile_size / 2);
+  return random_size(t.rng(), 5000);
+}
+
+// Signed sums stay small so the reference cannot overflow; unsigned ones
+// wrap on both sides.
+template <class T>
+std::vector<T> scan_input(Rng& rng, std::size_t n) {
+  std::vector<T> v(n);
+  for (auto& x : v) {
+    if constexpr (std::is_signed_v<T>)
+      x = static_cast<T>(static_cast<std::int64_t>(rng.below(2001)) - 1000);
+    else
+      x = random_value<T>(rng);
+  }
+  return v;
+}
+
+template <class T>
+void scan_types(Context& t, std::size_t n) {
+  auto const in = scan_input<T>(t.rng(), n);
+  std::vector<T> inc(n), exc(n);
+  T const init = static_cast<T>(t.rng().below(100));
+  T sum = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    exc[i] = static_cast<T>(init + sum);
+    sum = static_cast<T>(sum + in[i]);
+    inc[i] = sum;
+  }
+  T const total = static_cast<T>(init + sum);
+  std::vector<T> out(n);
+  t.set_case(describe<T>("scan", shape::random, n));
+  inclusive_scan(in.data(), n, out.data());
+  ALGORITMI_CHECK(t, out == inc);
+  ALGORITMI_CHECK(t, exclusive_scan(in.data(), n, out.data(), init) == total && out == exc);
+  ALGORITMI_CHECK(t, reduce(in.data(), n, init) == total);
+  if constexpr (sizeof(T) >= 4) {
+    for (isa which : host_isas()) {
+      t.set_case(describe<T>(to_string(which), shape::random, n));
+      std::fill(out.begin(), out.end(), T(0));
+      inclusive_scan(which, in.data(), n, out.data());
+      ALGORITMI_CHECK(t, out == inc);
+      ALGORITMI_CHECK(t, exclusive_scan(which, in.data(), n, out.data(), init) == total &&
+                             out == exc);
+      ALGORITMI_CHECK(t, reduce(which, in.data(), n, init) == total);
+    }
+  }
+  t.set_case(describe<T>("scan par", shape::random, n));
+  std::fill(out.begin(), out.end(), T(0));
+  inclusive_scan(par, in.data(), n, out.data());
+  ALGORITMI_CHECK(t, out == inc);
+  ALGORITMI_CHECK(t, exclusive_scan(par, in.data(), n, out.data(), init) == total && out == exc);
+  ALGORITMI_CHECK(t, reduce(par, in.data(), n, init) == total);
+  // In place.
+  out = in;
+  inclusive_scan(out.data(), n, out.data());
+  ALGORITMI_CHECK(t, out == inc);
+}
+
+// x -> a x + b; composition is associative but not commutative, so tiles
+// combined out of order show up.
+struct affine {
+  std::uint32_t a = 1, b = 0;
+  friend bool operator==(affine const& x, affine const& y) { return x.a == y.a && x.b == y.b; }
+};
+
+struct compose {
+  affine operator()(affine const& f, affine const& g) const noexcept {
+    return {f.a * g.a, f.b * g.a + g.b};
+  }
+};
+
+void scan_affine(Context& t, std::size_t n) {
+  std::vector<affine> in(n), inc(n), exc(n), out(n);
+  for (auto& f : in)
+    f = {static_cast<std::uint32_t>(t.rng().next() | 1),
+         static_cast<std::uint32_t>(t.rng().next())};
+  affine acc;
+  for (std::size_t i = 0; i < n; ++i) {
+    exc[i] = acc;
+    acc = compose()(acc, in[i]);
+    inc[i] = acc;
+  }
+  t.set_case("scan affine n=" + std::to_string(n));
+  inclusive_scan(in.data(), n, out.data(), compose());
+  ALGORITMI_CHECK(t, out == inc);
+  ALGORITMI_CHECK(t, exclusive_scan(in.data(), n, out.data(), affine(), compose()) == acc &&
+                         out == exc);
+  ALGORITMI_CHECK(t, reduce(in.data(), n, affine(), compose()) == acc);
+  t.set_case("scan affine par n=" + std::to_string(n));
+  inclusive_scan(par, in.data(), n, out.data(), compose());
+  ALGORITMI_CHECK(t, out == inc);
+  ALGORITMI_CHECK(t, exclusive_scan(par, in.data(), n, out.data(), affine(), compose()) == acc &&
+                         out == exc);
+  ALGORITMI_CHECK(t, reduce(par, in.data(), n, affine(), compose()) == acc);
+}
+
+void test_scan(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(16); ++round) {
+    std::size_t const n = round_size(t, round);
+    scan_types<std::int32_t>(t, n);
+    scan_types<std::uint32_t>(t, n);
+    scan_types<std::int64_t>(t, n);
+    scan_types<std::uint64_t>(t, n);
+    scan_types<std::uint16_t>(t, n);
+    scan_affine(t, n);
+  }
+}
+
+// Flags with a random density; any non-zero byte counts as set.
+std::vector<std::uint8_t> random_flags(Rng& rng, std::size_t n) {
+  std::uint64_t const density = rng.below(9);  // eighths
+  std::vector<std::uint8_t> flags(n);
+  for (auto& f : flags)
+    f = rng.below(8) < density ? static_cast<std::uint8_t>(1 + rng.below(255)) : 0;
+  return flags;
+}
+
+template <class T>
+void compact_types(Context& t, std::size_t n) {
+  auto const in = make_input<T>(shape::random, n, t.rng());
+  auto const flags = random_flags(t.rng(), n);
+  std::vector<T> expect;
+  for (std::size_t i = 0; i < n; ++i)
+    if (flags[i]) expect.push_back(in[i]);
+  std::vector<T> out(n);
+  auto const same = [&](std::size_t k) {
+    return k == expect.size() && std::equal(expect.begin(), expect.end(), out.begin());
+  };
+  t.set_case(describe<T>("compact", shape::random, n));
+  ALGORITMI_CHECK(t, same(compact(in.data(), flags.data(), n, out.data())));
+  ALGORITMI_CHECK(t, same(compact(par, in.data(), flags.data(), n, out.data())));
+  out = in;
+  ALGORITMI_CHECK(t, same(compact(out.data(), flags.data(), n, out.data())));
+  if constexpr (sizeof(T) == 4 || sizeof(T) == 8) {
+    for (isa which : host_isas()) {
+      t.set_case(describe<T>(to_string(which), shape::random, n));
+      std::fill(out.begin(), out.end(), T());
+      ALGORITMI_CHECK(t, same(compact(which, in.data(), flags.data(), n, out.data())));
+    }
+  }
+
+  // copy_if with the flags as the predicate's answer.
+  auto const keep = [&](T const& x) {
+    return flags[static_cast<std::size_t>(&x - in.data())] != 0;
+  };
+  t.set_case(describe<T>("copy_if", shape::random, n));
+  ALGORITMI_CHECK(t, same(copy_if(in.data(), n, out.data(), keep)));
+  ALGORITMI_CHECK(t, same(copy_if(par, in.data(), n, out.data(), keep)));
+}
+
+void test_compact(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(16); ++round) {
+    std::size_t const n = round_size(t, round);
+    compact_types<std::uint32_t>(t, n);
+    compact_types<float>(t, n);
+    compact_types<std::uint64_t>(t, n);
+    compact_types<double>(t, n);
+    compact_types<std::uint8_t>(t, n);
+    compact_types<std::uint16_t>(t, n);
+  }
+}
+
+template <class T>
+void partition_types(Context& t, std::size_t n) {
+  for (shape s : {shape::random, shape::sorted, shape::few_unique}) {
+    auto const in = make_input<T>(s, n, t.rng());
+    T const pivot = n ? in[t.rng().below(n)] : T();
+    auto const pred = [&](T const& x) { return x < pivot; };
+    auto expect = in;
+    auto const mid = static_cast<std::size_t>(
+        std::stable_partition(expect.begin(), expect.end(), pred) - expect.begin());
+    t.set_case(describe<T>("stable_partition", s, n));
+    auto data = in;
+    ALGORITMI_CHECK(t, stable_partition(data.data(), n, pred) == mid && data == expect);
+    data = in;
+    ALGORITMI_CHECK(t, stable_partition(par, data.data(), n, pred) == mid && data == expect);
+  }
+}
+
+void test_partition(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(12); ++round) {
+    std::size_t const n = round_size(t, round);
+    partition_types<std::int32_t>(t, n);
+    partition_types<double>(t, n);
+    partition_types<std::uint8_t>(t, n);
+    partition_types<std::string>(t, std::min<std::size_t>(n, 20000));
+  }
+}
+
+void test_histogram(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(16); ++round) {
+    std::size_t const n = round_size(t, round);
+    auto const bytes = make_input<std::uint8_t>(round % 2 ? shape::few_unique : shape::random, n,
+                                                t.rng());
+    std::vector<std::size_t> expect(256);
+    for (auto b : bytes) ++expect[b];
+    auto const same = [](auto const& got, std::vector<std::size_t> const& ref) {
+      return std::equal(got.begin(), got.end(), ref.begin(), ref.end());
+    };
+    t.set_case(describe<std::uint8_t>("histogram", shape::random, n));
+    ALGORITMI_CHECK(t, same(histogram(bytes.data(), n, 256), expect));
+    ALGORITMI_CHECK(t, same(histogram(par, bytes.data(), n, 256), expect));
+
+    std::size_t const bins = 1 + t.rng().below(5000);
+    auto const keys = make_input<std::uint64_t>(shape::random, n, t.rng());
+    auto const bin_of = [bins](std::uint64_t x) { return static_cast<std::size_t>(x % bins); };
+    std::vector<std::size_t> counts(bins);
+    for (auto k : keys) ++counts[bin_of(k)];
+    t.set_case(describe<std::uint64_t>("histogram", shape::random, n) +
+               " bins=" + std::to_string(bins));
+    ALGORITMI_CHECK(t, same(histogram(keys.data(), n, bins, bin_of), counts));
+    ALGORITMI_CHECK(t, same(histogram(par, keys.data(), n, bins, bin_of), counts));
+  }
+}
+
+ALGORITMI_TEST("primitives/scan", test_scan);
+ALGORITMI_TEST("primitives/compact", test_compact);
+ALGORITMI_TEST("primitives/partition", test_partition);
+ALGORITMI_TEST("primitives/histogram", test_histogram);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,203 @@
+// Scheduler: every index runs exactly once, on any executor, nested or not,
+// and exceptions come back to the caller.
+//
+//   scheduler/parallel_for     random ranges, grains and thread counts on
+//                              task_schedulers of several sizes, nested loops
+//   scheduler/parallel_invoke  recursive fork-join sums
+//   scheduler/exceptions       a throwing task rethrows from parallel_for and
+//                              parallel_invoke; the scheduler stays usable
+//   scheduler/pool_executor    the same loops on a plain thread pool through
+//                              pool_executor and scoped_executor
+#include <algoritmi/scheduler.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// Runs a random parallel_for on the current executor, sometimes with a
+// nested one per index, and checks that every index ran once.
+bool loop_case(Context& t, std::string const& where) {
+  std::size_t const n = random_size(t.rng(), 20000);
+  std::size_t const grain = t.rng().below(4) == 0 ? 0 : 1 + t.rng().below(2000);
+  unsigned const threads = static_cast<unsigned>(t.rng().below(9));
+  std::size_t const inner = t.rng().below(4) == 0 ? 1 + t.rng().below(40) : 0;
+  t.set_case(where + " n=" + std::to_string(n) + " grain=" + std::to_string(grain) +
+             " threads=" + std::to_string(threads) + " inner=" + std::to_string(inner));
+  std::size_t const first = t.rng().below(100);
+  std::vector<std::atomic<std::uint32_t>> hits((n + 1) * (inner ? inner : 1));
+  parallel_for(
+      par.with_threads(threads), first, first + n,
+      [&](std::size_t i) {
+        std::size_t const row = i - first;
+        if (!inner) {
+          hits[row].fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+        parallel_for(par, 0, inner, [&](std::size_t j) {
+          hits[row * inner + j].fetch_add(1, std::memory_order_relaxed);
+        });
+      },
+      grain);
+  std::size_t const used = n * (inner ? inner : 1);
+  for (std::size_t k = 0; k < hits.size(); ++k)
+    if (hits[k].load() != (k < used ? 1u : 0u)) return false;
+  return true;
+}
+
+void test_parallel_for(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(40); ++round)
+    ALGORITMI_CHECK(t, loop_case(t, "default executor"));
+  for (unsigned workers : {1u, 2u, 3u, 8u}) {
+    task_scheduler sched(scheduler_options{workers, false});
+    scoped_executor use(sched);
+    ALGORITMI_CHECK(t, current_executor().concurrency() == workers);
+    for (std::size_t round = 0; round < t.rounds(10); ++round)
+      ALGORITMI_CHECK(t, loop_case(t, "task_scheduler(" + std::to_string(workers) + ")"));
+  }
+  // Called from outside, the caller's share of the tasks also sees the
+  // scheduler as its executor, and the caller's own is restored afterwards.
+  t.set_case("task_scheduler bulk from outside");
+  {
+    task_scheduler sched(scheduler_options{2, false});
+    executor* const before = &current_executor();
+    std::atomic<bool> ok{true};
+    auto check = [&](std::size_t) {
+      if (&current_executor() != &sched) ok.store(false, std::memory_order_relaxed);
+    };
+    sched.bulk(256, 3, check);
+    ALGORITMI_CHECK(t, ok.load() && &current_executor() == before);
+  }
+}
+
+std::uint64_t fork_sum(std::uint64_t const* v, std::size_t n, std::size_t cutoff) {
+  if (n <= cutoff) {
+    std::uint64_t s = 0;
+    for (std::size_t i = 0; i < n; ++i) s += v[i];
+    return s;
+  }
+  std::uint64_t left = 0, right = 0;
+  parallel_invoke([&] { left = fork_sum(v, n / 2, cutoff); },
+                  [&] { right = fork_sum(v + n / 2, n - n / 2, cutoff); });
+  return left + right;
+}
+
+void test_parallel_invoke(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(40); ++round) {
+    std::size_t const n = random_size(t.rng(), 200000);
+    std::size_t const cutoff = 1 + t.rng().below(5000);
+    std::vector<std::uint64_t> v(n);
+    std::uint64_t expect = 0;
+    for (auto& x : v) expect += x = t.rng().next() >> 16;
+    t.set_case("fork_sum n=" + std::to_string(n) + " cutoff=" + std::to_string(cutoff));
+    ALGORITMI_CHECK(t, fork_sum(v.data(), n, cutoff) == expect);
+  }
+}
+
+void test_exceptions(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(40); ++round) {
+    std::size_t const n = 1 + t.rng().below(10000);
+    std::size_t const bad = t.rng().below(n);
+    std::size_t const grain = 1 + t.rng().below(100);
+    t.set_case("parallel_for throws at " + std::to_string(bad) + " of " + std::to_string(n));
+    std::atomic<std::size_t> ran{0};
+    ALGORITMI_CHECK_THROWS(t, std::runtime_error,
+                           parallel_for(
+                               par, 0, n,
+                               [&](std::size_t i) {
+                                 if (i == bad) throw std::runtime_error("task");
+                                 ran.fetch_add(1, std::memory_order_relaxed);
+                               },
+                               grain));
+    ALGORITMI_CHECK(t, ran.load() < n);
+    bool const first = t.rng().coin();
+    ALGORITMI_CHECK_THROWS(t, std::logic_error, parallel_invoke(
+                                                    [&] {
+                                                      if (first) throw std::logic_error("f");
+                                                    },
+                                                    [&] {
+                                                      if (!first) throw std::logic_error("g");
+                                                    }));
+    // Nothing is left half-done: the next loop runs normally.
+    ALGORITMI_CHECK(t, loop_case(t, "after exception"));
+  }
+}
+
+// A minimal application thread pool: a locked queue and N threads.
+class thread_pool {
+ public:
+  explicit thread_pool(unsigned n) {
+    for (unsigned i = 0; i < n; ++i)
+      threads_.emplace_back([this] {
+        for (;;) {
+          std::function<void()> job;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+          }
+          job();
+        }
+      });
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& th : threads_) th.join();
+  }
+
+  void submit(std::function<void()> job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> jobs_;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
+
+void test_pool_executor(Context& t) {
+  for (unsigned n : {1u, 3u}) {
+    thread_pool pool(n);
+    pool_executor exec([&](std::function<void()> job) { pool.submit(std::move(job)); }, n + 1);
+    scoped_executor use(exec);
+    ALGORITMI_CHECK(t, &current_executor() == &exec && exec.concurrency() == n + 1);
+    for (std::size_t round = 0; round < t.rounds(20); ++round)
+      ALGORITMI_CHECK(t, loop_case(t, "pool_executor(" + std::to_string(n) + ")"));
+    std::vector<std::uint64_t> v(50000, 3);
+    ALGORITMI_CHECK(t, fork_sum(v.data(), v.size(), 1000) == 150000);
+  }
+}
+
+ALGORITMI_TEST("scheduler/parallel_for", test_parallel_for);
+ALGORITMI_TEST("scheduler/parallel_invoke", test_parallel_invoke);
+ALGORITMI_TEST("scheduler/exceptions", test_exceptions);
+ALGORITMI_TEST("scheduler/pool_executor", test_pool_executor);
+
+}  // namespace
+}  // namespace algoritmi::test
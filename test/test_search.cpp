@@ -0,0 +1,204 @@
+// Searching against std::find, std::count_if and std::lower_bound.
+//
+//   search/linear          find_first and count_less, every instruction set
+//   search/lower_bound     lower_bound, binary_search, branchless_lower_bound
+//   search/eytzinger       eytzinger_index
+//   search/static_tree     static_search_tree, single and batched, every
+//                          instruction set
+#include <algoritmi/search.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+constexpr std::size_t max_n = 50000;
+
+// Keys drawn from the data, their neighbours, and the type's extremes.
+template <class T>
+std::vector<T> queries(std::vector<T> const& data, Rng& rng) {
+  std::vector<T> q;
+  if constexpr (std::is_arithmetic_v<T>)
+    q = {std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max(), T(0)};
+  for (std::size_t i = 0; i < 64; ++i) {
+    q.push_back(random_value<T>(rng));
+    if (data.empty()) continue;
+    T const x = data[rng.below(data.size())];
+    q.push_back(x);
+    if constexpr (std::is_integral_v<T>) {
+      q.push_back(static_cast<T>(x + 1));
+      q.push_back(static_cast<T>(x - 1));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      q.push_back(x * T(0.999));
+      q.push_back(x + T(1));
+    } else {
+      q.push_back(x + 'a');
+    }
+  }
+  return q;
+}
+
+template <class T>
+void linear_types(Context& t) {
+  std::size_t const n = random_size(t.rng(), max_n);
+  for (shape s : all_shapes) {
+    auto const v = make_input<T>(s, n, t.rng());
+    for (T key : queries(v, t.rng())) {
+      std::size_t const first = static_cast<std::size_t>(std::find(v.begin(), v.end(), key) -
+                                                         v.begin());
+      std::size_t const less = static_cast<std::size_t>(
+          std::count_if(v.begin(), v.end(), [&](T x) { return x < key; }));
+      t.set_case(describe<T>("find_first/count_less", s, n));
+      ALGORITMI_CHECK(t, find_first(v.data(), n, key) == first);
+      ALGORITMI_CHECK(t, count_less(v.data(), n, key) == less);
+      for (isa which : host_isas()) {
+        t.set_case(describe<T>(to_string(which), s, n));
+        ALGORITMI_CHECK(t, find_first(which, v.data(), n, key) == first);
+        ALGORITMI_CHECK(t, count_less(which, v.data(), n, key) == less);
+      }
+    }
+  }
+}
+
+void test_linear(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    linear_types<std::int32_t>(t);
+    linear_types<std::uint32_t>(t);
+    linear_types<std::int64_t>(t);
+    linear_types<std::uint64_t>(t);
+    linear_types<float>(t);
+    linear_types<double>(t);
+  }
+}
+
+template <class T>
+void lower_bound_types(Context& t) {
+  std::size_t const n = random_size(t.rng(), max_n);
+  for (shape s : all_shapes) {
+    auto v = make_input<T>(s, n, t.rng());
+    std::sort(v.begin(), v.end());
+    for (T key : queries(v, t.rng())) {
+      auto const it = std::lower_bound(v.begin(), v.end(), key);
+      auto const expect = static_cast<std::size_t>(it - v.begin());
+      bool const found = it != v.end() && !(key < *it);
+      t.set_case(describe<T>("lower_bound", s, n));
+      ALGORITMI_CHECK(t, lower_bound(v.data(), n, key) == expect);
+      ALGORITMI_CHECK(t, binary_search(v.data(), n, key) == found);
+      ALGORITMI_CHECK(t, branchless_lower_bound(v.begin(), v.end(), key) == it);
+      for (isa which : host_isas()) {
+        t.set_case(describe<T>(to_string(which), s, n));
+        ALGORITMI_CHECK(t, lower_bound(which, v.data(), n, key) == expect);
+      }
+    }
+  }
+}
+
+void test_lower_bound(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    lower_bound_types<std::int32_t>(t);
+    lower_bound_types<std::uint32_t>(t);
+    lower_bound_types<std::int64_t>(t);
+    lower_bound_types<std::uint64_t>(t);
+    lower_bound_types<float>(t);
+    lower_bound_types<double>(t);
+  }
+  // The generic version with a comparator and a non-arithmetic key.
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    std::size_t const n = random_size(t.rng(), 2000);
+    auto v = make_input<std::string>(shape::random, n, t.rng());
+    std::sort(v.begin(), v.end(), std::greater<>());
+    t.set_case(describe<std::string>("branchless_lower_bound", shape::random, n));
+    for (int i = 0; i < 32; ++i) {
+      std::string const key = random_value<std::string>(t.rng());
+      ALGORITMI_CHECK(t, branchless_lower_bound(v.begin(), v.end(), key, std::greater<>()) ==
+                             std::lower_bound(v.begin(), v.end(), key, std::greater<>()));
+    }
+  }
+}
+
+template <class T>
+void eytzinger_types(Context& t) {
+  std::size_t const n = random_size(t.rng(), max_n);
+  for (shape s : all_shapes) {
+    auto v = make_input<T>(s, n, t.rng());
+    std::sort(v.begin(), v.end());
+    eytzinger_index<T> const index(v.begin(), v.end());
+    t.set_case(describe<T>("eytzinger_index", s, n));
+    ALGORITMI_CHECK(t, index.size() == n);
+    for (T key : queries(v, t.rng())) {
+      auto const it = std::lower_bound(v.begin(), v.end(), key);
+      ALGORITMI_CHECK(t, index.lower_bound(key) == static_cast<std::size_t>(it - v.begin()));
+      ALGORITMI_CHECK(t, index.contains(key) == (it != v.end() && !(key < *it)));
+    }
+  }
+}
+
+void test_eytzinger(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    eytzinger_types<std::int32_t>(t);
+    eytzinger_types<std::uint64_t>(t);
+    eytzinger_types<double>(t);
+    eytzinger_types<std::string>(t);
+  }
+}
+
+template <class T>
+void static_tree_types(Context& t) {
+  std::size_t const n = random_size(t.rng(), max_n);
+  for (shape s : all_shapes) {
+    auto v = make_input<T>(s, n, t.rng());
+    std::sort(v.begin(), v.end());
+    static_search_tree<T> const tree(v.begin(), v.end());
+    auto const q = queries(v, t.rng());
+    std::vector<std::size_t> expect;
+    for (T key : q)
+      expect.push_back(static_cast<std::size_t>(std::lower_bound(v.begin(), v.end(), key) -
+                                                v.begin()));
+    t.set_case(describe<T>("static_search_tree", s, n));
+    ALGORITMI_CHECK(t, tree.size() == n);
+    std::vector<std::size_t> got(q.size());
+    for (std::size_t i = 0; i < q.size(); ++i) {
+      ALGORITMI_CHECK(t, tree.lower_bound(q[i]) == expect[i]);
+      ALGORITMI_CHECK(t, tree.contains(q[i]) == (expect[i] < n && !(q[i] < v[expect[i]])));
+    }
+    tree.lower_bound_batch(q.data(), q.size(), got.data());
+    ALGORITMI_CHECK(t, got == expect);
+    for (isa which : host_isas()) {
+      t.set_case(describe<T>(to_string(which), s, n));
+      for (std::size_t i = 0; i < q.size(); ++i)
+        ALGORITMI_CHECK(t, tree.lower_bound(which, q[i]) == expect[i]);
+      std::fill(got.begin(), got.end(), 0);
+      tree.lower_bound_batch(which, q.data(), q.size(), got.data());
+      ALGORITMI_CHECK(t, got == expect);
+    }
+  }
+}
+
+void test_static_tree(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    static_tree_types<std::int32_t>(t);
+    static_tree_types<std::uint32_t>(t);
+    static_tree_types<std::int64_t>(t);
+    static_tree_types<std::uint64_t>(t);
+    static_tree_types<float>(t);
+    static_tree_types<double>(t);
+    static_tree_types<std::uint8_t>(t);
+  }
+}
+
+ALGORITMI_TEST("search/linear", test_linear);
+ALGORITMI_TEST("search/lower_bound", test_lower_bound);
+ALGORITMI_TEST("search/eytzinger", test_eytzinger);
+ALGORITMI_TEST("search/static_tree", test_static_tree);
+
+}  // namespace
+}  // namespace algoritmi::test
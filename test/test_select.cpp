@@ -0,0 +1,323 @@
+// Selection against std::sort, sketches against exact ranks.
+//
+//   select/nth_element    every shape, several key types and both orders,
+//                         ranks at both ends and in between
+//   select/kernels        nth_element and nth_elements on every
+//                         instruction set, above the SIMD threshold
+//   select/adversary      McIlroy's adversary played against nth_element
+//                         itself: the comparison count stays linear
+//   select/nth_elements   many ranks at once, quantiles, argument errors
+//   select/kll_sketch     rank error of quantiles, single, merged and
+//                         self-merged, on several distributions and an
+//                         ordering of strings
+//   select/tdigest        rank error in the middle and the tails, cdf,
+//                         merged digests
+#include <algoritmi/select.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+constexpr std::size_t max_n = 50000;
+
+// v is a permutation of sorted with sorted[k] at k and the two sides
+// around it; equivalence, not ==, so -0.0 and 0.0 are interchangeable.
+template <class T, class Compare>
+bool selected(std::vector<T> const& v, std::vector<T> const& sorted, std::size_t k,
+              Compare comp) {
+  auto const equiv = [&](T const& a, T const& b) { return !comp(a, b) && !comp(b, a); };
+  if (!equiv(v[k], sorted[k])) return false;
+  for (std::size_t i = 0; i < k; ++i)
+    if (comp(v[k], v[i])) return false;
+  for (std::size_t i = k + 1; i < v.size(); ++i)
+    if (comp(v[i], v[k])) return false;
+  std::vector<T> again = v;
+  std::sort(again.begin(), again.end(), comp);
+  return std::equal(again.begin(), again.end(), sorted.begin(), equiv);
+}
+
+// Ranks worth checking in a range of n: the ends, the middle, random ones.
+std::vector<std::size_t> ranks_of(std::size_t n, Rng& rng) {
+  if (n == 0) return {};
+  return {0, n - 1, n / 2, static_cast<std::size_t>(rng.below(n)),
+          static_cast<std::size_t>(rng.below(n))};
+}
+
+template <class T, class Compare>
+void nth_element_case(Context& t, shape s, std::size_t n, Compare comp) {
+  auto const input = make_input<T>(s, n, t.rng());
+  auto sorted = input;
+  std::sort(sorted.begin(), sorted.end(), comp);
+  for (std::size_t k : ranks_of(n, t.rng())) {
+    auto v = input;
+    t.set_case(describe<T>("nth_element", s, n) + " k=" + std::to_string(k));
+    algoritmi::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end(), comp);
+    ALGORITMI_CHECK(t, selected(v, sorted, k, comp));
+  }
+}
+
+template <class T>
+void nth_element_types(Context& t, std::size_t n) {
+  for (shape s : all_shapes) {
+    nth_element_case<T>(t, s, n, std::less<T>());
+    nth_element_case<T>(t, s, n, std::greater<T>());
+  }
+}
+
+void test_nth_element(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    // Every other round is large enough for the sampling and SIMD paths.
+    std::size_t const n =
+        round % 2 ? 2000 + random_size(t.rng(), max_n) : random_size(t.rng(), max_n);
+    nth_element_types<std::uint8_t>(t, n);
+    nth_element_types<std::int32_t>(t, n);
+    nth_element_types<std::uint32_t>(t, n);
+    nth_element_types<std::int64_t>(t, n);
+    nth_element_types<std::uint64_t>(t, n);
+    nth_element_types<float>(t, n);
+    nth_element_types<double>(t, n);
+    nth_element_types<std::string>(t, std::min<std::size_t>(n, 5000));
+  }
+  // Past the end and empty ranges are no-ops.
+  std::vector<int> v{3, 1, 2};
+  algoritmi::nth_element(v.begin(), v.end(), v.end());
+  algoritmi::nth_element(v.begin(), v.begin(), v.begin());
+  ALGORITMI_CHECK(t, v == std::vector<int>({3, 1, 2}));
+}
+
+template <class T>
+void kernels_types(Context& t, std::size_t n) {
+  for (shape s : all_shapes) {
+    auto const input = make_input<T>(s, n, t.rng());
+    auto sorted = input;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::size_t> const ranks = ranks_of(n, t.rng());
+    for (isa which : host_isas()) {
+      t.set_case(describe<T>(to_string(which), s, n));
+      for (std::size_t k : ranks) {
+        auto v = input;
+        nth_element(which, v.data(), v.data() + k, v.data() + n);
+        ALGORITMI_CHECK(t, selected(v, sorted, k, std::less<T>()));
+      }
+      auto v = input;
+      nth_elements(which, v.data(), v.data() + n, span<std::size_t const>(ranks));
+      bool ok = true;
+      for (std::size_t k : ranks) ok = ok && !(v[k] < sorted[k]) && !(sorted[k] < v[k]);
+      ALGORITMI_CHECK(t, ok);
+    }
+  }
+}
+
+void test_kernels(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(3); ++round) {
+    std::size_t const n = 3000 + static_cast<std::size_t>(t.rng().below(20000));
+    kernels_types<std::int32_t>(t, n);
+    kernels_types<std::uint32_t>(t, n);
+    kernels_types<std::int64_t>(t, n);
+    kernels_types<std::uint64_t>(t, n);
+    kernels_types<float>(t, n);
+    kernels_types<double>(t, n);
+  }
+}
+
+void test_adversary(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const n = 1000 + random_size(t.rng(), 20000);
+    std::size_t const k = static_cast<std::size_t>(t.rng().below(n));
+    auto const play = [k](auto first, auto last, auto comp) {
+      algoritmi::nth_element(first, first + static_cast<std::ptrdiff_t>(k), last, comp);
+    };
+    std::vector<std::size_t> ranks = killer_ranks(n, play);
+    auto sorted = ranks;
+    std::sort(sorted.begin(), sorted.end());
+    t.set_case("adversary n=" + std::to_string(n) + " k=" + std::to_string(k));
+    std::uint64_t calls = 0;
+    auto const counting = [&calls](std::size_t a, std::size_t b) {
+      ++calls;
+      return a < b;
+    };
+    algoritmi::nth_element(ranks.begin(), ranks.begin() + static_cast<std::ptrdiff_t>(k),
+                           ranks.end(), counting);
+    ALGORITMI_CHECK(t, selected(ranks, sorted, k, std::less<std::size_t>()));
+    ALGORITMI_CHECK(t, calls <= 40 * n);
+  }
+}
+
+void test_nth_elements(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(20); ++round) {
+    shape const s = all_shapes[round % std::size(all_shapes)];
+    std::size_t const n = 1 + random_size(t.rng(), max_n);
+    auto v = make_input<std::uint64_t>(s, n, t.rng());
+    auto sorted = v;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::size_t> ranks;
+    std::size_t const m = static_cast<std::size_t>(t.rng().below(40));
+    for (std::size_t i = 0; i < m; ++i) ranks.push_back(static_cast<std::size_t>(t.rng().below(n)));
+    if (m > 0) ranks.push_back(ranks[0]);  // duplicates are fine
+    t.set_case(describe<std::uint64_t>("nth_elements", s, n) + " ranks=" + std::to_string(m));
+
+    auto a = v;
+    algoritmi::nth_elements(a.begin(), a.end(), span<std::size_t const>(ranks));
+    bool ok = true;
+    for (std::size_t r : ranks) ok = ok && a[r] == sorted[r];
+    ALGORITMI_CHECK(t, ok);
+    // Between two requested ranks only the elements that belong there.
+    std::vector<std::size_t> cut = ranks;
+    std::sort(cut.begin(), cut.end());
+    for (std::size_t i = 0; i + 1 < cut.size(); ++i)
+      for (std::size_t j = cut[i]; j < cut[i + 1]; ++j)
+        ok = ok && a[cut[i]] <= a[j] && a[j] <= a[cut[i + 1]];
+    ALGORITMI_CHECK(t, ok);
+
+    std::vector<double> const qs{0.0, 0.5, 0.9, 0.99, 0.999, 1.0, t.rng().uniform()};
+    auto b = v;
+    auto const q = algoritmi::quantiles(b.begin(), b.end(), span<double const>(qs));
+    ALGORITMI_CHECK(t, q.size() == qs.size());
+    for (std::size_t i = 0; i < qs.size(); ++i)
+      ALGORITMI_CHECK(t, q[i] == sorted[static_cast<std::size_t>(qs[i] * double(n - 1))]);
+
+    std::size_t const past = n;
+    ALGORITMI_CHECK_THROWS(t, std::out_of_range,
+                           algoritmi::nth_elements(a.begin(), a.end(),
+                                                   span<std::size_t const>(&past, 1)));
+  }
+  std::vector<int> empty;
+  std::vector<double> const half{0.5}, bad{1.5};
+  std::vector<int> one{7};
+  ALGORITMI_CHECK_THROWS(
+      t, std::invalid_argument,
+      algoritmi::quantiles(empty.begin(), empty.end(), span<double const>(half)));
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument,
+                         algoritmi::quantiles(one.begin(), one.end(), span<double const>(bad)));
+}
+
+// How far q lies outside the range of ranks x has in sorted.
+template <class T, class Compare>
+double rank_error(std::vector<T> const& sorted, T const& x, double q, Compare comp) {
+  double const n = static_cast<double>(sorted.size());
+  double const lo =
+      static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), x, comp) - sorted.begin());
+  double const hi =
+      static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), x, comp) - sorted.begin());
+  return std::max({0.0, lo / n - q, q - hi / n});
+}
+
+template <class T, class Compare>
+void kll_case(Context& t, std::vector<T> const& data, Compare comp, std::size_t shards) {
+  auto sorted = data;
+  std::sort(sorted.begin(), sorted.end(), comp);
+  std::vector<kll_sketch<T, Compare>> parts;
+  for (std::size_t i = 0; i < shards; ++i)
+    parts.emplace_back(200, t.rng().next(), comp);
+  for (std::size_t i = 0; i < data.size(); ++i) parts[i % shards].update(data[i]);
+  kll_sketch<T, Compare> sketch(200, t.rng().next(), comp);
+  for (auto const& p : parts) sketch.merge(p);
+
+  ALGORITMI_CHECK(t, sketch.count() == data.size());
+  ALGORITMI_CHECK(t, sketch.retained() < 1000);
+  ALGORITMI_CHECK(t, !comp(sketch.min(), sorted.front()) && !comp(sorted.front(), sketch.min()));
+  ALGORITMI_CHECK(t, !comp(sketch.max(), sorted.back()) && !comp(sorted.back(), sketch.max()));
+  std::vector<double> qs;
+  for (int i = 0; i <= 100; ++i) qs.push_back(i / 100.0);
+  qs.insert(qs.end(), {0.995, 0.999});
+  auto const values = sketch.quantiles(span<double const>(qs));
+  double worst = 0;
+  for (std::size_t i = 0; i < qs.size(); ++i)
+    worst = std::max(worst, rank_error(sorted, values[i], qs[i], comp));
+  ALGORITMI_CHECK(t, worst <= 0.02);
+  for (std::size_t i = 0; i < 20; ++i) {
+    T const& x = data[t.rng().below(data.size())];
+    double const exact = static_cast<double>(
+        std::lower_bound(sorted.begin(), sorted.end(), x, comp) - sorted.begin());
+    ALGORITMI_CHECK(t, std::abs(sketch.rank(x) - exact / static_cast<double>(data.size())) <= 0.02);
+  }
+  // Merged into itself, every item counts twice and the ranks stay put.
+  sketch.merge(sketch);
+  ALGORITMI_CHECK(t, sketch.count() == 2 * data.size() && sketch.retained() < 1000);
+  for (double q : {0.1, 0.5, 0.9})
+    ALGORITMI_CHECK(t, rank_error(sorted, sketch.quantile(q), q, comp) <= 0.02);
+}
+
+void test_kll_sketch(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const n = 20000 + static_cast<std::size_t>(t.rng().below(200000));
+    std::size_t const shards = 1 + static_cast<std::size_t>(t.rng().below(8));
+    for (shape s : {shape::random, shape::sorted, shape::reversed, shape::few_unique}) {
+      t.set_case(describe<std::uint64_t>("kll_sketch", s, n) + " shards=" + std::to_string(shards));
+      kll_case(t, make_input<std::uint64_t>(s, n, t.rng()), std::less<std::uint64_t>(), shards);
+      t.set_case(describe<double>("kll_sketch greater", s, n));
+      kll_case(t, make_input<double>(s, n, t.rng()), std::greater<double>(), shards);
+    }
+    t.set_case(describe<std::string>("kll_sketch", shape::random, n / 10));
+    kll_case(t, make_input<std::string>(shape::random, n / 10, t.rng()), std::less<std::string>(),
+             shards);
+  }
+  kll_sketch<int> a(200), b(100);
+  b.update(1);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, a.merge(b));
+}
+
+void tdigest_case(Context& t, std::vector<double> const& data, std::size_t shards) {
+  auto sorted = data;
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<tdigest> parts(shards);
+  for (std::size_t i = 0; i < data.size(); ++i) parts[i % shards].add(data[i]);
+  tdigest digest;
+  for (auto const& p : parts) digest.merge(p);
+
+  ALGORITMI_CHECK(t, digest.count() == static_cast<double>(data.size()));
+  ALGORITMI_CHECK(t, digest.min() == sorted.front() && digest.max() == sorted.back());
+  ALGORITMI_CHECK(t, digest.centroids().size() <= 200);
+  // Looser in the middle, tight in the tails, where t-digest spends its
+  // centroids.
+  for (double q : {0.01, 0.1, 0.25, 0.5, 0.75, 0.9}) {
+    double const x = digest.quantile(q);
+    ALGORITMI_CHECK(t, rank_error(sorted, x, q, std::less<double>()) <= 0.01);
+    ALGORITMI_CHECK(t, std::abs(digest.cdf(x) - q) <= 0.01);
+  }
+  ALGORITMI_CHECK(t, rank_error(sorted, digest.quantile(0.99), 0.99, std::less<double>()) <= 0.003);
+  for (double q : {0.001, 0.999}) {
+    double const x = digest.quantile(q);
+    ALGORITMI_CHECK(t, rank_error(sorted, x, q, std::less<double>()) <= 0.0005);
+  }
+  ALGORITMI_CHECK(t, digest.quantile(0) == sorted.front() && digest.quantile(1) == sorted.back());
+  ALGORITMI_CHECK(t, digest.cdf(sorted.front() - 1) == 0 && digest.cdf(sorted.back()) == 1);
+}
+
+void test_tdigest(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const n = 20000 + static_cast<std::size_t>(t.rng().below(300000));
+    std::size_t const shards = 1 + static_cast<std::size_t>(t.rng().below(8));
+    std::vector<double> uniform(n), latency(n);
+    for (auto& x : uniform) x = t.rng().uniform() * 1000;
+    // Long-tailed like request latencies: exponential with rare slow ones.
+    for (auto& x : latency)
+      x = -std::log(1 - t.rng().uniform()) * (t.rng().below(100) == 0 ? 50 : 1);
+    t.set_case("tdigest uniform n=" + std::to_string(n) + " shards=" + std::to_string(shards));
+    tdigest_case(t, uniform, shards);
+    t.set_case("tdigest latency n=" + std::to_string(n) + " shards=" + std::to_string(shards));
+    tdigest_case(t, latency, shards);
+  }
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, tdigest(1));
+}
+
+ALGORITMI_TEST("select/nth_element", test_nth_element);
+ALGORITMI_TEST("select/kernels", test_kernels);
+ALGORITMI_TEST("select/adversary", test_adversary);
+ALGORITMI_TEST("select/nth_elements", test_nth_elements);
+ALGORITMI_TEST("select/kll_sketch", test_kll_sketch);
+ALGORITMI_TEST("select/tdigest", test_tdigest);
+
+}  // namespace
+}  // namespace algoritmi::test
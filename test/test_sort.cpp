@@ -0,0 +1,359 @@
+// Sorting against std::sort and std::stable_sort.
+//
+//   sort/pdqsort         every shape, several key types and both orders;
+//                        comparison count on the quicksort killer
+//   sort/radix_sort      arithmetic keys and stability under a key extractor
+//   sort/sort            the dispatching entry point
+//   sort/parallel        par overloads above their parallel threshold
+//   sort/small_sort      every instruction set, every size up to
+//                        small_sort_max; static_sort and the networks
+//   sort/external_sort   files of several runs and merge passes
+//   sort/loser_tree      k-way merges against std::stable_sort
+#include <algoritmi/sort.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+constexpr std::size_t max_n = 20000;
+
+// Same sequence of values; -0.0 and 0.0 compare equal, like the sorts do.
+template <class T>
+bool same_values(std::vector<T> const& a, std::vector<T> const& b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <class T, class Compare>
+void pdqsort_case(Context& t, shape s, std::size_t n, Compare comp) {
+  auto v = make_input<T>(s, n, t.rng());
+  auto expect = v;
+  std::sort(expect.begin(), expect.end(), comp);
+  t.set_case(describe<T>("pdqsort", s, n));
+  pdqsort(v.begin(), v.end(), comp);
+  ALGORITMI_CHECK(t, same_values(v, expect));
+}
+
+template <class T>
+void pdqsort_types(Context& t, std::size_t n) {
+  for (shape s : all_shapes) {
+    pdqsort_case<T>(t, s, n, std::less<T>());
+    pdqsort_case<T>(t, s, n, std::greater<T>());
+  }
+}
+
+void test_pdqsort(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    std::size_t const n = random_size(t.rng(), max_n);
+    pdqsort_types<std::uint8_t>(t, n);
+    pdqsort_types<std::int32_t>(t, n);
+    pdqsort_types<std::uint64_t>(t, n);
+    pdqsort_types<double>(t, n);
+    pdqsort_types<std::string>(t, n);
+  }
+  // The adversary makes a median-of-3 quicksort quadratic; pdqsort must
+  // notice the bad partitions and stay within O(n log n) comparisons.
+  for (std::size_t n : {1000u, 10000u, 100000u}) {
+    auto v = make_input<std::uint32_t>(shape::killer, n, t.rng());
+    std::size_t comparisons = 0;
+    t.set_case(describe<std::uint32_t>("pdqsort comparisons", shape::killer, n));
+    pdqsort(v.begin(), v.end(), [&](std::uint32_t a, std::uint32_t b) {
+      ++comparisons;
+      return a < b;
+    });
+    ALGORITMI_CHECK(t, std::is_sorted(v.begin(), v.end()));
+    ALGORITMI_CHECK(t, comparisons < 4 * n * static_cast<std::size_t>(std::log2(n) + 1));
+  }
+}
+
+template <class T>
+void radix_types(Context& t, std::size_t n) {
+  for (shape s : all_shapes) {
+    auto v = make_input<T>(s, n, t.rng());
+    auto expect = v;
+    std::sort(expect.begin(), expect.end());
+    t.set_case(describe<T>("radix_sort", s, n));
+    radix_sort(v.begin(), v.end());
+    ALGORITMI_CHECK(t, same_values(v, expect));
+  }
+}
+
+void test_radix_sort(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(6); ++round) {
+    std::size_t const n = random_size(t.rng(), max_n);
+    radix_types<std::uint8_t>(t, n);
+    radix_types<std::int16_t>(t, n);
+    radix_types<std::uint32_t>(t, n);
+    radix_types<std::int64_t>(t, n);
+    radix_types<float>(t, n);
+    radix_types<double>(t, n);
+
+    // Stability: sort (key, original index) pairs by key only.
+    for (shape s : {shape::random, shape::few_unique, shape::all_equal}) {
+      auto const keys = make_input<std::int32_t>(s, n, t.rng());
+      std::vector<std::pair<std::int32_t, std::uint32_t>> v(n);
+      for (std::size_t i = 0; i < n; ++i) v[i] = {keys[i], static_cast<std::uint32_t>(i)};
+      auto expect = v;
+      auto const by_key = [](auto const& a, auto const& b) { return a.first < b.first; };
+      std::stable_sort(expect.begin(), expect.end(), by_key);
+      t.set_case(describe<std::int32_t>("radix_sort stable", s, n));
+      radix_sort(v.begin(), v.end(), [](auto const& p) { return p.first; });
+      ALGORITMI_CHECK(t, v == expect);
+    }
+  }
+}
+
+template <class T>
+void sort_types(Context& t, std::size_t n) {
+  for (shape s : all_shapes) {
+    auto v = make_input<T>(s, n, t.rng());
+    auto expect = v;
+    std::sort(expect.begin(), expect.end());
+    t.set_case(describe<T>("sort", s, n));
+    algoritmi::sort(v.begin(), v.end());
+    ALGORITMI_CHECK(t, same_values(v, expect));
+  }
+}
+
+void test_sort(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(4); ++round) {
+    std::size_t const n = random_size(t.rng(), max_n);
+    sort_types<std::uint16_t>(t, n);
+    sort_types<std::int64_t>(t, n);
+    sort_types<float>(t, n);
+    sort_types<std::string>(t, n);
+  }
+}
+
+// Inputs just above detail::psort::parallel_threshold, so the sample sort
+// and the parallel LSD passes run rather than the sequential fallbacks.
+void test_parallel(Context& t) {
+  std::size_t const base = detail::psort::parallel_threshold;
+  for (std::size_t round = 0; round < t.rounds(1); ++round) {
+    for (shape s : {shape::random, shape::few_unique, shape::reversed}) {
+      std::size_t const n = base + t.rng().below(5000);
+      auto v = make_input<std::uint32_t>(s, n, t.rng());
+      auto expect = v;
+      std::sort(expect.begin(), expect.end());
+      auto w = v;
+      t.set_case(describe<std::uint32_t>("sort(par)", s, n));
+      algoritmi::sort(par, v.begin(), v.end());
+      ALGORITMI_CHECK(t, v == expect);
+      t.set_case(describe<std::uint32_t>("pdqsort(par)", s, n));
+      pdqsort(par, w.begin(), w.end(), std::greater<>());
+      ALGORITMI_CHECK(t, std::equal(w.begin(), w.end(), expect.rbegin()));
+    }
+    // Stability of the parallel radix sort.
+    std::size_t const n = base + t.rng().below(5000);
+    std::vector<std::pair<std::uint16_t, std::uint32_t>> v(n);
+    for (std::size_t i = 0; i < n; ++i)
+      v[i] = {static_cast<std::uint16_t>(t.rng().below(300)), static_cast<std::uint32_t>(i)};
+    auto expect = v;
+    std::stable_sort(expect.begin(), expect.end(),
+                     [](auto const& a, auto const& b) { return a.first < b.first; });
+    t.set_case(describe<std::uint16_t>("radix_sort(par) stable", shape::few_unique, n));
+    radix_sort(par, v.begin(), v.end(), [](auto const& p) { return p.first; });
+    ALGORITMI_CHECK(t, v == expect);
+  }
+}
+
+template <class T>
+void small_types(Context& t) {
+  for (isa which : host_isas()) {
+    for (std::size_t n = 0; n <= small_sort_max; ++n) {
+      for (shape s : all_shapes) {
+        auto v = make_input<T>(s, n, t.rng());
+        auto w = v;
+        auto expect = v;
+        std::sort(expect.begin(), expect.end());
+        t.set_case(describe<T>((std::string("small_sort ") + to_string(which)).c_str(), s, n));
+        small_sort(which, v.begin(), v.end(), std::less<T>());
+        ALGORITMI_CHECK(t, same_values(v, expect));
+        small_sort(which, w.begin(), w.end(), std::greater<T>());
+        ALGORITMI_CHECK(t, std::equal(w.begin(), w.end(), expect.rbegin()));
+      }
+    }
+  }
+}
+
+template <std::size_t N>
+void static_sort_case(Context& t) {
+  auto v = make_input<std::int32_t>(shape::random, N, t.rng());
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  t.set_case("static_sort n=" + std::to_string(N));
+  static_sort<N>(v.begin());
+  ALGORITMI_CHECK(t, v == expect);
+
+  // 0-1 principle: a network sorts everything iff it sorts every 0/1 input.
+  if constexpr (N <= 16) {
+    auto const network = sorting_network<N>();
+    bool all = true;
+    for (std::uint32_t bits = 0; bits < (1u << N); ++bits) {
+      std::uint8_t x[N];
+      for (std::size_t i = 0; i < N; ++i) x[i] = bits >> i & 1;
+      for (auto const& p : network)
+        if (x[p.lo] > x[p.hi]) std::swap(x[p.lo], x[p.hi]);
+      all = all && std::is_sorted(x, x + N);
+    }
+    ALGORITMI_CHECK(t, all);
+  }
+}
+
+void test_small_sort(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(2); ++round) {
+    small_types<std::int32_t>(t);
+    small_types<std::uint32_t>(t);
+    small_types<std::int64_t>(t);
+    small_types<std::uint64_t>(t);
+    small_types<float>(t);
+    small_types<double>(t);
+    small_types<std::string>(t);
+  }
+  static_sort_case<1>(t);
+  static_sort_case<2>(t);
+  static_sort_case<3>(t);
+  static_sort_case<7>(t);
+  static_sort_case<8>(t);
+  static_sort_case<13>(t);
+  static_sort_case<16>(t);
+  static_sort_case<33>(t);
+  static_sort_case<64>(t);
+
+  for (std::size_t n = 0; n <= 48; ++n) {
+    auto v = make_input<std::string>(shape::random, n, t.rng());
+    auto expect = v;
+    std::sort(expect.begin(), expect.end());
+    t.set_case(describe<std::string>("branchless_insertion_sort", shape::random, n));
+    branchless_insertion_sort(v.begin(), v.end());
+    ALGORITMI_CHECK(t, v == expect);
+  }
+}
+
+struct record {
+  std::uint32_t key;
+  std::uint32_t payload[3];
+};
+
+template <class T>
+std::vector<T> read_file(std::filesystem::path const& p) {
+  std::ifstream in(p, std::ios::binary);
+  std::vector<T> v(std::filesystem::file_size(p) / sizeof(T));
+  in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+  return v;
+}
+
+template <class T>
+void write_file(std::filesystem::path const& p, std::vector<T> const& v) {
+  std::ofstream out(p, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<char const*>(v.data()),
+            static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+void test_external_sort(Context& t) {
+  auto const dir = std::filesystem::temp_directory_path();
+  auto const stem = "algoritmi_test_" + std::to_string(t.seed());
+  auto const in = dir / (stem + ".in"), out = dir / (stem + ".out");
+
+  for (std::size_t round = 0; round < t.rounds(2); ++round) {
+    for (shape s : {shape::random, shape::reversed, shape::few_unique}) {
+      std::size_t const n = 20000 + t.rng().below(20000);
+      auto const v = make_input<std::uint64_t>(s, n, t.rng());
+      write_file(in, v);
+      auto expect = v;
+      std::sort(expect.begin(), expect.end());
+
+      // A tiny budget forces many runs; small blocks force several passes.
+      external_sort_options options;
+      options.memory_budget = (1000 + t.rng().below(4000)) * sizeof(std::uint64_t);
+      options.block_bytes = 64 * sizeof(std::uint64_t);
+      options.use_mmap = t.rng().coin();
+      t.set_case(describe<std::uint64_t>("external_sort", s, n) +
+                 " budget=" + std::to_string(options.memory_budget));
+      auto const stats = external_sort<std::uint64_t>(in, out, std::less<std::uint64_t>(), options);
+      ALGORITMI_CHECK(t, stats.records == n && stats.runs > 1);
+      ALGORITMI_CHECK(t, read_file<std::uint64_t>(out) == expect);
+
+      t.set_case(describe<std::uint64_t>("external_sort(par)", s, n));
+      external_sort<std::uint64_t>(par, in, out, std::less<std::uint64_t>(), options);
+      ALGORITMI_CHECK(t, read_file<std::uint64_t>(out) == expect);
+    }
+
+    // Records under a comparator, sorted by pdqsort within runs.
+    std::size_t const n = 5000 + t.rng().below(5000);
+    std::vector<record> v(n);
+    for (std::size_t i = 0; i < n; ++i)
+      v[i] = {static_cast<std::uint32_t>(t.rng().below(100)),
+              {static_cast<std::uint32_t>(i), 0, 0}};
+    write_file(in, v);
+    external_sort_options options;
+    options.memory_budget = 300 * sizeof(record);
+    auto const by_key = [](record const& a, record const& b) { return a.key < b.key; };
+    t.set_case("external_sort record n=" + std::to_string(n));
+    external_sort<record>(in, out, by_key, options);
+    auto const got = read_file<record>(out);
+    bool ok = got.size() == n && std::is_sorted(got.begin(), got.end(), by_key);
+    std::vector<std::uint32_t> ids;
+    for (auto const& r : got) ids.push_back(r.payload[0]);
+    std::sort(ids.begin(), ids.end());
+    for (std::size_t i = 0; ok && i < n; ++i) ok = ids[i] == i;
+    ALGORITMI_CHECK(t, ok);
+  }
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, external_sort<std::uint64_t>(in, in));
+  std::filesystem::remove(in);
+  std::filesystem::remove(out);
+}
+
+void test_loser_tree(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(50); ++round) {
+    std::size_t const k = t.rng().below(40);
+    // Runs of (key, run) pairs; ties must come out in run order.
+    std::vector<std::vector<std::pair<int, int>>> runs(k);
+    std::vector<std::pair<int, int>> expect;
+    for (std::size_t r = 0; r < k; ++r) {
+      std::size_t const len = t.rng().below(30);
+      for (std::size_t i = 0; i < len; ++i)
+        runs[r].push_back({static_cast<int>(t.rng().below(20)), static_cast<int>(r)});
+      std::sort(runs[r].begin(), runs[r].end());
+      expect.insert(expect.end(), runs[r].begin(), runs[r].end());
+    }
+    auto const by_key = [](auto const& a, auto const& b) { return a.first < b.first; };
+    std::stable_sort(expect.begin(), expect.end(), by_key);
+
+    loser_tree<std::pair<int, int>, decltype(by_key)> tree(k, by_key);
+    std::vector<std::size_t> pos(k, 0);
+    for (std::size_t r = 0; r < k; ++r) tree.set(r, runs[r].empty() ? nullptr : runs[r].data());
+    tree.build();
+    std::vector<std::pair<int, int>> got;
+    while (!tree.empty()) {
+      std::size_t const r = tree.top_source();
+      got.push_back(tree.top());
+      tree.replace_top(++pos[r] < runs[r].size() ? runs[r].data() + pos[r] : nullptr);
+    }
+    t.set_case("loser_tree k=" + std::to_string(k));
+    ALGORITMI_CHECK(t, got == expect);
+  }
+}
+
+ALGORITMI_TEST("sort/pdqsort", test_pdqsort);
+ALGORITMI_TEST("sort/radix_sort", test_radix_sort);
+ALGORITMI_TEST("sort/sort", test_sort);
+ALGORITMI_TEST("sort/parallel", test_parallel);
+ALGORITMI_TEST("sort/small_sort", test_small_sort);
+ALGORITMI_TEST("sort/external_sort", test_external_sort);
+ALGORITMI_TEST("sort/loser_tree", test_loser_tree);
+
+}  // namespace
+}  // namespace algoritmi::test
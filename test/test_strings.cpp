@@ -0,0 +1,207 @@
+// String search and suffix structures against brute force.
+//
+//   strings/find_substring   find_substring and substring_searcher against
+//                            std::string_view::find, every instruction set
+//   strings/aho_corasick     for_each_match, find_all, contains_any against
+//                            matching every pattern at every position
+//   strings/suffix_array     suffix_array against sorting suffixes,
+//                            lcp_array against direct comparison,
+//                            suffix_range against a scan
+//
+// Texts come from alphabets of 1, 2, 4, 26 and 256 bytes (NUL and high
+// bytes included), or repeat a short period: highly periodic inputs are
+// where the SIMD filter gives up and the two-way fallback takes over.
+#include <algoritmi/strings.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+std::string random_text(Rng& rng, std::size_t n, unsigned sigma) {
+  std::string s(n, '\0');
+  for (auto& c : s)
+    c = static_cast<char>(sigma == 256 ? rng.below(256) : 'a' + rng.below(sigma));
+  return s;
+}
+
+// A random text, or a short random word repeated with rare mutations.
+std::string make_text(Rng& rng, std::size_t n, unsigned& sigma) {
+  static constexpr unsigned sigmas[] = {1, 2, 4, 26, 256};
+  sigma = sigmas[rng.below(5)];
+  if (rng.below(3) != 0) return random_text(rng, n, sigma);
+  std::string const word = random_text(rng, 1 + rng.below(8), sigma);
+  std::string s;
+  while (s.size() < n) s += word;
+  s.resize(n);
+  for (std::size_t k = rng.below(4); k > 0 && n > 0; --k)
+    s[rng.below(n)] = random_text(rng, 1, sigma)[0];
+  return s;
+}
+
+// Mostly pieces of the text, so that there are matches, sometimes tweaked
+// in one byte so that there nearly are.
+std::string make_pattern(Rng& rng, std::string const& text, unsigned sigma) {
+  std::size_t const m = rng.below(4) == 0 ? rng.below(80) : 1 + rng.below(12);
+  if (text.empty() || rng.below(4) == 0) return random_text(rng, m, sigma);
+  std::size_t const at = rng.below(text.size());
+  std::string p = text.substr(at, m);
+  if (!p.empty() && rng.coin()) p[rng.below(p.size())] = random_text(rng, 1, sigma)[0];
+  return p;
+}
+
+std::string label(char const* what, std::size_t n, unsigned sigma) {
+  return std::string(what) + " n=" + std::to_string(n) + " sigma=" + std::to_string(sigma);
+}
+
+void test_find_substring(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(60); ++round) {
+    std::size_t const n = random_size(t.rng(), 100000);
+    unsigned sigma = 0;
+    std::string const text = make_text(t.rng(), n, sigma);
+    std::string_view const view = text;
+    t.set_case(label("find_substring", n, sigma));
+    for (int k = 0; k < 16; ++k) {
+      std::string const p = make_pattern(t.rng(), text, sigma);
+      std::size_t const from = t.rng().below(4) == 0 ? t.rng().below(n + 2) : 0;
+      std::size_t const expect = view.find(p, from);
+      substring_searcher const searcher(p);
+      ALGORITMI_CHECK(t, find_substring(view, p, from) == expect);
+      ALGORITMI_CHECK(t, searcher.find(view, from) == expect);
+      for (isa which : host_isas()) {
+        ALGORITMI_CHECK(t, find_substring(which, view, p, from) == expect);
+        ALGORITMI_CHECK(t, searcher.find(which, view, from) == expect);
+      }
+      if (!p.empty()) {
+        std::size_t count = 0;
+        for (std::size_t i = view.find(p); i != npos; i = view.find(p, i + 1)) ++count;
+        ALGORITMI_CHECK(t, searcher.count(view) == count);
+      }
+    }
+  }
+}
+
+using match = aho_corasick::match;
+
+std::vector<match> brute_force_matches(std::vector<std::string> const& patterns,
+                                       std::string_view text) {
+  std::vector<match> out;
+  for (std::size_t k = 0; k < patterns.size(); ++k)
+    for (std::size_t i = text.find(patterns[k]); i != npos; i = text.find(patterns[k], i + 1))
+      out.push_back({k, i, i + patterns[k].size()});
+  return out;
+}
+
+// By end, longest first; the pattern index only orders equal patterns,
+// which the automaton may report in any order.
+bool reported_before(match const& a, match const& b) {
+  return std::make_tuple(a.end, a.begin, a.pattern) < std::make_tuple(b.end, b.begin, b.pattern);
+}
+
+bool same_matches(std::vector<match> got, std::vector<match> expect) {
+  bool const ordered =
+      std::is_sorted(got.begin(), got.end(), [](match const& a, match const& b) {
+        return std::make_pair(a.end, a.begin) < std::make_pair(b.end, b.begin);
+      });
+  std::sort(got.begin(), got.end(), reported_before);
+  std::sort(expect.begin(), expect.end(), reported_before);
+  return ordered && got.size() == expect.size() &&
+         std::equal(got.begin(), got.end(), expect.begin(), [](match const& a, match const& b) {
+           return a.pattern == b.pattern && a.begin == b.begin && a.end == b.end;
+         });
+}
+
+void test_aho_corasick(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(60); ++round) {
+    std::size_t const n = random_size(t.rng(), 8000);
+    unsigned sigma = 0;
+    std::string const text = make_text(t.rng(), n, sigma);
+    // A few patterns (the prefilter on) or many (off); duplicates allowed.
+    std::size_t const count = 1 + t.rng().below(t.rng().coin() ? 4 : 100);
+    std::vector<std::string> patterns;
+    while (patterns.size() < count) {
+      std::string p = make_pattern(t.rng(), text, sigma);
+      if (p.empty()) continue;
+      if (!patterns.empty() && t.rng().below(16) == 0)
+        p = patterns[t.rng().below(patterns.size())];
+      patterns.push_back(std::move(p));
+    }
+    aho_corasick const ac(patterns.begin(), patterns.end());
+    auto const expect = brute_force_matches(patterns, text);
+    t.set_case(label("aho_corasick", n, sigma) + " patterns=" + std::to_string(count));
+    auto const all = ac.find_all(text);
+    ALGORITMI_CHECK(t, ac.pattern_count() == count);
+    ALGORITMI_CHECK(t, same_matches({all.begin(), all.end()}, expect));
+    ALGORITMI_CHECK(t, ac.contains_any(text) == !expect.empty());
+    for (isa which : host_isas()) {
+      std::vector<match> got;
+      ac.for_each_match(which, text, [&](match const& m) { got.push_back(m); });
+      ALGORITMI_CHECK(t, same_matches(got, expect));
+    }
+  }
+  std::vector<std::string> const with_empty = {"a", ""};
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument,
+                         aho_corasick(with_empty.begin(), with_empty.end()));
+  aho_corasick const none;
+  ALGORITMI_CHECK(t, none.find_all("anything").empty() && !none.contains_any("anything"));
+}
+
+template <class Index>
+void suffix_case(Context& t, std::string const& text, unsigned sigma) {
+  std::size_t const n = text.size();
+  std::string_view const view = text;
+  std::vector<Index> expect(n);
+  for (std::size_t i = 0; i < n; ++i) expect[i] = static_cast<Index>(i);
+  std::sort(expect.begin(), expect.end(),
+            [&](Index a, Index b) { return view.substr(a) < view.substr(b); });
+  t.set_case(label(sizeof(Index) == 4 ? "suffix_array u32" : "suffix_array u64", n, sigma));
+  auto const sa = suffix_array<Index>(view);
+  ALGORITMI_CHECK(t, std::equal(sa.begin(), sa.end(), expect.begin(), expect.end()));
+
+  auto const lcp = lcp_array(view, expect.data());
+  bool ok = lcp.size() == n && (n == 0 || lcp[0] == 0);
+  for (std::size_t i = 1; ok && i < n; ++i) {
+    std::string_view const a = view.substr(expect[i - 1]), b = view.substr(expect[i]);
+    std::size_t h = 0;
+    while (h < a.size() && h < b.size() && a[h] == b[h]) ++h;
+    ok = lcp[i] == h;
+  }
+  ALGORITMI_CHECK(t, ok);
+
+  for (int k = 0; k < 16; ++k) {
+    std::string const p = make_pattern(t.rng(), text, sigma);
+    std::size_t first = 0;
+    while (first < n && view.substr(expect[first]).substr(0, p.size()) < p) ++first;
+    std::size_t last = first;
+    while (last < n && view.substr(expect[last]).substr(0, p.size()) == p) ++last;
+    ALGORITMI_CHECK(t, suffix_range(view, expect.data(), p) == std::make_pair(first, last));
+  }
+}
+
+void test_suffix_array(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(40); ++round) {
+    // Sorting suffixes directly is quadratic on periodic text; stay small.
+    std::size_t const n = random_size(t.rng(), 4000);
+    unsigned sigma = 0;
+    std::string const text = make_text(t.rng(), n, sigma);
+    suffix_case<std::uint32_t>(t, text, sigma);
+    if (round % 4 == 0) suffix_case<std::uint64_t>(t, text, sigma);
+  }
+}
+
+ALGORITMI_TEST("strings/find_substring", test_find_substring);
+ALGORITMI_TEST("strings/aho_corasick", test_aho_corasick);
+ALGORITMI_TEST("strings/suffix_array", test_suffix_array);
+
+}  // namespace
+}  // namespace algoritmi::test
@@ -0,0 +1,196 @@
+// Succinct structures against plain arrays.
+//
+//   succinct/bitvector      rank and select at every position and every
+//                           instruction set, against prefix counts
+//   succinct/elias_fano     access, lower_bound, decode against the sorted
+//                           input
+//   succinct/wavelet_matrix access, rank, select, quantile, count_less
+//                           against scans of the sequence
+//
+// Bit densities run from a handful of ones in a long vector to all ones,
+// and sizes cross the 2048-bit superblocks and the select samples.
+#include <algoritmi/succinct.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+namespace algoritmi::test {
+namespace {
+
+// Bits with one of several densities; a fifth of the time in long runs.
+std::vector<bool> random_bits(Rng& rng, std::size_t n) {
+  static constexpr std::uint64_t per_mille[] = {0, 1, 10, 100, 500, 900, 990, 999, 1000};
+  std::uint64_t const density = per_mille[rng.below(9)];
+  std::vector<bool> bits(n);
+  bool run = rng.coin();
+  for (std::size_t i = 0; i < n; ++i) {
+    if (rng.below(5) == 0) {
+      if (rng.below(64) == 0) run = !run;
+      bits[i] = run;
+    } else {
+      bits[i] = rng.below(1000) < density;
+    }
+  }
+  return bits;
+}
+
+void test_bitvector(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(40); ++round) {
+    std::size_t const n = round % 5 == 4 ? t.rng().below(300000) : random_size(t.rng(), 20000);
+    auto const bits = random_bits(t.rng(), n);
+    std::vector<std::uint64_t> words((n + 63) / 64 + t.rng().below(2));
+    for (std::size_t i = 0; i < n; ++i) words[i / 64] |= std::uint64_t{bits[i]} << (i % 64);
+    if (n % 64 && t.rng().coin()) words[n / 64] |= ~std::uint64_t{0} << (n % 64);  // ignored
+
+    rank_select_bitvector const from_words(span<std::uint64_t const>(words), n);
+    rank_select_bitvector const from_bools(bits.begin(), bits.end());
+    std::vector<std::size_t> ones, zeros;
+    for (std::size_t i = 0; i < n; ++i) (bits[i] ? ones : zeros).push_back(i);
+    t.set_case("bitvector n=" + std::to_string(n) + " ones=" + std::to_string(ones.size()));
+
+    for (auto const* bv : {&from_words, &from_bools}) {
+      ALGORITMI_CHECK(t, bv->size() == n && bv->count_ones() == ones.size() &&
+                             bv->count_zeros() == zeros.size());
+      bool ok = true;
+      std::size_t rank = 0;
+      for (std::size_t i = 0; ok && i <= n; ++i) {
+        ok = bv->rank1(i) == rank && bv->rank0(i) == i - rank;
+        if (i < n) {
+          ok = ok && (*bv)[i] == bits[i];
+          rank += bits[i];
+        }
+      }
+      for (std::size_t k = 0; ok && k < ones.size(); ++k) ok = bv->select1(k) == ones[k];
+      for (std::size_t k = 0; ok && k < zeros.size(); ++k) ok = bv->select0(k) == zeros[k];
+      ALGORITMI_CHECK(t, ok);
+    }
+
+    for (isa which : host_isas()) {
+      t.set_case("bitvector " + std::string(to_string(which)) + " n=" + std::to_string(n));
+      bool ok = true;
+      for (std::size_t q = 0; ok && q < 2000 && n; ++q) {
+        std::size_t const i = t.rng().below(n + 1);
+        ok = from_words.rank1(which, i) == from_words.rank1(i);
+      }
+      for (std::size_t k = 0; ok && k < ones.size(); k += 1 + t.rng().below(8))
+        ok = from_words.select1(which, k) == ones[k];
+      for (std::size_t k = 0; ok && k < zeros.size(); k += 1 + t.rng().below(8))
+        ok = from_words.select0(which, k) == zeros[k];
+      ALGORITMI_CHECK(t, ok);
+    }
+  }
+  std::vector<std::uint64_t> const one_word(1);
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument,
+                         rank_select_bitvector(span<std::uint64_t const>(one_word), 65));
+}
+
+// Sorted values from a universe of random width, with runs of duplicates.
+std::vector<std::uint64_t> sorted_values(Rng& rng, std::size_t n) {
+  unsigned const width = static_cast<unsigned>(rng.below(65));
+  std::vector<std::uint64_t> v(n);
+  for (auto& x : v) {
+    x = width == 64 ? rng.next() : rng.below(std::uint64_t{1} << width);
+    if (rng.below(8) == 0) x = ~std::uint64_t{0};
+  }
+  std::sort(v.begin(), v.end());
+  for (std::size_t i = 1; i < n; ++i)
+    if (rng.below(4) == 0) v[i] = v[i - 1];
+  return v;
+}
+
+void test_elias_fano(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(60); ++round) {
+    std::size_t const n = random_size(t.rng(), 100000);
+    auto const v = sorted_values(t.rng(), n);
+    elias_fano const ef(v.begin(), v.end());
+    t.set_case("elias_fano n=" + std::to_string(n) +
+               " back=" + std::to_string(n ? v.back() : 0));
+    ALGORITMI_CHECK(t, ef.size() == n && ef.back() == (n ? v.back() : 0));
+    bool ok = true;
+    for (std::size_t i = 0; ok && i < n; ++i) ok = ef[i] == v[i];
+    ALGORITMI_CHECK(t, ok);
+
+    for (std::size_t q = 0; ok && q < 500; ++q) {
+      std::uint64_t key = t.rng().next();
+      if (n && q % 2) key = v[t.rng().below(n)] + t.rng().below(3) - 1;
+      ok = ef.lower_bound(key) ==
+           static_cast<std::size_t>(std::lower_bound(v.begin(), v.end(), key) - v.begin());
+    }
+    ALGORITMI_CHECK(t, ok);
+
+    std::vector<std::uint64_t> out;
+    for (std::size_t q = 0; ok && q < 20 && n; ++q) {
+      std::size_t const first = t.rng().below(n + 1);
+      std::size_t const count = t.rng().below(n - first + 1);
+      out.assign(count + 1, 0xdead);
+      ef.decode(first, count, out.data());
+      ok = std::equal(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(count),
+                      v.begin() + static_cast<std::ptrdiff_t>(first)) &&
+           out[count] == 0xdead;
+    }
+    ALGORITMI_CHECK(t, ok);
+  }
+  std::vector<std::uint64_t> const unsorted = {1, 3, 2};
+  ALGORITMI_CHECK_THROWS(t, std::invalid_argument, elias_fano(unsorted.begin(), unsorted.end()));
+}
+
+void test_wavelet_matrix(Context& t) {
+  for (std::size_t round = 0; round < t.rounds(60); ++round) {
+    std::size_t const n = random_size(t.rng(), 3000);
+    unsigned const width = static_cast<unsigned>(t.rng().below(65));
+    std::vector<std::uint64_t> v(n);
+    for (auto& x : v) x = width == 64 ? t.rng().next() : t.rng().below(std::uint64_t{1} << width);
+    // A few repeated values so that rank and select have something to count.
+    for (std::size_t i = 1; i < n; ++i)
+      if (t.rng().below(3) == 0) v[i] = v[t.rng().below(i)];
+    wavelet_matrix const wm(v.begin(), v.end());
+    t.set_case("wavelet_matrix n=" + std::to_string(n) + " width=" + std::to_string(width));
+    ALGORITMI_CHECK(t, wm.size() == n);
+    bool ok = true;
+    for (std::size_t i = 0; ok && i < n; ++i) ok = wm[i] == v[i];
+    ALGORITMI_CHECK(t, ok);
+
+    for (std::size_t q = 0; ok && q < 100; ++q) {
+      std::uint64_t const value = n && q % 4 ? v[t.rng().below(n)] : t.rng().next();
+      std::size_t const i = t.rng().below(n + 1);
+      auto const before = v.begin() + static_cast<std::ptrdiff_t>(i);
+      ok = wm.rank(value, i) == static_cast<std::size_t>(std::count(v.begin(), before, value));
+      std::vector<std::size_t> at;
+      for (std::size_t j = 0; j < n; ++j)
+        if (v[j] == value) at.push_back(j);
+      std::size_t const k = t.rng().below(at.size() + 2);
+      ok = ok && wm.select(value, k) == (k < at.size() ? at[k] : n);
+    }
+    ALGORITMI_CHECK(t, ok);
+
+    for (std::size_t q = 0; ok && q < 100 && n; ++q) {
+      std::size_t first = t.rng().below(n + 1), last = t.rng().below(n + 1);
+      if (first > last) std::swap(first, last);
+      std::vector<std::uint64_t> range(v.begin() + static_cast<std::ptrdiff_t>(first),
+                                       v.begin() + static_cast<std::ptrdiff_t>(last));
+      std::sort(range.begin(), range.end());
+      std::uint64_t const value = q % 2 ? t.rng().next() : v[t.rng().below(n)];
+      ok = wm.count_less(first, last, value) ==
+           static_cast<std::size_t>(std::lower_bound(range.begin(), range.end(), value) -
+                                    range.begin());
+      if (!range.empty()) {
+        std::size_t const k = t.rng().below(range.size());
+        ok = ok && wm.quantile(first, last, k) == range[k];
+      }
+    }
+    ALGORITMI_CHECK(t, ok);
+  }
+}
+
+ALGORITMI_TEST("succinct/bitvector", test_bitvector);
+ALGORITMI_TEST("succinct/elias_fano", test_elias_fano);
+ALGORITMI_TEST("succinct/wavelet_matrix", test_wavelet_matrix);
+
+}  // namespace
+}  // namespace algoritmi::test